@@ -37,6 +37,8 @@ export const CameraViewer = () => {
     const [resolution, setResolution] = useState({ width: 0, height: 0 });
     const [dataReceived, setDataReceived] = useState(0);
     const [latency, setLatency] = useState(0);
+    const [latencySource, setLatencySource] = useState<"capture" | "server">("server");
+    const [framesLost, setFramesLost] = useState(0);
     const [sensorData, setSensorData] = useState<SensorData[]>([]);
 
     const clientVersion = "1.16.2";
@@ -47,6 +49,7 @@ export const CameraViewer = () => {
     const wsRef = useRef<WebSocket | null>(null);
     const fpsCounterRef = useRef({ count: 0, lastTime: 0 });
     const isConnectingRef = useRef(false);
+    const lastSequenceRef = useRef<number | null>(null);
 
     // Motion overlay state (bounding boxes from AI analyzer)
     interface BoundingBox {
@@ -119,6 +122,12 @@ export const CameraViewer = () => {
             ws.onopen = () => {
                 if (DEBUG_MODE) console.log(`[WS] Connected successfully to ${WS_URL}`);
                 setWsConnected(true);
+                lastSequenceRef.current = null;
+
+                // Opened in a background tab: the relay counts us as not watching
+                if (document.hidden) {
+                    ws.send("VIEWER_NEED:NONE");
+                }
 
                 // Request LED status
                 setTimeout(() => {
@@ -170,6 +179,18 @@ export const CameraViewer = () => {
         // eslint-disable-next-line react-hooks/exhaustive-deps
     }, []);
 
+    // Hidden tab = no live consumer (the device stops uploading when nobody watches)
+    useEffect(() => {
+        const onVisibilityChange = () => {
+            const ws = wsRef.current;
+            if (ws && ws.readyState === WebSocket.OPEN) {
+                ws.send(document.hidden ? "VIEWER_NEED:NONE" : "VIEWER_NEED:LIVE");
+            }
+        };
+        document.addEventListener("visibilitychange", onVisibilityChange);
+        return () => document.removeEventListener("visibilitychange", onVisibilityChange);
+    }, []);
+
     useEffect(() => {
         if (isConnecting && !wsConnected) {
             connectWebSocket();
@@ -245,11 +266,39 @@ export const CameraViewer = () => {
             frameData = data;
         }
 
+        // Frame envelope from the ESP32 ("CAM" magic, see FrameEnvelope.h): sequence + capture time
+        let captureTs: number | null = null;
+        const frameView = new DataView(frameData);
+        if (frameData.byteLength >= 48 && frameView.getUint8(0) === 0x43 && frameView.getUint8(1) === 0x41 && frameView.getUint8(2) === 0x4d) {
+            const headerLength = frameView.getUint8(4);
+            const flags = frameView.getUint8(5);
+            if (flags & 0x04) {
+                return; // backfilled after an outage (own sequence space): never drawn over the live picture
+            }
+            const sequence = frameView.getUint32(8, false);
+            const last = lastSequenceRef.current;
+            if (last !== null && sequence > last + 1) {
+                setFramesLost((prev) => prev + (sequence - last - 1));
+            }
+            if (last === null || sequence > last || last - sequence > 1000) {
+                lastSequenceRef.current = sequence; // restart resets, late frames are ignored
+            }
+            if (flags & 0x01) {
+                // Device clock → server clock (epoch µs)
+                const captureUs = frameView.getBigUint64(12, false) + frameView.getBigInt64(28, false);
+                captureTs = Number(captureUs) / 1000;
+            }
+            frameData = frameData.slice(headerLength);
+        }
+
         // Called after actual canvas render so latency reflects real display timing
         const updateLatency = () => {
+            setLatencySource(captureTs !== null ? "capture" : "server");
             setLatency(
-                serverTs !== null
-                    ? Math.round(Date.now() - serverTs!)  // E2E: server-send → browser-render
+                captureTs !== null
+                    ? Math.round(Date.now() - captureTs)  // E2E: camera capture → browser-render
+                    : serverTs !== null
+                    ? Math.round(Date.now() - serverTs!)  // server-send → browser-render
                     : Math.round(performance.now() - receivedAt), // WS-receive → render
             );
         };
@@ -497,7 +546,9 @@ export const CameraViewer = () => {
                                 <p className="text-sm font-semibold text-green-400">{fps} fps</p>
                             </div>
                             <div className="text-center">
-                                <p className="text-xs text-gray-500 mb-1">E2E 지연</p>
+                                <p className="text-xs text-gray-500 mb-1">
+                                    {latencySource === "capture" ? "캡처→표시 지연" : "E2E 지연"}
+                                </p>
                                 <p className={`text-sm font-semibold ${
                                     !wsConnected ? "text-gray-600"
                                     : latency < 30 ? "text-green-400"
@@ -511,6 +562,9 @@ export const CameraViewer = () => {
                                 <p className="text-xs text-gray-500 mb-1">Frames</p>
                                 <p className="text-sm font-semibold text-gray-300">
                                     {frameCount.toLocaleString()}
+                                    {framesLost > 0 && (
+                                        <span className="text-xs text-red-400"> ({framesLost} lost)</span>
+                                    )}
                                 </p>
                             </div>
                             <div className="text-center">
@@ -9,11 +9,51 @@
  */
 
 #include "CameraModule.h"
+#include "Config.h"
+
+#include "esp_timer.h"
+
+#include <MemoryPlan.h>
+
+// ========================================
+// Memory Plan
+// ========================================
+/**
+ * Frame buffers with or without PSRAM (the sketch allocates no other large buffers)
+ */
+static constexpr MemoryPlan planMemory(bool psram) {
+    MemoryPlan plan(MemoryBudget{MEMORY_DRAM_BUDGET, psram ? (uint32_t)MEMORY_PSRAM_BUDGET : 0, MEMORY_RESERVE});
+    FrameBufferRequest request = {};
+    request.bootFrameSize = (uint8_t)FRAME_SIZE;
+    request.streamMaxFrameSize = (uint8_t)FRAME_SIZE;
+    request.fbCount = FB_COUNT;
+    request.minFbCount = 1;
+    request.fbInPsram = FB_IN_PSRAM;
+    request.snapshotFrameSize = (uint8_t)FRAME_SIZE;
+    plan.planFrameBuffers(request);
+    return plan;
+}
+
+static constexpr MemoryPlan kPsramPlan = planMemory(true);
+static constexpr MemoryPlan kDramPlan = planMemory(false);
+
+static_assert(kPsramPlan.fits() && kDramPlan.fits(), "Frame buffers exceed the MEMORY_* budgets in Config.h");
+static_assert(MemoryPlan::worstJpegBytes((uint8_t)FRAME_SIZE, JPEG_QUALITY) <= kDramPlan.frameBuffers().fbBytes,
+              "JPEG_QUALITY can exceed the frame buffer of FRAME_SIZE (raise JPEG_QUALITY)");
 
 // ========================================
 // Constructor
 // ========================================
-CameraModule::CameraModule() : _initialized(false), _frameSize(FRAMESIZE_VGA) {
+CameraModule::CameraModule()
+    : _initialized(false), _frameSize(FRAME_SIZE), _ringConfig(), _ring(_ringConfig) {
+}
+
+// ========================================
+// Configure Frame Ring
+// ========================================
+void CameraModule::setRingConfig(const FrameRingConfig& config) {
+    _ringConfig = config;
+    _ring.configure(config);
 }
 
 // ========================================
@@ -22,7 +62,7 @@ CameraModule::CameraModule() : _initialized(false), _frameSize(FRAMESIZE_VGA) {
 bool CameraModule::init() {
     Serial.println("[Camera] Initializing camera...");
     
-    camera_config_t config;
+    camera_config_t config = {};
     config.ledc_channel = LEDC_CHANNEL_0;
     config.ledc_timer = LEDC_TIMER_0;
     config.pin_d0 = Y2_GPIO_NUM;
@@ -41,24 +81,34 @@ bool CameraModule::init() {
     config.pin_sscb_scl = SIOC_GPIO_NUM;
     config.pin_pwdn = PWDN_GPIO_NUM;
     config.pin_reset = RESET_GPIO_NUM;
-    config.xclk_freq_hz = 20000000;
+    config.xclk_freq_hz = XCLK_FREQ_MHZ * 1000000;
     config.pixel_format = PIXFORMAT_JPEG;
     
-    // Frame size and quality settings based on PSRAM availability
-    if (psramFound()) {
-        config.frame_size = FRAMESIZE_VGA;  // 640x480
-        config.jpeg_quality = 10;           // 0-63, lower means higher quality
-        config.fb_count = 2;                // Double buffering
-        _frameSize = FRAMESIZE_VGA;
-        Serial.println("[Camera] PSRAM found - using VGA quality");
-    } else {
-        config.frame_size = FRAMESIZE_SVGA; // 800x600
-        config.jpeg_quality = 12;
-        config.fb_count = 1;
-        _frameSize = FRAMESIZE_SVGA;
-        Serial.println("[Camera] PSRAM not found - using lower quality");
+    // Boot profile from Config.h; buffer count and placement depend on PSRAM
+    config.frame_size = FRAME_SIZE;
+    config.jpeg_quality = JPEG_QUALITY;     // 0-63, lower means higher quality
+    _frameSize = FRAME_SIZE;
+    
+    // Buffer count and placement from the compile-time plan (the ring tracks what was allocated)
+    const MemoryPlan& plan = USE_PSRAM && psramFound() ? kPsramPlan : kDramPlan;
+    const FrameBufferPlan& buffers = plan.frameBuffers();
+    config.fb_count = buffers.fbCount;
+    config.fb_location = buffers.region == MemoryRegion::Psram ? CAMERA_FB_IN_PSRAM : CAMERA_FB_IN_DRAM;
+    _ringConfig.bufferCount = buffers.fbCount;
+    _ringConfig.usePsram = buffers.region == MemoryRegion::Psram;
+    _ring.configure(_ringConfig);
+    Serial.printf("[Camera] PSRAM %s - %s q%d (%d buffers in %s, %u KB each, q%u+ fits)\n",
+                  psramFound() ? "found" : "not found", getFrameSizeName(), JPEG_QUALITY, config.fb_count,
+                  MemoryPlan::regionName(buffers.region), (unsigned)(buffers.fbBytes / 1024),
+                  MemoryPlan::qualityFloor(buffers.frameSize, buffers.fbBytes));
+    char line[128];
+    if (plan.formatRegion(buffers.region, line, sizeof(line)) > 0) {
+        Serial.printf("[Camera] %s\n", line);
     }
     
+    // Latest-frame grabbing needs at least two buffers (driver falls back otherwise)
+    config.grab_mode = config.fb_count > 1 ? CAMERA_GRAB_LATEST : CAMERA_GRAB_WHEN_EMPTY;
+    
     // Initialize camera
     esp_err_t err = esp_camera_init(&config);
     if (err != ESP_OK) {
@@ -70,6 +120,7 @@ bool CameraModule::init() {
     configureSensor();
     
     _initialized = true;
+    _ring.resetStats((uint64_t)esp_timer_get_time());
     Serial.println("[Camera] Initialized successfully");
     return true;
 }
@@ -118,13 +169,34 @@ camera_fb_t* CameraModule::captureFrame() {
         return NULL;
     }
     
-    camera_fb_t* fb = esp_camera_fb_get();
-    if (!fb) {
-        Serial.println("[Camera] ERROR: Frame capture failed");
-        return NULL;
+    // Skip buffers that aged in the ring (at most one pass over all buffers)
+    for (int attempt = 0; attempt <= _ringConfig.bufferCount; attempt++) {
+        camera_fb_t* fb = esp_camera_fb_get();
+        if (!fb) {
+            Serial.println("[Camera] ERROR: Frame capture failed");
+            return NULL;
+        }
+        
+        uint64_t nowUs = (uint64_t)esp_timer_get_time();
+        _ring.onAcquire(fb, captureMicros(fb), nowUs);
+        if (_ring.checkFresh(fb, captureMicros(fb), nowUs)) {
+            return fb;
+        }
+        releaseFrame(fb);
     }
     
-    return fb;
+    Serial.println("[Camera] ERROR: Only stale frames available");
+    return NULL;
+}
+
+// ========================================
+// Check Frame Freshness
+// ========================================
+bool CameraModule::isFresh(camera_fb_t* fb) {
+    if (fb == NULL) {
+        return false;
+    }
+    return _ring.checkFresh(fb, captureMicros(fb), (uint64_t)esp_timer_get_time());
 }
 
 // ========================================
@@ -132,10 +204,32 @@ camera_fb_t* CameraModule::captureFrame() {
 // ========================================
 void CameraModule::releaseFrame(camera_fb_t* fb) {
     if (fb != NULL) {
+        _ring.onRelease(fb, (uint64_t)esp_timer_get_time());
         esp_camera_fb_return(fb);
     }
 }
 
+// ========================================
+// Frame Ring Statistics
+// ========================================
+uint64_t CameraModule::captureMicros(const camera_fb_t* fb) {
+    return (uint64_t)fb->timestamp.tv_sec * 1000000ULL + fb->timestamp.tv_usec;
+}
+
+void CameraModule::logRingStats() {
+    uint64_t nowUs = (uint64_t)esp_timer_get_time();
+    FrameRingStats stats = _ring.getStats();
+    Serial.printf("[Camera] Ring: acquired=%u stale=%u held=%u/%u\n",
+                  stats.acquired, stats.staleDrops, stats.held, stats.maxHeld);
+    for (size_t i = 0; i < _ring.getSlotCount(); i++) {
+        FrameSlotStats slot = _ring.getSlotStats(i);
+        Serial.printf("[Camera]   fb[%u] occupancy=%u%% acquired=%u stale=%u maxAge=%ums\n",
+                      (unsigned)i, _ring.occupancyPermille(i, nowUs) / 10,
+                      slot.acquisitions, slot.staleDrops, slot.maxAgeMs);
+    }
+    _ring.resetStats(nowUs);
+}
+
 // ========================================
 // Get Frame Size Name
 // ========================================
@@ -2,6 +2,7 @@
  * `CameraModule.h`
  * - ESP32-CAM camera initialization and frame capture module
  * - Handles: Camera config, sensor settings, frame acquisition
+ * - Frame-ring mode: latest-frame grabbing, N buffers in PSRAM, stale-frame dropping
  *
  * @author      Sim Woo-Keun <smileteeth14@gmail.com>
  * @date        2026-02-18 initial version
@@ -17,6 +18,8 @@
 #include "soc/soc.h"
 #include "soc/rtc_cntl_reg.h"
 
+#include <FrameRing.h>
+
 // ========================================
 // Camera Pin Configuration (AI-Thinker ESP32-CAM)
 // ========================================
@@ -49,6 +52,12 @@ public:
      */
     CameraModule();
 
+    /**
+     * Configure frame-ring mode (call before init)
+     * @param config Buffer count, max frame age, PSRAM placement
+     */
+    void setRingConfig(const FrameRingConfig& config);
+
     /**
      * Initialize camera with optimal settings
      * @return true if initialization successful, false otherwise
@@ -57,10 +66,18 @@ public:
 
     /**
      * Capture a single frame from camera
+     * - Buffers older than maxFrameAgeMs are returned to the driver and skipped
      * @return camera_fb_t* Frame buffer pointer (must be released after use)
      */
     camera_fb_t* captureFrame();
 
+    /**
+     * Check a held frame right before sending it
+     * @param fb Frame buffer obtained from captureFrame()
+     * @return false if the frame is older than maxFrameAgeMs (release, do not send)
+     */
+    bool isFresh(camera_fb_t* fb);
+
     /**
      * Release frame buffer back to camera
      * @param fb Frame buffer to release
@@ -79,14 +96,31 @@ public:
      */
     bool isInitialized() const { return _initialized; }
 
+    /**
+     * Get frame ring statistics (per-buffer occupancy, stale drops)
+     */
+    const FrameRing& getRing() const { return _ring; }
+
+    /**
+     * Print per-buffer occupancy statistics and reset counters
+     */
+    void logRingStats();
+
 private:
     /**
      * Configure camera sensor settings for optimal quality
      */
     void configureSensor();
 
+    /**
+     * Capture timestamp of a frame buffer (esp_timer clock, microseconds)
+     */
+    static uint64_t captureMicros(const camera_fb_t* fb);
+
     bool _initialized;
     framesize_t _frameSize;
+    FrameRingConfig _ringConfig;
+    FrameRing _ring;
 };
 
 #endif // CAMERA_MODULE_H
@@ -42,9 +42,16 @@
 #define FRAME_INTERVAL   100              // 프레임 전송 간격 (ms) - 100ms = 10 FPS
 #define TARGET_FPS       10               // 목표 FPS
 
-// Camera Quality
-#define JPEG_QUALITY     12               // JPEG 품질 (0-63, 낮을수록 고품질)
+// Camera Quality (src/Config.h와 같은 부팅 프로파일)
+#define JPEG_QUALITY     25               // JPEG 품질 (0-63, 낮을수록 고품질)
 #define FRAME_SIZE       FRAMESIZE_HVGA   // 해상도: HVGA (480x320)
+#define XCLK_FREQ_MHZ    20               // 센서 클럭 (MHz)
+
+// Frame Ring (latest-frame grabbing)
+#define FB_COUNT          3               // 프레임 버퍼 수 (PSRAM 사용 시)
+#define FB_IN_PSRAM       true            // 프레임 버퍼를 PSRAM에 배치
+#define MAX_FRAME_AGE_MS  200             // 이보다 오래된 프레임은 전송하지 않음 (0 = 비활성화)
+#define RING_STATS_INTERVAL 10000         // 버퍼 점유율 통계 출력 간격 (ms)
 
 // Available Frame Sizes:
 // - FRAMESIZE_QQVGA  (160x120)
@@ -55,6 +62,18 @@
 // - FRAMESIZE_XGA    (1024x768)
 // - FRAMESIZE_SXGA   (1280x1024)
 
+// ========================================
+// Pipeline Configuration (Dual-core capture/upload)
+// - true: 캡처 태스크와 전송 태스크를 서로 다른 코어에서 병렬 실행
+// - ⚠️ Arduino IDE: ../lib/FramePipeline 폴더를 Arduino/libraries 에 복사한 후 활성화하세요
+// ========================================
+#define PIPELINE_ENABLED         false
+#define PIPELINE_QUEUE_DEPTH     1        // 태스크 간 대기 프레임 수 (FB_COUNT - 2 이하 권장)
+#define PIPELINE_DROP_POLICY     DropPolicy::DropOldest  // DropOldest: 최신 프레임 우선, DropNewest: 대기 프레임 우선
+#define PIPELINE_CAPTURE_CORE    1        // 캡처 태스크 코어 (APP_CPU)
+#define PIPELINE_NETWORK_CORE    0        // 전송 태스크 코어 (PRO_CPU, WiFi/lwIP와 동일)
+#define PIPELINE_STATS_INTERVAL  5000     // 파이프라인 통계 출력 간격 (ms)
+
 // ========================================
 // LED Configuration
 // ========================================
@@ -86,21 +105,25 @@
 #define PCLK_GPIO_NUM     22
 
 // ========================================
-// Debug Configuration
+// Debug / Log Configuration
+// - LOG_DEBUG/INFO/WARN/ERROR는 바이너리 레코드(포맷 포인터 + 인자 값)만 링에 기록하고 바로 반환 (락 없음)
+// - 포맷팅과 UART 출력은 낮은 우선순위 로그 태스크가 처리
+//   (115200 baud에서 60바이트 한 줄 ≈ 5 ms 동안 호출 태스크가 막히던 것을 제거)
+// - LOG_MIN_LEVEL 미만 호출은 컴파일 시 제거 (인자도 평가하지 않음)
+// - 링이 가득 차면 새 레코드를 버리고 개수를 로그로 보고 ("[Log] N records dropped")
 // ========================================
 #define SERIAL_BAUD_RATE  115200          // 시리얼 통신 속도
-#define DEBUG_ENABLED     true            // 디버그 로그 활성화
+#define DEBUG_ENABLED     true            // 디버그 로그 활성화 (false = LOG_* 전부 제거)
 
-// Debug 매크로
 #if DEBUG_ENABLED
-  #define DEBUG_PRINT(x)    Serial.print(x)
-  #define DEBUG_PRINTLN(x)  Serial.println(x)
-  #define DEBUG_PRINTF(...)  Serial.printf(__VA_ARGS__)
+  #define LOG_MIN_LEVEL   1               // 0 = DEBUG, 1 = INFO, 2 = WARN, 3 = ERROR
 #else
-  #define DEBUG_PRINT(x)
-  #define DEBUG_PRINTLN(x)
-  #define DEBUG_PRINTF(...)
+  #define LOG_MIN_LEVEL   4
 #endif
+#define LOG_RING_SLOTS        64          // 링 슬롯 수 (2의 거듭제곱, 슬롯당 ≈ 128 bytes 내부 RAM)
+#define LOG_FLUSH_INTERVAL    20          // 로그 태스크가 링을 비우는 간격 (ms)
+#define LOG_TASK_PRIORITY     1           // 캡처/전송 태스크보다 낮게 (idle 바로 위)
+#define LOG_TASK_CORE         0
 
 // ========================================
 // System Configuration
@@ -108,7 +131,11 @@
 #define WATCHDOG_ENABLED  false           // Watchdog 타이머 비활성화 (브라운아웃 방지)
 
 // Memory Configuration
-#define USE_PSRAM         true            // PSRAM 사용 여부
+// - 프레임 버퍼(개수/위치)를 컴파일 타임에 계획해 예산과 비교 (초과 시 빌드 실패), 부팅 시 보고
+#define USE_PSRAM           true          // PSRAM 사용 여부 (보드에 PSRAM이 있어도 false면 DRAM 계획)
+#define MEMORY_DRAM_BUDGET  (180 * 1024)  // WiFi/WebSocket 시작 후 남는 내부 힙 (bytes)
+#define MEMORY_PSRAM_BUDGET (4 * 1024 * 1024)  // PSRAM 크기 (ESP32-CAM 4MB)
+#define MEMORY_RESERVE      (32 * 1024)   // 영역마다 남겨둘 여유 메모리 (bytes)
 
 // ========================================
 // Application Info
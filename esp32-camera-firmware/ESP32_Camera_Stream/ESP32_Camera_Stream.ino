@@ -33,6 +33,12 @@
 #include "CameraModule.h"
 #include "LedModule.h"
 
+#include <AsyncLog.h>
+
+#if PIPELINE_ENABLED
+#include <FramePipeline.h>
+#endif
+
 // ========================================
 // Module Instances
 // ========================================
@@ -43,9 +49,36 @@ LedModule led;
 // Global Variables
 // ========================================
 WebSocketsClient webSocket;
-bool isConnected = false;
+volatile bool isConnected = false;  // Shared between capture and network tasks
 unsigned long lastFrameTime = 0;
 unsigned long frameCount = 0;
+unsigned long lastRingStatsTime = 0;
+
+// ========================================
+// Async Log
+// ========================================
+static_assert((LOG_RING_SLOTS & (LOG_RING_SLOTS - 1)) == 0, "LOG_RING_SLOTS must be a power of two");
+
+LogSlot logSlots[LOG_RING_SLOTS];  // LOG_* records waiting for the log task (internal RAM)
+AsyncLog* asyncLog = NULL;
+
+void writeSerialLog(const char* line, size_t length, void* context) {
+    (void)context;
+    Serial.write((const uint8_t*)line, length);
+}
+
+void initAsyncLog() {
+    AsyncLogConfig config;
+    config.sink = writeSerialLog;
+    config.flushIntervalMs = LOG_FLUSH_INTERVAL;
+    config.writerPriority = LOG_TASK_PRIORITY;
+    config.writerCore = LOG_TASK_CORE;
+    asyncLog = new AsyncLog(config, logSlots, LOG_RING_SLOTS);
+    if (!asyncLog->start()) {
+        Serial.println("[Main] Log task start failed - log lines written from loop()");
+    }
+    AsyncLog::install(asyncLog);
+}
 
 
 // ========================================
@@ -103,31 +136,30 @@ void handleCommand(const char* command) {
 void webSocketEvent(WStype_t type, uint8_t* payload, size_t length) {
     switch (type) {
         case WStype_DISCONNECTED:
-            Serial.println("[WS] Disconnected");
+            LOG_INFO("[WS] Disconnected");
             isConnected = false;
             break;
             
         case WStype_CONNECTED:
-            Serial.printf("[WS] Connected to: %s\n", payload);
+            LOG_INFO("[WS] Connected to: %s", (const char*)payload);
             isConnected = true;
             frameCount = 0;
             
             // Send firmware version to server
-            String versionMsg = "FIRMWARE_VERSION:" + String(APP_VERSION);
-            webSocket.sendTXT(versionMsg);
-            Serial.printf("[WS] Sent firmware version: %s\n", APP_VERSION);
+            webSocket.sendTXT("FIRMWARE_VERSION:" APP_VERSION);
+            LOG_INFO("[WS] Sent firmware version: %s", APP_VERSION);
             
             // Send initial LED status to server
             webSocket.sendTXT(led.getStatusString());
             break;
             
         case WStype_TEXT:
-            Serial.printf("[WS] Received command: %s\n", payload);
+            LOG_INFO("[WS] Received command: %s", (const char*)payload);
             handleCommand((char*)payload);
             break;
             
         case WStype_ERROR:
-            Serial.println("[WS] Error occurred");
+            LOG_WARN("[WS] Error occurred");
             isConnected = false;
             break;
             
@@ -147,7 +179,13 @@ void captureAndSendFrame() {
     // Capture frame using camera module
     camera_fb_t* fb = camera.captureFrame();
     if (!fb) {
-        Serial.println("[Main] Frame capture failed");
+        LOG_WARN("[Main] Frame capture failed");
+        return;
+    }
+    
+    // Never send frames that aged in the buffer ring
+    if (!camera.isFresh(fb)) {
+        camera.releaseFrame(fb);
         return;
     }
     
@@ -157,16 +195,107 @@ void captureAndSendFrame() {
     if (success) {
         frameCount++;
         if (frameCount % 30 == 0) { // Log every 30 frames
-            Serial.printf("[Main] Frame #%lu sent (%u bytes)\n", frameCount, fb->len);
+            LOG_INFO("[Main] Frame #%lu sent (%u bytes)", frameCount, (unsigned)fb->len);
         }
     } else {
-        Serial.println("[Main] Failed to send frame");
+        LOG_WARN("[Main] Failed to send frame");
     }
     
     // Release frame buffer
     camera.releaseFrame(fb);
 }
 
+#if PIPELINE_ENABLED
+// ========================================
+// Pipeline Backends
+// ========================================
+/**
+ * CameraModule frame source for FramePipeline
+ */
+class CameraFrameSource : public FrameSource {
+public:
+    bool acquire(FrameDescriptor& frame) override {
+        camera_fb_t* fb = camera.captureFrame();
+        if (!fb) {
+            return false;
+        }
+        frame.handle = fb;
+        frame.data = fb->buf;
+        frame.length = fb->len;
+        frame.captureUs = (uint64_t)fb->timestamp.tv_sec * 1000000ULL + fb->timestamp.tv_usec;
+        return true;
+    }
+
+    void release(const FrameDescriptor& frame) override {
+        camera.releaseFrame(static_cast<camera_fb_t*>(frame.handle));
+    }
+
+    bool isFresh(const FrameDescriptor& frame) override {
+        return camera.isFresh(static_cast<camera_fb_t*>(frame.handle));
+    }
+};
+
+/**
+ * WebSocket frame sink for FramePipeline
+ * - The network task owns the WebSocket client (loop + send)
+ */
+class WebSocketFrameSink : public FrameSink {
+public:
+    bool isReady() override { return isConnected; }
+
+    bool send(const FrameDescriptor& frame) override {
+        bool success = webSocket.sendBIN(frame.data, frame.length);
+        if (success) {
+            frameCount++;
+        } else {
+            LOG_WARN("[Main] Failed to send frame");
+        }
+        return success;
+    }
+
+    void poll() override { webSocket.loop(); }
+};
+
+CameraFrameSource frameSource;
+WebSocketFrameSink frameSink;
+FramePipeline* pipeline = NULL;
+unsigned long lastStatsTime = 0;
+
+/**
+ * Start dual-core capture/upload pipeline
+ */
+bool startPipeline() {
+    PipelineConfig config;
+    config.queueDepth = PIPELINE_QUEUE_DEPTH;
+    config.dropPolicy = PIPELINE_DROP_POLICY;
+    config.frameIntervalMs = FRAME_INTERVAL;
+    config.captureCore = PIPELINE_CAPTURE_CORE;
+    config.networkCore = PIPELINE_NETWORK_CORE;
+
+    pipeline = new FramePipeline(frameSource, frameSink, config);
+    if (!pipeline->start()) {
+        Serial.println("[Main] Pipeline start failed - falling back to loop() mode");
+        delete pipeline;
+        pipeline = NULL;
+        return false;
+    }
+    Serial.printf("[Main] Pipeline started (capture core %d, network core %d, queue %d)\n",
+                  PIPELINE_CAPTURE_CORE, PIPELINE_NETWORK_CORE, PIPELINE_QUEUE_DEPTH);
+    return true;
+}
+
+/**
+ * Log pipeline counters
+ */
+void logPipelineStats() {
+    PipelineStats stats = pipeline->getStats();
+    Serial.printf("[Pipeline] captured=%u sent=%u fail=%u drop(old=%u new=%u offline=%u stale=%u) depth=%u/%u\n",
+                  stats.captured, stats.sent, stats.sendFailures,
+                  stats.droppedOldest, stats.droppedNewest, stats.droppedOffline, stats.droppedStale,
+                  stats.queueDepth, stats.maxQueueDepth);
+}
+#endif
+
 // ========================================
 // Setup
 // ========================================
@@ -175,8 +304,9 @@ void setup() {
     WRITE_PERI_REG(RTC_CNTL_BROWN_OUT_REG, 0);
     
     // Initialize serial
-    Serial.begin(115200);
-    Serial.setDebugOutput(true);
+    Serial.begin(SERIAL_BAUD_RATE);
+    Serial.setDebugOutput(LOG_MIN_LEVEL == 0);  // ESP-IDF log lines would bypass the log task
+    initAsyncLog();
     Serial.println();
     Serial.println("========================================");
     Serial.println("ESP32-CAM WebSocket Stream Client");
@@ -186,7 +316,12 @@ void setup() {
     // Initialize LED module
     led.init();
     
-    // Initialize camera module
+    // Initialize camera module (frame ring: latest-frame grabbing, buffers in PSRAM)
+    FrameRingConfig ringConfig;
+    ringConfig.bufferCount = FB_COUNT;
+    ringConfig.usePsram = FB_IN_PSRAM;
+    ringConfig.maxFrameAgeMs = MAX_FRAME_AGE_MS;
+    camera.setRingConfig(ringConfig);
     if (!camera.init()) {
         Serial.println("[Main] Camera initialization failed!");
         Serial.println("[Main] System halted.");
@@ -213,6 +348,11 @@ void setup() {
     webSocket.onEvent(webSocketEvent);
     webSocket.setReconnectInterval(5000);
     
+#if PIPELINE_ENABLED
+    // Start capture/upload tasks (WebSocket is serviced by the network task from now on)
+    startPipeline();
+#endif
+    
     Serial.println("[Main] Setup complete!");
     Serial.println("========================================");
 }
@@ -221,6 +361,30 @@ void setup() {
 // Main Loop
 // ========================================
 void loop() {
+    // Log task did not start: LOG_* lines go out from here
+    if (asyncLog != NULL && !asyncLog->isRunning()) {
+        asyncLog->flush();
+    }
+    
+    // Per-buffer occupancy statistics
+    if (millis() - lastRingStatsTime >= RING_STATS_INTERVAL) {
+        camera.logRingStats();
+        lastRingStatsTime = millis();
+    }
+    
+#if PIPELINE_ENABLED
+    // Pipelined mode: capture/network tasks do the work, loop() only reports
+    if (pipeline != NULL) {
+        unsigned long now = millis();
+        if (now - lastStatsTime >= PIPELINE_STATS_INTERVAL) {
+            logPipelineStats();
+            lastStatsTime = now;
+        }
+        delay(100);
+        return;
+    }
+#endif
+    
     // Handle WebSocket events
     webSocket.loop();
     
@@ -9,6 +9,9 @@
  */
 
 #include "LedModule.h"
+#include "Config.h"
+
+#include <AsyncLog.h>
 
 // ========================================
 // Constructor
@@ -31,7 +34,7 @@ void LedModule::init() {
 void LedModule::on() {
     digitalWrite(LED_GPIO_NUM, HIGH);
     _state = true;
-    Serial.println("[LED] Turned ON");
+    LOG_INFO("[LED] Turned ON");
 }
 
 // ========================================
@@ -40,7 +43,7 @@ void LedModule::on() {
 void LedModule::off() {
     digitalWrite(LED_GPIO_NUM, LOW);
     _state = false;
-    Serial.println("[LED] Turned OFF");
+    LOG_INFO("[LED] Turned OFF");
 }
 
 // ========================================
@@ -68,6 +71,6 @@ void LedModule::setState(bool state) {
 // ========================================
 // Get Status String
 // ========================================
-String LedModule::getStatusString() const {
+const char* LedModule::getStatusString() const {
     return _state ? "LED_STATUS:ON" : "LED_STATUS:OFF";
 }
@@ -63,10 +63,10 @@ public:
     bool getState() const { return _state; }
 
     /**
-     * Get LED status as string
+     * Get LED status as string (static literal, nothing allocated per reply)
      * @return "LED_STATUS:ON" or "LED_STATUS:OFF"
      */
-    String getStatusString() const;
+    const char* getStatusString() const;
 
 private:
     bool _state;
@@ -0,0 +1,597 @@
+/**
+ * `bench_main.cpp`
+ * - Microbenchmarks for the firmware hot paths (native host build, CMake target firmware_bench)
+ * - Stages: frame envelope encode, JPEG marker scan (SOF) and DC decode (the frame validation
+ *   the motion gate relies on), motion scoring, luminance side-stream plane (resample + delta
+ *   code), command dispatch (text and binary form), frame queue and control queue push/pop
+ * - Corpus: `--corpus DIR` loads every *.jpg below DIR (ESP32-CAM captures, replay clips);
+ *   without it, OV2640-like fixtures (YUV422) at QVGA/HVGA/VGA/SVGA × quality 10/25/40
+ * - Each stage batch is paired with a calibration batch (CRC-32 loop); the baseline compares
+ *   the stage/calibration ratio, so one stored baseline holds across hosts of the same kind
+ * - Stages run in --repeat passes (default 3, 5 when writing a baseline) and keep their best ratio
+ * - Run: firmware_bench [--json out.json] [--baseline bench/baseline.json] [--tolerance 30]
+ *        firmware_bench --write-baseline bench/baseline.json
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <CommandRouter.h>
+#include <ControlQueue.h>
+#include <FrameEnvelope.h>
+#include <FramePipeline.h>
+#include <JpegDcDecoder.h>
+#include <LumaStream.h>
+#include <MotionGate.h>
+#include <SensorWindow.h>
+
+#include "jpeg_fixture.h"
+
+// Keeps results alive so the optimizer cannot drop the measured work
+static volatile uint32_t sink;
+
+// ========================================
+// Timing
+// ========================================
+static const int kRuns = 9;                 // batch pairs per stage
+static const double kBatchNs = 2e6;         // target batch duration
+static const int kConfirmRounds = 3;        // re-measurements before a regression counts
+
+/**
+ * Stage result
+ */
+struct StageResult {
+    std::string name;
+    double nsPerOp;
+    double relative;           // nsPerOp / calibration
+    double bytesPerOp;         // input bytes per operation (0 = not a byte stream)
+};
+
+/**
+ * Timing of one stage
+ */
+struct Timing {
+    double nsPerOp;            // fastest stage batch
+    double relative;           // nsPerOp / calibrationNs
+    double calibrationNs;      // fastest calibration batch
+};
+
+static double nowNs() {
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * Calibration workload: bitwise CRC-32 over 1 KB (integer ALU, branches, L1 loads)
+ */
+static void calibrationOp() {
+    static uint8_t data[1024];
+    static bool ready = false;
+    if (!ready) {
+        for (size_t i = 0; i < sizeof(data); i++) {
+            data[i] = (uint8_t)(i * 131 + 7);
+        }
+        ready = true;
+    }
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < sizeof(data); i++) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+        }
+    }
+    sink = ~crc;
+}
+
+/**
+ * Calls per batch so one batch of fn() takes ~kBatchNs
+ */
+template <typename Fn>
+static uint64_t batchSize(Fn&& fn) {
+    uint64_t batch = 1;
+    for (;;) {
+        double start = nowNs();
+        for (uint64_t i = 0; i < batch; i++) {
+            fn();
+        }
+        double elapsed = nowNs() - start;
+        if (elapsed >= kBatchNs / 4) {
+            return (uint64_t)(batch * kBatchNs / elapsed) + 1;
+        }
+        batch *= 4;
+    }
+}
+
+template <typename Fn>
+static double timeBatch(Fn&& fn, uint64_t batch) {
+    double start = nowNs();
+    for (uint64_t i = 0; i < batch; i++) {
+        fn();
+    }
+    return (nowNs() - start) / batch;
+}
+
+/**
+ * Time fn() in kRuns batches, each directly followed by a calibration batch
+ * - Minimums filter out preemption and cache-cold batches
+ * - Both minimums come from the same window, so a slow phase of the host (frequency
+ *   scaling, a busy neighbour) shifts numerator and denominator alike
+ */
+template <typename Fn>
+static Timing measure(Fn&& fn) {
+    static const uint64_t calibrationBatch = batchSize(calibrationOp);
+    uint64_t batch = batchSize(fn);
+    Timing timing = {0, 0, 0};
+    for (int run = 0; run < kRuns; run++) {
+        double ns = timeBatch(fn, batch);
+        double calibration = timeBatch(calibrationOp, calibrationBatch);
+        timing.nsPerOp = (run == 0 || ns < timing.nsPerOp) ? ns : timing.nsPerOp;
+        timing.calibrationNs = (run == 0 || calibration < timing.calibrationNs) ? calibration : timing.calibrationNs;
+    }
+    timing.relative = timing.nsPerOp / timing.calibrationNs;
+    return timing;
+}
+
+// ========================================
+// Corpus
+// ========================================
+/**
+ * One JPEG of the corpus (two consecutive frames so motion scoring sees change)
+ */
+struct Fixture {
+    std::string name;
+    std::vector<uint8_t> frames[2];
+};
+
+static bool readFile(const std::string& path, std::vector<uint8_t>& out) {
+    FILE* file = fopen(path.c_str(), "rb");
+    if (file == NULL) {
+        return false;
+    }
+    uint8_t buffer[16384];
+    size_t n;
+    out.clear();
+    while ((n = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        out.insert(out.end(), buffer, buffer + n);
+    }
+    fclose(file);
+    return !out.empty();
+}
+
+static void listJpegs(const std::string& dir, std::vector<std::string>& paths) {
+    DIR* handle = opendir(dir.c_str());
+    if (handle == NULL) {
+        return;
+    }
+    while (struct dirent* entry = readdir(handle)) {
+        std::string name = entry->d_name;
+        if (name == "." || name == "..") {
+            continue;
+        }
+        std::string path = dir + "/" + name;
+        struct stat info;
+        if (stat(path.c_str(), &info) != 0) {
+            continue;
+        }
+        if (S_ISDIR(info.st_mode)) {
+            listJpegs(path, paths);
+        } else if (name.size() > 4 && (name.compare(name.size() - 4, 4, ".jpg") == 0 ||
+                                       name.compare(name.size() - 4, 4, ".JPG") == 0)) {
+            paths.push_back(path);
+        }
+    }
+    closedir(handle);
+}
+
+/**
+ * Captured corpus: consecutive files pair up as (frame, next frame), named after size and file
+ */
+static std::vector<Fixture> loadCorpus(const std::string& dir) {
+    std::vector<std::string> paths;
+    listJpegs(dir, paths);
+    std::sort(paths.begin(), paths.end());
+    std::vector<Fixture> fixtures;
+    for (size_t i = 0; i < paths.size(); i++) {
+        Fixture fixture;
+        uint16_t width = 0, height = 0;
+        if (!readFile(paths[i], fixture.frames[0]) ||
+            !SensorWindow::jpegDimensions(fixture.frames[0].data(), fixture.frames[0].size(), width, height)) {
+            fprintf(stderr, "skipping %s (not a JPEG)\n", paths[i].c_str());
+            continue;
+        }
+        if (i + 1 >= paths.size() || !readFile(paths[i + 1], fixture.frames[1])) {
+            fixture.frames[1] = fixture.frames[0];
+        }
+        size_t slash = paths[i].find_last_of('/');
+        std::string stem = paths[i].substr(slash + 1, paths[i].size() - slash - 5);
+        char name[96];
+        snprintf(name, sizeof(name), "%ux%u_%s", width, height, stem.c_str());
+        fixture.name = name;
+        fixtures.push_back(fixture);
+    }
+    return fixtures;
+}
+
+/**
+ * Synthetic corpus: the replay harness scene, OV2640 quality mapped as in ReplayCamera
+ */
+static std::vector<Fixture> makeCorpus() {
+    struct Size {
+        const char* name;
+        int width;
+        int height;
+    };
+    static const Size sizes[] = { {"QVGA", 320, 240}, {"HVGA", 480, 320}, {"VGA", 640, 480}, {"SVGA", 800, 600} };
+    static const int qualities[] = { 10, 25, 40 };   // OV2640 0-63, lower = better
+
+    std::vector<Fixture> fixtures;
+    for (const Size& size : sizes) {
+        Scene background = makeBackground(size.width, size.height);
+        for (int quality : qualities) {
+            FixtureEncoder encoder(100 - quality * 3 / 2, FixtureSampling::Yuv422);
+            Fixture fixture;
+            char name[32];
+            snprintf(name, sizeof(name), "%s_q%d", size.name, quality);
+            fixture.name = name;
+            for (int f = 0; f < 2; f++) {
+                Scene scene = makeFrame(background, 11 + f, 2, 0, size.width / 4 + f * size.width / 8,
+                                        size.height / 3, size.width / 6, size.height / 3);
+                fixture.frames[f] = encoder.encode(scene);
+            }
+            fixtures.push_back(fixture);
+        }
+    }
+    return fixtures;
+}
+
+// ========================================
+// Stages
+// ========================================
+static void noopHandler(const CommandArgs& args, CommandReply& reply) {
+    (void)args;
+    reply.append("OK");
+}
+
+static void statusHandler(const CommandArgs& args, CommandReply& reply) {
+    reply.appendf("DEMAND_STATUS:{\"argument\":\"%s\"}", args.argument);
+}
+
+// Same names and order as the firmware table (the text lookup walks it)
+static constexpr CommandEntry kBenchCommands[] = {
+    { 1, "LED_ON", noopHandler },
+    { 2, "LED_OFF", noopHandler },
+    { 3, "LED_STATUS", noopHandler },
+    { 4, "STATS", noopHandler },
+    { 5, "REC_LIST", noopHandler },
+    { 6, "REC_EXPORT", noopHandler },
+    { 7, "ROI", noopHandler },
+    { 8, "ROI_OFF", noopHandler },
+    { 9, "DEMAND", statusHandler },
+};
+static_assert(CommandRouter::isValidTable(kBenchCommands), "bench table mirrors the firmware table");
+
+/**
+ * One pass over the stages accepted by selected()
+ * - Results merge into results by name, keeping the best ratio seen so far
+ * - calibrationNs tracks the fastest calibration batch
+ */
+static void runStages(const std::vector<Fixture>& fixtures, const std::function<bool(const std::string&)>& selected,
+                      std::vector<StageResult>& results, double& calibrationNs) {
+    auto add = [&](const std::string& name, double bytes, auto&& fn) {
+        if (!selected(name)) {
+            return;
+        }
+        Timing timing = measure(fn);
+        calibrationNs = (calibrationNs == 0 || timing.calibrationNs < calibrationNs) ? timing.calibrationNs : calibrationNs;
+        StageResult result = {name, timing.nsPerOp, timing.relative, bytes};
+        for (StageResult& existing : results) {
+            if (existing.name == name) {
+                existing = result.relative < existing.relative ? result : existing;
+                return;
+            }
+        }
+        results.push_back(result);
+    };
+
+    // Envelope header in front of every uploaded frame
+    {
+        FrameHeader header = {};
+        header.flags = kEnvelopeClockSynced | kEnvelopeMotion;
+        header.jpegQuality = 25;
+        header.payloadLength = 18000;
+        header.width = 480;
+        header.height = 320;
+        uint8_t out[FrameEnvelope::kHeaderSize];
+        add("envelope_encode", 0, [&]() {
+            header.sequence++;
+            header.captureUs += 100000;
+            header.sendUs = header.captureUs + 4000;
+            sink = (uint32_t)FrameEnvelope::encode(header, out, sizeof(out)) + out[9];
+        });
+    }
+
+    // Command dispatch: last table entry with an argument (longest lookup + copy + reply)
+    {
+        CommandRouter router(kBenchCommands, sizeof(kBenchCommands) / sizeof(kBenchCommands[0]));
+        static const char text[] = "DEMAND:1:2";
+        add("command_text", 0, [&]() {
+            sink = (uint32_t)router.dispatchText(text, sizeof(text) - 1) + (uint32_t)router.reply().length();
+        });
+        uint8_t binary[32];
+        size_t binaryLength = CommandRouter::encodeBinary(9, "1:2", 3, binary, sizeof(binary));
+        add("command_binary", 0, [&]() {
+            sink = (uint32_t)router.dispatchBinary(binary, binaryLength) + (uint32_t)router.reply().length();
+        });
+    }
+
+    // Capture → network task queue (one push + one pop per frame)
+    {
+        FrameQueue queue(2, DropPolicy::DropOldest);
+        FrameDescriptor frame = {};
+        FrameDescriptor out = {};
+        FrameDescriptor dropped = {};
+        add("frame_queue", 0, [&]() {
+            frame.sequence++;
+            queue.push(frame, dropped);
+            queue.pop(out, 0);
+            sink = out.sequence;
+        });
+    }
+
+    // Command replies waiting for the next frame part
+    {
+        static char storage[4 * 1024];
+        ControlQueue queue(storage, 4, 1024);
+        static const char reply[] = "LED_STATUS:ON";
+        add("control_queue", 0, [&]() {
+            const char* text = NULL;
+            size_t length = 0;
+            queue.push(reply, sizeof(reply) - 1, ControlPriority::High);
+            queue.front(text, length);
+            queue.pop();
+            sink = (uint32_t)length;
+        });
+    }
+
+    // Per fixture: SOF scan, DC decode, motion scoring of the decoded thumbnail
+    JpegDcDecoder decoder;
+    for (const Fixture& fixture : fixtures) {
+        const std::vector<uint8_t>& jpeg = fixture.frames[0];
+        add("jpeg_scan/" + fixture.name, 0, [&]() {
+            uint16_t width = 0, height = 0;
+            SensorWindow::jpegDimensions(jpeg.data(), jpeg.size(), width, height);
+            sink = width + height;
+        });
+
+        uint16_t width = 0, height = 0;
+        SensorWindow::jpegDimensions(jpeg.data(), jpeg.size(), width, height);
+        size_t blocks = (size_t)((width + 7) / 8) * ((height + 7) / 8);
+        std::vector<uint8_t> thumbnails[2] = { std::vector<uint8_t>(blocks), std::vector<uint8_t>(blocks) };
+        bool decoded = true;
+        for (int f = 0; f < 2; f++) {
+            decoded = decoded && decoder.decode(fixture.frames[f].data(), fixture.frames[f].size(),
+                                                thumbnails[f].data(), blocks) == JpegDcError::None;
+        }
+        if (!decoded) {
+            fprintf(stderr, "skipping decode/score of %s (unsupported JPEG)\n", fixture.name.c_str());
+            continue;
+        }
+        uint16_t widthBlocks = decoder.getWidthBlocks();
+        uint16_t heightBlocks = decoder.getHeightBlocks();
+
+        add("jpeg_decode/" + fixture.name, (double)jpeg.size(), [&]() {
+            sink = (uint32_t)decoder.decode(jpeg.data(), jpeg.size(), thumbnails[0].data(), blocks);
+        });
+
+        MotionGateConfig config;
+        config.maxBlocks = blocks;
+        MotionGate gate(config);
+        uint32_t nowMs = 0;
+        int toggle = 0;
+        add("motion_score/" + fixture.name, 0, [&]() {
+            nowMs += 100;
+            toggle ^= 1;
+            sink = gate.evaluateThumbnail(thumbnails[toggle].data(), widthBlocks, heightBlocks, nowMs).score;
+        });
+
+        // Side-stream plane of the thumbnail: fit in 80 × 60 (never upscaled) + delta code against the other frame
+        uint16_t lumaWidth = 0, lumaHeight = 0;
+        LumaCodec::fitSize(widthBlocks, heightBlocks, 80, 60, lumaWidth, lumaHeight);
+        const size_t pixels = (size_t)lumaWidth * lumaHeight;
+        std::vector<uint8_t> plane(pixels), reference(pixels, 0), payload(LumaCodec::maxPayload(pixels));
+        std::vector<uint32_t> scratch(2 * lumaWidth);
+        add("luma_plane/" + fixture.name, 0, [&]() {
+            toggle ^= 1;
+            LumaCodec::resample(thumbnails[toggle].data(), widthBlocks, heightBlocks, plane.data(), lumaWidth,
+                                lumaHeight, scratch.data());
+            sink = (uint32_t)LumaCodec::encodeDelta(plane.data(), reference.data(), pixels, 2, payload.data(),
+                                                    payload.size());
+        });
+    }
+}
+
+// ========================================
+// Baseline
+// ========================================
+/**
+ * Load a baseline written by --write-baseline (one stage per line)
+ */
+static bool loadBaseline(const std::string& path, std::map<std::string, double>& relative) {
+    FILE* file = fopen(path.c_str(), "r");
+    if (file == NULL) {
+        return false;
+    }
+    char line[512];
+    while (fgets(line, sizeof(line), file) != NULL) {
+        char name[256];
+        double ns = 0, rel = 0;
+        if (sscanf(line, " \"%255[^\"]\": {\"nsPerOp\": %lf, \"relative\": %lf", name, &ns, &rel) == 3) {
+            relative[name] = rel;
+        }
+    }
+    fclose(file);
+    return !relative.empty();
+}
+
+/**
+ * Machine-readable results (also the baseline format)
+ * - change/regressed only when a baseline was given and lists the stage
+ */
+static bool writeJson(const std::string& path, const std::vector<StageResult>& results, double calibrationNs,
+                      const char* corpus, const std::map<std::string, double>& baseline, double tolerance) {
+    FILE* file = fopen(path.c_str(), "w");
+    if (file == NULL) {
+        return false;
+    }
+    fprintf(file, "{\n  \"calibrationNs\": %.1f,\n  \"corpus\": \"%s\",\n  \"stages\": {\n", calibrationNs, corpus);
+    for (size_t i = 0; i < results.size(); i++) {
+        const StageResult& r = results[i];
+        fprintf(file, "    \"%s\": {\"nsPerOp\": %.1f, \"relative\": %.5f, \"mbPerS\": %.1f", r.name.c_str(),
+                r.nsPerOp, r.relative, r.bytesPerOp > 0 ? r.bytesPerOp * 1000.0 / r.nsPerOp : 0.0);
+        auto it = baseline.find(r.name);
+        if (it != baseline.end()) {
+            double change = 100.0 * (r.relative / it->second - 1.0);
+            fprintf(file, ", \"baseline\": %.5f, \"changePct\": %.1f, \"regressed\": %s", it->second, change,
+                    change > tolerance ? "true" : "false");
+        }
+        fprintf(file, "}%s\n", i + 1 < results.size() ? "," : "");
+    }
+    fprintf(file, "  }\n}\n");
+    fclose(file);
+    return true;
+}
+
+static void usage(const char* program) {
+    fprintf(stderr, "usage: %s [--corpus DIR] [--json FILE] [--baseline FILE] [--tolerance PCT]\n"
+                    "       %*s [--repeat N] [--write-baseline FILE] [--filter PREFIX]\n",
+            program, (int)strlen(program), "");
+}
+
+int main(int argc, char** argv) {
+    std::string corpusDir, jsonPath, baselinePath, writePath, filter;
+    double tolerance = 30.0;
+    int repeat = 0;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--corpus" && hasValue) {
+            corpusDir = argv[++i];
+        } else if (arg == "--json" && hasValue) {
+            jsonPath = argv[++i];
+        } else if (arg == "--baseline" && hasValue) {
+            baselinePath = argv[++i];
+        } else if (arg == "--write-baseline" && hasValue) {
+            writePath = argv[++i];
+        } else if (arg == "--tolerance" && hasValue) {
+            tolerance = atof(argv[++i]);
+        } else if (arg == "--repeat" && hasValue) {
+            repeat = std::max(1, atoi(argv[++i]));
+        } else if (arg == "--filter" && hasValue) {
+            filter = argv[++i];
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    if (repeat == 0) {
+        repeat = writePath.empty() ? 3 : 5;   // the baseline is the bar every later run must meet
+    }
+
+    std::vector<Fixture> fixtures = corpusDir.empty() ? makeCorpus() : loadCorpus(corpusDir);
+    if (fixtures.empty()) {
+        fprintf(stderr, "no JPEG files in %s\n", corpusDir.c_str());
+        return 2;
+    }
+
+    std::map<std::string, double> baseline;
+    if (!baselinePath.empty() && !loadBaseline(baselinePath, baseline)) {
+        fprintf(stderr, "cannot read baseline %s\n", baselinePath.c_str());
+        return 2;
+    }
+
+    // Several passes, best ratio per stage
+    double calibrationNs = 0;
+    std::vector<StageResult> results;
+    auto filtered = [&](const std::string& name) { return name.compare(0, filter.size(), filter) == 0; };
+    for (int pass = 0; pass < repeat; pass++) {
+        runStages(fixtures, filtered, results, calibrationNs);
+    }
+
+    auto regressed = [&](const StageResult& r) {
+        auto it = baseline.find(r.name);
+        return it != baseline.end() && 100.0 * (r.relative / it->second - 1.0) > tolerance;
+    };
+
+    // A slow phase of the host can outlast one stage's passes: re-measure suspects before failing
+    for (int round = 0; round < kConfirmRounds; round++) {
+        std::set<std::string> suspects;
+        for (const StageResult& r : results) {
+            if (regressed(r)) {
+                suspects.insert(r.name);
+            }
+        }
+        if (suspects.empty()) {
+            break;
+        }
+        printf("re-measuring %u stage(s) over tolerance (round %d)\n", (unsigned)suspects.size(), round + 1);
+        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+        runStages(fixtures, [&](const std::string& name) { return suspects.count(name) > 0; }, results, calibrationNs);
+    }
+
+    printf("calibration %.1f ns (%s corpus, %u fixtures)\n", calibrationNs,
+           corpusDir.empty() ? "synthetic" : corpusDir.c_str(), (unsigned)fixtures.size());
+    printf("%-28s %11s %9s %9s %9s %8s\n", "stage", "ns/op", "MB/s", "relative", "baseline", "change");
+    int regressions = 0;
+    for (const StageResult& r : results) {
+        printf("%-28s %11.1f ", r.name.c_str(), r.nsPerOp);
+        if (r.bytesPerOp > 0) {
+            printf("%9.1f ", r.bytesPerOp * 1000.0 / r.nsPerOp);
+        } else {
+            printf("%9s ", "-");
+        }
+        printf("%9.4f ", r.relative);
+        auto it = baseline.find(r.name);
+        if (it == baseline.end()) {
+            printf("%9s %8s\n", "-", "");
+            continue;
+        }
+        regressions += regressed(r) ? 1 : 0;
+        printf("%9.4f %+7.1f%%%s\n", it->second, 100.0 * (r.relative / it->second - 1.0),
+               regressed(r) ? "  REGRESSION" : "");
+    }
+
+    const char* corpusName = corpusDir.empty() ? "synthetic" : corpusDir.c_str();
+    if (!jsonPath.empty() && !writeJson(jsonPath, results, calibrationNs, corpusName, baseline, tolerance)) {
+        fprintf(stderr, "cannot write %s\n", jsonPath.c_str());
+        return 2;
+    }
+    if (!writePath.empty()) {
+        if (!writeJson(writePath, results, calibrationNs, corpusName, {}, tolerance)) {
+            fprintf(stderr, "cannot write %s\n", writePath.c_str());
+            return 2;
+        }
+        printf("baseline written to %s\n", writePath.c_str());
+    }
+    if (regressions > 0) {
+        printf("%d stage(s) more than %.0f%% slower than the baseline\n", regressions, tolerance);
+        return 1;
+    }
+    return 0;
+}
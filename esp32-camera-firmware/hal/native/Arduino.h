@@ -0,0 +1,116 @@
+/**
+ * `Arduino.h`
+ * - Native (Linux host) stand-in for the subset of the Arduino core used by src/main.cpp
+ * - Serial prints to stdout, time comes from the host steady clock (see esp_timer.h)
+ * - Only built by the replay environment (platformio.ini [env:replay])
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#ifndef NATIVE_ARDUINO_H
+#define NATIVE_ARDUINO_H
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <string>
+
+#include "esp_timer.h"
+
+#define HIGH    1
+#define LOW     0
+#define OUTPUT  0x03
+
+// ========================================
+// Time / GPIO / Memory
+// ========================================
+unsigned long millis();
+void delay(uint32_t ms);
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+bool psramFound();
+void* ps_malloc(size_t size);
+
+// ========================================
+// String (subset)
+// ========================================
+class String {
+public:
+    String(const char* text = "") : _text(text != NULL ? text : "") {}
+    String(const std::string& text) : _text(text) {}
+    explicit String(int value) : _text(std::to_string(value)) {}
+    explicit String(unsigned value) : _text(std::to_string(value)) {}
+    explicit String(long value) : _text(std::to_string(value)) {}
+    explicit String(unsigned long value) : _text(std::to_string(value)) {}
+
+    const char* c_str() const { return _text.c_str(); }
+    size_t length() const { return _text.size(); }
+    bool startsWith(const char* prefix) const { return _text.rfind(prefix, 0) == 0; }
+    bool operator==(const char* other) const { return _text == other; }
+    bool operator==(const String& other) const { return _text == other._text; }
+    String operator+(const String& other) const { return String(_text + other._text); }
+
+private:
+    std::string _text;
+};
+
+// ========================================
+// IPAddress (subset)
+// ========================================
+class IPAddress {
+public:
+    IPAddress() : _address(0) {}
+    IPAddress(uint32_t address) : _address(address) {}
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d)
+        : _address((uint32_t)a | ((uint32_t)b << 8) | ((uint32_t)c << 16) | ((uint32_t)d << 24)) {}
+
+    operator uint32_t() const { return _address; }
+    String toString() const;
+
+private:
+    uint32_t _address;     // network byte order, like the ESP32 core
+};
+
+// ========================================
+// Serial
+// ========================================
+class HardwareSerial {
+public:
+    void begin(unsigned long baud) { (void)baud; }
+    void setDebugOutput(bool enable) { (void)enable; }
+    size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+    size_t print(const char* text);
+    size_t print(const String& text) { return print(text.c_str()); }
+    size_t print(int value);
+    size_t println(const char* text = "");
+    size_t println(const String& text) { return println(text.c_str()); }
+    size_t println(int value);
+    size_t write(const uint8_t* data, size_t length);
+};
+
+extern HardwareSerial Serial;
+
+// ========================================
+// ESP (chip/heap info)
+// ========================================
+class EspClass {
+public:
+    uint32_t getFreeHeap() const { return 180 * 1024; }      // typical after WiFi + camera init
+    uint32_t getMinFreeHeap() const { return 160 * 1024; }
+    uint32_t getMaxAllocHeap() const { return 110 * 1024; }
+    uint32_t getPsramSize() const { return 4 * 1024 * 1024; }
+    uint32_t getFreePsram() const { return 3 * 1024 * 1024; }
+    uint32_t getMinFreePsram() const { return 3 * 1024 * 1024; }
+    uint32_t getMaxAllocPsram() const { return 3 * 1024 * 1024; }
+};
+
+extern EspClass ESP;
+
+#endif // NATIVE_ARDUINO_H
@@ -0,0 +1,302 @@
+/**
+ * `NativeArduino.cpp`
+ * - Native stand-ins for the Arduino core, esp_timer, WiFi, Preferences and SD_MMC
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#include "Arduino.h"
+#include "Preferences.h"
+#include "SD_MMC.h"
+#include "WiFi.h"
+#include "ReplayHarness.h"
+
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+HardwareSerial Serial;
+EspClass ESP;
+WiFiClass WiFi;
+SDMMCFS SD_MMC;
+
+static std::mutex serialMutex;
+
+// ========================================
+// Time
+// ========================================
+int64_t esp_timer_get_time() {
+    static const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+unsigned long millis() {
+    return (unsigned long)(esp_timer_get_time() / 1000);
+}
+
+void delay(uint32_t ms) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+// ========================================
+// GPIO / Memory
+// ========================================
+void pinMode(uint8_t pin, uint8_t mode) {
+    (void)pin;
+    (void)mode;
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+    (void)pin;
+    (void)value;
+}
+
+bool psramFound() {
+    return true;  // ESP32-CAM (AI-Thinker) has 4 MB PSRAM
+}
+
+void* ps_malloc(size_t size) {
+    return malloc(size);
+}
+
+// ========================================
+// Serial
+// ========================================
+size_t HardwareSerial::printf(const char* format, ...) {
+    if (harnessConfig().quiet) {
+        return 0;
+    }
+    std::lock_guard<std::mutex> lock(serialMutex);
+    va_list args;
+    va_start(args, format);
+    int written = vprintf(format, args);
+    va_end(args);
+    fflush(stdout);
+    return written > 0 ? (size_t)written : 0;
+}
+
+size_t HardwareSerial::write(const uint8_t* data, size_t length) {
+    if (harnessConfig().quiet) {
+        return 0;
+    }
+    std::lock_guard<std::mutex> lock(serialMutex);
+    size_t written = fwrite(data, 1, length, stdout);
+    fflush(stdout);
+    return written;
+}
+
+size_t HardwareSerial::print(const char* text) {
+    return printf("%s", text);
+}
+
+size_t HardwareSerial::print(int value) {
+    return printf("%d", value);
+}
+
+size_t HardwareSerial::println(const char* text) {
+    return printf("%s\n", text);
+}
+
+size_t HardwareSerial::println(int value) {
+    return printf("%d\n", value);
+}
+
+// ========================================
+// IPAddress
+// ========================================
+String IPAddress::toString() const {
+    char text[16];
+    snprintf(text, sizeof(text), "%u.%u.%u.%u", _address & 0xFF, (_address >> 8) & 0xFF,
+             (_address >> 16) & 0xFF, _address >> 24);
+    return String(text);
+}
+
+// ========================================
+// WiFi
+// ========================================
+// The emulated AP (the lease points at the host, where the sink and viewers run)
+static const uint8_t kApBssid[6] = {0x02, 0xCA, 0xFE, 0x00, 0x00, 0x01};
+static const int32_t kApChannel = 6;
+static const IPAddress kLeaseIp(127, 0, 0, 1);
+static const IPAddress kLeaseGateway(127, 0, 0, 1);
+static const IPAddress kLeaseSubnet(255, 0, 0, 0);
+
+wl_status_t WiFiClass::begin(const char* ssid, const char* password, int32_t channel,
+                             const uint8_t* bssid, bool connect) {
+    (void)ssid;
+    (void)password;
+    const HarnessConfig& config = harnessConfig();
+    bool known = channel == kApChannel && bssid != NULL && memcmp(bssid, kApBssid, sizeof(kApBssid)) == 0;
+    _unreachable = (channel != 0 && channel != kApChannel) ||
+                   (bssid != NULL && memcmp(bssid, kApBssid, sizeof(kApBssid)) != 0);
+    if (!connect || _unreachable) {
+        _associatedAtUs = -1;
+        return WL_DISCONNECTED;
+    }
+    int64_t startUs = esp_timer_get_time();
+    if (startUs < (int64_t)config.apDownMs * 1000) {
+        startUs = (int64_t)config.apDownMs * 1000;
+    }
+    uint32_t joinMs = (known ? 0 : config.wifiScanMs) + config.wifiJoinMs + (_staticIp ? 0 : config.wifiDhcpMs);
+    _associatedAtUs = startUs + (int64_t)joinMs * 1000;
+    return status();
+}
+
+bool WiFiClass::config(IPAddress local, IPAddress gateway, IPAddress subnet, IPAddress dns1) {
+    (void)gateway;
+    (void)subnet;
+    (void)dns1;
+    _staticIp = (uint32_t)local != 0;
+    return true;
+}
+
+bool WiFiClass::disconnect(bool wifiOff, bool eraseAp) {
+    (void)wifiOff;
+    (void)eraseAp;
+    _associatedAtUs = -1;
+    return true;
+}
+
+wl_status_t WiFiClass::status() {
+    int64_t associatedAtUs = _associatedAtUs;
+    if (associatedAtUs >= 0 && esp_timer_get_time() >= associatedAtUs) {
+        return WL_CONNECTED;
+    }
+    return _unreachable ? WL_NO_SSID_AVAIL : WL_DISCONNECTED;
+}
+
+IPAddress WiFiClass::localIP() {
+    return status() == WL_CONNECTED ? kLeaseIp : IPAddress();
+}
+
+IPAddress WiFiClass::gatewayIP() {
+    return status() == WL_CONNECTED ? kLeaseGateway : IPAddress();
+}
+
+IPAddress WiFiClass::subnetMask() {
+    return status() == WL_CONNECTED ? kLeaseSubnet : IPAddress();
+}
+
+IPAddress WiFiClass::dnsIP(uint8_t index) {
+    (void)index;
+    return gatewayIP();
+}
+
+uint8_t* WiFiClass::BSSID() {
+    static uint8_t bssid[6];
+    memcpy(bssid, kApBssid, sizeof(bssid));
+    return status() == WL_CONNECTED ? bssid : NULL;
+}
+
+int32_t WiFiClass::channel() {
+    return status() == WL_CONNECTED ? kApChannel : 0;
+}
+
+int8_t WiFiClass::RSSI() const {
+    return harnessConfig().rssiDbm;
+}
+
+// ========================================
+// Preferences
+// ========================================
+// "<namespace>/<key>" -> blob; loaded from / written through to --nvs FILE when given
+static std::mutex nvsMutex;
+static std::map<std::string, std::vector<uint8_t>> nvsStore;
+static bool nvsLoaded = false;
+
+static void loadNvs() {
+    if (nvsLoaded) {
+        return;
+    }
+    nvsLoaded = true;
+    const std::string& path = harnessConfig().nvsPath;
+    FILE* file = path.empty() ? NULL : fopen(path.c_str(), "r");
+    if (file == NULL) {
+        return;
+    }
+    char key[64];
+    char hex[1024];
+    while (fscanf(file, "%63s %1023s", key, hex) == 2) {
+        std::vector<uint8_t> value;
+        for (size_t i = 0; hex[i] != '\0' && hex[i + 1] != '\0'; i += 2) {
+            unsigned byte = 0;
+            sscanf(hex + i, "%2x", &byte);
+            value.push_back((uint8_t)byte);
+        }
+        nvsStore[key] = value;
+    }
+    fclose(file);
+}
+
+static void saveNvs() {
+    const std::string& path = harnessConfig().nvsPath;
+    FILE* file = path.empty() ? NULL : fopen(path.c_str(), "w");
+    if (file == NULL) {
+        return;
+    }
+    for (const auto& entry : nvsStore) {
+        fprintf(file, "%s ", entry.first.c_str());
+        for (uint8_t byte : entry.second) {
+            fprintf(file, "%02x", byte);
+        }
+        fprintf(file, "\n");
+    }
+    fclose(file);
+}
+
+bool Preferences::begin(const char* name, bool readOnly) {
+    std::lock_guard<std::mutex> lock(nvsMutex);
+    loadNvs();
+    _namespace = std::string(name) + "/";
+    if (readOnly) {
+        bool exists = false;
+        for (const auto& entry : nvsStore) {
+            exists = exists || entry.first.rfind(_namespace, 0) == 0;
+        }
+        if (!exists) {
+            return false;
+        }
+    }
+    _open = true;
+    _readOnly = readOnly;
+    return true;
+}
+
+void Preferences::end() {
+    _open = false;
+}
+
+size_t Preferences::getBytes(const char* key, void* buffer, size_t maxLength) {
+    std::lock_guard<std::mutex> lock(nvsMutex);
+    auto entry = nvsStore.find(_namespace + key);
+    if (!_open || entry == nvsStore.end() || entry->second.size() > maxLength) {
+        return 0;
+    }
+    memcpy(buffer, entry->second.data(), entry->second.size());
+    return entry->second.size();
+}
+
+size_t Preferences::putBytes(const char* key, const void* value, size_t length) {
+    std::lock_guard<std::mutex> lock(nvsMutex);
+    if (!_open || _readOnly) {
+        return 0;
+    }
+    const uint8_t* bytes = static_cast<const uint8_t*>(value);
+    nvsStore[_namespace + key] = std::vector<uint8_t>(bytes, bytes + length);
+    saveNvs();
+    return length;
+}
+
+bool Preferences::remove(const char* key) {
+    std::lock_guard<std::mutex> lock(nvsMutex);
+    if (!_open || _readOnly || nvsStore.erase(_namespace + key) == 0) {
+        return false;
+    }
+    saveNvs();
+    return true;
+}
@@ -0,0 +1,38 @@
+/**
+ * `Preferences.h`
+ * - Native stand-in for the ESP32 Preferences (NVS) class, byte blobs only
+ * - In memory by default; `--nvs FILE` keeps the store across harness runs (warm boot)
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#ifndef NATIVE_PREFERENCES_H
+#define NATIVE_PREFERENCES_H
+
+#include <stddef.h>
+
+#include <string>
+
+class Preferences {
+public:
+    /**
+     * Open a namespace
+     * @return false if read-only and the namespace does not exist (like NVS)
+     */
+    bool begin(const char* name, bool readOnly = false);
+    void end();
+
+    size_t getBytes(const char* key, void* buffer, size_t maxLength);
+    size_t putBytes(const char* key, const void* value, size_t length);
+    bool remove(const char* key);
+
+private:
+    std::string _namespace;
+    bool _open = false;
+    bool _readOnly = false;
+};
+
+#endif // NATIVE_PREFERENCES_H
@@ -0,0 +1,543 @@
+/**
+ * `ReplayCamera.cpp`
+ * - Native esp_camera driver: replays a JPEG clip at sensor timing
+ * - A sensor thread completes one frame every 1/sensorFps into `fb_count` buffers:
+ *   - CAMERA_GRAB_LATEST: a new frame replaces any frame nobody grabbed yet
+ *   - CAMERA_GRAB_WHEN_EMPTY: frames queue in free buffers, dropped when none is free
+ * - Clip sources:
+ *   - directory of *.jpg (sorted by name); optional subdirectories named after frame
+ *     sizes (QVGA, HVGA, VGA, ...) are used when the firmware switches frame size
+ *   - synthetic scene (no directory): textured room with an object crossing it,
+ *     encoded per (frame size, quality) so ABR and the motion gate behave as on device
+ * - set_res_raw (OV2640 window): synthetic frames become the window's crop of the scene
+ *   at the output size; like the driver, fb width/height still report status.framesize
+ * - esp_camera_deinit() stops the sensor and frees the buffers, so a stream profile can
+ *   re-initialize the driver with larger ones
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#include "esp_camera.h"
+#include "ReplayHarness.h"
+#include "esp_timer.h"
+#include "jpeg_fixture.h"
+
+#include <AllocCounter.h>
+
+#include <dirent.h>
+#include <stdio.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <thread>
+#include <tuple>
+
+const resolution_info_t resolution[FRAMESIZE_INVALID] = {
+    {96, 96}, {160, 120}, {176, 144}, {240, 176}, {240, 240}, {320, 240}, {400, 296},
+    {480, 320}, {640, 480}, {800, 600}, {1024, 768}, {1280, 720}, {1280, 1024}, {1600, 1200},
+};
+
+static const char* const kFrameSizeNames[FRAMESIZE_INVALID] = {
+    "96X96", "QQVGA", "QCIF", "HQVGA", "240X240", "QVGA", "CIF",
+    "HVGA", "VGA", "SVGA", "XGA", "HD", "SXGA", "UXGA",
+};
+
+// OV2640 readout modes by set_res_raw startX (UXGA, SVGA, CIF)
+static const resolution_info_t kSensorModes[] = { {1600, 1200}, {800, 600}, {400, 296} };
+
+static camera_sensor_info_t kSensorInfo = {CAMERA_OV2640, "OV2640", 0x30, 0x26, FRAMESIZE_UXGA, true};
+
+static const size_t kSyntheticFrames = 40;    // 4 s loop at 10 FPS
+static const uint32_t kFbGetTimeoutMs = 4000;  // esp32-camera FB_GET_TIMEOUT
+
+// ========================================
+// Clip Loading
+// ========================================
+struct ReplayFrame {
+    std::vector<uint8_t> jpeg;
+    uint16_t width;
+    uint16_t height;
+};
+
+typedef std::vector<ReplayFrame> ReplayClip;
+
+/**
+ * Frame dimensions from the SOFn marker (0 if not found)
+ */
+static void jpegSize(const std::vector<uint8_t>& jpeg, uint16_t& width, uint16_t& height) {
+    width = height = 0;
+    size_t pos = 2;
+    while (pos + 9 < jpeg.size()) {
+        if (jpeg[pos] != 0xFF) {
+            return;
+        }
+        uint8_t marker = jpeg[pos + 1];
+        size_t length = ((size_t)jpeg[pos + 2] << 8) | jpeg[pos + 3];
+        if (marker >= 0xC0 && marker <= 0xC2) {
+            height = (uint16_t)((jpeg[pos + 5] << 8) | jpeg[pos + 6]);
+            width = (uint16_t)((jpeg[pos + 7] << 8) | jpeg[pos + 8]);
+            return;
+        }
+        pos += 2 + length;
+    }
+}
+
+static bool hasJpegExtension(const std::string& name) {
+    size_t dot = name.rfind('.');
+    if (dot == std::string::npos) {
+        return false;
+    }
+    std::string ext = name.substr(dot + 1);
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+    return ext == "jpg" || ext == "jpeg";
+}
+
+static ReplayClip loadDirectory(const std::string& dir) {
+    ReplayClip clip;
+    DIR* handle = opendir(dir.c_str());
+    if (handle == NULL) {
+        return clip;
+    }
+    std::vector<std::string> names;
+    while (struct dirent* entry = readdir(handle)) {
+        if (hasJpegExtension(entry->d_name)) {
+            names.push_back(entry->d_name);
+        }
+    }
+    closedir(handle);
+    std::sort(names.begin(), names.end());
+
+    for (const std::string& name : names) {
+        FILE* file = fopen((dir + "/" + name).c_str(), "rb");
+        if (file == NULL) {
+            continue;
+        }
+        ReplayFrame frame;
+        uint8_t chunk[16384];
+        size_t n;
+        while ((n = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+            frame.jpeg.insert(frame.jpeg.end(), chunk, chunk + n);
+        }
+        fclose(file);
+        if (frame.jpeg.size() < 4 || frame.jpeg[0] != 0xFF || frame.jpeg[1] != 0xD8) {
+            continue;
+        }
+        jpegSize(frame.jpeg, frame.width, frame.height);
+        clip.push_back(std::move(frame));
+    }
+    return clip;
+}
+
+/**
+ * Synthetic view: the whole scene, or a window of it
+ * - The scene is rendered at sceneWidth x sceneHeight, frames are its crop at (cropX, cropY)
+ */
+struct SyntheticView {
+    int sceneWidth;
+    int sceneHeight;
+    int cropX;
+    int cropY;
+    int width;
+    int height;
+    int quality;                       // OV2640 quality (0-63, lower = better)
+
+    bool operator<(const SyntheticView& other) const {
+        return std::tie(sceneWidth, sceneHeight, cropX, cropY, width, height, quality) <
+               std::tie(other.sceneWidth, other.sceneHeight, other.cropX, other.cropY, other.width, other.height,
+                        other.quality);
+    }
+};
+
+static Scene cropScene(const Scene& scene, int x, int y, int width, int height) {
+    Scene crop(width, height);
+    for (int yy = 0; yy < height; yy++) {
+        for (int xx = 0; xx < width; xx++) {
+            crop.y[(size_t)yy * width + xx] = scene.at(x + xx, y + yy);
+        }
+    }
+    return crop;
+}
+
+/**
+ * Synthetic clip: idle room, then an object crossing it (motion), then idle again
+ */
+static ReplayClip makeSyntheticClip(const SyntheticView& view) {
+    int libjpegQuality = 100 - view.quality * 3 / 2;
+    libjpegQuality = libjpegQuality < 10 ? 10 : (libjpegQuality > 95 ? 95 : libjpegQuality);
+    FixtureEncoder encoder(libjpegQuality, FixtureSampling::Yuv422);
+    Scene background = makeBackground(view.sceneWidth, view.sceneHeight);
+    bool windowed = view.width != view.sceneWidth || view.height != view.sceneHeight;
+
+    ReplayClip clip;
+    int objectSize = view.sceneWidth / 6;
+    for (size_t i = 0; i < kSyntheticFrames; i++) {
+        bool moving = i >= 10 && i < 30;
+        int x = moving ? (int)(i - 10) * (view.sceneWidth - objectSize) / 20 : 0;
+        Scene scene = makeFrame(background, (uint32_t)i + 1, 2, 0, x, view.sceneHeight / 3,
+                                moving ? objectSize : 0, objectSize);
+        ReplayFrame frame;
+        frame.jpeg = encoder.encode(windowed ? cropScene(scene, view.cropX, view.cropY, view.width, view.height) : scene);
+        frame.width = (uint16_t)view.width;
+        frame.height = (uint16_t)view.height;
+        clip.push_back(std::move(frame));
+    }
+    return clip;
+}
+
+// ========================================
+// Replay Camera
+// ========================================
+namespace {
+
+enum class SlotState { Free, Filled, Held };
+
+struct Slot {
+    camera_fb_t fb;
+    std::vector<uint8_t> storage;
+    SlotState state;
+    uint64_t order;            // completion order (oldest queued frame first in WHEN_EMPTY)
+};
+
+class ReplayCamera {
+public:
+    ~ReplayCamera() {
+        if (_sensorThread.joinable()) {
+            _running = false;
+            _sensorThread.join();
+        }
+    }
+
+    bool load(const HarnessConfig& config) {
+        _config = config;
+        if (config.clipDir.empty()) {
+            return true;
+        }
+        _defaultClip = std::make_shared<ReplayClip>(loadDirectory(config.clipDir));
+        for (int size = 0; size < FRAMESIZE_INVALID; size++) {
+            ReplayClip clip = loadDirectory(config.clipDir + "/" + kFrameSizeNames[size]);
+            if (!clip.empty()) {
+                _sizeClips[size] = std::make_shared<ReplayClip>(std::move(clip));
+            }
+        }
+        if (_defaultClip->empty() && !_sizeClips.empty()) {
+            _defaultClip = _sizeClips.begin()->second;
+        }
+        return !_defaultClip->empty();
+    }
+
+    esp_err_t init(const camera_config_t* config) {
+        if (_running || config->pixel_format != PIXFORMAT_JPEG || config->fb_count < 1 ||
+            config->frame_size >= FRAMESIZE_INVALID) {
+            return ESP_FAIL;
+        }
+        _grabLatest = config->grab_mode == CAMERA_GRAB_LATEST;
+        _slots.resize(config->fb_count);
+        for (Slot& slot : _slots) {
+            slot.fb = {};
+            slot.fb.format = PIXFORMAT_JPEG;
+            slot.state = SlotState::Free;
+            slot.order = 0;
+        }
+        _sensor = {};
+        _sensor.id.PID = kSensorInfo.pid;
+        _sensor.xclk_freq_hz = config->xclk_freq_hz;
+        _sensor.status.framesize = config->frame_size;
+        _sensor.status.quality = (uint8_t)config->jpeg_quality;
+        _sensor.set_framesize = setFramesize;
+        _sensor.set_quality = setQuality;
+        _sensor.set_gainceiling = [](sensor_t*, gainceiling_t) { return 0; };
+        int (*ignore)(sensor_t*, int) = [](sensor_t*, int) { return 0; };
+        _sensor.set_brightness = _sensor.set_contrast = _sensor.set_saturation = ignore;
+        _sensor.set_special_effect = _sensor.set_whitebal = _sensor.set_awb_gain = ignore;
+        _sensor.set_wb_mode = _sensor.set_exposure_ctrl = _sensor.set_aec2 = ignore;
+        _sensor.set_gain_ctrl = _sensor.set_agc_gain = _sensor.set_bpc = _sensor.set_wpc = ignore;
+        _sensor.set_raw_gma = _sensor.set_lenc = _sensor.set_hmirror = _sensor.set_vflip = ignore;
+        _sensor.set_dcw = _sensor.set_colorbar = ignore;
+        _sensor.set_res_raw = setResRaw;
+        _sensor.set_xclk = [](sensor_t* sensor, int, int xclk) {
+            sensor->xclk_freq_hz = xclk * 1000000;
+            return 0;
+        };
+        _window = {};
+
+        // The sensor thread picks the clip (prepared in the background, the previous clip plays
+        // until then, nothing before the first one): the firmware may boot with buffers for
+        // the snapshot size and switch the stream down right after, before any frame is due
+        _running = true;
+        _sensorThread = std::thread([this] { sensorLoop(); });
+        return ESP_OK;
+    }
+
+    /**
+     * Stop the sensor and free the buffers (the application must have returned them all)
+     */
+    esp_err_t deinit() {
+        if (!_running) {
+            return ESP_FAIL;
+        }
+        _running = false;
+        _sensorThread.join();
+        std::lock_guard<std::mutex> lock(_mutex);
+        _slots.clear();
+        return ESP_OK;
+    }
+
+    camera_fb_t* get() {
+        std::unique_lock<std::mutex> lock(_mutex);
+        Slot* slot = NULL;
+        _ready.wait_for(lock, std::chrono::milliseconds(kFbGetTimeoutMs), [&] {
+            slot = pickFilled();
+            return slot != NULL;
+        });
+        if (slot == NULL) {
+            return NULL;
+        }
+        slot->state = SlotState::Held;
+        replayReport().onGrab();
+        return &slot->fb;
+    }
+
+    void put(camera_fb_t* fb) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (Slot& slot : _slots) {
+            if (&slot.fb == fb) {
+                slot.state = SlotState::Free;
+            }
+        }
+    }
+
+    sensor_t* sensor() { return _running ? &_sensor : NULL; }
+
+private:
+    static int setFramesize(sensor_t* sensor, framesize_t framesize);
+    static int setQuality(sensor_t* sensor, int quality);
+    static int setResRaw(sensor_t* sensor, int startX, int startY, int endX, int endY, int offsetX, int offsetY,
+                         int totalX, int totalY, int outputX, int outputY, bool scale, bool binning);
+
+    /**
+     * Synthetic view for the current sensor settings (call with _mutex held or before the sensor runs)
+     */
+    SyntheticView viewFor(int framesize, int quality) const {
+        if (_window.width > 0) {
+            SyntheticView view = _window;
+            view.quality = quality;
+            return view;
+        }
+        int width = resolution[framesize].width;
+        int height = resolution[framesize].height;
+        return SyntheticView{width, height, 0, 0, width, height, quality};
+    }
+
+    Slot* pickFilled() {
+        Slot* best = NULL;
+        for (Slot& slot : _slots) {
+            if (slot.state != SlotState::Filled) continue;
+            if (best == NULL || (_grabLatest ? slot.order > best->order : slot.order < best->order)) {
+                best = &slot;
+            }
+        }
+        return best;
+    }
+
+    /**
+     * Clip for the current sensor settings
+     * - Directory clips: per-size subdirectory or the default clip (quality and window are ignored)
+     * - Synthetic clips are encoded on first use in the background; NULL meanwhile (the
+     *   sensor keeps the previous clip)
+     */
+    std::shared_ptr<ReplayClip> clipFor(const SyntheticView& key, int framesize) {
+        if (!_config.clipDir.empty()) {
+            auto it = _sizeClips.find(framesize);
+            return it != _sizeClips.end() ? it->second : _defaultClip;
+        }
+        std::lock_guard<std::mutex> lock(_clipMutex);
+        auto it = _synthetic.find(key);
+        if (it != _synthetic.end()) {
+            return it->second;
+        }
+        if (_pending.count(key) == 0) {
+            _pending[key] = true;
+            std::thread([this, key] {
+                AllocExempt platform;
+                auto clip = std::make_shared<ReplayClip>(makeSyntheticClip(key));
+                std::lock_guard<std::mutex> guard(_clipMutex);
+                _synthetic[key] = clip;
+            }).detach();
+        }
+        return NULL;
+    }
+
+    void sensorLoop() {
+        AllocExempt platform;  // the driver's DMA buffers are allocated once on device
+        const uint64_t periodUs = (uint64_t)(1000000.0f / (_config.sensorFps > 0 ? _config.sensorFps : 25.0f));
+        uint64_t next = (uint64_t)esp_timer_get_time() + periodUs;
+        size_t index = 0;
+        uint64_t order = 0;
+        while (_running) {
+            // Frame period is fixed by the sensor clock, not by the consumer
+            int64_t wait = (int64_t)next - esp_timer_get_time();
+            if (wait > 0) {
+                std::this_thread::sleep_for(std::chrono::microseconds(wait));
+            }
+            next += periodUs;
+
+            int framesize;
+            SyntheticView view;
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                framesize = _sensor.status.framesize;
+                view = viewFor(framesize, _sensor.status.quality);
+            }
+            std::shared_ptr<ReplayClip> clip = clipFor(view, framesize);
+            if (clip != NULL && clip != _current) {
+                _current = clip;
+            }
+            if (_current == NULL) {
+                continue;
+            }
+            const ReplayFrame& frame = (*_current)[index++ % _current->size()];
+            fill(frame, ++order);
+        }
+    }
+
+    void fill(const ReplayFrame& frame, uint64_t order) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        bool overwrote = false;
+        Slot* target = NULL;
+        for (Slot& slot : _slots) {
+            if (slot.state == SlotState::Free) {
+                target = &slot;
+                break;
+            }
+        }
+        if (_grabLatest) {
+            // Only the newest completed frame is kept for the application
+            for (Slot& slot : _slots) {
+                if (slot.state == SlotState::Filled) {
+                    slot.state = SlotState::Free;
+                    overwrote = true;
+                    if (target == NULL) target = &slot;
+                }
+            }
+        }
+        if (target == NULL) {
+            replayReport().onSensorFrame(false, true);
+            return;
+        }
+        target->storage.assign(frame.jpeg.begin(), frame.jpeg.end());
+        target->fb.buf = target->storage.data();
+        target->fb.len = target->storage.size();
+        // esp_camera_fb_get() reports the status.framesize size, also for windowed frames
+        bool windowed = _window.width > 0 && _config.clipDir.empty();
+        target->fb.width = windowed ? resolution[_sensor.status.framesize].width : frame.width;
+        target->fb.height = windowed ? resolution[_sensor.status.framesize].height : frame.height;
+        uint64_t now = (uint64_t)esp_timer_get_time();
+        target->fb.timestamp.tv_sec = (time_t)(now / 1000000ULL);
+        target->fb.timestamp.tv_usec = (suseconds_t)(now % 1000000ULL);
+        target->state = SlotState::Filled;
+        target->order = order;
+        replayReport().onSensorFrame(overwrote, false);
+        _ready.notify_all();
+    }
+
+    HarnessConfig _config;
+    std::shared_ptr<ReplayClip> _defaultClip;
+    std::map<int, std::shared_ptr<ReplayClip>> _sizeClips;
+    std::map<SyntheticView, std::shared_ptr<ReplayClip>> _synthetic;
+    std::map<SyntheticView, bool> _pending;
+    std::mutex _clipMutex;
+    std::shared_ptr<ReplayClip> _current;
+
+    std::vector<Slot> _slots;
+    bool _grabLatest = true;
+    sensor_t _sensor = {};
+    SyntheticView _window = {};        // set_res_raw window (width 0 = full frame)
+    std::atomic<bool> _running{false};
+    std::thread _sensorThread;
+    std::mutex _mutex;
+    std::condition_variable _ready;
+};
+
+ReplayCamera camera;
+
+int ReplayCamera::setFramesize(sensor_t* sensor, framesize_t framesize) {
+    if (framesize >= FRAMESIZE_INVALID) {
+        return -1;
+    }
+    std::lock_guard<std::mutex> lock(camera._mutex);
+    sensor->status.framesize = framesize;
+    camera._window = {};
+    return 0;
+}
+
+int ReplayCamera::setResRaw(sensor_t* sensor, int startX, int startY, int endX, int endY, int offsetX, int offsetY,
+                            int totalX, int totalY, int outputX, int outputY, bool scale, bool binning) {
+    (void)sensor, (void)startY, (void)endX, (void)endY, (void)scale, (void)binning;
+    if (startX < 0 || startX >= (int)(sizeof(kSensorModes) / sizeof(kSensorModes[0]))) {
+        return -1;
+    }
+    const resolution_info_t& mode = kSensorModes[startX];
+    if (offsetX < 0 || offsetY < 0 || totalX <= 0 || totalY <= 0 || offsetX + totalX > mode.width ||
+        offsetY + totalY > mode.height || outputX <= 0 || outputY <= 0 || outputX > totalX || outputY > totalY) {
+        return -1;
+    }
+    // The DSP scales the window to the output: render the scene at that scale and crop it
+    std::lock_guard<std::mutex> lock(camera._mutex);
+    camera._window.sceneWidth = mode.width * outputX / totalX;
+    camera._window.sceneHeight = mode.height * outputY / totalY;
+    camera._window.cropX = offsetX * outputX / totalX;
+    camera._window.cropY = offsetY * outputY / totalY;
+    camera._window.width = outputX;
+    camera._window.height = outputY;
+    return 0;
+}
+
+int ReplayCamera::setQuality(sensor_t* sensor, int quality) {
+    std::lock_guard<std::mutex> lock(camera._mutex);
+    sensor->status.quality = (uint8_t)(quality < 0 ? 0 : (quality > 63 ? 63 : quality));
+    return 0;
+}
+
+} // namespace
+
+// ========================================
+// Driver API
+// ========================================
+bool replayCameraLoad(const HarnessConfig& config) {
+    return camera.load(config);
+}
+
+esp_err_t esp_camera_init(const camera_config_t* config) {
+    // --camera-init is the whole call (the first synthetic clip is encoded in the background)
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(harnessConfig().cameraInitMs);
+    esp_err_t result = camera.init(config);
+    std::this_thread::sleep_until(deadline);
+    return result;
+}
+
+esp_err_t esp_camera_deinit() {
+    return camera.deinit();
+}
+
+camera_fb_t* esp_camera_fb_get() {
+    return camera.get();
+}
+
+void esp_camera_fb_return(camera_fb_t* fb) {
+    camera.put(fb);
+}
+
+sensor_t* esp_camera_sensor_get() {
+    return camera.sensor();
+}
+
+camera_sensor_info_t* esp_camera_sensor_get_info(sensor_id_t* id) {
+    return id != NULL && id->PID == kSensorInfo.pid ? &kSensorInfo : NULL;
+}
@@ -0,0 +1,397 @@
+/**
+ * `ReplayHarness.cpp`
+ * - Entry point of the host replay build (`pio run -e replay`)
+ * - Parses the run configuration, drives setup()/loop() for the requested duration
+ *   and prints the report (optionally as JSON, and as a pass/fail gate)
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#include "ReplayHarness.h"
+#include "esp_timer.h"
+
+#include <FrameEnvelope.h>
+#include <LumaStream.h>
+#include <SnapshotCapture.h>
+
+#include <algorithm>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// Firmware entry points (src/main.cpp)
+void setup();
+void loop();
+
+namespace {
+
+HarnessConfig config;
+ReplayReport report;
+volatile sig_atomic_t interrupted = 0;
+
+void onSignal(int signal) {
+    (void)signal;
+    interrupted = 1;
+}
+
+void printUsage(const char* program) {
+    fprintf(stderr,
+            "usage: %s [options]\n"
+            "  --clip DIR          JPEG clip directory (default: synthetic scene)\n"
+            "  --sensor-fps N      sensor frame rate (default 25)\n"
+            "  --duration S        run time in seconds (default 30)\n"
+            "  --sink HOST:PORT    WebSocket sink (default 127.0.0.1:8887)\n"
+            "  --bandwidth KBPS    uplink rate (default unlimited)\n"
+            "  --delay MS          one-way delay\n"
+            "  --jitter MS         extra one-way delay, uniform [0, MS]\n"
+            "  --loss PCT          per-segment loss (retransmitted after --rto)\n"
+            "  --rto MS            retransmission timeout (default 200)\n"
+            "  --seed N            jitter/loss random seed\n"
+            "  --rssi DBM          reported WiFi RSSI (default -60)\n"
+            "  --camera-init MS    camera init duration, at least the synthetic clip encode (default 0)\n"
+            "  --wifi-scan MS      channel scan of a join without cached BSSID/channel (default 0)\n"
+            "  --wifi-join MS      WiFi authentication + association (default 0)\n"
+            "  --wifi-dhcp MS      DHCP exchange, skipped with a static IP (default 0)\n"
+            "  --ap-down MS        AP unreachable for the first MS after start\n"
+            "  --nvs FILE          keep the NVS (Preferences) store in FILE across runs\n"
+            "  --quiet             suppress firmware serial output\n"
+            "  --json FILE         write the report as JSON\n"
+            "  --min-fps N         exit 1 if delivered FPS is lower\n"
+            "  --max-p99-ms N      exit 1 if capture->sink p99 latency is higher\n",
+            program);
+}
+
+bool parseArgs(int argc, char** argv) {
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        if (strcmp(arg, "--quiet") == 0) {
+            config.quiet = true;
+            continue;
+        }
+        if (strcmp(arg, "--help") == 0 || i + 1 >= argc) {
+            return false;
+        }
+        const char* value = argv[++i];
+        if (strcmp(arg, "--clip") == 0) {
+            config.clipDir = value;
+        } else if (strcmp(arg, "--sensor-fps") == 0) {
+            config.sensorFps = strtof(value, nullptr);
+        } else if (strcmp(arg, "--duration") == 0) {
+            config.durationMs = (uint32_t)(strtof(value, nullptr) * 1000.0f);
+        } else if (strcmp(arg, "--sink") == 0) {
+            const char* colon = strrchr(value, ':');
+            if (colon == nullptr) {
+                return false;
+            }
+            config.sinkHost.assign(value, colon - value);
+            config.sinkPort = (uint16_t)atoi(colon + 1);
+        } else if (strcmp(arg, "--bandwidth") == 0) {
+            config.link.bandwidthKbps = (uint32_t)atoi(value);
+        } else if (strcmp(arg, "--delay") == 0) {
+            config.link.delayMs = (uint32_t)atoi(value);
+        } else if (strcmp(arg, "--jitter") == 0) {
+            config.link.jitterMs = (uint32_t)atoi(value);
+        } else if (strcmp(arg, "--loss") == 0) {
+            config.link.lossPercent = strtof(value, nullptr);
+        } else if (strcmp(arg, "--rto") == 0) {
+            config.link.rtoMs = (uint32_t)atoi(value);
+        } else if (strcmp(arg, "--seed") == 0) {
+            config.link.seed = (uint32_t)strtoul(value, nullptr, 10);
+        } else if (strcmp(arg, "--rssi") == 0) {
+            config.rssiDbm = (int8_t)atoi(value);
+        } else if (strcmp(arg, "--camera-init") == 0) {
+            config.cameraInitMs = (uint32_t)atoi(value);
+        } else if (strcmp(arg, "--wifi-scan") == 0) {
+            config.wifiScanMs = (uint32_t)atoi(value);
+        } else if (strcmp(arg, "--wifi-join") == 0) {
+            config.wifiJoinMs = (uint32_t)atoi(value);
+        } else if (strcmp(arg, "--wifi-dhcp") == 0) {
+            config.wifiDhcpMs = (uint32_t)atoi(value);
+        } else if (strcmp(arg, "--ap-down") == 0) {
+            config.apDownMs = (uint32_t)atoi(value);
+        } else if (strcmp(arg, "--nvs") == 0) {
+            config.nvsPath = value;
+        } else if (strcmp(arg, "--json") == 0) {
+            config.jsonPath = value;
+        } else if (strcmp(arg, "--min-fps") == 0) {
+            config.minFps = strtof(value, nullptr);
+        } else if (strcmp(arg, "--max-p99-ms") == 0) {
+            config.maxP99Ms = strtof(value, nullptr);
+        } else {
+            return false;
+        }
+    }
+    return config.sensorFps > 0.0f && config.durationMs > 0;
+}
+
+}  // namespace
+
+const HarnessConfig& harnessConfig() {
+    return config;
+}
+
+ReplayReport& replayReport() {
+    return report;
+}
+
+// ========================================
+// ReplayReport
+// ========================================
+void ReplayReport::onSensorFrame(bool overwrote, bool noBuffer) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (noBuffer) {
+        _counters.sensorNoBuffer++;
+        return;
+    }
+    _counters.sensorFrames++;
+    if (overwrote) {
+        _counters.sensorOverwritten++;
+    }
+}
+
+void ReplayReport::onGrab() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _counters.grabbed++;
+}
+
+void ReplayReport::onSend(bool success) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (success) {
+        _counters.sentFrames++;
+    } else {
+        _counters.sendFailures++;
+    }
+}
+
+void ReplayReport::onConnect() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _counters.connects++;
+}
+
+void ReplayReport::onDisconnect() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _counters.disconnects++;
+    _assembler.reset();
+}
+
+void ReplayReport::onDelivered(const uint8_t* payload, size_t length, uint64_t deliveredUs) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (SnapshotUpload::isPart(payload, length)) {
+        return;  // snapshot upload: not part of the live stream (the stand-in server checks it)
+    }
+    if (LumaCodec::isLuma(payload, length)) {
+        _counters.lumaPlanes++;  // analyzer side-stream: not a frame either
+        return;
+    }
+    bool firstPart = FrameEnvelope::isEnvelope(payload, length);
+    switch (_assembler.accept(payload, length)) {
+        case AssembleResult::Passthrough:
+            break;
+        case AssembleResult::Pending:
+            if (!firstPart) {
+                _counters.chunkParts++;
+            }
+            return;
+        case AssembleResult::Dropped:
+            _counters.chunkDropped++;
+            return;
+        case AssembleResult::Complete:
+            // Latency counts from the last part
+            if (!firstPart) {
+                _counters.chunkParts++;
+            }
+            payload = _assembler.frame();
+            length = _assembler.frameLength();
+            break;
+    }
+
+    FrameHeader header;
+    bool enveloped = FrameEnvelope::decode(payload, length, header);
+    _counters.delivered++;
+    _counters.deliveredBytes += length;
+    if (!enveloped) {
+        _counters.rawFrames++;
+        if (_counters.firstDeliveredUs == 0) {
+            _counters.firstDeliveredUs = deliveredUs;
+        }
+        return;
+    }
+    if (header.flags & kEnvelopeHistorical) {
+        // Own sequence space and old capture times: not part of the live stream
+        _counters.backfilled++;
+        return;
+    }
+    if (_counters.firstDeliveredUs == 0) {
+        _counters.firstDeliveredUs = deliveredUs;
+    }
+
+    // captureUs and deliveredUs share the process clock, no sync needed
+    if (deliveredUs > header.captureUs) {
+        _latencyUs.push_back((uint32_t)(deliveredUs - header.captureUs));
+    }
+    if (_hasSequence && header.sequence > _lastSequence + 1) {
+        _counters.sequenceGaps++;
+        _counters.framesSkipped += header.sequence - _lastSequence - 1;
+    }
+    _lastSequence = header.sequence;
+    _hasSequence = true;
+}
+
+ReplayCounters ReplayReport::getCounters() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _counters;
+}
+
+float ReplayReport::latencyPercentileMs(float percentile) const {
+    std::vector<uint32_t> sorted;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        sorted = _latencyUs;
+    }
+    if (sorted.empty()) {
+        return 0.0f;
+    }
+    std::sort(sorted.begin(), sorted.end());
+    size_t index = (size_t)(percentile / 100.0f * (float)(sorted.size() - 1) + 0.5f);
+    return sorted[std::min(index, sorted.size() - 1)] / 1000.0f;
+}
+
+float ReplayReport::latencyMaxMs() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_latencyUs.empty()) {
+        return 0.0f;
+    }
+    return *std::max_element(_latencyUs.begin(), _latencyUs.end()) / 1000.0f;
+}
+
+// ========================================
+// Report
+// ========================================
+namespace {
+
+struct Summary {
+    ReplayCounters counters;
+    LinkStats link;
+    float seconds;
+    float firstFrameMs;            // start to first live frame at the sink (-1 = none)
+    float deliveredFps;
+    float deliveredKbps;
+    float p50, p90, p99, max;
+};
+
+Summary summarize(uint64_t startUs, uint64_t elapsedUs) {
+    Summary summary;
+    summary.counters = report.getCounters();
+    summary.link = replayLinkStats();
+    summary.seconds = elapsedUs / 1000000.0f;
+    summary.firstFrameMs = summary.counters.firstDeliveredUs > startUs
+                               ? (summary.counters.firstDeliveredUs - startUs) / 1000.0f : -1.0f;
+    summary.deliveredFps = summary.counters.delivered / summary.seconds;
+    summary.deliveredKbps = summary.counters.deliveredBytes * 8.0f / 1000.0f / summary.seconds;
+    summary.p50 = report.latencyPercentileMs(50.0f);
+    summary.p90 = report.latencyPercentileMs(90.0f);
+    summary.p99 = report.latencyPercentileMs(99.0f);
+    summary.max = report.latencyMaxMs();
+    return summary;
+}
+
+void printSummary(const Summary& s) {
+    const ReplayCounters& c = s.counters;
+    const LinkConfig& link = config.link;
+    printf("\n[Replay] %.1fs, clip=%s, sensor %.1f fps\n", s.seconds,
+           config.clipDir.empty() ? "synthetic" : config.clipDir.c_str(), config.sensorFps);
+    printf("[Replay] link: %u kbps, delay %u ms, jitter %u ms, loss %.2f%%, rto %u ms\n",
+           link.bandwidthKbps, link.delayMs, link.jitterMs, link.lossPercent, link.rtoMs);
+    printf("[Replay] sensor: %u frames, %u overwritten, %u no buffer\n",
+           c.sensorFrames, c.sensorOverwritten, c.sensorNoBuffer);
+    printf("[Replay] firmware: %u grabbed, %u sent, %u send failures, %u frames skipped in %u gaps\n",
+           c.grabbed, c.sentFrames, c.sendFailures, c.framesSkipped, c.sequenceGaps);
+    printf("[Replay] delivered: %u frames (%.1f fps, %.0f kbps), %u raw, %u backfilled, connects %u, disconnects %u\n",
+           c.delivered, s.deliveredFps, s.deliveredKbps, c.rawFrames, c.backfilled, c.connects, c.disconnects);
+    printf("[Replay] chunked: %u later parts, %u dropped; luma planes: %u\n", c.chunkParts, c.chunkDropped,
+           c.lumaPlanes);
+    printf("[Replay] boot: camera init %u ms, WiFi scan %u / join %u / DHCP %u ms, first frame at sink %.0f ms\n",
+           config.cameraInitMs, config.wifiScanMs, config.wifiJoinMs, config.wifiDhcpMs, s.firstFrameMs);
+    printf("[Replay] link: %u segments, %u retransmits, sender blocked %.1f ms\n",
+           s.link.segments, s.link.retransmits, s.link.blockedUs / 1000.0f);
+    printf("[Replay] capture->sink latency: p50 %.1f ms, p90 %.1f ms, p99 %.1f ms, max %.1f ms\n",
+           s.p50, s.p90, s.p99, s.max);
+}
+
+bool writeJson(const Summary& s) {
+    FILE* file = fopen(config.jsonPath.c_str(), "w");
+    if (file == nullptr) {
+        fprintf(stderr, "[Replay] cannot write %s\n", config.jsonPath.c_str());
+        return false;
+    }
+    const ReplayCounters& c = s.counters;
+    fprintf(file,
+            "{\"seconds\": %.3f, \"sensorFps\": %.2f, \"firstFrameMs\": %.1f, "
+            "\"link\": {\"bandwidthKbps\": %u, \"delayMs\": %u, \"jitterMs\": %u, \"lossPercent\": %.3f, "
+            "\"rtoMs\": %u, \"segments\": %u, \"retransmits\": %u, \"blockedMs\": %.1f}, "
+            "\"sensor\": {\"frames\": %u, \"overwritten\": %u, \"noBuffer\": %u}, "
+            "\"firmware\": {\"grabbed\": %u, \"sent\": %u, \"sendFailures\": %u, \"gaps\": %u, \"skipped\": %u}, "
+            "\"delivered\": {\"frames\": %u, \"fps\": %.2f, \"kbps\": %.1f, \"raw\": %u, \"backfilled\": %u, "
+            "\"connects\": %u, \"disconnects\": %u, \"chunkParts\": %u, \"chunkDropped\": %u, \"lumaPlanes\": %u}, "
+            "\"latencyMs\": {\"p50\": %.2f, \"p90\": %.2f, \"p99\": %.2f, \"max\": %.2f}}\n",
+            s.seconds, config.sensorFps, s.firstFrameMs,
+            config.link.bandwidthKbps, config.link.delayMs, config.link.jitterMs, config.link.lossPercent,
+            config.link.rtoMs, s.link.segments, s.link.retransmits, s.link.blockedUs / 1000.0f,
+            c.sensorFrames, c.sensorOverwritten, c.sensorNoBuffer,
+            c.grabbed, c.sentFrames, c.sendFailures, c.sequenceGaps, c.framesSkipped,
+            c.delivered, s.deliveredFps, s.deliveredKbps, c.rawFrames, c.backfilled, c.connects, c.disconnects,
+            c.chunkParts, c.chunkDropped, c.lumaPlanes,
+            s.p50, s.p90, s.p99, s.max);
+    fclose(file);
+    return true;
+}
+
+}  // namespace
+
+// ========================================
+// Main
+// ========================================
+int main(int argc, char** argv) {
+    if (!parseArgs(argc, argv)) {
+        printUsage(argv[0]);
+        return 2;
+    }
+    if (!replayCameraLoad(config)) {
+        fprintf(stderr, "[Replay] no JPEG frames in %s\n", config.clipDir.c_str());
+        return 2;
+    }
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+
+    uint64_t startUs = (uint64_t)esp_timer_get_time();
+    setup();
+    uint64_t deadlineUs = startUs + (uint64_t)config.durationMs * 1000;
+    while (!interrupted && (uint64_t)esp_timer_get_time() < deadlineUs) {
+        loop();
+    }
+
+    Summary summary = summarize(startUs, (uint64_t)esp_timer_get_time() - startUs);
+    printSummary(summary);
+
+    int status = 0;
+    if (!config.jsonPath.empty() && !writeJson(summary)) {
+        status = 1;
+    }
+    if (config.minFps > 0.0f && summary.deliveredFps < config.minFps) {
+        printf("[Replay] FAIL: delivered %.1f fps < %.1f fps\n", summary.deliveredFps, config.minFps);
+        status = 1;
+    }
+    if (config.maxP99Ms > 0.0f && (summary.p99 > config.maxP99Ms || summary.counters.delivered == 0)) {
+        printf("[Replay] FAIL: p99 latency %.1f ms > %.1f ms\n", summary.p99, config.maxP99Ms);
+        status = 1;
+    }
+    fflush(stdout);
+
+    // The firmware's FreeRTOS-style tasks never return; leave without joining them
+    _exit(status);
+}
@@ -0,0 +1,128 @@
+/**
+ * `ReplayHarness.h`
+ * - Host replay harness: runs src/main.cpp (setup()/loop()) as a Linux binary
+ * - Camera replays a JPEG clip (or a synthetic scene) at sensor timing, the WebSocket
+ *   client talks to a local sink through LinkEmulator (bandwidth, delay, jitter, loss)
+ * - The shims report into ReplayReport; the harness prints FPS, end-to-end latency
+ *   and drop statistics at the end of the run
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#ifndef REPLAY_HARNESS_H
+#define REPLAY_HARNESS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <FrameChunker.h>
+#include <LinkEmulator.h>
+
+/**
+ * Harness configuration (command line)
+ */
+struct HarnessConfig {
+    std::string clipDir;               // directory of *.jpg (empty = synthetic scene)
+    float sensorFps = 25.0f;           // sensor frame rate (OV2640 JPEG up to SVGA)
+    uint32_t durationMs = 30000;
+    std::string sinkHost = "127.0.0.1";
+    uint16_t sinkPort = 8887;
+    LinkConfig link;
+    int8_t rssiDbm = -60;
+    uint32_t cameraInitMs = 0;         // esp_camera_init() duration (sensor probe + register setup)
+    uint32_t wifiScanMs = 0;           // channel scan before a join without BSSID/channel
+    uint32_t wifiJoinMs = 0;           // authentication + association
+    uint32_t wifiDhcpMs = 0;           // DHCP exchange (skipped with a static IP)
+    uint32_t apDownMs = 0;             // AP unreachable until this time
+    std::string nvsPath;               // persistent Preferences store (empty = in memory)
+    bool quiet = false;                // suppress firmware Serial output
+    std::string jsonPath;
+    float minFps = 0.0f;               // exit 1 if delivered FPS is lower
+    float maxP99Ms = 0.0f;             // exit 1 if capture→sink p99 is higher (0 = no gate)
+};
+
+const HarnessConfig& harnessConfig();
+
+/**
+ * Run counters collected from the camera and transport shims
+ */
+struct ReplayCounters {
+    uint32_t sensorFrames;             // frames produced by the replay sensor
+    uint32_t sensorOverwritten;        // completed frames replaced before anyone grabbed them
+    uint32_t sensorNoBuffer;           // frames lost because every buffer was held
+    uint32_t grabbed;                  // esp_camera_fb_get() successes
+    uint32_t sentFrames;               // frames accepted by sendBIN() (first part of a chunked frame)
+    uint32_t sendFailures;
+    uint32_t delivered;                // frames written to the sink (chunked frames once complete)
+    uint32_t chunkParts;               // messages carrying a later part of a chunked frame
+    uint32_t chunkDropped;             // parts the assembler could not place
+    uint64_t deliveredBytes;
+    uint32_t rawFrames;                // delivered without an envelope (no latency sample)
+    uint32_t backfilled;               // historical frames recorded during an outage
+    uint32_t lumaPlanes;               // gray plane side-stream messages (not frames)
+    uint32_t sequenceGaps;             // envelope sequence jumps (gated/stale/queue drops)
+    uint32_t framesSkipped;            // frames missing in those jumps
+    uint32_t connects;
+    uint32_t disconnects;
+    uint64_t firstDeliveredUs;         // first live frame at the sink (boot to first frame, 0 = none)
+};
+
+/**
+ * Report collector (thread-safe, shared by the shims)
+ */
+class ReplayReport {
+public:
+    void onSensorFrame(bool overwrote, bool noBuffer);
+    void onGrab();
+    void onSend(bool success);
+    void onConnect();
+    void onDisconnect();
+
+    /**
+     * A binary message reached the sink
+     * @param payload Message payload (envelope + JPEG, raw JPEG, or a frame part)
+     * @param deliveredUs esp_timer clock when the last byte was written
+     */
+    void onDelivered(const uint8_t* payload, size_t length, uint64_t deliveredUs);
+
+    ReplayCounters getCounters() const;
+
+    /**
+     * Capture→sink latency percentile (ms)
+     */
+    float latencyPercentileMs(float percentile) const;
+    float latencyMaxMs() const;
+
+private:
+    static constexpr size_t kMaxFrame = 256 * 1024;
+
+    mutable std::mutex _mutex;
+    ReplayCounters _counters = {};
+    std::vector<uint8_t> _assembly = std::vector<uint8_t>(kMaxFrame);
+    FrameAssembler _assembler{_assembly.data(), _assembly.size()};
+    std::vector<uint32_t> _latencyUs;
+    uint32_t _lastSequence = 0;
+    bool _hasSequence = false;
+};
+
+ReplayReport& replayReport();
+
+/**
+ * Transport counters of the emulated link (implemented by the WebSocketsClient shim)
+ */
+LinkStats replayLinkStats();
+
+/**
+ * Load the replay clip (called before setup() so a bad clip fails fast)
+ * @return false if the clip directory has no JPEG files
+ */
+bool replayCameraLoad(const HarnessConfig& config);
+
+#endif // REPLAY_HARNESS_H
@@ -0,0 +1,29 @@
+/**
+ * `SD_MMC.h`
+ * - Native stand-in for the Arduino SD_MMC class: no card is present in the replay harness,
+ *   so local recording stays disabled (SegmentStore itself is tested on the host filesystem)
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#ifndef NATIVE_SD_MMC_H
+#define NATIVE_SD_MMC_H
+
+#include "Arduino.h"
+
+class SDMMCFS {
+public:
+    bool begin(const char* mountpoint = "/sdcard", bool mode1bit = false) {
+        (void)mountpoint;
+        (void)mode1bit;
+        return false;
+    }
+    uint64_t totalBytes() const { return 0; }
+};
+
+extern SDMMCFS SD_MMC;
+
+#endif // NATIVE_SD_MMC_H
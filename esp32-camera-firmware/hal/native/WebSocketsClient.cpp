@@ -0,0 +1,445 @@
+/**
+ * `WebSocketsClient.cpp`
+ * - Native WebSocket client shim: RFC 6455 over POSIX sockets, paced by LinkEmulator
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#include "WebSocketsClient.h"
+#include "ReplayHarness.h"
+#include "esp_timer.h"
+
+#include <AllocCounter.h>
+#include <FrameChunker.h>
+#include <LumaStream.h>
+#include <SnapshotCapture.h>
+
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <stdlib.h>
+#include <string.h>
+
+namespace {
+
+WebSocketsClient* activeClient = nullptr;
+
+const uint8_t kOpText = 0x1;
+const uint8_t kOpBinary = 0x2;
+const uint8_t kOpClose = 0x8;
+const uint8_t kOpPing = 0x9;
+const uint8_t kOpPong = 0xA;
+
+uint64_t nowUs() {
+    return (uint64_t)esp_timer_get_time();
+}
+
+void sleepUntil(uint64_t targetUs) {
+    uint64_t now = nowUs();
+    if (targetUs > now) {
+        std::this_thread::sleep_for(std::chrono::microseconds(targetUs - now));
+    }
+}
+
+bool writeAll(int socket, const uint8_t* data, size_t length) {
+    while (length > 0) {
+        ssize_t written = ::send(socket, data, length, MSG_NOSIGNAL);
+        if (written <= 0) {
+            return false;
+        }
+        data += written;
+        length -= (size_t)written;
+    }
+    return true;
+}
+
+}  // namespace
+
+LinkStats replayLinkStats() {
+    return activeClient != nullptr ? activeClient->getLinkStats() : LinkStats{};
+}
+
+WebSocketsClient::WebSocketsClient()
+    : _reconnectIntervalMs(5000),
+      _nextConnectUs(0),
+      _socket(-1),
+      _connected(false),
+      _broken(false),
+      _stopping(false),
+      _link(nullptr) {
+}
+
+WebSocketsClient::~WebSocketsClient() {
+    _stopping = true;
+    _outCond.notify_all();
+    if (_writer.joinable()) {
+        _writer.join();
+    }
+    closeSocket();
+    delete _link;
+}
+
+// ========================================
+// Public API
+// ========================================
+void WebSocketsClient::begin(const char* host, uint16_t port, const char* url, const char* protocol) {
+    (void)host;
+    (void)port;
+    (void)protocol;
+    _path = url;
+    _nextConnectUs = 0;
+    if (_link == nullptr) {
+        _link = new LinkEmulator(harnessConfig().link);
+        _writer = std::thread(&WebSocketsClient::writerLoop, this);
+    }
+    activeClient = this;
+}
+
+void WebSocketsClient::enableHeartbeat(uint32_t pingInterval, uint32_t pongTimeout, uint8_t disconnectTimeoutCount) {
+    // The sink is local; a dead socket is detected by the reader thread instead
+    (void)pingInterval;
+    (void)pongTimeout;
+    (void)disconnectTimeoutCount;
+}
+
+void WebSocketsClient::loop() {
+    if (_link == nullptr) {
+        return;
+    }
+
+    if (_connected && _broken) {
+        closeSocket();
+        replayReport().onDisconnect();
+        _nextConnectUs = nowUs() + (uint64_t)_reconnectIntervalMs * 1000;
+        if (_event) {
+            _event(WStype_DISCONNECTED, nullptr, 0);
+        }
+    }
+
+    if (!_connected && nowUs() >= _nextConnectUs) {
+        if (connectSocket()) {
+            replayReport().onConnect();
+            if (_event) {
+                std::string path = _path;
+                _event(WStype_CONNECTED, (uint8_t*)&path[0], path.size());
+            }
+        } else {
+            _nextConnectUs = nowUs() + (uint64_t)_reconnectIntervalMs * 1000;
+        }
+    }
+
+    // Dispatch downlink messages whose emulated delay has elapsed
+    while (true) {
+        Incoming message;
+        {
+            std::lock_guard<std::mutex> lock(_inMutex);
+            if (_incoming.empty() || _incoming.front().deliverUs > nowUs()) {
+                break;
+            }
+            message = std::move(_incoming.front());
+            _incoming.pop_front();
+        }
+        size_t length = message.payload.size();
+        {
+            AllocExempt platform;
+            message.payload.push_back(0);  // the library NUL-terminates text payloads
+        }
+        if (_event) {
+            _event(message.opcode == kOpText ? WStype_TEXT : WStype_BIN, message.payload.data(), length);
+        }
+    }
+}
+
+bool WebSocketsClient::sendTXT(char* payload, size_t length, bool headerToPayload) {
+    if (length == 0) {
+        length = strlen(payload);
+    }
+    if (headerToPayload) {
+        payload += WEBSOCKETS_MAX_HEADER_SIZE;
+    }
+    return send(kOpText, (const uint8_t*)payload, length);
+}
+
+bool WebSocketsClient::sendBIN(uint8_t* payload, size_t length, bool headerToPayload) {
+    // headerToPayload: the caller reserved WEBSOCKETS_MAX_HEADER_SIZE bytes in front of the data
+    if (headerToPayload) {
+        payload += WEBSOCKETS_MAX_HEADER_SIZE;
+    }
+    if (LumaCodec::isLuma(payload, length)) {
+        return send(kOpBinary, payload, length);  // analyzer side-stream: neither frames nor parts
+    }
+    bool part = FrameChunker::isPart(payload, length) || SnapshotUpload::isPart(payload, length);
+    bool success = send(kOpBinary, payload, length);
+    if (!success || !part) {
+        replayReport().onSend(success);  // frames, not parts
+    }
+    return success;
+}
+
+void WebSocketsClient::disconnect() {
+    if (_connected) {
+        _broken = true;
+    }
+}
+
+LinkStats WebSocketsClient::getLinkStats() {
+    std::lock_guard<std::mutex> lock(_linkMutex);
+    return _link != nullptr ? _link->getStats() : LinkStats{};
+}
+
+// ========================================
+// Connection
+// ========================================
+bool WebSocketsClient::connectSocket() {
+    const HarnessConfig& config = harnessConfig();
+    struct addrinfo hints = {};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    struct addrinfo* result = nullptr;
+    std::string port = std::to_string(config.sinkPort);
+    if (getaddrinfo(config.sinkHost.c_str(), port.c_str(), &hints, &result) != 0 || result == nullptr) {
+        return false;
+    }
+
+    int fd = ::socket(result->ai_family, result->ai_socktype, result->ai_protocol);
+    bool ok = fd >= 0 && ::connect(fd, result->ai_addr, result->ai_addrlen) == 0;
+    freeaddrinfo(result);
+    if (!ok) {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+        return false;
+    }
+    int noDelay = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+
+    std::string request = "GET " + _path + " HTTP/1.1\r\n"
+                          "Host: " + config.sinkHost + ":" + port + "\r\n"
+                          "Upgrade: websocket\r\n"
+                          "Connection: Upgrade\r\n"
+                          "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n"
+                          "Sec-WebSocket-Protocol: arduino\r\n"
+                          "Sec-WebSocket-Version: 13\r\n\r\n";
+    if (!writeAll(fd, (const uint8_t*)request.data(), request.size())) {
+        ::close(fd);
+        return false;
+    }
+
+    // Read the response headers byte by byte so no frame data is consumed
+    std::string response;
+    char c;
+    while (response.size() < 4096 && response.find("\r\n\r\n") == std::string::npos) {
+        if (::recv(fd, &c, 1, 0) != 1) {
+            ::close(fd);
+            return false;
+        }
+        response += c;
+    }
+    if (response.compare(0, 12, "HTTP/1.1 101") != 0) {
+        ::close(fd);
+        return false;
+    }
+
+    _socket = fd;
+    _broken = false;
+    _connected = true;
+    _reader = std::thread(&WebSocketsClient::readerLoop, this);
+    return true;
+}
+
+void WebSocketsClient::closeSocket() {
+    if (_socket >= 0) {
+        ::shutdown(_socket, SHUT_RDWR);
+    }
+    if (_reader.joinable()) {
+        _reader.join();
+    }
+    {
+        std::lock_guard<std::mutex> lock(_socketMutex);
+        if (_socket >= 0) {
+            ::close(_socket);
+            _socket = -1;
+        }
+        _connected = false;
+    }
+    // In-flight data dies with the connection
+    {
+        std::lock_guard<std::mutex> lock(_outMutex);
+        _outgoing.clear();
+    }
+    std::lock_guard<std::mutex> lock(_inMutex);
+    _incoming.clear();
+}
+
+// ========================================
+// Uplink
+// ========================================
+bool WebSocketsClient::send(uint8_t opcode, const uint8_t* payload, size_t length) {
+    if (!_connected || _broken) {
+        return false;
+    }
+    AllocExempt platform;  // the device copies into lwIP buffers instead
+
+    Outgoing message;
+    message.binary = opcode == kOpBinary;
+    message.frame.reserve(length + WEBSOCKETS_MAX_HEADER_SIZE);
+    message.frame.push_back(0x80 | opcode);
+    if (length < 126) {
+        message.frame.push_back(0x80 | (uint8_t)length);
+    } else if (length <= 0xFFFF) {
+        message.frame.push_back(0x80 | 126);
+        message.frame.push_back((uint8_t)(length >> 8));
+        message.frame.push_back((uint8_t)length);
+    } else {
+        message.frame.push_back(0x80 | 127);
+        for (int shift = 56; shift >= 0; shift -= 8) {
+            message.frame.push_back((uint8_t)((uint64_t)length >> shift));
+        }
+    }
+    uint8_t mask[4] = { (uint8_t)rand(), (uint8_t)rand(), (uint8_t)rand(), (uint8_t)rand() };
+    message.frame.insert(message.frame.end(), mask, mask + 4);
+    message.payloadOffset = message.frame.size();
+    message.frame.resize(message.payloadOffset + length);
+    for (size_t i = 0; i < length; i++) {
+        message.frame[message.payloadOffset + i] = payload[i] ^ mask[i & 3];
+    }
+
+    LinkSend schedule;
+    {
+        std::lock_guard<std::mutex> lock(_linkMutex);
+        schedule = _link->send(message.frame.size(), nowUs());
+    }
+    message.deliverUs = schedule.deliverUs;
+    {
+        std::lock_guard<std::mutex> lock(_outMutex);
+        _outgoing.push_back(std::move(message));
+    }
+    _outCond.notify_all();
+
+    // lwIP blocks the caller until the rest of the message fits the send buffer
+    sleepUntil(schedule.unblockUs);
+    return true;
+}
+
+void WebSocketsClient::writerLoop() {
+    AllocExempt platform;
+    std::unique_lock<std::mutex> lock(_outMutex);
+    while (!_stopping) {
+        if (_outgoing.empty()) {
+            _outCond.wait(lock);
+            continue;
+        }
+        uint64_t now = nowUs();
+        uint64_t due = _outgoing.front().deliverUs;
+        if (due > now) {
+            _outCond.wait_for(lock, std::chrono::microseconds(due - now));
+            continue;
+        }
+        Outgoing message = std::move(_outgoing.front());
+        _outgoing.pop_front();
+        lock.unlock();
+
+        bool written = false;
+        {
+            std::lock_guard<std::mutex> socketLock(_socketMutex);
+            if (_socket >= 0) {
+                written = writeAll(_socket, message.frame.data(), message.frame.size());
+            }
+        }
+        if (!written) {
+            _broken = true;
+        } else if (message.binary) {
+            // Unmask so the report sees what the sink received
+            uint8_t* data = message.frame.data() + message.payloadOffset;
+            const uint8_t* mask = data - 4;
+            size_t length = message.frame.size() - message.payloadOffset;
+            for (size_t i = 0; i < length; i++) {
+                data[i] ^= mask[i & 3];
+            }
+            replayReport().onDelivered(data, length, nowUs());
+        }
+        lock.lock();
+    }
+}
+
+// ========================================
+// Downlink
+// ========================================
+bool WebSocketsClient::readExact(uint8_t* out, size_t length) {
+    while (length > 0) {
+        ssize_t received = ::recv(_socket, out, length, 0);
+        if (received <= 0) {
+            return false;
+        }
+        out += received;
+        length -= (size_t)received;
+    }
+    return true;
+}
+
+void WebSocketsClient::readerLoop() {
+    AllocExempt platform;
+    uint8_t header[8];
+    while (!_stopping) {
+        if (!readExact(header, 2)) {
+            break;
+        }
+        uint8_t opcode = header[0] & 0x0F;
+        bool masked = (header[1] & 0x80) != 0;
+        uint64_t length = header[1] & 0x7F;
+        if (length == 126) {
+            if (!readExact(header, 2)) {
+                break;
+            }
+            length = ((uint64_t)header[0] << 8) | header[1];
+        } else if (length == 127) {
+            if (!readExact(header, 8)) {
+                break;
+            }
+            length = 0;
+            for (int i = 0; i < 8; i++) {
+                length = (length << 8) | header[i];
+            }
+        }
+        uint8_t mask[4] = { 0, 0, 0, 0 };
+        if (masked && !readExact(mask, 4)) {
+            break;
+        }
+        if (length > 1024 * 1024) {
+            break;
+        }
+        std::vector<uint8_t> payload((size_t)length);
+        if (length > 0 && !readExact(payload.data(), payload.size())) {
+            break;
+        }
+        if (masked) {
+            for (size_t i = 0; i < payload.size(); i++) {
+                payload[i] ^= mask[i & 3];
+            }
+        }
+
+        if (opcode == kOpClose) {
+            break;
+        } else if (opcode == kOpPing) {
+            send(kOpPong, payload.data(), payload.size());
+        } else if (opcode == kOpText || opcode == kOpBinary) {
+            Incoming message;
+            message.opcode = opcode;
+            message.payload = std::move(payload);
+            {
+                std::lock_guard<std::mutex> lock(_linkMutex);
+                message.deliverUs = _link->receive(nowUs());
+            }
+            std::lock_guard<std::mutex> lock(_inMutex);
+            _incoming.push_back(std::move(message));
+        }
+    }
+    _broken = true;
+}
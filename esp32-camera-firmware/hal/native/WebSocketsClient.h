@@ -0,0 +1,119 @@
+/**
+ * `WebSocketsClient.h`
+ * - Native stand-in for links2004/WebSockets WebSocketsClient (subset used by src/main.cpp)
+ * - Real RFC 6455 client over a TCP socket to the harness sink (the configured
+ *   WS_HOST/WS_PORT are replaced by --sink; the path is kept)
+ * - Every message goes through LinkEmulator:
+ *   - sendBIN()/sendTXT() block like lwIP when the send buffer is full
+ *   - a writer thread puts bytes on the socket at their emulated delivery time
+ *   - received messages are dispatched from loop() after the downlink delay
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#ifndef NATIVE_WEBSOCKETS_CLIENT_H
+#define NATIVE_WEBSOCKETS_CLIENT_H
+
+#include "Arduino.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <LinkEmulator.h>
+
+#define WEBSOCKETS_MAX_HEADER_SIZE (14)
+
+typedef enum {
+    WStype_ERROR,
+    WStype_DISCONNECTED,
+    WStype_CONNECTED,
+    WStype_TEXT,
+    WStype_BIN,
+    WStype_FRAGMENT_TEXT_START,
+    WStype_FRAGMENT_BIN_START,
+    WStype_FRAGMENT,
+    WStype_FRAGMENT_FIN,
+    WStype_PING,
+    WStype_PONG
+} WStype_t;
+
+class WebSocketsClient {
+public:
+    typedef std::function<void(WStype_t type, uint8_t* payload, size_t length)> WebSocketClientEvent;
+
+    WebSocketsClient();
+    ~WebSocketsClient();
+
+    void begin(const char* host, uint16_t port, const char* url = "/", const char* protocol = "arduino");
+    void onEvent(WebSocketClientEvent cbEvent) { _event = cbEvent; }
+    void loop();
+
+    bool sendTXT(char* payload, size_t length = 0, bool headerToPayload = false);
+    bool sendTXT(const char* payload, size_t length = 0) { return sendTXT(const_cast<char*>(payload), length); }
+    bool sendTXT(const String& payload) { return sendTXT(payload.c_str()); }
+    bool sendBIN(uint8_t* payload, size_t length, bool headerToPayload = false);
+
+    void setReconnectInterval(unsigned long time) { _reconnectIntervalMs = time; }
+    void enableHeartbeat(uint32_t pingInterval, uint32_t pongTimeout, uint8_t disconnectTimeoutCount);
+    bool isConnected() const { return _connected; }
+    void disconnect();
+
+    /**
+     * Emulated link counters (for the harness report)
+     */
+    LinkStats getLinkStats();
+
+private:
+    struct Outgoing {
+        uint64_t deliverUs;
+        std::vector<uint8_t> frame;
+        size_t payloadOffset;
+        bool binary;
+    };
+
+    struct Incoming {
+        uint64_t deliverUs;
+        uint8_t opcode;
+        std::vector<uint8_t> payload;
+    };
+
+    bool connectSocket();
+    void closeSocket();
+    bool send(uint8_t opcode, const uint8_t* payload, size_t length);
+    void writerLoop();
+    void readerLoop();
+    bool readExact(uint8_t* out, size_t length);
+
+    WebSocketClientEvent _event;
+    std::string _path;
+    unsigned long _reconnectIntervalMs;
+    uint64_t _nextConnectUs;
+
+    int _socket;
+    std::atomic<bool> _connected;
+    std::atomic<bool> _broken;
+    std::atomic<bool> _stopping;
+    std::mutex _socketMutex;           // held while writing / closing the socket
+    std::thread _writer;
+    std::thread _reader;
+
+    std::mutex _linkMutex;
+    LinkEmulator* _link;
+
+    std::mutex _outMutex;
+    std::condition_variable _outCond;
+    std::deque<Outgoing> _outgoing;
+
+    std::mutex _inMutex;
+    std::deque<Incoming> _incoming;
+};
+
+#endif // NATIVE_WEBSOCKETS_CLIENT_H
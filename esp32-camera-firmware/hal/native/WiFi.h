@@ -0,0 +1,72 @@
+/**
+ * `WiFi.h`
+ * - Native stand-in for the Arduino WiFi class: one emulated AP, RSSI from the harness
+ *   configuration (so ABR sees a chosen signal level)
+ * - begin() associates after the harness join timings (--wifi-scan, --wifi-join,
+ *   --wifi-dhcp, --ap-down): joining with the AP's BSSID/channel skips the scan, a static
+ *   IP (config()) skips DHCP, so cached and cold boots can be compared
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#ifndef NATIVE_WIFI_H
+#define NATIVE_WIFI_H
+
+#include <atomic>
+
+#include "Arduino.h"
+
+typedef enum {
+    WL_IDLE_STATUS = 0,
+    WL_NO_SSID_AVAIL = 1,
+    WL_CONNECTED = 3,
+    WL_DISCONNECTED = 6
+} wl_status_t;
+
+typedef enum {
+    WIFI_OFF = 0,
+    WIFI_STA = 1
+} wifi_mode_t;
+
+class WiFiClass {
+public:
+    bool mode(wifi_mode_t mode) { (void)mode; return true; }
+    bool setSleep(bool enable) { (void)enable; return true; }
+    void persistent(bool enable) { (void)enable; }
+    bool setAutoReconnect(bool enable) { (void)enable; return true; }
+
+    /**
+     * Start joining (returns at once, like the ESP32 core)
+     * @param channel AP channel (0 = scan all channels)
+     * @param bssid AP BSSID (NULL = strongest AP with this SSID)
+     */
+    wl_status_t begin(const char* ssid, const char* password, int32_t channel = 0,
+                      const uint8_t* bssid = NULL, bool connect = true);
+
+    /**
+     * Static IP for the next join (all zero = DHCP)
+     */
+    bool config(IPAddress local, IPAddress gateway, IPAddress subnet, IPAddress dns1 = IPAddress());
+
+    bool disconnect(bool wifiOff = false, bool eraseAp = false);
+    wl_status_t status();
+    IPAddress localIP();
+    IPAddress gatewayIP();
+    IPAddress subnetMask();
+    IPAddress dnsIP(uint8_t index = 0);
+    uint8_t* BSSID();
+    int32_t channel();
+    int8_t RSSI() const;
+
+private:
+    std::atomic<int64_t> _associatedAtUs{-1};  // join completes at this esp_timer time (-1 = no join)
+    std::atomic<bool> _unreachable{false};     // BSSID/channel of another AP
+    bool _staticIp = false;
+};
+
+extern WiFiClass WiFi;
+
+#endif // NATIVE_WIFI_H
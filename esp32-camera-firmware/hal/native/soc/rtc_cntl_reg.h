@@ -0,0 +1,16 @@
+/**
+ * `soc/rtc_cntl_reg.h`
+ * - Native stand-in: brownout register address (ignored by WRITE_PERI_REG)
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#ifndef NATIVE_RTC_CNTL_REG_H
+#define NATIVE_RTC_CNTL_REG_H
+
+#define RTC_CNTL_BROWN_OUT_REG 0
+
+#endif // NATIVE_RTC_CNTL_REG_H
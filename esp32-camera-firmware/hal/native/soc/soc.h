@@ -0,0 +1,16 @@
+/**
+ * `soc/soc.h`
+ * - Native stand-in: register access is a no-op on the host
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#ifndef NATIVE_SOC_H
+#define NATIVE_SOC_H
+
+#define WRITE_PERI_REG(addr, val) ((void)(addr), (void)(val))
+
+#endif // NATIVE_SOC_H
@@ -0,0 +1,369 @@
+/**
+ * `AsyncLog.cpp`
+ * - Asynchronous logger implementation
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#include "AsyncLog.h"
+
+#include <stdio.h>
+
+#include <chrono>
+
+#ifdef ESP_PLATFORM
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+#endif
+
+std::atomic<AsyncLog*> AsyncLog::_installed(NULL);
+
+static const char kLevelLetters[] = { 'D', 'I', 'W', 'E' };
+
+// ========================================
+// Platform Helpers
+// ========================================
+uint32_t AsyncLog::nowMillis() {
+#ifdef ESP_PLATFORM
+    return (uint32_t)(esp_timer_get_time() / 1000);
+#else
+    static const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    return (uint32_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start).count();
+#endif
+}
+
+// ========================================
+// AsyncLog
+// ========================================
+AsyncLog::AsyncLog(const AsyncLogConfig& config, LogSlot* slots, size_t slotCount)
+    : _config(config),
+      _slots(slots),
+      _mask((uint32_t)slotCount - 1),
+      _enqueuePos(0),
+      _dequeuePos(0),
+      _posted(0),
+      _dropped(0),
+      _written(0),
+      _maxDepth(0),
+      _droppedReported(0),
+      _running(false),
+      _wake(false)
+#ifdef ESP_PLATFORM
+      , _taskActive(false)
+#endif
+{
+    for (size_t i = 0; i < slotCount; i++) {
+        _slots[i].sequence.store((uint32_t)i, std::memory_order_relaxed);
+    }
+}
+
+AsyncLog::~AsyncLog() {
+    if (installed() == this) {
+        install(NULL);
+    }
+    stop();
+}
+
+void AsyncLog::install(AsyncLog* log) {
+    _installed.store(log, std::memory_order_release);
+}
+
+bool AsyncLog::start() {
+    if (_running.exchange(true)) {
+        return true;
+    }
+#ifdef ESP_PLATFORM
+    _taskActive = true;
+    if (xTaskCreatePinnedToCore(writerTaskEntry, "log", _config.writerStackSize, this,
+                                _config.writerPriority, NULL, _config.writerCore) != pdPASS) {
+        _taskActive = false;
+        _running = false;
+        return false;
+    }
+#else
+    _writerThread = std::thread([this] { writerLoop(); });
+#endif
+    return true;
+}
+
+void AsyncLog::stop() {
+    if (_running.exchange(false)) {
+        {
+            std::lock_guard<std::mutex> lock(_wakeMutex);
+            _wake = true;
+        }
+        _wakeCond.notify_all();
+#ifdef ESP_PLATFORM
+        std::unique_lock<std::mutex> lock(_exitMutex);
+        _exitCond.wait(lock, [this] { return !_taskActive; });
+#else
+        if (_writerThread.joinable()) _writerThread.join();
+#endif
+    }
+    flush();
+}
+
+// ========================================
+// Log Side (any task, lock-free)
+// ========================================
+LogSlot* AsyncLog::claim(uint32_t& position) {
+    uint32_t pos = _enqueuePos.load(std::memory_order_relaxed);
+    for (;;) {
+        LogSlot* slot = &_slots[pos & _mask];
+        uint32_t sequence = slot->sequence.load(std::memory_order_acquire);
+        int32_t diff = (int32_t)(sequence - pos);
+        if (diff == 0) {
+            if (_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                position = pos;
+                return slot;
+            }
+        } else if (diff < 0) {
+            // The writer has not freed this slot yet: ring full
+            _dropped.fetch_add(1, std::memory_order_relaxed);
+            return NULL;
+        } else {
+            pos = _enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+void AsyncLog::publish(LogSlot* slot, uint32_t position) {
+    slot->sequence.store(position + 1, std::memory_order_release);
+    _posted.fetch_add(1, std::memory_order_relaxed);
+
+    uint32_t depth = position + 1 - _dequeuePos.load(std::memory_order_relaxed);
+    uint32_t seen = _maxDepth.load(std::memory_order_relaxed);
+    while (depth > seen && !_maxDepth.compare_exchange_weak(seen, depth, std::memory_order_relaxed)) {
+    }
+}
+
+uint64_t AsyncLog::copyText(LogRecord& record, const char* text) {
+    if (text == NULL) {
+        text = "(null)";
+    }
+    size_t offset = record.textUsed;
+    size_t room = kLogTextBytes - offset;
+    size_t length = 0;
+    if (room > 0) {
+        while (length + 1 < room && text[length] != '\0') {
+            length++;
+        }
+        memcpy(record.text + offset, text, length);
+        record.text[offset + length] = '\0';
+        record.textUsed = (uint8_t)(offset + length + 1);
+        return offset;
+    }
+    // No room left: point at the last byte (always the NUL of an earlier argument)
+    return kLogTextBytes - 1;
+}
+
+// ========================================
+// Writer Side
+// ========================================
+bool AsyncLog::take(LogRecord& record) {
+    uint32_t pos = _dequeuePos.load(std::memory_order_relaxed);
+    LogSlot* slot = &_slots[pos & _mask];
+    uint32_t sequence = slot->sequence.load(std::memory_order_acquire);
+    if ((int32_t)(sequence - (pos + 1)) < 0) {
+        return false;  // empty, or the next record is still being written
+    }
+    record = slot->record;
+    slot->sequence.store(pos + _mask + 1, std::memory_order_release);
+    _dequeuePos.store(pos + 1, std::memory_order_relaxed);
+    return true;
+}
+
+void AsyncLog::emit(const LogRecord& record) {
+    char line[kLogLineBytes];
+    size_t length = 0;
+    if (_config.timestamps) {
+        int prefix = snprintf(line, sizeof(line), "%lu.%03lu %c ", (unsigned long)(record.timeMs / 1000),
+                              (unsigned long)(record.timeMs % 1000), kLevelLetters[(size_t)record.level & 3]);
+        length = prefix > 0 ? (size_t)prefix : 0;
+    }
+    length += formatMessage(record, line + length, sizeof(line) - length - 1);
+    line[length++] = '\n';
+    if (_config.sink != NULL) {
+        _config.sink(line, length, _config.sinkContext);
+    }
+    _written.fetch_add(1, std::memory_order_relaxed);
+}
+
+void AsyncLog::reportDrops() {
+    uint32_t dropped = _dropped.load(std::memory_order_relaxed);
+    if (dropped == _droppedReported) {
+        return;
+    }
+    char line[64];
+    int length = snprintf(line, sizeof(line), "[Log] %lu records dropped (ring full)\n",
+                          (unsigned long)(dropped - _droppedReported));
+    _droppedReported = dropped;
+    if (_config.sink != NULL && length > 0) {
+        _config.sink(line, (size_t)length, _config.sinkContext);
+    }
+}
+
+size_t AsyncLog::flush(size_t maxRecords) {
+    std::lock_guard<std::mutex> lock(_flushMutex);
+    size_t count = 0;
+    LogRecord record;
+    while ((maxRecords == 0 || count < maxRecords) && take(record)) {
+        emit(record);
+        count++;
+    }
+    reportDrops();
+    return count;
+}
+
+void AsyncLog::writerLoop() {
+    while (_running.load()) {
+        {
+            std::unique_lock<std::mutex> lock(_wakeMutex);
+            _wakeCond.wait_for(lock, std::chrono::milliseconds(_config.flushIntervalMs), [this] { return _wake; });
+            _wake = false;
+        }
+        flush();
+    }
+}
+
+#ifdef ESP_PLATFORM
+void AsyncLog::writerTaskEntry(void* arg) {
+    AsyncLog* self = static_cast<AsyncLog*>(arg);
+    self->writerLoop();
+    {
+        std::lock_guard<std::mutex> lock(self->_exitMutex);
+        self->_taskActive = false;
+        self->_exitCond.notify_all();
+    }
+    vTaskDelete(NULL);
+}
+#endif
+
+// ========================================
+// Formatting
+// ========================================
+static bool isIntegerConversion(char c) {
+    return c == 'd' || c == 'i' || c == 'u' || c == 'x' || c == 'X' || c == 'o' || c == 'c';
+}
+
+static bool isFloatConversion(char c) {
+    return c == 'f' || c == 'F' || c == 'e' || c == 'E' || c == 'g' || c == 'G' || c == 'a' || c == 'A';
+}
+
+size_t AsyncLog::formatMessage(const LogRecord& record, char* out, size_t capacity) {
+    if (capacity == 0) {
+        return 0;
+    }
+    size_t length = 0;
+    size_t argIndex = 0;
+    const char* p = record.format;
+    while (*p != '\0' && length + 1 < capacity) {
+        if (*p != '%') {
+            out[length++] = *p++;
+            continue;
+        }
+        if (p[1] == '%') {
+            out[length++] = '%';
+            p += 2;
+            continue;
+        }
+
+        // %[flags][width][.precision][length]conversion: keep flags/width/precision, own length
+        const char* start = p++;
+        while (*p != '\0' && strchr("-+ #0123456789.", *p) != NULL) {
+            p++;
+        }
+        size_t specLength = (size_t)(p - start);
+        while (*p != '\0' && strchr("hlLqjzt", *p) != NULL) {
+            p++;
+        }
+        char conversion = *p;
+        if (conversion == '\0') {
+            break;
+        }
+        p++;
+
+        char spec[24];
+        if (specLength > sizeof(spec) - 4) {
+            specLength = sizeof(spec) - 4;
+        }
+        memcpy(spec, start, specLength);
+        size_t room = capacity - length;
+        int written;
+        if (argIndex >= record.argCount) {
+            written = snprintf(out + length, room, "%.*s%c", (int)(p - start - 1), start, conversion);
+        } else {
+            LogArgKind kind = record.kinds[argIndex];
+            uint64_t bits = record.args[argIndex];
+            argIndex++;
+            double number;
+            memcpy(&number, &bits, sizeof(number));
+            if (conversion == 's') {
+                spec[specLength] = 's';
+                spec[specLength + 1] = '\0';
+                if (kind == LogArgKind::Text) {
+                    written = snprintf(out + length, room, spec, record.text + (size_t)bits);
+                } else {
+                    written = snprintf(out + length, room, "?");
+                }
+            } else if (isFloatConversion(conversion)) {
+                spec[specLength] = conversion;
+                spec[specLength + 1] = '\0';
+                double value = kind == LogArgKind::Double ? number
+                             : kind == LogArgKind::Int ? (double)(int64_t)bits
+                             : (double)bits;
+                written = snprintf(out + length, room, spec, value);
+            } else if (conversion == 'p') {
+                spec[specLength] = 'p';
+                spec[specLength + 1] = '\0';
+                written = snprintf(out + length, room, spec, (void*)(uintptr_t)bits);
+            } else if (isIntegerConversion(conversion)) {
+                int64_t value = kind == LogArgKind::Double ? (int64_t)number : (int64_t)bits;
+                if (conversion == 'c') {
+                    spec[specLength] = 'c';
+                    spec[specLength + 1] = '\0';
+                    written = snprintf(out + length, room, spec, (int)value);
+                } else if (conversion == 'd' || conversion == 'i') {
+                    spec[specLength] = 'l';
+                    spec[specLength + 1] = 'l';
+                    spec[specLength + 2] = conversion;
+                    spec[specLength + 3] = '\0';
+                    written = snprintf(out + length, room, spec, (long long)value);
+                } else {
+                    // A negative int printed unsigned wraps at its own width, like printf
+                    uint64_t unsignedValue = (uint64_t)value;
+                    if (kind == LogArgKind::Int && value < 0 && value >= INT32_MIN) {
+                        unsignedValue &= 0xFFFFFFFFULL;
+                    }
+                    spec[specLength] = 'l';
+                    spec[specLength + 1] = 'l';
+                    spec[specLength + 2] = conversion;
+                    spec[specLength + 3] = '\0';
+                    written = snprintf(out + length, room, spec, (unsigned long long)unsignedValue);
+                }
+            } else {
+                written = snprintf(out + length, room, "%.*s%c", (int)(p - start - 1), start, conversion);
+            }
+        }
+        if (written < 0) {
+            break;
+        }
+        length += (size_t)written < room ? (size_t)written : room - 1;
+    }
+    out[length] = '\0';
+    return length;
+}
+
+AsyncLogStats AsyncLog::getStats() const {
+    AsyncLogStats stats = {};
+    stats.posted = _posted.load(std::memory_order_relaxed);
+    stats.dropped = _dropped.load(std::memory_order_relaxed);
+    stats.written = _written.load(std::memory_order_relaxed);
+    stats.maxDepth = _maxDepth.load(std::memory_order_relaxed);
+    return stats;
+}
@@ -0,0 +1,274 @@
+/**
+ * `AsyncLog.h`
+ * - Asynchronous logger: `Serial.printf` at 115200 baud blocks the caller for the whole line
+ *   (~87 µs per byte once the UART FIFO is full, ~5 ms for 60 bytes)
+ * - LOG_DEBUG/INFO/WARN/ERROR store a binary record (format pointer, arguments by value,
+ *   string arguments copied) in a lock-free ring and return; a low-priority writer task
+ *   formats the records and writes them to the sink (Serial)
+ * - Levels below LOG_MIN_LEVEL are removed at compile time (arguments are not evaluated)
+ * - A full ring drops the new record and counts it; the writer reports the count in the log
+ * - Ring: bounded MPMC sequence slots in caller-owned memory, any task may log, one writer
+ * - Platform independent: writer is a FreeRTOS task on device, a std::thread on the host
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#ifndef ASYNC_LOG_H
+#define ASYNC_LOG_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <type_traits>
+
+#ifndef ESP_PLATFORM
+#include <thread>
+#endif
+
+// Lowest level compiled in: 0 = debug, 1 = info, 2 = warn, 3 = error, 4 = none
+#ifndef LOG_MIN_LEVEL
+#define LOG_MIN_LEVEL 1
+#endif
+
+static constexpr size_t kLogMaxArgs = 6;
+static constexpr size_t kLogTextBytes = 48;    // string arguments of one record (truncated)
+static constexpr size_t kLogLineBytes = 192;   // formatted line (truncated)
+
+enum class LogLevel : uint8_t {
+    Debug = 0,
+    Info = 1,
+    Warn = 2,
+    Error = 3
+};
+
+enum class LogArgKind : uint8_t {
+    Int,       // signed integers, char
+    Uint,      // unsigned integers, bool, pointers
+    Double,    // float, double
+    Text       // char* (copied into the record)
+};
+
+/**
+ * One log call, nothing formatted yet
+ */
+struct LogRecord {
+    uint32_t timeMs;
+    const char* format;        // string literal (never copied)
+    LogLevel level;
+    uint8_t argCount;
+    uint8_t textUsed;
+    LogArgKind kinds[kLogMaxArgs];
+    uint64_t args[kLogMaxArgs];    // value bits, Text: offset into text
+    char text[kLogTextBytes];
+};
+
+/**
+ * Ring slot (caller allocates `slotCount` of them)
+ */
+struct LogSlot {
+    std::atomic<uint32_t> sequence;
+    LogRecord record;
+};
+
+/**
+ * Receives formatted lines (writer task)
+ */
+typedef void (*LogSink)(const char* line, size_t length, void* context);
+
+/**
+ * Logger configuration
+ */
+struct AsyncLogConfig {
+    LogSink sink = NULL;
+    void* sinkContext = NULL;
+    bool timestamps = true;            // "<s>.<ms> " in front of each line
+    uint32_t flushIntervalMs = 20;     // writer wake-up (log calls never wake it: no lock)
+
+    // FreeRTOS task parameters (ignored on host)
+    uint32_t writerStackSize = 3072;
+    uint8_t writerPriority = 1;        // below capture/network, above idle
+    int8_t writerCore = 0;
+};
+
+/**
+ * Logger counters
+ */
+struct AsyncLogStats {
+    uint32_t posted;           // records stored
+    uint32_t dropped;          // records lost to a full ring
+    uint32_t written;          // lines handed to the sink
+    uint32_t maxDepth;         // high-water mark of the ring
+};
+
+/**
+ * Ring-buffer logger
+ */
+class AsyncLog {
+public:
+    /**
+     * Constructor
+     * @param config Logger configuration
+     * @param slots Caller-owned ring memory
+     * @param slotCount Ring size, power of two
+     */
+    AsyncLog(const AsyncLogConfig& config, LogSlot* slots, size_t slotCount);
+    ~AsyncLog();
+
+    AsyncLog(const AsyncLog&) = delete;
+    AsyncLog& operator=(const AsyncLog&) = delete;
+
+    /**
+     * Start the writer task
+     * @return false if the task cannot be created (records wait for flush())
+     */
+    bool start();
+
+    /**
+     * Stop the writer and write what is left
+     */
+    void stop();
+
+    /**
+     * Store a record (never blocks, never allocates)
+     * @return false if the ring is full (counted as dropped)
+     */
+    template <typename... Args>
+    bool write(LogLevel level, const char* format, Args... args) {
+        static_assert(sizeof...(Args) <= kLogMaxArgs, "too many log arguments");
+        uint32_t position;
+        LogSlot* slot = claim(position);
+        if (slot == NULL) {
+            return false;
+        }
+        LogRecord& record = slot->record;
+        record.timeMs = nowMillis();
+        record.format = format;
+        record.level = level;
+        record.argCount = 0;
+        record.textUsed = 0;
+        int expand[] = { 0, (capture(record, args), 0)... };
+        (void)expand;
+        publish(slot, position);
+        return true;
+    }
+
+    /**
+     * Format and write waiting records on the calling task (writer task, shutdown, tests)
+     * @param maxRecords Upper bound (0 = until the ring is empty)
+     * @return Records written
+     */
+    size_t flush(size_t maxRecords = 0);
+
+    /**
+     * Render a record's message like printf would (no timestamp, no newline)
+     * @return Length written (truncated to capacity - 1, NUL-terminated)
+     */
+    static size_t formatMessage(const LogRecord& record, char* out, size_t capacity);
+
+    /**
+     * Logger behind the LOG_* macros (NULL: log calls are ignored)
+     */
+    static void install(AsyncLog* log);
+    static AsyncLog* installed() { return _installed.load(std::memory_order_acquire); }
+
+    template <typename... Args>
+    static void post(LogLevel level, const char* format, Args... args) {
+        AsyncLog* log = installed();
+        if (log != NULL) {
+            log->write(level, format, args...);
+        }
+    }
+
+    AsyncLogStats getStats() const;
+    bool isRunning() const { return _running.load(); }
+
+private:
+    LogSlot* claim(uint32_t& position);
+    void publish(LogSlot* slot, uint32_t position);
+    bool take(LogRecord& record);
+    void emit(const LogRecord& record);
+    void reportDrops();
+    void writerLoop();
+    static uint32_t nowMillis();
+
+    template <typename T>
+    static void capture(LogRecord& record, T value) {
+        uint8_t index = record.argCount++;
+        if constexpr (std::is_same<T, const char*>::value || std::is_same<T, char*>::value) {
+            record.kinds[index] = LogArgKind::Text;
+            record.args[index] = copyText(record, value);
+        } else if constexpr (std::is_floating_point<T>::value) {
+            double number = (double)value;
+            record.kinds[index] = LogArgKind::Double;
+            memcpy(&record.args[index], &number, sizeof(number));
+        } else if constexpr (std::is_pointer<T>::value) {
+            record.kinds[index] = LogArgKind::Uint;
+            record.args[index] = (uint64_t)(uintptr_t)value;
+        } else if constexpr (std::is_enum<T>::value) {
+            record.kinds[index] = LogArgKind::Int;
+            record.args[index] = (uint64_t)(int64_t)value;
+        } else {
+            static_assert(std::is_integral<T>::value, "log arguments: integers, floating point, pointers, char*");
+            record.kinds[index] = std::is_signed<T>::value ? LogArgKind::Int : LogArgKind::Uint;
+            record.args[index] = std::is_signed<T>::value ? (uint64_t)(int64_t)value : (uint64_t)value;
+        }
+    }
+
+    static uint64_t copyText(LogRecord& record, const char* text);
+
+    AsyncLogConfig _config;
+    LogSlot* _slots;
+    uint32_t _mask;
+    std::atomic<uint32_t> _enqueuePos;
+    std::atomic<uint32_t> _dequeuePos;    // advanced by the writer only
+    std::mutex _flushMutex;            // one writer at a time (task vs stop())
+
+    std::atomic<uint32_t> _posted;
+    std::atomic<uint32_t> _dropped;
+    std::atomic<uint32_t> _written;
+    std::atomic<uint32_t> _maxDepth;
+    uint32_t _droppedReported;
+
+    std::atomic<bool> _running;
+    std::mutex _wakeMutex;
+    std::condition_variable _wakeCond;
+    bool _wake;
+
+    static std::atomic<AsyncLog*> _installed;
+
+#ifdef ESP_PLATFORM
+    static void writerTaskEntry(void* arg);
+
+    std::mutex _exitMutex;
+    std::condition_variable _exitCond;
+    bool _taskActive;
+#else
+    std::thread _writerThread;
+#endif
+};
+
+// ========================================
+// Log Macros
+// - Format must be a string literal (the record keeps the pointer)
+// - No trailing newline: the writer ends every line
+// ========================================
+#define LOG_AT(level, fmt, ...)                                       \
+    do {                                                              \
+        if constexpr ((int)(level) >= LOG_MIN_LEVEL) {                \
+            AsyncLog::post((level), "" fmt "", ##__VA_ARGS__);        \
+        }                                                             \
+    } while (0)
+
+#define LOG_DEBUG(fmt, ...) LOG_AT(LogLevel::Debug, fmt, ##__VA_ARGS__)
+#define LOG_INFO(fmt, ...)  LOG_AT(LogLevel::Info, fmt, ##__VA_ARGS__)
+#define LOG_WARN(fmt, ...)  LOG_AT(LogLevel::Warn, fmt, ##__VA_ARGS__)
+#define LOG_ERROR(fmt, ...) LOG_AT(LogLevel::Error, fmt, ##__VA_ARGS__)
+
+#endif // ASYNC_LOG_H
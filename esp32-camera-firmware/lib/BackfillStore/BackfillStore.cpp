@@ -0,0 +1,283 @@
+/**
+ * `BackfillStore.cpp`
+ * - Outage store-and-forward buffer implementation
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#include "BackfillStore.h"
+
+#include <string.h>
+
+/**
+ * Arena record header (followed by the JPEG bytes)
+ */
+struct BackfillStore::RecordHeader {
+    uint32_t size;             // whole record incl. header and padding
+    uint32_t length;           // JPEG bytes
+    uint64_t captureUs;
+    uint32_t sequence;
+    uint16_t width;
+    uint16_t height;
+    uint16_t motionScore;
+    uint8_t frameSize;
+    uint8_t jpegQuality;
+    uint8_t flags;
+};
+
+static const size_t kRecordAlign = 8;
+
+BackfillStore::BackfillStore(const BackfillConfig& config, uint8_t* arena)
+    : _config(config),
+      _arena(arena),
+      _head(0),
+      _tail(0),
+      _wrapEnd(0),
+      _wrapped(false),
+      _count(0),
+      _used(0),
+      _inFlight(false),
+      _clearAfterSend(false),
+      _offline(false),
+      _nextSequence(0),
+      _lastRecordUs(0),
+      _hasRecorded(false),
+      _linkKbps(0),
+      _tokens(0),
+      _lastRefillUs(0),
+      _stats() {
+}
+
+size_t BackfillStore::recordSize(size_t length) {
+    size_t size = sizeof(RecordHeader) + length;
+    return (size + kRecordAlign - 1) & ~(kRecordAlign - 1);
+}
+
+// ========================================
+// Link State
+// ========================================
+void BackfillStore::onDisconnect(uint64_t nowUs) {
+    (void)nowUs;
+    std::lock_guard<std::mutex> lock(_mutex);
+    _offline = true;
+    _stats.outages++;
+}
+
+void BackfillStore::onConnect(uint64_t nowUs) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _offline = false;
+    _tokens = 0;
+    _lastRefillUs = nowUs;
+}
+
+void BackfillStore::setLinkRate(uint32_t kbps) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _linkKbps = kbps;
+}
+
+// ========================================
+// Recording
+// ========================================
+bool BackfillStore::recordDue(uint64_t nowUs) const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_arena == NULL || !_offline) {
+        return false;
+    }
+    return !_hasRecorded || nowUs - _lastRecordUs >= (uint64_t)_config.recordIntervalMs * 1000;
+}
+
+bool BackfillStore::hasRoom(size_t size, size_t& offset) const {
+    if (_count == 0) {
+        offset = 0;
+        return size <= _config.capacityBytes;
+    }
+    if (!_wrapped) {
+        // In use: [head, tail)
+        if (_config.capacityBytes - _tail >= size) {
+            offset = _tail;
+            return true;
+        }
+        if (_head >= size) {
+            offset = 0;
+            return true;
+        }
+        return false;
+    }
+    // In use: [head, wrapEnd) + [0, tail)
+    if (_head - _tail >= size) {
+        offset = _tail;
+        return true;
+    }
+    return false;
+}
+
+void BackfillStore::dropOldest() {
+    RecordHeader header;
+    memcpy(&header, _arena + _head, sizeof(header));
+    _head += header.size;
+    _used -= header.size;
+    _count--;
+    if (_count == 0) {
+        _head = 0;
+        _tail = 0;
+        _wrapped = false;
+    } else if (_wrapped && _head == _wrapEnd) {
+        _head = 0;
+        _wrapped = false;
+    }
+}
+
+bool BackfillStore::record(const BackfillFrame& frame, uint64_t nowUs) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_arena == NULL) {
+        return false;
+    }
+    _lastRecordUs = nowUs;
+    _hasRecorded = true;
+
+    size_t size = recordSize(frame.length);
+    if (size > _config.capacityBytes) {
+        _stats.rejected++;
+        return false;
+    }
+    size_t offset = 0;
+    while (!hasRoom(size, offset)) {
+        // The pinned head is being sent: it cannot be overwritten
+        if (_config.eviction == BackfillEviction::DropNewest || _inFlight) {
+            _stats.rejected++;
+            return false;
+        }
+        dropOldest();
+        _stats.evicted++;
+    }
+
+    if (_count > 0 && !_wrapped && offset == 0) {
+        _wrapEnd = _tail;
+        _wrapped = true;
+    }
+    RecordHeader header = {};
+    header.size = (uint32_t)size;
+    header.length = frame.length;
+    header.captureUs = frame.captureUs;
+    header.sequence = ++_nextSequence;
+    header.width = frame.width;
+    header.height = frame.height;
+    header.motionScore = frame.motionScore;
+    header.frameSize = frame.frameSize;
+    header.jpegQuality = frame.jpegQuality;
+    header.flags = frame.flags;
+    memcpy(_arena + offset, &header, sizeof(header));
+    memcpy(_arena + offset + sizeof(header), frame.data, frame.length);
+    _tail = offset + size;
+    _count++;
+    _used += size;
+
+    _stats.recorded++;
+    if (_used > _stats.maxPendingBytes) {
+        _stats.maxPendingBytes = (uint32_t)_used;
+    }
+    return true;
+}
+
+// ========================================
+// Backfill
+// ========================================
+uint32_t BackfillStore::rateKbps() const {
+    uint32_t share = (uint32_t)((uint64_t)_linkKbps * _config.sharePercent / 100);
+    return share > _config.minRateKbps ? share : _config.minRateKbps;
+}
+
+void BackfillStore::refill(uint64_t nowUs) {
+    if (nowUs <= _lastRefillUs) {
+        return;
+    }
+    // kbps * us / 8000 = bytes
+    uint64_t added = (uint64_t)rateKbps() * (nowUs - _lastRefillUs) / 8000;
+    _lastRefillUs = nowUs;
+    _tokens += (int64_t)added;
+    if (_tokens > (int64_t)_config.burstBytes) {
+        _tokens = (int64_t)_config.burstBytes;
+    }
+}
+
+bool BackfillStore::sendDue(uint64_t nowUs) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    refill(nowUs);
+    return _count > 0 && !_inFlight && _tokens >= 0;
+}
+
+bool BackfillStore::beginSend(BackfillFrame& frame) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_count == 0 || _inFlight) {
+        return false;
+    }
+    RecordHeader header;
+    memcpy(&header, _arena + _head, sizeof(header));
+    frame.data = _arena + _head + sizeof(header);
+    frame.length = header.length;
+    frame.captureUs = header.captureUs;
+    frame.sequence = header.sequence;
+    frame.width = header.width;
+    frame.height = header.height;
+    frame.motionScore = header.motionScore;
+    frame.frameSize = header.frameSize;
+    frame.jpegQuality = header.jpegQuality;
+    frame.flags = header.flags;
+    _inFlight = true;
+    return true;
+}
+
+void BackfillStore::endSend(bool sent) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (!_inFlight) {
+        return;
+    }
+    _inFlight = false;
+    if (sent) {
+        RecordHeader header;
+        memcpy(&header, _arena + _head, sizeof(header));
+        // A large frame borrows ahead; later sends wait until the bucket recovers
+        _tokens -= (int64_t)header.length;
+        _stats.sent++;
+        _stats.sentBytes += header.length;
+        dropOldest();
+    }
+    if (_clearAfterSend) {
+        _clearAfterSend = false;
+        _head = 0;
+        _tail = 0;
+        _wrapped = false;
+        _count = 0;
+        _used = 0;
+    }
+}
+
+void BackfillStore::clear() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_inFlight) {
+        _clearAfterSend = true;
+        return;
+    }
+    _head = 0;
+    _tail = 0;
+    _wrapped = false;
+    _count = 0;
+    _used = 0;
+}
+
+bool BackfillStore::isEmpty() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _count == 0;
+}
+
+BackfillStats BackfillStore::getStats() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    BackfillStats stats = _stats;
+    stats.pendingFrames = _count;
+    stats.pendingBytes = (uint32_t)_used;
+    stats.rateKbps = rateKbps();
+    return stats;
+}
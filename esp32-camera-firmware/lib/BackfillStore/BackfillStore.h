@@ -0,0 +1,180 @@
+/**
+ * `BackfillStore.h`
+ * - Store-and-forward buffer for WebSocket outages
+ * - While disconnected, decimated frames are copied into a bounded arena (PSRAM on device);
+ *   after reconnect they are handed out oldest first, behind the live stream, at a capped
+ *   share of the measured link rate (token bucket), so live latency is not hurt
+ * - Arena: ring of variable-size records (metadata + JPEG), records never straddle the end
+ * - Platform independent: arena is caller-owned, time is passed in (us)
+ * - Thread-safe: recording (loop task) and backfill sends (network task) may run concurrently
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#ifndef BACKFILL_STORE_H
+#define BACKFILL_STORE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <mutex>
+
+/**
+ * What to do when a new frame does not fit
+ */
+enum class BackfillEviction : uint8_t {
+    DropOldest,     // evict the oldest frames (keep the end of the outage)
+    DropNewest      // reject the new frame (keep the start of the outage)
+};
+
+/**
+ * Store configuration
+ */
+struct BackfillConfig {
+    size_t capacityBytes = 1024 * 1024;    // arena size (memory cap)
+    uint32_t recordIntervalMs = 500;       // decimation while offline (0 = every offered frame)
+    BackfillEviction eviction = BackfillEviction::DropOldest;
+    uint8_t sharePercent = 25;             // backfill share of the link rate
+    uint32_t minRateKbps = 64;             // backfill rate when the link rate is unknown or low
+    uint32_t burstBytes = 32 * 1024;       // token bucket depth
+};
+
+/**
+ * Stored frame (metadata + JPEG)
+ */
+struct BackfillFrame {
+    const uint8_t* data;       // JPEG bytes (points into the arena when read back)
+    uint32_t length;
+    uint64_t captureUs;
+    uint32_t sequence;         // backfill sequence (own numbering, not the live sequence)
+    uint16_t width;
+    uint16_t height;
+    uint16_t motionScore;
+    uint8_t frameSize;         // framesize_t
+    uint8_t jpegQuality;
+    uint8_t flags;             // envelope flags at capture (kEnvelopeMotion, ...)
+};
+
+/**
+ * Store statistics
+ */
+struct BackfillStats {
+    uint32_t outages;          // disconnects seen
+    uint32_t recorded;         // frames stored
+    uint32_t evicted;          // stored frames evicted (DropOldest)
+    uint32_t rejected;         // frames not stored (DropNewest, too large, in-flight head)
+    uint32_t sent;             // frames backfilled
+    uint64_t sentBytes;
+    uint32_t pendingFrames;    // frames waiting for backfill
+    uint32_t pendingBytes;     // arena bytes in use
+    uint32_t maxPendingBytes;  // high-water mark of pendingBytes
+    uint32_t rateKbps;         // current backfill rate cap
+};
+
+/**
+ * Outage store-and-forward buffer
+ */
+class BackfillStore {
+public:
+    /**
+     * Constructor
+     * @param config Store configuration
+     * @param arena Caller-owned storage of config.capacityBytes (NULL disables recording)
+     */
+    BackfillStore(const BackfillConfig& config, uint8_t* arena);
+
+    /**
+     * Link went down: starts an outage (recording is only due during outages)
+     */
+    void onDisconnect(uint64_t nowUs);
+
+    /**
+     * Link is back: backfill starts with an empty token bucket (live frames go first)
+     */
+    void onConnect(uint64_t nowUs);
+
+    /**
+     * Check if a frame should be recorded now (during an outage, decimation interval elapsed)
+     */
+    bool recordDue(uint64_t nowUs) const;
+
+    /**
+     * Copy a frame into the store, evicting per policy
+     * @param frame Metadata and JPEG (frame.sequence is assigned by the store)
+     * @return true if stored
+     */
+    bool record(const BackfillFrame& frame, uint64_t nowUs);
+
+    /**
+     * Update the measured link rate the backfill share is taken from
+     */
+    void setLinkRate(uint32_t kbps);
+
+    /**
+     * Check if a stored frame may be sent now (rate cap allows it)
+     */
+    bool sendDue(uint64_t nowUs);
+
+    /**
+     * Pin the oldest frame for sending (it cannot be evicted until endSend())
+     * @param frame Filled with the stored frame; data stays valid until endSend()
+     * @return false if the store is empty or a send is already in progress
+     */
+    bool beginSend(BackfillFrame& frame);
+
+    /**
+     * Finish the send started by beginSend()
+     * @param sent true: remove the frame and charge it to the rate cap; false: keep it for later
+     */
+    void endSend(bool sent);
+
+    /**
+     * Forget every stored frame (in-flight frame included once its send ends)
+     */
+    void clear();
+
+    bool isEmpty() const;
+    BackfillStats getStats() const;
+    const BackfillConfig& getConfig() const { return _config; }
+
+    /**
+     * Arena bytes used by a frame of the given JPEG length
+     */
+    static size_t recordSize(size_t length);
+
+private:
+    struct RecordHeader;
+
+    bool hasRoom(size_t size, size_t& offset) const;
+    void dropOldest();
+    void refill(uint64_t nowUs);
+    uint32_t rateKbps() const;
+
+    BackfillConfig _config;
+    uint8_t* _arena;
+
+    size_t _head;              // oldest record
+    size_t _tail;              // next write position
+    size_t _wrapEnd;           // end of data before the tail wrapped to 0 (valid while _wrapped)
+    bool _wrapped;
+    uint32_t _count;
+    size_t _used;
+    bool _inFlight;            // head record pinned by beginSend()
+    bool _clearAfterSend;
+
+    bool _offline;
+    uint32_t _nextSequence;
+    uint64_t _lastRecordUs;
+    bool _hasRecorded;
+    uint32_t _linkKbps;
+    int64_t _tokens;           // bytes (may go negative: a large frame borrows ahead)
+    uint64_t _lastRefillUs;
+
+    BackfillStats _stats;
+    mutable std::mutex _mutex;
+};
+
+#endif // BACKFILL_STORE_H
@@ -0,0 +1,156 @@
+/**
+ * `BitrateController.cpp`
+ * - Closed-loop adaptive bitrate controller implementation
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#include "BitrateController.h"
+
+// ========================================
+// Constructor
+// ========================================
+BitrateController::BitrateController(const BitrateConfig& config)
+    : _config(config), _rung(0), _avgSendMs(0), _avgFrameBytes(0), _hasSamples(false),
+      _rssiDbm(0), _windowStartMs(0), _windowBytes(0), _windowSendUs(0), _throughputKbps(0),
+      _lastSwitchMs(0), _goodSinceMs(0), _good(false), _upBlockedUntilMs(0),
+      _switchesUp(0), _switchesDown(0), _framesMeasured(0) {
+    if (_config.ladderSize > 0) {
+        _rung = _config.initialRung < _config.ladderSize ? _config.initialRung : _config.ladderSize - 1;
+    }
+}
+
+// ========================================
+// Measurements
+// ========================================
+bool BitrateController::onFrameSent(size_t bytes, uint32_t sendUs, uint32_t nowMs) {
+    float sendMs = sendUs / 1000.0f;
+    if (!_hasSamples) {
+        _avgSendMs = sendMs;
+        _avgFrameBytes = (float)bytes;
+        _hasSamples = true;
+    } else {
+        _avgSendMs += _config.ewmaAlpha * (sendMs - _avgSendMs);
+        _avgFrameBytes += _config.ewmaAlpha * ((float)bytes - _avgFrameBytes);
+    }
+    _windowBytes += (uint32_t)bytes;
+    _windowSendUs += sendUs;
+    _framesMeasured++;
+
+    // A single send stalling for several intervals: do not wait for the window
+    float intervalMs = getRung().intervalMs;
+    if (sendMs > _config.emergencyFactor * intervalMs && nowMs - _lastSwitchMs >= _config.windowMs) {
+        return stepDown(nowMs);
+    }
+    return false;
+}
+
+void BitrateController::onRssi(int8_t rssiDbm) {
+    _rssiDbm = rssiDbm;
+}
+
+float BitrateController::utilization() const {
+    uint16_t intervalMs = getRung().intervalMs;
+    return intervalMs > 0 ? _avgSendMs / intervalMs : 0;
+}
+
+// ========================================
+// Control Loop
+// ========================================
+bool BitrateController::update(uint32_t nowMs) {
+    if (_config.ladderSize == 0 || nowMs - _windowStartMs < _config.windowMs) {
+        return false;
+    }
+
+    uint32_t elapsedMs = nowMs - _windowStartMs;
+    uint32_t windowBytes = _windowBytes;
+    _throughputKbps = elapsedMs > 0 ? windowBytes * 8.0f / elapsedMs : 0;
+    _windowStartMs = nowMs;
+    _windowBytes = 0;
+    _windowSendUs = 0;
+
+    // Nothing sent (e.g. disconnected): no evidence either way
+    if (windowBytes == 0 || !_hasSamples) {
+        _good = false;
+        return false;
+    }
+
+    bool hasRssi = _rssiDbm != 0;
+    bool dwelled = nowMs - _lastSwitchMs >= _config.minDwellMs;
+    float util = utilization();
+
+    bool bad = util > _config.downUtilization || (hasRssi && _rssiDbm < _config.rssiDownDbm);
+    if (bad) {
+        _good = false;
+        return dwelled ? stepDown(nowMs) : false;
+    }
+
+    bool good = util < _config.upUtilization && (!hasRssi || _rssiDbm >= _config.rssiUpDbm);
+    if (!good) {
+        _good = false;
+        return false;
+    }
+    if (!_good) {
+        _good = true;
+        _goodSinceMs = nowMs;
+    }
+    if (dwelled && nowMs - _goodSinceMs >= _config.upHoldMs && (int32_t)(nowMs - _upBlockedUntilMs) >= 0) {
+        return stepUp(nowMs);
+    }
+    return false;
+}
+
+bool BitrateController::stepDown(uint32_t nowMs) {
+    if (_rung == 0) {
+        return false;
+    }
+    _rung--;
+    _switchesDown++;
+    _lastSwitchMs = nowMs;
+    _upBlockedUntilMs = nowMs + _config.upBackoffMs;
+    _good = false;
+    _hasSamples = false;  // averages belong to the previous rung
+    return true;
+}
+
+bool BitrateController::stepUp(uint32_t nowMs) {
+    if (_rung + 1 >= _config.ladderSize) {
+        return false;
+    }
+    _rung++;
+    _switchesUp++;
+    _lastSwitchMs = nowMs;
+    _good = false;
+    _hasSamples = false;
+    return true;
+}
+
+void BitrateController::setRung(size_t index, uint32_t nowMs) {
+    if (index >= _config.ladderSize) {
+        return;
+    }
+    _rung = index;
+    _lastSwitchMs = nowMs;
+    _good = false;
+    _hasSamples = false;
+}
+
+// ========================================
+// Statistics
+// ========================================
+BitrateStats BitrateController::getStats() const {
+    BitrateStats stats;
+    stats.rung = _rung;
+    stats.switchesUp = _switchesUp;
+    stats.switchesDown = _switchesDown;
+    stats.framesMeasured = _framesMeasured;
+    stats.avgSendMs = _avgSendMs;
+    stats.avgFrameBytes = _avgFrameBytes;
+    stats.throughputKbps = _throughputKbps;
+    stats.rssiDbm = _rssiDbm;
+    stats.utilization = utilization();
+    return stats;
+}
@@ -0,0 +1,130 @@
+/**
+ * `BitrateController.h`
+ * - Closed-loop adaptive bitrate (ABR) controller
+ * - Measures per-frame send time, achieved throughput and WiFi RSSI, then moves
+ *   along a ladder of (framesize, jpeg_quality, interval) rungs with hysteresis
+ * - Platform independent: time and measurements are passed in, the caller applies
+ *   the selected rung (sensor_t::set_framesize / set_quality on device)
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#ifndef BITRATE_CONTROLLER_H
+#define BITRATE_CONTROLLER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * One step of the quality ladder
+ */
+struct BitrateRung {
+    uint8_t frameSize;       // framesize_t value (FRAMESIZE_QVGA, ...)
+    uint8_t jpegQuality;     // 0-63, lower = better quality, more bytes
+    uint16_t intervalMs;     // frame interval
+};
+
+/**
+ * Controller configuration
+ * - Ladder is ordered from lowest (index 0) to highest bitrate
+ */
+struct BitrateConfig {
+    const BitrateRung* ladder = NULL;
+    size_t ladderSize = 0;
+    size_t initialRung = 0;
+    uint32_t windowMs = 1000;          // evaluation period
+    float ewmaAlpha = 0.3f;            // smoothing of send time / frame size
+    float downUtilization = 0.9f;      // avg send time / interval above this → step down
+    float upUtilization = 0.45f;       // avg send time / interval below this → candidate for step up
+    float emergencyFactor = 3.0f;      // single send > factor × interval → step down immediately
+    uint32_t upHoldMs = 5000;          // good conditions required before stepping up
+    uint32_t minDwellMs = 2000;        // minimum time on a rung after a switch
+    uint32_t upBackoffMs = 10000;      // extra hold after a step down (anti-oscillation)
+    int8_t rssiDownDbm = -80;          // RSSI below this → step down
+    int8_t rssiUpDbm = -72;            // RSSI must be above this to step up
+};
+
+/**
+ * Controller state snapshot
+ */
+struct BitrateStats {
+    size_t rung;               // current ladder index
+    uint32_t switchesUp;
+    uint32_t switchesDown;
+    uint32_t framesMeasured;
+    float avgSendMs;           // EWMA of per-frame send time
+    float avgFrameBytes;       // EWMA of frame size
+    float throughputKbps;      // achieved bytes/sec over the last window (×8/1000)
+    int8_t rssiDbm;            // last reported RSSI
+    float utilization;         // avgSendMs / intervalMs
+};
+
+/**
+ * Adaptive bitrate controller
+ */
+class BitrateController {
+public:
+    /**
+     * Constructor
+     * @param config Ladder and thresholds
+     */
+    explicit BitrateController(const BitrateConfig& config);
+
+    /**
+     * Record one completed send
+     * @param bytes Frame size
+     * @param sendUs Time spent in sendBIN()
+     * @param nowMs Current time
+     * @return true if an emergency step down happened (apply getRung())
+     */
+    bool onFrameSent(size_t bytes, uint32_t sendUs, uint32_t nowMs);
+
+    /**
+     * Record the current WiFi signal strength
+     */
+    void onRssi(int8_t rssiDbm);
+
+    /**
+     * Evaluate the window and move along the ladder if needed
+     * @param nowMs Current time
+     * @return true if the rung changed (apply getRung())
+     */
+    bool update(uint32_t nowMs);
+
+    /**
+     * Jump to a rung (e.g. operator override); resets hold timers
+     */
+    void setRung(size_t index, uint32_t nowMs);
+
+    const BitrateRung& getRung() const { return _config.ladder[_rung]; }
+    size_t getRungIndex() const { return _rung; }
+    BitrateStats getStats() const;
+
+private:
+    bool stepDown(uint32_t nowMs);
+    bool stepUp(uint32_t nowMs);
+    float utilization() const;
+
+    BitrateConfig _config;
+    size_t _rung;
+    float _avgSendMs;
+    float _avgFrameBytes;
+    bool _hasSamples;
+    int8_t _rssiDbm;
+    uint32_t _windowStartMs;
+    uint32_t _windowBytes;
+    uint32_t _windowSendUs;
+    float _throughputKbps;
+    uint32_t _lastSwitchMs;
+    uint32_t _goodSinceMs;
+    bool _good;
+    uint32_t _upBlockedUntilMs;
+    uint32_t _switchesUp;
+    uint32_t _switchesDown;
+    uint32_t _framesMeasured;
+};
+
+#endif // BITRATE_CONTROLLER_H
@@ -0,0 +1,86 @@
+/**
+ * `AllocCounter.cpp`
+ * - Counting replacements of the global operator new/delete
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#include "AllocCounter.h"
+
+#include <stdlib.h>
+
+#include <atomic>
+#include <new>
+
+namespace {
+
+std::atomic<uint32_t> allocationCount(0);
+std::atomic<uint32_t> deallocationCount(0);
+std::atomic<uint32_t> platformCount(0);
+thread_local uint32_t exemptDepth = 0;
+
+void* countedAlloc(size_t size) {
+    (exemptDepth > 0 ? platformCount : allocationCount).fetch_add(1, std::memory_order_relaxed);
+    return malloc(size != 0 ? size : 1);
+}
+
+void* countedAllocOrThrow(size_t size) {
+    void* ptr = countedAlloc(size);
+    if (ptr == NULL) {
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS)
+        throw std::bad_alloc();
+#else
+        abort();
+#endif
+    }
+    return ptr;
+}
+
+void countedFree(void* ptr) {
+    if (ptr != NULL) {
+        deallocationCount.fetch_add(1, std::memory_order_relaxed);
+        free(ptr);
+    }
+}
+
+}  // namespace
+
+uint32_t AllocCounter::allocations() {
+    return allocationCount.load(std::memory_order_relaxed);
+}
+
+uint32_t AllocCounter::deallocations() {
+    return deallocationCount.load(std::memory_order_relaxed);
+}
+
+uint32_t AllocCounter::platformAllocations() {
+    return platformCount.load(std::memory_order_relaxed);
+}
+
+AllocExempt::AllocExempt() {
+    exemptDepth++;
+}
+
+AllocExempt::~AllocExempt() {
+    exemptDepth--;
+}
+
+// ========================================
+// Replacement Operators
+// ========================================
+void* operator new(size_t size) { return countedAllocOrThrow(size); }
+void* operator new[](size_t size) { return countedAllocOrThrow(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return countedAlloc(size); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return countedAlloc(size); }
+
+void operator delete(void* ptr) noexcept { countedFree(ptr); }
+void operator delete[](void* ptr) noexcept { countedFree(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { countedFree(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { countedFree(ptr); }
+#if __cpp_sized_deallocation
+void operator delete(void* ptr, size_t) noexcept { countedFree(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { countedFree(ptr); }
+#endif
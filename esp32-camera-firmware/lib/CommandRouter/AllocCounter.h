@@ -0,0 +1,68 @@
+/**
+ * `AllocCounter.h`
+ * - Counts heap allocations made through C++ operator new/delete
+ * - The replacement operators are linked in with this module (host and device alike), so
+ *   every new/delete in the program is counted: library containers, std::function,
+ *   Arduino String on the host shim
+ * - Used to prove that the steady-state frame and command paths never allocate
+ *   (host unit tests, `allocs` in the STATS snapshot); plain malloc() is not seen
+ * - Code standing in for the platform on the host (hal/native shims: lwIP send buffers,
+ *   camera driver) marks its allocations with AllocExempt so they are counted apart
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#ifndef ALLOC_COUNTER_H
+#define ALLOC_COUNTER_H
+
+#include <stdint.h>
+
+/**
+ * Global allocation counters
+ */
+class AllocCounter {
+public:
+    /**
+     * operator new calls since boot (all variants)
+     */
+    static uint32_t allocations();
+
+    /**
+     * operator delete calls since boot (null pointers excluded)
+     */
+    static uint32_t deallocations();
+
+    /**
+     * operator new calls made under an AllocExempt (not in allocations())
+     */
+    static uint32_t platformAllocations();
+};
+
+/**
+ * Counts the current thread's allocations as platform allocations while alive (nestable)
+ */
+class AllocExempt {
+public:
+    AllocExempt();
+    ~AllocExempt();
+
+    AllocExempt(const AllocExempt&) = delete;
+    AllocExempt& operator=(const AllocExempt&) = delete;
+};
+
+/**
+ * Allocations made since construction (checks a code path in tests)
+ */
+class AllocScope {
+public:
+    AllocScope() : _start(AllocCounter::allocations()) {}
+    uint32_t allocations() const { return AllocCounter::allocations() - _start; }
+
+private:
+    uint32_t _start;
+};
+
+#endif // ALLOC_COUNTER_H
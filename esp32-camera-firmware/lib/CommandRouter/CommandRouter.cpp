@@ -0,0 +1,163 @@
+/**
+ * `CommandRouter.cpp`
+ * - Table-driven command dispatch and fixed reply buffer
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#include "CommandRouter.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+// ========================================
+// CommandReply
+// ========================================
+void CommandReply::clear() {
+    _length = 0;
+    _overflow = false;
+    _text[0] = '\0';
+}
+
+bool CommandReply::appendf(const char* format, ...) {
+    if (_overflow) {
+        return false;
+    }
+    va_list args;
+    va_start(args, format);
+    int written = vsnprintf(_text + _length, kCapacity - _length, format, args);
+    va_end(args);
+    if (written < 0 || (size_t)written >= kCapacity - _length) {
+        _overflow = true;
+        _text[_length] = '\0';
+        return false;
+    }
+    _length += (size_t)written;
+    return true;
+}
+
+bool CommandReply::append(const char* text) {
+    if (_overflow) {
+        return false;
+    }
+    size_t length = strlen(text);
+    if (length >= kCapacity - _length) {
+        _overflow = true;
+        return false;
+    }
+    memcpy(_text + _length, text, length + 1);
+    _length += length;
+    return true;
+}
+
+// ========================================
+// CommandRouter
+// ========================================
+CommandRouter::CommandRouter(const CommandEntry* table, size_t count)
+    : _table(table),
+      _count(count),
+      _stats() {
+    _argument[0] = '\0';
+}
+
+const CommandEntry* CommandRouter::find(uint8_t opcode) const {
+    // Valid tables hold opcode n at index n - 1
+    if (opcode == 0 || opcode > _count) {
+        return NULL;
+    }
+    return &_table[opcode - 1];
+}
+
+const CommandEntry* CommandRouter::find(const char* name, size_t length) const {
+    for (size_t i = 0; i < _count; i++) {
+        const char* candidate = _table[i].name;
+        if (strncmp(candidate, name, length) == 0 && candidate[length] == '\0') {
+            return &_table[i];
+        }
+    }
+    return NULL;
+}
+
+CommandStatus CommandRouter::dispatchText(const char* message, size_t length) {
+    const char* colon = (const char*)memchr(message, ':', length);
+    size_t nameLength = colon != NULL ? (size_t)(colon - message) : length;
+    const CommandEntry* entry = find(message, nameLength);
+    if (entry == NULL) {
+        _stats.unknown++;
+        return CommandStatus::Unknown;
+    }
+    const char* argument = colon != NULL ? colon + 1 : message + length;
+    CommandStatus status = invoke(*entry, argument, length - (size_t)(argument - message), false);
+    if (status == CommandStatus::Handled) {
+        _stats.text++;
+    }
+    return status;
+}
+
+CommandStatus CommandRouter::dispatchBinary(const uint8_t* message, size_t length) {
+    if (!isBinaryCommand(message, length)) {
+        _stats.malformed++;
+        return CommandStatus::Malformed;
+    }
+    size_t argumentLength = ((size_t)message[2] << 8) | message[3];
+    if (kCommandHeaderSize + argumentLength != length) {
+        _stats.malformed++;
+        return CommandStatus::Malformed;
+    }
+    const CommandEntry* entry = find(message[1]);
+    if (entry == NULL) {
+        _stats.unknown++;
+        return CommandStatus::Unknown;
+    }
+    CommandStatus status = invoke(*entry, (const char*)message + kCommandHeaderSize, argumentLength, true);
+    if (status == CommandStatus::Handled) {
+        _stats.binary++;
+    }
+    return status;
+}
+
+CommandStatus CommandRouter::invoke(const CommandEntry& entry, const char* argument, size_t length, bool binary) {
+    if (length > kMaxArgument) {
+        _stats.malformed++;
+        return CommandStatus::Malformed;
+    }
+    // Handlers get a terminated copy (text payloads are not terminated after the argument in general)
+    memcpy(_argument, argument, length);
+    _argument[length] = '\0';
+
+    CommandArgs args;
+    args.opcode = entry.opcode;
+    args.argument = _argument;
+    args.argumentLength = length;
+    args.binary = binary;
+
+    _reply.clear();
+    entry.handler(args, _reply);
+    if (_reply.overflowed()) {
+        _stats.replyOverflows++;
+    }
+    return CommandStatus::Handled;
+}
+
+bool CommandRouter::isBinaryCommand(const uint8_t* message, size_t length) {
+    return length >= kCommandHeaderSize && message[0] == kCommandMagic;
+}
+
+size_t CommandRouter::encodeBinary(uint8_t opcode, const char* argument, size_t argumentLength,
+                                   uint8_t* out, size_t capacity) {
+    if (argumentLength > kMaxArgument || kCommandHeaderSize + argumentLength > capacity) {
+        return 0;
+    }
+    out[0] = kCommandMagic;
+    out[1] = opcode;
+    out[2] = (uint8_t)(argumentLength >> 8);
+    out[3] = (uint8_t)argumentLength;
+    if (argumentLength > 0) {
+        memcpy(out + kCommandHeaderSize, argument, argumentLength);
+    }
+    return kCommandHeaderSize + argumentLength;
+}
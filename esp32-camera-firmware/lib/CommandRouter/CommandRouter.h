@@ -0,0 +1,198 @@
+/**
+ * `CommandRouter.h`
+ * - Control command dispatch without heap allocation
+ * - Commands are registered at compile time in a constant table of {opcode, name, handler};
+ *   CommandRouter::isValidTable() checks the table in a static_assert
+ * - Text form: `NAME` or `NAME:<argument>` (the existing protocol, matched in place)
+ * - Binary form: [kCommandMagic][opcode][argument length u16, big-endian][argument]
+ *   (opcode indexes the table directly, no name matching)
+ * - Handlers render their reply into the router's preallocated CommandReply
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#ifndef COMMAND_ROUTER_H
+#define COMMAND_ROUTER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Command opcodes (binary form; the table must list them in this order)
+ */
+enum CommandOpcode : uint8_t {
+    kCommandLedOn = 1,
+    kCommandLedOff = 2,
+    kCommandLedStatus = 3,
+    kCommandStats = 4,
+    kCommandRecList = 5,
+    kCommandRecExport = 6,      // argument `<fromMs>:<toMs>`
+    kCommandRoi = 7,            // argument `<x>:<y>:<w>:<h>` (‰ of the field of view), none = status
+    kCommandRoiOff = 8,
+    kCommandDemand = 9,         // argument `<live>:<analyzer>` (relay consumer set), none = status
+    kCommandCredit = 10,        // argument `<n>` (frame credits from the relay), none = status
+    kCommandCaps = 11,          // camera capabilities
+    kCommandProfile = 12,       // argument `<size>:<quality>:<intervalMs>[:<xclkMhz>]` or `AUTO`, none = status
+    kCommandJpegSync = 13,      // compact frames on, next frame defines the JPEG header
+    kCommandSnapshot = 14,      // argument `[<size>[:<quality>]]` (high-resolution still), none = Config.h defaults
+    kCommandLuma = 15           // argument `<intervalMs>` (gray plane side-stream, 0 = off) | `KEY` (next plane is a key plane), none = status
+};
+
+static const uint8_t kCommandMagic = 0xC7;        // first byte of a binary command
+static const size_t kCommandHeaderSize = 4;
+
+/**
+ * Fixed-capacity reply text
+ */
+class CommandReply {
+public:
+    static constexpr size_t kCapacity = 1024;
+
+    CommandReply() : _length(0), _overflow(false) { _text[0] = '\0'; }
+
+    void clear();
+
+    /**
+     * Append printf output
+     * @return false if it does not fit (the reply is then discarded as a whole)
+     */
+    bool appendf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+    bool append(const char* text);
+
+    const char* text() const { return _text; }
+    char* data() { return _text; }
+    size_t length() const { return _overflow ? 0 : _length; }
+    bool isEmpty() const { return length() == 0; }
+    bool overflowed() const { return _overflow; }
+
+private:
+    char _text[kCapacity];
+    size_t _length;
+    bool _overflow;
+};
+
+/**
+ * Parsed command handed to a handler
+ */
+struct CommandArgs {
+    uint8_t opcode;
+    const char* argument;      // NUL-terminated copy (empty if none)
+    size_t argumentLength;
+    bool binary;               // arrived in the binary form
+};
+
+typedef void (*CommandHandler)(const CommandArgs& args, CommandReply& reply);
+
+/**
+ * Command table entry
+ */
+struct CommandEntry {
+    uint8_t opcode;
+    const char* name;
+    CommandHandler handler;
+};
+
+/**
+ * Dispatch result
+ */
+enum class CommandStatus : uint8_t {
+    Handled,       // handler ran (reply() may be empty)
+    Unknown,       // no such command
+    Malformed      // binary framing error or argument too long
+};
+
+/**
+ * Dispatch counters
+ */
+struct CommandRouterStats {
+    uint32_t text;             // text commands handled
+    uint32_t binary;           // binary commands handled
+    uint32_t unknown;
+    uint32_t malformed;
+    uint32_t replyOverflows;   // replies dropped because they did not fit
+};
+
+/**
+ * Command router
+ */
+class CommandRouter {
+public:
+    static constexpr size_t kMaxArgument = 63;
+
+    /**
+     * Constructor
+     * @param table Constant command table (checked with isValidTable at compile time)
+     */
+    CommandRouter(const CommandEntry* table, size_t count);
+
+    /**
+     * Check a command table: opcodes 1..N in table order, every entry named, names unique
+     */
+    template <size_t N>
+    static constexpr bool isValidTable(const CommandEntry (&table)[N]) {
+        return validFrom(table, N, 0);
+    }
+
+    /**
+     * Dispatch a text message (`NAME` or `NAME:<argument>`)
+     */
+    CommandStatus dispatchText(const char* message, size_t length);
+
+    /**
+     * Dispatch a binary command message
+     */
+    CommandStatus dispatchBinary(const uint8_t* message, size_t length);
+
+    /**
+     * Check if a binary message is a command (vs. other binary traffic)
+     */
+    static bool isBinaryCommand(const uint8_t* message, size_t length);
+
+    /**
+     * Encode a binary command
+     * @return Bytes written (0 if the buffer is too small or the argument too long)
+     */
+    static size_t encodeBinary(uint8_t opcode, const char* argument, size_t argumentLength,
+                               uint8_t* out, size_t capacity);
+
+    /**
+     * Reply of the last dispatched command (valid until the next dispatch)
+     */
+    const CommandReply& reply() const { return _reply; }
+    CommandReply& reply() { return _reply; }
+
+    const CommandEntry* find(uint8_t opcode) const;
+    const CommandEntry* find(const char* name, size_t length) const;
+    size_t size() const { return _count; }
+
+    CommandRouterStats getStats() const { return _stats; }
+
+private:
+    static constexpr bool sameName(const char* a, const char* b) {
+        return *a == *b && (*a == '\0' || sameName(a + 1, b + 1));
+    }
+    static constexpr bool nameUnique(const CommandEntry* table, size_t count, size_t index, size_t other) {
+        return other >= count ||
+               ((other == index || !sameName(table[index].name, table[other].name)) &&
+                nameUnique(table, count, index, other + 1));
+    }
+    static constexpr bool validFrom(const CommandEntry* table, size_t count, size_t index) {
+        return index >= count ||
+               (table[index].opcode == index + 1 && table[index].name != nullptr &&
+                table[index].name[0] != '\0' && table[index].handler != nullptr &&
+                nameUnique(table, count, index, index + 1) && validFrom(table, count, index + 1));
+    }
+
+    CommandStatus invoke(const CommandEntry& entry, const char* argument, size_t length, bool binary);
+
+    const CommandEntry* _table;
+    size_t _count;
+    CommandReply _reply;
+    char _argument[kMaxArgument + 1];
+    CommandRouterStats _stats;
+};
+
+#endif // COMMAND_ROUTER_H
@@ -0,0 +1,125 @@
+/**
+ * `FlowCredit.cpp`
+ * - Credit-based flow control implementation
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#include "FlowCredit.h"
+
+#include <string.h>
+
+static const char kGrantPrefix[] = "CREDIT:";
+static const size_t kGrantPrefixLength = sizeof(kGrantPrefix) - 1;
+
+// ========================================
+// Constructor
+// ========================================
+FlowCredit::FlowCredit(const FlowCreditConfig& config)
+    : _config(config), _limited(false), _waiting(false), _credits(0), _waitStartMs(0), _stats() {
+}
+
+// ========================================
+// Grants
+// ========================================
+bool FlowCredit::parse(const char* text, uint32_t& credits) {
+    if (text == NULL || *text == '\0') {
+        return false;
+    }
+    uint32_t value = 0;
+    for (const char* p = text; *p != '\0'; p++) {
+        if (*p < '0' || *p > '9' || p - text >= 5) {
+            return false;
+        }
+        value = value * 10 + (uint32_t)(*p - '0');
+    }
+    if (value == 0 || value > 0xFFFF) {
+        return false;
+    }
+    credits = value;
+    return true;
+}
+
+bool FlowCredit::isGrant(const char* text, size_t length, uint32_t& credits) {
+    if (text == NULL || length <= kGrantPrefixLength || length > kGrantPrefixLength + 5 ||
+        memcmp(text, kGrantPrefix, kGrantPrefixLength) != 0) {
+        return false;
+    }
+    char digits[6];
+    memcpy(digits, text + kGrantPrefixLength, length - kGrantPrefixLength);
+    digits[length - kGrantPrefixLength] = '\0';
+    return parse(digits, credits);
+}
+
+void FlowCredit::grant(uint32_t credits, uint32_t nowMs) {
+    _stats.grants++;
+    _stats.granted += credits;
+    if (!_limited) {
+        _limited = true;
+        _credits = 0;   // the first grant is the whole window
+    }
+    uint32_t room = _config.maxCredits - _credits;
+    if (credits > room) {
+        _stats.clipped += credits - room;
+        credits = room;
+    }
+    _credits += credits;
+    if (_credits > 0) {
+        endWait(nowMs);
+    }
+}
+
+void FlowCredit::reset(uint32_t nowMs) {
+    endWait(nowMs);
+    _limited = false;
+    _credits = 0;
+}
+
+// ========================================
+// Sending
+// ========================================
+bool FlowCredit::canSend(uint32_t nowMs) {
+    if (!_limited || _credits > 0) {
+        return true;
+    }
+    if (!_waiting) {
+        _waiting = true;
+        _waitStartMs = nowMs;
+        _stats.waits++;
+        return false;
+    }
+    return _config.stallTimeoutMs > 0 && nowMs - _waitStartMs >= _config.stallTimeoutMs;
+}
+
+void FlowCredit::onSent(uint32_t nowMs) {
+    if (!_limited) {
+        return;
+    }
+    if (_credits > 0) {
+        _credits--;
+        _stats.sent++;
+        return;
+    }
+    // Probe after a stall: the next probe waits a full timeout again
+    _stats.probes++;
+    endWait(nowMs);
+}
+
+void FlowCredit::endWait(uint32_t nowMs) {
+    if (!_waiting) {
+        return;
+    }
+    _waiting = false;
+    uint32_t waitedMs = nowMs - _waitStartMs;
+    _stats.waitMs += waitedMs;
+    if (waitedMs > _stats.maxWaitMs) {
+        _stats.maxWaitMs = waitedMs;
+    }
+}
+
+void FlowCredit::resetStats() {
+    _stats = FlowCreditStats();
+}
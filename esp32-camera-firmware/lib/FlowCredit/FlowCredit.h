@@ -0,0 +1,105 @@
+/**
+ * `FlowCredit.h`
+ * - Credit-based flow control of the live upload (`CREDIT:<n>` from the relay)
+ * - The relay grants a window of frame credits on connect and returns one credit per live
+ *   frame it has passed on to its consumers; a live frame is only sent while a credit is
+ *   held, so at most `window` frames are ever queued between the camera and the viewers
+ * - Without credit the sender keeps its pending frame and replaces it with each newer
+ *   capture (pipeline queue with DropOldest), so the frame that goes out next is the newest
+ * - Until the relay grants credit (older servers never do) the upload is not limited;
+ *   reset() on disconnect returns to that state
+ * - A frame is let through after stallTimeoutMs without credit, so a relay that lost
+ *   track of the window cannot stop the stream for good
+ * - Platform independent: time is passed in, not thread-safe (owned by the WebSocket context)
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#ifndef FLOW_CREDIT_H
+#define FLOW_CREDIT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Flow control configuration
+ */
+struct FlowCreditConfig {
+    uint32_t maxCredits = 8;           // credits held at most (larger grants are clipped)
+    uint32_t stallTimeoutMs = 3000;    // send one frame after waiting this long (0 = wait forever)
+};
+
+/**
+ * Flow control counters
+ */
+struct FlowCreditStats {
+    uint32_t grants;           // CREDIT messages applied
+    uint32_t granted;          // credits received
+    uint32_t clipped;          // credits above maxCredits discarded
+    uint32_t sent;             // frames sent on a credit
+    uint32_t probes;           // frames sent after stallTimeoutMs without credit
+    uint32_t waits;            // times the sender ran out of credit
+    uint64_t waitMs;           // total time spent without credit
+    uint32_t maxWaitMs;
+};
+
+/**
+ * Frame credit window
+ */
+class FlowCredit {
+public:
+    explicit FlowCredit(const FlowCreditConfig& config);
+
+    /**
+     * Parse a grant argument (`<n>`, 1-65535)
+     * @return false if malformed
+     */
+    static bool parse(const char* text, uint32_t& credits);
+
+    /**
+     * Check if a text message is a grant (`CREDIT:<n>`, not necessarily NUL-terminated)
+     * @param credits Parsed credit count
+     */
+    static bool isGrant(const char* text, size_t length, uint32_t& credits);
+
+    /**
+     * Apply credits from the relay (enables flow control on the first grant)
+     */
+    void grant(uint32_t credits, uint32_t nowMs);
+
+    /**
+     * Connection lost: unlimited until the next relay grants credit
+     */
+    void reset(uint32_t nowMs);
+
+    /**
+     * Check if a live frame may be sent now (starts a wait when it may not)
+     */
+    bool canSend(uint32_t nowMs);
+
+    /**
+     * A live frame was sent (consumes a credit, or counts a stall probe)
+     */
+    void onSent(uint32_t nowMs);
+
+    bool isLimited() const { return _limited; }
+    uint32_t getCredits() const { return _credits; }
+
+    const FlowCreditStats& getStats() const { return _stats; }
+    void resetStats();
+
+private:
+    void endWait(uint32_t nowMs);
+
+    FlowCreditConfig _config;
+    bool _limited;
+    bool _waiting;
+    uint32_t _credits;
+    uint32_t _waitStartMs;
+    FlowCreditStats _stats;
+};
+
+#endif // FLOW_CREDIT_H
@@ -0,0 +1,122 @@
+/**
+ * `ControlQueue.cpp`
+ * - Control message priority queue implementation
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#include "ControlQueue.h"
+
+#include <string.h>
+
+ControlQueue::ControlQueue(char* storage, size_t slots, size_t slotSize)
+    : _storage(storage),
+      _slotCount(slots < kMaxSlots ? slots : kMaxSlots),
+      _slotSize(slotSize),
+      _count(0),
+      _nextOrder(0),
+      _stats() {
+    clear();
+}
+
+void ControlQueue::clear() {
+    for (size_t i = 0; i < kMaxSlots; i++) {
+        _slots[i].used = false;
+    }
+    _count = 0;
+}
+
+int ControlQueue::findFront() const {
+    int best = -1;
+    for (size_t i = 0; i < _slotCount; i++) {
+        const Slot& slot = _slots[i];
+        if (!slot.used) {
+            continue;
+        }
+        // Order wraps after 2^32 pushes: compare by distance
+        if (best < 0 || slot.priority < _slots[best].priority ||
+            (slot.priority == _slots[best].priority && (int32_t)(slot.order - _slots[best].order) < 0)) {
+            best = (int)i;
+        }
+    }
+    return best;
+}
+
+int ControlQueue::findFree() const {
+    for (size_t i = 0; i < _slotCount; i++) {
+        if (!_slots[i].used) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+int ControlQueue::findEvictable(ControlPriority priority) const {
+    // Oldest message of the lowest priority below `priority`
+    int victim = -1;
+    for (size_t i = 0; i < _slotCount; i++) {
+        const Slot& slot = _slots[i];
+        if (!slot.used || slot.priority <= priority) {
+            continue;
+        }
+        if (victim < 0 || slot.priority > _slots[victim].priority ||
+            (slot.priority == _slots[victim].priority && (int32_t)(slot.order - _slots[victim].order) < 0)) {
+            victim = (int)i;
+        }
+    }
+    return victim;
+}
+
+bool ControlQueue::push(const char* text, size_t length, ControlPriority priority) {
+    if (length == 0 || length > _slotSize || length > UINT16_MAX) {
+        _stats.refused++;
+        return false;
+    }
+    int index = findFree();
+    if (index < 0) {
+        index = findEvictable(priority);
+        if (index < 0) {
+            _stats.refused++;
+            return false;
+        }
+        _slots[index].used = false;
+        _count--;
+        _stats.evicted++;
+    }
+
+    Slot& slot = _slots[index];
+    memcpy(_storage + (size_t)index * _slotSize, text, length);
+    slot.order = _nextOrder++;
+    slot.length = (uint16_t)length;
+    slot.priority = priority;
+    slot.used = true;
+    _count++;
+    _stats.queued++;
+    if (_count > _stats.maxDepth) {
+        _stats.maxDepth = (uint32_t)_count;
+    }
+    return true;
+}
+
+bool ControlQueue::front(const char*& text, size_t& length) const {
+    int index = findFront();
+    if (index < 0) {
+        return false;
+    }
+    text = _storage + (size_t)index * _slotSize;
+    length = _slots[index].length;
+    return true;
+}
+
+void ControlQueue::pop() {
+    int index = findFront();
+    if (index < 0) {
+        return;
+    }
+    _slots[index].used = false;
+    _count--;
+    _stats.sent++;
+}
@@ -0,0 +1,104 @@
+/**
+ * `ControlQueue.h`
+ * - Small priority queue of outgoing text control messages (command replies, notices)
+ * - Drained whenever the sender services the WebSocket, including between the parts of a
+ *   chunked frame, so replies do not wait for the rest of the frame
+ * - Fixed slots in caller-owned memory, no heap; highest priority first, FIFO within a priority
+ * - When full, a new message evicts the oldest message of lower priority, otherwise it is refused
+ * - Platform independent, not thread-safe (owned by the task that owns the WebSocket)
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#ifndef CONTROL_QUEUE_H
+#define CONTROL_QUEUE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Message priority (lower value is sent first)
+ */
+enum class ControlPriority : uint8_t {
+    High = 0,      // command replies
+    Normal = 1     // notices (export done, ...)
+};
+
+/**
+ * Queue counters
+ */
+struct ControlQueueStats {
+    uint32_t queued;
+    uint32_t sent;             // popped after a successful send
+    uint32_t evicted;          // lower-priority messages replaced by higher ones
+    uint32_t refused;          // queue full of equal/higher priority, or message too long
+    uint32_t maxDepth;
+};
+
+/**
+ * Fixed-slot control message queue
+ */
+class ControlQueue {
+public:
+    static constexpr size_t kMaxSlots = 16;
+
+    /**
+     * Constructor
+     * @param storage Caller-owned slot memory, `slots * slotSize` bytes
+     * @param slots Number of messages (at most kMaxSlots)
+     * @param slotSize Longest message
+     */
+    ControlQueue(char* storage, size_t slots, size_t slotSize);
+
+    /**
+     * Queue a copy of a message
+     * @return false if it was refused (caller may send it directly instead)
+     */
+    bool push(const char* text, size_t length, ControlPriority priority);
+
+    /**
+     * Next message to send
+     * @return false if the queue is empty
+     */
+    bool front(const char*& text, size_t& length) const;
+
+    /**
+     * Remove the front message after it was sent
+     */
+    void pop();
+
+    /**
+     * Drop everything (connection closed: replies are for the old session)
+     */
+    void clear();
+
+    size_t size() const { return _count; }
+    bool isEmpty() const { return _count == 0; }
+
+    ControlQueueStats getStats() const { return _stats; }
+
+private:
+    struct Slot {
+        uint32_t order;        // push order, FIFO within a priority
+        uint16_t length;
+        ControlPriority priority;
+        bool used;
+    };
+
+    int findFront() const;
+    int findFree() const;
+    int findEvictable(ControlPriority priority) const;
+
+    char* _storage;
+    size_t _slotCount;
+    size_t _slotSize;
+    Slot _slots[kMaxSlots];
+    size_t _count;
+    uint32_t _nextOrder;
+    ControlQueueStats _stats;
+};
+
+#endif // CONTROL_QUEUE_H
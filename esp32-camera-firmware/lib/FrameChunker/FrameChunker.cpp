@@ -0,0 +1,184 @@
+/**
+ * `FrameChunker.cpp`
+ * - Frame part splitting and reassembly implementation
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#include "FrameChunker.h"
+
+#include <string.h>
+
+#include <FrameEnvelope.h>
+
+static const uint8_t kPartMagic[3] = {'C', 'A', 'P'};
+
+static inline void put32(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)(v >> 24);
+    p[1] = (uint8_t)(v >> 16);
+    p[2] = (uint8_t)(v >> 8);
+    p[3] = (uint8_t)v;
+}
+
+static inline uint32_t get32(const uint8_t* p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+// ========================================
+// FrameChunker
+// ========================================
+FrameChunker::FrameChunker(size_t chunkSize, size_t headroom)
+    : _chunkSize(chunkSize),
+      _message(NULL),
+      _payload(NULL),
+      _headerLength(0),
+      _payloadLength(0),
+      _offset(0),
+      _sequence(0),
+      _index(0) {
+    // A part header and the transport header room must fit into the previous chunk
+    if (_chunkSize > 0 && _chunkSize < kPartHeaderSize + headroom) {
+        _chunkSize = kPartHeaderSize + headroom;
+    }
+}
+
+size_t FrameChunker::partCount(size_t payloadLength) const {
+    if (!isChunked(payloadLength)) {
+        return 1;
+    }
+    return (payloadLength + _chunkSize - 1) / _chunkSize;
+}
+
+void FrameChunker::begin(uint8_t* message, size_t headerLength, size_t payloadLength, uint32_t sequence) {
+    _message = message;
+    _payload = message + headerLength;
+    _headerLength = headerLength;
+    _payloadLength = payloadLength;
+    _offset = 0;
+    _sequence = sequence;
+    _index = 0;
+}
+
+bool FrameChunker::next(FrameChunk& chunk) {
+    if (_message == NULL || (_index > 0 && _offset >= _payloadLength)) {
+        return false;
+    }
+    size_t remaining = _payloadLength - _offset;
+    size_t length = isChunked(_payloadLength) && remaining > _chunkSize ? _chunkSize : remaining;
+
+    if (_index == 0) {
+        chunk.message = _message;
+        chunk.length = _headerLength + length;
+    } else {
+        // Overwrites the already sent tail of the previous part
+        chunk.message = _payload + _offset - kPartHeaderSize;
+        encodePart(_sequence, (uint32_t)_offset, chunk.message, kPartHeaderSize);
+        chunk.length = kPartHeaderSize + length;
+    }
+    chunk.offset = (uint32_t)_offset;
+    chunk.index = _index;
+    _offset += length;
+    _index++;
+    chunk.last = _offset >= _payloadLength;
+    if (chunk.last) {
+        _message = NULL;
+    }
+    return true;
+}
+
+size_t FrameChunker::encodePart(uint32_t sequence, uint32_t offset, uint8_t* out, size_t capacity) {
+    if (out == NULL || capacity < kPartHeaderSize) {
+        return 0;
+    }
+    memcpy(out, kPartMagic, sizeof(kPartMagic));
+    out[3] = kPartVersion;
+    put32(out + 4, sequence);
+    put32(out + 8, offset);
+    return kPartHeaderSize;
+}
+
+bool FrameChunker::isPart(const uint8_t* data, size_t length) {
+    return data != NULL && length >= 4 &&
+           data[0] == kPartMagic[0] && data[1] == kPartMagic[1] && data[2] == kPartMagic[2];
+}
+
+bool FrameChunker::decodePart(const uint8_t* data, size_t length, FramePart& part) {
+    if (!isPart(data, length) || length < kPartHeaderSize || data[3] < 1) {
+        return false;
+    }
+    part.sequence = get32(data + 4);
+    part.offset = get32(data + 8);
+    part.data = data + kPartHeaderSize;
+    part.length = length - kPartHeaderSize;
+    return true;
+}
+
+// ========================================
+// FrameAssembler
+// ========================================
+FrameAssembler::FrameAssembler(uint8_t* buffer, size_t capacity)
+    : _buffer(buffer),
+      _capacity(capacity),
+      _pending(false),
+      _sequence(0),
+      _received(0),
+      _expected(0),
+      _stats() {
+}
+
+void FrameAssembler::reset() {
+    if (_pending) {
+        _stats.aborted++;
+    }
+    _pending = false;
+    _received = 0;
+    _expected = 0;
+}
+
+AssembleResult FrameAssembler::accept(const uint8_t* message, size_t length) {
+    FrameHeader header;
+    if (FrameEnvelope::decodeHeader(message, length, header)) {
+        if (!(header.flags & kEnvelopeChunked)) {
+            return AssembleResult::Passthrough;
+        }
+        reset();
+        size_t expected = (size_t)header.headerLength + header.payloadLength;
+        if (expected > _capacity || length > expected) {
+            _stats.dropped++;
+            return AssembleResult::Dropped;
+        }
+        memcpy(_buffer, message, length);
+        _buffer[5] &= (uint8_t)~kEnvelopeChunked;  // flags byte
+        _pending = true;
+        _sequence = header.sequence;
+        _received = length;
+        _expected = expected;
+        _stats.parts++;
+    } else {
+        FramePart part;
+        if (!FrameChunker::decodePart(message, length, part)) {
+            return AssembleResult::Passthrough;
+        }
+        size_t headerLength = _buffer[4];
+        if (!_pending || part.sequence != _sequence || headerLength + part.offset != _received ||
+            _received + part.length > _expected) {
+            // A gap cannot be repaired: drop the frame, later parts are orphans
+            reset();
+            _stats.dropped++;
+            return AssembleResult::Dropped;
+        }
+        memcpy(_buffer + _received, part.data, part.length);
+        _received += part.length;
+        _stats.parts++;
+    }
+
+    if (_received < _expected) {
+        return AssembleResult::Pending;
+    }
+    _pending = false;
+    _stats.frames++;
+    return AssembleResult::Complete;
+}
@@ -0,0 +1,178 @@
+/**
+ * `FrameChunker.h`
+ * - Splits one enveloped frame into bounded parts so the sender can service the WebSocket
+ *   (incoming commands, heartbeats, queued control messages) between them
+ * - Each part is a complete binary message. RFC 6455 continuation fragments cannot be used:
+ *   no other data message (command reply, clock sync ping) may be sent until the last
+ *   fragment, so replies would still wait for the whole frame
+ * - First part: [envelope with kEnvelopeChunked][first chunk]; envelope.payloadLength is the
+ *   full JPEG length. Later parts: [part header][next chunk]
+ * - Zero copy: a part header (and the transport's header room) is written in place over the
+ *   tail of the previous part, which has already been sent
+ * - FrameAssembler is the receiver side (stand-in harness, tests)
+ * - Platform independent, not thread-safe
+ *
+ * Part header (version 1, 12 bytes, big-endian):
+ *   0  magic "CAP" (3)        3  version (1)
+ *   4  sequence (4, envelope sequence of the frame)    8  offset (4, payload offset of the chunk)
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#ifndef FRAME_CHUNKER_H
+#define FRAME_CHUNKER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * One part ready to send
+ */
+struct FrameChunk {
+    uint8_t* message;          // part message (the transport header room lies in front of it)
+    size_t length;             // part message length
+    uint32_t offset;           // payload offset of the first chunk byte
+    uint16_t index;            // 0 = first part (carries the envelope)
+    bool last;
+};
+
+/**
+ * Decoded part header
+ */
+struct FramePart {
+    uint32_t sequence;
+    uint32_t offset;
+    const uint8_t* data;       // chunk bytes
+    size_t length;
+};
+
+/**
+ * Sender side: iterate the parts of one frame
+ */
+class FrameChunker {
+public:
+    static constexpr uint8_t kPartVersion = 1;
+    static constexpr size_t kPartHeaderSize = 12;
+
+    /**
+     * Constructor
+     * @param chunkSize Payload bytes per part (0 = never chunk); raised to fit the part
+     *                  header and the header room if smaller
+     * @param headroom Bytes the transport writes in front of each message
+     *                 (WEBSOCKETS_MAX_HEADER_SIZE with headerToPayload)
+     */
+    FrameChunker(size_t chunkSize, size_t headroom);
+
+    /**
+     * Check if a payload is split (sender sets kEnvelopeChunked before encoding the envelope)
+     */
+    bool isChunked(size_t payloadLength) const { return _chunkSize > 0 && payloadLength > _chunkSize; }
+
+    /**
+     * Number of parts for a payload
+     */
+    size_t partCount(size_t payloadLength) const;
+
+    /**
+     * Start a frame
+     * @param message Encoded envelope followed by the payload (`headroom` writable bytes in front)
+     */
+    void begin(uint8_t* message, size_t headerLength, size_t payloadLength, uint32_t sequence);
+
+    /**
+     * Next part (writes its part header in place)
+     * @return false when the frame is done
+     */
+    bool next(FrameChunk& chunk);
+
+    bool isDone() const { return _message == NULL || _offset >= _payloadLength; }
+    size_t chunkSize() const { return _chunkSize; }
+
+    /**
+     * Encode a part header
+     * @return Bytes written (0 if `out` is too small)
+     */
+    static size_t encodePart(uint32_t sequence, uint32_t offset, uint8_t* out, size_t capacity);
+
+    /**
+     * Parse a part message
+     */
+    static bool decodePart(const uint8_t* data, size_t length, FramePart& part);
+
+    /**
+     * Check for the part magic (envelopes start with "CAM", raw JPEG with FF D8)
+     */
+    static bool isPart(const uint8_t* data, size_t length);
+
+private:
+    size_t _chunkSize;
+    uint8_t* _message;
+    uint8_t* _payload;
+    size_t _headerLength;
+    size_t _payloadLength;
+    size_t _offset;
+    uint32_t _sequence;
+    uint16_t _index;
+};
+
+/**
+ * Result of feeding one message to the assembler
+ */
+enum class AssembleResult : uint8_t {
+    Passthrough,   // not part of a chunked frame, use the message as is
+    Pending,       // part accepted, frame not complete yet
+    Complete,      // frame() holds the whole [envelope][payload]
+    Dropped        // part without a matching frame, out of order, or frame too large
+};
+
+/**
+ * Assembler counters
+ */
+struct FrameAssemblerStats {
+    uint32_t frames;           // chunked frames completed
+    uint32_t parts;            // parts accepted (including first parts)
+    uint32_t dropped;          // parts dropped
+    uint32_t aborted;          // frames abandoned before their last part
+};
+
+/**
+ * Receiver side: reassemble chunked frames (one frame in flight per connection)
+ */
+class FrameAssembler {
+public:
+    /**
+     * Constructor
+     * @param buffer Caller-owned frame buffer (largest envelope + payload)
+     */
+    FrameAssembler(uint8_t* buffer, size_t capacity);
+
+    AssembleResult accept(const uint8_t* message, size_t length);
+
+    /**
+     * Completed frame (valid until the next accept); kEnvelopeChunked is cleared so it
+     * decodes like an unchunked frame
+     */
+    const uint8_t* frame() const { return _buffer; }
+    size_t frameLength() const { return _expected; }
+
+    /**
+     * Forget the pending frame (connection closed)
+     */
+    void reset();
+
+    FrameAssemblerStats getStats() const { return _stats; }
+
+private:
+    uint8_t* _buffer;
+    size_t _capacity;
+    bool _pending;
+    uint32_t _sequence;
+    size_t _received;          // bytes in _buffer (envelope + payload so far)
+    size_t _expected;
+    FrameAssemblerStats _stats;
+};
+
+#endif // FRAME_CHUNKER_H
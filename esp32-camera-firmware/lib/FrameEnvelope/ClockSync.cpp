@@ -0,0 +1,179 @@
+/**
+ * `ClockSync.cpp`
+ * - Clock offset estimation implementation
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#include "ClockSync.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * Parse "<prefix><n>:<n>:..." into `count` unsigned decimal fields
+ */
+static bool parseFields(const char* text, size_t length, const char* prefix, uint64_t* fields, size_t count) {
+    size_t prefixLength = strlen(prefix);
+    if (text == NULL || length <= prefixLength || memcmp(text, prefix, prefixLength) != 0) {
+        return false;
+    }
+    size_t pos = prefixLength;
+    for (size_t i = 0; i < count; i++) {
+        if (i > 0) {
+            if (pos >= length || text[pos] != ':') return false;
+            pos++;
+        }
+        size_t start = pos;
+        uint64_t value = 0;
+        while (pos < length && text[pos] >= '0' && text[pos] <= '9') {
+            value = value * 10 + (uint64_t)(text[pos] - '0');
+            pos++;
+        }
+        if (pos == start) return false;
+        fields[i] = value;
+    }
+    // Trailing fields are allowed (forward compatible)
+    return pos == length || text[pos] == ':' || text[pos] == '\0';
+}
+
+// ========================================
+// Constructor
+// ========================================
+ClockSync::ClockSync(const ClockSyncConfig& config)
+    : _config(config), _samples(), _sampleCount(0), _nextSample(0), _sequence(0), _lastPingUs(0),
+      _pinged(false), _stats(), _mutex() {
+}
+
+void ClockSync::reset() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _sampleCount = 0;
+    _nextSample = 0;
+    _pinged = false;
+    _stats.synced = false;
+    _stats.offsetUs = 0;
+    _stats.rttUs = 0;
+}
+
+// ========================================
+// Device Side
+// ========================================
+bool ClockSync::pingDue(uint64_t nowUs) const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (!_pinged) {
+        return true;
+    }
+    uint32_t intervalMs = _sampleCount < _config.fastSamples ? _config.fastIntervalMs : _config.intervalMs;
+    return nowUs - _lastPingUs >= (uint64_t)intervalMs * 1000ULL;
+}
+
+size_t ClockSync::makePing(uint64_t nowUs, char* out, size_t capacity) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    int written = snprintf(out, capacity, "PING:%u:%llu", (unsigned)(_sequence + 1), (unsigned long long)nowUs);
+    if (written <= 0 || (size_t)written >= capacity) {
+        return 0;
+    }
+    _sequence++;
+    _lastPingUs = nowUs;
+    _pinged = true;
+    _stats.pingsSent++;
+    return (size_t)written;
+}
+
+bool ClockSync::isPong(const char* text, size_t length) {
+    return text != NULL && length > 5 && memcmp(text, "PONG:", 5) == 0;
+}
+
+bool ClockSync::handlePong(const char* text, size_t length, uint64_t nowUs) {
+    uint64_t f[4];  // seq, t0, t1, t2
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (!parseFields(text, length, "PONG:", f, 4)) {
+        _stats.rejected++;
+        return false;
+    }
+    uint64_t t0 = f[1];
+    uint64_t t1 = f[2];
+    uint64_t t2 = f[3];
+    uint32_t seq = (uint32_t)f[0];
+
+    // Only answers to one of our recent pings, with sane timestamps
+    bool known = seq != 0 && seq <= _sequence && _sequence - seq < kWindow;
+    if (!known || nowUs < t0 || t2 < t1 || t2 - t1 > nowUs - t0) {
+        _stats.rejected++;
+        return false;
+    }
+    uint64_t rtt = (nowUs - t0) - (t2 - t1);
+    if (rtt > _config.maxRttUs) {
+        _stats.rejected++;
+        _stats.lastRttUs = (uint32_t)(rtt > 0xFFFFFFFFULL ? 0xFFFFFFFFULL : rtt);
+        return false;
+    }
+
+    Sample sample;
+    sample.offsetUs = ((int64_t)(t1 - t0) + (int64_t)(t2 - nowUs)) / 2;
+    sample.rttUs = (uint32_t)rtt;
+    _samples[_nextSample] = sample;
+    _nextSample = (_nextSample + 1) % kWindow;
+    if (_sampleCount < kWindow) {
+        _sampleCount++;
+    }
+    _stats.pongsReceived++;
+    _stats.lastRttUs = sample.rttUs;
+    selectBest();
+    return true;
+}
+
+void ClockSync::selectBest() {
+    size_t best = 0;
+    for (size_t i = 1; i < _sampleCount; i++) {
+        if (_samples[i].rttUs < _samples[best].rttUs) {
+            best = i;
+        }
+    }
+    _stats.synced = true;
+    _stats.offsetUs = _samples[best].offsetUs;
+    _stats.rttUs = _samples[best].rttUs;
+}
+
+// ========================================
+// Server Side
+// ========================================
+size_t ClockSync::makePong(const char* ping, size_t length, uint64_t receiveUs, uint64_t sendUs,
+                           char* out, size_t capacity) {
+    uint64_t f[2];  // seq, t0
+    if (!parseFields(ping, length, "PING:", f, 2)) {
+        return 0;
+    }
+    int written = snprintf(out, capacity, "PONG:%llu:%llu:%llu:%llu", (unsigned long long)f[0],
+                           (unsigned long long)f[1], (unsigned long long)receiveUs, (unsigned long long)sendUs);
+    if (written <= 0 || (size_t)written >= capacity) {
+        return 0;
+    }
+    return (size_t)written;
+}
+
+// ========================================
+// Accessors
+// ========================================
+uint64_t ClockSync::toServerUs(uint64_t deviceUs) const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _stats.synced ? (uint64_t)((int64_t)deviceUs + _stats.offsetUs) : deviceUs;
+}
+
+bool ClockSync::isSynced() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _stats.synced;
+}
+
+int64_t ClockSync::getOffsetUs() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _stats.offsetUs;
+}
+
+ClockSyncStats ClockSync::getStats() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _stats;
+}
@@ -0,0 +1,126 @@
+/**
+ * `ClockSync.h`
+ * - Lightweight device → server clock offset estimation over the WebSocket
+ * - NTP-style exchange on text messages:
+ *     device: "PING:<seq>:<t0>"                 t0 = device send time (us)
+ *     server: "PONG:<seq>:<t0>:<t1>:<t2>"       t1/t2 = server receive/send time (us)
+ *   offset = ((t1 - t0) + (t2 - t3)) / 2, rtt = (t3 - t0) - (t2 - t1)
+ * - The offset of the lowest-RTT sample in a sliding window is used (least queuing error)
+ * - Platform independent: time is passed in (microseconds)
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#ifndef CLOCK_SYNC_H
+#define CLOCK_SYNC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <mutex>
+
+/**
+ * Clock sync configuration
+ */
+struct ClockSyncConfig {
+    uint32_t intervalMs = 10000;       // ping period once synced
+    uint32_t fastIntervalMs = 1000;    // ping period until the window has `fastSamples` samples
+    size_t fastSamples = 4;
+    uint32_t maxRttUs = 1000000;       // samples slower than this are ignored
+};
+
+/**
+ * Clock sync state snapshot
+ */
+struct ClockSyncStats {
+    bool synced;
+    int64_t offsetUs;          // server clock - device clock
+    uint32_t rttUs;            // RTT of the sample the offset came from
+    uint32_t lastRttUs;        // RTT of the latest sample
+    uint32_t pingsSent;
+    uint32_t pongsReceived;
+    uint32_t rejected;         // malformed, unknown or too slow pongs
+};
+
+/**
+ * Clock offset estimator
+ */
+class ClockSync {
+public:
+    static constexpr size_t kWindow = 8;
+    static constexpr size_t kMaxMessage = 96;
+
+    explicit ClockSync(const ClockSyncConfig& config);
+
+    /**
+     * Check if a ping should be sent now
+     */
+    bool pingDue(uint64_t nowUs) const;
+
+    /**
+     * Build the next ping message
+     * @param nowUs Device time right before sending
+     * @param out Text buffer (kMaxMessage bytes is always enough)
+     * @return Message length (0 if `out` is too small)
+     */
+    size_t makePing(uint64_t nowUs, char* out, size_t capacity);
+
+    /**
+     * Process a pong message
+     * @param text Message payload (need not be NUL-terminated)
+     * @param nowUs Device time at reception (t3)
+     * @return true if the sample was accepted
+     */
+    bool handlePong(const char* text, size_t length, uint64_t nowUs);
+
+    /**
+     * Check if a message is a pong (cheap prefix test for the text handler)
+     */
+    static bool isPong(const char* text, size_t length);
+
+    /**
+     * Server side: answer a ping (used by stand-in servers and tests)
+     * @param receiveUs Server time at reception (t1)
+     * @param sendUs Server time at reply (t2)
+     * @return Reply length (0 if `ping` is malformed)
+     */
+    static size_t makePong(const char* ping, size_t length, uint64_t receiveUs, uint64_t sendUs,
+                           char* out, size_t capacity);
+
+    /**
+     * Map a device timestamp to server time (identity until synced)
+     */
+    uint64_t toServerUs(uint64_t deviceUs) const;
+
+    bool isSynced() const;
+    int64_t getOffsetUs() const;
+    ClockSyncStats getStats() const;
+
+    /**
+     * Forget all samples (e.g. after a reconnect to a different server)
+     */
+    void reset();
+
+private:
+    struct Sample {
+        int64_t offsetUs;
+        uint32_t rttUs;
+    };
+
+    void selectBest();
+
+    ClockSyncConfig _config;
+    Sample _samples[kWindow];
+    size_t _sampleCount;
+    size_t _nextSample;
+    uint32_t _sequence;
+    uint64_t _lastPingUs;
+    bool _pinged;
+    ClockSyncStats _stats;
+    mutable std::mutex _mutex;
+};
+
+#endif // CLOCK_SYNC_H
@@ -0,0 +1,102 @@
+/**
+ * `FrameEnvelope.cpp`
+ * - Frame envelope encoder/decoder implementation
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#include "FrameEnvelope.h"
+
+static const uint8_t kMagic[3] = {'C', 'A', 'M'};
+
+// ========================================
+// Byte Order Helpers
+// ========================================
+static inline void put16(uint8_t* p, uint16_t v) {
+    p[0] = (uint8_t)(v >> 8);
+    p[1] = (uint8_t)v;
+}
+
+static inline void put32(uint8_t* p, uint32_t v) {
+    put16(p, (uint16_t)(v >> 16));
+    put16(p + 2, (uint16_t)v);
+}
+
+static inline void put64(uint8_t* p, uint64_t v) {
+    put32(p, (uint32_t)(v >> 32));
+    put32(p + 4, (uint32_t)v);
+}
+
+static inline uint16_t get16(const uint8_t* p) {
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+static inline uint32_t get32(const uint8_t* p) {
+    return ((uint32_t)get16(p) << 16) | get16(p + 2);
+}
+
+static inline uint64_t get64(const uint8_t* p) {
+    return ((uint64_t)get32(p) << 32) | get32(p + 4);
+}
+
+// ========================================
+// Encode / Decode
+// ========================================
+size_t FrameEnvelope::encode(const FrameHeader& header, uint8_t* out, size_t capacity) {
+    if (out == NULL || capacity < kHeaderSize) {
+        return 0;
+    }
+    out[0] = kMagic[0];
+    out[1] = kMagic[1];
+    out[2] = kMagic[2];
+    out[3] = kVersion;
+    out[4] = (uint8_t)kHeaderSize;
+    out[5] = header.flags;
+    out[6] = header.jpegQuality;
+    out[7] = header.frameSize;
+    put32(out + 8, header.sequence);
+    put64(out + 12, header.captureUs);
+    put64(out + 20, header.sendUs);
+    put64(out + 28, (uint64_t)header.clockOffsetUs);
+    put32(out + 36, header.payloadLength);
+    put16(out + 40, header.width);
+    put16(out + 42, header.height);
+    put16(out + 44, header.motionScore);
+    put16(out + 46, header.headerId);
+    return kHeaderSize;
+}
+
+bool FrameEnvelope::isEnvelope(const uint8_t* data, size_t length) {
+    return data != NULL && length >= 4 && data[0] == kMagic[0] && data[1] == kMagic[1] && data[2] == kMagic[2];
+}
+
+bool FrameEnvelope::decode(const uint8_t* data, size_t length, FrameHeader& header) {
+    return decodeHeader(data, length, header) && (size_t)header.headerLength + header.payloadLength <= length;
+}
+
+bool FrameEnvelope::decodeHeader(const uint8_t* data, size_t length, FrameHeader& header) {
+    if (!isEnvelope(data, length) || length < kHeaderSize) {
+        return false;
+    }
+    header.version = data[3];
+    header.headerLength = data[4];
+    if (header.version < 1 || header.headerLength < kHeaderSize || header.headerLength > length) {
+        return false;
+    }
+    header.flags = data[5];
+    header.jpegQuality = data[6];
+    header.frameSize = data[7];
+    header.sequence = get32(data + 8);
+    header.captureUs = get64(data + 12);
+    header.sendUs = get64(data + 20);
+    header.clockOffsetUs = (int64_t)get64(data + 28);
+    header.payloadLength = get32(data + 36);
+    header.width = get16(data + 40);
+    header.height = get16(data + 42);
+    header.motionScore = get16(data + 44);
+    header.headerId = get16(data + 46);
+    return true;
+}
@@ -0,0 +1,107 @@
+/**
+ * `FrameEnvelope.h`
+ * - Versioned binary envelope sent in front of each JPEG frame
+ * - Carries sequence number, capture/send timestamps, clock offset to the server,
+ *   frame size/quality and flags, so the relay server and viewers can measure
+ *   per-hop latency, detect gaps and reorder
+ * - Platform independent, fixed-size, network byte order (big-endian)
+ *
+ * Wire format (version 1, 48 bytes):
+ *   0  magic "CAM" (3)        3  version (1)          4  headerLength (1)
+ *   5  flags (1)              6  jpegQuality (1)      7  frameSize (1, framesize_t)
+ *   8  sequence (4)           12 captureUs (8)        20 sendUs (8)
+ *   28 clockOffsetUs (8, signed: server = device + offset)
+ *   36 payloadLength (4)      40 width (2)            42 height (2)
+ *   44 motionScore (2)        46 headerId (2, 0 = none; was reserved)
+ * Receivers must skip `headerLength` bytes so later versions can append fields.
+ * Compact frames (JpegHeaderElision.h): with kEnvelopeHeaderElided the payload is the
+ * scan data only and the JPEG preamble is the one last defined as headerId.
+ * Snapshots (SnapshotCapture.h) travel inside "SNP" parts and carry kEnvelopeSnapshot.
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#ifndef FRAME_ENVELOPE_H
+#define FRAME_ENVELOPE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Envelope flags
+ */
+enum FrameEnvelopeFlags : uint8_t {
+    kEnvelopeClockSynced = 0x01,   // clockOffsetUs is valid
+    kEnvelopeMotion = 0x02,        // motion gate scored this frame as motion
+    kEnvelopeHistorical = 0x04,    // recorded during an outage, backfilled later (own sequence space)
+    kEnvelopeRecorded = 0x08,      // read back from the microSD recording (REC_EXPORT, with kEnvelopeHistorical)
+    kEnvelopeChunked = 0x10,       // message holds the first part only, the rest follows in FrameChunker parts
+    kEnvelopeHeaderDefined = 0x20, // whole JPEG whose preamble becomes headerId
+    kEnvelopeHeaderElided = 0x40,  // payload starts after the preamble of headerId
+    kEnvelopeSnapshot = 0x80       // SNAPSHOT still (own id space), sent in SnapshotCapture parts
+};
+
+/**
+ * Decoded envelope fields
+ */
+struct FrameHeader {
+    uint8_t version;
+    uint8_t headerLength;
+    uint8_t flags;
+    uint8_t jpegQuality;
+    uint8_t frameSize;
+    uint32_t sequence;
+    uint64_t captureUs;        // device clock
+    uint64_t sendUs;           // device clock
+    int64_t clockOffsetUs;     // server clock - device clock
+    uint32_t payloadLength;
+    uint16_t width;
+    uint16_t height;
+    uint16_t motionScore;
+    uint16_t headerId;         // compact frames: JPEG preamble epoch (0 = none)
+};
+
+/**
+ * Envelope encoder/decoder
+ */
+class FrameEnvelope {
+public:
+    static constexpr uint8_t kVersion = 1;
+    static constexpr size_t kHeaderSize = 48;
+
+    /**
+     * Write the envelope header
+     * @param header Fields to encode (version/headerLength are set by the encoder)
+     * @param out Destination, at least kHeaderSize bytes
+     * @param capacity Size of `out`
+     * @return Bytes written (0 if `out` is too small)
+     */
+    static size_t encode(const FrameHeader& header, uint8_t* out, size_t capacity);
+
+    /**
+     * Parse an envelope header
+     * - Accepts any version >= 1 whose headerLength covers the version 1 fields
+     * @param data Received message
+     * @param length Message length
+     * @param header Filled on success
+     * @return true if `data` starts with a valid envelope and holds the full payload
+     */
+    static bool decode(const uint8_t* data, size_t length, FrameHeader& header);
+
+    /**
+     * Parse the envelope header only (the payload may be incomplete, e.g. the first part
+     * of a kEnvelopeChunked frame)
+     * @return true if `data` starts with a valid envelope header
+     */
+    static bool decodeHeader(const uint8_t* data, size_t length, FrameHeader& header);
+
+    /**
+     * Check for the envelope magic (raw JPEG starts with FF D8 instead)
+     */
+    static bool isEnvelope(const uint8_t* data, size_t length);
+};
+
+#endif // FRAME_ENVELOPE_H
@@ -0,0 +1,109 @@
+/**
+ * `FramePacer.cpp`
+ * - Deadline-based frame pacing implementation
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#include "FramePacer.h"
+
+FramePacer::FramePacer(const FramePacerConfig& config)
+    : _config(config),
+      _running(false),
+      _deadlineUs(0),
+      _lastDeadlineUs(0),
+      _hasTicked(false),
+      _catchUpRun(0),
+      _lastLatenessUs(0),
+      _stats() {
+    resetStats();
+}
+
+void FramePacer::start(uint64_t nowUs) {
+    _running = true;
+    _deadlineUs = nowUs;
+    _lastDeadlineUs = nowUs;
+    _hasTicked = false;
+    _catchUpRun = 0;
+    resetStats();
+}
+
+bool FramePacer::poll(uint64_t nowUs) {
+    if (!_running || nowUs < _deadlineUs) {
+        return false;
+    }
+
+    // Tick: measure against the deadline, not against the previous tick
+    uint64_t lateness = nowUs - _deadlineUs;
+    _lastLatenessUs = lateness > UINT32_MAX ? UINT32_MAX : (uint32_t)lateness;
+    _stats.latenessSumUs += _lastLatenessUs;
+    if (_lastLatenessUs > _stats.maxLatenessUs) {
+        _stats.maxLatenessUs = _lastLatenessUs;
+    }
+    if (_stats.ticks > 0) {
+        uint64_t period = nowUs - _stats.lastTickUs;
+        uint32_t periodUs = period > UINT32_MAX ? UINT32_MAX : (uint32_t)period;
+        if (periodUs < _stats.minPeriodUs) _stats.minPeriodUs = periodUs;
+        if (periodUs > _stats.maxPeriodUs) _stats.maxPeriodUs = periodUs;
+    } else {
+        _stats.firstTickUs = nowUs;
+    }
+    _stats.ticks++;
+    _stats.lastTickUs = nowUs;
+    _lastDeadlineUs = _deadlineUs;
+    _hasTicked = true;
+
+    // Next deadline on the grid
+    if (_config.intervalUs == 0) {
+        _deadlineUs = nowUs;
+        return true;
+    }
+    _deadlineUs += _config.intervalUs;
+    if (_deadlineUs > nowUs) {
+        _catchUpRun = 0;
+        return true;
+    }
+
+    // The next deadline already passed (the last frame overran its slot)
+    if (_config.policy == PacingPolicy::CatchUp && _catchUpRun < _config.maxCatchUp) {
+        _catchUpRun++;
+        _stats.caughtUp++;
+        return true;
+    }
+    uint64_t missed = (nowUs - _deadlineUs) / _config.intervalUs + 1;
+    _stats.skipped += (uint32_t)missed;
+    _deadlineUs += missed * _config.intervalUs;
+    _catchUpRun = 0;
+    return true;
+}
+
+uint32_t FramePacer::waitUs(uint64_t nowUs) const {
+    if (!_running || nowUs >= _deadlineUs) {
+        return 0;
+    }
+    uint64_t wait = _deadlineUs - nowUs;
+    return wait > UINT32_MAX ? UINT32_MAX : (uint32_t)wait;
+}
+
+void FramePacer::setInterval(uint32_t intervalUs, uint64_t nowUs) {
+    if (intervalUs == _config.intervalUs) {
+        return;
+    }
+    _config.intervalUs = intervalUs;
+    if (!_running || !_hasTicked) {
+        return;
+    }
+    _deadlineUs = _lastDeadlineUs + intervalUs;
+    if (_deadlineUs < nowUs) {
+        _deadlineUs = nowUs;
+    }
+    _catchUpRun = 0;
+}
+
+void FramePacer::resetStats() {
+    _stats = FramePacerStats();
+    _stats.minPeriodUs = UINT32_MAX;
+}
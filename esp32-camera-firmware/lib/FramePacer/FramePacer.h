@@ -0,0 +1,121 @@
+/**
+ * `FramePacer.h`
+ * - Deadline-based frame pacing: ticks sit on a fixed grid (start + n * interval),
+ *   so capture/send time and wake-up latency never accumulate into drift
+ * - Late ticks follow a policy: skip the missed deadlines or catch up a few of them
+ * - Measures lateness (jitter) and the period between ticks
+ * - Platform independent: time is passed in (us), so tests run on a simulated clock
+ * - Not thread-safe: owned by the task that paces (loop() or the capture task)
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#ifndef FRAME_PACER_H
+#define FRAME_PACER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * What to do with deadlines that passed while the previous frame was still in progress
+ */
+enum class PacingPolicy : uint8_t {
+    Skip,       // drop them and realign to the next grid point (steady rate, no bursts)
+    CatchUp     // fire up to maxCatchUp of them back-to-back, then realign (keeps the frame count)
+};
+
+/**
+ * Pacer configuration
+ */
+struct FramePacerConfig {
+    uint32_t intervalUs = 100000;          // tick period (0 = every poll)
+    PacingPolicy policy = PacingPolicy::Skip;
+    uint8_t maxCatchUp = 1;                // CatchUp: missed ticks fired late per stall
+};
+
+/**
+ * Pacing statistics (since the last reset)
+ */
+struct FramePacerStats {
+    uint32_t ticks;
+    uint32_t skipped;          // deadlines dropped
+    uint32_t caughtUp;         // missed deadlines fired late (CatchUp)
+    uint32_t maxLatenessUs;    // worst tick lateness (now - deadline)
+    uint64_t latenessSumUs;
+    uint32_t minPeriodUs;      // shortest / longest time between consecutive ticks
+    uint32_t maxPeriodUs;
+    uint64_t firstTickUs;
+    uint64_t lastTickUs;
+
+    uint32_t meanLatenessUs() const { return ticks > 0 ? (uint32_t)(latenessSumUs / ticks) : 0; }
+
+    /**
+     * Achieved tick rate between the first and last tick
+     */
+    float achievedFps() const {
+        return ticks > 1 && lastTickUs > firstTickUs
+                   ? (float)(ticks - 1) * 1000000.0f / (float)(lastTickUs - firstTickUs)
+                   : 0.0f;
+    }
+};
+
+/**
+ * Deadline-based frame pacer
+ */
+class FramePacer {
+public:
+    explicit FramePacer(const FramePacerConfig& config);
+
+    /**
+     * Start (or re-anchor) pacing; the first tick is due immediately
+     * - Resets the statistics so a pause is not counted as one long period
+     */
+    void start(uint64_t nowUs);
+
+    void stop() { _running = false; }
+    bool isRunning() const { return _running; }
+
+    /**
+     * Consume the tick if its deadline has passed
+     * @return true if a frame should be produced now
+     */
+    bool poll(uint64_t nowUs);
+
+    /**
+     * Time until the next deadline
+     * @return 0 if a tick is due (or the pacer is stopped)
+     */
+    uint32_t waitUs(uint64_t nowUs) const;
+
+    /**
+     * Change the period, keeping the phase of the last tick
+     * - The next deadline becomes last deadline + new interval (now, if that already passed)
+     */
+    void setInterval(uint32_t intervalUs, uint64_t nowUs);
+
+    uint32_t getIntervalUs() const { return _config.intervalUs; }
+    uint64_t getDeadlineUs() const { return _deadlineUs; }
+
+    /**
+     * Lateness of the tick consumed by the last successful poll()
+     */
+    uint32_t getLastLatenessUs() const { return _lastLatenessUs; }
+
+    FramePacerStats getStats() const { return _stats; }
+    void resetStats();
+
+private:
+    FramePacerConfig _config;
+    bool _running;
+    uint64_t _deadlineUs;          // next tick
+    uint64_t _lastDeadlineUs;      // deadline of the last tick (grid anchor for setInterval)
+    bool _hasTicked;
+    uint8_t _catchUpRun;           // consecutive late deadlines kept for catch-up
+    uint32_t _lastLatenessUs;
+    FramePacerStats _stats;
+};
+
+#endif // FRAME_PACER_H
@@ -0,0 +1,84 @@
+/**
+ * `PaceTimer.cpp`
+ * - Microsecond pacing wait (esp_timer on the ESP32, std::thread on the host)
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#include "PaceTimer.h"
+
+#ifdef ESP_PLATFORM
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_rom_sys.h"
+#include "esp_timer.h"
+#else
+#include <chrono>
+#include <thread>
+#endif
+
+#ifdef ESP_PLATFORM
+PaceTimer::PaceTimer() : _timer(NULL), _waiter(NULL) {
+}
+
+PaceTimer::~PaceTimer() {
+    if (_timer != NULL) {
+        esp_timer_stop((esp_timer_handle_t)_timer);
+        esp_timer_delete((esp_timer_handle_t)_timer);
+    }
+}
+
+void PaceTimer::onTimer(void* arg) {
+    PaceTimer* self = static_cast<PaceTimer*>(arg);
+    TaskHandle_t waiter = (TaskHandle_t)self->_waiter;
+    if (waiter != NULL) {
+        xTaskNotifyGive(waiter);
+    }
+}
+
+void PaceTimer::wait(uint32_t waitUs) {
+    if (waitUs == 0) {
+        return;
+    }
+    if (waitUs < kSpinThresholdUs) {
+        esp_rom_delay_us(waitUs);
+        return;
+    }
+    if (_timer == NULL) {
+        esp_timer_create_args_t args = {};
+        args.callback = &PaceTimer::onTimer;
+        args.arg = this;
+        args.name = "pace";
+        esp_timer_handle_t timer;
+        if (esp_timer_create(&args, &timer) != ESP_OK) {
+            vTaskDelay(pdMS_TO_TICKS(waitUs / 1000) > 0 ? pdMS_TO_TICKS(waitUs / 1000) : 1);
+            return;
+        }
+        _timer = timer;
+    }
+
+    _waiter = xTaskGetCurrentTaskHandle();
+    ulTaskNotifyTake(pdTRUE, 0);  // drop a notification left over from a timed-out wait
+    esp_timer_start_once((esp_timer_handle_t)_timer, waitUs);
+    // Timeout only guards against a lost notification
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(waitUs / 1000 + 20));
+    esp_timer_stop((esp_timer_handle_t)_timer);
+    _waiter = NULL;
+}
+#else
+PaceTimer::PaceTimer() {
+}
+
+PaceTimer::~PaceTimer() {
+}
+
+void PaceTimer::wait(uint32_t waitUs) {
+    if (waitUs == 0) {
+        return;
+    }
+    std::this_thread::sleep_for(std::chrono::microseconds(waitUs));
+}
+#endif
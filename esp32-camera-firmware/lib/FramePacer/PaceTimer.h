@@ -0,0 +1,44 @@
+/**
+ * `PaceTimer.h`
+ * - Blocks the calling task until a pacing deadline with microsecond wake-up
+ * - ESP32: one-shot esp_timer + task notification (vTaskDelay() would round the
+ *   wait up to the next 1 ms tick); very short waits are spun instead
+ * - Host: std::this_thread::sleep_for
+ * - One waiter at a time per instance (the loop task or the capture task)
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#ifndef PACE_TIMER_H
+#define PACE_TIMER_H
+
+#include <stdint.h>
+
+class PaceTimer {
+public:
+    static constexpr uint32_t kSpinThresholdUs = 100;  // shorter waits are not worth a context switch
+
+    PaceTimer();
+    ~PaceTimer();
+
+    PaceTimer(const PaceTimer&) = delete;
+    PaceTimer& operator=(const PaceTimer&) = delete;
+
+    /**
+     * Block for waitUs (returns immediately for 0)
+     */
+    void wait(uint32_t waitUs);
+
+private:
+#ifdef ESP_PLATFORM
+    static void onTimer(void* arg);
+
+    void* _timer;              // esp_timer_handle_t (created on first wait)
+    void* volatile _waiter;    // TaskHandle_t of the blocked task
+#endif
+};
+
+#endif // PACE_TIMER_H
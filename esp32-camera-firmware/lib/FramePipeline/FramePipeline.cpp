@@ -0,0 +1,352 @@
+/**
+ * `FramePipeline.cpp`
+ * - Dual-core capture/upload pipeline implementation
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#include "FramePipeline.h"
+
+#include <chrono>
+
+#ifdef ESP_PLATFORM
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+#endif
+
+// ========================================
+// Platform Helpers
+// ========================================
+static uint64_t nowMicros() {
+#ifdef ESP_PLATFORM
+    return (uint64_t)esp_timer_get_time();
+#else
+    return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+// Longest single pacing wait: bounds how late stop() and setFrameInterval() take effect
+static const uint32_t kMaxPaceWaitUs = 50000;
+
+static FramePacerConfig pacerConfig(const PipelineConfig& config) {
+    FramePacerConfig pacer;
+    pacer.intervalUs = config.frameIntervalMs * 1000;
+    pacer.policy = config.pacingPolicy;
+    pacer.maxCatchUp = config.maxCatchUp;
+    return pacer;
+}
+
+static void sleepMillis(uint32_t ms) {
+#ifdef ESP_PLATFORM
+    TickType_t ticks = pdMS_TO_TICKS(ms);
+    vTaskDelay(ticks > 0 ? ticks : 1);
+#else
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+#endif
+}
+
+// ========================================
+// FrameQueue
+// ========================================
+FrameQueue::FrameQueue(size_t capacity, DropPolicy policy)
+    : _slots(), _capacity(capacity), _policy(policy), _head(0), _count(0), _maxCount(0),
+      _droppedOldest(0), _droppedNewest(0), _woken(false) {
+    if (_capacity < 1) _capacity = 1;
+    if (_capacity > kMaxCapacity) _capacity = kMaxCapacity;
+}
+
+bool FrameQueue::push(const FrameDescriptor& frame, FrameDescriptor& dropped) {
+    bool hasDropped = false;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_count == _capacity) {
+            if (_policy == DropPolicy::DropNewest) {
+                dropped = frame;
+                _droppedNewest++;
+                return true;
+            }
+            // Drop oldest: evict head, keep the newest frame
+            dropped = _slots[_head];
+            _head = (_head + 1) % _capacity;
+            _count--;
+            _droppedOldest++;
+            hasDropped = true;
+        }
+        _slots[(_head + _count) % _capacity] = frame;
+        _count++;
+        if (_count > _maxCount) _maxCount = _count;
+    }
+    _cond.notify_one();
+    return hasDropped;
+}
+
+bool FrameQueue::pop(FrameDescriptor& frame, uint32_t timeoutMs) {
+    std::unique_lock<std::mutex> lock(_mutex);
+    if (_count == 0 && timeoutMs > 0) {
+        _cond.wait_for(lock, std::chrono::milliseconds(timeoutMs),
+                       [this] { return _count > 0 || _woken; });
+    }
+    _woken = false;
+    if (_count == 0) {
+        return false;
+    }
+    frame = _slots[_head];
+    _head = (_head + 1) % _capacity;
+    _count--;
+    return true;
+}
+
+void FrameQueue::wake() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _woken = true;
+    }
+    _cond.notify_all();
+}
+
+size_t FrameQueue::depth() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _count;
+}
+
+size_t FrameQueue::maxDepth() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _maxCount;
+}
+
+uint32_t FrameQueue::droppedOldest() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _droppedOldest;
+}
+
+uint32_t FrameQueue::droppedNewest() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _droppedNewest;
+}
+
+// ========================================
+// FramePipeline
+// ========================================
+FramePipeline::FramePipeline(FrameSource& source, FrameSink& sink, const PipelineConfig& config)
+    : _source(source), _sink(sink), _config(config), _queue(config.queueDepth, config.dropPolicy),
+      _pacer(pacerConfig(config)),
+      _running(false), _frameIntervalMs(config.frameIntervalMs), _sequence(0), _captured(0), _captureFailures(0), _sent(0),
+      _sendFailures(0), _droppedOffline(0), _droppedStale(0), _held(0), _gated(0)
+#ifdef ESP_PLATFORM
+      , _activeTasks(0)
+#endif
+{
+}
+
+FramePipeline::~FramePipeline() {
+    stop();
+}
+
+bool FramePipeline::start() {
+    if (_running.exchange(true)) {
+        return true;
+    }
+
+#ifdef ESP_PLATFORM
+    _activeTasks = 2;
+    BaseType_t capOk = xTaskCreatePinnedToCore(captureTaskEntry, "capture", _config.captureStackSize,
+                                               this, _config.capturePriority, NULL, _config.captureCore);
+    BaseType_t netOk = xTaskCreatePinnedToCore(networkTaskEntry, "network", _config.networkStackSize,
+                                               this, _config.networkPriority, NULL, _config.networkCore);
+    if (capOk != pdPASS || netOk != pdPASS) {
+        {
+            std::lock_guard<std::mutex> lock(_exitMutex);
+            _activeTasks -= (capOk != pdPASS ? 1 : 0) + (netOk != pdPASS ? 1 : 0);
+        }
+        stop();
+        return false;
+    }
+#else
+    _captureThread = std::thread([this] { captureLoop(); });
+    _networkThread = std::thread([this] { networkLoop(); });
+#endif
+    return true;
+}
+
+void FramePipeline::stop() {
+    if (!_running.exchange(false)) {
+        return;
+    }
+    _queue.wake();
+
+#ifdef ESP_PLATFORM
+    std::unique_lock<std::mutex> lock(_exitMutex);
+    _exitCond.wait(lock, [this] { return _activeTasks == 0; });
+#else
+    if (_captureThread.joinable()) _captureThread.join();
+    if (_networkThread.joinable()) _networkThread.join();
+#endif
+
+    flush();
+}
+
+bool FramePipeline::captureOnce() {
+    FrameDescriptor frame = {};
+    if (!_source.acquire(frame)) {
+        _captureFailures++;
+        return false;
+    }
+    _captured++;
+    if (!_source.admit(frame)) {
+        _gated++;
+        _source.release(frame);
+        return true;
+    }
+    frame.sequence = ++_sequence;
+    if (frame.captureUs == 0) {
+        frame.captureUs = nowMicros();
+    }
+
+    FrameDescriptor dropped;
+    if (_queue.push(frame, dropped)) {
+        _source.release(dropped);
+    }
+    return true;
+}
+
+bool FramePipeline::sendOnce(uint32_t timeoutMs) {
+    _sink.poll();
+
+    // Flow control: a queued frame stays where newer captures replace it; the wait goes to
+    // background traffic, which holds no credit (a slow link is when it runs out)
+    if (!_sink.canSend()) {
+        _held++;
+        uint64_t startUs = nowMicros();
+        _sink.idle();
+        uint64_t spentMs = (nowMicros() - startUs) / 1000;
+        if (spentMs < timeoutMs) {
+            sleepMillis(timeoutMs - (uint32_t)spentMs);
+        }
+        return false;
+    }
+
+    FrameDescriptor frame;
+    if (!_queue.pop(frame, timeoutMs)) {
+        _sink.idle();
+        return false;
+    }
+
+    bool success = false;
+    if (!_source.isFresh(frame)) {
+        _droppedStale++;
+    } else if (_sink.isReady()) {
+        success = _sink.send(frame);
+        if (success) {
+            _sent++;
+        } else {
+            _sendFailures++;
+        }
+    } else {
+        _droppedOffline++;
+    }
+    _source.release(frame);
+    return success;
+}
+
+void FramePipeline::flush() {
+    FrameDescriptor frame;
+    while (_queue.pop(frame, 0)) {
+        _source.release(frame);
+    }
+}
+
+PipelineStats FramePipeline::getStats() const {
+    PipelineStats stats;
+    stats.captured = _captured.load();
+    stats.captureFailures = _captureFailures.load();
+    stats.sent = _sent.load();
+    stats.sendFailures = _sendFailures.load();
+    stats.droppedOldest = _queue.droppedOldest();
+    stats.droppedNewest = _queue.droppedNewest();
+    stats.droppedOffline = _droppedOffline.load();
+    stats.droppedStale = _droppedStale.load();
+    stats.held = _held.load();
+    stats.gated = _gated.load();
+    stats.queueDepth = (uint32_t)_queue.depth();
+    stats.maxQueueDepth = (uint32_t)_queue.maxDepth();
+    return stats;
+}
+
+FramePacerStats FramePipeline::getPacingStats() const {
+    std::lock_guard<std::mutex> lock(_pacerMutex);
+    return _pacer.getStats();
+}
+
+// ========================================
+// Task Loops
+// ========================================
+void FramePipeline::captureLoop() {
+    while (_running.load()) {
+        // Do not hold camera buffers while nobody can receive them
+        if (!_sink.isReady()) {
+            {
+                std::lock_guard<std::mutex> lock(_pacerMutex);
+                _pacer.stop();
+            }
+            sleepMillis(_config.pollIntervalMs);
+            continue;
+        }
+
+        // Captures sit on a fixed deadline grid, so capture time never adds to the period;
+        // the network task sends the previous frame meanwhile
+        uint64_t nowUs = nowMicros();
+        bool due;
+        uint32_t latenessUs;
+        uint32_t waitUs;
+        {
+            std::lock_guard<std::mutex> lock(_pacerMutex);
+            if (!_pacer.isRunning()) {
+                _pacer.start(nowUs);
+            }
+            _pacer.setInterval(_frameIntervalMs.load() * 1000, nowUs);
+            due = _pacer.poll(nowUs);
+            latenessUs = _pacer.getLastLatenessUs();
+            waitUs = _pacer.waitUs(nowUs);
+        }
+
+        if (due) {
+            _source.onTick(latenessUs);
+            captureOnce();
+        } else {
+            _paceTimer.wait(waitUs < kMaxPaceWaitUs ? waitUs : kMaxPaceWaitUs);
+        }
+    }
+}
+
+void FramePipeline::networkLoop() {
+    while (_running.load()) {
+        sendOnce(_config.pollIntervalMs);
+    }
+}
+
+#ifdef ESP_PLATFORM
+void FramePipeline::captureTaskEntry(void* arg) {
+    FramePipeline* self = static_cast<FramePipeline*>(arg);
+    self->captureLoop();
+    self->taskExited();
+    vTaskDelete(NULL);
+}
+
+void FramePipeline::networkTaskEntry(void* arg) {
+    FramePipeline* self = static_cast<FramePipeline*>(arg);
+    self->networkLoop();
+    self->taskExited();
+    vTaskDelete(NULL);
+}
+
+void FramePipeline::taskExited() {
+    std::lock_guard<std::mutex> lock(_exitMutex);
+    _activeTasks--;
+    _exitCond.notify_all();
+}
+#endif
@@ -0,0 +1,341 @@
+/**
+ * `FramePipeline.h`
+ * - Dual-core capture/upload pipeline for ESP32-CAM streaming
+ * - Capture task → bounded FrameQueue → network task (capture and send overlap)
+ * - Platform independent: camera/socket are reached through FrameSource/FrameSink,
+ *   so the same code runs on FreeRTOS (pinned tasks) and on a Linux host (std::thread)
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#ifndef FRAME_PIPELINE_H
+#define FRAME_PIPELINE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+
+#include <FramePacer.h>
+#include <PaceTimer.h>
+
+#ifndef ESP_PLATFORM
+#include <thread>
+#endif
+
+/**
+ * Descriptor of a captured frame travelling through the pipeline
+ * - The pipeline never copies frame data, it only moves descriptors
+ */
+struct FrameDescriptor {
+    void* handle;            // backend handle (camera_fb_t* on device)
+    const uint8_t* data;     // JPEG bytes
+    size_t length;           // JPEG length in bytes
+    uint64_t captureUs;      // capture timestamp (microseconds)
+    uint32_t sequence;       // capture sequence number (assigned by pipeline)
+    uint16_t motionScore;    // changed blocks in permille (set by the source, 0 = unknown)
+};
+
+/**
+ * What to do when the queue is full and a new frame arrives
+ */
+enum class DropPolicy : uint8_t {
+    DropOldest = 0,          // evict the queued frame, keep the newest (lowest latency)
+    DropNewest = 1           // reject the incoming frame, keep the queued one
+};
+
+/**
+ * Camera side of the pipeline
+ */
+class FrameSource {
+public:
+    virtual ~FrameSource() {}
+
+    /**
+     * Acquire a frame from the camera (may block until one is ready)
+     * @param frame Filled with data/length/captureUs/handle on success
+     * @return true if a frame was acquired
+     */
+    virtual bool acquire(FrameDescriptor& frame) = 0;
+
+    /**
+     * Return a frame previously obtained from acquire()
+     * @param frame Frame to release
+     */
+    virtual void release(const FrameDescriptor& frame) = 0;
+
+    /**
+     * Pacing tick notification, right before the frame for this tick is acquired
+     * - Called by the capture task (e.g. to record the pacing jitter)
+     * @param latenessUs How late the tick fired relative to its deadline
+     */
+    virtual void onTick(uint32_t latenessUs) {
+        (void)latenessUs;
+    }
+
+    /**
+     * Decide whether a captured frame enters the queue (e.g. motion gating)
+     * - Called by the capture task right after acquire(); may annotate the frame
+     * @return false to release the frame without queueing it
+     */
+    virtual bool admit(FrameDescriptor& frame) {
+        (void)frame;
+        return true;
+    }
+
+    /**
+     * Check if a queued frame is still worth sending (e.g. not too old)
+     * - Called by the network task right before send
+     * @return false to drop the frame instead of sending it
+     */
+    virtual bool isFresh(const FrameDescriptor& frame) {
+        (void)frame;
+        return true;
+    }
+};
+
+/**
+ * Network side of the pipeline
+ */
+class FrameSink {
+public:
+    virtual ~FrameSink() {}
+
+    /**
+     * @return true if frames can be sent (e.g. WebSocket connected)
+     */
+    virtual bool isReady() = 0;
+
+    /**
+     * Send one frame (may block)
+     * @return true if sent successfully
+     */
+    virtual bool send(const FrameDescriptor& frame) = 0;
+
+    /**
+     * Flow control: false keeps the queued frame back (with DropOldest each newer capture
+     * replaces it) until the receiver allows the next one
+     * - Always called from the network task only
+     */
+    virtual bool canSend() { return true; }
+
+    /**
+     * Service the connection between frames (e.g. webSocket.loop())
+     * - Always called from the network task only
+     */
+    virtual void poll() {}
+
+    /**
+     * No live frame arrived within the poll interval, or canSend() holds the queued one
+     * back: spare time for background traffic (e.g. outage backfill), so it never delays
+     * a live frame that could go out
+     * - Always called from the network task only
+     */
+    virtual void idle() {}
+};
+
+/**
+ * Pipeline configuration
+ */
+struct PipelineConfig {
+    size_t queueDepth = 1;                          // frames held between tasks (1..FrameQueue::kMaxCapacity)
+    DropPolicy dropPolicy = DropPolicy::DropOldest;
+    uint32_t frameIntervalMs = 100;                 // capture period (0 = as fast as the camera allows)
+    PacingPolicy pacingPolicy = PacingPolicy::Skip; // capture deadlines missed by a slow frame
+    uint8_t maxCatchUp = 1;                         // PacingPolicy::CatchUp only
+    uint32_t pollIntervalMs = 5;                    // max wait for a frame before servicing the sink
+    int captureCore = 1;                            // core for the capture task (ESP32 only)
+    int networkCore = 0;                            // core for the network task (ESP32 only)
+    uint32_t captureStackSize = 4096;               // task stack sizes (ESP32 only)
+    uint32_t networkStackSize = 8192;
+    uint8_t capturePriority = 2;                    // task priorities (ESP32 only)
+    uint8_t networkPriority = 2;
+};
+
+/**
+ * Pipeline counters snapshot
+ */
+struct PipelineStats {
+    uint32_t captured;         // frames acquired from the source
+    uint32_t captureFailures;  // acquire() failures
+    uint32_t sent;             // frames sent successfully
+    uint32_t sendFailures;     // send() failures
+    uint32_t droppedOldest;    // frames evicted from the queue (DropOldest)
+    uint32_t droppedNewest;    // frames rejected by the queue (DropNewest)
+    uint32_t droppedOffline;   // queued frames discarded because the sink was not ready
+    uint32_t droppedStale;     // queued frames discarded by FrameSource::isFresh()
+    uint32_t held;             // polls spent waiting for FrameSink::canSend()
+    uint32_t gated;            // captured frames rejected by FrameSource::admit()
+    uint32_t queueDepth;       // current queue depth
+    uint32_t maxQueueDepth;    // high-water mark of the queue depth
+};
+
+/**
+ * Bounded, thread-safe FIFO of frame descriptors with a drop policy
+ * - Fixed storage (no heap allocation)
+ */
+class FrameQueue {
+public:
+    static constexpr size_t kMaxCapacity = 8;
+
+    /**
+     * Constructor
+     * @param capacity Max frames held (clamped to 1..kMaxCapacity)
+     * @param policy Drop policy applied when full
+     */
+    FrameQueue(size_t capacity, DropPolicy policy);
+
+    /**
+     * Enqueue a frame, applying the drop policy when full
+     * @param frame Frame to enqueue
+     * @param dropped Filled with the frame that was dropped (oldest or incoming)
+     * @return true if a frame was dropped (caller must release `dropped`)
+     */
+    bool push(const FrameDescriptor& frame, FrameDescriptor& dropped);
+
+    /**
+     * Dequeue the oldest frame, waiting up to timeoutMs
+     * @return true if a frame was dequeued
+     */
+    bool pop(FrameDescriptor& frame, uint32_t timeoutMs);
+
+    /**
+     * Wake up any waiting consumer (used on shutdown)
+     */
+    void wake();
+
+    size_t capacity() const { return _capacity; }
+    size_t depth() const;
+    size_t maxDepth() const;
+    uint32_t droppedOldest() const;
+    uint32_t droppedNewest() const;
+
+private:
+    FrameDescriptor _slots[kMaxCapacity];
+    size_t _capacity;
+    DropPolicy _policy;
+    size_t _head;
+    size_t _count;
+    size_t _maxCount;
+    uint32_t _droppedOldest;
+    uint32_t _droppedNewest;
+    bool _woken;
+    mutable std::mutex _mutex;
+    std::condition_variable _cond;
+};
+
+/**
+ * Capture task + network task connected by a FrameQueue
+ */
+class FramePipeline {
+public:
+    /**
+     * Constructor
+     * @param source Camera backend
+     * @param sink Network backend
+     * @param config Pipeline configuration
+     */
+    FramePipeline(FrameSource& source, FrameSink& sink, const PipelineConfig& config);
+
+    /**
+     * Destructor (stops the tasks if still running)
+     */
+    ~FramePipeline();
+
+    /**
+     * Start capture and network tasks
+     * @return true if both tasks were started
+     */
+    bool start();
+
+    /**
+     * Stop both tasks and release every queued frame
+     */
+    void stop();
+
+    /**
+     * Check if the tasks are running
+     */
+    bool isRunning() const { return _running.load(); }
+
+    /**
+     * Run one capture step: acquire a frame and enqueue it
+     * - Called by the capture task; usable directly for single-threaded tests
+     * @return true if a frame was captured
+     */
+    bool captureOnce();
+
+    /**
+     * Run one network step: service the sink, then send one queued frame
+     * - Called by the network task; usable directly for single-threaded tests
+     * @param timeoutMs Max time to wait for a frame
+     * @return true if a frame was sent
+     */
+    bool sendOnce(uint32_t timeoutMs);
+
+    /**
+     * Release every frame still queued
+     */
+    void flush();
+
+    /**
+     * Change the capture period at runtime (e.g. from the bitrate controller)
+     */
+    void setFrameInterval(uint32_t intervalMs) { _frameIntervalMs.store(intervalMs); }
+
+    /**
+     * Get counters snapshot
+     */
+    PipelineStats getStats() const;
+
+    /**
+     * Get capture pacing statistics (since the sink last became ready)
+     */
+    FramePacerStats getPacingStats() const;
+
+    const PipelineConfig& getConfig() const { return _config; }
+
+private:
+    void captureLoop();
+    void networkLoop();
+
+    FrameSource& _source;
+    FrameSink& _sink;
+    PipelineConfig _config;
+    FrameQueue _queue;
+    FramePacer _pacer;                 // capture deadlines (capture task)
+    PaceTimer _paceTimer;
+    mutable std::mutex _pacerMutex;    // guards _pacer against getPacingStats()
+
+    std::atomic<bool> _running;
+    std::atomic<uint32_t> _frameIntervalMs;
+    std::atomic<uint32_t> _sequence;
+    std::atomic<uint32_t> _captured;
+    std::atomic<uint32_t> _captureFailures;
+    std::atomic<uint32_t> _sent;
+    std::atomic<uint32_t> _sendFailures;
+    std::atomic<uint32_t> _droppedOffline;
+    std::atomic<uint32_t> _droppedStale;
+    std::atomic<uint32_t> _held;
+    std::atomic<uint32_t> _gated;
+
+#ifdef ESP_PLATFORM
+    static void captureTaskEntry(void* arg);
+    static void networkTaskEntry(void* arg);
+    void taskExited();
+
+    std::mutex _exitMutex;
+    std::condition_variable _exitCond;
+    int _activeTasks;
+#else
+    std::thread _captureThread;
+    std::thread _networkThread;
+#endif
+};
+
+#endif // FRAME_PIPELINE_H
@@ -0,0 +1,168 @@
+/**
+ * `FrameRing.cpp`
+ * - Frame buffer ring tracker implementation
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#include "FrameRing.h"
+
+#include <string.h>
+
+// ========================================
+// Constructor
+// ========================================
+FrameRing::FrameRing(const FrameRingConfig& config)
+    : _config(config), _slots(), _slotCount(0), _stats(), _statsSinceUs(0), _mutex() {
+}
+
+void FrameRing::configure(const FrameRingConfig& config) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _config = config;
+    memset(_slots, 0, sizeof(_slots));
+    memset(&_stats, 0, sizeof(_stats));
+    _slotCount = 0;
+    _statsSinceUs = 0;
+}
+
+// ========================================
+// Buffer Tracking
+// ========================================
+int FrameRing::findSlot(const void* handle) const {
+    for (size_t i = 0; i < _slotCount; i++) {
+        if (_slots[i].stats.handle == handle) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+int FrameRing::onAcquire(const void* handle, uint64_t captureUs, uint64_t nowUs) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stats.acquired++;
+
+    // Driver buffers have stable addresses: assign a slot on first sight
+    int slot = findSlot(handle);
+    if (slot < 0) {
+        if (_slotCount >= kMaxBuffers) {
+            _stats.untracked++;
+            return -1;
+        }
+        slot = (int)_slotCount++;
+        _slots[slot].stats.handle = handle;
+    }
+
+    Slot& s = _slots[slot];
+    if (!s.stats.held) {
+        s.stats.held = true;
+        s.heldSinceUs = nowUs;
+        _stats.held++;
+        if (_stats.held > _stats.maxHeld) _stats.maxHeld = _stats.held;
+    }
+    s.stats.acquisitions++;
+    s.stats.lastCaptureUs = captureUs;
+    return slot;
+}
+
+void FrameRing::onRelease(const void* handle, uint64_t nowUs) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stats.released++;
+
+    int slot = findSlot(handle);
+    if (slot < 0) {
+        return;
+    }
+    Slot& s = _slots[slot];
+    if (s.stats.held) {
+        s.stats.held = false;
+        s.stats.heldUs += nowUs - s.heldSinceUs;
+        _stats.held--;
+    }
+}
+
+// ========================================
+// Freshness
+// ========================================
+bool FrameRing::isStale(uint64_t captureUs, uint64_t nowUs) const {
+    if (_config.maxFrameAgeMs == 0 || nowUs <= captureUs) {
+        return false;
+    }
+    return (nowUs - captureUs) > (uint64_t)_config.maxFrameAgeMs * 1000ULL;
+}
+
+bool FrameRing::checkFresh(const void* handle, uint64_t captureUs, uint64_t nowUs) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    int slot = findSlot(handle);
+    uint32_t ageMs = nowUs > captureUs ? (uint32_t)((nowUs - captureUs) / 1000ULL) : 0;
+    if (slot >= 0 && ageMs > _slots[slot].stats.maxAgeMs) {
+        _slots[slot].stats.maxAgeMs = ageMs;
+    }
+
+    if (!isStale(captureUs, nowUs)) {
+        return true;
+    }
+    _stats.staleDrops++;
+    if (slot >= 0) {
+        _slots[slot].stats.staleDrops++;
+    }
+    return false;
+}
+
+// ========================================
+// Statistics
+// ========================================
+uint32_t FrameRing::occupancyPermille(size_t slot, uint64_t nowUs) const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (slot >= _slotCount || nowUs <= _statsSinceUs) {
+        return 0;
+    }
+    const Slot& s = _slots[slot];
+    uint64_t heldUs = s.stats.heldUs;
+    if (s.stats.held) {
+        uint64_t since = s.heldSinceUs > _statsSinceUs ? s.heldSinceUs : _statsSinceUs;
+        heldUs += nowUs - since;
+    }
+    uint64_t permille = heldUs * 1000ULL / (nowUs - _statsSinceUs);
+    return permille > 1000 ? 1000 : (uint32_t)permille;
+}
+
+void FrameRing::resetStats(uint64_t nowUs) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (size_t i = 0; i < _slotCount; i++) {
+        Slot& s = _slots[i];
+        s.stats.acquisitions = 0;
+        s.stats.staleDrops = 0;
+        s.stats.heldUs = 0;
+        s.stats.maxAgeMs = 0;
+        if (s.stats.held) {
+            s.heldSinceUs = nowUs;
+        }
+    }
+    uint32_t held = _stats.held;
+    memset(&_stats, 0, sizeof(_stats));
+    _stats.held = held;
+    _stats.maxHeld = held;
+    _statsSinceUs = nowUs;
+}
+
+FrameSlotStats FrameRing::getSlotStats(size_t slot) const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (slot >= _slotCount) {
+        FrameSlotStats empty = {};
+        return empty;
+    }
+    return _slots[slot].stats;
+}
+
+FrameRingStats FrameRing::getStats() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _stats;
+}
+
+size_t FrameRing::getSlotCount() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _slotCount;
+}
@@ -0,0 +1,136 @@
+/**
+ * `FrameRing.h`
+ * - Bookkeeping for the camera driver's frame buffer ring
+ * - Tracks every buffer's capture timestamp and hold time, and flags frames
+ *   older than a configurable age so they are dropped before reaching the socket
+ * - Platform independent: buffers are identified by handle, time is passed in (us)
+ * - Thread-safe: capture and network tasks may acquire/release concurrently
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#ifndef FRAME_RING_H
+#define FRAME_RING_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <mutex>
+
+/**
+ * Frame ring configuration
+ */
+struct FrameRingConfig {
+    uint8_t bufferCount = 3;        // driver frame buffers (fb_count)
+    uint32_t maxFrameAgeMs = 200;   // frames older than this are never sent (0 = disabled)
+    bool usePsram = true;           // place buffers in PSRAM (CAMERA_FB_IN_PSRAM)
+};
+
+/**
+ * Per-buffer statistics
+ */
+struct FrameSlotStats {
+    const void* handle;        // driver buffer handle (NULL = slot unused)
+    bool held;                 // currently held by the application
+    uint32_t acquisitions;     // times this buffer was handed out
+    uint32_t staleDrops;       // times this buffer was dropped for age
+    uint64_t heldUs;           // total time held by the application
+    uint64_t lastCaptureUs;    // capture timestamp of the last frame in this buffer
+    uint32_t maxAgeMs;         // oldest frame age observed at freshness check
+};
+
+/**
+ * Ring-wide statistics
+ */
+struct FrameRingStats {
+    uint32_t acquired;         // frames handed out
+    uint32_t released;         // frames returned
+    uint32_t staleDrops;       // frames dropped for age
+    uint32_t untracked;        // handles beyond kMaxBuffers (not tracked per slot)
+    uint32_t held;             // buffers currently held
+    uint32_t maxHeld;          // high-water mark of held buffers
+};
+
+/**
+ * Frame buffer ring tracker
+ */
+class FrameRing {
+public:
+    static constexpr size_t kMaxBuffers = 8;
+
+    /**
+     * Constructor
+     * @param config Ring configuration
+     */
+    explicit FrameRing(const FrameRingConfig& config);
+
+    /**
+     * Replace the configuration and forget all tracked buffers
+     * - Call only while no buffer is held (e.g. before camera init)
+     */
+    void configure(const FrameRingConfig& config);
+
+    /**
+     * Record that a buffer was handed out by the driver
+     * @param handle Driver buffer handle (camera_fb_t*)
+     * @param captureUs Capture timestamp of the frame in the buffer
+     * @param nowUs Current time
+     * @return Slot index, or -1 if the buffer could not be tracked
+     */
+    int onAcquire(const void* handle, uint64_t captureUs, uint64_t nowUs);
+
+    /**
+     * Record that a buffer was returned to the driver
+     * @param handle Driver buffer handle
+     * @param nowUs Current time
+     */
+    void onRelease(const void* handle, uint64_t nowUs);
+
+    /**
+     * Check freshness of a held buffer and count a stale drop if too old
+     * - Call right before sending; a false result means "release, do not send"
+     * @return true if the frame may be sent
+     */
+    bool checkFresh(const void* handle, uint64_t captureUs, uint64_t nowUs);
+
+    /**
+     * Check if a frame captured at captureUs is older than maxFrameAgeMs
+     */
+    bool isStale(uint64_t captureUs, uint64_t nowUs) const;
+
+    /**
+     * Fraction of time the buffer was held since the last reset
+     * @return Occupancy in permille (0..1000)
+     */
+    uint32_t occupancyPermille(size_t slot, uint64_t nowUs) const;
+
+    /**
+     * Reset counters (slot assignment is kept)
+     */
+    void resetStats(uint64_t nowUs);
+
+    FrameSlotStats getSlotStats(size_t slot) const;
+    FrameRingStats getStats() const;
+    size_t getSlotCount() const;
+    const FrameRingConfig& getConfig() const { return _config; }
+
+private:
+    struct Slot {
+        FrameSlotStats stats;
+        uint64_t heldSinceUs;
+    };
+
+    int findSlot(const void* handle) const;
+
+    FrameRingConfig _config;
+    Slot _slots[kMaxBuffers];
+    size_t _slotCount;
+    FrameRingStats _stats;
+    uint64_t _statsSinceUs;
+    mutable std::mutex _mutex;
+};
+
+#endif // FRAME_RING_H
@@ -0,0 +1,130 @@
+/**
+ * `JpegHeaderElision.cpp`
+ * - JPEG header elision and reconstruction implementation
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#include "JpegHeaderElision.h"
+
+#include <string.h>
+
+// ========================================
+// Preamble
+// ========================================
+size_t JpegHeaderElider::findPreamble(const uint8_t* jpeg, size_t length, size_t limit) {
+    if (jpeg == NULL || length < 4 || jpeg[0] != 0xFF || jpeg[1] != 0xD8) {
+        return 0;
+    }
+    size_t end = length < limit ? length : limit;
+    size_t pos = 2;
+    while (pos + 4 <= end) {
+        if (jpeg[pos] != 0xFF) {
+            return 0;
+        }
+        uint8_t marker = jpeg[pos + 1];
+        if (marker == 0xFF) {
+            pos++;  // fill byte
+            continue;
+        }
+        // Markers without a length (SOI, EOI, RSTn, TEM) do not belong before the scan
+        if (marker == 0xD8 || marker == 0xD9 || (marker >= 0xD0 && marker <= 0xD7) || marker == 0x01 ||
+            marker == 0x00) {
+            return 0;
+        }
+        size_t segment = ((size_t)jpeg[pos + 2] << 8) | jpeg[pos + 3];
+        if (segment < 2) {
+            return 0;
+        }
+        pos += 2 + segment;
+        if (marker == 0xDA) {
+            return pos <= end ? pos : 0;
+        }
+    }
+    return 0;
+}
+
+// ========================================
+// Elider
+// ========================================
+JpegHeaderElider::JpegHeaderElider() : _preambleLength(0), _headerId(0), _stats() {
+}
+
+CompactFrame JpegHeaderElider::prepare(const uint8_t* jpeg, size_t length) {
+    CompactFrame frame = {CompactMode::Full, 0, 0};
+    _stats.frames++;
+    _stats.bytesIn += length;
+
+    size_t preamble = findPreamble(jpeg, length);
+    if (preamble == 0 || preamble >= length) {
+        _stats.full++;
+        return frame;
+    }
+    if (preamble == _preambleLength && memcmp(jpeg, _preamble, preamble) == 0) {
+        frame.mode = CompactMode::Elided;
+        frame.headerId = _headerId;
+        frame.skip = preamble;
+        _stats.elided++;
+        _stats.bytesSaved += preamble;
+        return frame;
+    }
+
+    // New epoch (ID 0 means "none", so it is skipped on wrap)
+    memcpy(_preamble, jpeg, preamble);
+    _preambleLength = preamble;
+    _headerId = (uint16_t)(_headerId + 1) != 0 ? (uint16_t)(_headerId + 1) : 1;
+    frame.mode = CompactMode::Define;
+    frame.headerId = _headerId;
+    _stats.defined++;
+    _stats.preambleLength = (uint16_t)preamble;
+    return frame;
+}
+
+void JpegHeaderElider::invalidate() {
+    _preambleLength = 0;
+}
+
+JpegElisionStats JpegHeaderElider::getStats() const {
+    return _stats;
+}
+
+void JpegHeaderElider::resetStats() {
+    uint16_t preambleLength = _stats.preambleLength;
+    _stats = JpegElisionStats();
+    _stats.preambleLength = preambleLength;
+}
+
+// ========================================
+// Rebuilder
+// ========================================
+JpegHeaderRebuilder::JpegHeaderRebuilder() : _preambleLength(0), _headerId(0) {
+}
+
+bool JpegHeaderRebuilder::learn(uint16_t headerId, const uint8_t* jpeg, size_t length) {
+    size_t preamble = JpegHeaderElider::findPreamble(jpeg, length);
+    if (headerId == 0 || preamble == 0) {
+        return false;
+    }
+    memcpy(_preamble, jpeg, preamble);
+    _preambleLength = preamble;
+    _headerId = headerId;
+    return true;
+}
+
+size_t JpegHeaderRebuilder::rebuild(uint16_t headerId, const uint8_t* scan, size_t scanLength, uint8_t* out,
+                                    size_t capacity) const {
+    if (!knows(headerId) || scan == NULL || out == NULL || _preambleLength + scanLength > capacity) {
+        return 0;
+    }
+    memcpy(out, _preamble, _preambleLength);
+    memcpy(out + _preambleLength, scan, scanLength);
+    return _preambleLength + scanLength;
+}
+
+void JpegHeaderRebuilder::reset() {
+    _preambleLength = 0;
+    _headerId = 0;
+}
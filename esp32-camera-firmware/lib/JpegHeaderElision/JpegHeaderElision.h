@@ -0,0 +1,130 @@
+/**
+ * `JpegHeaderElision.h`
+ * - Compact frame mode: the JPEG preamble (SOI, DQT, SOF, DHT, DRI, SOS header) is the same
+ *   for every frame of one frame size and quality, so it is sent once per epoch and later
+ *   frames carry only the scan data plus the epoch's header ID
+ * - JpegHeaderElider (device): compares each frame's preamble with the current epoch's copy
+ *   - same bytes: Elided (send the scan only)
+ *   - different bytes (size/quality/window change, new sensor settings): Define, a new ID and
+ *     the whole frame, so the receiver always has the header before it is elided
+ *   - no preamble found or longer than kMaxPreamble: Full (whole frame, no ID)
+ * - JpegHeaderRebuilder (relay, tests): learns the preamble from Define frames and rebuilds
+ *   byte-identical JPEGs from Elided ones; an unknown ID asks the device for a new epoch
+ *   (invalidate()), it never guesses
+ * - Platform independent, no allocation after construction, not thread-safe
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#ifndef JPEG_HEADER_ELISION_H
+#define JPEG_HEADER_ELISION_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+static constexpr size_t kMaxJpegPreamble = 1024;   // OV2640: ~620 bytes (2 DQT, SOF, 4 DHT, SOS)
+
+/**
+ * How a frame goes out
+ */
+enum class CompactMode : uint8_t {
+    Full,      // whole JPEG, no header ID (preamble not usable)
+    Define,    // whole JPEG, its preamble becomes headerId
+    Elided     // scan data only (skip the first `skip` bytes), preamble of headerId
+};
+
+struct CompactFrame {
+    CompactMode mode;
+    uint16_t headerId;         // 0 with Full
+    size_t skip;               // preamble bytes left out (Elided only)
+};
+
+/**
+ * Sender counters
+ */
+struct JpegElisionStats {
+    uint32_t frames;
+    uint32_t elided;
+    uint32_t defined;          // header epochs started (changes, resyncs, reconnects)
+    uint32_t full;             // frames without a usable preamble
+    uint64_t bytesIn;          // JPEG bytes before elision
+    uint64_t bytesSaved;       // preamble bytes not sent
+    uint16_t preambleLength;   // current epoch
+};
+
+/**
+ * Device side
+ */
+class JpegHeaderElider {
+public:
+    JpegHeaderElider();
+
+    /**
+     * Length of the preamble: everything up to and including the SOS header
+     * @return 0 if the JPEG does not start with SOI, a marker is malformed or the SOS
+     *         header ends beyond `limit` bytes
+     */
+    static size_t findPreamble(const uint8_t* jpeg, size_t length, size_t limit = kMaxJpegPreamble);
+
+    /**
+     * Decide how to send a frame (call once per frame, in send order)
+     */
+    CompactFrame prepare(const uint8_t* jpeg, size_t length);
+
+    /**
+     * Next frame defines the header again (receiver lost it, the defining send failed,
+     * or the connection changed)
+     */
+    void invalidate();
+
+    JpegElisionStats getStats() const;
+    void resetStats();
+
+private:
+    uint8_t _preamble[kMaxJpegPreamble];
+    size_t _preambleLength;    // 0 = no epoch
+    uint16_t _headerId;
+    JpegElisionStats _stats;
+};
+
+/**
+ * Receiver side
+ */
+class JpegHeaderRebuilder {
+public:
+    JpegHeaderRebuilder();
+
+    /**
+     * Take the preamble of a Define frame as headerId
+     * @return false if the frame has no usable preamble (nothing learned)
+     */
+    bool learn(uint16_t headerId, const uint8_t* jpeg, size_t length);
+
+    /**
+     * Rebuild the JPEG of an Elided frame (preamble + scan)
+     * @return Length written, 0 if headerId is not the learned one or `out` is too small
+     */
+    size_t rebuild(uint16_t headerId, const uint8_t* scan, size_t scanLength, uint8_t* out, size_t capacity) const;
+
+    /**
+     * Check if the preamble for headerId is known
+     */
+    bool knows(uint16_t headerId) const { return headerId != 0 && headerId == _headerId; }
+
+    size_t getPreambleLength() const { return _preambleLength; }
+
+    /**
+     * Forget the header (the sender starts a new epoch after reconnecting)
+     */
+    void reset();
+
+private:
+    uint8_t _preamble[kMaxJpegPreamble];
+    size_t _preambleLength;
+    uint16_t _headerId;
+};
+
+#endif // JPEG_HEADER_ELISION_H
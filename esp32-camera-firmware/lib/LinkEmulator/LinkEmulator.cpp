@@ -0,0 +1,96 @@
+/**
+ * `LinkEmulator.cpp`
+ * - Network impairment model implementation
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#include "LinkEmulator.h"
+
+// ========================================
+// Constructor
+// ========================================
+LinkEmulator::LinkEmulator(const LinkConfig& config)
+    : _config(config), _random(config.seed ? config.seed : 1), _linkFreeUs(0), _lastUpUs(0), _lastDownUs(0),
+      _stats() {
+    if (_config.segmentBytes == 0) {
+        _config.segmentBytes = 1436;
+    }
+}
+
+// ========================================
+// Model
+// ========================================
+uint32_t LinkEmulator::nextRandom() {
+    _random = _random * 1664525u + 1013904223u;
+    return _random >> 8;
+}
+
+uint64_t LinkEmulator::jitterUs() {
+    if (_config.jitterMs == 0) {
+        return 0;
+    }
+    return (uint64_t)nextRandom() % ((uint64_t)_config.jitterMs * 1000 + 1);
+}
+
+uint64_t LinkEmulator::transmitUs(size_t bytes) const {
+    if (_config.bandwidthKbps == 0) {
+        return 0;
+    }
+    return (uint64_t)bytes * 8000ULL / _config.bandwidthKbps;
+}
+
+LinkSend LinkEmulator::send(size_t bytes, uint64_t nowUs) {
+    LinkSend result;
+    result.retransmits = 0;
+
+    // Serialize behind whatever is still queued on the link
+    uint64_t start = nowUs > _linkFreeUs ? nowUs : _linkFreeUs;
+    _linkFreeUs = start + transmitUs(bytes);
+
+    // send() returns once the unsent tail fits the socket buffer
+    uint64_t buffered = transmitUs(_config.sendBufferBytes);
+    result.unblockUs = _linkFreeUs > nowUs + buffered ? _linkFreeUs - buffered : nowUs;
+
+    // Lost segments cost one RTO each (plus resending the segment)
+    uint32_t segments = (uint32_t)((bytes + _config.segmentBytes - 1) / _config.segmentBytes);
+    uint64_t penaltyUs = 0;
+    if (_config.lossPercent > 0.0f) {
+        uint32_t threshold = (uint32_t)(_config.lossPercent / 100.0f * (float)(1u << 24));
+        for (uint32_t i = 0; i < segments; i++) {
+            if (nextRandom() < threshold) {
+                result.retransmits++;
+                penaltyUs += (uint64_t)_config.rtoMs * 1000 + transmitUs(_config.segmentBytes);
+            }
+        }
+    }
+    // Retransmissions occupy the link (and stall the stream) as well
+    _linkFreeUs += penaltyUs;
+
+    uint64_t deliver = _linkFreeUs + (uint64_t)_config.delayMs * 1000 + jitterUs();
+    if (deliver < _lastUpUs) {
+        deliver = _lastUpUs;  // TCP delivers in order
+    }
+    _lastUpUs = deliver;
+    result.deliverUs = deliver;
+
+    _stats.messages++;
+    _stats.bytes += bytes;
+    _stats.segments += segments;
+    _stats.retransmits += result.retransmits;
+    _stats.blockedUs += result.unblockUs - nowUs;
+    return result;
+}
+
+uint64_t LinkEmulator::receive(uint64_t nowUs) {
+    uint64_t deliver = nowUs + (uint64_t)_config.delayMs * 1000 + jitterUs();
+    if (deliver < _lastDownUs) {
+        deliver = _lastDownUs;
+    }
+    _lastDownUs = deliver;
+    _stats.received++;
+    return deliver;
+}
@@ -0,0 +1,94 @@
+/**
+ * `LinkEmulator.h`
+ * - Network impairment model for the host replay harness (bandwidth, delay, jitter, loss)
+ * - Models a TCP stream the way the firmware sees it through lwIP:
+ *   - a send blocks until the unsent remainder fits the socket send buffer
+ *   - bytes leave at the link rate, arrive after delay + jitter, in order
+ *   - a lost segment is retransmitted after an RTO (TCP never loses data; loss shows up
+ *     as head-of-line delay for that message and everything queued behind it)
+ * - Platform independent, not thread-safe: time is passed in (microseconds)
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#ifndef LINK_EMULATOR_H
+#define LINK_EMULATOR_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Link configuration (one direction uses the same delay/jitter/loss as the other)
+ */
+struct LinkConfig {
+    uint32_t bandwidthKbps = 0;        // uplink rate (0 = unlimited)
+    uint32_t delayMs = 0;              // one-way base delay
+    uint32_t jitterMs = 0;             // extra one-way delay, uniform in [0, jitterMs]
+    float lossPercent = 0.0f;          // per-segment loss probability (%)
+    uint32_t rtoMs = 200;              // retransmission timeout (lwIP minimum RTO is ~200 ms)
+    size_t segmentBytes = 1436;        // TCP MSS on the ESP32
+    size_t sendBufferBytes = 5744;     // lwIP TCP_SND_BUF in the Arduino core
+    uint32_t seed = 1;                 // jitter/loss random sequence
+};
+
+/**
+ * Outcome of one uplink message
+ */
+struct LinkSend {
+    uint64_t unblockUs;        // when the sender's send() call returns
+    uint64_t deliverUs;        // when the last byte reaches the receiver
+    uint32_t retransmits;      // segments that were lost and resent
+};
+
+/**
+ * Link counters
+ */
+struct LinkStats {
+    uint32_t messages;
+    uint64_t bytes;
+    uint32_t segments;
+    uint32_t retransmits;
+    uint32_t received;         // downlink messages
+    uint64_t blockedUs;        // total time senders were blocked
+};
+
+/**
+ * Impairment model
+ */
+class LinkEmulator {
+public:
+    explicit LinkEmulator(const LinkConfig& config);
+
+    /**
+     * Schedule an uplink message
+     * @param bytes Message size on the wire
+     * @param nowUs Time the sender calls send()
+     */
+    LinkSend send(size_t bytes, uint64_t nowUs);
+
+    /**
+     * Schedule a downlink message (small control messages: delay + jitter only)
+     * @return Delivery time
+     */
+    uint64_t receive(uint64_t nowUs);
+
+    LinkStats getStats() const { return _stats; }
+    const LinkConfig& getConfig() const { return _config; }
+
+private:
+    uint32_t nextRandom();
+    uint64_t jitterUs();
+    uint64_t transmitUs(size_t bytes) const;
+
+    LinkConfig _config;
+    uint32_t _random;
+    uint64_t _linkFreeUs;      // uplink serializer busy until
+    uint64_t _lastUpUs;        // last uplink delivery (in-order)
+    uint64_t _lastDownUs;      // last downlink delivery (in-order)
+    LinkStats _stats;
+};
+
+#endif // LINK_EMULATOR_H
@@ -0,0 +1,421 @@
+/**
+ * `LumaStream.cpp`
+ * - Luminance side-stream implementation
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#include "LumaStream.h"
+
+#include <string.h>
+
+static const uint8_t kMagic[3] = {'L', 'U', 'M'};
+
+// ========================================
+// Byte Order Helpers
+// ========================================
+static inline void put16(uint8_t* p, uint16_t v) {
+    p[0] = (uint8_t)(v >> 8);
+    p[1] = (uint8_t)v;
+}
+
+static inline void put32(uint8_t* p, uint32_t v) {
+    put16(p, (uint16_t)(v >> 16));
+    put16(p + 2, (uint16_t)v);
+}
+
+static inline void put64(uint8_t* p, uint64_t v) {
+    put32(p, (uint32_t)(v >> 32));
+    put32(p + 4, (uint32_t)v);
+}
+
+static inline uint16_t get16(const uint8_t* p) {
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+static inline uint32_t get32(const uint8_t* p) {
+    return ((uint32_t)get16(p) << 16) | get16(p + 2);
+}
+
+static inline uint64_t get64(const uint8_t* p) {
+    return ((uint64_t)get32(p) << 32) | get32(p + 4);
+}
+
+// ========================================
+// Header
+// ========================================
+size_t LumaCodec::encodeHeader(const LumaHeader& header, uint8_t* out, size_t capacity) {
+    if (out == NULL || capacity < kHeaderSize) {
+        return 0;
+    }
+    out[0] = kMagic[0];
+    out[1] = kMagic[1];
+    out[2] = kMagic[2];
+    out[3] = kVersion;
+    out[4] = (uint8_t)kHeaderSize;
+    out[5] = header.flags;
+    out[6] = header.deadband;
+    out[7] = header.frameSize;
+    put32(out + 8, header.sequence);
+    put64(out + 12, header.captureUs);
+    put64(out + 20, (uint64_t)header.clockOffsetUs);
+    put16(out + 28, header.width);
+    put16(out + 30, header.height);
+    put32(out + 32, header.payloadLength);
+    return kHeaderSize;
+}
+
+bool LumaCodec::isLuma(const uint8_t* data, size_t length) {
+    return data != NULL && length >= 4 && data[0] == kMagic[0] && data[1] == kMagic[1] && data[2] == kMagic[2];
+}
+
+bool LumaCodec::decodeHeader(const uint8_t* data, size_t length, LumaHeader& header) {
+    if (!isLuma(data, length) || length < kHeaderSize) {
+        return false;
+    }
+    header.version = data[3];
+    header.headerLength = data[4];
+    if (header.version < 1 || header.headerLength < kHeaderSize || header.headerLength > length) {
+        return false;
+    }
+    header.flags = data[5];
+    header.deadband = data[6];
+    header.frameSize = data[7];
+    header.sequence = get32(data + 8);
+    header.captureUs = get64(data + 12);
+    header.clockOffsetUs = (int64_t)get64(data + 20);
+    header.width = get16(data + 28);
+    header.height = get16(data + 30);
+    header.payloadLength = get32(data + 32);
+    return (size_t)header.headerLength + header.payloadLength <= length;
+}
+
+// ========================================
+// Resampler
+// ========================================
+/**
+ * Source pixel i covers [i × dst, (i + 1) × dst), destination pixel x covers [x × src, (x + 1) × src)
+ * (both grids span src × dst units): walking the merged boundaries yields each overlap once,
+ * and the overlaps of one destination pixel add up to `src`
+ */
+static void resampleRow(const uint8_t* line, uint32_t srcWidth, uint32_t* out, uint32_t dstWidth) {
+    uint32_t i = 0, pixelEnd = dstWidth;
+    uint32_t position = 0, outEnd = srcWidth;
+    uint32_t sum = 0;
+    for (uint32_t x = 0; x < dstWidth;) {
+        uint32_t next = pixelEnd < outEnd ? pixelEnd : outEnd;
+        sum += (next - position) * line[i];
+        position = next;
+        if (next == pixelEnd) {
+            i++;
+            pixelEnd += dstWidth;
+        }
+        if (next == outEnd) {
+            out[x++] = sum;
+            sum = 0;
+            outEnd += srcWidth;
+        }
+    }
+}
+
+void LumaCodec::resample(const uint8_t* src, uint16_t srcWidth, uint16_t srcHeight, uint8_t* dst,
+                         uint16_t dstWidth, uint16_t dstHeight, uint32_t* scratch) {
+    if (src == NULL || dst == NULL || scratch == NULL || srcWidth == 0 || srcHeight == 0) {
+        return;
+    }
+    if (srcWidth == dstWidth && srcHeight == dstHeight) {
+        memcpy(dst, src, (size_t)dstWidth * dstHeight);  // VGA thumbnail = 80 × 60
+        return;
+    }
+    // Normalization by a 2^-48 fixed-point reciprocal: exact while 256 × total² < 2^48
+    const uint32_t total = (uint32_t)srcWidth * srcHeight;
+    const bool reciprocal = total < (1u << 20);
+    const uint64_t inverse = ((uint64_t)1 << 48) / total + 1;
+    uint32_t* sums = scratch;
+    uint32_t* row = scratch + dstWidth;
+    memset(sums, 0, sizeof(uint32_t) * dstWidth);
+
+    // Same walk over the rows; each source row is resampled horizontally once
+    uint32_t j = 0, rowEnd = dstHeight;
+    uint32_t position = 0, outEnd = srcHeight;
+    bool rowReady = false;
+    for (uint32_t y = 0; y < dstHeight;) {
+        if (!rowReady) {
+            resampleRow(src + (size_t)j * srcWidth, srcWidth, row, dstWidth);
+            rowReady = true;
+        }
+        uint32_t next = rowEnd < outEnd ? rowEnd : outEnd;
+        uint32_t weight = next - position;
+        for (uint32_t x = 0; x < dstWidth; x++) {
+            sums[x] += weight * row[x];
+        }
+        position = next;
+        if (next == rowEnd) {
+            j++;
+            rowEnd += dstHeight;
+            rowReady = false;
+        }
+        if (next == outEnd) {
+            uint8_t* out = dst + (size_t)y * dstWidth;
+            for (uint32_t x = 0; x < dstWidth; x++) {
+                uint32_t rounded = sums[x] + total / 2;
+                out[x] = (uint8_t)(reciprocal ? (rounded * inverse) >> 48 : rounded / total);
+                sums[x] = 0;
+            }
+            y++;
+            outEnd += srcHeight;
+        }
+    }
+}
+
+// ========================================
+// Delta Codec
+// ========================================
+static inline uint8_t delta(const uint8_t* plane, const uint8_t* reference, size_t i, uint8_t deadband) {
+    uint8_t d = (uint8_t)(plane[i] - reference[i]);
+    int magnitude = d < 128 ? d : 256 - d;
+    return magnitude <= deadband ? 0 : d;
+}
+
+void LumaCodec::fitSize(uint16_t srcWidth, uint16_t srcHeight, uint16_t maxWidth, uint16_t maxHeight,
+                        uint16_t& width, uint16_t& height) {
+    if (srcWidth <= maxWidth && srcHeight <= maxHeight) {
+        width = srcWidth;
+        height = srcHeight;
+        return;
+    }
+    // The tighter bound wins, the other side follows the source ratio
+    if ((uint32_t)srcWidth * maxHeight >= (uint32_t)srcHeight * maxWidth) {
+        width = maxWidth;
+        height = (uint16_t)(((uint32_t)srcHeight * maxWidth + srcWidth / 2) / srcWidth);
+    } else {
+        height = maxHeight;
+        width = (uint16_t)(((uint32_t)srcWidth * maxHeight + srcHeight / 2) / srcHeight);
+    }
+    width = width > 0 ? width : 1;
+    height = height > 0 ? height : 1;
+}
+
+size_t LumaCodec::encodeDelta(const uint8_t* plane, uint8_t* reference, size_t pixels, uint8_t deadband,
+                              uint8_t* out, size_t capacity) {
+    if (plane == NULL || reference == NULL || out == NULL) {
+        return 0;
+    }
+    size_t length = 0;
+    size_t i = 0;
+    while (i < pixels) {
+        if (delta(plane, reference, i, deadband) == 0) {
+            size_t run = 1;
+            while (i + run < pixels && run < kMaxRun && delta(plane, reference, i + run, deadband) == 0) {
+                run++;
+            }
+            if (length + 1 > capacity) {
+                return 0;
+            }
+            out[length++] = (uint8_t)(run - 1);
+            i += run;
+            continue;
+        }
+
+        // Literals up to the next run of two zeros (a single zero costs less as a literal)
+        size_t count = 1;
+        while (i + count < pixels && count < kMaxRun) {
+            if (delta(plane, reference, i + count, deadband) == 0 &&
+                (i + count + 1 >= pixels || delta(plane, reference, i + count + 1, deadband) == 0)) {
+                break;
+            }
+            count++;
+        }
+        if (length + 1 + count > capacity) {
+            return 0;
+        }
+        out[length++] = (uint8_t)(0x7F + count);
+        for (size_t k = 0; k < count; k++, i++) {
+            uint8_t d = delta(plane, reference, i, deadband);
+            out[length++] = d;
+            reference[i] = (uint8_t)(reference[i] + d);
+        }
+    }
+    return length;
+}
+
+bool LumaCodec::decodeDelta(const uint8_t* payload, size_t length, uint8_t* plane, size_t pixels) {
+    if (payload == NULL || plane == NULL) {
+        return false;
+    }
+    size_t offset = 0;
+    size_t i = 0;
+    while (offset < length) {
+        uint8_t token = payload[offset++];
+        if (token < 0x80) {
+            i += (size_t)token + 1;
+            if (i > pixels) {
+                return false;
+            }
+            continue;
+        }
+        size_t count = (size_t)token - 0x7F;
+        if (i + count > pixels || offset + count > length) {
+            return false;
+        }
+        for (size_t k = 0; k < count; k++) {
+            plane[i + k] = (uint8_t)(plane[i + k] + payload[offset + k]);
+        }
+        i += count;
+        offset += count;
+    }
+    return i == pixels;
+}
+
+// ========================================
+// Side-Stream
+// ========================================
+LumaStream::LumaStream(const LumaStreamConfig& config)
+    : _config(config),
+      _intervalMs(config.intervalMs),
+      _lastPublishMs(0),
+      _published(false),
+      _pending(false),
+      _forceKey(true),
+      _sourceWidth(0),
+      _sourceHeight(0),
+      _planeWidth(0),
+      _planeHeight(0),
+      _frameSize(0),
+      _captureUs(0),
+      _sequence(0),
+      _sinceKey(0),
+      _stats() {
+    if (_config.headroom > kMaxHeadroom) {
+        _config.headroom = kMaxHeadroom;
+    }
+    size_t pixels = (size_t)_config.width * _config.height;
+    _latest = new uint8_t[pixels];
+    _reference = new uint8_t[pixels];
+    _buffer = new uint8_t[_config.headroom + LumaCodec::kHeaderSize + LumaCodec::maxPayload(pixels)];
+    _scratch = new uint32_t[2 * _config.width];
+    memset(_reference, 0, pixels);
+}
+
+LumaStream::~LumaStream() {
+    delete[] _latest;
+    delete[] _reference;
+    delete[] _buffer;
+    delete[] _scratch;
+}
+
+bool LumaStream::publish(const uint8_t* luma, uint16_t srcWidth, uint16_t srcHeight, uint8_t frameSize,
+                         uint64_t captureUs, uint32_t nowMs) {
+    if (luma == NULL || srcWidth == 0 || srcHeight == 0) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_intervalMs == 0 || (_published && nowMs - _lastPublishMs < _intervalMs)) {
+        return false;
+    }
+    if (srcWidth != _sourceWidth || srcHeight != _sourceHeight) {
+        // New resolution (ABR, profile): the view changes scale (and maybe plane size), restart the decoder
+        _sourceWidth = srcWidth;
+        _sourceHeight = srcHeight;
+        LumaCodec::fitSize(srcWidth, srcHeight, _config.width, _config.height, _planeWidth, _planeHeight);
+        _forceKey = true;
+    }
+    LumaCodec::resample(luma, srcWidth, srcHeight, _latest, _planeWidth, _planeHeight, _scratch);
+    if (_pending) {
+        _stats.skipped++;
+    }
+    _frameSize = frameSize;
+    _captureUs = captureUs;
+    _lastPublishMs = nowMs;
+    _published = true;
+    _pending = true;
+    _stats.published++;
+    return true;
+}
+
+bool LumaStream::hasPending() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _pending;
+}
+
+bool LumaStream::encode(bool clockSynced, int64_t clockOffsetUs, uint8_t*& message, size_t& length) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (!_pending) {
+        return false;
+    }
+    const size_t pixels = (size_t)_planeWidth * _planeHeight;
+    bool key = _forceKey || (_config.keyInterval > 0 && _sinceKey >= _config.keyInterval);
+    if (key) {
+        memset(_reference, 0, pixels);
+    }
+    message = _buffer + _config.headroom;
+    uint8_t* payload = message + LumaCodec::kHeaderSize;
+    size_t payloadLength = LumaCodec::encodeDelta(_latest, _reference, pixels, _config.deadband, payload,
+                                                  LumaCodec::maxPayload(pixels));
+
+    LumaHeader header = {};
+    header.flags = (key ? kLumaKey : 0) | (clockSynced ? kLumaClockSynced : 0);
+    header.deadband = _config.deadband;
+    header.frameSize = _frameSize;
+    header.sequence = _sequence++;
+    header.captureUs = _captureUs;
+    header.clockOffsetUs = clockOffsetUs;
+    header.width = _planeWidth;
+    header.height = _planeHeight;
+    header.payloadLength = (uint32_t)payloadLength;
+    LumaCodec::encodeHeader(header, message, LumaCodec::kHeaderSize);
+
+    length = LumaCodec::kHeaderSize + payloadLength;
+    _pending = false;
+    _forceKey = false;
+    _sinceKey = key ? 1 : (uint16_t)(_sinceKey + 1);
+    if (key) {
+        _stats.keyPlanes++;
+    }
+    _stats.lastPayload = (uint32_t)payloadLength;
+    return true;
+}
+
+void LumaStream::commit(bool sent, size_t length) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (sent) {
+        _stats.sent++;
+        _stats.bytes += length;
+    } else {
+        // The reference already holds this plane: the decoder must restart
+        _stats.failed++;
+        _forceKey = true;
+    }
+}
+
+void LumaStream::reset() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _forceKey = true;
+}
+
+void LumaStream::setInterval(uint32_t intervalMs) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _intervalMs = intervalMs;
+    if (intervalMs == 0) {
+        _pending = false;
+    }
+}
+
+uint32_t LumaStream::getInterval() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _intervalMs;
+}
+
+void LumaStream::getPlaneSize(uint16_t& width, uint16_t& height) const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    width = _planeWidth;
+    height = _planeHeight;
+}
+
+LumaStreamStats LumaStream::getStats() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _stats;
+}
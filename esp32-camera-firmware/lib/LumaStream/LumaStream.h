@@ -0,0 +1,239 @@
+/**
+ * `LumaStream.h`
+ * - Analytics side-stream: a small 8-bit luminance plane (at most e.g. 80 × 60) per capture,
+ *   delta-coded against the previous plane and sent as its own "LUM" message, so the motion
+ *   analyzer works on gray pixels without decoding a JPEG
+ * - Source: the DC thumbnail the motion gate already decoded (1/8 scale, one value per 8 × 8
+ *   block), area-downscaled to fit the configured size with the source aspect ratio kept
+ *   (exact integer overlap weights); never upscaled, so a thumbnail smaller than the
+ *   configured size (HVGA 60 × 40, QVGA 40 × 30) is sent as it is
+ * - Delta codec, per pixel d = (plane - reference) mod 256:
+ *   - |d| <= deadband is sent as 0 (sensor noise costs nothing); the encoder keeps the
+ *     plane the decoder reconstructs as its reference, so the error stays <= deadband
+ *     and does not drift
+ *   - token byte c < 0x80: c + 1 zero deltas; c >= 0x80: c - 0x7F literal deltas follow
+ * - Key planes are coded against a zero plane (kLumaKey): first plane, after a reconnect or
+ *   a failed send, when the source (and so the plane) size changes and every keyInterval planes
+ * - Capture context: publish(); network context: encode() → commit()
+ * - Platform independent
+ *
+ * Wire format (version 1, 36 bytes, big-endian):
+ *   0  magic "LUM" (3)        3  version (1)          4  headerLength (1)
+ *   5  flags (1)              6  deadband (1)         7  frameSize (1, framesize_t of the source)
+ *   8  sequence (4)           12 captureUs (8, device clock)
+ *   20 clockOffsetUs (8, signed: server = device + offset)
+ *   28 width (2)              30 height (2)           32 payloadLength (4)
+ * Receivers must skip `headerLength` bytes so later versions can append fields.
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#ifndef LUMA_STREAM_H
+#define LUMA_STREAM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <mutex>
+
+/**
+ * Plane flags
+ */
+enum LumaFlags : uint8_t {
+    kLumaKey = 0x01,           // coded against a zero plane (decoder restarts here)
+    kLumaClockSynced = 0x02    // clockOffsetUs is valid
+};
+
+/**
+ * Decoded plane header
+ */
+struct LumaHeader {
+    uint8_t version;
+    uint8_t headerLength;
+    uint8_t flags;
+    uint8_t deadband;
+    uint8_t frameSize;
+    uint32_t sequence;
+    uint64_t captureUs;        // device clock
+    int64_t clockOffsetUs;     // server clock - device clock
+    uint16_t width;
+    uint16_t height;
+    uint32_t payloadLength;
+};
+
+/**
+ * Header, resampler and delta codec
+ */
+class LumaCodec {
+public:
+    static constexpr uint8_t kVersion = 1;
+    static constexpr size_t kHeaderSize = 36;
+    static constexpr size_t kMaxRun = 128;
+
+    /**
+     * Largest delta payload for a plane (all literals)
+     */
+    static constexpr size_t maxPayload(size_t pixels) {
+        return pixels + (pixels + kMaxRun - 1) / kMaxRun;
+    }
+
+    /**
+     * Write the plane header
+     * @return Bytes written (0 if `out` is too small)
+     */
+    static size_t encodeHeader(const LumaHeader& header, uint8_t* out, size_t capacity);
+
+    /**
+     * Parse a plane message
+     * @return true if `data` starts with a valid header and holds the full payload
+     */
+    static bool decodeHeader(const uint8_t* data, size_t length, LumaHeader& header);
+
+    /**
+     * Check for the plane magic (frame envelopes start with "CAM")
+     */
+    static bool isLuma(const uint8_t* data, size_t length);
+
+    /**
+     * Plane size for a source: fits in maxWidth × maxHeight, keeps the source aspect ratio
+     * (rounded), never larger than the source
+     */
+    static void fitSize(uint16_t srcWidth, uint16_t srcHeight, uint16_t maxWidth, uint16_t maxHeight,
+                        uint16_t& width, uint16_t& height);
+
+    /**
+     * Area-resample a plane to another size (down or up)
+     * @param scratch 2 × dstWidth accumulators (srcWidth × srcHeight below 2^24)
+     */
+    static void resample(const uint8_t* src, uint16_t srcWidth, uint16_t srcHeight, uint8_t* dst,
+                         uint16_t dstWidth, uint16_t dstHeight, uint32_t* scratch);
+
+    /**
+     * Delta-code a plane against the reference (updated to what the decoder reconstructs)
+     * @return Payload length (0 if `out` is too small; the reference is then undefined)
+     */
+    static size_t encodeDelta(const uint8_t* plane, uint8_t* reference, size_t pixels, uint8_t deadband,
+                              uint8_t* out, size_t capacity);
+
+    /**
+     * Apply a delta payload to the previous plane (zero plane for a key plane)
+     * @return false if the payload does not cover exactly `pixels`
+     */
+    static bool decodeDelta(const uint8_t* payload, size_t length, uint8_t* plane, size_t pixels);
+};
+
+/**
+ * Side-stream settings
+ */
+struct LumaStreamConfig {
+    uint16_t width = 80;           // largest plane (smaller sources are not upscaled)
+    uint16_t height = 60;
+    uint32_t intervalMs = 200;     // 0 = off
+    uint8_t deadband = 2;
+    uint16_t keyInterval = 50;     // planes between key planes (0 = only when needed)
+    size_t headroom = 0;           // transport header room in front of each message (at most kMaxHeadroom)
+};
+
+/**
+ * Side-stream counters
+ */
+struct LumaStreamStats {
+    uint32_t published;        // planes resampled from captures
+    uint32_t sent;
+    uint32_t keyPlanes;        // planes coded as key planes
+    uint32_t failed;           // sends the transport refused (next plane is a key plane)
+    uint32_t skipped;          // planes replaced before they were sent
+    uint64_t bytes;            // messages sent (header + payload)
+    uint32_t lastPayload;      // bytes of the last plane
+};
+
+/**
+ * Latest plane (capture side) and its delta-coded messages (network side)
+ */
+class LumaStream {
+public:
+    static constexpr size_t kMaxHeadroom = 16;
+
+    static constexpr size_t bufferBytes(uint16_t width, uint16_t height) {
+        return 2 * (size_t)width * height + kMaxHeadroom + LumaCodec::kHeaderSize +
+               LumaCodec::maxPayload((size_t)width * height) + 2 * sizeof(uint32_t) * width;
+    }
+
+    explicit LumaStream(const LumaStreamConfig& config);
+    ~LumaStream();
+
+    LumaStream(const LumaStream&) = delete;
+    LumaStream& operator=(const LumaStream&) = delete;
+
+    /**
+     * Take a plane from a capture when the interval is due
+     * @param luma Source plane (e.g. the motion gate thumbnail), srcWidth × srcHeight
+     * @return true if the plane was taken
+     */
+    bool publish(const uint8_t* luma, uint16_t srcWidth, uint16_t srcHeight, uint8_t frameSize,
+                 uint64_t captureUs, uint32_t nowMs);
+
+    /**
+     * A published plane waits to be sent
+     */
+    bool hasPending() const;
+
+    /**
+     * Code the pending plane into the message buffer
+     * @param message Set to the message (the transport header room lies in front of it)
+     * @param length Set to header + payload
+     * @return false if nothing is pending
+     */
+    bool encode(bool clockSynced, int64_t clockOffsetUs, uint8_t*& message, size_t& length);
+
+    /**
+     * Finish the message from encode() (not sent: the next plane is a key plane)
+     */
+    void commit(bool sent, size_t length);
+
+    /**
+     * Next plane is a key plane (connection lost; the receiver dropped its reference)
+     */
+    void reset();
+
+    /**
+     * Change the interval at runtime (0 = off)
+     */
+    void setInterval(uint32_t intervalMs);
+
+    uint32_t getInterval() const;
+
+    /**
+     * Size of the last published plane (0 × 0 before the first one)
+     */
+    void getPlaneSize(uint16_t& width, uint16_t& height) const;
+    const LumaStreamConfig& getConfig() const { return _config; }
+    LumaStreamStats getStats() const;
+
+private:
+    LumaStreamConfig _config;
+    uint8_t* _latest;
+    uint8_t* _reference;
+    uint8_t* _buffer;              // headroom + header + payload
+    uint32_t* _scratch;
+    uint32_t _intervalMs;
+    uint32_t _lastPublishMs;
+    bool _published;               // _lastPublishMs is valid
+    bool _pending;
+    bool _forceKey;
+    uint16_t _sourceWidth;
+    uint16_t _sourceHeight;
+    uint16_t _planeWidth;
+    uint16_t _planeHeight;
+    uint8_t _frameSize;
+    uint64_t _captureUs;
+    uint32_t _sequence;
+    uint16_t _sinceKey;
+    LumaStreamStats _stats;
+    mutable std::mutex _mutex;
+};
+
+#endif // LUMA_STREAM_H
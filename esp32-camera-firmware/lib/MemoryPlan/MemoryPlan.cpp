@@ -0,0 +1,52 @@
+/**
+ * `MemoryPlan.cpp`
+ * - Memory plan report (the plan itself is constexpr, see MemoryPlan.h)
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#include "MemoryPlan.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+
+static void appendf(char* out, size_t capacity, size_t& length, const char* format, ...) {
+    if (length >= capacity) {
+        return;
+    }
+    va_list args;
+    va_start(args, format);
+    int written = vsnprintf(out + length, capacity - length, format, args);
+    va_end(args);
+    length = written < 0 ? capacity : length + (size_t)written;
+}
+
+const char* MemoryPlan::regionName(MemoryRegion region) {
+    return region == MemoryRegion::Dram ? "DRAM" : "PSRAM";
+}
+
+size_t MemoryPlan::formatRegion(MemoryRegion region, char* out, size_t capacity) const {
+    if (out == NULL || capacity == 0) {
+        return 0;
+    }
+    size_t length = 0;
+    appendf(out, capacity, length, "%s %u KB of %u KB (reserve %u KB)", regionName(region),
+            (unsigned)(usedBytes(region) / 1024), (unsigned)(budgetBytes(region) / 1024),
+            (unsigned)(_budget.reserveBytes / 1024));
+    const char* separator = ": ";
+    for (size_t i = 0; i < _count; i++) {
+        if (_items[i].region != region || _items[i].bytes == 0) {
+            continue;
+        }
+        appendf(out, capacity, length, "%s%s %u KB", separator, _items[i].name, (unsigned)(_items[i].bytes / 1024));
+        separator = ", ";
+    }
+    if (length >= capacity) {
+        out[0] = '\0';
+        return 0;
+    }
+    return length;
+}
@@ -0,0 +1,283 @@
+/**
+ * `MemoryPlan.h`
+ * - Compile-time memory plan: frame buffers (frame size, count, DRAM or PSRAM) and the other
+ *   large heap buffers, checked against the Config.h budgets with static_assert and printed
+ *   at boot, so which plan runs no longer depends on the build system
+ * - The camera driver gives every JPEG frame buffer width × height / 5 bytes and drops frames
+ *   that do not fit; worstJpegBytes() is the upper envelope of OV2640 JPEG output for a detailed
+ *   scene by quality, so the plan can tell which qualities are safe for a buffer (model, not
+ *   measured on a device; the synthetic frames of the replay harness and tests stay below it)
+ * - Frame buffers are planned after the other buffers of their region:
+ *   - with PSRAM: the snapshot size if it is preallocated (else the largest streamed size),
+ *     as many buffers as wanted and fit; too few for the snapshot size → stream size instead
+ *   - without PSRAM: one DRAM buffer of the largest streamed size that fits, down to the
+ *     boot size (the stream is capped there)
+ * - Frame size values follow esp32-camera framesize_t (96X96 .. UXGA)
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#ifndef MEMORY_PLAN_H
+#define MEMORY_PLAN_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Where a buffer lives
+ */
+enum class MemoryRegion : uint8_t {
+    Dram,          // internal heap
+    Psram
+};
+
+/**
+ * Heap available to the application
+ */
+struct MemoryBudget {
+    uint32_t dramBytes;        // internal heap left after WiFi/lwIP/WebSockets started
+    uint32_t psramBytes;       // 0 = no PSRAM
+    uint32_t reserveBytes;     // kept free in each region
+};
+
+/**
+ * One planned allocation
+ */
+struct MemoryItem {
+    const char* name;
+    uint32_t bytes;
+    MemoryRegion region;
+};
+
+/**
+ * What the frame buffers must hold
+ */
+struct FrameBufferRequest {
+    uint8_t bootFrameSize;         // stream frame size at boot
+    uint8_t streamMaxFrameSize;    // largest size the stream switches to live (ABR ladder)
+    uint8_t fbCount;               // buffers wanted with PSRAM
+    uint8_t minFbCount;            // fewer than this: no snapshot-size buffers
+    bool fbInPsram;
+    bool snapshotPreallocate;      // buffers for the snapshot size (live switch)
+    uint8_t snapshotFrameSize;
+};
+
+/**
+ * Planned frame buffers
+ */
+struct FrameBufferPlan {
+    uint8_t frameSize;             // size the buffers are allocated for
+    uint8_t fbCount;               // 0 = they do not fit
+    MemoryRegion region;
+    uint32_t fbBytes;              // one buffer
+    uint8_t streamMaxFrameSize;    // largest streamed size (capped to frameSize)
+    bool snapshotLive;             // snapshot size fits the buffers (no re-init)
+};
+
+/**
+ * Memory planner (constexpr: usable in static_assert)
+ */
+class MemoryPlan {
+public:
+    static constexpr uint8_t kFrameSizeCount = 14;     // FRAMESIZE_96X96 .. FRAMESIZE_UXGA
+    static constexpr size_t kMaxItems = 10;
+    static constexpr uint32_t kJpegOverheadBytes = 1024;   // SOI .. SOS header (kMaxJpegPreamble)
+
+    constexpr explicit MemoryPlan(const MemoryBudget& budget) : _budget(budget) {}
+
+    // ========================================
+    // Frame sizes and JPEG sizes
+    // ========================================
+    static constexpr uint16_t frameWidth(uint8_t frameSize) {
+        return frameSize < kFrameSizeCount ? kDimensions[frameSize][0] : 0;
+    }
+
+    static constexpr uint16_t frameHeight(uint8_t frameSize) {
+        return frameSize < kFrameSizeCount ? kDimensions[frameSize][1] : 0;
+    }
+
+    /**
+     * Frame buffer size the driver allocates for a JPEG frame size (width × height / 5)
+     */
+    static constexpr uint32_t frameBufferBytes(uint8_t frameSize) {
+        return (uint32_t)frameWidth(frameSize) * frameHeight(frameSize) / 5;
+    }
+
+    /**
+     * Worst-case JPEG size (detailed scene) for a frame size and quality (0-63, lower = larger)
+     */
+    static constexpr uint32_t worstJpegBytes(uint8_t frameSize, uint8_t quality) {
+        uint32_t pixels = (uint32_t)frameWidth(frameSize) * frameHeight(frameSize);
+        if (pixels == 0) {
+            return 0;
+        }
+        uint32_t milli = milliBytesPerPixel(quality);
+        return (uint32_t)(((uint64_t)pixels * milli + 999) / 1000) + kJpegOverheadBytes;
+    }
+
+    /**
+     * Lowest quality value whose worst-case JPEG fits a buffer
+     * @return 0-63, or 64 if none does
+     */
+    static constexpr uint8_t qualityFloor(uint8_t frameSize, uint32_t bufferBytes) {
+        for (uint8_t quality = 0; quality <= 63; quality++) {
+            if (worstJpegBytes(frameSize, quality) <= bufferBytes) {
+                return quality;
+            }
+        }
+        return 64;
+    }
+
+    // ========================================
+    // Planning
+    // ========================================
+    /**
+     * Add an allocation (ignored once kMaxItems are planned: check overflowed())
+     */
+    constexpr void add(const char* name, uint32_t bytes, MemoryRegion region) {
+        if (_count >= kMaxItems) {
+            _overflowed = true;
+            return;
+        }
+        _items[_count] = MemoryItem{name, bytes, region};
+        _count++;
+    }
+
+    /**
+     * Plan the frame buffers in what the other allocations left (adds them as "frame buffers")
+     */
+    constexpr FrameBufferPlan planFrameBuffers(const FrameBufferRequest& request) {
+        FrameBufferPlan plan = {};
+        const bool psram = _budget.psramBytes > 0;
+        plan.region = psram && request.fbInPsram ? MemoryRegion::Psram : MemoryRegion::Dram;
+        const uint32_t available = availableBytes(plan.region);
+        const uint8_t streamMax = request.streamMaxFrameSize > request.bootFrameSize ? request.streamMaxFrameSize
+                                                                                     : request.bootFrameSize;
+
+        if (psram) {
+            plan.frameSize = streamMax;
+            plan.fbCount = buffersFitting(streamMax, request.fbCount, available);
+            if (request.snapshotPreallocate && request.snapshotFrameSize > streamMax) {
+                uint8_t count = buffersFitting(request.snapshotFrameSize, request.fbCount, available);
+                if (count >= request.minFbCount && count > 0) {
+                    plan.frameSize = request.snapshotFrameSize;
+                    plan.fbCount = count;
+                }
+            }
+            plan.streamMaxFrameSize = streamMax;
+        } else {
+            // One buffer; the largest streamed size that fits (the stream is capped there)
+            plan.frameSize = request.bootFrameSize;
+            for (uint8_t size = streamMax; size > request.bootFrameSize; size--) {
+                if (frameBufferBytes(size) <= available) {
+                    plan.frameSize = size;
+                    break;
+                }
+            }
+            plan.fbCount = frameBufferBytes(plan.frameSize) <= available ? 1 : 0;
+            plan.streamMaxFrameSize = plan.frameSize;
+        }
+        plan.fbBytes = frameBufferBytes(plan.frameSize);
+        plan.snapshotLive = plan.frameSize >= request.snapshotFrameSize;
+        add("frame buffers", plan.fbBytes * plan.fbCount, plan.region);
+        _frameBuffers = plan;
+        return plan;
+    }
+
+    // ========================================
+    // Results
+    // ========================================
+    constexpr uint32_t usedBytes(MemoryRegion region) const {
+        uint32_t total = 0;
+        for (size_t i = 0; i < _count; i++) {
+            if (_items[i].region == region) {
+                total += _items[i].bytes;
+            }
+        }
+        return total;
+    }
+
+    constexpr uint32_t budgetBytes(MemoryRegion region) const {
+        return region == MemoryRegion::Dram ? _budget.dramBytes : _budget.psramBytes;
+    }
+
+    /**
+     * Left for further allocations in a region (after the reserve)
+     */
+    constexpr uint32_t availableBytes(MemoryRegion region) const {
+        uint32_t budget = budgetBytes(region);
+        uint32_t used = usedBytes(region) + _budget.reserveBytes;
+        return budget > used ? budget - used : 0;
+    }
+
+    /**
+     * Everything fits its region with the reserve left over (an empty region always fits)
+     */
+    constexpr bool fits(MemoryRegion region) const {
+        uint32_t used = usedBytes(region);
+        return used == 0 || used + _budget.reserveBytes <= budgetBytes(region);
+    }
+
+    constexpr bool fits() const {
+        return !_overflowed && fits(MemoryRegion::Dram) && fits(MemoryRegion::Psram) && _frameBuffers.fbCount > 0;
+    }
+
+    constexpr bool overflowed() const { return _overflowed; }
+    constexpr size_t itemCount() const { return _count; }
+    constexpr const MemoryItem& item(size_t index) const { return _items[index]; }
+    constexpr const FrameBufferPlan& frameBuffers() const { return _frameBuffers; }
+    constexpr const MemoryBudget& budget() const { return _budget; }
+
+    static const char* regionName(MemoryRegion region);
+
+    /**
+     * Render one line per region (`PSRAM 3.1 MB of 4.0 MB: frame buffers 1125 KB, ...`)
+     * @return Length, or 0 if it does not fit (out is an empty string then)
+     */
+    size_t formatRegion(MemoryRegion region, char* out, size_t capacity) const;
+
+private:
+    static constexpr uint16_t kDimensions[kFrameSizeCount][2] = {
+        {96, 96}, {160, 120}, {176, 144}, {240, 176}, {240, 240}, {320, 240}, {400, 296},
+        {480, 320}, {640, 480}, {800, 600}, {1024, 768}, {1280, 720}, {1280, 1024}, {1600, 1200},
+    };
+
+    // Worst-case bytes per 1000 pixels at quality breakpoints (linear in between)
+    static constexpr uint16_t kWorstCase[][2] = {
+        {0, 400}, {4, 320}, {6, 260}, {8, 220}, {10, 190}, {12, 170}, {15, 145},
+        {20, 115}, {25, 100}, {30, 88}, {40, 70}, {50, 58}, {63, 48},
+    };
+
+    static constexpr uint32_t milliBytesPerPixel(uint8_t quality) {
+        const size_t count = sizeof(kWorstCase) / sizeof(kWorstCase[0]);
+        if (quality >= kWorstCase[count - 1][0]) {
+            return kWorstCase[count - 1][1];
+        }
+        for (size_t i = 1; i < count; i++) {
+            if (quality <= kWorstCase[i][0]) {
+                uint32_t q0 = kWorstCase[i - 1][0], q1 = kWorstCase[i][0];
+                uint32_t m0 = kWorstCase[i - 1][1], m1 = kWorstCase[i][1];
+                // Rounded up (m0 > m1: larger towards the lower quality value)
+                return m1 + ((m0 - m1) * (q1 - quality) + (q1 - q0) - 1) / (q1 - q0);
+            }
+        }
+        return kWorstCase[0][1];
+    }
+
+    static constexpr uint8_t buffersFitting(uint8_t frameSize, uint8_t wanted, uint32_t available) {
+        uint32_t bytes = frameBufferBytes(frameSize);
+        uint32_t count = bytes > 0 ? available / bytes : 0;
+        return (uint8_t)(count < wanted ? count : wanted);
+    }
+
+    MemoryBudget _budget;
+    MemoryItem _items[kMaxItems] = {};
+    size_t _count = 0;
+    bool _overflowed = false;
+    FrameBufferPlan _frameBuffers = {};
+};
+
+#endif // MEMORY_PLAN_H
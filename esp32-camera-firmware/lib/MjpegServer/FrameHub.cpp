@@ -0,0 +1,105 @@
+/**
+ * `FrameHub.cpp`
+ * - Latest-frame fan-out implementation
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#include "FrameHub.h"
+
+#include <string.h>
+
+FrameHub::FrameHub(uint8_t* arena, size_t slots, size_t slotSize)
+    : _arena(arena),
+      _slotCount(slots < kMaxSlots ? slots : kMaxSlots),
+      _slotSize(slotSize),
+      _slots(),
+      _newest(-1),
+      _sequence(0),
+      _stats(),
+      _readers(0) {
+    for (size_t i = 0; i < _slotCount; i++) {
+        _slots[i].data = _arena + i * _slotSize;
+    }
+}
+
+bool FrameHub::publish(const uint8_t* jpeg, size_t length, uint64_t captureUs) {
+    int index = -1;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (length == 0 || length > _slotSize) {
+            _stats.oversized++;
+            return false;
+        }
+        uint32_t held = 0;
+        for (size_t i = 0; i < _slotCount; i++) {
+            if (_slots[i].refs == 0) {
+                if (index < 0) index = (int)i;
+            } else {
+                held++;
+            }
+        }
+        if (index < 0) {
+            _stats.noSlot++;
+            return false;
+        }
+        _slots[index].refs = 1;  // publisher's reference, handed to the hub below
+        if (held + 1 > _stats.maxHeld) {
+            _stats.maxHeld = held + 1;
+        }
+    }
+
+    Slot& slot = _slots[index];
+    memcpy(slot.data, jpeg, length);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    slot.length = length;
+    slot.captureUs = captureUs;
+    slot.sequence = ++_sequence;
+    if (_newest >= 0) {
+        _slots[_newest].refs--;
+    }
+    _newest = index;
+    _stats.published++;
+    return true;
+}
+
+bool FrameHub::acquire(uint32_t afterSequence, HubFrame& frame) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    // Sequence wraps after 2^32 frames: compare by distance
+    if (_newest < 0 || (int32_t)(_slots[_newest].sequence - afterSequence) <= 0) {
+        return false;
+    }
+    Slot& slot = _slots[_newest];
+    slot.refs++;
+    frame.data = slot.data;
+    frame.length = slot.length;
+    frame.captureUs = slot.captureUs;
+    frame.sequence = slot.sequence;
+    frame.slot = _newest;
+    return true;
+}
+
+void FrameHub::release(HubFrame& frame) {
+    if (frame.slot < 0) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _slots[frame.slot].refs--;
+    }
+    frame.slot = -1;
+}
+
+uint32_t FrameHub::refCount(int slot) const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return slot >= 0 && (size_t)slot < _slotCount ? _slots[slot].refs : 0;
+}
+
+FrameHubStats FrameHub::getStats() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _stats;
+}
@@ -0,0 +1,125 @@
+/**
+ * `FrameHub.h`
+ * - Latest-frame fan-out for local viewers (MJPEG HTTP server)
+ * - publish() copies a captured JPEG once into a refcounted slot; every viewer sends from that
+ *   same slot (no per-viewer copy) and releases it when its socket has taken the last byte
+ * - Viewers always take the newest frame: a slow viewer skips frames on its own without
+ *   holding back the others or the capture path
+ * - Driver frame buffers are returned right after the copy (a slow viewer never holds the camera)
+ * - Fixed slots in caller-owned memory, no heap; thread-safe (capture task publishes, server task reads)
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#ifndef FRAME_HUB_H
+#define FRAME_HUB_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+#include <mutex>
+
+/**
+ * Reference to a published frame (valid until FrameHub::release)
+ */
+struct HubFrame {
+    const uint8_t* data;
+    size_t length;
+    uint64_t captureUs;
+    uint32_t sequence;         // publish order, starts at 1
+    int slot;                  // -1 = no frame
+};
+
+/**
+ * Hub counters
+ */
+struct FrameHubStats {
+    uint32_t published;
+    uint32_t oversized;        // frames larger than a slot (not published)
+    uint32_t noSlot;           // every slot held (more readers than the hub was sized for)
+    uint32_t maxHeld;          // high-water mark of slots in use
+};
+
+/**
+ * Refcounted latest-frame slots
+ */
+class FrameHub {
+public:
+    static constexpr size_t kMaxSlots = 8;
+
+    /**
+     * Slots needed so publish() always finds a free one
+     * - newest frame + the frame being copied + one frame held by each reader
+     */
+    static constexpr size_t slotsFor(size_t readers) { return readers + 2; }
+
+    /**
+     * Constructor
+     * @param arena Caller-owned `slots * slotSize` bytes
+     * @param slots Number of frames (at most kMaxSlots)
+     * @param slotSize Largest JPEG
+     */
+    FrameHub(uint8_t* arena, size_t slots, size_t slotSize);
+
+    FrameHub(const FrameHub&) = delete;
+    FrameHub& operator=(const FrameHub&) = delete;
+
+    /**
+     * Copy a frame into a free slot and make it the newest
+     * - The copy runs outside the lock (readers keep sending meanwhile)
+     * @return false if the frame is too large or no slot is free
+     */
+    bool publish(const uint8_t* jpeg, size_t length, uint64_t captureUs);
+
+    /**
+     * Take a reference to the newest frame if it is newer than `afterSequence`
+     * @return false if there is nothing new
+     */
+    bool acquire(uint32_t afterSequence, HubFrame& frame);
+
+    /**
+     * Drop a reference taken by acquire()
+     */
+    void release(HubFrame& frame);
+
+    /**
+     * Readers register so the capture path can skip the copy while nobody watches
+     */
+    void attach() { _readers++; }
+    void detach() { _readers--; }
+    bool hasReaders() const { return _readers.load() > 0; }
+
+    /**
+     * References currently held on a slot (tests)
+     */
+    uint32_t refCount(int slot) const;
+
+    size_t slotCount() const { return _slotCount; }
+    size_t slotSize() const { return _slotSize; }
+    FrameHubStats getStats() const;
+
+private:
+    struct Slot {
+        uint8_t* data;
+        size_t length;
+        uint64_t captureUs;
+        uint32_t sequence;
+        uint32_t refs;         // the hub holds one on the newest frame, the publisher one while copying
+    };
+
+    uint8_t* _arena;
+    size_t _slotCount;
+    size_t _slotSize;
+    Slot _slots[kMaxSlots];
+    int _newest;
+    uint32_t _sequence;
+    FrameHubStats _stats;
+    std::atomic<int> _readers;
+    mutable std::mutex _mutex;
+};
+
+#endif // FRAME_HUB_H
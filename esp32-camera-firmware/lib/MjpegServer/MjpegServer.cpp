@@ -0,0 +1,447 @@
+/**
+ * `MjpegServer.cpp`
+ * - MJPEG-over-HTTP server implementation
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#include "MjpegServer.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <netinet/in.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+
+#include <chrono>
+
+#ifdef ESP_PLATFORM
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+#endif
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+// ========================================
+// Platform Helpers
+// ========================================
+static uint64_t nowMicros() {
+#ifdef ESP_PLATFORM
+    return (uint64_t)esp_timer_get_time();
+#else
+    return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+static bool setNonBlocking(int fd) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+static bool wouldBlock() {
+    return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+}
+
+// Select timeout without any streaming viewer (only accepts and requests to watch)
+static const uint32_t kIdlePollMs = 50;
+
+static const char kStreamResponse[] =
+    "HTTP/1.1 200 OK\r\n"
+    "Content-Type: multipart/x-mixed-replace; boundary=frame\r\n"
+    "Cache-Control: no-cache, no-store\r\n"
+    "Connection: close\r\n"
+    "\r\n";
+
+// ========================================
+// MjpegServer
+// ========================================
+MjpegServer::MjpegServer(FrameHub& hub, const MjpegServerConfig& config)
+    : _hub(hub), _config(config), _listenFd(-1), _port(0), _viewers(), _stats(), _running(false)
+#ifdef ESP_PLATFORM
+      , _taskActive(false)
+#endif
+{
+    if (_config.maxViewers > kMaxViewers) {
+        _config.maxViewers = kMaxViewers;
+    }
+    for (size_t i = 0; i < kMaxViewers; i++) {
+        _viewers[i].fd = -1;
+        _viewers[i].state = ViewerState::Free;
+        _viewers[i].frame.slot = -1;
+    }
+}
+
+MjpegServer::~MjpegServer() {
+    stop();
+}
+
+bool MjpegServer::open() {
+    if (_listenFd >= 0) {
+        return true;
+    }
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return false;
+    }
+    int reuse = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    struct sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(_config.port);
+    socklen_t addressLength = sizeof(address);
+    if (bind(fd, (struct sockaddr*)&address, sizeof(address)) != 0 ||
+        listen(fd, (int)_config.maxViewers + 1) != 0 || !setNonBlocking(fd) ||
+        getsockname(fd, (struct sockaddr*)&address, &addressLength) != 0) {
+        close(fd);
+        return false;
+    }
+    _listenFd = fd;
+    _port = ntohs(address.sin_port);
+    return true;
+}
+
+bool MjpegServer::start() {
+    if (!open()) {
+        return false;
+    }
+    if (_running.exchange(true)) {
+        return true;
+    }
+
+#ifdef ESP_PLATFORM
+    _taskActive = true;
+    if (xTaskCreatePinnedToCore(serverTaskEntry, "mjpeg", _config.stackSize, this,
+                                _config.priority, NULL, _config.core) != pdPASS) {
+        _taskActive = false;
+        _running = false;
+        return false;
+    }
+#else
+    _serverThread = std::thread([this] { serverLoop(); });
+#endif
+    return true;
+}
+
+void MjpegServer::stop() {
+    if (_running.exchange(false)) {
+#ifdef ESP_PLATFORM
+        std::unique_lock<std::mutex> lock(_exitMutex);
+        _exitCond.wait(lock, [this] { return !_taskActive; });
+#else
+        if (_serverThread.joinable()) _serverThread.join();
+#endif
+    }
+
+    for (size_t i = 0; i < kMaxViewers; i++) {
+        if (_viewers[i].state != ViewerState::Free) {
+            closeViewer(_viewers[i]);
+        }
+    }
+    if (_listenFd >= 0) {
+        close(_listenFd);
+        _listenFd = -1;
+    }
+}
+
+MjpegServerStats MjpegServer::getStats() const {
+    std::lock_guard<std::mutex> lock(_statsMutex);
+    return _stats;
+}
+
+// ========================================
+// Socket Service
+// ========================================
+void MjpegServer::serviceOnce(uint32_t timeoutMs) {
+    if (_listenFd < 0) {
+        return;
+    }
+    uint64_t nowUs = nowMicros();
+
+    // Idle viewers pick up the newest frame before waiting for writability
+    fd_set readSet;
+    fd_set writeSet;
+    FD_ZERO(&readSet);
+    FD_ZERO(&writeSet);
+    FD_SET(_listenFd, &readSet);
+    int maxFd = _listenFd;
+    for (size_t i = 0; i < kMaxViewers; i++) {
+        Viewer& viewer = _viewers[i];
+        if (viewer.state == ViewerState::Free) {
+            continue;
+        }
+        if (viewer.state == ViewerState::Streaming && !wantsWrite(viewer) && nextFrame(viewer)) {
+            viewer.lastProgressUs = nowUs;
+        }
+        FD_SET(viewer.fd, &readSet);  // requests, or the client closing the stream
+        if (wantsWrite(viewer)) {
+            FD_SET(viewer.fd, &writeSet);
+        }
+        if (viewer.fd > maxFd) maxFd = viewer.fd;
+    }
+
+    struct timeval timeout;
+    timeout.tv_sec = timeoutMs / 1000;
+    timeout.tv_usec = (timeoutMs % 1000) * 1000;
+    int ready = select(maxFd + 1, &readSet, &writeSet, NULL, &timeout);
+    nowUs = nowMicros();
+    if (ready < 0) {
+        return;
+    }
+
+    if (FD_ISSET(_listenFd, &readSet)) {
+        acceptViewer(nowUs);
+    }
+    for (size_t i = 0; i < kMaxViewers; i++) {
+        Viewer& viewer = _viewers[i];
+        if (viewer.state == ViewerState::Free) {
+            continue;
+        }
+        int fd = viewer.fd;
+        if (ready > 0 && FD_ISSET(fd, &readSet)) {
+            readRequest(viewer, nowUs);
+        }
+        if (viewer.state != ViewerState::Free && ready > 0 && FD_ISSET(fd, &writeSet)) {
+            writeViewer(viewer, nowUs);
+        }
+        if (viewer.state != ViewerState::Free &&
+            (viewer.state == ViewerState::Request || wantsWrite(viewer)) &&
+            nowUs - viewer.lastProgressUs > (uint64_t)_config.stallTimeoutMs * 1000) {
+            if (viewer.state == ViewerState::Streaming) {
+                std::lock_guard<std::mutex> lock(_statsMutex);
+                _stats.stalled++;
+            }
+            closeViewer(viewer);
+        }
+    }
+}
+
+void MjpegServer::acceptViewer(uint64_t nowUs) {
+    int fd = accept(_listenFd, NULL, NULL);
+    if (fd < 0) {
+        return;
+    }
+    for (size_t i = 0; i < kMaxViewers; i++) {
+        Viewer& viewer = _viewers[i];
+        if (viewer.state != ViewerState::Free) {
+            continue;
+        }
+        if (!setNonBlocking(fd)) {
+            break;
+        }
+        // lwIP has no per-socket buffer size (TCP_SND_BUF is already small): failure is fine
+        if (_config.sendBufferBytes > 0) {
+            setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &_config.sendBufferBytes, sizeof(_config.sendBufferBytes));
+        }
+        viewer.fd = fd;
+        viewer.state = ViewerState::Request;
+        viewer.requestLength = 0;
+        viewer.headLength = 0;
+        viewer.headSent = 0;
+        viewer.frame.slot = -1;
+        viewer.frameSent = 0;
+        viewer.lastSequence = 0;
+        viewer.lastProgressUs = nowUs;
+        return;
+    }
+    // No connection slot left: nothing can be answered
+    close(fd);
+    std::lock_guard<std::mutex> lock(_statsMutex);
+    _stats.rejected++;
+}
+
+void MjpegServer::readRequest(Viewer& viewer, uint64_t nowUs) {
+    if (viewer.state != ViewerState::Request) {
+        // Streaming viewers send nothing after the request: data is ignored, EOF closes
+        char discard[64];
+        ssize_t n = recv(viewer.fd, discard, sizeof(discard), 0);
+        if (n == 0 || (n < 0 && !wouldBlock())) {
+            closeViewer(viewer);
+        }
+        return;
+    }
+
+    size_t room = sizeof(viewer.request) - 1 - viewer.requestLength;
+    ssize_t n = recv(viewer.fd, viewer.request + viewer.requestLength, room, 0);
+    if (n == 0 || (n < 0 && !wouldBlock())) {
+        closeViewer(viewer);
+        return;
+    }
+    if (n < 0) {
+        return;
+    }
+    viewer.requestLength += (size_t)n;
+    viewer.request[viewer.requestLength] = '\0';
+    viewer.lastProgressUs = nowUs;
+    if (strstr(viewer.request, "\r\n\r\n") == NULL && strstr(viewer.request, "\n\n") == NULL) {
+        if (viewer.requestLength == sizeof(viewer.request) - 1) {
+            respond(viewer, "400 Bad Request");
+        }
+        return;
+    }
+
+    // Request line: GET <path>[?query] HTTP/1.x
+    size_t pathLength = strlen(_config.path);
+    const char* path = viewer.request + 4;
+    bool matches = strncmp(viewer.request, "GET ", 4) == 0 && strncmp(path, _config.path, pathLength) == 0 &&
+                   (path[pathLength] == ' ' || path[pathLength] == '?');
+    if (!matches) {
+        respond(viewer, "404 Not Found");
+        return;
+    }
+    if (streamingCount() >= _config.maxViewers) {
+        respond(viewer, "503 Service Unavailable");
+        return;
+    }
+
+    memcpy(viewer.head, kStreamResponse, sizeof(kStreamResponse) - 1);
+    viewer.headLength = sizeof(kStreamResponse) - 1;
+    viewer.headSent = 0;
+    viewer.state = ViewerState::Streaming;
+    _hub.attach();
+    std::lock_guard<std::mutex> lock(_statsMutex);
+    _stats.accepted++;
+    _stats.viewers = (uint32_t)streamingCount();
+}
+
+void MjpegServer::writeViewer(Viewer& viewer, uint64_t nowUs) {
+    while (true) {
+        const uint8_t* data;
+        size_t remaining;
+        if (viewer.headSent < viewer.headLength) {
+            data = (const uint8_t*)viewer.head + viewer.headSent;
+            remaining = viewer.headLength - viewer.headSent;
+        } else if (viewer.frame.slot >= 0 && viewer.frameSent < viewer.frame.length) {
+            data = viewer.frame.data + viewer.frameSent;
+            remaining = viewer.frame.length - viewer.frameSent;
+        } else {
+            if (viewer.frame.slot >= 0) {
+                std::lock_guard<std::mutex> lock(_statsMutex);
+                _stats.framesSent++;
+                _stats.bytesSent += viewer.frame.length;
+            }
+            _hub.release(viewer.frame);
+            if (viewer.state == ViewerState::Closing) {
+                closeViewer(viewer);
+                return;
+            }
+            if (!nextFrame(viewer)) {
+                return;
+            }
+            continue;
+        }
+
+        ssize_t n = send(viewer.fd, data, remaining, MSG_NOSIGNAL);
+        if (n <= 0) {
+            if (n < 0 && wouldBlock()) {
+                return;  // socket full: this viewer keeps its frame, the others go on
+            }
+            closeViewer(viewer);
+            return;
+        }
+        viewer.lastProgressUs = nowUs;
+        if (viewer.headSent < viewer.headLength) {
+            viewer.headSent += (size_t)n;
+        } else {
+            viewer.frameSent += (size_t)n;
+        }
+    }
+}
+
+bool MjpegServer::nextFrame(Viewer& viewer) {
+    if (viewer.state != ViewerState::Streaming || viewer.headSent < viewer.headLength ||
+        !_hub.acquire(viewer.lastSequence, viewer.frame)) {
+        return false;
+    }
+    if (viewer.lastSequence != 0 && viewer.frame.sequence - viewer.lastSequence > 1) {
+        std::lock_guard<std::mutex> lock(_statsMutex);
+        _stats.framesSkipped += viewer.frame.sequence - viewer.lastSequence - 1;
+    }
+    viewer.lastSequence = viewer.frame.sequence;
+    viewer.frameSent = 0;
+    int length = snprintf(viewer.head, sizeof(viewer.head),
+                          "\r\n--frame\r\n"
+                          "Content-Type: image/jpeg\r\n"
+                          "Content-Length: %u\r\n"
+                          "X-Frame-Sequence: %u\r\n"
+                          "X-Timestamp-Us: %llu\r\n"
+                          "\r\n",
+                          (unsigned)viewer.frame.length, (unsigned)viewer.frame.sequence,
+                          (unsigned long long)viewer.frame.captureUs);
+    viewer.headLength = (size_t)length;
+    viewer.headSent = 0;
+    return true;
+}
+
+void MjpegServer::respond(Viewer& viewer, const char* status) {
+    viewer.headLength = (size_t)snprintf(viewer.head, sizeof(viewer.head),
+                                         "HTTP/1.1 %s\r\nContent-Length: 0\r\nConnection: close\r\n\r\n", status);
+    viewer.headSent = 0;
+    viewer.state = ViewerState::Closing;
+    std::lock_guard<std::mutex> lock(_statsMutex);
+    _stats.rejected++;
+}
+
+void MjpegServer::closeViewer(Viewer& viewer) {
+    _hub.release(viewer.frame);
+    close(viewer.fd);
+    viewer.fd = -1;
+    bool streaming = viewer.state == ViewerState::Streaming;
+    viewer.state = ViewerState::Free;
+    if (streaming) {
+        _hub.detach();
+        std::lock_guard<std::mutex> lock(_statsMutex);
+        _stats.closed++;
+        _stats.viewers = (uint32_t)streamingCount();
+    }
+}
+
+bool MjpegServer::wantsWrite(const Viewer& viewer) const {
+    return viewer.headSent < viewer.headLength ||
+           (viewer.frame.slot >= 0 && viewer.frameSent < viewer.frame.length) ||
+           viewer.state == ViewerState::Closing;
+}
+
+size_t MjpegServer::streamingCount() const {
+    size_t count = 0;
+    for (size_t i = 0; i < kMaxViewers; i++) {
+        if (_viewers[i].state == ViewerState::Streaming) {
+            count++;
+        }
+    }
+    return count;
+}
+
+// ========================================
+// Server Task
+// ========================================
+void MjpegServer::serverLoop() {
+    while (_running.load()) {
+        serviceOnce(streamingCount() > 0 ? _config.pollIntervalMs : kIdlePollMs);
+    }
+}
+
+#ifdef ESP_PLATFORM
+void MjpegServer::serverTaskEntry(void* arg) {
+    MjpegServer* self = static_cast<MjpegServer*>(arg);
+    self->serverLoop();
+    {
+        std::lock_guard<std::mutex> lock(self->_exitMutex);
+        self->_taskActive = false;
+        self->_exitCond.notify_all();
+    }
+    vTaskDelete(NULL);
+}
+#endif
@@ -0,0 +1,169 @@
+/**
+ * `MjpegServer.h`
+ * - Embedded `multipart/x-mixed-replace` HTTP server for LAN viewers (`GET /stream`)
+ * - One server task multiplexes every viewer with select() and non-blocking sockets:
+ *   a viewer whose socket is full keeps its current frame and takes the newest one when
+ *   it drains, so each viewer drops frames independently (see FrameHub)
+ * - Runs next to the cloud WebSocket upload; it never blocks the capture or network task
+ * - Platform independent: BSD sockets (lwIP on device, the host stack on Linux),
+ *   FreeRTOS task on device, std::thread on the host
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#ifndef MJPEG_SERVER_H
+#define MJPEG_SERVER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+
+#include "FrameHub.h"
+
+#ifndef ESP_PLATFORM
+#include <thread>
+#endif
+
+/**
+ * Server configuration
+ */
+struct MjpegServerConfig {
+    uint16_t port = 81;                // 0 = any free port (tests, see port())
+    const char* path = "/stream";
+    size_t maxViewers = 3;             // the hub needs FrameHub::slotsFor(maxViewers) slots
+    uint32_t pollIntervalMs = 5;       // longest wait before an idle viewer sees a new frame
+    uint32_t stallTimeoutMs = 10000;   // viewer that took no byte for this long is closed
+    int sendBufferBytes = 16 * 1024;   // per-viewer socket send buffer (0 = stack default); small
+                                       // so a slow viewer skips frames instead of queueing them
+
+    // FreeRTOS task parameters (ignored on host)
+    uint32_t stackSize = 4096;
+    uint8_t priority = 1;
+    int8_t core = 0;
+};
+
+/**
+ * Server counters
+ */
+struct MjpegServerStats {
+    uint32_t accepted;         // viewers that got a stream
+    uint32_t rejected;         // bad request, unknown path or server full
+    uint32_t closed;           // viewers gone (closed by the client, stalled or errors)
+    uint32_t stalled;          // closed by stallTimeoutMs
+    uint32_t framesSent;       // frames fully written, all viewers
+    uint32_t framesSkipped;    // newer frames a viewer was too slow for, all viewers
+    uint64_t bytesSent;
+    uint32_t viewers;          // streaming now
+};
+
+/**
+ * MJPEG-over-HTTP server
+ */
+class MjpegServer {
+public:
+    static constexpr size_t kMaxViewers = 6;
+
+    /**
+     * Constructor
+     * @param hub Frame source shared with the capture path
+     * @param config Server configuration
+     */
+    MjpegServer(FrameHub& hub, const MjpegServerConfig& config);
+    ~MjpegServer();
+
+    MjpegServer(const MjpegServer&) = delete;
+    MjpegServer& operator=(const MjpegServer&) = delete;
+
+    /**
+     * Open the listening socket (no task)
+     * @return false if the port cannot be bound
+     */
+    bool open();
+
+    /**
+     * Open the socket and start the server task
+     * @return false if the port cannot be bound or the task cannot start
+     */
+    bool start();
+
+    /**
+     * Stop the task, close every viewer and the listening socket
+     */
+    void stop();
+
+    /**
+     * Run one select() round: accept, read requests, write frames
+     * - Called by the server task; usable directly for single-threaded tests
+     * @param timeoutMs Max time to wait for socket activity
+     */
+    void serviceOnce(uint32_t timeoutMs);
+
+    /**
+     * Bound port (the chosen one when configured with port 0)
+     */
+    uint16_t port() const { return _port; }
+
+    bool isRunning() const { return _running.load(); }
+    MjpegServerStats getStats() const;
+
+private:
+    enum class ViewerState : uint8_t {
+        Free = 0,
+        Request,               // reading the request head
+        Streaming,             // response sent or being sent, frames follow
+        Closing                // error response being sent, then close
+    };
+
+    struct Viewer {
+        int fd;
+        ViewerState state;
+        char request[256];
+        size_t requestLength;
+        char head[192];        // response head and/or part head of the current frame
+        size_t headLength;
+        size_t headSent;
+        HubFrame frame;        // frame being written (reference held on the hub)
+        size_t frameSent;
+        uint32_t lastSequence;
+        uint64_t lastProgressUs;
+    };
+
+    void serverLoop();
+    void acceptViewer(uint64_t nowUs);
+    void readRequest(Viewer& viewer, uint64_t nowUs);
+    void writeViewer(Viewer& viewer, uint64_t nowUs);
+    bool nextFrame(Viewer& viewer);
+    void respond(Viewer& viewer, const char* status);
+    void closeViewer(Viewer& viewer);
+    bool wantsWrite(const Viewer& viewer) const;
+    size_t streamingCount() const;
+
+    FrameHub& _hub;
+    MjpegServerConfig _config;
+    int _listenFd;
+    uint16_t _port;
+    Viewer _viewers[kMaxViewers];
+
+    mutable std::mutex _statsMutex;
+    MjpegServerStats _stats;
+
+    std::atomic<bool> _running;
+
+#ifdef ESP_PLATFORM
+    static void serverTaskEntry(void* arg);
+
+    std::mutex _exitMutex;
+    std::condition_variable _exitCond;
+    bool _taskActive;
+#else
+    std::thread _serverThread;
+#endif
+};
+
+#endif // MJPEG_SERVER_H
@@ -0,0 +1,452 @@
+/**
+ * `JpegDcDecoder.cpp`
+ * - DC-only baseline JPEG decoder implementation
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#include "JpegDcDecoder.h"
+
+#include <string.h>
+
+// JPEG markers
+enum : uint8_t {
+    kMarkerSof0 = 0xC0,
+    kMarkerSof1 = 0xC1,
+    kMarkerDht = 0xC4,
+    kMarkerRst0 = 0xD0,
+    kMarkerSoi = 0xD8,
+    kMarkerEoi = 0xD9,
+    kMarkerSos = 0xDA,
+    kMarkerDqt = 0xDB,
+    kMarkerDri = 0xDD
+};
+
+static inline uint16_t readU16(const uint8_t* p) {
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+// ========================================
+// Constructor
+// ========================================
+JpegDcDecoder::JpegDcDecoder()
+    : _componentCount(0), _scanCount(0), _restartInterval(0), _width(0), _height(0),
+      _widthBlocks(0), _heightBlocks(0), _bitPtr(NULL), _bitEnd(NULL), _bitBuf(0),
+      _bitCount(0), _padBits(0) {
+    memset(_dcTables, 0, sizeof(_dcTables));
+    memset(_acTables, 0, sizeof(_acTables));
+    memset(_dcQuant, 0, sizeof(_dcQuant));
+    memset(_components, 0, sizeof(_components));
+    memset(_scanOrder, 0, sizeof(_scanOrder));
+}
+
+// ========================================
+// Marker Parsing
+// ========================================
+JpegDcError JpegDcDecoder::decode(const uint8_t* data, size_t length, uint8_t* luma, size_t capacity) {
+    _componentCount = 0;
+    _scanCount = 0;
+    _restartInterval = 0;
+    _width = _height = 0;
+    _widthBlocks = _heightBlocks = 0;
+    for (int i = 0; i < 2; i++) {
+        _dcTables[i].defined = false;
+        _acTables[i].defined = false;
+    }
+
+    if (data == NULL || length < 4 || data[0] != 0xFF || data[1] != kMarkerSoi) {
+        return JpegDcError::BadMarker;
+    }
+
+    const uint8_t* p = data + 2;
+    const uint8_t* end = data + length;
+    while (p < end) {
+        if (*p != 0xFF) {
+            return JpegDcError::BadMarker;
+        }
+        while (p < end && *p == 0xFF) {
+            p++;  // fill bytes
+        }
+        if (p >= end) {
+            break;
+        }
+        uint8_t marker = *p++;
+
+        // Standalone markers
+        if (marker == kMarkerSoi || marker == 0x01 || (marker & 0xF8) == kMarkerRst0) {
+            continue;
+        }
+        if (marker == kMarkerEoi) {
+            return JpegDcError::BadMarker;  // no scan
+        }
+
+        if (end - p < 2) {
+            return JpegDcError::Truncated;
+        }
+        size_t segmentLength = readU16(p);
+        if (segmentLength < 2 || (size_t)(end - p) < segmentLength) {
+            return JpegDcError::Truncated;
+        }
+        const uint8_t* payload = p + 2;
+        size_t payloadLength = segmentLength - 2;
+        p += segmentLength;
+
+        JpegDcError err = JpegDcError::None;
+        switch (marker) {
+            case kMarkerDqt:
+                if (!parseDqt(payload, payloadLength)) err = JpegDcError::BadMarker;
+                break;
+            case kMarkerDht:
+                if (!parseDht(payload, payloadLength)) err = JpegDcError::BadHuffman;
+                break;
+            case kMarkerSof0:
+            case kMarkerSof1:
+                err = parseSof(payload, payloadLength);
+                break;
+            case kMarkerDri:
+                if (payloadLength < 2) err = JpegDcError::BadMarker;
+                else _restartInterval = readU16(payload);
+                break;
+            case kMarkerSos:
+                err = parseSos(payload, payloadLength);
+                if (err == JpegDcError::None) {
+                    return decodeScan(p, end, luma, capacity);
+                }
+                break;
+            default:
+                // Other SOFn: progressive, lossless, arithmetic coding
+                if (marker >= 0xC2 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC) {
+                    err = JpegDcError::Unsupported;
+                }
+                break;  // APPn, COM, ...: skip
+        }
+        if (err != JpegDcError::None) {
+            return err;
+        }
+    }
+    return JpegDcError::Truncated;
+}
+
+bool JpegDcDecoder::parseDqt(const uint8_t* p, size_t len) {
+    while (len > 0) {
+        uint8_t precision = p[0] >> 4;
+        uint8_t table = p[0] & 0x0F;
+        size_t size = precision == 0 ? 65 : 129;
+        if (table > 3 || precision > 1 || len < size) {
+            return false;
+        }
+        // Only the DC quantizer (first entry, zigzag order) is needed
+        _dcQuant[table] = precision == 0 ? p[1] : readU16(p + 1);
+        p += size;
+        len -= size;
+    }
+    return true;
+}
+
+bool JpegDcDecoder::parseDht(const uint8_t* p, size_t len) {
+    while (len > 0) {
+        if (len < 17) {
+            return false;
+        }
+        uint8_t tableClass = p[0] >> 4;
+        uint8_t tableId = p[0] & 0x0F;
+        if (tableClass > 1 || tableId > 1) {
+            return false;
+        }
+        const uint8_t* counts = p + 1;
+        size_t total = 0;
+        for (int i = 0; i < 16; i++) {
+            total += counts[i];
+        }
+        if (total > 256 || len < 17 + total) {
+            return false;
+        }
+
+        HuffTable& table = tableClass == 0 ? _dcTables[tableId] : _acTables[tableId];
+        memcpy(table.huffVal, p + 17, total);
+        memset(table.lookup, 0, sizeof(table.lookup));
+
+        // Canonical code assignment (ITU T.81 Annex C)
+        int32_t code = 0;
+        int32_t index = 0;
+        for (int bits = 1; bits <= 16; bits++) {
+            int count = counts[bits - 1];
+            table.valOffset[bits] = index - code;
+            if (count == 0) {
+                table.maxCode[bits] = -1;
+            } else {
+                if (code + count > (1 << bits)) {
+                    return false;  // over-subscribed
+                }
+                for (int i = 0; i < count && bits <= HuffTable::kLookBits; i++) {
+                    int shift = HuffTable::kLookBits - bits;
+                    uint16_t entry = (uint16_t)((bits << 8) | table.huffVal[index + i]);
+                    int first = (code + i) << shift;
+                    for (int j = 0; j < (1 << shift); j++) {
+                        table.lookup[first + j] = entry;
+                    }
+                }
+                table.maxCode[bits] = code + count - 1;
+            }
+            code = (code + count) << 1;
+            index += count;
+        }
+        table.maxCode[17] = 0x7FFFFFFF;
+        table.defined = true;
+
+        p += 17 + total;
+        len -= 17 + total;
+    }
+    return true;
+}
+
+JpegDcError JpegDcDecoder::parseSof(const uint8_t* p, size_t len) {
+    if (len < 6) {
+        return JpegDcError::BadMarker;
+    }
+    if (p[0] != 8) {
+        return JpegDcError::Unsupported;  // 12-bit samples
+    }
+    _height = readU16(p + 1);
+    _width = readU16(p + 3);
+    _componentCount = p[5];
+    if (_width == 0 || _height == 0 || (_componentCount != 1 && _componentCount != 3)) {
+        return JpegDcError::Unsupported;
+    }
+    if (len < 6 + 3 * (size_t)_componentCount) {
+        return JpegDcError::BadMarker;
+    }
+
+    uint8_t hMax = 1;
+    uint8_t vMax = 1;
+    for (uint8_t i = 0; i < _componentCount; i++) {
+        Component& c = _components[i];
+        c.id = p[6 + i * 3];
+        c.h = p[7 + i * 3] >> 4;
+        c.v = p[7 + i * 3] & 0x0F;
+        c.tq = p[8 + i * 3] & 0x03;
+        if (c.h < 1 || c.h > 4 || c.v < 1 || c.v > 4) {
+            return JpegDcError::BadMarker;
+        }
+        if (c.h > hMax) hMax = c.h;
+        if (c.v > vMax) vMax = c.v;
+    }
+
+    // Luminance (first component) block grid, ignoring MCU padding
+    const Component& y = _components[0];
+    uint32_t lumaWidth = ((uint32_t)_width * y.h + hMax - 1) / hMax;
+    uint32_t lumaHeight = ((uint32_t)_height * y.v + vMax - 1) / vMax;
+    _widthBlocks = (uint16_t)((lumaWidth + 7) / 8);
+    _heightBlocks = (uint16_t)((lumaHeight + 7) / 8);
+    return JpegDcError::None;
+}
+
+JpegDcError JpegDcDecoder::parseSos(const uint8_t* p, size_t len) {
+    if (_componentCount == 0 || len < 1) {
+        return JpegDcError::BadMarker;
+    }
+    _scanCount = p[0];
+    if (_scanCount != _componentCount) {
+        return JpegDcError::Unsupported;  // non-interleaved scans
+    }
+    if (len < 1 + 2 * (size_t)_scanCount) {
+        return JpegDcError::BadMarker;
+    }
+    for (uint8_t i = 0; i < _scanCount; i++) {
+        uint8_t id = p[1 + i * 2];
+        uint8_t tables = p[2 + i * 2];
+        int found = -1;
+        for (uint8_t c = 0; c < _componentCount; c++) {
+            if (_components[c].id == id) found = c;
+        }
+        if (found < 0) {
+            return JpegDcError::BadMarker;
+        }
+        Component& c = _components[found];
+        c.td = tables >> 4;
+        c.ta = tables & 0x0F;
+        if (c.td > 1 || c.ta > 1 || !_dcTables[c.td].defined || !_acTables[c.ta].defined) {
+            return JpegDcError::BadHuffman;
+        }
+        _scanOrder[i] = (uint8_t)found;
+    }
+    return JpegDcError::None;
+}
+
+// ========================================
+// Entropy-Coded Segment
+// ========================================
+JpegDcError JpegDcDecoder::decodeScan(const uint8_t* p, const uint8_t* end, uint8_t* luma, size_t capacity) {
+    if ((size_t)_widthBlocks * _heightBlocks > capacity || luma == NULL) {
+        return JpegDcError::TooLarge;
+    }
+
+    // A single-component scan is not interleaved: one block per MCU
+    bool single = _scanCount == 1;
+    uint8_t hMax = 1;
+    uint8_t vMax = 1;
+    for (uint8_t i = 0; i < _componentCount; i++) {
+        if (_components[i].h > hMax) hMax = _components[i].h;
+        if (_components[i].v > vMax) vMax = _components[i].v;
+    }
+    uint32_t mcusX = single ? _widthBlocks : (_width + 8 * hMax - 1) / (8 * hMax);
+    uint32_t mcusY = single ? _heightBlocks : (_height + 8 * vMax - 1) / (8 * vMax);
+    int32_t lumaQuant = _dcQuant[_components[0].tq];
+
+    int32_t pred[kMaxComponents] = {0, 0, 0};
+    uint32_t restartsLeft = _restartInterval;
+    resetBits(p, end);
+
+    for (uint32_t my = 0; my < mcusY; my++) {
+        for (uint32_t mx = 0; mx < mcusX; mx++) {
+            if (_restartInterval != 0) {
+                if (restartsLeft == 0) {
+                    if (!restart()) {
+                        return JpegDcError::Truncated;
+                    }
+                    pred[0] = pred[1] = pred[2] = 0;
+                    restartsLeft = _restartInterval;
+                }
+                restartsLeft--;
+            }
+
+            for (uint8_t s = 0; s < _scanCount; s++) {
+                uint8_t ci = _scanOrder[s];
+                const Component& c = _components[ci];
+                const HuffTable& dc = _dcTables[c.td];
+                const HuffTable& ac = _acTables[c.ta];
+                uint8_t blocksH = single ? 1 : c.h;
+                uint8_t blocksV = single ? 1 : c.v;
+
+                for (uint8_t v = 0; v < blocksV; v++) {
+                    for (uint8_t h = 0; h < blocksH; h++) {
+                        // DC: differential against the previous block of this component
+                        int size = decodeHuffman(dc);
+                        if (size < 0 || size > 11) {
+                            return JpegDcError::BadHuffman;
+                        }
+                        if (size > 0) {
+                            pred[ci] += receiveExtend(size);
+                        }
+
+                        // AC: decode run/size symbols only to skip the value bits
+                        for (int k = 1; k < 64;) {
+                            int rs = decodeHuffman(ac);
+                            if (rs < 0) {
+                                return JpegDcError::BadHuffman;
+                            }
+                            int run = rs >> 4;
+                            int bits = rs & 0x0F;
+                            if (bits != 0) {
+                                skipBits(bits);
+                                k += run + 1;
+                            } else if (run == 15) {
+                                k += 16;  // ZRL
+                            } else {
+                                break;    // EOB
+                            }
+                        }
+
+                        if (ci == 0) {
+                            uint32_t bx = mx * blocksH + h;
+                            uint32_t by = my * blocksV + v;
+                            if (bx < _widthBlocks && by < _heightBlocks) {
+                                // Dequantized DC = 8 × block mean (level-shifted)
+                                int32_t value = 128 + (pred[0] * lumaQuant + (pred[0] >= 0 ? 4 : -4)) / 8;
+                                luma[by * _widthBlocks + bx] = (uint8_t)(value < 0 ? 0 : (value > 255 ? 255 : value));
+                            }
+                        }
+                    }
+                }
+            }
+        }
+        if (_padBits > _bitCount) {
+            return JpegDcError::Truncated;
+        }
+    }
+    return JpegDcError::None;
+}
+
+void JpegDcDecoder::resetBits(const uint8_t* p, const uint8_t* end) {
+    _bitPtr = p;
+    _bitEnd = end;
+    _bitBuf = 0;
+    _bitCount = 0;
+    _padBits = 0;
+}
+
+void JpegDcDecoder::fillBits() {
+    while (_bitCount <= 24) {
+        uint32_t byte = 0;
+        if (_bitPtr < _bitEnd) {
+            byte = *_bitPtr;
+            if (byte != 0xFF) {
+                _bitPtr++;
+            } else if (_bitPtr + 1 < _bitEnd && _bitPtr[1] == 0x00) {
+                _bitPtr += 2;  // stuffed byte
+            } else {
+                byte = 0;      // marker: feed zeros, leave it for restart()
+            }
+        } else {
+            _padBits += 8;
+        }
+        _bitBuf |= byte << (24 - _bitCount);
+        _bitCount += 8;
+    }
+}
+
+int JpegDcDecoder::decodeHuffman(const HuffTable& table) {
+    fillBits();
+    uint16_t entry = table.lookup[_bitBuf >> (32 - HuffTable::kLookBits)];
+    if (entry != 0) {
+        int bits = entry >> 8;
+        _bitBuf <<= bits;
+        _bitCount -= bits;
+        return entry & 0xFF;
+    }
+    for (int bits = HuffTable::kLookBits + 1; bits <= 16; bits++) {
+        int32_t code = (int32_t)(_bitBuf >> (32 - bits));
+        if (code <= table.maxCode[bits]) {
+            int32_t index = table.valOffset[bits] + code;
+            if (index < 0 || index > 255) {
+                return -1;
+            }
+            _bitBuf <<= bits;
+            _bitCount -= bits;
+            return table.huffVal[index];
+        }
+    }
+    return -1;
+}
+
+int JpegDcDecoder::receiveExtend(int bits) {
+    fillBits();
+    int value = (int)(_bitBuf >> (32 - bits));
+    _bitBuf <<= bits;
+    _bitCount -= bits;
+    return value < (1 << (bits - 1)) ? value - (1 << bits) + 1 : value;
+}
+
+void JpegDcDecoder::skipBits(int bits) {
+    fillBits();
+    _bitBuf <<= bits;
+    _bitCount -= bits;
+}
+
+bool JpegDcDecoder::restart() {
+    // Byte-align and step over the next RSTn marker
+    _bitBuf = 0;
+    _bitCount = 0;
+    _padBits = 0;
+    while (_bitPtr + 1 < _bitEnd) {
+        if (_bitPtr[0] == 0xFF && (_bitPtr[1] & 0xF8) == kMarkerRst0) {
+            _bitPtr += 2;
+            return true;
+        }
+        _bitPtr++;
+    }
+    return false;
+}
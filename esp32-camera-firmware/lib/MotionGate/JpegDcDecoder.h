@@ -0,0 +1,114 @@
+/**
+ * `JpegDcDecoder.h`
+ * - DC-only baseline JPEG decoder
+ * - Entropy-decodes each block's DC coefficient and skips the AC coefficients,
+ *   giving a 1/8-scale luminance thumbnail (one pixel per 8x8 block) without IDCT
+ * - Supports baseline Huffman JPEG (SOF0/SOF1), any sampling factors (OV2640 emits
+ *   4:2:2), grayscale and restart markers (DRI/RSTn)
+ * - Platform independent, no heap allocation (decodes straight from fb->buf)
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#ifndef JPEG_DC_DECODER_H
+#define JPEG_DC_DECODER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Decode result
+ */
+enum class JpegDcError : uint8_t {
+    None = 0,
+    Truncated,         // data ended before the end of the scan
+    BadMarker,         // missing SOI or malformed segment
+    Unsupported,       // progressive/arithmetic/12-bit or non-interleaved scan
+    BadHuffman,        // invalid table or undecodable code
+    TooLarge           // thumbnail does not fit the output buffer
+};
+
+/**
+ * DC-only JPEG decoder
+ */
+class JpegDcDecoder {
+public:
+    static constexpr size_t kMaxComponents = 3;
+
+    JpegDcDecoder();
+
+    /**
+     * Decode the luminance DC thumbnail of a JPEG image
+     * @param data JPEG bytes (SOI ... EOI)
+     * @param length JPEG length in bytes
+     * @param luma Output, one byte per luminance block, row-major (widthBlocks × heightBlocks)
+     * @param capacity Size of `luma` in bytes
+     * @return JpegDcError::None on success
+     */
+    JpegDcError decode(const uint8_t* data, size_t length, uint8_t* luma, size_t capacity);
+
+    uint16_t getWidth() const { return _width; }
+    uint16_t getHeight() const { return _height; }
+    uint16_t getWidthBlocks() const { return _widthBlocks; }
+    uint16_t getHeightBlocks() const { return _heightBlocks; }
+
+private:
+    /**
+     * Huffman table with a 9-bit lookahead for the common short codes
+     */
+    struct HuffTable {
+        static constexpr int kLookBits = 9;
+        uint16_t lookup[1 << kLookBits];   // (length << 8) | symbol, 0 = longer code
+        int32_t maxCode[18];               // largest code of each length (-1 = none)
+        int32_t valOffset[17];             // huffVal index of the first code of each length, minus that code
+        uint8_t huffVal[256];
+        bool defined;
+    };
+
+    struct Component {
+        uint8_t id;
+        uint8_t h;
+        uint8_t v;
+        uint8_t tq;        // quantization table
+        uint8_t td;        // DC Huffman table
+        uint8_t ta;        // AC Huffman table
+    };
+
+    bool parseDqt(const uint8_t* p, size_t len);
+    bool parseDht(const uint8_t* p, size_t len);
+    JpegDcError parseSof(const uint8_t* p, size_t len);
+    JpegDcError parseSos(const uint8_t* p, size_t len);
+    JpegDcError decodeScan(const uint8_t* p, const uint8_t* end, uint8_t* luma, size_t capacity);
+
+    // Bit reader over entropy-coded data (byte stuffing aware, stops at markers)
+    void resetBits(const uint8_t* p, const uint8_t* end);
+    void fillBits();
+    int decodeHuffman(const HuffTable& table);
+    int receiveExtend(int bits);
+    void skipBits(int bits);
+    bool restart();
+
+    HuffTable _dcTables[2];
+    HuffTable _acTables[2];
+    uint16_t _dcQuant[4];              // DC quantizer of each DQT table
+    Component _components[kMaxComponents];
+    uint8_t _componentCount;
+    uint8_t _scanOrder[kMaxComponents];
+    uint8_t _scanCount;
+    uint16_t _restartInterval;
+    uint16_t _width;
+    uint16_t _height;
+    uint16_t _widthBlocks;
+    uint16_t _heightBlocks;
+
+    const uint8_t* _bitPtr;
+    const uint8_t* _bitEnd;
+    uint32_t _bitBuf;
+    int _bitCount;
+    int _padBits;                      // zero bits appended past the end of the data
+};
+
+#endif // JPEG_DC_DECODER_H
@@ -0,0 +1,179 @@
+/**
+ * `MotionGate.cpp`
+ * - Motion scoring and upload gating implementation
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#include "MotionGate.h"
+
+#include <string.h>
+
+// ========================================
+// Constructor / Destructor
+// ========================================
+MotionGate::MotionGate(const MotionGateConfig& config)
+    : _config(config), _decoder(), _thumbnail(NULL), _background(NULL), _widthBlocks(0),
+      _heightBlocks(0), _hasBackground(false), _hasMotion(false), _lastMotionMs(0), _lastSentMs(0),
+      _stats(), _mutex() {
+    // Allocated once: nothing is allocated per frame
+    _thumbnail = new uint8_t[_config.maxBlocks];
+    _background = new uint16_t[_config.maxBlocks];
+}
+
+MotionGate::~MotionGate() {
+    delete[] _thumbnail;
+    delete[] _background;
+}
+
+void MotionGate::reset() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _hasBackground = false;
+    _hasMotion = false;
+}
+
+void MotionGate::reserve(size_t maxBlocks) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (maxBlocks > _config.maxBlocks) {
+        delete[] _thumbnail;
+        delete[] _background;
+        _thumbnail = new uint8_t[maxBlocks];
+        _background = new uint16_t[maxBlocks];
+        _config.maxBlocks = maxBlocks;
+    }
+    _hasBackground = false;
+    _hasMotion = false;
+}
+
+void MotionGate::setEnabled(bool enabled) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _config.enabled = enabled;
+}
+
+// ========================================
+// Evaluation
+// ========================================
+MotionResult MotionGate::evaluate(const uint8_t* jpeg, size_t length, uint32_t nowMs) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stats.frames++;
+
+    JpegDcError err = _decoder.decode(jpeg, length, _thumbnail, _config.maxBlocks);
+    if (err != JpegDcError::None) {
+        // Fail open: an unreadable frame is still uploaded
+        _stats.decodeErrors++;
+        _stats.passed++;
+        _lastSentMs = nowMs;
+        MotionResult result = {0, false, false, true};
+        return result;
+    }
+    return score(_thumbnail, _decoder.getWidthBlocks(), _decoder.getHeightBlocks(), nowMs);
+}
+
+MotionResult MotionGate::evaluateThumbnail(const uint8_t* luma, uint16_t widthBlocks, uint16_t heightBlocks,
+                                           uint32_t nowMs) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stats.frames++;
+    if ((size_t)widthBlocks * heightBlocks > _config.maxBlocks) {
+        _stats.decodeErrors++;
+        _stats.passed++;
+        _lastSentMs = nowMs;
+        MotionResult result = {0, false, false, true};
+        return result;
+    }
+    return score(luma, widthBlocks, heightBlocks, nowMs);
+}
+
+MotionResult MotionGate::score(const uint8_t* luma, uint16_t widthBlocks, uint16_t heightBlocks, uint32_t nowMs) {
+    size_t count = (size_t)widthBlocks * heightBlocks;
+    MotionResult result = {0, true, false, true};
+
+    // First frame or new resolution: start a new background, always send
+    if (!_hasBackground || widthBlocks != _widthBlocks || heightBlocks != _heightBlocks || count == 0) {
+        for (size_t i = 0; i < count; i++) {
+            _background[i] = (uint16_t)(luma[i] << 8);
+        }
+        _widthBlocks = widthBlocks;
+        _heightBlocks = heightBlocks;
+        _stats.widthBlocks = widthBlocks;
+        _stats.heightBlocks = heightBlocks;
+        _hasBackground = count > 0;
+        _hasMotion = false;
+        _stats.passed++;
+        _stats.lastScore = 0;
+        _lastSentMs = nowMs;
+        return result;
+    }
+
+    // Global brightness shift (auto exposure, lights) is not motion
+    int64_t sumDiff = 0;
+    for (size_t i = 0; i < count; i++) {
+        sumDiff += (int32_t)(luma[i] << 8) - _background[i];
+    }
+    int32_t offset = (int32_t)(sumDiff / (int64_t)count);
+
+    int32_t threshold = (int32_t)_config.blockThreshold << 8;
+    uint32_t changed = 0;
+    for (size_t i = 0; i < count; i++) {
+        int32_t sample = (int32_t)(luma[i] << 8);
+        int32_t diff = sample - _background[i] - offset;
+        if (diff > threshold || diff < -threshold) {
+            changed++;
+        }
+        // Running average: objects that stop moving fade into the background
+        _background[i] = (uint16_t)(_background[i] + ((sample - _background[i]) >> _config.backgroundShift));
+    }
+
+    result.score = (uint16_t)(changed * 1000 / count);
+    result.motion = result.score >= _config.motionPermille;
+    return decide(result, nowMs);
+}
+
+MotionResult MotionGate::decide(MotionResult result, uint32_t nowMs) {
+    _stats.lastScore = result.score;
+    if (result.score > _stats.peakScore) {
+        _stats.peakScore = result.score;
+    }
+    if (result.motion) {
+        _stats.motionFrames++;
+        _hasMotion = true;
+        _lastMotionMs = nowMs;
+    }
+
+    bool holding = _hasMotion && nowMs - _lastMotionMs < _config.holdMs;
+    if (!_config.enabled || result.motion || holding) {
+        result.send = true;
+    } else if (_config.keepAliveMs != 0 && nowMs - _lastSentMs >= _config.keepAliveMs) {
+        result.send = true;
+        _stats.keepAlives++;
+    } else {
+        result.send = false;
+    }
+
+    if (result.send) {
+        _stats.passed++;
+        _lastSentMs = nowMs;
+    } else {
+        _stats.gated++;
+    }
+    return result;
+}
+
+// ========================================
+// Statistics
+// ========================================
+MotionGateStats MotionGate::getStats() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _stats;
+}
+
+void MotionGate::resetStats() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    uint16_t widthBlocks = _stats.widthBlocks;
+    uint16_t heightBlocks = _stats.heightBlocks;
+    memset(&_stats, 0, sizeof(_stats));
+    _stats.widthBlocks = widthBlocks;
+    _stats.heightBlocks = heightBlocks;
+}
@@ -0,0 +1,137 @@
+/**
+ * `MotionGate.h`
+ * - On-device motion scoring and upload gating from JPEG DC thumbnails
+ * - Compares each frame's 1/8-scale luminance (JpegDcDecoder) with a running
+ *   background model and decides whether the frame is worth uploading:
+ *   full rate while there is motion, a slow keep-alive rate while the scene is static
+ * - Platform independent: time is passed in, buffers are allocated once in the constructor
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#ifndef MOTION_GATE_H
+#define MOTION_GATE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <mutex>
+
+#include "JpegDcDecoder.h"
+
+/**
+ * Motion gate configuration
+ */
+struct MotionGateConfig {
+    bool enabled = true;                 // false: score frames but never gate them
+    size_t maxBlocks = 80 * 60;          // largest thumbnail (VGA = 80 × 60 blocks)
+    uint8_t blockThreshold = 10;         // |block - background| above this counts as changed
+    uint16_t motionPermille = 15;        // changed blocks (‰) at or above this = motion
+    uint8_t backgroundShift = 4;         // background learning rate = 1 / 2^shift per frame
+    uint32_t holdMs = 2000;              // keep full rate this long after the last motion
+    uint32_t keepAliveMs = 5000;         // upload interval while idle (0 = drop all idle frames)
+};
+
+/**
+ * Gate decision for one frame
+ */
+struct MotionResult {
+    uint16_t score;            // changed blocks in permille (0-1000)
+    bool decoded;              // false if the JPEG could not be parsed (frame is sent)
+    bool motion;               // score >= motionPermille
+    bool send;                 // upload this frame
+};
+
+/**
+ * Motion gate counters snapshot
+ */
+struct MotionGateStats {
+    uint32_t frames;           // frames evaluated
+    uint32_t decodeErrors;     // frames whose DC thumbnail could not be decoded
+    uint32_t motionFrames;     // frames scored as motion
+    uint32_t passed;           // frames allowed through
+    uint32_t keepAlives;       // idle frames passed by the keep-alive timer
+    uint32_t gated;            // idle frames held back
+    uint16_t lastScore;        // score of the last frame
+    uint16_t peakScore;        // highest score since the last reset
+    uint16_t widthBlocks;      // current thumbnail size
+    uint16_t heightBlocks;
+};
+
+/**
+ * Motion scorer + upload gate
+ */
+class MotionGate {
+public:
+    /**
+     * Constructor
+     * @param config Thresholds and timers
+     */
+    explicit MotionGate(const MotionGateConfig& config);
+    ~MotionGate();
+
+    MotionGate(const MotionGate&) = delete;
+    MotionGate& operator=(const MotionGate&) = delete;
+
+    /**
+     * Score one JPEG frame and decide whether to upload it
+     * - A frame size change (e.g. ABR switch) restarts the background model
+     * @param jpeg JPEG bytes (fb->buf)
+     * @param length JPEG length (fb->len)
+     * @param nowMs Current time
+     */
+    MotionResult evaluate(const uint8_t* jpeg, size_t length, uint32_t nowMs);
+
+    /**
+     * Score an already decoded thumbnail (same rules as evaluate())
+     */
+    MotionResult evaluateThumbnail(const uint8_t* luma, uint16_t widthBlocks, uint16_t heightBlocks,
+                                   uint32_t nowMs);
+
+    /**
+     * Forget the background model (next frame is always sent)
+     */
+    void reset();
+
+    /**
+     * Grow the thumbnail buffers for a larger frame size (e.g. a new stream profile)
+     * - Allocates only when maxBlocks grows; the background model restarts
+     */
+    void reserve(size_t maxBlocks);
+
+    /**
+     * Enable/disable gating at runtime (scoring continues)
+     */
+    void setEnabled(bool enabled);
+
+    /**
+     * Last decoded thumbnail (widthBlocks × heightBlocks, valid until the next evaluate())
+     */
+    const uint8_t* getThumbnail() const { return _thumbnail; }
+
+    MotionGateStats getStats() const;
+    void resetStats();
+    const MotionGateConfig& getConfig() const { return _config; }
+
+private:
+    MotionResult score(const uint8_t* luma, uint16_t widthBlocks, uint16_t heightBlocks, uint32_t nowMs);
+    MotionResult decide(MotionResult result, uint32_t nowMs);
+
+    MotionGateConfig _config;
+    JpegDcDecoder _decoder;
+    uint8_t* _thumbnail;
+    uint16_t* _background;           // 8.8 fixed point luminance per block
+    uint16_t _widthBlocks;
+    uint16_t _heightBlocks;
+    bool _hasBackground;
+    bool _hasMotion;
+    uint32_t _lastMotionMs;
+    uint32_t _lastSentMs;
+    MotionGateStats _stats;
+    mutable std::mutex _mutex;
+};
+
+#endif // MOTION_GATE_H
@@ -0,0 +1,387 @@
+/**
+ * `RtpJpegDepacketizer.cpp`
+ * - RTP/JPEG reassembly, parity repair and JFIF header rebuild
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#include "RtpJpegDepacketizer.h"
+
+#include <string.h>
+
+#include "RtpJpegTables.h"
+
+static uint16_t read16(const uint8_t* p) {
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+static uint32_t read32(const uint8_t* p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+/**
+ * Fields of a media packet behind its RTP header
+ */
+struct MediaFields {
+    uint32_t offset;
+    uint8_t type;
+    uint8_t q;
+    uint8_t width8;
+    uint8_t height8;
+    uint16_t restartInterval;
+    const uint8_t* quant;      // in-band tables (offset 0, Q >= 128), else NULL
+    const uint8_t* payload;
+    size_t payloadLength;
+};
+
+static bool parseMedia(const uint8_t* body, size_t length, MediaFields& fields) {
+    if (length < kRtpJpegHeaderSize) {
+        return false;
+    }
+    fields.offset = ((uint32_t)body[1] << 16) | ((uint32_t)body[2] << 8) | body[3];
+    fields.type = body[4];
+    fields.q = body[5];
+    fields.width8 = body[6];
+    fields.height8 = body[7];
+    fields.restartInterval = 0;
+    fields.quant = NULL;
+    size_t header = kRtpJpegHeaderSize;
+    if (fields.type & 64) {
+        if (length < header + kRtpRestartHeaderSize) {
+            return false;
+        }
+        fields.restartInterval = read16(body + header);
+        header += kRtpRestartHeaderSize;
+    }
+    if (fields.offset == 0 && fields.q >= 128) {
+        if (length < header + kRtpQuantHeaderSize) {
+            return false;
+        }
+        size_t tablesLength = read16(body + header + 2);
+        if (body[header + 1] == 0 && tablesLength >= kRtpQuantTablesSize) {
+            fields.quant = body + header + kRtpQuantHeaderSize;
+        }
+        header += kRtpQuantHeaderSize + tablesLength;
+        if (length < header) {
+            return false;
+        }
+    }
+    fields.payload = body + header;
+    fields.payloadLength = length - header;
+    return true;
+}
+
+// ========================================
+// Constructor / Destructor
+// ========================================
+RtpJpegDepacketizer::RtpJpegDepacketizer(uint8_t* buffer, size_t capacity, const RtpJpegReceiverConfig& config)
+    : _buffer(buffer), _capacity(capacity), _config(config), _slots(NULL), _slotInfo(NULL), _slotCount(0),
+      _active(false), _delivered(false), _timestamp(0), _received(0), _scanLength(0), _markerSeen(false),
+      _frameLength(0), _stats() {
+    // Allocated once: nothing is allocated per packet
+    _slots = new uint8_t[_config.maxPackets * _config.maxPacketSize];
+    _slotInfo = new Slot[_config.maxPackets];
+}
+
+RtpJpegDepacketizer::~RtpJpegDepacketizer() {
+    delete[] _slots;
+    delete[] _slotInfo;
+}
+
+void RtpJpegDepacketizer::reset() {
+    _active = false;
+    _slotCount = 0;
+}
+
+// ========================================
+// Packet Intake
+// ========================================
+RtpReceiveResult RtpJpegDepacketizer::accept(const uint8_t* packet, size_t length) {
+    if (packet == NULL || length < kRtpHeaderSize || (packet[0] >> 6) != 2) {
+        _stats.dropped++;
+        return RtpReceiveResult::Dropped;
+    }
+    size_t header = kRtpHeaderSize + 4 * (packet[0] & 0x0F);
+    if ((packet[0] & 0x10) && length >= header + 4) {
+        header += 4 + 4 * (size_t)read16(packet + header + 2);  // extension
+    }
+    if ((packet[0] & 0x20) && length > header) {
+        length -= packet[length - 1] < length - header ? packet[length - 1] : 0;  // padding
+    }
+    uint8_t payloadType = packet[1] & 0x7F;
+    bool parity = payloadType == _config.fecPayloadType;
+    if (header > length || (payloadType != kRtpPayloadJpeg && !parity)) {
+        _stats.dropped++;
+        return RtpReceiveResult::Dropped;
+    }
+    bool marker = (packet[1] & 0x80) != 0;
+    uint16_t sequence = read16(packet + 2);
+    uint32_t timestamp = read32(packet + 4);
+
+    if (!_active || timestamp != _timestamp) {
+        if (_active && (int32_t)(timestamp - _timestamp) < 0) {
+            _stats.dropped++;  // late packet of an older frame
+            return RtpReceiveResult::Dropped;
+        }
+        if (_active && !_delivered) {
+            _stats.lostFrames++;
+        }
+        startFrame(timestamp);
+    }
+    if (_delivered) {
+        return RtpReceiveResult::Pending;  // parity behind a frame that needed no repair
+    }
+    if (findSequence(sequence) >= 0) {
+        _stats.duplicates++;
+        return RtpReceiveResult::Pending;
+    }
+
+    const uint8_t* body = packet + header;
+    size_t bodyLength = length - header;
+    if (_slotCount >= _config.maxPackets || bodyLength > _config.maxPacketSize ||
+        (parity && bodyLength < kRtpFecHeaderSize)) {
+        _stats.dropped++;
+        return RtpReceiveResult::Dropped;
+    }
+    size_t index = _slotCount;
+    memcpy(slotData(index), body, bodyLength);
+    _slotInfo[index] = Slot{sequence, (uint16_t)bodyLength, parity, marker};
+
+    if (parity) {
+        _slotCount++;
+        _stats.parityPackets++;
+        tryRepair(index);
+    } else {
+        if (!storeMedia(index)) {
+            _stats.dropped++;
+            return RtpReceiveResult::Dropped;
+        }
+        _stats.packets++;
+        for (size_t i = 0; i < _slotCount; i++) {
+            const uint8_t* fec = slotData(i);
+            if (_slotInfo[i].parity && (uint16_t)(sequence - read16(fec)) < fec[2]) {
+                tryRepair(i);
+                break;
+            }
+        }
+    }
+
+    if (!isComplete()) {
+        return RtpReceiveResult::Pending;
+    }
+    _delivered = true;
+    if (!build()) {
+        _stats.lostFrames++;
+        _stats.dropped++;
+        return RtpReceiveResult::Dropped;
+    }
+    _stats.frames++;
+    return RtpReceiveResult::Complete;
+}
+
+void RtpJpegDepacketizer::startFrame(uint32_t timestamp) {
+    _active = true;
+    _delivered = false;
+    _timestamp = timestamp;
+    _slotCount = 0;
+    _received = 0;
+    _scanLength = 0;
+    _markerSeen = false;
+}
+
+int RtpJpegDepacketizer::findSequence(uint16_t sequence) const {
+    for (size_t i = 0; i < _slotCount; i++) {
+        if (_slotInfo[i].sequence == sequence) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+bool RtpJpegDepacketizer::storeMedia(size_t index) {
+    MediaFields fields;
+    if (!parseMedia(slotData(index), _slotInfo[index].length, fields)) {
+        return false;
+    }
+    _slotCount = index + 1;
+    _received += fields.payloadLength;
+    if (_slotInfo[index].marker) {
+        _markerSeen = true;
+        _scanLength = fields.offset + fields.payloadLength;
+    }
+    return true;
+}
+
+// ========================================
+// Parity Repair
+// ========================================
+void RtpJpegDepacketizer::tryRepair(size_t paritySlot) {
+    const uint8_t* fec = slotData(paritySlot);
+    uint16_t base = read16(fec);
+    uint8_t count = fec[2];
+    uint16_t missing = 0;
+    int missingCount = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        uint16_t sequence = (uint16_t)(base + i);
+        if (findSequence(sequence) < 0) {
+            missing = sequence;
+            missingCount++;
+        }
+    }
+    if (missingCount != 1 || _slotCount >= _config.maxPackets) {
+        return;  // nothing to do, or more losses than one parity can repair
+    }
+
+    // XOR of the parity with every other member gives the missing protected bytes
+    size_t parityLength = _slotInfo[paritySlot].length - kRtpFecHeaderSize;
+    uint16_t length = read16(fec + 4);
+    uint8_t marker = fec[3];
+    for (uint8_t i = 0; i < count; i++) {
+        int member = findSequence((uint16_t)(base + i));
+        if (member >= 0) {
+            length ^= _slotInfo[member].length;
+            marker ^= _slotInfo[member].marker ? 1 : 0;
+        }
+    }
+    if (length > parityLength || length > _config.maxPacketSize) {
+        return;  // inconsistent group (parity of another stream)
+    }
+    size_t index = _slotCount;
+    uint8_t* out = slotData(index);
+    memcpy(out, fec + kRtpFecHeaderSize, length);
+    for (uint8_t i = 0; i < count; i++) {
+        int member = findSequence((uint16_t)(base + i));
+        if (member < 0) {
+            continue;
+        }
+        const uint8_t* data = slotData((size_t)member);
+        size_t memberLength = _slotInfo[member].length < length ? _slotInfo[member].length : length;
+        for (size_t j = 0; j < memberLength; j++) {
+            out[j] ^= data[j];
+        }
+    }
+    _slotInfo[index] = Slot{missing, length, false, marker != 0};
+    if (storeMedia(index)) {
+        _stats.recovered++;
+    }
+}
+
+// ========================================
+// JPEG Rebuild
+// ========================================
+bool RtpJpegDepacketizer::isComplete() const {
+    return _markerSeen && _received == _scanLength;
+}
+
+bool RtpJpegDepacketizer::build() {
+    MediaFields first;
+    bool found = false;
+    for (size_t i = 0; i < _slotCount && !found; i++) {
+        found = !_slotInfo[i].parity && parseMedia(slotData(i), _slotInfo[i].length, first) &&
+                first.offset == 0;
+    }
+    if (!found || (first.type & ~64) > 1) {
+        return false;
+    }
+    uint8_t tables[kRtpQuantTablesSize];
+    if (first.q >= 128) {
+        if (first.quant == NULL) {
+            return false;  // tables announced in an earlier frame: not kept
+        }
+        memcpy(tables, first.quant, kRtpQuantTablesSize);
+    } else {
+        rtpJpegMakeTables(first.q, tables);
+    }
+
+    size_t headerLength = writeHeaders(first.type, (uint16_t)(first.width8 * 8), (uint16_t)(first.height8 * 8),
+                                       first.restartInterval, tables, _buffer, _capacity);
+    if (headerLength == 0 || headerLength + _scanLength + 2 > _capacity) {
+        return false;
+    }
+    for (size_t i = 0; i < _slotCount; i++) {
+        MediaFields fields;
+        if (_slotInfo[i].parity || !parseMedia(slotData(i), _slotInfo[i].length, fields)) {
+            continue;
+        }
+        if (fields.offset + fields.payloadLength > _scanLength) {
+            return false;
+        }
+        memcpy(_buffer + headerLength + fields.offset, fields.payload, fields.payloadLength);
+    }
+    _buffer[headerLength + _scanLength] = 0xFF;
+    _buffer[headerLength + _scanLength + 1] = 0xD9;
+    _frameLength = headerLength + _scanLength + 2;
+    return true;
+}
+
+size_t RtpJpegDepacketizer::writeHeaders(uint8_t type, uint16_t width, uint16_t height, uint16_t restartInterval,
+                                         const uint8_t* quant, uint8_t* out, size_t capacity) {
+    size_t needed = 2 + (4 + 2 * 65) + (restartInterval ? 6 : 0) + 19 + 14;
+    for (const RtpHuffmanTable& table : kRtpStandardHuffman) {
+        needed += 4 + 1 + 16 + table.valueCount;
+    }
+    if (out == NULL || capacity < needed) {
+        return 0;
+    }
+    uint8_t* p = out;
+    auto put8 = [&](uint8_t value) { *p++ = value; };
+    auto put16 = [&](uint16_t value) {
+        *p++ = (uint8_t)(value >> 8);
+        *p++ = (uint8_t)value;
+    };
+
+    put16(0xFFD8);
+    put16(0xFFDB);
+    put16(2 + 2 * 65);
+    put8(0x00);
+    memcpy(p, quant, 64);
+    p += 64;
+    put8(0x01);
+    memcpy(p, quant + 64, 64);
+    p += 64;
+    if (restartInterval) {
+        put16(0xFFDD);
+        put16(4);
+        put16(restartInterval);
+    }
+    put16(0xFFC0);
+    put16(17);
+    put8(8);
+    put16(height);
+    put16(width);
+    put8(3);
+    put8(1);
+    put8((type & 1) ? 0x22 : 0x21);
+    put8(0);
+    put8(2);
+    put8(0x11);
+    put8(1);
+    put8(3);
+    put8(0x11);
+    put8(1);
+    for (const RtpHuffmanTable& table : kRtpStandardHuffman) {
+        put16(0xFFC4);
+        put16((uint16_t)(2 + 1 + 16 + table.valueCount));
+        put8((uint8_t)((table.tableClass << 4) | table.tableId));
+        memcpy(p, table.bits, 16);
+        p += 16;
+        memcpy(p, table.values, table.valueCount);
+        p += table.valueCount;
+    }
+    put16(0xFFDA);
+    put16(12);
+    put8(3);
+    put8(1);
+    put8(0x00);
+    put8(2);
+    put8(0x11);
+    put8(3);
+    put8(0x11);
+    put8(0);
+    put8(63);
+    put8(0);
+    return (size_t)(p - out);
+}
@@ -0,0 +1,130 @@
+/**
+ * `RtpJpegDepacketizer.h`
+ * - Receiver side of the RTP/JPEG transport (relay, stand-in tools, tests): reassembles the
+ *   scan from fragments in any order, repairs single losses per parity group and rebuilds
+ *   a complete JFIF image (RFC 2435 Appendix B headers + standard Huffman tables)
+ * - One frame in flight: a packet with a newer timestamp abandons an incomplete frame, so a
+ *   loss costs that frame only and the next frame decodes normally
+ * - A frame is handed out as soon as its scan is complete; parity arriving later is ignored
+ * - Packets are kept in fixed slots allocated once (maxPackets × maxPacketSize)
+ * - Platform independent, not thread-safe
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#ifndef RTP_JPEG_DEPACKETIZER_H
+#define RTP_JPEG_DEPACKETIZER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "RtpJpegPacketizer.h"
+
+/**
+ * Receiver configuration
+ */
+struct RtpJpegReceiverConfig {
+    size_t maxPacketSize = 1500;       // largest datagram accepted
+    size_t maxPackets = 256;           // media + parity packets of one frame
+    uint8_t fecPayloadType = 127;
+};
+
+/**
+ * Result of feeding one packet to the receiver
+ */
+enum class RtpReceiveResult : uint8_t {
+    Pending,       // packet kept, frame not complete yet (or frame already delivered)
+    Complete,      // frame() holds the rebuilt JPEG
+    Dropped        // malformed, foreign payload type, late (older frame) or no free slot
+};
+
+/**
+ * Receiver counters
+ */
+struct RtpJpegReceiverStats {
+    uint32_t frames;           // JPEGs rebuilt
+    uint32_t lostFrames;       // frames abandoned incomplete
+    uint32_t packets;          // media packets accepted
+    uint32_t parityPackets;    // parity packets accepted
+    uint32_t recovered;        // media packets rebuilt from parity
+    uint32_t duplicates;
+    uint32_t dropped;
+};
+
+/**
+ * RTP/JPEG receiver with parity repair
+ */
+class RtpJpegDepacketizer {
+public:
+    /**
+     * Constructor
+     * @param buffer Caller-owned output buffer (largest rebuilt JPEG: scan + ~700 header bytes)
+     */
+    RtpJpegDepacketizer(uint8_t* buffer, size_t capacity, const RtpJpegReceiverConfig& config);
+    ~RtpJpegDepacketizer();
+
+    RtpJpegDepacketizer(const RtpJpegDepacketizer&) = delete;
+    RtpJpegDepacketizer& operator=(const RtpJpegDepacketizer&) = delete;
+
+    RtpReceiveResult accept(const uint8_t* packet, size_t length);
+
+    /**
+     * Rebuilt JPEG (valid until the next accept)
+     */
+    const uint8_t* frame() const { return _buffer; }
+    size_t frameLength() const { return _frameLength; }
+    uint32_t frameTimestamp() const { return _timestamp; }
+
+    /**
+     * Forget the frame in flight (stream restarted)
+     */
+    void reset();
+
+    RtpJpegReceiverStats getStats() const { return _stats; }
+
+    /**
+     * Write SOI + DQT + DRI + SOF0 + DHT + SOS for an RTP/JPEG frame
+     * @return Header length (0 if `out` is too small)
+     */
+    static size_t writeHeaders(uint8_t type, uint16_t width, uint16_t height, uint16_t restartInterval,
+                               const uint8_t* quant, uint8_t* out, size_t capacity);
+
+private:
+    /**
+     * Stored packet (media or parity)
+     */
+    struct Slot {
+        uint16_t sequence;
+        uint16_t length;       // bytes behind the RTP header
+        bool parity;
+        bool marker;
+    };
+
+    uint8_t* slotData(size_t index) { return _slots + index * _config.maxPacketSize; }
+    int findSequence(uint16_t sequence) const;
+    void startFrame(uint32_t timestamp);
+    bool storeMedia(size_t index);
+    void tryRepair(size_t paritySlot);
+    bool isComplete() const;
+    bool build();
+
+    uint8_t* _buffer;
+    size_t _capacity;
+    RtpJpegReceiverConfig _config;
+    uint8_t* _slots;           // maxPackets × maxPacketSize
+    Slot* _slotInfo;
+    size_t _slotCount;
+    bool _active;
+    bool _delivered;
+    uint32_t _timestamp;
+    size_t _received;          // scan bytes held
+    size_t _scanLength;        // known once the marker packet is held
+    bool _markerSeen;
+    size_t _frameLength;
+    RtpJpegReceiverStats _stats;
+};
+
+#endif // RTP_JPEG_DEPACKETIZER_H
@@ -0,0 +1,365 @@
+/**
+ * `RtpJpegPacketizer.cpp`
+ * - RTP/JPEG packetizer and parity FEC implementation
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#include "RtpJpegPacketizer.h"
+
+#include <string.h>
+
+#include "RtpJpegTables.h"
+
+static constexpr size_t kMinMtu = 256;
+static constexpr uint16_t kMaxDimension = 2040;   // 8-bit width/height fields in 8-pixel units
+
+static uint16_t read16(const uint8_t* p) {
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+static void write16(uint8_t* p, uint16_t value) {
+    p[0] = (uint8_t)(value >> 8);
+    p[1] = (uint8_t)value;
+}
+
+static void write32(uint8_t* p, uint32_t value) {
+    p[0] = (uint8_t)(value >> 24);
+    p[1] = (uint8_t)(value >> 16);
+    p[2] = (uint8_t)(value >> 8);
+    p[3] = (uint8_t)value;
+}
+
+/**
+ * Check one DHT table against the standard table of its class and slot
+ */
+static bool isStandardHuffman(uint8_t tableClass, uint8_t tableId, const uint8_t* bits, const uint8_t* values,
+                              size_t count) {
+    for (const RtpHuffmanTable& table : kRtpStandardHuffman) {
+        if (table.tableClass == tableClass && table.tableId == tableId) {
+            return count == table.valueCount && memcmp(bits, table.bits, 16) == 0 &&
+                   memcmp(values, table.values, count) == 0;
+        }
+    }
+    return false;
+}
+
+// ========================================
+// Constructor / Destructor
+// ========================================
+RtpJpegPacketizer::RtpJpegPacketizer(const RtpJpegConfig& config)
+    : _config(config), _packet(NULL), _parity(NULL), _scan(), _active(false), _offset(0), _timestamp(0),
+      _sequence(config.firstSequence), _groupBase(0), _groupCount(0), _groupMarker(0), _groupLength(0),
+      _groupMax(0), _parityPending(false), _stats() {
+    if (_config.mtu < kMinMtu) {
+        _config.mtu = kMinMtu;
+    }
+    // Allocated once: nothing is allocated per frame
+    _packet = new uint8_t[_config.mtu];
+    _parity = new uint8_t[_config.mtu];
+    memset(_parity, 0, _config.mtu);
+}
+
+RtpJpegPacketizer::~RtpJpegPacketizer() {
+    delete[] _packet;
+    delete[] _parity;
+}
+
+void RtpJpegPacketizer::resetStats() {
+    _stats = RtpJpegStats();
+}
+
+// ========================================
+// JPEG Parsing
+// ========================================
+RtpJpegError RtpJpegPacketizer::parse(const uint8_t* jpeg, size_t length, RtpJpegScan& scan) {
+    if (jpeg == NULL || length < 4 || jpeg[0] != 0xFF || jpeg[1] != 0xD8) {
+        return RtpJpegError::BadMarker;
+    }
+    uint8_t quant[4][64];
+    bool quantPresent[4] = {false, false, false, false};
+    uint8_t lumaTable = 0xFF;
+    uint8_t chromaTable = 0xFF;
+    bool frameSeen = false;
+    scan = RtpJpegScan();
+
+    size_t pos = 2;
+    while (pos + 4 <= length) {
+        if (jpeg[pos] != 0xFF) {
+            return RtpJpegError::BadMarker;
+        }
+        uint8_t marker = jpeg[pos + 1];
+        if (marker == 0xFF) {
+            pos++;  // fill byte
+            continue;
+        }
+        if (marker == 0x01 || (marker >= 0xD0 && marker <= 0xD7)) {
+            pos += 2;  // standalone
+            continue;
+        }
+        size_t segment = read16(jpeg + pos + 2);
+        if (segment < 2 || pos + 2 + segment > length) {
+            return RtpJpegError::BadMarker;
+        }
+        const uint8_t* body = jpeg + pos + 4;
+        size_t bodyLength = segment - 2;
+
+        switch (marker) {
+        case 0xC0:
+        case 0xC1: {
+            // 8-bit YCbCr: Y 2x1 (4:2:2) or 2x2 (4:2:0), Cb/Cr 1x1 sharing one table
+            if (bodyLength < 15 || body[0] != 8 || body[5] != 3) {
+                return RtpJpegError::Unsupported;
+            }
+            scan.height = read16(body + 1);
+            scan.width = read16(body + 3);
+            uint8_t lumaSampling = body[7];
+            if (lumaSampling == 0x21) {
+                scan.type = 0;
+            } else if (lumaSampling == 0x22) {
+                scan.type = 1;
+            } else {
+                return RtpJpegError::Unsupported;
+            }
+            lumaTable = body[8];
+            chromaTable = body[11];
+            if (body[10] != 0x11 || body[13] != 0x11 || body[14] != chromaTable || lumaTable > 3 ||
+                chromaTable > 3) {
+                return RtpJpegError::Unsupported;
+            }
+            frameSeen = true;
+            break;
+        }
+        case 0xC4: {
+            size_t p = 0;
+            while (p + 17 <= bodyLength) {
+                uint8_t tableClass = body[p] >> 4;
+                uint8_t tableId = body[p] & 0x0F;
+                size_t count = 0;
+                for (int i = 0; i < 16; i++) {
+                    count += body[p + 1 + i];
+                }
+                if (p + 17 + count > bodyLength) {
+                    return RtpJpegError::BadMarker;
+                }
+                if (!isStandardHuffman(tableClass, tableId, body + p + 1, body + p + 17, count)) {
+                    return RtpJpegError::Unsupported;
+                }
+                p += 17 + count;
+            }
+            break;
+        }
+        case 0xDB: {
+            size_t p = 0;
+            while (p + 65 <= bodyLength) {
+                uint8_t precision = body[p] >> 4;
+                uint8_t tableId = body[p] & 0x0F;
+                if (precision != 0 || tableId > 3) {
+                    return RtpJpegError::Unsupported;
+                }
+                memcpy(quant[tableId], body + p + 1, 64);
+                quantPresent[tableId] = true;
+                p += 65;
+            }
+            break;
+        }
+        case 0xDD:
+            if (bodyLength < 2) {
+                return RtpJpegError::BadMarker;
+            }
+            scan.restartInterval = read16(body);
+            break;
+        case 0xDA: {
+            // One interleaved scan, luma on Huffman slot 0, chroma on slot 1
+            if (!frameSeen || bodyLength < 10 || body[0] != 3 || body[2] != 0x00 || body[4] != 0x11 ||
+                body[6] != 0x11 || body[7] != 0 || body[8] != 63 || body[9] != 0) {
+                return RtpJpegError::Unsupported;
+            }
+            if (!quantPresent[lumaTable] || !quantPresent[chromaTable]) {
+                return RtpJpegError::BadMarker;
+            }
+            if (scan.width > kMaxDimension || scan.height > kMaxDimension) {
+                return RtpJpegError::TooLarge;
+            }
+            if (scan.width == 0 || scan.height == 0 || scan.width % 8 != 0 || scan.height % 8 != 0) {
+                return RtpJpegError::Unsupported;
+            }
+            // Scan runs to the last EOI (the driver may leave padding behind it)
+            size_t start = pos + 2 + segment;
+            size_t end = length;
+            while (end >= start + 2 && !(jpeg[end - 2] == 0xFF && jpeg[end - 1] == 0xD9)) {
+                end--;
+            }
+            if (end < start + 2) {
+                return RtpJpegError::BadMarker;
+            }
+            memcpy(scan.quant, quant[lumaTable], 64);
+            memcpy(scan.quant + 64, quant[chromaTable], 64);
+            if (scan.restartInterval != 0) {
+                scan.type |= 64;
+            }
+            scan.data = jpeg + start;
+            scan.length = end - 2 - start;
+            return RtpJpegError::None;
+        }
+        default:
+            if ((marker >= 0xC2 && marker <= 0xCF) && marker != 0xC4 && marker != 0xC8 && marker != 0xCC) {
+                return RtpJpegError::Unsupported;  // progressive, lossless, arithmetic
+            }
+            break;  // APPn, COM
+        }
+        pos += 2 + segment;
+    }
+    return RtpJpegError::BadMarker;
+}
+
+// ========================================
+// Packetizing
+// ========================================
+size_t RtpJpegPacketizer::payloadSize(bool first, bool restart) const {
+    return _config.mtu - kRtpHeaderSize - (_config.fecGroup > 0 ? kRtpFecHeaderSize : 0) - kRtpJpegHeaderSize -
+           (restart ? kRtpRestartHeaderSize : 0) - (first ? kRtpQuantHeaderSize + kRtpQuantTablesSize : 0);
+}
+
+size_t RtpJpegPacketizer::packetCount(size_t scanLength, bool restart) const {
+    size_t first = payloadSize(true, restart);
+    size_t rest = payloadSize(false, restart);
+    size_t media = scanLength <= first ? 1 : 1 + (scanLength - first + rest - 1) / rest;
+    size_t parity = _config.fecGroup > 0 ? (media + _config.fecGroup - 1) / _config.fecGroup : 0;
+    return media + parity;
+}
+
+RtpJpegError RtpJpegPacketizer::begin(const uint8_t* jpeg, size_t length, uint32_t timestamp) {
+    _active = false;
+    _parityPending = false;
+    RtpJpegError error = parse(jpeg, length, _scan);
+    if (error != RtpJpegError::None) {
+        _stats.rejected++;
+        return error;
+    }
+    _active = true;
+    _offset = 0;
+    _timestamp = timestamp;
+    _groupCount = 0;
+    _stats.frames++;
+    _stats.scanBytes += _scan.length;
+    return RtpJpegError::None;
+}
+
+void RtpJpegPacketizer::writeRtpHeader(uint8_t* out, uint8_t payloadType, bool marker, uint16_t sequence) {
+    out[0] = 0x80;  // version 2, no padding/extension/CSRC
+    out[1] = (uint8_t)((marker ? 0x80 : 0) | (payloadType & 0x7F));
+    write16(out + 2, sequence);
+    write32(out + 4, _timestamp);
+    write32(out + 8, _config.ssrc);
+}
+
+void RtpJpegPacketizer::accumulateParity(const uint8_t* protectedBytes, size_t length, bool marker) {
+    uint8_t* accumulator = _parity + kRtpHeaderSize + kRtpFecHeaderSize;
+    for (size_t i = 0; i < length; i++) {
+        accumulator[i] ^= protectedBytes[i];
+    }
+    _groupLength ^= (uint16_t)length;
+    _groupMarker ^= marker ? 1 : 0;
+    _groupMax = length > _groupMax ? length : _groupMax;
+}
+
+void RtpJpegPacketizer::emitParity(RtpPacket& packet) {
+    bool frameDone = _offset >= _scan.length;
+    uint16_t sequence = _sequence++;
+    writeRtpHeader(_parity, _config.fecPayloadType, false, sequence);
+    uint8_t* header = _parity + kRtpHeaderSize;
+    write16(header, _groupBase);
+    header[2] = _groupCount;
+    header[3] = _groupMarker;
+    write16(header + 4, _groupLength);
+    write16(header + 6, 0);
+
+    packet.data = _parity;
+    packet.length = kRtpHeaderSize + kRtpFecHeaderSize + _groupMax;
+    packet.sequence = sequence;
+    packet.parity = true;
+    packet.last = frameDone;
+    _stats.parityPackets++;
+    _stats.wireBytes += packet.length;
+
+    // The accumulator is cleared when the next group starts (the packet above still points at it)
+    _groupCount = 0;
+    _parityPending = false;
+    if (frameDone) {
+        _active = false;
+    }
+}
+
+bool RtpJpegPacketizer::next(RtpPacket& packet) {
+    if (_parityPending) {
+        emitParity(packet);
+        return true;
+    }
+    if (!_active) {
+        return false;
+    }
+
+    bool first = _offset == 0;
+    bool restart = (_scan.type & 64) != 0;
+    size_t chunk = _scan.length - _offset;
+    size_t room = payloadSize(first, restart);
+    chunk = chunk > room ? room : chunk;
+    bool marker = _offset + chunk >= _scan.length;
+    uint16_t sequence = _sequence++;
+
+    writeRtpHeader(_packet, kRtpPayloadJpeg, marker, sequence);
+    uint8_t* p = _packet + kRtpHeaderSize;
+    p[0] = 0;  // type-specific
+    p[1] = (uint8_t)(_offset >> 16);
+    p[2] = (uint8_t)(_offset >> 8);
+    p[3] = (uint8_t)_offset;
+    p[4] = _scan.type;
+    p[5] = 255;  // quantization tables in-band
+    p[6] = (uint8_t)(_scan.width / 8);
+    p[7] = (uint8_t)(_scan.height / 8);
+    p += kRtpJpegHeaderSize;
+    if (restart) {
+        write16(p, _scan.restartInterval);
+        write16(p + 2, 0xFFFF);  // F = L = 1, count 0x3FFF: fragments ignore restart boundaries
+        p += kRtpRestartHeaderSize;
+    }
+    if (first) {
+        p[0] = 0;
+        p[1] = 0;  // 8-bit tables
+        write16(p + 2, (uint16_t)kRtpQuantTablesSize);
+        memcpy(p + kRtpQuantHeaderSize, _scan.quant, kRtpQuantTablesSize);
+        p += kRtpQuantHeaderSize + kRtpQuantTablesSize;
+    }
+    memcpy(p, _scan.data + _offset, chunk);
+    _offset += chunk;
+
+    packet.data = _packet;
+    packet.length = (size_t)(p - _packet) + chunk;
+    packet.sequence = sequence;
+    packet.parity = false;
+    packet.last = marker && _config.fecGroup == 0;
+    _stats.mediaPackets++;
+    _stats.wireBytes += packet.length;
+
+    if (_config.fecGroup == 0) {
+        _active = !marker;
+        return true;
+    }
+    if (_groupCount == 0) {
+        memset(_parity + kRtpHeaderSize + kRtpFecHeaderSize, 0, _groupMax);
+        _groupBase = sequence;
+        _groupMarker = 0;
+        _groupLength = 0;
+        _groupMax = 0;
+    }
+    accumulateParity(_packet + kRtpHeaderSize, packet.length - kRtpHeaderSize, marker);
+    _groupCount++;
+    if (_groupCount >= _config.fecGroup || marker) {
+        _parityPending = true;
+    }
+    return true;
+}
@@ -0,0 +1,170 @@
+/**
+ * `RtpJpegPacketizer.h`
+ * - RTP/JPEG (RFC 2435) packetizer for the UDP transport: one lost packet costs at most its
+ *   frame instead of stalling every later frame behind TCP retransmits
+ * - Sends only the entropy-coded scan of fb->buf; the receiver rebuilds the JFIF headers
+ *   from the 8-byte JPEG header and the quantization tables (Q = 255, tables in-band in
+ *   the first packet of every frame)
+ * - Supported input: baseline 3-component YCbCr with the standard (Annex K) Huffman tables,
+ *   4:2:2 (type 0, the OV2640 output) or 4:2:0 (type 1), optional DRI (types 64/65)
+ * - Parity FEC per frame: after every `fecGroup` media packets (and after the last packet of
+ *   the frame) a parity packet XORs everything behind their RTP headers, so the receiver
+ *   recovers any single lost packet of a group (RtpJpegDepacketizer)
+ * - Zero copy into the caller: next() writes each packet into one internal MTU buffer
+ * - Platform independent, not thread-safe
+ *
+ * Media packet:  [RTP 12][JPEG 8][restart 4, types 64+][quant header 4 + 128, offset 0 only][scan]
+ * Parity packet: [RTP 12, payload type fecPayloadType, same timestamp][FEC 8][XOR of the
+ *                protected bytes, zero padded to the longest packet of the group]
+ *
+ * FEC header (8 bytes, big-endian):
+ *   0  sequence base (2, first media packet of the group)   2  count (1)   3  marker XOR (1)
+ *   4  protected length XOR (2)                              6  reserved (2)
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#ifndef RTP_JPEG_PACKETIZER_H
+#define RTP_JPEG_PACKETIZER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+static constexpr size_t kRtpHeaderSize = 12;
+static constexpr size_t kRtpJpegHeaderSize = 8;
+static constexpr size_t kRtpRestartHeaderSize = 4;
+static constexpr size_t kRtpQuantHeaderSize = 4;
+static constexpr size_t kRtpQuantTablesSize = 128;    // two 8-bit tables (luma, chroma)
+static constexpr size_t kRtpFecHeaderSize = 8;
+static constexpr uint8_t kRtpPayloadJpeg = 26;        // static payload type (RFC 3551)
+static constexpr uint32_t kRtpJpegClockHz = 90000;
+
+/**
+ * Packetizer configuration
+ */
+struct RtpJpegConfig {
+    size_t mtu = 1400;                 // largest datagram (RTP header included)
+    uint8_t fecGroup = 4;              // media packets per parity packet (0 = no FEC)
+    uint8_t fecPayloadType = 127;      // dynamic payload type of parity packets
+    uint32_t ssrc = 0x43414D31;        // "CAM1"
+    uint16_t firstSequence = 0;
+};
+
+/**
+ * JPEG check result
+ */
+enum class RtpJpegError : uint8_t {
+    None = 0,
+    BadMarker,         // no SOI, malformed segment or no EOI
+    Unsupported,       // not representable in RFC 2435 (progressive, grayscale, other
+                       // sampling, custom Huffman tables, 16-bit or shared-slot tables)
+    TooLarge           // width or height above 2040 pixels
+};
+
+/**
+ * What the RTP/JPEG header needs from a JPEG
+ */
+struct RtpJpegScan {
+    uint8_t type;              // 0 = 4:2:2, 1 = 4:2:0 (+64 with restart markers)
+    uint16_t width;
+    uint16_t height;
+    uint16_t restartInterval;  // 0 = none
+    uint8_t quant[kRtpQuantTablesSize];   // luma then chroma, zig-zag order as in DQT
+    const uint8_t* data;       // entropy-coded scan (after SOS, before EOI)
+    size_t length;
+};
+
+/**
+ * One packet ready to send
+ */
+struct RtpPacket {
+    const uint8_t* data;
+    size_t length;
+    uint16_t sequence;
+    bool parity;
+    bool last;                 // last packet of the frame (media marker or trailing parity)
+};
+
+/**
+ * Packetizer counters
+ */
+struct RtpJpegStats {
+    uint32_t frames;
+    uint32_t rejected;         // JPEGs begin() refused
+    uint32_t mediaPackets;
+    uint32_t parityPackets;
+    uint64_t scanBytes;        // JPEG scan bytes packetized
+    uint64_t wireBytes;        // datagram bytes, parity included
+};
+
+/**
+ * RFC 2435 packetizer with per-frame parity FEC
+ */
+class RtpJpegPacketizer {
+public:
+    explicit RtpJpegPacketizer(const RtpJpegConfig& config);
+    ~RtpJpegPacketizer();
+
+    RtpJpegPacketizer(const RtpJpegPacketizer&) = delete;
+    RtpJpegPacketizer& operator=(const RtpJpegPacketizer&) = delete;
+
+    /**
+     * Parse the JPEG fields RFC 2435 carries
+     * @return RtpJpegError::None if the JPEG can be sent as RTP/JPEG
+     */
+    static RtpJpegError parse(const uint8_t* jpeg, size_t length, RtpJpegScan& scan);
+
+    /**
+     * Start a frame
+     * @param jpeg JPEG bytes (must stay valid until the last next())
+     * @param timestamp RTP timestamp (90 kHz)
+     */
+    RtpJpegError begin(const uint8_t* jpeg, size_t length, uint32_t timestamp);
+
+    /**
+     * Next packet of the frame (valid until the next call)
+     * @return false when the frame is done
+     */
+    bool next(RtpPacket& packet);
+
+    /**
+     * Packets begin() produces for a scan of this length (media + parity)
+     */
+    size_t packetCount(size_t scanLength, bool restart) const;
+
+    /**
+     * Scan bytes per media packet (the first packet carries the quantization tables)
+     */
+    size_t payloadSize(bool first, bool restart) const;
+
+    uint16_t nextSequence() const { return _sequence; }
+    RtpJpegStats getStats() const { return _stats; }
+    void resetStats();
+
+private:
+    void writeRtpHeader(uint8_t* out, uint8_t payloadType, bool marker, uint16_t sequence);
+    void accumulateParity(const uint8_t* protectedBytes, size_t length, bool marker);
+    void emitParity(RtpPacket& packet);
+
+    RtpJpegConfig _config;
+    uint8_t* _packet;          // mtu bytes
+    uint8_t* _parity;          // mtu bytes: FEC header + XOR accumulator behind the RTP header
+    RtpJpegScan _scan;
+    bool _active;
+    size_t _offset;            // scan bytes sent
+    uint32_t _timestamp;
+    uint16_t _sequence;
+    // Parity group
+    uint16_t _groupBase;
+    uint8_t _groupCount;
+    uint8_t _groupMarker;
+    uint16_t _groupLength;     // XOR of protected lengths
+    size_t _groupMax;          // longest protected region
+    bool _parityPending;       // group closed, parity goes out on the next call
+    RtpJpegStats _stats;
+};
+
+#endif // RTP_JPEG_PACKETIZER_H
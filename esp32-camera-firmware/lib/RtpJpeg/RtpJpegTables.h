@@ -0,0 +1,39 @@
+/**
+ * `RtpJpegTables.h`
+ * - Tables RFC 2435 leaves implicit: the standard Huffman tables (JPEG Annex K.3) both ends
+ *   assume, and the Q 1-99 quantization table scaling (RFC 2435 Appendix A)
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#ifndef RTP_JPEG_TABLES_H
+#define RTP_JPEG_TABLES_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * One Huffman table as stored in a DHT segment
+ */
+struct RtpHuffmanTable {
+    uint8_t tableClass;        // 0 = DC, 1 = AC
+    uint8_t tableId;           // 0 = luma, 1 = chroma
+    const uint8_t* bits;       // code counts for lengths 1-16
+    const uint8_t* values;
+    size_t valueCount;
+};
+
+/**
+ * Standard tables in DHT order: DC luma, AC luma, DC chroma, AC chroma
+ */
+extern const RtpHuffmanTable kRtpStandardHuffman[4];
+
+/**
+ * Quantization tables for RFC 2435 Q 1-99 (zig-zag order, luma then chroma)
+ */
+void rtpJpegMakeTables(uint8_t q, uint8_t* tables);
+
+#endif // RTP_JPEG_TABLES_H
@@ -0,0 +1,121 @@
+/**
+ * `RtpSender.cpp`
+ * - RTP/JPEG UDP sender implementation
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#include "RtpSender.h"
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#ifdef ESP_PLATFORM
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#else
+#include <chrono>
+#include <thread>
+#endif
+
+static_assert(sizeof(struct sockaddr_in) <= 16, "destination storage");
+
+// ========================================
+// Platform Helpers
+// ========================================
+static void sleepMs(uint32_t ms) {
+#ifdef ESP_PLATFORM
+    vTaskDelay(pdMS_TO_TICKS(ms) > 0 ? pdMS_TO_TICKS(ms) : 1);
+#else
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+#endif
+}
+
+static bool outOfBuffers() {
+    return errno == ENOMEM || errno == ENOBUFS || errno == EAGAIN || errno == EWOULDBLOCK;
+}
+
+// ========================================
+// RtpSender
+// ========================================
+RtpSender::RtpSender(const RtpSenderConfig& config)
+    : _config(config), _packetizer(config.rtp), _fd(-1), _address(), _stats() {
+}
+
+RtpSender::~RtpSender() {
+    close();
+}
+
+bool RtpSender::open(const char* host, uint16_t port) {
+    close();
+    struct addrinfo hints = {};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_DGRAM;
+    struct addrinfo* result = NULL;
+    if (host == NULL || getaddrinfo(host, NULL, &hints, &result) != 0 || result == NULL) {
+        return false;
+    }
+    struct sockaddr_in address;
+    memcpy(&address, result->ai_addr, sizeof(address));
+    freeaddrinfo(result);
+    address.sin_port = htons(port);
+    memcpy(_address, &address, sizeof(address));
+
+    _fd = socket(AF_INET, SOCK_DGRAM, 0);
+    return _fd >= 0;
+}
+
+void RtpSender::close() {
+    if (_fd >= 0) {
+        ::close(_fd);
+        _fd = -1;
+    }
+}
+
+bool RtpSender::sendPacket(const RtpPacket& packet) {
+    for (uint8_t attempt = 0;; attempt++) {
+        ssize_t sent = sendto(_fd, packet.data, packet.length, 0, (const struct sockaddr*)_address,
+                              sizeof(struct sockaddr_in));
+        if (sent == (ssize_t)packet.length) {
+            _stats.packets++;
+            _stats.bytes += packet.length;
+            return true;
+        }
+        if (sent >= 0 || !outOfBuffers() || attempt >= _config.sendRetries) {
+            _stats.sendErrors++;
+            return false;
+        }
+        _stats.retries++;
+        sleepMs(_config.retryDelayMs);
+    }
+}
+
+RtpSendResult RtpSender::sendFrame(const uint8_t* jpeg, size_t length, uint64_t captureUs) {
+    if (_fd < 0) {
+        return RtpSendResult::Failed;
+    }
+    uint32_t timestamp = (uint32_t)(captureUs * (kRtpJpegClockHz / 1000) / 1000);
+    if (_packetizer.begin(jpeg, length, timestamp) != RtpJpegError::None) {
+        _stats.unsupported++;
+        return RtpSendResult::Unsupported;
+    }
+    bool complete = true;
+    RtpPacket packet;
+    while (_packetizer.next(packet)) {
+        complete = sendPacket(packet) && complete;
+    }
+    if (!complete) {
+        _stats.failed++;
+        return RtpSendResult::Failed;
+    }
+    _stats.frames++;
+    return RtpSendResult::Sent;
+}
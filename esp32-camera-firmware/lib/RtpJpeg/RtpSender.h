@@ -0,0 +1,95 @@
+/**
+ * `RtpSender.h`
+ * - UDP transport for RTP/JPEG: packetizes a camera frame and writes the datagrams to one
+ *   destination (the relay, or a receiver on the LAN)
+ * - Nothing waits on acknowledgements: a lost datagram costs its frame at most (less with
+ *   parity FEC), where a TCP upload stalls every later frame behind the retransmit
+ * - When lwIP runs out of packet buffers (ENOMEM) the datagram is retried after a short
+ *   sleep; the remaining packets of the frame still go out if it keeps failing, so the
+ *   receiver can repair the gap from parity
+ * - Platform independent: BSD sockets (lwIP on device, the host stack on Linux)
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#ifndef RTP_SENDER_H
+#define RTP_SENDER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "RtpJpegPacketizer.h"
+
+/**
+ * Sender configuration
+ */
+struct RtpSenderConfig {
+    RtpJpegConfig rtp;
+    uint8_t sendRetries = 3;           // extra attempts per datagram while the stack is out of buffers
+    uint32_t retryDelayMs = 2;
+};
+
+/**
+ * Frame send result
+ */
+enum class RtpSendResult : uint8_t {
+    Sent,
+    Unsupported,       // JPEG not representable as RTP/JPEG (caller sends it another way)
+    Failed             // socket closed, or datagrams lost in the local stack
+};
+
+/**
+ * Sender counters
+ */
+struct RtpSenderStats {
+    uint32_t frames;           // frames fully handed to the stack
+    uint32_t unsupported;      // frames refused by the packetizer
+    uint32_t failed;           // frames with at least one datagram the stack refused
+    uint32_t packets;          // datagrams sent (parity included)
+    uint32_t retries;          // ENOMEM/ENOBUFS retries
+    uint32_t sendErrors;       // datagrams given up on
+    uint64_t bytes;
+};
+
+/**
+ * RTP/JPEG over UDP
+ */
+class RtpSender {
+public:
+    explicit RtpSender(const RtpSenderConfig& config);
+    ~RtpSender();
+
+    RtpSender(const RtpSender&) = delete;
+    RtpSender& operator=(const RtpSender&) = delete;
+
+    /**
+     * Open the socket and resolve the destination
+     * @param host IPv4 address or host name
+     */
+    bool open(const char* host, uint16_t port);
+    void close();
+    bool isOpen() const { return _fd >= 0; }
+
+    /**
+     * Packetize and send one frame
+     * @param captureUs Capture time (RTP timestamp = captureUs at 90 kHz)
+     */
+    RtpSendResult sendFrame(const uint8_t* jpeg, size_t length, uint64_t captureUs);
+
+    RtpSenderStats getStats() const { return _stats; }
+    RtpJpegStats getPacketizerStats() const { return _packetizer.getStats(); }
+
+private:
+    bool sendPacket(const RtpPacket& packet);
+
+    RtpSenderConfig _config;
+    RtpJpegPacketizer _packetizer;
+    int _fd;
+    uint8_t _address[16];      // struct sockaddr_in
+    RtpSenderStats _stats;
+};
+
+#endif // RTP_SENDER_H
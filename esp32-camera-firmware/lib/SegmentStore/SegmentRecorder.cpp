@@ -0,0 +1,231 @@
+/**
+ * `SegmentRecorder.cpp`
+ * - Asynchronous segment writer implementation
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#include "SegmentRecorder.h"
+
+#include <chrono>
+
+#ifdef ESP_PLATFORM
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+#endif
+
+// ========================================
+// Platform Helpers
+// ========================================
+static uint64_t nowMicros() {
+#ifdef ESP_PLATFORM
+    return (uint64_t)esp_timer_get_time();
+#else
+    return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+static BackfillConfig stagingConfig(const SegmentRecorderConfig& config) {
+    BackfillConfig staging;
+    staging.capacityBytes = config.stagingBytes;
+    staging.recordIntervalMs = 0;
+    // Frames already staged are older: keep them, the card is the bottleneck
+    staging.eviction = BackfillEviction::DropNewest;
+    return staging;
+}
+
+// ========================================
+// SegmentRecorder
+// ========================================
+SegmentRecorder::SegmentRecorder(const SegmentStoreConfig& storeConfig, const SegmentRecorderConfig& config,
+                                 uint8_t* workspace, uint8_t* staging)
+    : _config(config),
+      _store(storeConfig, workspace),
+      _staging(stagingConfig(config), staging),
+      _running(false),
+      _lastSubmitUs(0),
+      _hasSubmitted(false),
+      _written(0),
+      _writeErrors(0),
+      _wake(false)
+#ifdef ESP_PLATFORM
+      , _taskActive(false)
+#endif
+{
+}
+
+SegmentRecorder::~SegmentRecorder() {
+    stop();
+}
+
+bool SegmentRecorder::start() {
+    {
+        std::lock_guard<std::mutex> lock(_storeMutex);
+        if (!_store.open()) {
+            return false;
+        }
+    }
+    if (_running.exchange(true)) {
+        return true;
+    }
+
+#ifdef ESP_PLATFORM
+    _taskActive = true;
+    if (xTaskCreatePinnedToCore(writerTaskEntry, "recorder", _config.writerStackSize, this,
+                                _config.writerPriority, NULL, _config.writerCore) != pdPASS) {
+        _taskActive = false;
+        _running = false;
+        return false;
+    }
+#else
+    _writerThread = std::thread([this] { writerLoop(); });
+#endif
+    return true;
+}
+
+void SegmentRecorder::stop() {
+    if (_running.exchange(false)) {
+        {
+            std::lock_guard<std::mutex> lock(_wakeMutex);
+            _wake = true;
+        }
+        _wakeCond.notify_all();
+#ifdef ESP_PLATFORM
+        std::unique_lock<std::mutex> lock(_exitMutex);
+        _exitCond.wait(lock, [this] { return !_taskActive; });
+#else
+        if (_writerThread.joinable()) _writerThread.join();
+#endif
+    }
+
+    drainOnce(nowMicros());
+    std::lock_guard<std::mutex> lock(_storeMutex);
+    _store.close();
+}
+
+// ========================================
+// Capture Side
+// ========================================
+bool SegmentRecorder::recordDue(uint64_t nowUs) const {
+    return !_hasSubmitted.load() || nowUs - _lastSubmitUs.load() >= (uint64_t)_config.recordIntervalMs * 1000;
+}
+
+bool SegmentRecorder::submit(uint64_t timeUs, const uint8_t* data, uint32_t length, uint8_t flags, uint64_t nowUs) {
+    _lastSubmitUs = nowUs;
+    _hasSubmitted = true;
+
+    BackfillFrame frame = {};
+    frame.data = data;
+    frame.length = length;
+    frame.captureUs = timeUs;
+    frame.flags = flags;
+    if (!_staging.record(frame, nowUs)) {
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(_wakeMutex);
+        _wake = true;
+    }
+    _wakeCond.notify_one();
+    return true;
+}
+
+// ========================================
+// Writer Side
+// ========================================
+size_t SegmentRecorder::drainOnce(uint64_t nowUs) {
+    size_t written = 0;
+    BackfillFrame frame;
+    // The staged frame stays pinned (not overwritten) while the card writes it
+    while (_staging.beginSend(frame)) {
+        bool ok;
+        {
+            std::lock_guard<std::mutex> lock(_storeMutex);
+            ok = _store.append(frame.captureUs, frame.data, frame.length, frame.flags);
+        }
+        _staging.endSend(true);
+        if (ok) {
+            _written++;
+            written++;
+        } else {
+            _writeErrors++;
+        }
+    }
+    std::lock_guard<std::mutex> lock(_storeMutex);
+    _store.tick(nowUs);
+    return written;
+}
+
+void SegmentRecorder::writerLoop() {
+    while (_running.load()) {
+        {
+            std::unique_lock<std::mutex> lock(_wakeMutex);
+            _wakeCond.wait_for(lock, std::chrono::milliseconds(_config.pollIntervalMs), [this] { return _wake; });
+            _wake = false;
+        }
+        drainOnce(nowMicros());
+    }
+}
+
+#ifdef ESP_PLATFORM
+void SegmentRecorder::writerTaskEntry(void* arg) {
+    SegmentRecorder* self = static_cast<SegmentRecorder*>(arg);
+    self->writerLoop();
+    {
+        std::lock_guard<std::mutex> lock(self->_exitMutex);
+        self->_taskActive = false;
+        self->_exitCond.notify_all();
+    }
+    vTaskDelete(NULL);
+}
+#endif
+
+// ========================================
+// Export Access
+// ========================================
+bool SegmentRecorder::seek(uint64_t timeUs, SegmentCursor& cursor) {
+    std::lock_guard<std::mutex> lock(_storeMutex);
+    return _store.seek(timeUs, cursor);
+}
+
+bool SegmentRecorder::read(SegmentCursor& cursor, uint8_t* out, size_t capacity, RecordedFrame& frame) {
+    std::lock_guard<std::mutex> lock(_storeMutex);
+    return _store.read(cursor, out, capacity, frame);
+}
+
+size_t SegmentRecorder::catalog(SegmentInfo* out, size_t maxCount) const {
+    std::lock_guard<std::mutex> lock(_storeMutex);
+    size_t total = _store.segmentCount();
+    size_t count = total < maxCount ? total : maxCount;
+    for (size_t i = 0; i < count; i++) {
+        out[i] = _store.segment(total - count + i);
+    }
+    return count;
+}
+
+size_t SegmentRecorder::segmentCount() const {
+    std::lock_guard<std::mutex> lock(_storeMutex);
+    return _store.segmentCount();
+}
+
+SegmentRecorderStats SegmentRecorder::getStats() const {
+    BackfillStats staging = _staging.getStats();
+    SegmentRecorderStats stats = {};
+    stats.submitted = staging.recorded;
+    stats.dropped = staging.rejected;
+    stats.written = _written.load();
+    stats.writeErrors = _writeErrors.load();
+    stats.stagedFrames = staging.pendingFrames;
+    stats.maxStagedBytes = staging.maxPendingBytes;
+    return stats;
+}
+
+SegmentStoreStats SegmentRecorder::getStoreStats() const {
+    std::lock_guard<std::mutex> lock(_storeMutex);
+    return _store.getStats();
+}
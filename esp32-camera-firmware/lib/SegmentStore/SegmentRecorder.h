@@ -0,0 +1,154 @@
+/**
+ * `SegmentRecorder.h`
+ * - Continuous recording without blocking the capture path
+ * - submit() copies the frame into a staging FIFO (BackfillStore arena, DropNewest) and returns;
+ *   a writer task drains it into the SegmentStore, so SD latency spikes only cost staged frames
+ * - Readers (time-range export) go through the recorder so they serialize with the writer
+ * - Platform independent: writer is a FreeRTOS task on device, a std::thread on the host
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#ifndef SEGMENT_RECORDER_H
+#define SEGMENT_RECORDER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+
+#include <BackfillStore.h>
+
+#include "SegmentStore.h"
+
+#ifndef ESP_PLATFORM
+#include <thread>
+#endif
+
+/**
+ * Recorder configuration
+ */
+struct SegmentRecorderConfig {
+    size_t stagingBytes = 256 * 1024;  // staging FIFO (frames waiting for the card)
+    uint32_t recordIntervalMs = 0;     // min spacing of recorded frames (0 = every submitted frame)
+    uint32_t pollIntervalMs = 50;      // writer wake-up without new frames (timed flush)
+
+    // FreeRTOS task parameters (ignored on host)
+    uint32_t writerStackSize = 4096;
+    uint8_t writerPriority = 1;        // below capture/network: the card gets idle time
+    int8_t writerCore = 0;
+};
+
+/**
+ * Recorder counters
+ */
+struct SegmentRecorderStats {
+    uint32_t submitted;        // frames staged
+    uint32_t dropped;          // frames not staged (FIFO full: the card fell behind)
+    uint32_t written;          // frames appended to the store
+    uint32_t writeErrors;      // append failures (frame lost)
+    uint32_t stagedFrames;     // frames waiting now
+    uint32_t maxStagedBytes;   // high-water mark of the FIFO
+};
+
+/**
+ * Asynchronous segment writer
+ */
+class SegmentRecorder {
+public:
+    /**
+     * Constructor
+     * @param storeConfig Segment store configuration
+     * @param config Recorder configuration
+     * @param workspace Caller-owned SegmentStore::workspaceSize(storeConfig) bytes
+     * @param staging Caller-owned config.stagingBytes bytes
+     */
+    SegmentRecorder(const SegmentStoreConfig& storeConfig, const SegmentRecorderConfig& config,
+                    uint8_t* workspace, uint8_t* staging);
+    ~SegmentRecorder();
+
+    SegmentRecorder(const SegmentRecorder&) = delete;
+    SegmentRecorder& operator=(const SegmentRecorder&) = delete;
+
+    /**
+     * Open the store and start the writer
+     * @return false if the store cannot be opened or the writer cannot start
+     */
+    bool start();
+
+    /**
+     * Stop the writer, write the staged frames and close the open segment
+     */
+    void stop();
+
+    /**
+     * Check if a frame should be recorded now (recording interval elapsed)
+     */
+    bool recordDue(uint64_t nowUs) const;
+
+    /**
+     * Copy a frame into the staging FIFO (never waits for the card)
+     * @param timeUs Recording timestamp (index key)
+     * @param nowUs Monotonic clock for the recording interval
+     * @return false if the FIFO is full
+     */
+    bool submit(uint64_t timeUs, const uint8_t* data, uint32_t length, uint8_t flags, uint64_t nowUs);
+
+    /**
+     * Move staged frames into the store and run its timed flush (writer task)
+     * @return Frames written
+     */
+    size_t drainOnce(uint64_t nowUs);
+
+    /**
+     * Export access, serialized with the writer
+     */
+    bool seek(uint64_t timeUs, SegmentCursor& cursor);
+    bool read(SegmentCursor& cursor, uint8_t* out, size_t capacity, RecordedFrame& frame);
+
+    /**
+     * Copy the newest part of the segment catalog
+     * @return Number of segments copied (the newest maxCount, oldest first)
+     */
+    size_t catalog(SegmentInfo* out, size_t maxCount) const;
+    size_t segmentCount() const;
+
+    SegmentRecorderStats getStats() const;
+    SegmentStoreStats getStoreStats() const;
+    bool isRunning() const { return _running.load(); }
+
+private:
+    void writerLoop();
+
+    SegmentRecorderConfig _config;
+    SegmentStore _store;
+    BackfillStore _staging;
+    mutable std::mutex _storeMutex;    // writer vs export readers
+
+    std::atomic<bool> _running;
+    std::atomic<uint64_t> _lastSubmitUs;
+    std::atomic<bool> _hasSubmitted;
+    std::atomic<uint32_t> _written;
+    std::atomic<uint32_t> _writeErrors;
+
+    std::mutex _wakeMutex;
+    std::condition_variable _wakeCond;
+    bool _wake;
+
+#ifdef ESP_PLATFORM
+    static void writerTaskEntry(void* arg);
+
+    std::mutex _exitMutex;
+    std::condition_variable _exitCond;
+    bool _taskActive;
+#else
+    std::thread _writerThread;
+#endif
+};
+
+#endif // SEGMENT_RECORDER_H
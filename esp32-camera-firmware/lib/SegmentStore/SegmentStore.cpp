@@ -0,0 +1,609 @@
+/**
+ * `SegmentStore.cpp`
+ * - Segmented frame store implementation
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#include "SegmentStore.h"
+
+#include <dirent.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+static const uint8_t kSegmentMagic[4] = {'C', 'S', 'E', 'G'};
+static const uint8_t kTrailerMagic[4] = {'C', 'I', 'D', 'X'};
+static const uint16_t kRecordMagic = 0xF7A3;
+static const uint8_t kRecordFrame = 1;
+static const uint8_t kRecordPad = 2;
+static const size_t kMaxPath = 96;
+
+// ========================================
+// Little-endian Helpers
+// ========================================
+static void put16(uint8_t* p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put32(uint8_t* p, uint32_t v) {
+    for (int i = 0; i < 4; i++) p[i] = (uint8_t)(v >> (8 * i));
+}
+
+static void put64(uint8_t* p, uint64_t v) {
+    for (int i = 0; i < 8; i++) p[i] = (uint8_t)(v >> (8 * i));
+}
+
+static uint16_t get16(const uint8_t* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t get32(const uint8_t* p) {
+    uint32_t v = 0;
+    for (int i = 3; i >= 0; i--) v = (v << 8) | p[i];
+    return v;
+}
+
+static uint64_t get64(const uint8_t* p) {
+    uint64_t v = 0;
+    for (int i = 7; i >= 0; i--) v = (v << 8) | p[i];
+    return v;
+}
+
+static void encodeRecordHeader(uint8_t* p, uint8_t type, uint8_t flags, uint32_t length, uint64_t timeUs) {
+    put16(p, kRecordMagic);
+    p[2] = type;
+    p[3] = flags;
+    put32(p + 4, length);
+    put64(p + 8, timeUs);
+}
+
+static uint32_t batchSize(const SegmentStoreConfig& config) {
+    uint32_t sectors = config.batchBytes / SegmentStore::kSectorSize;
+    return (sectors > 0 ? sectors : 1) * SegmentStore::kSectorSize;
+}
+
+// ========================================
+// Construction
+// ========================================
+size_t SegmentStore::workspaceSize(const SegmentStoreConfig& config) {
+    return batchSize(config) + (size_t)config.segmentMaxFrames * kIndexEntrySize;
+}
+
+SegmentStore::SegmentStore(const SegmentStoreConfig& config, uint8_t* workspace)
+    : _config(config),
+      _batch(workspace),
+      _index(workspace + batchSize(config)),
+      _catalog(),
+      _file(NULL),
+      _nextId(1),
+      _fileOffset(0),
+      _batchFill(0),
+      _dirty(false),
+      _lastFlushUs(0),
+      _hasFlushTime(false),
+      _fileMoved(false),
+      _readFile(NULL),
+      _readId(0),
+      _stats() {
+    _config.batchBytes = batchSize(config);
+    if (_config.segmentMaxFrames < 1) _config.segmentMaxFrames = 1;
+}
+
+SegmentStore::~SegmentStore() {
+    close();
+}
+
+void SegmentStore::segmentPath(uint32_t id, char* path, size_t size) const {
+    snprintf(path, size, "%s/seg_%08u.csg", _config.directory, (unsigned)id);
+}
+
+uint64_t SegmentStore::totalBytes() const {
+    uint64_t total = 0;
+    for (size_t i = 0; i < _catalog.size(); i++) {
+        total += _catalog[i].bytes;
+    }
+    return total;
+}
+
+// ========================================
+// Catalog / Recovery
+// ========================================
+bool SegmentStore::open() {
+    mkdir(_config.directory, 0775);
+    DIR* dir = opendir(_config.directory);
+    if (dir == NULL) {
+        _stats.errors++;
+        return false;
+    }
+    std::vector<uint32_t> ids;
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != NULL) {
+        unsigned id = 0;
+        char ext[4] = {};
+        if (sscanf(entry->d_name, "seg_%8u.%3s", &id, ext) == 2 && strcmp(ext, "csg") == 0) {
+            ids.push_back((uint32_t)id);
+        }
+    }
+    closedir(dir);
+    std::sort(ids.begin(), ids.end());
+
+    _catalog.clear();
+    for (size_t i = 0; i < ids.size(); i++) {
+        SegmentInfo info = {};
+        if (loadSegmentInfo(ids[i], info)) {
+            _catalog.push_back(info);
+        }
+        _nextId = ids[i] + 1;
+    }
+    enforceRetention();
+    return true;
+}
+
+bool SegmentStore::loadSegmentInfo(uint32_t id, SegmentInfo& info) {
+    char path[kMaxPath];
+    segmentPath(id, path, sizeof(path));
+    FILE* file = fopen(path, "r+b");
+    if (file == NULL) {
+        _stats.errors++;
+        return false;
+    }
+    uint8_t header[16];
+    fseek(file, 0, SEEK_END);
+    uint64_t size = (uint64_t)ftell(file);
+    fseek(file, 0, SEEK_SET);
+    if (size < kHeaderSize || fread(header, 1, sizeof(header), file) != sizeof(header) ||
+        memcmp(header, kSegmentMagic, 4) != 0) {
+        fclose(file);
+        _stats.errors++;
+        return false;
+    }
+
+    info.id = id;
+    info.bytes = size;
+    info.open = false;
+    uint8_t trailer[kTrailerSize];
+    if (size >= kHeaderSize + kTrailerSize && fseek(file, (long)(size - kTrailerSize), SEEK_SET) == 0 &&
+        fread(trailer, 1, sizeof(trailer), file) == sizeof(trailer) && memcmp(trailer, kTrailerMagic, 4) == 0) {
+        info.frames = get32(trailer + 4);
+        info.indexOffset = get64(trailer + 8);
+        info.firstUs = get64(trailer + 16);
+        info.lastUs = get64(trailer + 24);
+        if (info.indexOffset + (uint64_t)info.frames * kIndexEntrySize + kTrailerSize == size) {
+            fclose(file);
+            return info.frames > 0;
+        }
+    }
+
+    // No valid trailer: the segment was being written when power was lost
+    bool recovered = recoverSegment(file, size, info);
+    fclose(file);
+    if (!recovered || info.frames == 0) {
+        remove(path);
+        return false;
+    }
+    _stats.segmentsRecovered++;
+    return true;
+}
+
+bool SegmentStore::recoverSegment(FILE* file, uint64_t fileSize, SegmentInfo& info) {
+    std::vector<uint8_t> index;
+    info.frames = 0;
+    uint64_t offset = kHeaderSize;
+    uint8_t header[kRecordHeaderSize];
+    while (offset + kRecordHeaderSize <= fileSize) {
+        if (fseek(file, (long)offset, SEEK_SET) != 0 || fread(header, 1, sizeof(header), file) != sizeof(header) ||
+            get16(header) != kRecordMagic) {
+            break;
+        }
+        uint32_t length = get32(header + 4);
+        uint64_t end = offset + kRecordHeaderSize + length;
+        if (end > fileSize) {
+            break;  // torn write
+        }
+        if (header[2] == kRecordFrame) {
+            uint64_t timeUs = get64(header + 8);
+            uint8_t entry[kIndexEntrySize];
+            put64(entry, timeUs);
+            put32(entry + 8, (uint32_t)offset);
+            put32(entry + 12, length);
+            index.insert(index.end(), entry, entry + sizeof(entry));
+            if (info.frames == 0) info.firstUs = timeUs;
+            info.lastUs = timeUs;
+            info.frames++;
+        }
+        offset = end;
+    }
+    if (info.frames == 0) {
+        return true;
+    }
+
+    // Index and trailer go behind whatever the file holds (torn bytes are never indexed)
+    uint8_t trailer[kTrailerSize] = {};
+    memcpy(trailer, kTrailerMagic, 4);
+    put32(trailer + 4, info.frames);
+    put64(trailer + 8, fileSize);
+    put64(trailer + 16, info.firstUs);
+    put64(trailer + 24, info.lastUs);
+    if (fseek(file, (long)fileSize, SEEK_SET) != 0 ||
+        fwrite(index.data(), 1, index.size(), file) != index.size() ||
+        fwrite(trailer, 1, sizeof(trailer), file) != sizeof(trailer)) {
+        _stats.errors++;
+        return false;
+    }
+    fflush(file);
+    fsync(fileno(file));
+    info.indexOffset = fileSize;
+    info.bytes = fileSize + index.size() + sizeof(trailer);
+    return true;
+}
+
+void SegmentStore::enforceRetention() {
+    // The open segment (always last) is never deleted
+    while (!_catalog.empty() && !_catalog[0].open) {
+        bool overCount = _config.retentionSegments > 0 && _catalog.size() > _config.retentionSegments;
+        bool overBytes = _config.retentionBytes > 0 && totalBytes() > _config.retentionBytes;
+        if (!overCount && !overBytes) {
+            break;
+        }
+        if (_readFile != NULL && _readId == _catalog[0].id) {
+            closeReadHandle();
+        }
+        char path[kMaxPath];
+        segmentPath(_catalog[0].id, path, sizeof(path));
+        if (remove(path) != 0) {
+            _stats.errors++;
+        }
+        _catalog.erase(_catalog.begin());
+        _stats.segmentsDeleted++;
+    }
+}
+
+// ========================================
+// Writing
+// ========================================
+bool SegmentStore::writeBatch(size_t length) {
+    if (_fileMoved) {
+        fseek(_file, (long)_fileOffset, SEEK_SET);
+        _fileMoved = false;
+    }
+    _stats.writeCalls++;
+    if (fwrite(_batch, 1, length, _file) != length) {
+        _stats.errors++;
+        return false;
+    }
+    _fileOffset += (uint32_t)length;
+    _stats.bytesWritten += length;
+    return true;
+}
+
+bool SegmentStore::writeBytes(const uint8_t* data, size_t length) {
+    // data == NULL writes zeros (padding)
+    while (length > 0) {
+        size_t chunk = std::min(length, (size_t)_config.batchBytes - _batchFill);
+        if (data != NULL) {
+            memcpy(_batch + _batchFill, data, chunk);
+            data += chunk;
+        } else {
+            memset(_batch + _batchFill, 0, chunk);
+        }
+        _batchFill += chunk;
+        length -= chunk;
+        // Only whole batches are written: file offsets stay sector aligned
+        if (_batchFill == _config.batchBytes) {
+            _batchFill = 0;
+            if (!writeBatch(_config.batchBytes)) {
+                return false;
+            }
+        }
+    }
+    _dirty = true;
+    return true;
+}
+
+bool SegmentStore::padToSector() {
+    uint32_t remainder = (uint32_t)((_fileOffset + _batchFill) % kSectorSize);
+    if (remainder == 0) {
+        return true;
+    }
+    uint32_t pad = kSectorSize - remainder;
+    if (pad < kRecordHeaderSize) {
+        pad += kSectorSize;
+    }
+    uint8_t header[kRecordHeaderSize];
+    encodeRecordHeader(header, kRecordPad, 0, pad - kRecordHeaderSize, 0);
+    _stats.padBytes += pad;
+    return writeBytes(header, sizeof(header)) && writeBytes(NULL, pad - kRecordHeaderSize);
+}
+
+bool SegmentStore::openSegment(uint64_t timeUs) {
+    char path[kMaxPath];
+    segmentPath(_nextId, path, sizeof(path));
+    _file = fopen(path, "w+b");
+    if (_file == NULL) {
+        _stats.errors++;
+        return false;
+    }
+    setvbuf(_file, NULL, _IONBF, 0);  // the batch buffer is the only buffering
+
+    SegmentInfo info = {};
+    info.id = _nextId++;
+    info.firstUs = timeUs;
+    info.lastUs = timeUs;
+    info.open = true;
+    _catalog.push_back(info);
+    _fileOffset = 0;
+    _batchFill = 0;
+    _fileMoved = false;
+    _stats.segmentsCreated++;
+
+    uint8_t header[kHeaderSize] = {};
+    memcpy(header, kSegmentMagic, 4);
+    put16(header + 4, kVersion);
+    put16(header + 6, (uint16_t)kHeaderSize);
+    put32(header + 8, info.id);
+    return writeBytes(header, sizeof(header));
+}
+
+bool SegmentStore::closeSegment() {
+    SegmentInfo& info = _catalog.back();
+    uint8_t trailer[kTrailerSize] = {};
+    memcpy(trailer, kTrailerMagic, 4);
+    put32(trailer + 4, info.frames);
+    put64(trailer + 8, (uint64_t)_fileOffset + _batchFill);
+    put64(trailer + 16, info.firstUs);
+    put64(trailer + 24, info.lastUs);
+
+    info.indexOffset = (uint64_t)_fileOffset + _batchFill;
+    bool ok = writeBytes(_index, (size_t)info.frames * kIndexEntrySize) && writeBytes(trailer, sizeof(trailer));
+    if (ok && _batchFill > 0) {
+        ok = writeBatch(_batchFill);
+    }
+    _batchFill = 0;
+    fflush(_file);
+    fsync(fileno(_file));
+    fclose(_file);
+    _file = NULL;
+    _dirty = false;
+    info.open = false;
+    info.bytes = _fileOffset;
+    return ok;
+}
+
+bool SegmentStore::append(uint64_t timeUs, const uint8_t* data, uint32_t length, uint8_t flags) {
+    uint64_t recordBytes = (uint64_t)kRecordHeaderSize + length;
+    if (kHeaderSize + recordBytes + kIndexEntrySize + kTrailerSize + kSectorSize > _config.segmentMaxBytes) {
+        _stats.errors++;
+        return false;
+    }
+
+    if (_file != NULL) {
+        const SegmentInfo& info = _catalog.back();
+        uint64_t projected = (uint64_t)_fileOffset + _batchFill + recordBytes + kSectorSize +
+                             (uint64_t)(info.frames + 1) * kIndexEntrySize + kTrailerSize;
+        if (info.frames >= _config.segmentMaxFrames || timeUs < info.lastUs ||
+            timeUs - info.firstUs >= (uint64_t)_config.segmentDurationMs * 1000 ||
+            projected > _config.segmentMaxBytes) {
+            if (!closeSegment()) {
+                return false;
+            }
+        }
+    }
+    if (_file == NULL && !openSegment(timeUs)) {
+        return false;
+    }
+
+    SegmentInfo& info = _catalog.back();
+    uint8_t* entry = _index + (size_t)info.frames * kIndexEntrySize;
+    put64(entry, timeUs);
+    put32(entry + 8, _fileOffset + (uint32_t)_batchFill);
+    put32(entry + 12, length);
+
+    uint8_t header[kRecordHeaderSize];
+    encodeRecordHeader(header, kRecordFrame, flags, length, timeUs);
+    if (!writeBytes(header, sizeof(header)) || !writeBytes(data, length)) {
+        return false;
+    }
+    if (info.frames == 0) info.firstUs = timeUs;
+    info.lastUs = timeUs;
+    info.frames++;
+    info.bytes = (uint64_t)_fileOffset + _batchFill;
+    _stats.framesWritten++;
+
+    // Retention counts the open segment as it grows
+    enforceRetention();
+    return true;
+}
+
+bool SegmentStore::flush() {
+    if (_file == NULL || !_dirty) {
+        return true;
+    }
+    bool ok = padToSector();
+    if (ok && _batchFill > 0) {
+        ok = writeBatch(_batchFill);
+    }
+    _batchFill = 0;
+    fflush(_file);
+    fsync(fileno(_file));
+    _dirty = false;
+    _catalog.back().bytes = _fileOffset;
+    _stats.flushes++;
+    return ok;
+}
+
+void SegmentStore::tick(uint64_t nowUs) {
+    if (!_dirty || !_hasFlushTime) {
+        _lastFlushUs = nowUs;
+        _hasFlushTime = true;
+        return;
+    }
+    if (nowUs - _lastFlushUs >= (uint64_t)_config.flushIntervalMs * 1000) {
+        flush();
+        _lastFlushUs = nowUs;
+    }
+}
+
+void SegmentStore::close() {
+    if (_file != NULL) {
+        closeSegment();
+    }
+    closeReadHandle();
+}
+
+// ========================================
+// Reading
+// ========================================
+FILE* SegmentStore::readHandle(const SegmentInfo& info) {
+    if (info.open) {
+        _fileMoved = true;
+        return _file;
+    }
+    if (_readFile != NULL && _readId == info.id) {
+        return _readFile;
+    }
+    closeReadHandle();
+    char path[kMaxPath];
+    segmentPath(info.id, path, sizeof(path));
+    _readFile = fopen(path, "rb");
+    if (_readFile == NULL) {
+        _stats.errors++;
+        return NULL;
+    }
+    _readId = info.id;
+    return _readFile;
+}
+
+void SegmentStore::closeReadHandle() {
+    if (_readFile != NULL) {
+        fclose(_readFile);
+        _readFile = NULL;
+    }
+}
+
+bool SegmentStore::readRange(const SegmentInfo& info, uint64_t offset, uint8_t* out, size_t length) {
+    // Open segment: the tail may still sit in the batch buffer
+    if (info.open && offset + length > _fileOffset) {
+        size_t inBatch = (size_t)std::min<uint64_t>(length, offset + length - _fileOffset);
+        size_t batchStart = offset >= _fileOffset ? (size_t)(offset - _fileOffset) : 0;
+        memcpy(out + (length - inBatch), _batch + batchStart, inBatch);
+        length -= inBatch;
+        if (length == 0) {
+            return true;
+        }
+    }
+    FILE* file = readHandle(info);
+    if (file == NULL) {
+        return false;
+    }
+    _stats.seeks++;
+    if (fseek(file, (long)offset, SEEK_SET) != 0 || fread(out, 1, length, file) != length) {
+        _stats.errors++;
+        return false;
+    }
+    return true;
+}
+
+bool SegmentStore::readIndexEntry(const SegmentInfo& info, uint32_t entry, uint64_t& timeUs, uint32_t& offset,
+                                  uint32_t& length) {
+    uint8_t buffer[kIndexEntrySize];
+    const uint8_t* p = buffer;
+    if (info.open) {
+        p = _index + (size_t)entry * kIndexEntrySize;
+    } else if (!readRange(info, info.indexOffset + (uint64_t)entry * kIndexEntrySize, buffer, sizeof(buffer))) {
+        return false;
+    }
+    timeUs = get64(p);
+    offset = get32(p + 8);
+    length = get32(p + 12);
+    return true;
+}
+
+bool SegmentStore::seek(uint64_t timeUs, SegmentCursor& cursor) {
+    cursor.valid = false;
+    for (size_t i = 0; i < _catalog.size(); i++) {
+        const SegmentInfo& info = _catalog[i];
+        if (info.frames == 0 || info.lastUs < timeUs) {
+            continue;
+        }
+        cursor.segmentId = info.id;
+        cursor.entry = 0;
+        cursor.valid = true;
+        if (info.firstUs >= timeUs) {
+            return true;
+        }
+        // lower_bound over the index: one entry read per step
+        uint32_t low = 0;
+        uint32_t high = info.frames - 1;  // lastUs >= timeUs, so the answer exists
+        while (low < high) {
+            uint32_t mid = low + (high - low) / 2;
+            uint64_t entryUs;
+            uint32_t offset, length;
+            if (!readIndexEntry(info, mid, entryUs, offset, length)) {
+                cursor.valid = false;
+                return false;
+            }
+            if (entryUs < timeUs) {
+                low = mid + 1;
+            } else {
+                high = mid;
+            }
+        }
+        cursor.entry = low;
+        return true;
+    }
+    return false;
+}
+
+bool SegmentStore::read(SegmentCursor& cursor, uint8_t* out, size_t capacity, RecordedFrame& frame) {
+    if (!cursor.valid) {
+        return false;
+    }
+    size_t i = 0;
+    while (i < _catalog.size() && _catalog[i].id < cursor.segmentId) i++;
+    while (i < _catalog.size()) {
+        const SegmentInfo& info = _catalog[i];
+        if (info.id != cursor.segmentId) {
+            // Segment deleted by retention or finished: continue with the next one
+            cursor.segmentId = info.id;
+            cursor.entry = 0;
+        }
+        if (cursor.entry < info.frames) {
+            uint64_t timeUs;
+            uint32_t offset, length;
+            uint8_t header[kRecordHeaderSize];
+            if (!readIndexEntry(info, cursor.entry, timeUs, offset, length) ||
+                !readRange(info, offset, header, sizeof(header))) {
+                return false;
+            }
+            if (get16(header) != kRecordMagic || get32(header + 4) != length) {
+                _stats.errors++;
+                return false;
+            }
+            frame.timeUs = timeUs;
+            frame.segmentId = info.id;
+            frame.length = length;
+            frame.flags = header[3];
+            if (length <= capacity && !readRange(info, (uint64_t)offset + kRecordHeaderSize, out, length)) {
+                return false;
+            }
+            cursor.entry++;
+            return true;
+        }
+        if (info.open) {
+            return false;  // caught up with the recording
+        }
+        i++;
+        if (i < _catalog.size()) {
+            cursor.segmentId = _catalog[i].id;
+            cursor.entry = 0;
+        }
+    }
+    return false;
+}
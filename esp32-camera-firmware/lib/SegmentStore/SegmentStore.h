@@ -0,0 +1,206 @@
+/**
+ * `SegmentStore.h`
+ * - Append-only local recording (microSD on device, a regular directory on the host)
+ * - Segments hold length-prefixed, timestamped JPEG frames; a per-segment index is
+ *   appended when the segment closes, so any time is reached with O(log n) seeks
+ * - Writes are batched in sector-sized chunks (file offsets stay sector aligned)
+ * - Rotation by duration/size/frame count, retention by total bytes/segment count
+ * - Unterminated segments (power loss) are recovered by scanning their records
+ * - Platform independent: stdio/dirent only (ESP-IDF VFS mounts the card), workspace is caller-owned
+ * - Not thread-safe: the caller serializes writer and readers (see SegmentRecorder)
+ *
+ * File format (little-endian), `seg_<id>.csg`:
+ *   header   (512): magic "CSEG", version u16, headerSize u16, segmentId u32
+ *   record   (16 + n): magic u16 0xF7A3, type u8 (1 frame, 2 pad), flags u8, length u32, timeUs u64, payload
+ *   index    (16 each, at close): timeUs u64, offset u32, length u32
+ *   trailer  (32): magic "CIDX", count u32, indexOffset u64, firstUs u64, lastUs u64
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#ifndef SEGMENT_STORE_H
+#define SEGMENT_STORE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include <vector>
+
+/**
+ * Store configuration
+ */
+struct SegmentStoreConfig {
+    const char* directory = "/sdcard/rec";
+    uint32_t segmentDurationMs = 60000;        // rotate after this much recorded time
+    uint32_t segmentMaxBytes = 8 * 1024 * 1024; // rotate before a segment grows past this
+    uint32_t segmentMaxFrames = 2048;          // index entries kept in RAM for the open segment
+    uint32_t batchBytes = 16 * 1024;           // write batch (multiple of kSectorSize)
+    uint32_t flushIntervalMs = 2000;           // max time data waits in the batch buffer
+    uint64_t retentionBytes = 512ULL * 1024 * 1024;  // delete oldest segments beyond this (0 = no limit)
+    uint16_t retentionSegments = 256;          // and beyond this many segments
+};
+
+/**
+ * Segment catalog entry
+ */
+struct SegmentInfo {
+    uint32_t id;
+    uint64_t firstUs;
+    uint64_t lastUs;
+    uint32_t frames;
+    uint64_t bytes;            // file size
+    uint64_t indexOffset;      // index position (closed segments)
+    bool open;                 // being written
+};
+
+/**
+ * Position of a frame for sequential reads
+ */
+struct SegmentCursor {
+    uint32_t segmentId;
+    uint32_t entry;            // index entry within the segment
+    bool valid;
+};
+
+/**
+ * Frame read back from the store
+ */
+struct RecordedFrame {
+    uint64_t timeUs;
+    uint32_t segmentId;
+    uint32_t length;
+    uint8_t flags;
+};
+
+/**
+ * Store counters
+ */
+struct SegmentStoreStats {
+    uint32_t framesWritten;
+    uint64_t bytesWritten;     // file bytes incl. headers, padding and index
+    uint32_t writeCalls;       // fwrite() calls (batching efficiency)
+    uint32_t flushes;          // timed/explicit flushes (with padding)
+    uint32_t padBytes;
+    uint32_t segmentsCreated;
+    uint32_t segmentsDeleted;
+    uint32_t segmentsRecovered;  // unterminated segments re-indexed at open()
+    uint32_t seeks;            // fseek() calls on the read path
+    uint32_t errors;           // failed file operations
+};
+
+/**
+ * Segmented frame store
+ */
+class SegmentStore {
+public:
+    static constexpr uint32_t kSectorSize = 512;
+    static constexpr uint32_t kHeaderSize = 512;
+    static constexpr uint32_t kRecordHeaderSize = 16;
+    static constexpr uint32_t kIndexEntrySize = 16;
+    static constexpr uint32_t kTrailerSize = 32;
+    static constexpr uint16_t kVersion = 1;
+
+    /**
+     * Workspace bytes needed for a configuration (batch buffer + open segment index)
+     */
+    static size_t workspaceSize(const SegmentStoreConfig& config);
+
+    /**
+     * Constructor
+     * @param config Store configuration
+     * @param workspace Caller-owned buffer of workspaceSize(config) bytes (PSRAM on device)
+     */
+    SegmentStore(const SegmentStoreConfig& config, uint8_t* workspace);
+    ~SegmentStore();
+
+    SegmentStore(const SegmentStore&) = delete;
+    SegmentStore& operator=(const SegmentStore&) = delete;
+
+    /**
+     * Scan the directory, recover unterminated segments and apply retention
+     * @return false if the directory cannot be created or read
+     */
+    bool open();
+
+    /**
+     * Close the open segment (writes its index)
+     */
+    void close();
+
+    /**
+     * Append one frame (opens/rotates segments as needed)
+     * - A timestamp older than the previous frame starts a new segment (clock reset)
+     * @return false on write error or oversize frame
+     */
+    bool append(uint64_t timeUs, const uint8_t* data, uint32_t length, uint8_t flags);
+
+    /**
+     * Write the batch buffer now, padded to a sector boundary, and sync the file
+     */
+    bool flush();
+
+    /**
+     * Flush if data has waited flushIntervalMs (nowUs: monotonic clock, any domain)
+     */
+    void tick(uint64_t nowUs);
+
+    /**
+     * Position a cursor on the first frame with timeUs >= the given time
+     * @return false if no frame is that recent
+     */
+    bool seek(uint64_t timeUs, SegmentCursor& cursor);
+
+    /**
+     * Read the frame under the cursor and advance it
+     * @param out Destination for the JPEG bytes
+     * @param capacity Size of `out` (larger frames are not copied: frame.length > capacity)
+     * @return false at the end of the recording (cursor stays valid for later frames) or on error
+     */
+    bool read(SegmentCursor& cursor, uint8_t* out, size_t capacity, RecordedFrame& frame);
+
+    size_t segmentCount() const { return _catalog.size(); }
+    const SegmentInfo& segment(size_t index) const { return _catalog[index]; }
+    uint64_t totalBytes() const;
+    SegmentStoreStats getStats() const { return _stats; }
+
+private:
+    bool openSegment(uint64_t timeUs);
+    bool closeSegment();
+    bool writeBytes(const uint8_t* data, size_t length);
+    bool writeBatch(size_t length);
+    bool padToSector();
+    bool readRange(const SegmentInfo& info, uint64_t offset, uint8_t* out, size_t length);
+    void enforceRetention();
+    bool loadSegmentInfo(uint32_t id, SegmentInfo& info);
+    bool recoverSegment(FILE* file, uint64_t fileSize, SegmentInfo& info);
+    bool readIndexEntry(const SegmentInfo& info, uint32_t entry, uint64_t& timeUs, uint32_t& offset, uint32_t& length);
+    FILE* readHandle(const SegmentInfo& info);
+    void closeReadHandle();
+    void segmentPath(uint32_t id, char* path, size_t size) const;
+
+    SegmentStoreConfig _config;
+    uint8_t* _batch;           // batchBytes
+    uint8_t* _index;           // segmentMaxFrames * kIndexEntrySize (encoded entries of the open segment)
+    std::vector<SegmentInfo> _catalog;    // sorted by id (creation order)
+
+    FILE* _file;               // open segment
+    uint32_t _nextId;
+    uint32_t _fileOffset;      // bytes written to the file (excl. batch buffer)
+    size_t _batchFill;
+    bool _dirty;               // batch buffer or file holds data not yet synced
+    uint64_t _lastFlushUs;
+    bool _hasFlushTime;
+
+    bool _fileMoved;           // open segment handle was used for reads (seek before writing)
+
+    FILE* _readFile;           // closed segment being read (cached handle)
+    uint32_t _readId;
+
+    SegmentStoreStats _stats;
+};
+
+#endif // SEGMENT_STORE_H
@@ -0,0 +1,176 @@
+/**
+ * `SensorWindow.cpp`
+ * - ROI readout planning implementation
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#include "SensorWindow.h"
+
+#include <stdio.h>
+
+static const SensorModeInfo kModes[] = {
+    {1600, 1200, 15},   // SensorMode::Uxga
+    {800, 600, 30},     // SensorMode::Svga
+    {400, 296, 60},     // SensorMode::Cif
+};
+
+// Fastest readout first
+static const SensorMode kModeOrder[] = { SensorMode::Cif, SensorMode::Svga, SensorMode::Uxga };
+
+static uint32_t alignDown(uint32_t value, uint16_t alignment) {
+    return alignment > 1 ? value / alignment * alignment : value;
+}
+
+static uint32_t alignUp(uint32_t value, uint16_t alignment) {
+    return alignment > 1 ? (value + alignment - 1) / alignment * alignment : value;
+}
+
+/**
+ * Grow one axis of an ROI to at least `minimum` ‰ around its center, inside the field of view
+ */
+static void grow(uint16_t& origin, uint16_t& size, uint32_t minimum) {
+    if (minimum > 1000) minimum = 1000;
+    if (size >= minimum) {
+        return;
+    }
+    int32_t start = (int32_t)origin + size / 2 - (int32_t)minimum / 2;
+    if (start < 0) start = 0;
+    if (start + (int32_t)minimum > 1000) start = 1000 - (int32_t)minimum;
+    origin = (uint16_t)start;
+    size = (uint16_t)minimum;
+}
+
+// ========================================
+// Constructor
+// ========================================
+SensorWindow::SensorWindow(const SensorWindowConfig& config)
+    : _config(config), _roi(), _active(false) {
+}
+
+// ========================================
+// ROI
+// ========================================
+bool SensorWindow::isValid(const RoiRect& roi) {
+    return roi.width > 0 && roi.height > 0 && roi.x + roi.width <= 1000 && roi.y + roi.height <= 1000;
+}
+
+bool SensorWindow::parse(const char* text, RoiRect& roi) {
+    unsigned x = 0, y = 0, width = 0, height = 0;
+    int consumed = 0;
+    if (text == NULL || sscanf(text, "%u:%u:%u:%u%n", &x, &y, &width, &height, &consumed) != 4 ||
+        text[consumed] != '\0' || x > 1000 || y > 1000 || width > 1000 || height > 1000) {
+        return false;
+    }
+    roi.x = (uint16_t)x;
+    roi.y = (uint16_t)y;
+    roi.width = (uint16_t)width;
+    roi.height = (uint16_t)height;
+    return isValid(roi);
+}
+
+bool SensorWindow::set(const RoiRect& roi) {
+    if (!isValid(roi)) {
+        return false;
+    }
+    _roi = roi;
+    _active = true;
+    return true;
+}
+
+// ========================================
+// Planning
+// ========================================
+const SensorModeInfo& SensorWindow::modeInfo(SensorMode mode) {
+    return kModes[(size_t)mode < sizeof(kModes) / sizeof(kModes[0]) ? (size_t)mode : 0];
+}
+
+bool SensorWindow::plan(uint16_t fullWidth, uint16_t fullHeight, uint32_t fullIntervalMs, WindowPlan& plan) const {
+    if (!_active || fullWidth == 0 || fullHeight == 0) {
+        return false;
+    }
+    const uint16_t alignment = _config.alignment;
+    RoiRect roi = _roi;
+    grow(roi.x, roi.width, ((uint32_t)_config.minOutput * 1000 + fullWidth - 1) / fullWidth);
+    grow(roi.y, roi.height, ((uint32_t)_config.minOutput * 1000 + fullHeight - 1) / fullHeight);
+
+    // Same pixel density as the full view: the ROI is a crop of it, not a zoom
+    uint32_t outputWidth = alignDown((uint32_t)roi.width * fullWidth / 1000, alignment);
+    uint32_t outputHeight = alignDown((uint32_t)roi.height * fullHeight / 1000, alignment);
+
+    // Fastest mode that needs no upscaling (the DSP only scales down)
+    SensorMode mode = SensorMode::Uxga;
+    for (SensorMode candidate : kModeOrder) {
+        if (modeInfo(candidate).width >= fullWidth && modeInfo(candidate).height >= fullHeight) {
+            mode = candidate;
+            break;
+        }
+    }
+    const SensorModeInfo& info = modeInfo(mode);
+
+    uint32_t left = alignDown((uint32_t)roi.x * info.width / 1000, alignment);
+    uint32_t top = alignDown((uint32_t)roi.y * info.height / 1000, alignment);
+    uint32_t right = alignUp((uint32_t)(roi.x + roi.width) * info.width / 1000, alignment);
+    uint32_t bottom = alignUp((uint32_t)(roi.y + roi.height) * info.height / 1000, alignment);
+    if (right > info.width) right = alignDown(info.width, alignment);
+    if (bottom > info.height) bottom = alignDown(info.height, alignment);
+    uint32_t windowWidth = right > left ? right - left : alignment;
+    uint32_t windowHeight = bottom > top ? bottom - top : alignment;
+
+    if (outputWidth > windowWidth) outputWidth = windowWidth;
+    if (outputHeight > windowHeight) outputHeight = windowHeight;
+    if (outputWidth < alignment) outputWidth = alignment;
+    if (outputHeight < alignment) outputHeight = alignment;
+
+    // Bytes scale with the area: the same budget buys proportionally more frames
+    uint32_t intervalMs = (uint32_t)((uint64_t)fullIntervalMs * outputWidth * outputHeight /
+                                     ((uint32_t)fullWidth * fullHeight));
+    uint32_t floorMs = (1000 + info.maxFps - 1) / info.maxFps;
+    if (floorMs < _config.minIntervalMs) floorMs = _config.minIntervalMs;
+    if (intervalMs < floorMs) intervalMs = floorMs;
+    if (intervalMs > fullIntervalMs) intervalMs = fullIntervalMs;
+
+    plan.mode = mode;
+    plan.offsetX = (uint16_t)left;
+    plan.offsetY = (uint16_t)top;
+    plan.windowWidth = (uint16_t)windowWidth;
+    plan.windowHeight = (uint16_t)windowHeight;
+    plan.outputWidth = (uint16_t)outputWidth;
+    plan.outputHeight = (uint16_t)outputHeight;
+    plan.intervalMs = (uint16_t)intervalMs;
+    plan.roi = roi;
+    return true;
+}
+
+// ========================================
+// JPEG Header
+// ========================================
+bool SensorWindow::jpegDimensions(const uint8_t* jpeg, size_t length, uint16_t& width, uint16_t& height) {
+    if (jpeg == NULL || length < 4 || jpeg[0] != 0xFF || jpeg[1] != 0xD8) {
+        return false;
+    }
+    size_t pos = 2;
+    while (pos + 9 <= length) {
+        if (jpeg[pos] != 0xFF) {
+            return false;
+        }
+        uint8_t marker = jpeg[pos + 1];
+        if (marker == 0xFF) {
+            pos++;                 // fill byte
+            continue;
+        }
+        if (marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC) {
+            height = (uint16_t)((jpeg[pos + 5] << 8) | jpeg[pos + 6]);
+            width = (uint16_t)((jpeg[pos + 7] << 8) | jpeg[pos + 8]);
+            return true;
+        }
+        if (marker == 0xDA || marker == 0xD9) {
+            return false;          // scan data or end before any frame header
+        }
+        pos += 2 + (((size_t)jpeg[pos + 2] << 8) | jpeg[pos + 3]);
+    }
+    return false;
+}
@@ -0,0 +1,132 @@
+/**
+ * `SensorWindow.h`
+ * - Region-of-interest (ROI) readout planning for the OV2640
+ * - An ROI is given in ‰ of the field of view (independent of the frame size) and mapped
+ *   to a sensor window: readout mode, DSP crop window and JPEG output size, so only the
+ *   region is scaled and encoded (sensor_t::set_res_raw on device)
+ * - The ROI keeps the pixel density of the full view it replaces and spends the same
+ *   byte budget on a shorter frame interval
+ * - Platform independent: the caller programs the sensor with the returned plan
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#ifndef SENSOR_WINDOW_H
+#define SENSOR_WINDOW_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * OV2640 readout modes (value = set_res_raw `startX`, ov2640_sensor_mode_t)
+ */
+enum class SensorMode : uint8_t {
+    Uxga = 0,      // 1600x1200, 15 FPS
+    Svga = 1,      // 800x600, 30 FPS
+    Cif = 2        // 400x296, 60 FPS
+};
+
+/**
+ * Readout geometry and frame rate of one mode
+ */
+struct SensorModeInfo {
+    uint16_t width;
+    uint16_t height;
+    uint8_t maxFps;
+};
+
+/**
+ * Region of interest in ‰ of the field of view (0-1000)
+ */
+struct RoiRect {
+    uint16_t x;
+    uint16_t y;
+    uint16_t width;
+    uint16_t height;
+};
+
+/**
+ * Planner configuration
+ */
+struct SensorWindowConfig {
+    uint16_t alignment = 8;            // window/output multiple (DSP needs 4, JPEG MCU rows 8)
+    uint16_t minOutput = 64;           // smallest output side (small ROIs grow around their center)
+    uint16_t minIntervalMs = 40;       // shortest ROI frame interval
+};
+
+/**
+ * Sensor settings for one ROI
+ */
+struct WindowPlan {
+    SensorMode mode;
+    uint16_t offsetX;          // window origin in mode pixels
+    uint16_t offsetY;
+    uint16_t windowWidth;      // DSP crop window in mode pixels
+    uint16_t windowHeight;
+    uint16_t outputWidth;      // JPEG frame size
+    uint16_t outputHeight;
+    uint16_t intervalMs;       // frame interval for the ROI
+    RoiRect roi;               // ROI after growing to minOutput
+};
+
+/**
+ * ROI state and planner
+ */
+class SensorWindow {
+public:
+    /**
+     * Constructor
+     * @param config Alignment and limits
+     */
+    explicit SensorWindow(const SensorWindowConfig& config);
+
+    /**
+     * Parse `<x>:<y>:<w>:<h>` (‰ of the field of view)
+     * @return false if malformed or outside the field of view
+     */
+    static bool parse(const char* text, RoiRect& roi);
+
+    /**
+     * Set the ROI (checked like parse())
+     * @return false if the ROI is empty or outside the field of view (the previous one stays)
+     */
+    bool set(const RoiRect& roi);
+
+    /**
+     * Return to the full view
+     */
+    void clear() { _active = false; }
+
+    bool isActive() const { return _active; }
+    const RoiRect& getRoi() const { return _roi; }
+
+    /**
+     * Plan the sensor window for the current ROI
+     * @param fullWidth Full-view frame width the ROI replaces (sets the pixel density)
+     * @param fullHeight Full-view frame height
+     * @param fullIntervalMs Full-view frame interval (the ROI gets the same byte budget)
+     * @return false if no ROI is set
+     */
+    bool plan(uint16_t fullWidth, uint16_t fullHeight, uint32_t fullIntervalMs, WindowPlan& plan) const;
+
+    static const SensorModeInfo& modeInfo(SensorMode mode);
+
+    /**
+     * Frame size from the SOFn marker
+     * - The driver reports the full-view size for windowed frames (status.framesize)
+     * @return false if no SOFn marker was found
+     */
+    static bool jpegDimensions(const uint8_t* jpeg, size_t length, uint16_t& width, uint16_t& height);
+
+private:
+    static bool isValid(const RoiRect& roi);
+
+    SensorWindowConfig _config;
+    RoiRect _roi;
+    bool _active;
+};
+
+#endif // SENSOR_WINDOW_H
@@ -0,0 +1,380 @@
+/**
+ * `SnapshotCapture.cpp`
+ * - Snapshot capture, part-wise upload and reassembly implementation
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#include "SnapshotCapture.h"
+
+#include <string.h>
+
+#include <SensorWindow.h>
+#include <StreamProfile.h>
+
+static const char* const kErrorNames[] = { "none", "busy", "reinit", "mode", "capture", "too_large" };
+
+static void writeU32(uint8_t* out, uint32_t value) {
+    out[0] = (uint8_t)(value >> 24);
+    out[1] = (uint8_t)(value >> 16);
+    out[2] = (uint8_t)(value >> 8);
+    out[3] = (uint8_t)value;
+}
+
+static uint32_t readU32(const uint8_t* in) {
+    return ((uint32_t)in[0] << 24) | ((uint32_t)in[1] << 16) | ((uint32_t)in[2] << 8) | in[3];
+}
+
+// ========================================
+// Upload
+// ========================================
+SnapshotUpload::SnapshotUpload(uint8_t* buffer, size_t capacity, const SnapshotUploadConfig& config)
+    : _blob(NULL),
+      _capacity(0),
+      _config(config),
+      _state(kIdle),
+      _id(0),
+      _total(0),
+      _offset(0),
+      _partLength(0),
+      _partKbps(0),
+      _nextPartUs(0),
+      _stats() {
+    if (_config.headroom > kMaxHeadroom) {
+        _config.headroom = kMaxHeadroom;
+    }
+    if (_config.sharePercent == 0 || _config.sharePercent > 100) {
+        _config.sharePercent = 100;
+    }
+    if (_config.minPartBytes == 0) {
+        _config.minPartBytes = 1;
+    }
+    size_t overhead = bufferSize(0, _config.headroom);
+    if (buffer != NULL && capacity > overhead) {
+        _blob = buffer + _config.headroom + kPartHeaderSize;
+        _capacity = capacity - overhead;
+    }
+}
+
+void SnapshotUpload::publish(const FrameHeader& header) {
+    FrameHeader snapshot = header;
+    snapshot.flags |= kEnvelopeSnapshot;
+    FrameEnvelope::encode(snapshot, _blob, FrameEnvelope::kHeaderSize);
+    _id = header.sequence;
+    _total = (uint32_t)(FrameEnvelope::kHeaderSize + header.payloadLength);
+    _offset = 0;
+    _partLength = 0;
+    _nextPartUs = 0;
+    _state.store(kReady, std::memory_order_release);
+}
+
+bool SnapshotUpload::nextPart(uint64_t nowUs, uint32_t budgetUs, uint32_t linkKbps, SnapshotPart& part) {
+    if (!hasPending() || _partLength > 0 || nowUs < _nextPartUs) {
+        return false;
+    }
+    // What the link carries before the next live frame (kbit/s = bytes per 8 ms)
+    uint32_t kbps = linkKbps > 0 ? linkKbps : _config.minRateKbps;
+    uint64_t fits = (uint64_t)budgetUs * kbps / 8000;
+    if (fits < _config.minPartBytes) {
+        return false;
+    }
+    size_t remaining = _total - _offset;
+    size_t length = fits < _config.maxPartBytes ? (size_t)fits : _config.maxPartBytes;
+    if (length > remaining) {
+        length = remaining;
+    }
+
+    // Part header and transport header room go over bytes in front of the data; keep them
+    uint8_t* message = _blob + _offset - kPartHeaderSize;
+    memcpy(_saved, message - _config.headroom, _config.headroom + kPartHeaderSize);
+    encodePart(_id, _offset, _total, message, kPartHeaderSize);
+
+    _partLength = length;
+    _partKbps = kbps;
+    part.message = message;
+    part.length = kPartHeaderSize + length;
+    part.offset = _offset;
+    part.last = _offset + length == _total;
+    return true;
+}
+
+bool SnapshotUpload::endPart(bool sent, uint64_t nowUs) {
+    if (_partLength == 0) {
+        return false;
+    }
+    uint8_t* message = _blob + _offset - kPartHeaderSize;
+    memcpy(message - _config.headroom, _saved, _config.headroom + kPartHeaderSize);
+    size_t length = _partLength;
+    _partLength = 0;
+    if (!sent) {
+        _stats.failedParts++;
+        return false;
+    }
+    // Leave the link to live frames for the rest of the share (part time × (100 - share) / share)
+    uint64_t partUs = (uint64_t)(kPartHeaderSize + length) * 8000 / _partKbps;
+    _nextPartUs = nowUs + partUs * (100 - _config.sharePercent) / _config.sharePercent;
+    _offset += (uint32_t)length;
+    _stats.parts++;
+    _stats.bytes += length;
+    if (_offset < _total) {
+        return false;
+    }
+    _stats.uploaded++;
+    _state.store(kIdle, std::memory_order_release);
+    return true;
+}
+
+void SnapshotUpload::restart() {
+    if (_partLength > 0) {
+        endPart(false, 0);  // lost with the connection (also called from the transport's disconnect event)
+    }
+    if (hasPending() && _offset > 0) {
+        _offset = 0;
+        _stats.restarts++;
+    }
+}
+
+void SnapshotUpload::cancel() {
+    if (_partLength > 0) {
+        endPart(false, 0);
+    }
+    _offset = 0;
+    _state.store(kIdle, std::memory_order_release);
+}
+
+size_t SnapshotUpload::encodePart(uint32_t id, uint32_t offset, uint32_t total, uint8_t* out, size_t capacity) {
+    if (out == NULL || capacity < kPartHeaderSize) {
+        return 0;
+    }
+    out[0] = 'S';
+    out[1] = 'N';
+    out[2] = 'P';
+    out[3] = kPartVersion;
+    writeU32(out + 4, id);
+    writeU32(out + 8, offset);
+    writeU32(out + 12, total);
+    return kPartHeaderSize;
+}
+
+bool SnapshotUpload::isPart(const uint8_t* data, size_t length) {
+    return data != NULL && length >= kPartHeaderSize && data[0] == 'S' && data[1] == 'N' && data[2] == 'P' &&
+           data[3] >= 1;
+}
+
+bool SnapshotUpload::decodePart(const uint8_t* data, size_t length, SnapshotPartInfo& part) {
+    if (!isPart(data, length)) {
+        return false;
+    }
+    part.id = readU32(data + 4);
+    part.offset = readU32(data + 8);
+    part.total = readU32(data + 12);
+    part.data = data + kPartHeaderSize;
+    part.length = length - kPartHeaderSize;
+    return part.offset <= part.total && part.length <= part.total - part.offset;
+}
+
+// ========================================
+// Capture
+// ========================================
+SnapshotCapture::SnapshotCapture(SnapshotCamera& camera, SnapshotUpload& upload, const SnapshotConfig& config)
+    : _camera(camera),
+      _upload(upload),
+      _config(config),
+      _nextId(0),
+      _lastLiveUs(0),
+      _liveWidth(0),
+      _liveHeight(0),
+      _modeWidth(0),
+      _modeHeight(0),
+      _restoredUs(0),
+      _result(),
+      _resultReady(false) {
+}
+
+const char* SnapshotCapture::errorName(SnapshotError error) {
+    return (size_t)error < sizeof(kErrorNames) / sizeof(kErrorNames[0]) ? kErrorNames[(size_t)error] : "?";
+}
+
+bool SnapshotCapture::isComplete(const uint8_t* jpeg, size_t length) {
+    // The driver may leave a few padding bytes behind EOI
+    size_t end = length > 64 ? length - 64 : 0;
+    for (size_t i = length; i >= end + 2; i--) {
+        if (jpeg[i - 2] == 0xFF && jpeg[i - 1] == 0xD9) {
+            return true;
+        }
+    }
+    return false;
+}
+
+SnapshotError SnapshotCapture::capture(uint8_t frameSize, uint8_t jpegQuality, SnapshotResult& result) {
+    result = SnapshotResult();
+    result.frameSize = frameSize;
+    result.jpegQuality = jpegQuality;
+    if (!_upload.isIdle()) {
+        result.error = SnapshotError::Busy;
+        return result.error;
+    }
+    uint16_t expectedWidth = ProfilePlanner::frameWidth(frameSize);
+    uint16_t expectedHeight = ProfilePlanner::frameHeight(frameSize);
+    _modeWidth = expectedWidth;
+    _modeHeight = expectedHeight;
+
+    uint64_t startUs = _camera.nowUs();
+    result.reinit = frameSize > _camera.bufferFrameSize();
+    SnapshotError error = SnapshotError::Capture;
+    bool buffersChanged = false;
+    if (result.reinit) {
+        buffersChanged = _camera.reallocate(frameSize);
+        if (!buffersChanged) {
+            error = SnapshotError::Reinit;
+        }
+    }
+    bool switched = error != SnapshotError::Reinit && _camera.setMode(frameSize, jpegQuality);
+    if (!switched && error != SnapshotError::Reinit) {
+        error = SnapshotError::Mode;
+    }
+    uint64_t switchedUs = _camera.nowUs();
+    result.switchUs = (uint32_t)(switchedUs - startUs);
+
+    // First complete frame of the snapshot size that started after the switch
+    uint8_t settle = _config.settleFrames;
+    while (switched && _camera.nowUs() - switchedUs < (uint64_t)_config.maxWaitMs * 1000) {
+        SnapshotFrame frame;
+        if (!_camera.grab(frame)) {
+            break;
+        }
+        uint16_t width = 0;
+        uint16_t height = 0;
+        bool valid = frame.captureUs >= switchedUs &&
+                     SensorWindow::jpegDimensions(frame.data, frame.length, width, height) &&
+                     width == expectedWidth && height == expectedHeight && isComplete(frame.data, frame.length);
+        if (valid && settle > 0) {
+            settle--;
+            valid = false;
+        }
+        if (!valid) {
+            result.discarded++;
+            _camera.release(frame);
+            continue;
+        }
+        if (frame.length > _upload.jpegCapacity()) {
+            error = SnapshotError::TooLarge;
+        } else {
+            // Copied out so the driver buffer goes back before the switch back
+            memcpy(_upload.jpegBuffer(), frame.data, frame.length);
+            result.bytes = (uint32_t)frame.length;
+            result.width = width;
+            result.height = height;
+            result.captureUs = frame.captureUs;
+            error = SnapshotError::None;
+        }
+        _camera.release(frame);
+        break;
+    }
+    uint64_t restoreStartUs = _camera.nowUs();
+    result.settleUs = (uint32_t)(restoreStartUs - switchedUs);
+
+    // Live buffers and mode back on every path
+    if (buffersChanged) {
+        _camera.restoreBuffers();  // on failure the driver keeps the snapshot buffers
+    }
+    _camera.restoreMode();
+    _restoredUs = _camera.nowUs();
+    result.restoreUs = (uint32_t)(_restoredUs - restoreStartUs);
+
+    if (error == SnapshotError::None) {
+        result.id = ++_nextId;
+    }
+    result.error = error;
+    _result = result;
+    _resultReady = false;
+    if (_lastLiveUs == 0) {
+        _restoredUs = 0;  // no live frame before it: no gap to measure
+        _resultReady = true;
+    }
+    return error;
+}
+
+bool SnapshotCapture::admitLive(const uint8_t* jpeg, size_t length, uint64_t captureUs) {
+    uint16_t width = 0;
+    uint16_t height = 0;
+    bool sized = SensorWindow::jpegDimensions(jpeg, length, width, height);
+    if (_restoredUs != 0) {
+        // Left in the driver's buffers from the snapshot mode (a live stream of that size drops none)
+        bool stale = sized && width == _modeWidth && height == _modeHeight &&
+                     (width != _liveWidth || height != _liveHeight);
+        if (stale) {
+            _result.staleDropped++;
+            return false;
+        }
+        _result.gapUs = (uint32_t)(captureUs - _lastLiveUs);
+        _restoredUs = 0;
+        _resultReady = true;
+    }
+    if (sized) {
+        _liveWidth = width;
+        _liveHeight = height;
+    }
+    _lastLiveUs = captureUs;
+    return true;
+}
+
+bool SnapshotCapture::takeResult(SnapshotResult& result) {
+    if (!_resultReady) {
+        return false;
+    }
+    result = _result;
+    _resultReady = false;
+    return true;
+}
+
+// ========================================
+// Assembler
+// ========================================
+SnapshotAssembler::SnapshotAssembler(uint8_t* buffer, size_t capacity)
+    : _buffer(buffer), _capacity(capacity), _pending(false), _id(0), _received(0), _total(0), _completed(0),
+      _dropped(0) {
+}
+
+SnapshotAssembleResult SnapshotAssembler::accept(const uint8_t* message, size_t length) {
+    SnapshotPartInfo part;
+    if (!SnapshotUpload::isPart(message, length)) {
+        return AssembleResult::Passthrough;
+    }
+    if (!SnapshotUpload::decodePart(message, length, part)) {
+        _dropped++;
+        return AssembleResult::Dropped;
+    }
+    if (part.offset == 0) {
+        // First part (also an upload started over after a reconnect)
+        if (part.total > _capacity || part.total < FrameEnvelope::kHeaderSize) {
+            reset();
+            _dropped++;
+            return AssembleResult::Dropped;
+        }
+        _pending = true;
+        _id = part.id;
+        _received = 0;
+        _total = part.total;
+    } else if (!_pending || part.id != _id || part.offset != _received || part.total != _total) {
+        reset();
+        _dropped++;
+        return AssembleResult::Dropped;
+    }
+    memcpy(_buffer + _received, part.data, part.length);
+    _received += part.length;
+    if (_received < _total) {
+        return AssembleResult::Pending;
+    }
+    _pending = false;
+    _completed++;
+    return AssembleResult::Complete;
+}
+
+void SnapshotAssembler::reset() {
+    _pending = false;
+    _received = 0;
+}
@@ -0,0 +1,367 @@
+/**
+ * `SnapshotCapture.h`
+ * - High-resolution still (SNAPSHOT) taken between live frames: the sensor switches to the
+ *   snapshot frame size, one frame is copied into a separate buffer and the live mode is
+ *   restored before anything is uploaded
+ * - Gap kept short:
+ *   - the first frame is accepted as soon as it started after the switch and its SOF
+ *     reports the snapshot size (no fixed delay); `settleFrames` more can be skipped for
+ *     exposure
+ *   - buffers already large enough: live switch (set_framesize); otherwise one driver
+ *     re-init there and one back
+ *   - after the switch back, stale snapshot-size frames are dropped from the live path
+ *     and the gap (last live capture before → first live capture after) is measured
+ * - Upload: the buffer is sent in "SNP" parts that fit the idle time before the next live
+ *   frame and use at most a share of the link, so live frames keep priority and go out
+ *   between two parts. Part headers are written in place (the overwritten bytes are put
+ *   back after each part, so a lost connection restarts the upload from the first part)
+ * - SnapshotAssembler is the receiver side (stand-in harness, tests)
+ * - Platform independent: the driver is behind SnapshotCamera (synthetic camera in tests)
+ *
+ * Part header (version 1, 16 bytes, big-endian):
+ *   0  magic "SNP" (3)        3  version (1)
+ *   4  snapshot id (4)        8  offset (4, into [envelope][JPEG])    12 total length (4)
+ * The reassembled parts are an envelope with kEnvelopeSnapshot (sequence = snapshot id)
+ * followed by the JPEG.
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#ifndef SNAPSHOT_CAPTURE_H
+#define SNAPSHOT_CAPTURE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+
+#include <FrameChunker.h>
+#include <FrameEnvelope.h>
+
+/**
+ * One frame from the driver
+ */
+struct SnapshotFrame {
+    void* handle;              // driver buffer (camera_fb_t* on device)
+    const uint8_t* data;
+    size_t length;
+    uint64_t captureUs;        // frame start (device clock)
+};
+
+/**
+ * Camera operations a snapshot needs (implemented over esp_camera on device)
+ */
+class SnapshotCamera {
+public:
+    virtual ~SnapshotCamera() {}
+
+    /**
+     * Largest frame size the frame buffers hold (framesize_t)
+     */
+    virtual uint8_t bufferFrameSize() = 0;
+
+    /**
+     * Re-initialize the driver with buffers for `frameSize` (the previous configuration is
+     * back if this fails)
+     */
+    virtual bool reallocate(uint8_t frameSize) = 0;
+
+    /**
+     * Re-initialize the driver with the buffers it had before reallocate()
+     */
+    virtual bool restoreBuffers() = 0;
+
+    /**
+     * Switch the sensor to the snapshot frame size (full view) and quality
+     */
+    virtual bool setMode(uint8_t frameSize, uint8_t jpegQuality) = 0;
+
+    /**
+     * Back to the live frame size, quality and view
+     */
+    virtual void restoreMode() = 0;
+
+    virtual bool grab(SnapshotFrame& frame) = 0;
+    virtual void release(const SnapshotFrame& frame) = 0;
+    virtual uint64_t nowUs() = 0;
+};
+
+/**
+ * Snapshot settings
+ */
+struct SnapshotConfig {
+    uint8_t settleFrames = 1;      // frames skipped after the first valid one (exposure after the readout change)
+    uint32_t maxWaitMs = 1500;     // give up if no valid frame arrives within this time
+};
+
+/**
+ * Why a snapshot failed
+ */
+enum class SnapshotError : uint8_t {
+    None,
+    Busy,              // previous snapshot still uploading
+    Reinit,            // driver re-init for the larger buffers failed
+    Mode,              // sensor refused the frame size
+    Capture,           // no complete frame of the snapshot size in time
+    TooLarge           // frame larger than the snapshot buffer
+};
+
+/**
+ * Outcome of one snapshot (times in µs)
+ */
+struct SnapshotResult {
+    uint32_t id;
+    uint8_t frameSize;
+    uint8_t jpegQuality;
+    uint16_t width;
+    uint16_t height;
+    uint32_t bytes;
+    uint64_t captureUs;        // snapshot frame start
+    bool reinit;               // buffers were reallocated (and restored)
+    uint8_t discarded;         // frames grabbed but not taken (old mode, incomplete, settling)
+    uint32_t switchUs;         // re-init + mode switch
+    uint32_t settleUs;         // switch done → snapshot frame grabbed
+    uint32_t restoreUs;        // live mode (and buffers) back
+    uint32_t gapUs;            // last live capture before → first live capture after (0 until measured)
+    uint8_t staleDropped;      // snapshot-size frames dropped from the live path afterwards
+    SnapshotError error;
+};
+
+/**
+ * Upload settings
+ */
+struct SnapshotUploadConfig {
+    size_t headroom = 0;               // transport header room in front of each message (at most kMaxHeadroom)
+    uint8_t sharePercent = 50;         // link time for snapshot parts (live frames keep the rest)
+    uint32_t minRateKbps = 256;        // link rate assumed while it is unknown
+    size_t minPartBytes = 1024;        // smaller idle times are left to live frames
+    size_t maxPartBytes = 32 * 1024;
+};
+
+/**
+ * Upload counters
+ */
+struct SnapshotUploadStats {
+    uint32_t uploaded;         // snapshots completely sent
+    uint32_t parts;            // parts sent
+    uint32_t failedParts;      // parts the transport refused (sent again)
+    uint32_t restarts;         // uploads started over (connection lost)
+    uint64_t bytes;            // part payload bytes sent
+};
+
+/**
+ * One part ready to send
+ */
+struct SnapshotPart {
+    uint8_t* message;          // part message (the transport header room lies in front of it)
+    size_t length;             // part header + data
+    uint32_t offset;           // offset of the data in [envelope][JPEG]
+    bool last;
+};
+
+/**
+ * Decoded part header
+ */
+struct SnapshotPartInfo {
+    uint32_t id;
+    uint32_t offset;
+    uint32_t total;
+    const uint8_t* data;
+    size_t length;
+};
+
+/**
+ * Snapshot buffer and its part-wise upload
+ * - Capture context: jpegBuffer() → publish(); network context: nextPart() → endPart()
+ * - The handoff is one atomic state: the capture side only writes while isIdle()
+ */
+class SnapshotUpload {
+public:
+    static constexpr uint8_t kPartVersion = 1;
+    static constexpr size_t kPartHeaderSize = 16;
+    static constexpr size_t kMaxHeadroom = 16;
+
+    /**
+     * Buffer size for a JPEG capacity
+     */
+    static constexpr size_t bufferSize(size_t jpegCapacity, size_t headroom) {
+        return headroom + kPartHeaderSize + FrameEnvelope::kHeaderSize + jpegCapacity;
+    }
+
+    /**
+     * Constructor
+     * @param buffer Caller-owned buffer (PSRAM on device), see bufferSize()
+     */
+    SnapshotUpload(uint8_t* buffer, size_t capacity, const SnapshotUploadConfig& config);
+
+    uint8_t* jpegBuffer() const { return _blob + FrameEnvelope::kHeaderSize; }
+    size_t jpegCapacity() const { return _capacity; }
+
+    /**
+     * Nothing waiting to be uploaded (capture context may fill jpegBuffer())
+     */
+    bool isIdle() const { return _state.load(std::memory_order_acquire) == kIdle; }
+
+    /**
+     * Hand the JPEG in jpegBuffer() to the uploader
+     * @param header Envelope fields (payloadLength = JPEG length; kEnvelopeSnapshot is added)
+     */
+    void publish(const FrameHeader& header);
+
+    bool hasPending() const { return _state.load(std::memory_order_acquire) == kReady; }
+
+    /**
+     * Next part, sized to what the link sends before the next live frame (writes its part
+     * header in place)
+     * @param budgetUs Time until the next live frame is due
+     * @param linkKbps Estimated link rate (0 = unknown)
+     * @return false if nothing is waiting, the share of the link is used up, the budget is
+     *         below minPartBytes, or a part is already out
+     */
+    bool nextPart(uint64_t nowUs, uint32_t budgetUs, uint32_t linkKbps, SnapshotPart& part);
+
+    /**
+     * Finish the part from nextPart() (restores the bytes under its header)
+     * @return true if that was the last part of the snapshot
+     */
+    bool endPart(bool sent, uint64_t nowUs);
+
+    /**
+     * Start the upload over from the first part (connection lost; the receiver dropped it)
+     */
+    void restart();
+
+    /**
+     * Drop the waiting snapshot
+     */
+    void cancel();
+
+    uint32_t pendingId() const { return _id; }
+    uint32_t totalLength() const { return _total; }
+    uint32_t sentLength() const { return _offset; }
+    SnapshotUploadStats getStats() const { return _stats; }
+
+    /**
+     * Encode a part header
+     * @return Bytes written (0 if `out` is too small)
+     */
+    static size_t encodePart(uint32_t id, uint32_t offset, uint32_t total, uint8_t* out, size_t capacity);
+
+    /**
+     * Parse a part message
+     */
+    static bool decodePart(const uint8_t* data, size_t length, SnapshotPartInfo& part);
+
+    /**
+     * Check for the part magic (frame envelopes start with "CAM", frame parts with "CAP")
+     */
+    static bool isPart(const uint8_t* data, size_t length);
+
+private:
+    static constexpr uint8_t kIdle = 0;
+    static constexpr uint8_t kReady = 1;
+
+    uint8_t* _blob;            // [envelope][JPEG], headroom + part header in front
+    size_t _capacity;
+    SnapshotUploadConfig _config;
+    std::atomic<uint8_t> _state;
+    uint32_t _id;
+    uint32_t _total;
+    uint32_t _offset;
+    size_t _partLength;        // data bytes of the part that is out (0 = none)
+    uint32_t _partKbps;
+    uint64_t _nextPartUs;      // share of the link: no part before this
+    uint8_t _saved[kMaxHeadroom + kPartHeaderSize];
+    SnapshotUploadStats _stats;
+};
+
+/**
+ * Mode switch and capture (capture context, between two live captures)
+ */
+class SnapshotCapture {
+public:
+    SnapshotCapture(SnapshotCamera& camera, SnapshotUpload& upload, const SnapshotConfig& config);
+
+    /**
+     * Take a snapshot into the upload buffer (not published: the caller adds the envelope
+     * fields it owns and calls upload.publish())
+     * - Blocks the calling context for the gap; the live mode is restored on every path
+     * @return SnapshotError::None if result describes a JPEG in upload.jpegBuffer()
+     */
+    SnapshotError capture(uint8_t frameSize, uint8_t jpegQuality, SnapshotResult& result);
+
+    /**
+     * Check a live frame (call for every live capture)
+     * - After a snapshot, frames of the snapshot size still in the driver's buffers are
+     *   refused; the first accepted one completes the gap measurement
+     * @return false if the frame must not be used as a live frame
+     */
+    bool admitLive(const uint8_t* jpeg, size_t length, uint64_t captureUs);
+
+    /**
+     * Result of the last snapshot once its gap is measured (once per snapshot)
+     */
+    bool takeResult(SnapshotResult& result);
+
+    /**
+     * JPEG ends with EOI (trailing padding allowed): the driver did not cut it off
+     */
+    static bool isComplete(const uint8_t* jpeg, size_t length);
+
+    static const char* errorName(SnapshotError error);
+
+private:
+    SnapshotCamera& _camera;
+    SnapshotUpload& _upload;
+    SnapshotConfig _config;
+    uint32_t _nextId;
+    uint64_t _lastLiveUs;
+    uint16_t _liveWidth;       // SOF size of the last live frame
+    uint16_t _liveHeight;
+    uint16_t _modeWidth;       // snapshot size of the last capture
+    uint16_t _modeHeight;
+    uint64_t _restoredUs;      // live mode back (0 = no gap pending)
+    SnapshotResult _result;
+    bool _resultReady;
+};
+
+/**
+ * Result of feeding one message to the snapshot assembler (same meaning as for frame parts)
+ */
+typedef AssembleResult SnapshotAssembleResult;
+
+/**
+ * Receiver side: reassemble snapshot parts (live frames may arrive between them)
+ */
+class SnapshotAssembler {
+public:
+    SnapshotAssembler(uint8_t* buffer, size_t capacity);
+
+    SnapshotAssembleResult accept(const uint8_t* message, size_t length);
+
+    /**
+     * Completed [envelope][JPEG] (valid until the next accept)
+     */
+    const uint8_t* snapshot() const { return _buffer; }
+    size_t snapshotLength() const { return _total; }
+
+    void reset();
+
+    uint32_t completed() const { return _completed; }
+    uint32_t dropped() const { return _dropped; }
+
+private:
+    uint8_t* _buffer;
+    size_t _capacity;
+    bool _pending;
+    uint32_t _id;
+    size_t _received;
+    size_t _total;
+    uint32_t _completed;
+    uint32_t _dropped;
+};
+
+#endif // SNAPSHOT_CAPTURE_H
@@ -0,0 +1,158 @@
+/**
+ * `StreamDemand.cpp`
+ * - Consumer-driven upload gate implementation
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#include "StreamDemand.h"
+
+#include <stdio.h>
+#include <string.h>
+
+// ========================================
+// Constructor
+// ========================================
+StreamDemand::StreamDemand(const StreamDemandConfig& config)
+    : _config(config), _consumers(), _mode(StreamMode::Live), _pendingMode(StreamMode::Live),
+      _subscribed(false), _rampUp(false), _hasSent(false), _pendingSinceMs(0), _lastSentMs(0),
+      _accountedMs(0), _stats() {
+}
+
+// ========================================
+// Consumer Set
+// ========================================
+bool StreamDemand::parse(const char* text, ConsumerSet& set) {
+    unsigned live = 0, analyzer = 0;
+    int consumed = 0;
+    if (text == NULL || sscanf(text, "%u:%u%n", &live, &analyzer, &consumed) != 2 ||
+        text[consumed] != '\0' || live > 0xFFFF || analyzer > 0xFFFF) {
+        return false;
+    }
+    set.live = (uint16_t)live;
+    set.analyzer = (uint16_t)analyzer;
+    return true;
+}
+
+const char* StreamDemand::modeName(StreamMode mode) {
+    switch (mode) {
+        case StreamMode::Live: return "live";
+        case StreamMode::Analyzer: return "analyzer";
+        case StreamMode::Idle: return "idle";
+        default: return "unknown";
+    }
+}
+
+StreamMode StreamDemand::modeFor(const ConsumerSet& set) {
+    if (set.live > 0) {
+        return StreamMode::Live;
+    }
+    return set.analyzer > 0 ? StreamMode::Analyzer : StreamMode::Idle;
+}
+
+void StreamDemand::setConsumers(const ConsumerSet& set, uint32_t nowMs) {
+    account(nowMs);
+    _stats.updates++;
+    _consumers = set;
+
+    StreamMode target = modeFor(set);
+    if (!_subscribed) {
+        _subscribed = true;
+        if (target != _mode) {
+            enter(target);   // first set: live was only a default, nobody to linger for
+        }
+    } else if (target < _mode) {
+        enter(target);   // ramp up at once
+    } else if (target > _mode) {
+        if (_pendingMode == _mode) {
+            _pendingSinceMs = nowMs;   // linger counts from the first consumer loss
+        }
+        _pendingMode = target;
+    } else {
+        _pendingMode = _mode;   // consumers came back before the linger expired
+    }
+}
+
+void StreamDemand::reset(uint32_t nowMs) {
+    account(nowMs);
+    _consumers = ConsumerSet();
+    _subscribed = false;
+    if (_mode != StreamMode::Live) {
+        _stats.modeChanges++;
+    }
+    _mode = StreamMode::Live;
+    _pendingMode = StreamMode::Live;
+    _rampUp = false;
+}
+
+// ========================================
+// Gate
+// ========================================
+void StreamDemand::enter(StreamMode mode) {
+    if (mode < _mode) {
+        _stats.rampUps++;
+        _rampUp = true;
+    } else {
+        _rampUp = false;
+    }
+    _stats.modeChanges++;
+    _mode = mode;
+    _pendingMode = mode;
+}
+
+StreamMode StreamDemand::update(uint32_t nowMs) {
+    account(nowMs);
+    if (_pendingMode != _mode && nowMs - _pendingSinceMs >= _config.lingerMs) {
+        enter(_pendingMode);
+    }
+    return _mode;
+}
+
+bool StreamDemand::admit(bool wanted, uint32_t bytes, uint32_t nowMs) {
+    bool send = false;
+    switch (update(nowMs)) {
+        case StreamMode::Live:
+            send = wanted || _rampUp;
+            break;
+        case StreamMode::Analyzer:
+            send = (wanted || _rampUp) &&
+                   (_rampUp || !_hasSent || nowMs - _lastSentMs >= _config.analyzerIntervalMs);
+            break;
+        default:
+            break;
+    }
+
+    if (send) {
+        _rampUp = false;
+        _hasSent = true;
+        _lastSentMs = nowMs;
+        _stats.sent++;
+    } else if (wanted) {
+        _stats.suppressed++;
+        _stats.suppressedBytes += bytes;
+    }
+    return send;
+}
+
+uint32_t StreamDemand::getPendingMs(uint32_t nowMs) const {
+    if (_pendingMode == _mode) {
+        return 0;
+    }
+    uint32_t elapsedMs = nowMs - _pendingSinceMs;
+    return elapsedMs >= _config.lingerMs ? 0 : _config.lingerMs - elapsedMs;
+}
+
+// ========================================
+// Statistics
+// ========================================
+void StreamDemand::account(uint32_t nowMs) {
+    _stats.modeMs[(int)_mode] += nowMs - _accountedMs;
+    _accountedMs = nowMs;
+}
+
+void StreamDemand::resetStats() {
+    memset(&_stats, 0, sizeof(_stats));
+}
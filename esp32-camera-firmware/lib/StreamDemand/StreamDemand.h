@@ -0,0 +1,145 @@
+/**
+ * `StreamDemand.h`
+ * - Upload gate driven by the relay's consumer set (`DEMAND:<live>:<analyzer>`)
+ * - Live viewers: full rate (motion gate decides); analyzers only: one frame per
+ *   analyzerIntervalMs; nobody: no frames, the WebSocket heartbeat keeps the link
+ * - A richer mode is entered at once and its first frame skips the motion gate, so a new
+ *   viewer gets a picture within one frame interval; a poorer mode only after lingerMs
+ *   (page reloads and analyzer restarts do not flap the rate)
+ * - Until the relay sends a consumer set (older servers never do) the device stays live;
+ *   the first set after boot or reset() applies at once
+ * - Platform independent: time is passed in
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#ifndef STREAM_DEMAND_H
+#define STREAM_DEMAND_H
+
+#include <stdint.h>
+
+/**
+ * Demand configuration
+ */
+struct StreamDemandConfig {
+    uint32_t analyzerIntervalMs = 500;   // upload interval while only analyzers consume
+    uint32_t lingerMs = 5000;            // keep a mode this long after its last consumer left
+};
+
+/**
+ * Upload mode (richest first)
+ */
+enum class StreamMode : uint8_t {
+    Live,          // viewers watching: full rate
+    Analyzer,      // analyzers only: low rate
+    Idle,          // no consumers: heartbeat only
+    Count
+};
+
+/**
+ * Consumer set reported by the relay
+ */
+struct ConsumerSet {
+    uint16_t live;             // viewers showing the stream
+    uint16_t analyzer;         // analyzer clients (and viewers that only need events)
+};
+
+/**
+ * Demand statistics
+ */
+struct StreamDemandStats {
+    uint32_t updates;          // consumer sets received
+    uint32_t modeChanges;
+    uint32_t rampUps;          // changes to a richer mode
+    uint32_t sent;             // frames admitted
+    uint32_t suppressed;       // frames the motion gate would have uploaded
+    uint64_t suppressedBytes;  // ... and their size (egress saved)
+    uint32_t modeMs[(int)StreamMode::Count];   // time spent per mode
+};
+
+/**
+ * Consumer-driven upload gate
+ */
+class StreamDemand {
+public:
+    /**
+     * Constructor
+     * @param config Analyzer interval and ramp-down linger
+     */
+    explicit StreamDemand(const StreamDemandConfig& config);
+
+    /**
+     * Parse a `<live>:<analyzer>` argument
+     * @return false if malformed
+     */
+    static bool parse(const char* text, ConsumerSet& set);
+
+    static const char* modeName(StreamMode mode);
+
+    /**
+     * Mode a consumer set asks for
+     */
+    static StreamMode modeFor(const ConsumerSet& set);
+
+    /**
+     * Apply a consumer set from the relay
+     */
+    void setConsumers(const ConsumerSet& set, uint32_t nowMs);
+
+    /**
+     * Connection lost: back to live until the next relay tells otherwise
+     */
+    void reset(uint32_t nowMs);
+
+    /**
+     * Apply a pending ramp-down whose linger has expired
+     * @return Current mode
+     */
+    StreamMode update(uint32_t nowMs);
+
+    /**
+     * Decide on one captured frame (calls update())
+     * @param wanted The motion gate would upload it
+     * @param bytes Frame size (counted as saved egress when suppressed)
+     * @return Upload it
+     */
+    bool admit(bool wanted, uint32_t bytes, uint32_t nowMs);
+
+    StreamMode getMode() const { return _mode; }
+    const ConsumerSet& getConsumers() const { return _consumers; }
+    bool isSubscribed() const { return _subscribed; }
+
+    /**
+     * Mode a pending ramp-down will enter (== getMode() if none)
+     */
+    StreamMode getPendingMode() const { return _pendingMode; }
+
+    /**
+     * Time until the pending ramp-down (0 if none)
+     */
+    uint32_t getPendingMs(uint32_t nowMs) const;
+
+    const StreamDemandStats& getStats() const { return _stats; }
+    void resetStats();
+
+private:
+    void enter(StreamMode mode);
+    void account(uint32_t nowMs);
+
+    StreamDemandConfig _config;
+    ConsumerSet _consumers;
+    StreamMode _mode;
+    StreamMode _pendingMode;
+    bool _subscribed;
+    bool _rampUp;              // next frame skips the motion gate
+    bool _hasSent;
+    uint32_t _pendingSinceMs;
+    uint32_t _lastSentMs;
+    uint32_t _accountedMs;
+    StreamDemandStats _stats;
+};
+
+#endif // STREAM_DEMAND_H
@@ -0,0 +1,223 @@
+/**
+ * `StreamProfile.cpp`
+ * - Stream profile parsing and planning implementation
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#include "StreamProfile.h"
+
+#include <MemoryPlan.h>
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <strings.h>
+
+// esp32-camera framesize_t order
+static const char* const kFrameSizeNames[ProfilePlanner::kFrameSizeCount] = {
+    "96X96", "QQVGA", "QCIF", "HQVGA", "240X240", "QVGA", "CIF",
+    "HVGA", "VGA", "SVGA", "XGA", "HD", "SXGA", "UXGA",
+};
+
+// Dimensions and buffer sizes come from the memory planner (one table for both)
+static_assert(ProfilePlanner::kFrameSizeCount == MemoryPlan::kFrameSizeCount, "frame size tables differ");
+
+static const char* const kErrorNames[] = {
+    "none", "malformed", "frame_size", "quality", "interval", "xclk", "memory",
+};
+
+static const size_t kMaxNameLength = 7;    // "240X240"
+
+// ========================================
+// Constructor
+// ========================================
+ProfilePlanner::ProfilePlanner(const ProfileLimits& limits) : _limits(limits) {
+}
+
+// ========================================
+// Frame Sizes
+// ========================================
+uint32_t ProfilePlanner::frameBufferBytes(uint8_t frameSize) {
+    return MemoryPlan::frameBufferBytes(frameSize);
+}
+
+bool ProfilePlanner::frameSizeFromName(const char* name, size_t length, uint8_t& frameSize) {
+    if (name == NULL || length == 0 || length > kMaxNameLength) {
+        return false;
+    }
+    for (uint8_t i = 0; i < kFrameSizeCount; i++) {
+        if (kFrameSizeNames[i][length] == '\0' && strncasecmp(kFrameSizeNames[i], name, length) == 0) {
+            frameSize = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* ProfilePlanner::frameSizeName(uint8_t frameSize) {
+    return frameSize < kFrameSizeCount ? kFrameSizeNames[frameSize] : "?";
+}
+
+uint16_t ProfilePlanner::frameWidth(uint8_t frameSize) {
+    return MemoryPlan::frameWidth(frameSize);
+}
+
+uint16_t ProfilePlanner::frameHeight(uint8_t frameSize) {
+    return MemoryPlan::frameHeight(frameSize);
+}
+
+const char* ProfilePlanner::errorName(ProfileError error) {
+    return (size_t)error < sizeof(kErrorNames) / sizeof(kErrorNames[0]) ? kErrorNames[(size_t)error] : "?";
+}
+
+// ========================================
+// Parsing
+// ========================================
+ProfileError ProfilePlanner::parse(const char* text, StreamProfile& profile) {
+    if (text == NULL) {
+        return ProfileError::Malformed;
+    }
+    const char* colon = text;
+    while (*colon != '\0' && *colon != ':') {
+        colon++;
+    }
+    if (*colon != ':' || colon == text) {
+        return ProfileError::Malformed;
+    }
+
+    unsigned quality = 0, interval = 0, xclk = 0;
+    int consumed = 0;
+    if (sscanf(colon + 1, "%u:%u%n", &quality, &interval, &consumed) != 2) {
+        return ProfileError::Malformed;
+    }
+    const char* rest = colon + 1 + consumed;
+    if (*rest == ':') {
+        int more = 0;
+        if (sscanf(rest + 1, "%u%n", &xclk, &more) != 1 || xclk == 0) {
+            return ProfileError::Malformed;
+        }
+        rest += 1 + more;
+    }
+    // Digits only: sscanf also takes signs and leading blanks
+    for (const char* p = colon + 1; p < rest; p++) {
+        if ((*p < '0' || *p > '9') && *p != ':') {
+            return ProfileError::Malformed;
+        }
+    }
+    if (*rest != '\0' || quality > 0xFF || interval > 0xFFFFFF || xclk > 0xFF) {
+        return ProfileError::Malformed;
+    }
+
+    uint8_t frameSize = 0;
+    if (!frameSizeFromName(text, (size_t)(colon - text), frameSize)) {
+        return ProfileError::FrameSize;
+    }
+    profile.frameSize = frameSize;
+    profile.jpegQuality = (uint8_t)quality;
+    profile.intervalMs = interval;
+    profile.xclkMhz = (uint8_t)xclk;
+    return ProfileError::None;
+}
+
+// ========================================
+// Planning
+// ========================================
+ProfileError ProfilePlanner::plan(const StreamProfile& profile, const CameraCaps& caps, ProfilePlan& plan) const {
+    if (profile.frameSize >= kFrameSizeCount || profile.frameSize > caps.maxFrameSize) {
+        return ProfileError::FrameSize;
+    }
+    if (profile.jpegQuality < _limits.minQuality || profile.jpegQuality > _limits.maxQuality) {
+        return ProfileError::Quality;
+    }
+    if (profile.intervalMs < _limits.minIntervalMs || profile.intervalMs > _limits.maxIntervalMs) {
+        return ProfileError::Interval;
+    }
+    uint8_t xclkMhz = profile.xclkMhz != 0 ? profile.xclkMhz : caps.xclkMhz;
+    if (xclkMhz < _limits.minXclkMhz || xclkMhz > _limits.maxXclkMhz) {
+        return ProfileError::Xclk;
+    }
+
+    ProfilePlan result;
+    result.profile = profile;
+    result.profile.xclkMhz = xclkMhz;
+    result.xclkChange = xclkMhz != caps.xclkMhz;
+    uint32_t currentBytes = frameBufferBytes(caps.fbFrameSize);
+    uint32_t neededBytes = frameBufferBytes(profile.frameSize);
+
+    // Fits the current buffers: a live switch
+    if (neededBytes <= currentBytes) {
+        result.reinit = false;
+        result.fbFrameSize = caps.fbFrameSize;
+        result.fbCount = caps.fbCount;
+        result.fbBytes = currentBytes * caps.fbCount;
+        plan = result;
+        return ProfileError::None;
+    }
+
+    // Larger buffers: the old ones are freed first, and each new one must fit a free block
+    uint64_t available = (uint64_t)caps.fbFreeBytes + (uint64_t)currentBytes * caps.fbCount;
+    available = available > _limits.reserveBytes ? available - _limits.reserveBytes : 0;
+    uint8_t count = caps.fbCount;
+    while (count > _limits.minFbCount && (uint64_t)neededBytes * count > available) {
+        count--;
+    }
+    if (count == 0 || (uint64_t)neededBytes * count > available || neededBytes > caps.fbLargestFree) {
+        return ProfileError::Memory;
+    }
+    result.reinit = true;
+    result.fbFrameSize = profile.frameSize;
+    result.fbCount = count;
+    result.fbBytes = neededBytes * count;
+    plan = result;
+    return ProfileError::None;
+}
+
+// ========================================
+// Capabilities
+// ========================================
+/**
+ * Append printf output at `length` (sets length past capacity on overflow)
+ */
+static void appendf(char* out, size_t capacity, size_t& length, const char* format, ...)
+    __attribute__((format(printf, 4, 5)));
+
+static void appendf(char* out, size_t capacity, size_t& length, const char* format, ...) {
+    if (length >= capacity) {
+        return;
+    }
+    va_list args;
+    va_start(args, format);
+    int written = vsnprintf(out + length, capacity - length, format, args);
+    va_end(args);
+    length = written < 0 ? capacity : length + (size_t)written;
+}
+
+size_t ProfilePlanner::formatCaps(const CameraCaps& caps, char* out, size_t capacity) const {
+    if (out == NULL || capacity == 0) {
+        return 0;
+    }
+    size_t length = 0;
+    appendf(out, capacity, length, "CAPS:{\"sensor\":\"%s\",\"pid\":%u,\"jpeg\":%s,\"frameSizes\":[",
+            caps.sensorName != NULL ? caps.sensorName : "unknown", caps.sensorPid, caps.jpeg ? "true" : "false");
+    for (uint8_t i = 0; i <= caps.maxFrameSize && i < kFrameSizeCount; i++) {
+        appendf(out, capacity, length, "%s\"%s\"", i > 0 ? "," : "", kFrameSizeNames[i]);
+    }
+    uint32_t fbBytes = frameBufferBytes(caps.fbFrameSize);
+    appendf(out, capacity, length,
+            "],\"psram\":%u,\"fb\":{\"count\":%u,\"location\":\"%s\",\"frameSize\":\"%s\",\"bytes\":%u,"
+            "\"free\":%u,\"largestFree\":%u},\"xclkMhz\":%u,",
+            caps.psramBytes, caps.fbCount, caps.fbInPsram ? "PSRAM" : "DRAM", frameSizeName(caps.fbFrameSize),
+            fbBytes * caps.fbCount, caps.fbFreeBytes, caps.fbLargestFree, caps.xclkMhz);
+    appendf(out, capacity, length,
+            "\"limits\":{\"quality\":[%u,%u],\"intervalMs\":[%u,%u],\"xclkMhz\":[%u,%u]}}",
+            _limits.minQuality, _limits.maxQuality, _limits.minIntervalMs, _limits.maxIntervalMs,
+            _limits.minXclkMhz, _limits.maxXclkMhz);
+    if (length >= capacity) {
+        out[0] = '\0';
+        return 0;
+    }
+    return length;
+}
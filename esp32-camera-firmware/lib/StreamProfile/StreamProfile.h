@@ -0,0 +1,143 @@
+/**
+ * `StreamProfile.h`
+ * - Stream profile negotiation: what the camera can do (CAPS) and what the server asks for
+ *   (`PROFILE:<size>:<quality>:<intervalMs>[:<xclkMhz>]`)
+ * - A profile is checked against the advertised capabilities and planned before anything
+ *   touches the driver:
+ *   - frame sizes up to the one the frame buffers were allocated for switch live
+ *     (set_framesize), like the ABR ladder does
+ *   - a larger frame size needs new frame buffers (driver re-init); the buffers never
+ *     shrink again, so switching back down is live
+ *   - the buffer count is reduced when the new buffers would not fit the free memory
+ * - Frame size values and names follow esp32-camera framesize_t (96X96 .. UXGA)
+ * - Platform independent: the caller reads the capabilities from the driver and applies the plan
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#ifndef STREAM_PROFILE_H
+#define STREAM_PROFILE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Requested stream settings
+ */
+struct StreamProfile {
+    uint8_t frameSize;         // framesize_t value
+    uint8_t jpegQuality;       // 0-63, lower = better quality, more bytes
+    uint32_t intervalMs;       // frame interval
+    uint8_t xclkMhz;           // sensor clock (0 = keep the current one)
+};
+
+/**
+ * Camera capabilities (advertised on connect as `CAPS:{json}`)
+ */
+struct CameraCaps {
+    const char* sensorName;    // driver's sensor name ("OV2640", ...)
+    uint16_t sensorPid;
+    uint8_t maxFrameSize;      // largest framesize_t the sensor supports
+    bool jpeg;                 // sensor encodes JPEG itself
+    uint32_t psramBytes;       // 0 = no PSRAM
+    uint8_t fbCount;           // frame buffers allocated
+    bool fbInPsram;
+    uint8_t fbFrameSize;       // frame size the buffers were allocated for
+    uint32_t fbFreeBytes;      // free memory where the buffers live (besides them)
+    uint32_t fbLargestFree;    // largest free block there
+    uint8_t xclkMhz;
+};
+
+/**
+ * Accepted ranges
+ */
+struct ProfileLimits {
+    uint8_t minQuality = 4;            // below this the OV2640 overflows its JPEG buffer
+    uint8_t maxQuality = 63;
+    uint32_t minIntervalMs = 33;       // 30 FPS
+    uint32_t maxIntervalMs = 10000;
+    uint8_t minXclkMhz = 8;
+    uint8_t maxXclkMhz = 25;
+    uint8_t minFbCount = 1;            // fewer buffers than this: rejected as Memory
+    uint32_t reserveBytes = 32 * 1024; // left free after new buffers are allocated
+};
+
+/**
+ * Why a profile was rejected
+ */
+enum class ProfileError : uint8_t {
+    None,
+    Malformed,         // not `<size>:<quality>:<intervalMs>[:<xclkMhz>]`
+    FrameSize,         // unknown or beyond the sensor
+    Quality,
+    Interval,
+    Xclk,
+    Memory             // frame buffers for it do not fit
+};
+
+/**
+ * How to apply an accepted profile
+ */
+struct ProfilePlan {
+    StreamProfile profile;     // xclkMhz filled in
+    bool reinit;               // frame buffers must be reallocated (driver re-init)
+    bool xclkChange;           // sensor clock changes (set_xclk)
+    uint8_t fbFrameSize;       // buffers after the switch
+    uint8_t fbCount;
+    uint32_t fbBytes;          // all buffers
+};
+
+/**
+ * Profile parser and planner
+ */
+class ProfilePlanner {
+public:
+    static constexpr uint8_t kFrameSizeCount = 14;     // FRAMESIZE_96X96 .. FRAMESIZE_UXGA
+    static constexpr size_t kMaxCaps = 512;            // CAPS message buffer
+
+    explicit ProfilePlanner(const ProfileLimits& limits);
+
+    /**
+     * Parse `<size>:<quality>:<intervalMs>[:<xclkMhz>]` (size by name, e.g. `VGA:12:100`)
+     * @return ProfileError::None, Malformed or FrameSize (unknown name)
+     */
+    static ProfileError parse(const char* text, StreamProfile& profile);
+
+    /**
+     * Check a profile against the limits and capabilities and plan the switch
+     * @return ProfileError::None if it can be applied (plan is filled)
+     */
+    ProfileError plan(const StreamProfile& profile, const CameraCaps& caps, ProfilePlan& plan) const;
+
+    /**
+     * Render `CAPS:{json}` (capabilities and the accepted ranges, NUL-terminated)
+     * @return Length, or 0 if it does not fit
+     */
+    size_t formatCaps(const CameraCaps& caps, char* out, size_t capacity) const;
+
+    /**
+     * Frame buffer size the driver allocates for a JPEG frame size (width × height / 5)
+     */
+    static uint32_t frameBufferBytes(uint8_t frameSize);
+
+    /**
+     * Frame size by name (case-insensitive)
+     * @return false if unknown
+     */
+    static bool frameSizeFromName(const char* name, size_t length, uint8_t& frameSize);
+
+    static const char* frameSizeName(uint8_t frameSize);
+    static uint16_t frameWidth(uint8_t frameSize);
+    static uint16_t frameHeight(uint8_t frameSize);
+    static const char* errorName(ProfileError error);
+
+    const ProfileLimits& getLimits() const { return _limits; }
+
+private:
+    ProfileLimits _limits;
+};
+
+#endif // STREAM_PROFILE_H
@@ -0,0 +1,126 @@
+/**
+ * `Histogram.cpp`
+ * - Lock-free log-linear histogram implementation
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#include "Histogram.h"
+
+Histogram::Histogram() {
+    reset();
+}
+
+// ========================================
+// Bucket Mapping
+// ========================================
+size_t Histogram::bucketIndex(uint32_t value) {
+    if (value < kSubBuckets) {
+        return value;
+    }
+    uint32_t msb = 31 - (uint32_t)__builtin_clz(value);
+    uint32_t shift = msb - kSubBucketBits;
+    uint32_t sub = (value >> shift) & (kSubBuckets - 1);
+    return (size_t)(msb - kSubBucketBits + 1) * kSubBuckets + sub;
+}
+
+uint32_t Histogram::bucketLowerBound(size_t index) {
+    if (index < kSubBuckets) {
+        return (uint32_t)index;
+    }
+    uint32_t shift = (uint32_t)(index / kSubBuckets) - 1;
+    uint32_t sub = (uint32_t)(index % kSubBuckets);
+    return (kSubBuckets + sub) << shift;
+}
+
+uint32_t Histogram::bucketUpperBound(size_t index) {
+    if (index < kSubBuckets) {
+        return (uint32_t)index;
+    }
+    uint32_t shift = (uint32_t)(index / kSubBuckets) - 1;
+    return bucketLowerBound(index) + ((1u << shift) - 1);
+}
+
+// ========================================
+// Recording
+// ========================================
+void Histogram::record(uint32_t value) {
+    _buckets[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+    _count.fetch_add(1, std::memory_order_relaxed);
+    _sum.fetch_add(value, std::memory_order_relaxed);
+
+    uint32_t current = _min.load(std::memory_order_relaxed);
+    while (value < current && !_min.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+    current = _max.load(std::memory_order_relaxed);
+    while (value > current && !_max.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+void Histogram::reset() {
+    for (size_t i = 0; i < kBucketCount; i++) {
+        _buckets[i].store(0, std::memory_order_relaxed);
+    }
+    _count.store(0, std::memory_order_relaxed);
+    _sum.store(0, std::memory_order_relaxed);
+    _min.store(UINT32_MAX, std::memory_order_relaxed);
+    _max.store(0, std::memory_order_relaxed);
+}
+
+// ========================================
+// Queries
+// ========================================
+uint32_t Histogram::percentileOf(const uint32_t* buckets, uint32_t total, float percentile, uint32_t max) const {
+    if (total == 0) {
+        return 0;
+    }
+    // Rank of the sample at this percentile (1-based, nearest-rank)
+    uint32_t rank = (uint32_t)(percentile / 100.0f * (float)total + 0.999f);
+    if (rank < 1) rank = 1;
+    if (rank > total) rank = total;
+
+    uint32_t seen = 0;
+    for (size_t i = 0; i < kBucketCount; i++) {
+        seen += buckets[i];
+        if (seen >= rank) {
+            uint32_t upper = bucketUpperBound(i);
+            return upper < max ? upper : max;
+        }
+    }
+    return max;
+}
+
+uint32_t Histogram::percentile(float percentile) const {
+    uint32_t buckets[kBucketCount];
+    uint32_t total = 0;
+    for (size_t i = 0; i < kBucketCount; i++) {
+        buckets[i] = _buckets[i].load(std::memory_order_relaxed);
+        total += buckets[i];
+    }
+    return percentileOf(buckets, total, percentile, _max.load(std::memory_order_relaxed));
+}
+
+HistogramSummary Histogram::summarize() const {
+    HistogramSummary summary = {};
+    uint32_t buckets[kBucketCount];
+    uint32_t total = 0;
+    for (size_t i = 0; i < kBucketCount; i++) {
+        buckets[i] = _buckets[i].load(std::memory_order_relaxed);
+        total += buckets[i];
+    }
+    if (total == 0) {
+        return summary;
+    }
+    uint32_t count = _count.load(std::memory_order_relaxed);
+    summary.count = total;
+    summary.min = _min.load(std::memory_order_relaxed);
+    summary.max = _max.load(std::memory_order_relaxed);
+    summary.mean = count > 0 ? _sum.load(std::memory_order_relaxed) / count : 0;
+    summary.p50 = percentileOf(buckets, total, 50.0f, summary.max);
+    summary.p90 = percentileOf(buckets, total, 90.0f, summary.max);
+    summary.p99 = percentileOf(buckets, total, 99.0f, summary.max);
+    return summary;
+}
@@ -0,0 +1,86 @@
+/**
+ * `Histogram.h`
+ * - Fixed-memory, lock-free histogram of uint32 samples (latencies in us, sizes in bytes)
+ * - Log-linear buckets: exact below 8, then 8 sub-buckets per power of two
+ *   (≤ 12.5% relative error on percentiles, full uint32 range in 240 buckets)
+ * - record() is wait-free apart from the min/max CAS and safe from any task/core;
+ *   only 32-bit atomics are used so it stays lock-free on the ESP32 (Xtensa S32C1I)
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+
+/**
+ * Summary of a histogram window
+ */
+struct HistogramSummary {
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint32_t mean;
+    uint32_t p50;
+    uint32_t p90;
+    uint32_t p99;
+};
+
+/**
+ * Log-linear histogram
+ */
+class Histogram {
+public:
+    static constexpr uint32_t kSubBucketBits = 3;
+    static constexpr uint32_t kSubBuckets = 1u << kSubBucketBits;
+    static constexpr size_t kBucketCount = (32 - kSubBucketBits + 1) * kSubBuckets;
+
+    Histogram();
+
+    /**
+     * Add one sample
+     */
+    void record(uint32_t value);
+
+    /**
+     * Clear all samples (concurrent record() calls may land on either side)
+     */
+    void reset();
+
+    /**
+     * Value at the given percentile (upper bound of its bucket, clamped to max)
+     * @param percentile 0..100
+     */
+    uint32_t percentile(float percentile) const;
+
+    HistogramSummary summarize() const;
+    uint32_t getCount() const { return _count.load(std::memory_order_relaxed); }
+
+    /**
+     * Bucket mapping (public for tests)
+     */
+    static size_t bucketIndex(uint32_t value);
+    static uint32_t bucketLowerBound(size_t index);
+    static uint32_t bucketUpperBound(size_t index);
+
+private:
+    /**
+     * Percentiles from a bucket copy (one consistent pass for summarize())
+     */
+    uint32_t percentileOf(const uint32_t* buckets, uint32_t total, float percentile, uint32_t max) const;
+
+    std::atomic<uint32_t> _buckets[kBucketCount];
+    std::atomic<uint32_t> _count;
+    std::atomic<uint32_t> _sum;        // wraps after 2^32 (windows are reset long before)
+    std::atomic<uint32_t> _min;
+    std::atomic<uint32_t> _max;
+};
+
+#endif // HISTOGRAM_H
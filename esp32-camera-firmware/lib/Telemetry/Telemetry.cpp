@@ -0,0 +1,166 @@
+/**
+ * `Telemetry.cpp`
+ * - Telemetry aggregation and STATS snapshot formatting
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#include "Telemetry.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+namespace {
+
+const char* const kMetricKeys[] = { "capUs", "sendUs", "loopUs", "frameB", "jitUs", "gapUs" };
+const char* const kBootKeys[] = { "camMs", "wifiMs", "wsMs", "frameMs" };
+const char kCommand[] = "STATS";
+
+/**
+ * Append printf output, tracking overflow
+ */
+bool append(char* out, size_t capacity, size_t& used, const char* format, ...) __attribute__((format(printf, 4, 5)));
+
+bool append(char* out, size_t capacity, size_t& used, const char* format, ...) {
+    if (used >= capacity) {
+        return false;
+    }
+    va_list args;
+    va_start(args, format);
+    int written = vsnprintf(out + used, capacity - used, format, args);
+    va_end(args);
+    if (written < 0 || (size_t)written >= capacity - used) {
+        used = capacity;
+        return false;
+    }
+    used += (size_t)written;
+    return true;
+}
+
+}  // namespace
+
+Telemetry::Telemetry(const TelemetryConfig& config)
+    : _config(config),
+      _freeHeap(0),
+      _minFreeHeap(UINT32_MAX),
+      _freePsram(0),
+      _minFreePsram(UINT32_MAX),
+      _connects(0),
+      _reconnects(0),
+      _sendFailures(0),
+      _windowSendFailures(0),
+      _allocations(0),
+      _cachedJoin(false),
+      _windowAllocations(0),
+      _windowStartUs(0) {
+    for (size_t i = 0; i < (size_t)BootStage::Count; i++) {
+        _bootMs[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+// ========================================
+// Recording
+// ========================================
+void Telemetry::record(Metric metric, uint32_t value) {
+    _histograms[(size_t)metric].record(value);
+}
+
+void Telemetry::lowerTo(std::atomic<uint32_t>& watermark, uint32_t value) {
+    uint32_t current = watermark.load(std::memory_order_relaxed);
+    while (value < current && !watermark.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+void Telemetry::sampleMemory(uint32_t freeHeap, uint32_t freePsram) {
+    _freeHeap.store(freeHeap, std::memory_order_relaxed);
+    lowerTo(_minFreeHeap, freeHeap);
+    _freePsram.store(freePsram, std::memory_order_relaxed);
+    lowerTo(_minFreePsram, freePsram);
+}
+
+void Telemetry::sampleAllocations(uint32_t total) {
+    _allocations.store(total, std::memory_order_relaxed);
+}
+
+void Telemetry::onConnect() {
+    if (_connects.fetch_add(1, std::memory_order_relaxed) > 0) {
+        _reconnects.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void Telemetry::onSendFailure() {
+    _sendFailures.fetch_add(1, std::memory_order_relaxed);
+    _windowSendFailures.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Telemetry::recordBoot(BootStage stage, uint32_t ms) {
+    uint32_t expected = 0;
+    // 0 marks "not reached": a milestone at reset time still reads as reached
+    _bootMs[(size_t)stage].compare_exchange_strong(expected, ms > 0 ? ms : 1, std::memory_order_relaxed);
+}
+
+// ========================================
+// Snapshot
+// ========================================
+bool Telemetry::publishDue(uint64_t nowUs) const {
+    return _config.publishIntervalMs > 0 &&
+           nowUs - _windowStartUs >= (uint64_t)_config.publishIntervalMs * 1000;
+}
+
+size_t Telemetry::format(char* out, size_t capacity, uint64_t nowUs) const {
+    size_t used = 0;
+    append(out, capacity, used, "STATS:{\"v\":%u,\"upMs\":%llu,\"winMs\":%llu",
+           kVersion, (unsigned long long)(nowUs / 1000),
+           (unsigned long long)((nowUs - _windowStartUs) / 1000));
+
+    for (size_t i = 0; i < (size_t)Metric::Count; i++) {
+        HistogramSummary h = _histograms[i].summarize();
+        append(out, capacity, used,
+               ",\"%s\":{\"n\":%u,\"min\":%u,\"avg\":%u,\"p50\":%u,\"p90\":%u,\"p99\":%u,\"max\":%u}",
+               kMetricKeys[i], h.count, h.min, h.mean, h.p50, h.p90, h.p99, h.max);
+    }
+
+    uint32_t minHeap = _minFreeHeap.load(std::memory_order_relaxed);
+    uint32_t minPsram = _minFreePsram.load(std::memory_order_relaxed);
+    uint32_t allocations = _allocations.load(std::memory_order_relaxed);
+    append(out, capacity, used,
+           ",\"heap\":{\"free\":%u,\"min\":%u},\"psram\":{\"free\":%u,\"min\":%u}"
+           ",\"reconnects\":%u,\"sendFail\":{\"win\":%u,\"total\":%u},\"allocs\":{\"win\":%u,\"total\":%u}",
+           _freeHeap.load(std::memory_order_relaxed), minHeap == UINT32_MAX ? 0 : minHeap,
+           _freePsram.load(std::memory_order_relaxed), minPsram == UINT32_MAX ? 0 : minPsram,
+           _reconnects.load(std::memory_order_relaxed),
+           _windowSendFailures.load(std::memory_order_relaxed),
+           _sendFailures.load(std::memory_order_relaxed),
+           allocations - _windowAllocations, allocations);
+
+    append(out, capacity, used, ",\"boot\":{");
+    for (size_t i = 0; i < (size_t)BootStage::Count; i++) {
+        append(out, capacity, used, "\"%s\":%u,", kBootKeys[i], _bootMs[i].load(std::memory_order_relaxed));
+    }
+    append(out, capacity, used, "\"cachedJoin\":%s}}", _cachedJoin.load(std::memory_order_relaxed) ? "true" : "false");
+
+    if (used >= capacity) {
+        if (capacity > 0) {
+            out[0] = '\0';
+        }
+        return 0;
+    }
+    return used;
+}
+
+void Telemetry::resetWindow(uint64_t nowUs) {
+    for (size_t i = 0; i < (size_t)Metric::Count; i++) {
+        _histograms[i].reset();
+    }
+    _windowSendFailures.store(0, std::memory_order_relaxed);
+    _windowAllocations = _allocations.load(std::memory_order_relaxed);
+    _windowStartUs = nowUs;
+}
+
+bool Telemetry::isCommand(const char* message, size_t length) {
+    return length == sizeof(kCommand) - 1 && memcmp(message, kCommand, length) == 0;
+}
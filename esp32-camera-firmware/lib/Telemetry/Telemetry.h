@@ -0,0 +1,155 @@
+/**
+ * `Telemetry.h`
+ * - Runtime telemetry: per-stage histograms, memory watermarks and link counters
+ * - Fixed memory, no allocation after construction; record*() calls are lock-free and
+ *   may come from the capture task, the network task and loop() concurrently
+ * - format() renders a compact `STATS:{json}` snapshot into a caller buffer; it is
+ *   sent on the `STATS` text command and every publish interval
+ * - Boot milestones (ms since reset) show how long a reset keeps the camera blind
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+
+#include "Histogram.h"
+
+/**
+ * Histogram channels
+ */
+enum class Metric : uint8_t {
+    CaptureUs,      // esp_camera_fb_get() duration
+    SendUs,         // WebSocket send duration (successful sends)
+    LoopUs,         // busy time of one WebSocket-owning loop iteration
+    FrameBytes,     // size of sent frames
+    PaceJitterUs,   // frame pacing lateness (tick time - deadline)
+    ServiceGapUs,   // time between WebSocket services (how long an incoming command can wait)
+    Count
+};
+
+/**
+ * Boot milestones, in the order they are normally reached
+ */
+enum class BootStage : uint8_t {
+    Camera,         // esp_camera_init() done
+    WiFi,           // station associated with an IP
+    Socket,         // WebSocket connected
+    FirstFrame,     // first frame sent (the boot-to-first-frame time)
+    Count
+};
+
+/**
+ * Telemetry configuration
+ */
+struct TelemetryConfig {
+    uint32_t publishIntervalMs = 10000;    // periodic snapshot (0 = only on STATS command)
+};
+
+/**
+ * Telemetry aggregator
+ */
+class Telemetry {
+public:
+    static constexpr uint8_t kVersion = 1;
+    static constexpr size_t kMaxSnapshot = 1024;   // format() output incl. "STATS:" prefix
+
+    explicit Telemetry(const TelemetryConfig& config);
+
+    /**
+     * Add one sample to a histogram channel
+     */
+    void record(Metric metric, uint32_t value);
+
+    /**
+     * Sample free memory (keeps the current value and the low watermark since boot)
+     */
+    void sampleMemory(uint32_t freeHeap, uint32_t freePsram);
+
+    /**
+     * Sample the heap allocation counter (AllocCounter; the window delta should stay 0 while streaming)
+     */
+    void sampleAllocations(uint32_t total);
+
+    /**
+     * WebSocket connected (every connect after the first counts as a reconnect)
+     */
+    void onConnect();
+
+    void onSendFailure();
+
+    /**
+     * Boot milestone reached (only the first report per stage is kept)
+     * @param ms Time since reset
+     */
+    void recordBoot(BootStage stage, uint32_t ms);
+
+    /**
+     * The first association reused the cached BSSID/channel (no scan)
+     */
+    void markCachedJoin() { _cachedJoin.store(true, std::memory_order_relaxed); }
+
+    /**
+     * Check if a periodic snapshot is due
+     */
+    bool publishDue(uint64_t nowUs) const;
+
+    /**
+     * Render the snapshot of the current window
+     * - Histograms cover the window since the last resetWindow(); counters and
+     *   watermarks are totals since boot
+     * @return Length written (0 if the buffer is too small)
+     */
+    size_t format(char* out, size_t capacity, uint64_t nowUs) const;
+
+    /**
+     * Start a new histogram window (after a snapshot was published)
+     */
+    void resetWindow(uint64_t nowUs);
+
+    /**
+     * Check if a text message is the STATS command
+     */
+    static bool isCommand(const char* message, size_t length);
+
+    const Histogram& getHistogram(Metric metric) const { return _histograms[(size_t)metric]; }
+    uint32_t getReconnects() const { return _reconnects.load(std::memory_order_relaxed); }
+    uint32_t getSendFailures() const { return _sendFailures.load(std::memory_order_relaxed); }
+    uint32_t getMinFreeHeap() const { return _minFreeHeap.load(std::memory_order_relaxed); }
+    uint32_t getMinFreePsram() const { return _minFreePsram.load(std::memory_order_relaxed); }
+    uint32_t getAllocations() const { return _allocations.load(std::memory_order_relaxed); }
+
+    /**
+     * @return Milestone time in ms since reset, 0 if not reached yet
+     */
+    uint32_t getBootMs(BootStage stage) const { return _bootMs[(size_t)stage].load(std::memory_order_relaxed); }
+
+private:
+    static void lowerTo(std::atomic<uint32_t>& watermark, uint32_t value);
+
+    TelemetryConfig _config;
+    Histogram _histograms[(size_t)Metric::Count];
+    std::atomic<uint32_t> _freeHeap;
+    std::atomic<uint32_t> _minFreeHeap;
+    std::atomic<uint32_t> _freePsram;
+    std::atomic<uint32_t> _minFreePsram;
+    std::atomic<uint32_t> _connects;
+    std::atomic<uint32_t> _reconnects;
+    std::atomic<uint32_t> _sendFailures;
+    std::atomic<uint32_t> _windowSendFailures;
+    std::atomic<uint32_t> _allocations;
+    std::atomic<uint32_t> _bootMs[(size_t)BootStage::Count];
+    std::atomic<bool> _cachedJoin;
+    uint32_t _windowAllocations;       // _allocations at the window start
+    uint64_t _windowStartUs;           // owned by the publishing context
+};
+
+#endif // TELEMETRY_H
@@ -0,0 +1,92 @@
+/**
+ * `WifiCache.cpp`
+ * - Cached association record encoding
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#include "WifiCache.h"
+
+#include <string.h>
+
+static const uint8_t kMagic[2] = {'W', 'C'};
+
+static uint32_t crc32(const uint8_t* data, size_t length) {
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < length; i++) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+        }
+    }
+    return ~crc;
+}
+
+static void putU32(uint8_t* out, uint32_t value) {
+    out[0] = (uint8_t)value;
+    out[1] = (uint8_t)(value >> 8);
+    out[2] = (uint8_t)(value >> 16);
+    out[3] = (uint8_t)(value >> 24);
+}
+
+static uint32_t getU32(const uint8_t* in) {
+    return (uint32_t)in[0] | ((uint32_t)in[1] << 8) | ((uint32_t)in[2] << 16) | ((uint32_t)in[3] << 24);
+}
+
+uint32_t WifiCache::hashSsid(const char* ssid) {
+    uint32_t hash = 2166136261u;
+    for (const char* p = ssid; p != NULL && *p != '\0'; p++) {
+        hash = (hash ^ (uint8_t)*p) * 16777619u;
+    }
+    return hash;
+}
+
+bool WifiCache::isValidFor(const char* ssid) const {
+    return channel >= 1 && channel <= 14 && ssidHash == hashSsid(ssid);
+}
+
+// ========================================
+// Encoding
+// ========================================
+// [0] 'W' 'C'  [2] version  [3] channel  [4] bssid (6)  [10] ssidHash  [14] localIp
+// [18] gateway  [22] subnet  [26] dns  [30] CRC-32 of bytes 0..29
+size_t WifiCache::encode(uint8_t* out, size_t capacity) const {
+    if (capacity < kEncodedSize) {
+        return 0;
+    }
+    out[0] = kMagic[0];
+    out[1] = kMagic[1];
+    out[2] = kVersion;
+    out[3] = channel;
+    memcpy(out + 4, bssid, sizeof(bssid));
+    putU32(out + 10, ssidHash);
+    putU32(out + 14, localIp);
+    putU32(out + 18, gateway);
+    putU32(out + 22, subnet);
+    putU32(out + 26, dns);
+    putU32(out + 30, crc32(out, 30));
+    return kEncodedSize;
+}
+
+bool WifiCache::decode(const uint8_t* data, size_t length) {
+    clear();
+    if (data == NULL || length != kEncodedSize || data[0] != kMagic[0] || data[1] != kMagic[1] ||
+        data[2] != kVersion || getU32(data + 30) != crc32(data, 30)) {
+        return false;
+    }
+    channel = data[3];
+    memcpy(bssid, data + 4, sizeof(bssid));
+    ssidHash = getU32(data + 10);
+    localIp = getU32(data + 14);
+    gateway = getU32(data + 18);
+    subnet = getU32(data + 22);
+    dns = getU32(data + 26);
+    return true;
+}
+
+void WifiCache::clear() {
+    memset(this, 0, sizeof(*this));
+}
@@ -0,0 +1,63 @@
+/**
+ * `WifiCache.h`
+ * - Last successful association (BSSID, channel, DHCP lease), kept in NVS across resets
+ * - With a valid record the station joins the known AP directly (no channel scan) and may
+ *   reuse the lease as a static IP (no DHCP exchange)
+ * - Fixed little-endian blob with a CRC: a record written by another SSID or cut by a
+ *   brownout mid-write is rejected
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#ifndef WIFI_CACHE_H
+#define WIFI_CACHE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Cached association
+ */
+struct WifiCache {
+    static constexpr size_t kEncodedSize = 34;
+    static constexpr uint8_t kVersion = 1;
+
+    uint8_t bssid[6];
+    uint8_t channel;           // 1-14, 0 = empty
+    uint32_t ssidHash;         // hashSsid() of the network it was learned on
+    uint32_t localIp;          // DHCP lease (IPAddress value, 0 = none)
+    uint32_t gateway;
+    uint32_t subnet;
+    uint32_t dns;
+
+    /**
+     * FNV-1a of the SSID (the SSID itself is not stored)
+     */
+    static uint32_t hashSsid(const char* ssid);
+
+    /**
+     * Record usable for a cached join to this SSID
+     */
+    bool isValidFor(const char* ssid) const;
+
+    bool hasLease() const { return localIp != 0 && subnet != 0; }
+
+    /**
+     * Serialize for NVS
+     * @return kEncodedSize, or 0 if the buffer is too small
+     */
+    size_t encode(uint8_t* out, size_t capacity) const;
+
+    /**
+     * Parse an NVS blob (the record is left empty on failure)
+     * @return false on wrong size, magic, version or CRC
+     */
+    bool decode(const uint8_t* data, size_t length);
+
+    void clear();
+};
+
+#endif // WIFI_CACHE_H
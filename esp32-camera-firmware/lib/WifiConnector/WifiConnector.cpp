@@ -0,0 +1,110 @@
+/**
+ * `WifiConnector.cpp`
+ * - Station association state machine implementation
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#include "WifiConnector.h"
+
+// ========================================
+// Constructor
+// ========================================
+WifiConnector::WifiConnector(const WifiConnectorConfig& config)
+    : _config(config), _phase(WifiPhase::Idle), _cacheUsable(false), _cachedFailures(0),
+      _attemptStartMs(0), _nextAttemptMs(0), _backoffMs(0), _stats() {
+}
+
+// ========================================
+// State Machine
+// ========================================
+WifiEvent WifiConnector::begin(bool cacheValid, uint32_t nowMs) {
+    _cacheUsable = cacheValid;
+    _cachedFailures = 0;
+    _backoffMs = 0;
+    return startAttempt(_cacheUsable, nowMs);
+}
+
+WifiEvent WifiConnector::startAttempt(bool cached, uint32_t nowMs) {
+    _phase = cached ? WifiPhase::Cached : WifiPhase::Scan;
+    _attemptStartMs = nowMs;
+    _stats.attempts++;
+    if (cached) {
+        _stats.cachedAttempts++;
+    }
+    return cached ? WifiEvent::BeginCached : WifiEvent::BeginScan;
+}
+
+WifiEvent WifiConnector::update(bool associated, uint32_t nowMs) {
+    if (_phase == WifiPhase::Idle) {
+        return WifiEvent::None;
+    }
+
+    if (associated) {
+        if (_phase == WifiPhase::Connected) {
+            return WifiEvent::None;
+        }
+        // Backoff included: the driver may still finish the attempt that timed out
+        _stats.lastJoinCached = _phase == WifiPhase::Cached;
+        if (_stats.lastJoinCached) {
+            _stats.cachedConnects++;
+        } else {
+            _stats.scanConnects++;
+        }
+        _stats.lastJoinMs = nowMs - _attemptStartMs;
+        _phase = WifiPhase::Connected;
+        _cachedFailures = 0;
+        _backoffMs = 0;
+        return WifiEvent::Connected;
+    }
+
+    uint32_t elapsedMs = nowMs - _attemptStartMs;
+    switch (_phase) {
+        case WifiPhase::Connected:
+            // The AP we just left is the best guess: rejoin it without a scan if cached
+            _stats.lost++;
+            _phase = WifiPhase::Backoff;
+            _nextAttemptMs = nowMs;
+            return WifiEvent::Lost;
+
+        case WifiPhase::Cached:
+            if (elapsedMs < _config.cachedTimeoutMs) {
+                return WifiEvent::None;
+            }
+            _stats.cachedTimeouts++;
+            if (++_cachedFailures >= _config.maxCachedFailures) {
+                _cacheUsable = false;      // AP moved or changed channel: scan until a new cache is stored
+            }
+            return startAttempt(false, nowMs);
+
+        case WifiPhase::Scan:
+            if (elapsedMs < _config.scanTimeoutMs) {
+                return WifiEvent::None;
+            }
+            _stats.scanTimeouts++;
+            _backoffMs = _backoffMs == 0 ? _config.minBackoffMs : _backoffMs * 2;
+            if (_backoffMs > _config.maxBackoffMs) {
+                _backoffMs = _config.maxBackoffMs;
+            }
+            _phase = WifiPhase::Backoff;
+            _nextAttemptMs = nowMs + _backoffMs;
+            return WifiEvent::Backoff;
+
+        case WifiPhase::Backoff:
+            if ((int32_t)(nowMs - _nextAttemptMs) < 0) {
+                return WifiEvent::None;
+            }
+            return startAttempt(_cacheUsable, nowMs);
+
+        default:
+            return WifiEvent::None;
+    }
+}
+
+void WifiConnector::onCacheStored() {
+    _cacheUsable = true;
+    _cachedFailures = 0;
+}
@@ -0,0 +1,123 @@
+/**
+ * `WifiConnector.h`
+ * - Non-blocking station association: the caller polls update() from loop() and starts
+ *   the attempts it asks for, so camera init and streaming setup run while the radio joins
+ * - A valid WifiCache is tried first (known BSSID/channel, short timeout); after that, or
+ *   when there is no cache, a full scan is used, then an exponential backoff between
+ *   attempts. It never gives up: a missing AP means a retry, not a halted device
+ * - Platform independent: the caller issues WiFi.begin()/disconnect() per event
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#ifndef WIFI_CONNECTOR_H
+#define WIFI_CONNECTOR_H
+
+#include <stdint.h>
+
+/**
+ * Connector configuration
+ */
+struct WifiConnectorConfig {
+    uint32_t cachedTimeoutMs = 1500;   // cached BSSID/channel join (no scan) before falling back
+    uint32_t scanTimeoutMs = 10000;    // join with a full channel scan
+    uint32_t minBackoffMs = 1000;      // pause after a failed scan, doubled per failure
+    uint32_t maxBackoffMs = 30000;
+    uint8_t maxCachedFailures = 2;     // cached joins that may time out before the cache is ignored
+};
+
+/**
+ * Connector phase
+ */
+enum class WifiPhase : uint8_t {
+    Idle,          // begin() not called yet
+    Cached,        // joining the cached BSSID/channel
+    Scan,          // joining after a full scan
+    Backoff,       // waiting before the next attempt
+    Connected
+};
+
+/**
+ * What the caller has to do after update()
+ */
+enum class WifiEvent : uint8_t {
+    None,
+    BeginCached,   // disconnect, then begin(ssid, pass, cache.channel, cache.bssid)
+    BeginScan,     // disconnect, then begin(ssid, pass)
+    Backoff,       // attempt failed: disconnect, next attempt after getBackoffMs()
+    Connected,     // associated (store the new cache)
+    Lost           // association dropped: a new attempt follows on the next update()
+};
+
+/**
+ * Connector statistics
+ */
+struct WifiConnectorStats {
+    uint32_t attempts;
+    uint32_t cachedAttempts;
+    uint32_t cachedConnects;       // joins that skipped the scan
+    uint32_t scanConnects;
+    uint32_t cachedTimeouts;
+    uint32_t scanTimeouts;
+    uint32_t lost;
+    uint32_t lastJoinMs;           // begin to association of the last successful attempt
+    bool lastJoinCached;           // ... and whether it used the cache
+};
+
+/**
+ * Station association state machine
+ */
+class WifiConnector {
+public:
+    /**
+     * Constructor
+     * @param config Timeouts and backoff limits
+     */
+    explicit WifiConnector(const WifiConnectorConfig& config);
+
+    /**
+     * Start connecting
+     * @param cacheValid A WifiCache for this SSID was loaded (first attempt skips the scan)
+     * @return BeginCached or BeginScan
+     */
+    WifiEvent begin(bool cacheValid, uint32_t nowMs);
+
+    /**
+     * Advance on the current association state
+     * @param associated Station is associated and has an IP (WL_CONNECTED)
+     */
+    WifiEvent update(bool associated, uint32_t nowMs);
+
+    /**
+     * A fresh cache was stored after Connected (cached joins are tried again)
+     */
+    void onCacheStored();
+
+    WifiPhase getPhase() const { return _phase; }
+    bool isConnected() const { return _phase == WifiPhase::Connected; }
+    bool isCacheUsable() const { return _cacheUsable; }
+
+    /**
+     * Current pause before the next attempt (0 until a scan has failed)
+     */
+    uint32_t getBackoffMs() const { return _backoffMs; }
+
+    const WifiConnectorStats& getStats() const { return _stats; }
+
+private:
+    WifiEvent startAttempt(bool cached, uint32_t nowMs);
+
+    WifiConnectorConfig _config;
+    WifiPhase _phase;
+    bool _cacheUsable;
+    uint8_t _cachedFailures;
+    uint32_t _attemptStartMs;
+    uint32_t _nextAttemptMs;
+    uint32_t _backoffMs;
+    WifiConnectorStats _stats;
+};
+
+#endif // WIFI_CONNECTOR_H
@@ -20,8 +20,15 @@
 #define WIFI_PASSWORD    "BD0982CF83"
 
 // WiFi 연결 설정
-#define WIFI_CONNECT_TIMEOUT     20       // WiFi 연결 시도 횟수
-#define WIFI_RETRY_DELAY         500      // WiFi 재연결 대기 시간 (ms)
+// - 연결은 비차단: 카메라 초기화와 병렬로 진행되고, 실패해도 멈추지 않고 백오프 후 재시도
+// - 마지막 연결의 BSSID/채널(과 DHCP 임대 IP)을 NVS에 저장 → 재부팅 후 채널 스캔 없이 바로 접속
+#define WIFI_FAST_CONNECT        true     // 저장된 BSSID/채널로 스캔 없이 접속 (실패 시 스캔 접속)
+#define WIFI_REUSE_LEASE         false    // 저장된 IP를 고정 IP로 사용해 DHCP 생략 (공유기에 예약된 주소일 때만)
+#define WIFI_CACHE_NAMESPACE     "wifi"   // NVS 네임스페이스
+#define WIFI_CACHED_TIMEOUT      1500     // 캐시 접속 제한 시간 (ms)
+#define WIFI_CONNECT_TIMEOUT     10000    // 스캔 접속 제한 시간 (ms)
+#define WIFI_RETRY_DELAY         1000     // 실패 후 첫 재시도 대기 시간 (ms), 실패마다 2배
+#define WIFI_RETRY_MAX_DELAY     30000    // 재시도 대기 시간 상한 (ms)
 
 // ========================================
 // WebSocket Server Configuration  
@@ -42,9 +49,16 @@
 #define FRAME_INTERVAL   100              // 프레임 전송 간격 (ms) - 100ms = 10 FPS
 #define TARGET_FPS       10               // 목표 FPS
 
-// Camera Quality
-#define JPEG_QUALITY     12               // JPEG 품질 (0-63, 낮을수록 고품질)
+// Camera Quality (부팅 시 스트림 프로필, ABR과 PROFILE 명령이 런타임에 변경)
+#define JPEG_QUALITY     25               // JPEG 품질 (0-63, 낮을수록 고품질) - 25는 대역폭 약 70% 절약
 #define FRAME_SIZE       FRAMESIZE_HVGA   // 해상도: HVGA (480x320)
+#define XCLK_FREQ_MHZ    20               // 센서 클럭 (MHz) - OV2640 권장값
+
+// Frame Ring (latest-frame grabbing)
+#define FB_COUNT          3               // 프레임 버퍼 수 (PSRAM 사용 시)
+#define FB_IN_PSRAM       true            // 프레임 버퍼를 PSRAM에 배치
+#define MAX_FRAME_AGE_MS  200             // 이보다 오래된 프레임은 전송하지 않음 (0 = 비활성화)
+#define RING_STATS_INTERVAL 10000         // 버퍼 점유율 통계 출력 간격 (ms)
 
 // Available Frame Sizes:
 // - FRAMESIZE_QQVGA  (160x120)
@@ -55,6 +69,248 @@
 // - FRAMESIZE_XGA    (1024x768)
 // - FRAMESIZE_SXGA   (1280x1024)
 
+// ========================================
+// Pipeline Configuration (Dual-core capture/upload)
+// - true: 캡처 태스크와 전송 태스크를 서로 다른 코어에서 병렬 실행
+// - false: 기존 loop() 동기 방식 (캡처 → 전송 → delay)
+// ========================================
+#define PIPELINE_ENABLED         true
+#define PIPELINE_QUEUE_DEPTH     1        // 태스크 간 대기 프레임 수 (FB_COUNT - 2 이하 권장)
+#define PIPELINE_DROP_POLICY     DropPolicy::DropOldest  // DropOldest: 최신 프레임 우선, DropNewest: 대기 프레임 우선
+#define PIPELINE_CAPTURE_CORE    1        // 캡처 태스크 코어 (APP_CPU)
+#define PIPELINE_NETWORK_CORE    0        // 전송 태스크 코어 (PRO_CPU, WiFi/lwIP와 동일)
+#define PIPELINE_STATS_INTERVAL  5000     // 파이프라인 통계 출력 간격 (ms)
+
+// ========================================
+// Frame Pacing Configuration
+// - 프레임 시각을 고정 격자(시작 + n × 간격)에 맞춰 캡처/전송 시간이 주기에 누적되지 않음
+// - ESP32: esp_timer 원샷 + 태스크 알림으로 µs 단위 기상 (1ms 틱 반올림 없음)
+// ========================================
+#define PACING_POLICY            PacingPolicy::Skip  // Skip: 놓친 시점 버림, CatchUp: 최대 PACING_MAX_CATCH_UP개 즉시 보충
+#define PACING_MAX_CATCH_UP      1        // CatchUp 정책에서 연속 보충 프레임 수
+#define WS_SERVICE_INTERVAL      5        // loop() 모드에서 프레임 사이 WebSocket 처리 최대 간격 (ms)
+#define PACING_STATS_INTERVAL    10000    // 페이싱 통계 출력 간격 (ms)
+
+// ========================================
+// Adaptive Bitrate (ABR) Configuration
+// - 전송 시간, 처리량, RSSI를 측정해 (해상도, JPEG 품질, 프레임 간격)을 런타임에 조정
+// - 프레임 버퍼는 래더의 최대 해상도로 할당됩니다
+// ========================================
+#define ABR_ENABLED              true
+#define ABR_LADDER { \
+    {FRAMESIZE_QVGA, 30, 200},   /* 0: 320x240, 5 FPS   */ \
+    {FRAMESIZE_QVGA, 20, 100},   /* 1: 320x240, 10 FPS  */ \
+    {FRAMESIZE_HVGA, 25, 100},   /* 2: 480x320, 10 FPS  */ \
+    {FRAMESIZE_HVGA, 15, 66},    /* 3: 480x320, 15 FPS  */ \
+    {FRAMESIZE_VGA,  12, 66},    /* 4: 640x480, 15 FPS  */ \
+}
+#define ABR_INITIAL_RUNG         2        // 부팅 시 시작 단계 (HVGA q25 10 FPS)
+#define ABR_RSSI_DOWN_DBM        -80      // 이보다 약하면 단계 하향
+#define ABR_RSSI_UP_DBM          -72      // 이보다 강해야 단계 상향
+
+// ========================================
+// Region of Interest (ROI) Configuration
+// - ROI:<x>:<y>:<w>:<h> 명령 (시야의 ‰)으로 센서 윈도우만 읽어 JPEG 인코딩, ROI_OFF로 전체 화면 복귀
+// - ROI는 현재 ABR 해상도의 픽셀 밀도를 유지하고, 같은 바이트 예산으로 프레임 간격을 줄입니다
+// ========================================
+#define ROI_ENABLED              true
+#define ROI_MIN_OUTPUT           64       // ROI 출력 최소 변 길이 (px, 작은 ROI는 중심 기준으로 확장)
+#define ROI_MIN_INTERVAL         40       // ROI 최소 프레임 간격 (ms) - 40ms = 25 FPS
+#define ROI_ALIGNMENT            8        // 윈도우/출력 크기 정렬 단위 (px, JPEG MCU)
+
+// ========================================
+// Motion Gate Configuration
+// - JPEG DC 계수만 디코딩한 1/8 축소 휘도 영상을 배경 모델과 비교해 움직임 점수 계산
+// - 움직임이 있으면 전체 프레임 레이트, 정지 장면은 keep-alive 간격으로만 전송
+// ========================================
+#define MOTION_GATE_ENABLED      true
+#define MOTION_BLOCK_THRESHOLD   10       // 블록 밝기 변화 임계값 (0-255)
+#define MOTION_SCORE_THRESHOLD   15       // 변화 블록 비율이 이 이상이면 움직임 (‰)
+#define MOTION_HOLD_MS           2000     // 움직임 종료 후 전체 레이트 유지 시간 (ms)
+#define MOTION_KEEPALIVE_MS      5000     // 정지 장면 전송 간격 (ms, 0 = 전송 안 함)
+#define MOTION_STATS_INTERVAL    10000    // 모션 게이트 통계 출력 간격 (ms)
+
+// ========================================
+// Demand-driven Streaming Configuration
+// - 서버가 소비자 구성(`DEMAND:<라이브 뷰어 수>:<분석기 수>`)을 연결 직후와 변경 시마다 전송
+// - 라이브 뷰어 있음: 전체 레이트, 분석기만: 저속 전송, 소비자 없음: 프레임 전송 중지 (하트비트만 유지)
+// - 뷰어 도착 시 즉시 전환하고 첫 프레임은 모션 게이트를 건너뜀, 하향 전환은 유예 시간 후
+// - 서버가 DEMAND를 보내지 않으면 (이전 서버) 항상 전체 레이트, 캡처/로컬 MJPEG/녹화는 영향 없음
+// ========================================
+#define DEMAND_ENABLED           true
+#define DEMAND_ANALYZER_INTERVAL 500      // 분석기만 있을 때 전송 간격 (ms) - 500ms = 2 FPS
+#define DEMAND_LINGER_MS         5000     // 마지막 소비자가 떠난 뒤 하향 전환까지 유예 시간 (ms)
+
+// ========================================
+// Stream Profile Configuration
+// - 연결 시 카메라 능력(`CAPS:{json}`: 센서, 지원 해상도, PSRAM, 프레임 버퍼 메모리) 전송
+// - 서버가 `PROFILE:<해상도>:<품질>:<간격ms>[:<XCLK MHz>]`로 스트림 프로필을 보내면 런타임에 적용
+// - 현재 버퍼보다 큰 해상도는 카메라 드라이버를 재초기화해 버퍼를 다시 할당 (전환 공백을 측정해 보고)
+// - 수동 프로필은 ABR을 고정하고, `PROFILE:AUTO`로 ABR에 돌려줍니다
+// ========================================
+#define STREAM_PROFILE_ENABLED   true
+#define PROFILE_DRAIN_TIMEOUT    1000     // 재초기화 전 사용 중인 버퍼 반환 대기 (ms)
+#define PROFILE_MEMORY_RESERVE   (32 * 1024)  // 새 버퍼 할당 후 남겨둘 메모리 (bytes)
+
+// ========================================
+// Snapshot Configuration
+// - 서버가 `SNAPSHOT[:<해상도>[:<품질>]]`을 보내면 라이브 프레임 사이에 고해상도 정지 영상 1장 촬영
+// - 센서를 스냅샷 해상도로 바꾼 뒤 그 해상도의 첫 완전한 프레임을 PSRAM 버퍼에 복사하고 즉시 라이브 프로필 복원
+// - 라이브 스트림 공백(전환 전 마지막 캡처 → 복원 후 첫 캡처)을 측정해 `SNAPSHOT_STATUS`로 보고
+// - 업로드는 "SNP" 파트로 나눠 라이브 프레임 사이 빈 시간에만 전송 (링크 시간의 일부만 사용)
+// - 프레임 버퍼가 스냅샷 해상도보다 작으면 촬영 동안 드라이버를 재초기화 (공백이 길어짐)
+// - PSRAM이 필요하며, 서버(릴레이/대역 서버)가 "SNP" 파트를 조립합니다
+// ========================================
+#define SNAPSHOT_ENABLED         true
+#define SNAPSHOT_FRAME_SIZE      FRAMESIZE_UXGA  // 기본 스냅샷 해상도 (최대 해상도, 버퍼 크기 기준)
+#define SNAPSHOT_JPEG_QUALITY    10       // 기본 스냅샷 JPEG 품질
+#define SNAPSHOT_PREALLOCATE     true     // 부팅 시 프레임 버퍼를 스냅샷 해상도로 할당 (PSRAM, 재초기화 없이 전환)
+#define SNAPSHOT_SETTLE_FRAMES   1        // 첫 유효 프레임 뒤 추가로 버릴 프레임 수 (노출 안정화)
+#define SNAPSHOT_MAX_WAIT        1500     // 스냅샷 프레임 대기 제한 (ms)
+#define SNAPSHOT_SHARE_PERCENT   50       // 업로드가 사용할 링크 시간 비율 (%)
+#define SNAPSHOT_PART_SIZE       (32 * 1024)  // 업로드 파트 최대 크기 (bytes)
+#define SNAPSHOT_MIN_KBPS        256      // 링크 속도를 모를 때 가정하는 속도 (kbps)
+#define SNAPSHOT_STATS_INTERVAL  10000    // 업로드 통계 출력 간격 (ms)
+
+// ========================================
+// Luma Side-Stream Configuration
+// - 모션 게이트가 디코딩한 1/8 축소 휘도 영상(DC 썸네일)을 작은 8비트 휘도 평면(최대 예: 80 × 60)으로 축소
+// - 확대하지 않음: 썸네일이 최대 크기보다 작으면 그대로 (HVGA 60 × 40, QVGA 40 × 30), 크면 원본 비율 유지 축소
+// - 이전 평면과의 차이만 "LUM" 메시지로 전송 → 분석기가 JPEG 디코딩 없이 회색조 평면으로 모션 분석
+// - 데드밴드 이하 변화(센서 노이즈)는 0으로 보내고 오차는 데드밴드 이내로 유지 (누적 없음)
+// - 첫 평면, 재연결, 전송 실패, 해상도 변경, 주기마다 키 평면(전체) 전송
+// - 분석기가 있을 때만 전송 (서버가 DEMAND를 보내지 않으면 항상), 서버가 `LUMA:<간격ms>`로 런타임 변경 (0 = 끔)
+// ========================================
+#define LUMA_ENABLED             true
+#define LUMA_WIDTH               80       // 평면 최대 너비 (px)
+#define LUMA_HEIGHT              60       // 평면 최대 높이 (px)
+#define LUMA_INTERVAL            200      // 평면 전송 간격 (ms, 0 = 끔) - 200ms = 5 FPS
+#define LUMA_DEADBAND            2        // 이 이하의 밝기 변화는 보내지 않음 (0-255, 0 = 무손실)
+#define LUMA_KEY_INTERVAL        50       // 키 평면 간격 (평면 수, 0 = 필요할 때만)
+#define LUMA_STATS_INTERVAL      10000    // 사이드 스트림 통계 출력 간격 (ms)
+
+// ========================================
+// Flow Control (Credit) Configuration
+// - 서버가 연결 직후 크레딧 창(`CREDIT:<n>`)을 주고, 라이브 프레임을 뷰어에게 넘길 때마다 `CREDIT:1` 반환
+// - 크레딧이 있을 때만 라이브 프레임 전송 → 카메라와 뷰어 사이 대기 프레임이 창 크기 이하로 유지
+// - 크레딧이 없으면 대기 중인 프레임을 최신 캡처로 교체 (느린 뷰어도 최신 프레임을 봄)
+// - 서버가 CREDIT을 보내지 않으면 (이전 서버) 제한 없음, 백필/내보내기는 크레딧을 쓰지 않음
+// ========================================
+#define FLOW_CONTROL_ENABLED     true
+#define FLOW_CREDIT_MAX          8        // 보유 가능한 최대 크레딧 (초과분은 버림)
+#define FLOW_CREDIT_STALL_MS     3000     // 크레딧 없이 이 시간이 지나면 프레임 1개 전송 (ms, 0 = 무한 대기)
+#define FLOW_STATS_INTERVAL      10000    // 흐름 제어 통계 출력 간격 (ms)
+
+// ========================================
+// Frame Envelope / Clock Sync Configuration
+// - 각 JPEG 앞에 48바이트 헤더(시퀀스, 캡처/전송 시각, 클럭 오프셋, 해상도/품질, 플래그)를 붙여 전송
+// - 서버와 PING/PONG 텍스트 메시지로 클럭 오프셋을 추정 → 구간별 지연 측정
+// ========================================
+#define FRAME_ENVELOPE_ENABLED   true
+#define FRAME_SEND_BUFFER_SIZE   (96 * 1024)  // 헤더+JPEG 전송 버퍼 (PSRAM, 초과 프레임은 헤더 없이 전송)
+#define CLOCK_SYNC_INTERVAL      10000    // 동기화 후 PING 간격 (ms)
+#define CLOCK_SYNC_FAST_INTERVAL 1000     // 연결 직후 PING 간격 (ms)
+
+// ========================================
+// Compact Frame (JPEG Header Elision) Configuration
+// - 해상도/품질이 같으면 모든 프레임의 JPEG 헤더(SOI, DQT, SOF, DHT, SOS ≈ 600 bytes)가 동일
+// - 헤더가 바뀔 때 한 번만 전체 프레임 + 헤더 ID로 보내고, 이후 프레임은 스캔 데이터만 전송 (서버가 복원)
+// - 서버가 `JPEG_SYNC`를 보낸 뒤에만 사용 (이전 서버는 항상 전체 프레임), 연결이 끊기면 해제
+// - 프레임 엔벨로프가 필요합니다
+// ========================================
+#define COMPACT_FRAMES_ENABLED   true
+#define COMPACT_STATS_INTERVAL   10000    // 압축 통계 출력 간격 (ms)
+
+// ========================================
+// Chunked Frame Sending Configuration
+// - 큰 프레임을 여러 바이너리 메시지(파트)로 나눠 보내고, 파트 사이에 WebSocket을 처리
+// - 전송 중 도착한 LED 명령/하트비트는 프레임 전체가 아닌 파트 하나만 기다림 (명령 응답 지연이 프레임 크기와 무관)
+// - 명령 응답 등 제어 메시지는 우선순위 큐에 넣었다가 파트 사이에 먼저 전송
+// ========================================
+#define FRAME_CHUNK_SIZE         (4 * 1024)  // 파트당 JPEG 바이트 (0 = 분할 안 함, 프레임 엔벨로프 필요)
+#define CONTROL_QUEUE_SLOTS      4        // 대기 가능한 제어 메시지 수
+#define CONTROL_QUEUE_SLOT_SIZE  1024     // 제어 메시지 최대 길이 (명령 응답 버퍼와 동일)
+
+// ========================================
+// Outage Backfill (Store-and-forward) Configuration
+// - WebSocket 연결이 끊긴 동안 프레임을 일정 간격으로 PSRAM 링에 저장
+// - 재연결 후 라이브 프레임 사이 빈 시간에, 링크 속도의 일부만 사용해 과거 프레임(historical 플래그)으로 전송
+// - 프레임 엔벨로프와 PSRAM이 필요합니다
+// ========================================
+#define BACKFILL_ENABLED         true
+#define BACKFILL_BUFFER_SIZE     (1024 * 1024)  // 저장 링 크기 (PSRAM, 메모리 상한)
+#define BACKFILL_RECORD_INTERVAL 500      // 연결 끊김 중 저장 간격 (ms) - 500ms = 2 FPS
+#define BACKFILL_EVICTION        BackfillEviction::DropOldest  // DropOldest: 끊김 끝부분 유지, DropNewest: 시작 부분 유지
+#define BACKFILL_SHARE_PERCENT   25       // 재전송에 쓰는 링크 속도 비율 (%)
+#define BACKFILL_MIN_KBPS        64       // 링크 속도를 모를 때 재전송 속도 (kbps)
+
+// ========================================
+// Local Recording (microSD) Configuration
+// - 캡처 경로는 프레임을 PSRAM 대기열에 복사만 하고, 별도 태스크가 microSD 세그먼트 파일에 기록 (스트리밍 비차단)
+// - 세그먼트마다 시간 인덱스 저장 → `REC_EXPORT:<시작ms>:<끝ms>` 요청 시 O(log n) 탐색 후 라이브 프레임 사이에 전송
+// - 시각: 클럭 동기화 후에는 서버 시각(epoch ms), 이전에는 장치 부팅 후 시각
+// - SD 1-bit 모드 사용 (GPIO 2/14/15, LED_PIN(12)/플래시 LED와 충돌 없음), PSRAM이 필요합니다
+// ========================================
+#define RECORDING_ENABLED        true
+#define RECORDING_MOUNT_POINT    "/sdcard"
+#define RECORDING_DIRECTORY      "/sdcard/rec"  // 세그먼트 파일 디렉터리
+#define RECORDING_INTERVAL       200      // 기록 간격 (ms) - 200ms = 5 FPS (0 = 모든 프레임)
+#define RECORDING_SEGMENT_MS     60000    // 세그먼트 최대 길이 (ms)
+#define RECORDING_SEGMENT_BYTES  (8 * 1024 * 1024)  // 세그먼트 최대 크기
+#define RECORDING_SEGMENT_FRAMES 2048     // 세그먼트 최대 프레임 수 (인덱스 RAM = 16B × 프레임)
+#define RECORDING_BATCH_SIZE     (16 * 1024)  // 쓰기 단위 (512B 섹터 배수)
+#define RECORDING_FLUSH_INTERVAL 2000     // 쓰기 버퍼 최대 대기 시간 (ms, 전원 차단 시 손실 범위)
+#define RECORDING_STAGING_SIZE   (256 * 1024)  // 캡처 → 기록 태스크 대기열 (PSRAM)
+#define RECORDING_RETENTION_MB   1024     // 전체 기록 용량 상한 (초과 시 오래된 세그먼트 삭제)
+#define RECORDING_RETENTION_SEGMENTS 1024 // 세그먼트 수 상한
+#define RECORDING_WRITER_CORE    0        // 기록 태스크 코어 (낮은 우선순위)
+#define RECORDING_STATS_INTERVAL 30000    // 기록 통계 출력 간격 (ms)
+
+// ========================================
+// Local MJPEG Server Configuration
+// - LAN 뷰어가 클라우드 릴레이를 거치지 않고 `http://<장치 IP>:MJPEG_PORT/stream`으로 직접 시청
+// - 캡처한 프레임을 PSRAM 슬롯에 한 번만 복사하고 모든 뷰어가 참조 카운트로 공유 (뷰어별 복사 없음)
+// - 느린 뷰어는 각자 최신 프레임으로 건너뜀 (다른 뷰어, 캡처, 클라우드 업로드는 기다리지 않음)
+// - 클라우드 연결이 끊긴 동안에도 계속 시청 가능, PSRAM이 필요합니다
+// ========================================
+#define MJPEG_SERVER_ENABLED     true
+#ifndef MJPEG_PORT
+#define MJPEG_PORT               81       // HTTP 포트 (리플레이 빌드는 platformio.ini에서 변경)
+#endif
+#define MJPEG_PATH               "/stream"  // 스트림 경로 (multipart/x-mixed-replace)
+#define MJPEG_MAX_VIEWERS        3        // 동시 뷰어 수 (PSRAM 슬롯 = 뷰어 + 2)
+#define MJPEG_SLOT_SIZE          (96 * 1024)  // 슬롯 크기 (초과 프레임은 로컬 뷰어에 보내지 않음)
+#define MJPEG_SERVER_CORE        0        // 서버 태스크 코어 (WiFi/lwIP와 동일)
+#define MJPEG_STATS_INTERVAL     10000    // 로컬 뷰어 통계 출력 간격 (ms)
+
+// ========================================
+// RTP/JPEG UDP Transport Configuration
+// - 프레임을 RFC 2435 RTP/JPEG 패킷으로 나눠 UDP로 전송 (WebSocket은 명령/텔레메트리/하트비트용으로 유지)
+// - 패킷 손실은 그 프레임에만 영향 (TCP처럼 재전송을 기다리느라 이후 프레임이 밀리지 않음)
+// - RTP_FEC_GROUP개 패킷마다 XOR 패리티 패킷 1개 → 그룹당 1개 손실은 수신 측에서 복구
+// - 프레임 엔벨로프(시퀀스/클럭 오프셋)는 실리지 않음, RTP/JPEG로 표현할 수 없는 JPEG는 WebSocket으로 전송
+// ========================================
+#ifndef RTP_ENABLED
+#define RTP_ENABLED              false    // 리플레이 빌드는 빌드 플래그로 변경
+#endif
+#ifndef RTP_DEST_HOST
+#define RTP_DEST_HOST            WS_HOST  // 수신기 주소 (릴레이 또는 LAN 수신기)
+#endif
+#define RTP_DEST_PORT            5004     // 수신기 UDP 포트
+#define RTP_MTU                  1400     // 데이터그램 최대 크기 (IP/UDP 헤더 제외)
+#define RTP_FEC_GROUP            4        // 패리티 1개당 미디어 패킷 수 (0 = FEC 없음, 오버헤드 ≈ 1/N)
+#define RTP_FEC_PAYLOAD_TYPE     127      // 패리티 패킷 페이로드 타입 (동적 범위)
+#define RTP_SEND_RETRIES         3        // lwIP 버퍼 부족(ENOMEM) 시 데이터그램 재시도 횟수
+#define RTP_STATS_INTERVAL       10000    // RTP 통계 출력 간격 (ms)
+
+// ========================================
+// Telemetry Configuration
+// - 캡처/전송/루프 시간, 프레임 크기 히스토그램 + 힙/PSRAM 최저치, 재연결/전송 실패 수
+// - `STATS` 텍스트 명령 또는 주기적으로 `STATS:{json}` 스냅샷 전송
+// ========================================
+#define TELEMETRY_ENABLED        true
+#define TELEMETRY_INTERVAL       10000    // 주기적 스냅샷 전송 간격 (ms, 0 = STATS 요청 시에만)
+
 // ========================================
 // LED Configuration
 // ========================================
@@ -87,21 +343,25 @@
 #define PCLK_GPIO_NUM     22
 
 // ========================================
-// Debug Configuration
+// Debug / Log Configuration
+// - LOG_DEBUG/INFO/WARN/ERROR는 바이너리 레코드(포맷 포인터 + 인자 값)만 링에 기록하고 바로 반환 (락 없음)
+// - 포맷팅과 UART 출력은 낮은 우선순위 로그 태스크가 처리
+//   (115200 baud에서 60바이트 한 줄 ≈ 5 ms 동안 호출 태스크가 막히던 것을 제거)
+// - LOG_MIN_LEVEL 미만 호출은 컴파일 시 제거 (인자도 평가하지 않음)
+// - 링이 가득 차면 새 레코드를 버리고 개수를 로그로 보고 ("[Log] N records dropped")
 // ========================================
 #define SERIAL_BAUD_RATE  115200          // 시리얼 통신 속도
-#define DEBUG_ENABLED     true            // 디버그 로그 활성화
+#define DEBUG_ENABLED     true            // 디버그 로그 활성화 (false = LOG_* 전부 제거)
 
-// Debug 매크로
 #if DEBUG_ENABLED
-  #define DEBUG_PRINT(x)    Serial.print(x)
-  #define DEBUG_PRINTLN(x)  Serial.println(x)
-  #define DEBUG_PRINTF(...)  Serial.printf(__VA_ARGS__)
+  #define LOG_MIN_LEVEL   1               // 0 = DEBUG, 1 = INFO, 2 = WARN, 3 = ERROR
 #else
-  #define DEBUG_PRINT(x)
-  #define DEBUG_PRINTLN(x)
-  #define DEBUG_PRINTF(...)
+  #define LOG_MIN_LEVEL   4
 #endif
+#define LOG_RING_SLOTS        64          // 링 슬롯 수 (2의 거듭제곱, 슬롯당 ≈ 128 bytes 내부 RAM)
+#define LOG_FLUSH_INTERVAL    20          // 로그 태스크가 링을 비우는 간격 (ms)
+#define LOG_TASK_PRIORITY     1           // 캡처/전송 태스크보다 낮게 (idle 바로 위)
+#define LOG_TASK_CORE         0
 
 // ========================================
 // System Configuration
@@ -109,7 +369,12 @@
 #define WATCHDOG_ENABLED  false           // Watchdog 타이머 비활성화 (브라운아웃 방지)
 
 // Memory Configuration
-#define USE_PSRAM         true            // PSRAM 사용 여부
+// - 프레임 버퍼(해상도/개수/위치)와 큰 버퍼를 컴파일 타임에 계획해 예산과 비교 (초과 시 빌드 실패)
+// - PSRAM 유무에 따른 두 계획 중 하나를 부팅 시 선택하고 시리얼로 보고
+#define USE_PSRAM           true          // PSRAM 사용 여부 (sdkconfig에 CONFIG_SPIRAM 필요)
+#define MEMORY_DRAM_BUDGET  (180 * 1024)  // WiFi/WebSocket 시작 후 남는 내부 힙 (bytes)
+#define MEMORY_PSRAM_BUDGET (4 * 1024 * 1024)  // PSRAM 크기 (ESP32-CAM 4MB)
+#define MEMORY_RESERVE      (32 * 1024)   // 영역마다 남겨둘 여유 메모리 (bytes)
 
 // ========================================
 // Application Info
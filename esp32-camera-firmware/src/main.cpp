@@ -21,187 +21,2957 @@
  */
 
 #include <Arduino.h>
+#include <Preferences.h>
+#include <SD_MMC.h>
 #include <WiFi.h>
 #include <WebSocketsClient.h>
 #include "esp_camera.h"
 #include "soc/soc.h"
 #include "soc/rtc_cntl_reg.h"
+#include "esp_timer.h"
+
+#include <mutex>
 
 // Import configuration
 #include "Config.h"
 
+// Host-testable modules (lib/)
+#include <BackfillStore.h>
+#include <AllocCounter.h>
+#include <AsyncLog.h>
+#include <BitrateController.h>
+#include <ClockSync.h>
+#include <CommandRouter.h>
+#include <ControlQueue.h>
+#include <FrameChunker.h>
+#include <FrameEnvelope.h>
+#include <FrameHub.h>
+#include <FramePacer.h>
+#include <FlowCredit.h>
+#include <JpegHeaderElision.h>
+#include <FramePipeline.h>
+#include <FrameRing.h>
+#include <MemoryPlan.h>
+#include <MjpegServer.h>
+#include <LumaStream.h>
+#include <MotionGate.h>
+#include <PaceTimer.h>
+#include <RtpSender.h>
+#include <SegmentRecorder.h>
+#include <SensorWindow.h>
+#include <SnapshotCapture.h>
+#include <StreamDemand.h>
+#include <StreamProfile.h>
+#include <Telemetry.h>
+#include <WifiCache.h>
+#include <WifiConnector.h>
+
 // ========================================
 // Global Variables
 // ========================================
 WebSocketsClient webSocket;
-bool isConnected = false;
-unsigned long lastFrameTime = 0;
+volatile bool isConnected = false;  // Shared between capture and network tasks
+volatile uint32_t frameIntervalMs = FRAME_INTERVAL;  // Current frame interval (ABR may change it)
 unsigned long frameCount = 0;
 bool ledState = false; // LED 상태 (false=OFF, true=ON)
+FrameRing frameRing{FrameRingConfig()};  // Per-buffer timestamps/occupancy (configured in initCamera)
+unsigned long lastRingStatsTime = 0;
+MotionGate* motionGate = NULL;  // Upload gating from JPEG DC thumbnails (created in initCamera)
+unsigned long lastMotionStatsTime = 0;
+ClockSync* clockSync = NULL;    // Device → server clock offset (PING/PONG over the WebSocket)
+uint8_t* sendBuffer = NULL;     // [WebSocket header room][envelope][JPEG] (PSRAM)
+FrameChunker frameChunker(FRAME_CHUNK_SIZE, WEBSOCKETS_MAX_HEADER_SIZE);  // Large frames go out in parts
+uint64_t lastServiceUs = 0;     // Last webSocket.loop() (the gap bounds how long a command waits)
+uint32_t legacySequence = 0;    // Frame sequence for the loop() path (pipeline assigns its own)
+unsigned long lastClockStatsTime = 0;
+Telemetry* telemetry = NULL;    // Per-stage histograms and counters (STATS snapshots)
+char telemetrySnapshot[Telemetry::kMaxSnapshot];  // Owned by the WebSocket context
+char statsLine[Telemetry::kMaxSnapshot];  // Last snapshot for the serial log (printed by loop(), too long for LOG_*)
+std::mutex statsLineMutex;
+volatile bool statsLinePending = false;
+FramePacer framePacer{FramePacerConfig()};  // Capture deadlines for the loop() path (configured in setup)
+PaceTimer paceTimer;
+unsigned long lastPaceStatsTime = 0;
+BackfillStore* backfill = NULL; // Frames recorded during outages, sent after reconnect (PSRAM arena)
+SegmentRecorder* recorder = NULL;  // Continuous microSD recording (writer task)
+unsigned long lastRecordingStatsTime = 0;
+SegmentCursor exportCursor = {};   // REC_EXPORT in progress (served between live frames)
+uint64_t exportEndUs = 0;
+uint32_t exportSent = 0;
+bool exportActive = false;
+FrameHub* frameHub = NULL;         // Latest frame shared by local MJPEG viewers (PSRAM slots)
+MjpegServer* mjpegServer = NULL;   // LAN viewers, next to the cloud upload
+uint64_t lastLocalFrameUs = 0;
+unsigned long lastMjpegStatsTime = 0;
+RtpSender* rtpSender = NULL;       // Frames as RTP/JPEG over UDP (the WebSocket keeps commands)
+unsigned long lastRtpStatsTime = 0;
+StreamProfile activeProfile = {};  // Frame size/quality/interval/XCLK the sensor runs (boot, ABR or PROFILE)
+volatile bool profilePinned = false;  // PROFILE set manually: ABR keeps measuring but does not switch (capture context)
+
+// ========================================
+// Async Log
+// ========================================
+static_assert((LOG_RING_SLOTS & (LOG_RING_SLOTS - 1)) == 0, "LOG_RING_SLOTS must be a power of two");
+
+LogSlot logSlots[LOG_RING_SLOTS];  // LOG_* records waiting for the log task (internal RAM)
+AsyncLog* asyncLog = NULL;          // NULL until setup() starts it
+
+/**
+ * Log task sink: formatted lines go to the UART here, off the calling task
+ */
+void writeSerialLog(const char* line, size_t length, void* context) {
+    (void)context;
+    Serial.write((const uint8_t*)line, length);
+}
+
+/**
+ * Start the log task and route LOG_* to it
+ */
+void initAsyncLog() {
+    AsyncLogConfig config;
+    config.sink = writeSerialLog;
+    config.flushIntervalMs = LOG_FLUSH_INTERVAL;
+    config.writerPriority = LOG_TASK_PRIORITY;
+    config.writerCore = LOG_TASK_CORE;
+    asyncLog = new AsyncLog(config, logSlots, LOG_RING_SLOTS);
+    if (!asyncLog->start()) {
+        Serial.println("Log task start failed - log lines written from loop()");
+    }
+    AsyncLog::install(asyncLog);
+}
+
+// ========================================
+// Boot Timing
+// ========================================
+uint32_t bootStageMs[(size_t)BootStage::Count] = {};  // ms since reset, 0 = not reached
+
+/**
+ * Record a boot milestone (first time only) and log the summary with the first frame
+ * @return true if the stage was reached for the first time
+ */
+bool markBootStage(BootStage stage) {
+    if (bootStageMs[(size_t)stage] != 0) {
+        return false;
+    }
+    uint32_t ms = (uint32_t)(esp_timer_get_time() / 1000);
+    bootStageMs[(size_t)stage] = ms > 0 ? ms : 1;
+    if (telemetry != NULL) {
+        telemetry->recordBoot(stage, ms);
+    }
+    if (stage == BootStage::FirstFrame) {
+        LOG_INFO("[Boot] first frame sent %u ms after reset (camera %u ms, WiFi %u ms, WebSocket %u ms)",
+                 (unsigned)ms, (unsigned)bootStageMs[(size_t)BootStage::Camera],
+                 (unsigned)bootStageMs[(size_t)BootStage::WiFi], (unsigned)bootStageMs[(size_t)BootStage::Socket]);
+    }
+    return true;
+}
+
+// ========================================
+// Sensor Window (ROI)
+// ========================================
+SensorWindow* sensorWindow = NULL;  // ROI readout, NULL if disabled
+WindowPlan roiPlan = {};            // sensor settings of the active ROI
+volatile bool roiApplied = false;   // sensor is windowed (read by the capture task)
+
+/**
+ * Programmed view as the WebSocket context sees it (ROI_STATUS)
+ */
+struct RoiStatus {
+    bool active;
+    WindowPlan plan;
+};
+
+// ROI / ROI_OFF request (WebSocket context → capture context) and the view it programmed (back)
+std::mutex roiMutex;
+RoiRect roiRequest = {};
+bool roiRequestActive = false;        // false = ROI_OFF
+volatile uint32_t roiRequestSeq = 0;
+uint32_t roiAppliedSeq = 0;
+RoiStatus roiStatus = {};
+const char* roiError = NULL;          // why the last request was refused (NULL if applied)
+volatile uint32_t roiResultSeq = 0;
+uint32_t roiReportedSeq = 0;
+
+/**
+ * Create the ROI planner (full view until an ROI command arrives)
+ */
+void initSensorWindow() {
+    SensorWindowConfig config;
+    config.alignment = ROI_ALIGNMENT;
+    config.minOutput = ROI_MIN_OUTPUT;
+    config.minIntervalMs = ROI_MIN_INTERVAL;
+    sensorWindow = new SensorWindow(config);
+    Serial.printf("ROI: window readout on command, min %u px, min interval %u ms\n", ROI_MIN_OUTPUT, ROI_MIN_INTERVAL);
+}
+
+/**
+ * Copy the programmed view for ROI_STATUS (capture context)
+ */
+void postRoiStatus() {
+    std::lock_guard<std::mutex> lock(roiMutex);
+    roiStatus.active = roiApplied;
+    roiStatus.plan = roiPlan;
+}
+
+/**
+ * Program the full view, or the sensor window when an ROI is set (capture context)
+ * - OV2640 set_res_raw(mode, -, -, -, offset, window, output): the DSP crops the window
+ *   and scales it to the output size, so only the region is JPEG-encoded
+ * @param frameSize Full view (the ROI keeps its pixel density)
+ * @param fullIntervalMs Full-view frame interval
+ * @return Frame interval to use (shorter for an ROI: same byte budget, smaller frames)
+ */
+uint32_t applyView(sensor_t* s, framesize_t frameSize, uint32_t fullIntervalMs) {
+    if (sensorWindow != NULL && s->set_res_raw != NULL &&
+        sensorWindow->plan(resolution[frameSize].width, resolution[frameSize].height, fullIntervalMs, roiPlan) &&
+        s->set_res_raw(s, (int)roiPlan.mode, 0, 0, 0, roiPlan.offsetX, roiPlan.offsetY,
+                       roiPlan.windowWidth, roiPlan.windowHeight, roiPlan.outputWidth, roiPlan.outputHeight,
+                       false, false) == 0) {
+        roiApplied = true;
+        postRoiStatus();
+        return roiPlan.intervalMs;
+    }
+    s->set_framesize(s, frameSize);
+    roiApplied = false;
+    postRoiStatus();
+    return fullIntervalMs;
+}
+
+/**
+ * Frame size of a grabbed frame
+ * - The driver reports the full-view size (status.framesize) for windowed frames
+ */
+void frameDimensions(const camera_fb_t* fb, uint16_t& width, uint16_t& height) {
+    width = (uint16_t)fb->width;
+    height = (uint16_t)fb->height;
+    if (roiApplied) {
+        SensorWindow::jpegDimensions(fb->buf, fb->len, width, height);
+    }
+}
+
+// ========================================
+// Adaptive Bitrate
+// ========================================
+static constexpr BitrateRung abrLadder[] = ABR_LADDER;
+size_t abrLadderSize = sizeof(abrLadder) / sizeof(abrLadder[0]);  // Rungs in use (initCamera drops those the buffers cannot hold)
+BitrateController* abr = NULL;
+unsigned long lastRssiTime = 0;
+
+// ABR rung change (network context → capture context, which owns the sensor)
+std::mutex rungMutex;
+BitrateRung rungRequest = {};
+BitrateStats rungRequestStats = {};
+volatile uint32_t rungRequestSeq = 0;
+uint32_t rungAppliedSeq = 0;
+BitrateRung abrRung = {};             // capture context: last rung posted by the controller
+BitrateStats abrStats = {};
+FramePipeline* pipeline = NULL;
+
+/**
+ * Largest frame size of the ladder (frame buffers must be allocated for it)
+ */
+constexpr framesize_t abrMaxFrameSize() {
+    uint8_t maxSize = 0;
+    for (size_t i = 0; i < sizeof(abrLadder) / sizeof(abrLadder[0]); i++) {
+        if (abrLadder[i].frameSize > maxSize) maxSize = abrLadder[i].frameSize;
+    }
+    return (framesize_t)maxSize;
+}
+
+/**
+ * Frame interval for pacing and the capture task
+ */
+void setFrameInterval(uint32_t intervalMs) {
+    frameIntervalMs = intervalMs;
+    framePacer.setInterval(intervalMs * 1000, (uint64_t)esp_timer_get_time());
+    if (pipeline != NULL) {
+        pipeline->setFrameInterval(intervalMs);
+    }
+}
+
+/**
+ * Apply the last posted rung to the sensor and frame pacing (capture context)
+ * - With an ROI set, the rung's frame size sets the window's pixel density
+ */
+void applyBitrateRung() {
+    const BitrateRung& rung = abrRung;
+    uint32_t intervalMs = rung.intervalMs;
+    sensor_t* s = esp_camera_sensor_get();
+    if (s != NULL) {
+        intervalMs = applyView(s, (framesize_t)rung.frameSize, rung.intervalMs);
+        s->set_quality(s, rung.jpegQuality);
+    }
+    setFrameInterval(intervalMs);
+    activeProfile.frameSize = rung.frameSize;
+    activeProfile.jpegQuality = rung.jpegQuality;
+    activeProfile.intervalMs = rung.intervalMs;
+    LOG_INFO("[ABR] Rung %u: framesize=%u quality=%u interval=%ums",
+             (unsigned)abrStats.rung, rung.frameSize, rung.jpegQuality, (unsigned)intervalMs);
+    LOG_INFO("[ABR]   send %.1fms, %.0fkbps, RSSI %d", abrStats.avgSendMs, abrStats.throughputKbps, abrStats.rssiDbm);
+}
+
+/**
+ * Start the bitrate controller on the initial rung
+ */
+void initBitrateController() {
+    BitrateConfig config;
+    config.ladder = abrLadder;
+    config.ladderSize = abrLadderSize;
+    config.initialRung = ABR_INITIAL_RUNG;  // clamped to the ladder in use
+    config.rssiDownDbm = ABR_RSSI_DOWN_DBM;
+    config.rssiUpDbm = ABR_RSSI_UP_DBM;
+    abr = new BitrateController(config);
+    abrRung = abr->getRung();
+    abrStats = abr->getStats();
+    applyBitrateRung();
+}
+
+/**
+ * Hand the controller's rung to the capture context, which owns the sensor
+ */
+void requestBitrateRung() {
+    std::lock_guard<std::mutex> lock(rungMutex);
+    rungRequest = abr->getRung();
+    rungRequestStats = abr->getStats();
+    rungRequestSeq = rungRequestSeq + 1;
+}
+
+/**
+ * Feed one send measurement to the controller and post rung changes
+ * - Called from whichever context sends frames (loop() or network task)
+ * - The capture context applies the rung before its next grab (kept while a PROFILE is pinned)
+ */
+void recordFrameSent(size_t bytes, uint32_t sendUs) {
+    if (telemetry != NULL) {
+        telemetry->record(Metric::SendUs, sendUs);
+        telemetry->record(Metric::FrameBytes, (uint32_t)bytes);
+    }
+    markBootStage(BootStage::FirstFrame);
+    if (abr == NULL) {
+        return;
+    }
+    uint32_t now = millis();
+    bool changed = abr->onFrameSent(bytes, sendUs, now);
+    if (now - lastRssiTime >= 1000) {
+        abr->onRssi((int8_t)WiFi.RSSI());
+        lastRssiTime = now;
+    }
+    changed = abr->update(now) || changed;
+    if (changed) {
+        requestBitrateRung();
+    }
+}
+
+/**
+ * Re-program the sensor for the current ROI (the full view follows the ABR rung, or a PROFILE pinned over it)
+ */
+void refreshView() {
+    if (abr != NULL && !profilePinned) {
+        applyBitrateRung();
+        return;
+    }
+    sensor_t* s = esp_camera_sensor_get();
+    if (s != NULL) {
+        setFrameInterval(applyView(s, (framesize_t)activeProfile.frameSize, activeProfile.intervalMs));
+    }
+}
+
+/**
+ * Hand an ROI (active) or ROI_OFF to the capture context
+ */
+void requestRoi(const RoiRect& roi, bool active) {
+    std::lock_guard<std::mutex> lock(roiMutex);
+    roiRequest = roi;
+    roiRequestActive = active;
+    roiRequestSeq = roiRequestSeq + 1;
+}
+
+/**
+ * Post the outcome of an ROI request for the WebSocket context (sent as ROI_STATUS)
+ */
+void postRoiResult(const char* error) {
+    std::lock_guard<std::mutex> lock(roiMutex);
+    roiError = error;
+    roiResultSeq = roiResultSeq + 1;
+}
+
+/**
+ * Apply the latest ABR rung and ROI request before the next capture (capture context)
+ * - A rung that moved while a PROFILE is pinned is kept for PROFILE:AUTO
+ */
+void applyViewRequest() {
+    bool rungMoved = false;
+    if (rungRequestSeq != rungAppliedSeq) {
+        std::lock_guard<std::mutex> lock(rungMutex);
+        abrRung = rungRequest;
+        abrStats = rungRequestStats;
+        rungAppliedSeq = rungRequestSeq;
+        rungMoved = true;
+    }
+    if (roiRequestSeq == roiAppliedSeq) {
+        if (rungMoved && !profilePinned) {
+            applyBitrateRung();
+        }
+        return;
+    }
+    RoiRect roi;
+    bool active;
+    {
+        std::lock_guard<std::mutex> lock(roiMutex);
+        roi = roiRequest;
+        active = roiRequestActive;
+        roiAppliedSeq = roiRequestSeq;
+    }
+
+    bool wasActive = sensorWindow->isActive();
+    const char* error = NULL;
+    if (!active) {
+        sensorWindow->clear();
+    } else if (!sensorWindow->set(roi)) {
+        error = "invalid";  // checked by the command already: the previous ROI stays
+    }
+    refreshView();
+    if (error == NULL && active && !roiApplied) {
+        sensorWindow->clear();  // sensor without raw windowing: stay on the full view
+        error = "unsupported";
+    }
+    postRoiResult(error);
+    if (error != NULL) {
+        return;
+    }
+    if (active) {
+        LOG_INFO("[ROI] %u,%u %ux%u permille", roi.x, roi.y, roi.width, roi.height);
+        LOG_INFO("[ROI]   -> %ux%u every %u ms", roiPlan.outputWidth, roiPlan.outputHeight, (unsigned)frameIntervalMs);
+    } else if (wasActive) {
+        LOG_INFO("[ROI] Full view");
+    }
+}
+
+// ========================================
+// Memory Plan
+// ========================================
+// The Arduino core reads PSRAM support from its sdkconfig.h: a PSRAM plan needs CONFIG_SPIRAM there
+#if defined(ESP_PLATFORM) && USE_PSRAM && !defined(CONFIG_SPIRAM) && !defined(CONFIG_SPIRAM_SUPPORT)
+#error "USE_PSRAM needs a PSRAM-enabled sdkconfig (CONFIG_SPIRAM=y, see sdkconfig.esp32cam)"
+#endif
+
+/**
+ * Recording workspace (write batch + segment index) and staging queue, see SegmentStore::workspaceSize()
+ */
+constexpr uint32_t recordingBytes() {
+    return (RECORDING_BATCH_SIZE / SegmentStore::kSectorSize > 0 ? RECORDING_BATCH_SIZE / SegmentStore::kSectorSize : 1) *
+               SegmentStore::kSectorSize +
+           (uint32_t)RECORDING_SEGMENT_FRAMES * SegmentStore::kIndexEntrySize + RECORDING_STAGING_SIZE;
+}
+
+/**
+ * Large buffers and frame buffers with or without PSRAM (initCamera picks one at boot)
+ * - Without PSRAM only the send buffer is allocated: the other large buffers need PSRAM
+ */
+constexpr MemoryPlan planMemory(bool psram) {
+    MemoryPlan plan(MemoryBudget{MEMORY_DRAM_BUDGET, psram ? (uint32_t)MEMORY_PSRAM_BUDGET : 0, MEMORY_RESERVE});
+    const MemoryRegion bulk = psram ? MemoryRegion::Psram : MemoryRegion::Dram;
+    if (FRAME_ENVELOPE_ENABLED) {
+        plan.add("send", FRAME_SEND_BUFFER_SIZE, bulk);
+    }
+    if (LUMA_ENABLED) {
+        plan.add("luma", LumaStream::bufferBytes(LUMA_WIDTH, LUMA_HEIGHT), MemoryRegion::Dram);
+    }
+    if (psram) {
+        if (SNAPSHOT_ENABLED) {
+            plan.add("snapshot",
+                     SnapshotUpload::bufferSize(MemoryPlan::frameBufferBytes((uint8_t)SNAPSHOT_FRAME_SIZE),
+                                                WEBSOCKETS_MAX_HEADER_SIZE),
+                     bulk);
+        }
+        if (BACKFILL_ENABLED && FRAME_ENVELOPE_ENABLED) {
+            plan.add("backfill", BACKFILL_BUFFER_SIZE, bulk);
+        }
+        if (RECORDING_ENABLED) {
+            plan.add("recording", recordingBytes(), bulk);
+        }
+        if (MJPEG_SERVER_ENABLED) {
+            plan.add("mjpeg", FrameHub::slotsFor(MJPEG_MAX_VIEWERS) * MJPEG_SLOT_SIZE, bulk);
+        }
+    }
+
+    FrameBufferRequest request = {};
+    request.bootFrameSize = (uint8_t)FRAME_SIZE;
+    request.streamMaxFrameSize = ABR_ENABLED ? (uint8_t)abrMaxFrameSize() : (uint8_t)FRAME_SIZE;
+    request.fbCount = FB_COUNT;
+    request.minFbCount = FB_COUNT > 1 ? 2 : 1;     // keep latest-frame grabbing for the snapshot size
+    request.fbInPsram = FB_IN_PSRAM;
+    request.snapshotPreallocate = SNAPSHOT_ENABLED && SNAPSHOT_PREALLOCATE;
+    request.snapshotFrameSize = (uint8_t)SNAPSHOT_FRAME_SIZE;
+    plan.planFrameBuffers(request);
+    return plan;
+}
+
+/**
+ * The worst-case JPEG of the boot profile and of every rung kept at boot fits one frame buffer
+ */
+constexpr bool streamFits(const MemoryPlan& plan) {
+    const FrameBufferPlan& buffers = plan.frameBuffers();
+    if (MemoryPlan::worstJpegBytes((uint8_t)FRAME_SIZE, JPEG_QUALITY) > buffers.fbBytes) {
+        return false;
+    }
+    for (size_t i = 0; ABR_ENABLED && i < sizeof(abrLadder) / sizeof(abrLadder[0]); i++) {
+        if (abrLadder[i].frameSize <= buffers.streamMaxFrameSize &&
+            MemoryPlan::worstJpegBytes(abrLadder[i].frameSize, abrLadder[i].jpegQuality) > buffers.fbBytes) {
+            return false;
+        }
+    }
+    return true;
+}
+
+constexpr MemoryPlan kPsramPlan = planMemory(true);
+constexpr MemoryPlan kDramPlan = planMemory(false);
+
+static_assert(kPsramPlan.fits(), "Buffers exceed MEMORY_PSRAM_BUDGET - MEMORY_RESERVE (lower FB_COUNT or a buffer size)");
+static_assert(kDramPlan.fits(), "No frame buffer fits MEMORY_DRAM_BUDGET without PSRAM (lower FRAME_SIZE or the send buffer)");
+static_assert(streamFits(kPsramPlan) && streamFits(kDramPlan),
+              "A stream quality can exceed its frame buffer (raise JPEG_QUALITY or the ABR_LADDER quality)");
+static_assert(!ABR_ENABLED || abrLadder[0].frameSize <= kDramPlan.frameBuffers().streamMaxFrameSize,
+              "The lowest ABR rung must fit the DRAM frame buffer");
+static_assert(!SNAPSHOT_ENABLED || MemoryPlan::worstJpegBytes((uint8_t)SNAPSHOT_FRAME_SIZE, SNAPSHOT_JPEG_QUALITY) <=
+                                       MemoryPlan::frameBufferBytes((uint8_t)SNAPSHOT_FRAME_SIZE),
+              "SNAPSHOT_JPEG_QUALITY can exceed the snapshot buffer");
+
+/**
+ * Plan for this board (PSRAM detected and allowed by USE_PSRAM)
+ */
+const MemoryPlan& activeMemoryPlan() {
+    return USE_PSRAM && psramFound() ? kPsramPlan : kDramPlan;
+}
+
+/**
+ * Boot report: frame buffers, then one line per region in use
+ */
+void printMemoryPlan(const MemoryPlan& plan) {
+    const FrameBufferPlan& buffers = plan.frameBuffers();
+    uint8_t streamMax = buffers.streamMaxFrameSize;
+    Serial.printf("Memory plan: %u x %s frame buffers in %s (%u KB each), stream up to %s (q%u+ fits), snapshot %s\n",
+                  (unsigned)buffers.fbCount, ProfilePlanner::frameSizeName(buffers.frameSize),
+                  MemoryPlan::regionName(buffers.region), (unsigned)(buffers.fbBytes / 1024),
+                  ProfilePlanner::frameSizeName(streamMax), MemoryPlan::qualityFloor(streamMax, buffers.fbBytes),
+                  buffers.snapshotLive ? "live" : "re-init");
+    char line[192];
+    const MemoryRegion regions[] = {MemoryRegion::Dram, MemoryRegion::Psram};
+    for (MemoryRegion region : regions) {
+        if (plan.usedBytes(region) > 0 && plan.formatRegion(region, line, sizeof(line)) > 0) {
+            Serial.printf("  %s\n", line);
+        }
+    }
+}
+
+// ========================================
+// Camera Initialization
+// ========================================
+camera_config_t cameraConfig = {};  // Driver configuration in use (a stream profile re-init starts from it)
+
+/**
+ * Motion gate thumbnail size: one byte per 8x8 block
+ */
+size_t motionGateBlocks(framesize_t frameSize) {
+    return (size_t)((resolution[frameSize].width + 7) / 8) * ((resolution[frameSize].height + 7) / 8);
+}
+
+/**
+ * Track the driver's buffers (call before esp_camera_init, with no buffer held)
+ */
+void configureFrameRing(const camera_config_t& config) {
+    FrameRingConfig ringConfig;
+    ringConfig.bufferCount = config.fb_count;
+    ringConfig.usePsram = config.fb_location == CAMERA_FB_IN_PSRAM;
+    ringConfig.maxFrameAgeMs = MAX_FRAME_AGE_MS;
+    frameRing.configure(ringConfig);
+}
+
+/**
+ * Image settings (after every driver init)
+ */
+void applySensorSettings(sensor_t* s) {
+    // Adjust settings for better performance
+    s->set_brightness(s, 0);     // -2 to 2
+    s->set_contrast(s, 0);       // -2 to 2
+    s->set_saturation(s, 0);     // -2 to 2
+    s->set_special_effect(s, 0); // 0 to 6 (0 - No Effect)
+    s->set_whitebal(s, 1);       // 0 = disable , 1 = enable
+    s->set_awb_gain(s, 1);       // 0 = disable , 1 = enable
+    s->set_wb_mode(s, 0);        // 0 to 4
+    s->set_exposure_ctrl(s, 1);  // 0 = disable , 1 = enable
+    s->set_aec2(s, 0);           // 0 = disable , 1 = enable
+    s->set_gain_ctrl(s, 1);      // 0 = disable , 1 = enable
+    s->set_agc_gain(s, 0);       // 0 to 30
+    s->set_gainceiling(s, (gainceiling_t)0); // 0 to 6
+    s->set_bpc(s, 0);            // 0 = disable , 1 = enable
+    s->set_wpc(s, 1);            // 0 = disable , 1 = enable
+    s->set_raw_gma(s, 1);        // 0 = disable , 1 = enable
+    s->set_lenc(s, 1);           // 0 = disable , 1 = enable
+    s->set_hmirror(s, 0);        // 0 = disable , 1 = enable
+    s->set_vflip(s, 0);          // 0 = disable , 1 = enable
+    s->set_dcw(s, 1);            // 0 = disable , 1 = enable
+    s->set_colorbar(s, 0);       // 0 = disable , 1 = enable
+}
+
+bool initCamera() {
+    Serial.println("Initializing camera...");
+    
+    camera_config_t config = {};
+    config.ledc_channel = LEDC_CHANNEL_0;
+    config.ledc_timer = LEDC_TIMER_0;
+    config.pin_d0 = Y2_GPIO_NUM;
+    config.pin_d1 = Y3_GPIO_NUM;
+    config.pin_d2 = Y4_GPIO_NUM;
+    config.pin_d3 = Y5_GPIO_NUM;
+    config.pin_d4 = Y6_GPIO_NUM;
+    config.pin_d5 = Y7_GPIO_NUM;
+    config.pin_d6 = Y8_GPIO_NUM;
+    config.pin_d7 = Y9_GPIO_NUM;
+    config.pin_xclk = XCLK_GPIO_NUM;
+    config.pin_pclk = PCLK_GPIO_NUM;
+    config.pin_vsync = VSYNC_GPIO_NUM;
+    config.pin_href = HREF_GPIO_NUM;
+    config.pin_sccb_sda = SIOD_GPIO_NUM;  // Fixed deprecated name
+    config.pin_sccb_scl = SIOC_GPIO_NUM;  // Fixed deprecated name
+    config.pin_pwdn = PWDN_GPIO_NUM;
+    config.pin_reset = RESET_GPIO_NUM;
+    config.xclk_freq_hz = XCLK_FREQ_MHZ * 1000000;
+    config.pixel_format = PIXFORMAT_JPEG;
+    
+    // Boot stream profile from Config.h (ABR and PROFILE change it at runtime)
+    config.frame_size = FRAME_SIZE;
+    config.jpeg_quality = JPEG_QUALITY;
+    
+    // Buffers from the compile-time plan: sized for the largest ABR rung, or for the snapshot size
+    // (live switch, no driver re-init) when PSRAM holds enough of them
+    const MemoryPlan& plan = activeMemoryPlan();
+    const FrameBufferPlan& buffers = plan.frameBuffers();
+    config.frame_size = (framesize_t)buffers.frameSize;
+    config.fb_count = buffers.fbCount;
+    config.fb_location = buffers.region == MemoryRegion::Psram ? CAMERA_FB_IN_PSRAM : CAMERA_FB_IN_DRAM;
+    Serial.println(psramFound() ? "PSRAM found - Cloud-optimized mode (frame ring)" : "PSRAM not found - single frame buffer");
+    printMemoryPlan(plan);
+    framesize_t streamMaxSize = (framesize_t)buffers.streamMaxFrameSize;
+    
+    // Rungs larger than the buffers are dropped (the ladder goes from small to large)
+    abrLadderSize = 0;
+    while (abrLadderSize < sizeof(abrLadder) / sizeof(abrLadder[0]) &&
+           abrLadder[abrLadderSize].frameSize <= buffers.streamMaxFrameSize) {
+        abrLadderSize++;
+    }
+    
+    // Latest-frame grabbing needs at least two buffers (driver falls back otherwise)
+    config.grab_mode = config.fb_count > 1 ? CAMERA_GRAB_LATEST : CAMERA_GRAB_WHEN_EMPTY;
+    
+    configureFrameRing(config);
+    Serial.printf("Frame ring: %d buffers in %s, max age %d ms\n",
+                  (int)config.fb_count, config.fb_location == CAMERA_FB_IN_PSRAM ? "PSRAM" : "DRAM", MAX_FRAME_AGE_MS);
+    
+    // Initialize camera
+    esp_err_t err = esp_camera_init(&config);
+    if (err != ESP_OK) {
+        Serial.printf("Camera init failed with error 0x%x\n", err);
+        return false;
+    }
+    cameraConfig = config;
+    activeProfile.frameSize = (uint8_t)FRAME_SIZE;
+    activeProfile.jpegQuality = JPEG_QUALITY;
+    activeProfile.intervalMs = FRAME_INTERVAL;
+    activeProfile.xclkMhz = XCLK_FREQ_MHZ;
+    
+    // Motion gate thumbnail: one byte per 8x8 block of the largest streamed frame size (not the snapshot's)
+    // - The luma side-stream resamples the same thumbnail: without MOTION_GATE_ENABLED it scores but never gates
+    if (MOTION_GATE_ENABLED || LUMA_ENABLED) {
+        MotionGateConfig gateConfig;
+        gateConfig.enabled = MOTION_GATE_ENABLED;
+        gateConfig.maxBlocks = motionGateBlocks(streamMaxSize);
+        gateConfig.blockThreshold = MOTION_BLOCK_THRESHOLD;
+        gateConfig.motionPermille = MOTION_SCORE_THRESHOLD;
+        gateConfig.holdMs = MOTION_HOLD_MS;
+        gateConfig.keepAliveMs = MOTION_KEEPALIVE_MS;
+        motionGate = new MotionGate(gateConfig);
+        Serial.printf("Motion gate: %u blocks, keep-alive %d ms%s\n", (unsigned)gateConfig.maxBlocks, MOTION_KEEPALIVE_MS,
+                      MOTION_GATE_ENABLED ? "" : " (scoring only)");
+    }
+    
+    // Camera sensor settings
+    sensor_t* s = esp_camera_sensor_get();
+    if (s != NULL) {
+        applySensorSettings(s);
+        // Buffers may be larger than the boot frame size (ABR ladder)
+        s->set_framesize(s, FRAME_SIZE);
+    }
+    
+    Serial.println("Camera initialized successfully");
+    return true;
+}
+
+// ========================================
+// WiFi Connection
+// ========================================
+WifiConnector* wifiConnector = NULL;   // Non-blocking join and retries (polled from loop())
+WifiCache wifiCache = {};              // Last association, reused by the next join (NVS)
+Preferences preferences;
+
+/**
+ * Load the last association from NVS
+ * @return true if it is usable for WIFI_SSID
+ */
+bool loadWifiCache() {
+    uint8_t blob[WifiCache::kEncodedSize];
+    size_t length = 0;
+    if (preferences.begin(WIFI_CACHE_NAMESPACE, true)) {
+        length = preferences.getBytes("assoc", blob, sizeof(blob));
+        preferences.end();
+    }
+    return wifiCache.decode(blob, length) && wifiCache.isValidFor(WIFI_SSID);
+}
+
+/**
+ * Store the current association (only when it changed: NVS writes wear the flash)
+ */
+void storeWifiCache() {
+    const uint8_t* bssid = WiFi.BSSID();
+    if (bssid == NULL) {
+        return;
+    }
+    WifiCache current;
+    current.clear();
+    memcpy(current.bssid, bssid, sizeof(current.bssid));
+    current.channel = (uint8_t)WiFi.channel();
+    current.ssidHash = WifiCache::hashSsid(WIFI_SSID);
+    current.localIp = (uint32_t)WiFi.localIP();
+    current.gateway = (uint32_t)WiFi.gatewayIP();
+    current.subnet = (uint32_t)WiFi.subnetMask();
+    current.dns = (uint32_t)WiFi.dnsIP();
+
+    uint8_t blob[WifiCache::kEncodedSize];
+    uint8_t stored[WifiCache::kEncodedSize];
+    current.encode(blob, sizeof(blob));
+    wifiCache.encode(stored, sizeof(stored));
+    if (memcmp(blob, stored, sizeof(blob)) != 0 && preferences.begin(WIFI_CACHE_NAMESPACE, false)) {
+        preferences.putBytes("assoc", blob, sizeof(blob));
+        preferences.end();
+        LOG_INFO("[WiFi] Cached BSSID %02X:%02X:%02X:%02X:%02X:%02X", bssid[0], bssid[1], bssid[2], bssid[3],
+                 bssid[4], bssid[5]);
+        LOG_INFO("[WiFi]   channel %u", current.channel);
+    }
+    wifiCache = current;
+    wifiConnector->onCacheStored();
+}
+
+/**
+ * Start one join (returns at once; the WiFi task associates in the background)
+ * - Cached: known BSSID/channel, no scan, and with WIFI_REUSE_LEASE the previous lease as a
+ *   static IP (no DHCP)
+ */
+void beginWiFi(bool cached) {
+    WiFi.disconnect();
+    if (cached && WIFI_REUSE_LEASE && wifiCache.hasLease()) {
+        WiFi.config(IPAddress(wifiCache.localIp), IPAddress(wifiCache.gateway),
+                    IPAddress(wifiCache.subnet), IPAddress(wifiCache.dns));
+    } else {
+        WiFi.config(IPAddress(), IPAddress(), IPAddress());  // DHCP
+    }
+    if (cached) {
+        WiFi.begin(WIFI_SSID, WIFI_PASSWORD, wifiCache.channel, wifiCache.bssid);
+    } else {
+        WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
+    }
+}
+
+/**
+ * Carry out what the connector asks for
+ */
+void handleWifiEvent(WifiEvent event) {
+    switch (event) {
+        case WifiEvent::BeginCached:
+            beginWiFi(true);
+            break;
+
+        case WifiEvent::BeginScan:
+            LOG_INFO("[WiFi] Scanning for %s", WIFI_SSID);
+            beginWiFi(false);
+            break;
+
+        case WifiEvent::Backoff:
+            WiFi.disconnect();
+            LOG_WARN("[WiFi] Not connected, retrying in %u ms", wifiConnector->getBackoffMs());
+            break;
+
+        case WifiEvent::Lost:
+            LOG_WARN("[WiFi] Connection lost");
+            break;
+
+        case WifiEvent::Connected: {
+            const WifiConnectorStats& stats = wifiConnector->getStats();
+            LOG_INFO("[WiFi] Connected in %u ms (%s), IP %s, RSSI %d dBm", stats.lastJoinMs,
+                     stats.lastJoinCached ? "cached BSSID/channel" : "scan",
+                     WiFi.localIP().toString().c_str(), (int)WiFi.RSSI());
+            if (markBootStage(BootStage::WiFi) && stats.lastJoinCached && telemetry != NULL) {
+                telemetry->markCachedJoin();
+            }
+            if (WIFI_FAST_CONNECT) {
+                storeWifiCache();
+            }
+            break;
+        }
+
+        default:
+            break;
+    }
+}
+
+/**
+ * Bring the station up and start the first join
+ * - Called before camera init: the radio associates while the sensor is configured
+ */
+void startWiFi() {
+    WiFi.persistent(false);        // the cache below replaces the SDK's own NVS copy
+    WiFi.mode(WIFI_STA);
+    WiFi.setSleep(false);          // Disable WiFi power saving for lower latency
+    WiFi.setAutoReconnect(false);  // rejoins are driven by the connector
+
+    WifiConnectorConfig config;
+    config.cachedTimeoutMs = WIFI_CACHED_TIMEOUT;
+    config.scanTimeoutMs = WIFI_CONNECT_TIMEOUT;
+    config.minBackoffMs = WIFI_RETRY_DELAY;
+    config.maxBackoffMs = WIFI_RETRY_MAX_DELAY;
+    wifiConnector = new WifiConnector(config);
+
+    bool cached = WIFI_FAST_CONNECT && loadWifiCache();
+    Serial.printf("Connecting to WiFi: %s (%s)\n", WIFI_SSID, cached ? "cached BSSID/channel" : "scan");
+    handleWifiEvent(wifiConnector->begin(cached, millis()));
+}
+
+/**
+ * Poll the connector (loop(); never blocks)
+ */
+void serviceWiFi() {
+    if (wifiConnector != NULL) {
+        handleWifiEvent(wifiConnector->update(WiFi.status() == WL_CONNECTED, millis()));
+    }
+}
+
+// ========================================
+// Telemetry Helpers
+// ========================================
+/**
+ * Create the telemetry aggregator and open the first window
+ */
+void initTelemetry() {
+    TelemetryConfig config;
+    config.publishIntervalMs = TELEMETRY_INTERVAL;
+    telemetry = new Telemetry(config);
+    telemetry->resetWindow((uint64_t)esp_timer_get_time());
+    Serial.printf("Telemetry: snapshot every %d ms (and on STATS)\n", TELEMETRY_INTERVAL);
+}
+
+/**
+ * Send the snapshot of the current window and start a new one
+ * - Called from the context that owns the WebSocket (STATS command or serviceTelemetry)
+ * - The serial copy is handed to loop() (up to 1 KB: ~90 ms of UART at 115200)
+ */
+void publishTelemetry() {
+    uint64_t nowUs = (uint64_t)esp_timer_get_time();
+    size_t length = telemetry->format(telemetrySnapshot, sizeof(telemetrySnapshot), nowUs);
+    if (length > 6) {
+        if (isConnected) {
+            webSocket.sendTXT(telemetrySnapshot, length);
+        }
+        // loop() still printing the previous one: this one only goes to the server
+        std::unique_lock<std::mutex> lock(statsLineMutex, std::try_to_lock);
+        if (lock.owns_lock()) {
+            memcpy(statsLine, telemetrySnapshot + 6, length - 6);  // skip "STATS:"
+            statsLine[length - 6] = '\0';
+            statsLinePending = true;
+        }
+    }
+    telemetry->resetWindow(nowUs);
+}
+
+/**
+ * Print the last published snapshot (loop())
+ */
+void logStatsLine() {
+    std::lock_guard<std::mutex> lock(statsLineMutex);
+    Serial.printf("[Stats] %s\n", statsLine);
+    statsLinePending = false;
+}
+
+/**
+ * Publish the periodic snapshot when due
+ */
+void serviceTelemetry() {
+    if (telemetry != NULL && telemetry->publishDue((uint64_t)esp_timer_get_time())) {
+        publishTelemetry();
+    }
+}
+
+/**
+ * Record how late a pacing tick fired (capture task or loop())
+ */
+void recordPaceTick(uint32_t latenessUs) {
+    if (telemetry != NULL) {
+        telemetry->record(Metric::PaceJitterUs, latenessUs);
+    }
+}
+
+// Held by the capture context while it re-initialises the driver or switches it for a snapshot;
+// loop()'s offline grab skips its slot meanwhile (the pipeline's capture task only leaves the
+// driver idle between two acquire() calls)
+std::mutex cameraMutex;
+
+/**
+ * Grab a frame from the driver, timing the call
+ */
+camera_fb_t* grabFrame() {
+    uint32_t startUs = (uint32_t)esp_timer_get_time();
+    camera_fb_t* fb = esp_camera_fb_get();
+    if (fb != NULL && telemetry != NULL) {
+        telemetry->record(Metric::CaptureUs, (uint32_t)esp_timer_get_time() - startUs);
+    }
+    return fb;
+}
+
+/**
+ * Capture timestamp of a frame buffer (esp_timer clock, microseconds)
+ */
+uint64_t frameCaptureMicros(const camera_fb_t* fb) {
+    return (uint64_t)fb->timestamp.tv_sec * 1000000ULL + fb->timestamp.tv_usec;
+}
+
+// ========================================
+// Local Recording Helpers
+// ========================================
+/**
+ * Mount the microSD card and start the segment writer
+ */
+void initRecording() {
+    // 1-bit mode leaves GPIO 4 (flash LED) and GPIO 12 (LED_PIN) free
+    if (!SD_MMC.begin(RECORDING_MOUNT_POINT, true)) {
+        Serial.println("Recording disabled (no microSD card)");
+        return;
+    }
+    if (!psramFound()) {
+        Serial.println("Recording disabled (needs PSRAM)");
+        return;
+    }
+    SegmentStoreConfig storeConfig;
+    storeConfig.directory = RECORDING_DIRECTORY;
+    storeConfig.segmentDurationMs = RECORDING_SEGMENT_MS;
+    storeConfig.segmentMaxBytes = RECORDING_SEGMENT_BYTES;
+    storeConfig.segmentMaxFrames = RECORDING_SEGMENT_FRAMES;
+    storeConfig.batchBytes = RECORDING_BATCH_SIZE;
+    storeConfig.flushIntervalMs = RECORDING_FLUSH_INTERVAL;
+    storeConfig.retentionBytes = (uint64_t)RECORDING_RETENTION_MB * 1024 * 1024;
+    storeConfig.retentionSegments = RECORDING_RETENTION_SEGMENTS;
+    SegmentRecorderConfig config;
+    config.stagingBytes = RECORDING_STAGING_SIZE;
+    config.recordIntervalMs = RECORDING_INTERVAL;
+    config.writerCore = RECORDING_WRITER_CORE;
+
+    uint8_t* workspace = (uint8_t*)ps_malloc(SegmentStore::workspaceSize(storeConfig));
+    uint8_t* staging = (uint8_t*)ps_malloc(RECORDING_STAGING_SIZE);
+    if (workspace == NULL || staging == NULL) {
+        Serial.println("Recording buffer allocation failed");
+        free(workspace);
+        free(staging);
+        return;
+    }
+    recorder = new SegmentRecorder(storeConfig, config, workspace, staging);
+    if (!recorder->start()) {
+        Serial.printf("Recording disabled (cannot open %s)\n", RECORDING_DIRECTORY);
+        delete recorder;
+        recorder = NULL;
+        return;
+    }
+    Serial.printf("Recording: %s, %llu MB card, 1 frame / %u ms, %u segments kept\n",
+                  RECORDING_DIRECTORY, (unsigned long long)(SD_MMC.totalBytes() / (1024 * 1024)),
+                  RECORDING_INTERVAL, (unsigned)recorder->segmentCount());
+}
+
+/**
+ * Copy a frame into the recording when the recording interval has elapsed
+ * - Called from the capture context; never waits for the card
+ * - Timestamps are server epoch µs once the clock is synced (REC_EXPORT ranges use that clock)
+ */
+void recordLocalFrame(const uint8_t* jpeg, size_t length, uint64_t captureUs, uint16_t motionScore) {
+    uint64_t nowUs = (uint64_t)esp_timer_get_time();
+    if (recorder == NULL || !recorder->recordDue(nowUs)) {
+        return;
+    }
+    bool synced = clockSync != NULL && clockSync->isSynced();
+    uint8_t flags = (synced ? kEnvelopeClockSynced : 0) |
+                    (motionScore >= MOTION_SCORE_THRESHOLD ? kEnvelopeMotion : 0);
+    uint64_t timeUs = synced ? clockSync->toServerUs(captureUs) : captureUs;
+    recorder->submit(timeUs, jpeg, (uint32_t)length, flags, nowUs);  // FIFO full: counted as dropped
+}
+
+/**
+ * Render the REC_LIST reply: `REC_INDEX:{json}` with the segment catalog (newest segments that fit)
+ */
+void formatRecordingIndex(CommandReply& reply) {
+    const size_t kMaxListed = 8;
+    SegmentInfo segments[kMaxListed];
+    size_t count = recorder->catalog(segments, kMaxListed);
+    SegmentRecorderStats stats = recorder->getStats();
+
+    reply.appendf("REC_INDEX:{\"total\":%u,\"staged\":%u,\"dropped\":%u,\"segments\":[",
+                  (unsigned)recorder->segmentCount(), stats.stagedFrames, stats.dropped);
+    for (size_t i = 0; i < count; i++) {
+        reply.appendf("%s{\"id\":%u,\"fromMs\":%llu,\"toMs\":%llu,\"frames\":%u,\"kb\":%llu,\"open\":%s}",
+                      i > 0 ? "," : "", segments[i].id,
+                      (unsigned long long)(segments[i].firstUs / 1000), (unsigned long long)(segments[i].lastUs / 1000),
+                      segments[i].frames, (unsigned long long)(segments[i].bytes / 1024),
+                      segments[i].open ? "true" : "false");
+    }
+    reply.append("]}");
+}
+
+/**
+ * Start a time-range export: `REC_EXPORT:<fromMs>:<toMs>` (recording clock, see recordLocalFrame)
+ * - Frames are streamed between live frames by serviceRecordingExport(), then `REC_EXPORT_DONE:<frames>`
+ * @param range `<fromMs>:<toMs>`
+ */
+void startRecordingExport(const char* range, CommandReply& reply) {
+    unsigned long long fromMs = 0;
+    unsigned long long toMs = 0;
+    // Exported frames need the envelope (historical/recorded flags)
+    if (sendBuffer == NULL || sscanf(range, "%llu:%llu", &fromMs, &toMs) != 2 || toMs < fromMs) {
+        reply.append("REC_EXPORT_DONE:0");
+        return;
+    }
+    exportSent = 0;
+    exportEndUs = toMs * 1000;
+    exportActive = recorder->seek(fromMs * 1000, exportCursor);
+    if (!exportActive) {
+        reply.append("REC_EXPORT_DONE:0");
+        return;
+    }
+    LOG_INFO("[Rec] Export %llu..%llu ms started", fromMs, toMs);
+}
+
+/**
+ * Print recording counters
+ */
+void logRecordingStats() {
+    SegmentRecorderStats stats = recorder->getStats();
+    SegmentStoreStats store = recorder->getStoreStats();
+    Serial.printf("[Rec] written=%u staged=%u (peak %u KB) dropped=%u errors=%u segments(+%u -%u recovered=%u) writes=%u flushes=%u pad=%u KB\n",
+                  stats.written, stats.stagedFrames, stats.maxStagedBytes / 1024, stats.dropped,
+                  stats.writeErrors + store.errors, store.segmentsCreated, store.segmentsDeleted, store.segmentsRecovered,
+                  store.writeCalls, store.flushes, store.padBytes / 1024);
+}
+
+// ========================================
+// Local MJPEG Server Helpers
+// ========================================
+/**
+ * Allocate the viewer frame slots and start the HTTP server task (after the station is started)
+ */
+void initMjpegServer() {
+    if (!psramFound()) {
+        Serial.println("MJPEG server disabled (needs PSRAM)");
+        return;
+    }
+    const size_t slots = FrameHub::slotsFor(MJPEG_MAX_VIEWERS);
+    uint8_t* arena = (uint8_t*)ps_malloc(slots * MJPEG_SLOT_SIZE);
+    if (arena == NULL) {
+        Serial.println("MJPEG slot allocation failed");
+        return;
+    }
+    frameHub = new FrameHub(arena, slots, MJPEG_SLOT_SIZE);
+    MjpegServerConfig config;
+    config.port = MJPEG_PORT;
+    config.path = MJPEG_PATH;
+    config.maxViewers = MJPEG_MAX_VIEWERS;
+    config.core = MJPEG_SERVER_CORE;
+    mjpegServer = new MjpegServer(*frameHub, config);
+    if (!mjpegServer->start()) {
+        Serial.printf("MJPEG server disabled (cannot listen on port %d)\n", MJPEG_PORT);
+        delete mjpegServer;
+        mjpegServer = NULL;
+        return;
+    }
+    Serial.printf("MJPEG server: port %d %s, %d viewers, %u x %u KB PSRAM\n",
+                  MJPEG_PORT, MJPEG_PATH, MJPEG_MAX_VIEWERS, (unsigned)slots, MJPEG_SLOT_SIZE / 1024);
+}
+
+/**
+ * Hand a captured frame to the local viewers (one copy, only while someone watches)
+ * - Called from the capture context before the motion gate: the LAN gets every frame
+ */
+void publishLocalFrame(const uint8_t* jpeg, size_t length, uint64_t captureUs) {
+    if (mjpegServer == NULL || !frameHub->hasReaders()) {
+        return;
+    }
+    frameHub->publish(jpeg, length, captureUs);
+    lastLocalFrameUs = (uint64_t)esp_timer_get_time();
+}
+
+/**
+ * Check if local viewers need a frame while nothing else captures (cloud link down)
+ */
+bool localFrameDue(uint64_t nowUs) {
+    return mjpegServer != NULL && frameHub->hasReaders() &&
+           nowUs - lastLocalFrameUs >= (uint64_t)frameIntervalMs * 1000;
+}
+
+/**
+ * Print local viewer counters
+ */
+void logMjpegStats() {
+    MjpegServerStats stats = mjpegServer->getStats();
+    FrameHubStats hub = frameHub->getStats();
+    Serial.printf("[MJPEG] viewers=%u accepted=%u rejected=%u closed=%u (stalled %u) frames sent=%u skipped=%u %llu KB published=%u noSlot=%u oversized=%u\n",
+                  stats.viewers, stats.accepted, stats.rejected, stats.closed, stats.stalled,
+                  stats.framesSent, stats.framesSkipped, (unsigned long long)(stats.bytesSent / 1024),
+                  hub.published, hub.noSlot, hub.oversized);
+}
+
+// ========================================
+// Stream Demand
+// ========================================
+StreamDemand* streamDemand = NULL;  // Upload mode from the relay's consumer set, NULL if disabled
+static const uint32_t kDemandReset = 0xFFFFFFFFu;
+volatile uint32_t demandRequest = kDemandReset;  // (live << 16) | analyzer, set by the network task
+volatile uint32_t demandRequestSeq = 0;
+uint32_t demandAppliedSeq = 0;                     // capture task side
+
+/**
+ * Create the demand gate (live until the relay sends a consumer set)
+ */
+void initStreamDemand() {
+    StreamDemandConfig config;
+    config.analyzerIntervalMs = DEMAND_ANALYZER_INTERVAL;
+    config.lingerMs = DEMAND_LINGER_MS;
+    streamDemand = new StreamDemand(config);
+    Serial.printf("Demand: analyzer-only every %u ms, ramp-down after %u ms\n",
+                  DEMAND_ANALYZER_INTERVAL, DEMAND_LINGER_MS);
+}
+
+/**
+ * Hand a consumer set (or kDemandReset) to the capture task, which owns the gate
+ */
+void requestDemand(uint32_t request) {
+    demandRequest = request;
+    demandRequestSeq = demandRequestSeq + 1;
+}
+
+/**
+ * Apply the latest request from the network task (capture task)
+ */
+void applyDemandRequest(uint32_t nowMs) {
+    uint32_t seq = demandRequestSeq;
+    if (seq == demandAppliedSeq) {
+        return;
+    }
+    demandAppliedSeq = seq;
+    uint32_t request = demandRequest;
+    if (request == kDemandReset) {
+        streamDemand->reset(nowMs);
+        return;
+    }
+    ConsumerSet set;
+    set.live = (uint16_t)(request >> 16);
+    set.analyzer = (uint16_t)request;
+    streamDemand->setConsumers(set, nowMs);
+}
+
+/**
+ * Upload decision for a frame the motion gate scored (capture task)
+ * @param wanted The motion gate would upload it
+ */
+bool admitDemand(bool wanted, uint32_t bytes) {
+    uint32_t nowMs = millis();
+    StreamMode before = streamDemand->getMode();
+    applyDemandRequest(nowMs);
+    bool send = streamDemand->admit(wanted, bytes, nowMs);
+    StreamMode after = streamDemand->getMode();
+    if (after != before) {
+        const ConsumerSet& set = streamDemand->getConsumers();
+        LOG_INFO("[Demand] %s -> %s (%u viewers, %u analyzers)", StreamDemand::modeName(before),
+                 StreamDemand::modeName(after), set.live, set.analyzer);
+    }
+    return send;
+}
+
+/**
+ * Print demand counters and reset them
+ */
+void logDemandStats() {
+    StreamDemandStats stats = streamDemand->getStats();
+    Serial.printf("[Demand] mode=%s sent=%u suppressed=%u (%llu KB saved) changes=%u rampUps=%u time live/analyzer/idle=%u/%u/%u s\n",
+                  StreamDemand::modeName(streamDemand->getMode()), stats.sent, stats.suppressed,
+                  (unsigned long long)(stats.suppressedBytes / 1024), stats.modeChanges, stats.rampUps,
+                  stats.modeMs[(int)StreamMode::Live] / 1000, stats.modeMs[(int)StreamMode::Analyzer] / 1000,
+                  stats.modeMs[(int)StreamMode::Idle] / 1000);
+    streamDemand->resetStats();
+}
+
+// ========================================
+// Luma Side-Stream
+// ========================================
+LumaStream* lumaStream = NULL;      // Gray planes for the analyzer ("LUM" messages), NULL if disabled
+unsigned long lastLumaStatsTime = 0;
+
+/**
+ * Create the side-stream (planes come from the motion gate's thumbnail)
+ */
+void initLumaStream() {
+    LumaStreamConfig config;
+    config.width = LUMA_WIDTH;
+    config.height = LUMA_HEIGHT;
+    config.intervalMs = LUMA_INTERVAL;
+    config.deadband = LUMA_DEADBAND;
+    config.keyInterval = LUMA_KEY_INTERVAL;
+    config.headroom = WEBSOCKETS_MAX_HEADER_SIZE;
+    lumaStream = new LumaStream(config);
+    Serial.printf("Luma side-stream: up to %ux%u every %u ms, deadband %u, key plane every %u\n", LUMA_WIDTH, LUMA_HEIGHT,
+                  LUMA_INTERVAL, LUMA_DEADBAND, LUMA_KEY_INTERVAL);
+}
+
+/**
+ * An analyzer consumes the planes (always while the relay sends no consumer set)
+ * - Capture task: the consumer set was applied by admitDemand()
+ */
+bool lumaWanted() {
+    return streamDemand == NULL || !streamDemand->isSubscribed() || streamDemand->getConsumers().analyzer > 0;
+}
+
+/**
+ * Take the thumbnail the motion gate just decoded as the next plane when the interval is due
+ * - Capture context, right after MotionGate::evaluate() (the thumbnail is valid until the next one)
+ */
+void publishLumaPlane(uint64_t captureUs) {
+    if (!lumaWanted()) {
+        return;
+    }
+    MotionGateStats stats = motionGate->getStats();
+    sensor_t* sensor = esp_camera_sensor_get();
+    uint8_t frameSize = sensor != NULL ? (uint8_t)sensor->status.framesize : 0;
+    lumaStream->publish(motionGate->getThumbnail(), stats.widthBlocks, stats.heightBlocks, frameSize, captureUs,
+                        millis());
+}
+
+/**
+ * Send the waiting plane
+ * - Called only from the context that owns the WebSocket, between live frames (a plane is a
+ *   few hundred bytes, a key plane at most LUMA_WIDTH × LUMA_HEIGHT)
+ * - The WebSocket header goes into the room in front of the message (no copy)
+ */
+void serviceLumaStream() {
+    if (!isConnected || !lumaStream->hasPending()) {
+        return;
+    }
+    bool synced = clockSync != NULL && clockSync->isSynced();
+    int64_t offsetUs = synced ? clockSync->getStats().offsetUs : 0;
+    uint8_t* message = NULL;
+    size_t length = 0;
+    if (!lumaStream->encode(synced, offsetUs, message, length)) {
+        return;
+    }
+    bool sent = webSocket.sendBIN(message - WEBSOCKETS_MAX_HEADER_SIZE, length, true);
+    lumaStream->commit(sent, length);  // not sent: the next plane is a key plane
+}
+
+/**
+ * Render `LUMA_STATUS:{json}` (interval, plane size, counters)
+ * - width/height: the plane now sent (the thumbnail of the current frame size, never upscaled),
+ *   maxWidth/maxHeight: LUMA_WIDTH × LUMA_HEIGHT
+ */
+void formatLumaStatus(CommandReply& reply, const char* error) {
+    LumaStreamStats stats = lumaStream->getStats();
+    uint16_t width = 0;
+    uint16_t height = 0;
+    lumaStream->getPlaneSize(width, height);
+    reply.appendf("LUMA_STATUS:{\"intervalMs\":%u,\"width\":%u,\"height\":%u,\"maxWidth\":%u,\"maxHeight\":%u,",
+                  (unsigned)lumaStream->getInterval(), width, height, LUMA_WIDTH, LUMA_HEIGHT);
+    reply.appendf("\"deadband\":%u,\"sent\":%u,\"keyPlanes\":%u,\"failed\":%u,\"kb\":%llu", LUMA_DEADBAND,
+                  (unsigned)stats.sent, (unsigned)stats.keyPlanes, (unsigned)stats.failed,
+                  (unsigned long long)(stats.bytes / 1024));
+    if (error != NULL) {
+        reply.appendf(",\"error\":\"%s\"", error);
+    }
+    reply.append("}");
+}
+
+/**
+ * Print side-stream counters
+ */
+void logLumaStats() {
+    LumaStreamStats stats = lumaStream->getStats();
+    Serial.printf("[Luma] interval=%u ms published=%u sent=%u (key %u) skipped=%u failed=%u %llu KB, last payload %u B\n",
+                  (unsigned)lumaStream->getInterval(), (unsigned)stats.published, (unsigned)stats.sent,
+                  (unsigned)stats.keyPlanes, (unsigned)stats.skipped, (unsigned)stats.failed,
+                  (unsigned long long)(stats.bytes / 1024), (unsigned)stats.lastPayload);
+}
+
+// ========================================
+// Flow Control
+// ========================================
+FlowCredit* flowCredit = NULL;      // Live frames in flight to the relay's viewers, NULL if disabled
+unsigned long lastFlowStatsTime = 0;
+
+/**
+ * Create the credit window (unlimited until the relay grants credit)
+ */
+void initFlowControl() {
+    FlowCreditConfig config;
+    config.maxCredits = FLOW_CREDIT_MAX;
+    config.stallTimeoutMs = FLOW_CREDIT_STALL_MS;
+    flowCredit = new FlowCredit(config);
+    Serial.printf("Flow control: up to %u credits, probe after %u ms without credit\n",
+                  FLOW_CREDIT_MAX, FLOW_CREDIT_STALL_MS);
+}
+
+/**
+ * Check if a live frame may go out now (WebSocket context)
+ */
+bool hasFlowCredit() {
+    return flowCredit == NULL || flowCredit->canSend(millis());
+}
+
+/**
+ * Print flow control counters and reset them
+ */
+void logFlowStats() {
+    FlowCreditStats stats = flowCredit->getStats();
+    Serial.printf("[Flow] %s credits=%u granted=%u (clipped %u) sent=%u probes=%u waits=%u %llu ms (max %u ms)\n",
+                  flowCredit->isLimited() ? "limited" : "unlimited", flowCredit->getCredits(), stats.granted,
+                  stats.clipped, stats.sent, stats.probes, stats.waits, (unsigned long long)stats.waitMs,
+                  stats.maxWaitMs);
+    flowCredit->resetStats();
+}
+
+// ========================================
+// Compact Frames
+// ========================================
+JpegHeaderElider* headerElider = NULL;  // JPEG preamble epochs, NULL if disabled (WebSocket context)
+bool compactFrames = false;             // relay asked for them (JPEG_SYNC), off again on disconnect
+unsigned long lastCompactStatsTime = 0;
+
+/**
+ * Create the header elider (frames stay whole until the relay sends JPEG_SYNC)
+ */
+void initCompactFrames() {
+    headerElider = new JpegHeaderElider();
+    Serial.printf("Compact frames: JPEG preamble (up to %u bytes) once per header epoch after JPEG_SYNC\n",
+                  (unsigned)kMaxJpegPreamble);
+}
+
+/**
+ * Relay lost the header (or just connected): next frame defines a new one
+ */
+void syncCompactFrames() {
+    compactFrames = true;
+    headerElider->invalidate();
+}
+
+/**
+ * Connection lost: the next relay may not rebuild compact frames
+ */
+void resetCompactFrames() {
+    if (headerElider != NULL) {
+        compactFrames = false;
+        headerElider->invalidate();
+    }
+}
+
+/**
+ * Print header elision counters and reset them
+ */
+void logCompactStats() {
+    JpegElisionStats stats = headerElider->getStats();
+    Serial.printf("[Compact] %s frames=%u elided=%u defined=%u full=%u preamble=%u B saved=%llu KB (%.1f%%)\n",
+                  compactFrames ? "on" : "off", stats.frames, stats.elided, stats.defined, stats.full,
+                  stats.preambleLength, (unsigned long long)(stats.bytesSaved / 1024),
+                  stats.bytesIn > 0 ? 100.0 * stats.bytesSaved / stats.bytesIn : 0.0);
+    headerElider->resetStats();
+}
+
+// ========================================
+// Stream Profile
+// ========================================
+static_assert(FRAMESIZE_INVALID == ProfilePlanner::kFrameSizeCount, "profile frame sizes must follow framesize_t");
+
+ProfilePlanner* profilePlanner = NULL;  // CAPS on connect, PROFILE command; NULL if disabled
+unsigned long profileSwitches = 0;
+
+// PROFILE request (WebSocket context → capture context) and its result (back)
+std::mutex profileMutex;
+StreamProfile profileRequest = {};
+bool profileRequestAuto = false;
+volatile uint32_t profileRequestSeq = 0;
+uint32_t profileAppliedSeq = 0;
+
+/**
+ * Outcome of one PROFILE request
+ */
+struct ProfileResult {
+    StreamProfile profile;
+    bool automatic;            // back to ABR (PROFILE:AUTO)
+    bool reinit;               // frame buffers were reallocated
+    uint8_t fbCount;
+    const char* error;         // NULL if applied
+    uint32_t reinitMs;         // driver deinit + init
+    uint32_t gapMs;            // last capture before the switch → first capture after it
+};
+ProfileResult profileResult = {};
+volatile uint32_t profileResultSeq = 0;
+uint32_t profileReportedSeq = 0;
+char capsText[ProfilePlanner::kMaxCaps];  // WebSocket context
+
+ProfileResult profilePending = {};      // capture context: applied, gap not measured yet
+uint64_t lastCaptureUs = 0;
+uint64_t profileSwitchUs = 0;           // last capture before the switch (0 = no gap pending)
+
+/**
+ * Create the profile planner (the boot profile comes from Config.h, ABR drives it until PROFILE)
+ */
+void initStreamProfile() {
+    ProfileLimits limits;
+    limits.minFbCount = cameraConfig.fb_count > 1 ? 2 : 1;  // keep latest-frame grabbing
+    limits.reserveBytes = PROFILE_MEMORY_RESERVE;
+    profilePlanner = new ProfilePlanner(limits);
+    Serial.printf("Stream profile: CAPS on connect, PROFILE switches live up to %s buffers (re-init above)\n",
+                  ProfilePlanner::frameSizeName((uint8_t)cameraConfig.frame_size));
+}
+
+/**
+ * Current capabilities from the driver and the heap that holds the frame buffers
+ */
+CameraCaps readCameraCaps() {
+    CameraCaps caps = {};
+    caps.sensorName = "unknown";
+    caps.maxFrameSize = (uint8_t)cameraConfig.frame_size;
+    sensor_t* s = esp_camera_sensor_get();
+    if (s != NULL) {
+        caps.sensorPid = s->id.PID;
+        camera_sensor_info_t* info = esp_camera_sensor_get_info(&s->id);
+        if (info != NULL) {
+            caps.sensorName = info->name;
+            caps.maxFrameSize = (uint8_t)info->max_size;
+            caps.jpeg = info->support_jpeg;
+        }
+    }
+    if (caps.maxFrameSize >= ProfilePlanner::kFrameSizeCount) {
+        caps.maxFrameSize = ProfilePlanner::kFrameSizeCount - 1;  // newer sensors (QXGA and up)
+    }
+    caps.psramBytes = psramFound() ? ESP.getPsramSize() : 0;
+    caps.fbCount = (uint8_t)cameraConfig.fb_count;
+    caps.fbInPsram = cameraConfig.fb_location == CAMERA_FB_IN_PSRAM;
+    caps.fbFrameSize = (uint8_t)cameraConfig.frame_size;
+    caps.fbFreeBytes = caps.fbInPsram ? ESP.getFreePsram() : ESP.getFreeHeap();
+    caps.fbLargestFree = caps.fbInPsram ? ESP.getMaxAllocPsram() : ESP.getMaxAllocHeap();
+    caps.xclkMhz = (uint8_t)(cameraConfig.xclk_freq_hz / 1000000);
+    return caps;
+}
+
+/**
+ * Hand a PROFILE request to the capture context, which owns the sensor and the buffers
+ */
+void requestProfile(const StreamProfile& profile, bool automatic) {
+    std::lock_guard<std::mutex> lock(profileMutex);
+    profileRequest = profile;
+    profileRequestAuto = automatic;
+    profileRequestSeq = profileRequestSeq + 1;
+}
+
+/**
+ * Post a result for the WebSocket context (sent as PROFILE_STATUS)
+ */
+void postProfileResult(const ProfileResult& result) {
+    std::lock_guard<std::mutex> lock(profileMutex);
+    profileResult = result;
+    profileResultSeq = profileResultSeq + 1;
+}
+
+/**
+ * Reallocate the frame buffers for another frame size or count (capture context)
+ * - PROFILE above the buffers, and a snapshot above them (and back)
+ * - Frames queued for upload are dropped; a frame being sent is waited for
+ * - On failure the previous configuration is restored
+ */
+bool reinitCamera(const ProfilePlan& plan) {
+    if (pipeline != NULL) {
+        pipeline->flush();
+    }
+    unsigned long waitStart = millis();
+    while (frameRing.getStats().held > 0) {
+        if (millis() - waitStart >= PROFILE_DRAIN_TIMEOUT) {
+            return false;
+        }
+        delay(1);
+    }
+
+    camera_config_t config = cameraConfig;
+    config.frame_size = (framesize_t)plan.fbFrameSize;
+    config.jpeg_quality = plan.profile.jpegQuality;
+    config.fb_count = plan.fbCount;
+    config.xclk_freq_hz = plan.profile.xclkMhz * 1000000;
+    config.grab_mode = config.fb_count > 1 ? CAMERA_GRAB_LATEST : CAMERA_GRAB_WHEN_EMPTY;
+
+    esp_camera_deinit();
+    configureFrameRing(config);
+    bool success = esp_camera_init(&config) == ESP_OK;
+    if (success) {
+        cameraConfig = config;
+    } else {
+        LOG_ERROR("[Profile] Camera re-init for %s failed, restoring %s",
+                  ProfilePlanner::frameSizeName(plan.fbFrameSize),
+                  ProfilePlanner::frameSizeName((uint8_t)cameraConfig.frame_size));
+        configureFrameRing(cameraConfig);
+        if (esp_camera_init(&cameraConfig) != ESP_OK) {
+            LOG_ERROR("[Profile] Camera restore failed");
+            return false;
+        }
+    }
+    sensor_t* s = esp_camera_sensor_get();
+    if (s != NULL) {
+        applySensorSettings(s);
+    }
+    return success;
+}
+
+/**
+ * Apply the latest PROFILE request before the next capture (capture context)
+ */
+void applyProfileRequest() {
+    if (profileRequestSeq == profileAppliedSeq) {
+        return;
+    }
+    StreamProfile profile;
+    bool automatic;
+    {
+        std::lock_guard<std::mutex> lock(profileMutex);
+        profile = profileRequest;
+        automatic = profileRequestAuto;
+        profileAppliedSeq = profileRequestSeq;
+    }
+
+    ProfileResult result = {};
+    result.automatic = automatic;
+    result.fbCount = (uint8_t)cameraConfig.fb_count;
+    sensor_t* s = esp_camera_sensor_get();
+
+    if (automatic && abr != NULL) {
+        // ABR's frame sizes always fit the buffers (allocated for its largest rung, never shrunk)
+        profilePinned = false;
+        applyBitrateRung();
+        const BitrateRung& rung = abrRung;
+        result.profile.frameSize = rung.frameSize;
+        result.profile.jpegQuality = rung.jpegQuality;
+        result.profile.intervalMs = rung.intervalMs;
+        result.profile.xclkMhz = activeProfile.xclkMhz;
+    } else {
+        // Planned again here: memory may have changed since the command was checked
+        ProfilePlan plan;
+        ProfileError error = profilePlanner->plan(profile, readCameraCaps(), plan);
+        if (error != ProfileError::None) {
+            result.profile = profile;
+            result.error = ProfilePlanner::errorName(error);
+            postProfileResult(result);
+            return;
+        }
+        result.profile = plan.profile;
+
+        // ABR and ROI changes only reach the sensor from this context: the switch runs undisturbed;
+        // the lock keeps loop()'s offline grab out of a driver being torn down
+        std::lock_guard<std::mutex> camera(cameraMutex);
+        if (plan.reinit) {
+            uint32_t startUs = (uint32_t)esp_timer_get_time();
+            bool reinitialized = reinitCamera(plan);
+            result.reinitMs = ((uint32_t)esp_timer_get_time() - startUs) / 1000;
+            s = esp_camera_sensor_get();
+            if (!reinitialized) {
+                // Previous buffers are back: previous view
+                if (!profilePinned && abr != NULL) {
+                    applyBitrateRung();
+                } else if (s != NULL) {
+                    s->set_quality(s, activeProfile.jpegQuality);
+                    setFrameInterval(applyView(s, (framesize_t)activeProfile.frameSize, activeProfile.intervalMs));
+                }
+                result.error = "reinit";
+                postProfileResult(result);
+                return;
+            }
+            result.reinit = true;
+            result.fbCount = (uint8_t)cameraConfig.fb_count;
+        } else if (plan.xclkChange && s != NULL && s->set_xclk != NULL) {
+            s->set_xclk(s, LEDC_TIMER_0, plan.profile.xclkMhz);
+            cameraConfig.xclk_freq_hz = plan.profile.xclkMhz * 1000000;
+        }
+        if (s != NULL) {
+            s->set_quality(s, plan.profile.jpegQuality);
+            setFrameInterval(applyView(s, (framesize_t)plan.profile.frameSize, plan.profile.intervalMs));
+        }
+        // Buffers may be larger than the stream (snapshot preallocation): the gate follows the stream
+        if (motionGate != NULL) {
+            motionGate->reserve(motionGateBlocks((framesize_t)plan.profile.frameSize));
+        }
+        profilePinned = !automatic;
+    }
+
+    // Reported with the gap once the first frame after the switch is captured
+    activeProfile = result.profile;
+    profilePending = result;
+    profileSwitchUs = lastCaptureUs != 0 ? lastCaptureUs : (uint64_t)esp_timer_get_time();
+    profileSwitches++;
+}
+
+/**
+ * Record a capture; the first one after a switch completes the result with the gap (capture context)
+ */
+void noteProfileCapture(uint64_t captureUs) {
+    if (profileSwitchUs != 0 && captureUs > profileSwitchUs) {
+        ProfileResult result = profilePending;
+        result.gapMs = (uint32_t)((captureUs - profileSwitchUs) / 1000);
+        profileSwitchUs = 0;
+        postProfileResult(result);
+        LOG_INFO("[Profile] %s %s q%u %u ms %u MHz",
+                 result.automatic ? "auto" : "manual", ProfilePlanner::frameSizeName(result.profile.frameSize),
+                 result.profile.jpegQuality, (unsigned)result.profile.intervalMs, result.profile.xclkMhz);
+        LOG_INFO("[Profile]   %s%u ms gap (%u buffers)", result.reinit ? "re-init, " : "", (unsigned)result.gapMs,
+                 result.fbCount);
+    }
+    lastCaptureUs = captureUs;
+}
+
+// ========================================
+// Snapshot
+// ========================================
+/**
+ * SnapshotCamera over the esp_camera driver (capture context, between two live captures)
+ * - Buffers too small for the snapshot: one re-init with a single buffer, and back
+ */
+class FirmwareSnapshotCamera : public SnapshotCamera {
+public:
+    uint8_t bufferFrameSize() override { return (uint8_t)cameraConfig.frame_size; }
+
+    bool reallocate(uint8_t frameSize) override {
+        _liveFrameSize = (uint8_t)cameraConfig.frame_size;
+        _liveFbCount = (uint8_t)cameraConfig.fb_count;
+        ProfilePlan plan = {};
+        plan.profile = activeProfile;
+        plan.fbFrameSize = frameSize;
+        plan.fbCount = 1;  // one frame, and the live buffers are freed first
+        return reinitCamera(plan);
+    }
+
+    bool restoreBuffers() override {
+        ProfilePlan plan = {};
+        plan.profile = activeProfile;
+        plan.fbFrameSize = _liveFrameSize;
+        plan.fbCount = _liveFbCount;
+        return reinitCamera(plan);
+    }
+
+    bool setMode(uint8_t frameSize, uint8_t jpegQuality) override {
+        sensor_t* s = esp_camera_sensor_get();
+        if (s == NULL) {
+            return false;
+        }
+        s->set_quality(s, jpegQuality);
+        return s->set_framesize(s, (framesize_t)frameSize) == 0;  // full view (an ROI is put back after)
+    }
+
+    void restoreMode() override {
+        sensor_t* s = esp_camera_sensor_get();
+        if (s != NULL) {
+            s->set_quality(s, activeProfile.jpegQuality);
+            applyView(s, (framesize_t)activeProfile.frameSize, activeProfile.intervalMs);
+        }
+    }
+
+    bool grab(SnapshotFrame& frame) override {
+        camera_fb_t* fb = grabFrame();
+        if (fb == NULL) {
+            return false;
+        }
+        frame.handle = fb;
+        frame.data = fb->buf;
+        frame.length = fb->len;
+        frame.captureUs = frameCaptureMicros(fb);
+        frameRing.onAcquire(fb, frame.captureUs, (uint64_t)esp_timer_get_time());
+        return true;
+    }
+
+    void release(const SnapshotFrame& frame) override {
+        frameRing.onRelease(frame.handle, (uint64_t)esp_timer_get_time());
+        esp_camera_fb_return(static_cast<camera_fb_t*>(frame.handle));
+    }
+
+    uint64_t nowUs() override { return (uint64_t)esp_timer_get_time(); }
+
+private:
+    uint8_t _liveFrameSize = 0;
+    uint8_t _liveFbCount = 0;
+};
+
+FirmwareSnapshotCamera snapshotCamera;
+SnapshotUpload* snapshotUpload = NULL;    // [header room][part header][envelope][JPEG] (PSRAM); NULL if disabled
+SnapshotCapture* snapshotCapture = NULL;
+unsigned long lastSnapshotStatsTime = 0;
+
+// SNAPSHOT request (WebSocket context → capture context) and its result (back)
+std::mutex snapshotMutex;
+uint8_t snapshotRequestSize = 0;
+uint8_t snapshotRequestQuality = 0;
+volatile uint32_t snapshotRequestSeq = 0;
+uint32_t snapshotAppliedSeq = 0;
+SnapshotResult snapshotResult = {};
+volatile uint32_t snapshotResultSeq = 0;
+uint32_t snapshotReportedSeq = 0;
+uint64_t snapshotUploadStartUs = 0;       // WebSocket context
+
+/**
+ * Snapshot buffer and capture (the buffer holds one JPEG of SNAPSHOT_FRAME_SIZE)
+ */
+void initSnapshot() {
+    size_t jpegCapacity = ProfilePlanner::frameBufferBytes((uint8_t)SNAPSHOT_FRAME_SIZE);
+    size_t bufferSize = SnapshotUpload::bufferSize(jpegCapacity, WEBSOCKETS_MAX_HEADER_SIZE);
+    uint8_t* buffer = psramFound() ? (uint8_t*)ps_malloc(bufferSize) : NULL;
+    if (buffer == NULL) {
+        Serial.println("Snapshot buffer allocation failed - SNAPSHOT disabled (needs PSRAM)");
+        return;
+    }
+    SnapshotUploadConfig uploadConfig;
+    uploadConfig.headroom = WEBSOCKETS_MAX_HEADER_SIZE;
+    uploadConfig.sharePercent = SNAPSHOT_SHARE_PERCENT;
+    uploadConfig.minRateKbps = SNAPSHOT_MIN_KBPS;
+    uploadConfig.maxPartBytes = SNAPSHOT_PART_SIZE;
+    snapshotUpload = new SnapshotUpload(buffer, bufferSize, uploadConfig);
+
+    SnapshotConfig config;
+    config.settleFrames = SNAPSHOT_SETTLE_FRAMES;
+    config.maxWaitMs = SNAPSHOT_MAX_WAIT;
+    snapshotCapture = new SnapshotCapture(snapshotCamera, *snapshotUpload, config);
+    Serial.printf("Snapshot: up to %s, %u KB buffer, %s switch, %d%% of the link for the upload\n",
+                  ProfilePlanner::frameSizeName((uint8_t)SNAPSHOT_FRAME_SIZE), (unsigned)(bufferSize / 1024),
+                  cameraConfig.frame_size >= SNAPSHOT_FRAME_SIZE ? "live" : "re-init", SNAPSHOT_SHARE_PERCENT);
+}
+
+/**
+ * Hand a SNAPSHOT request to the capture context, which owns the sensor and the buffers
+ */
+void requestSnapshot(uint8_t frameSize, uint8_t jpegQuality) {
+    std::lock_guard<std::mutex> lock(snapshotMutex);
+    snapshotRequestSize = frameSize;
+    snapshotRequestQuality = jpegQuality;
+    snapshotRequestSeq = snapshotRequestSeq + 1;
+}
+
+/**
+ * Post a result for the WebSocket context (sent as SNAPSHOT_STATUS)
+ */
+void postSnapshotResult(const SnapshotResult& result) {
+    std::lock_guard<std::mutex> lock(snapshotMutex);
+    snapshotResult = result;
+    snapshotResultSeq = snapshotResultSeq + 1;
+}
+
+/**
+ * Take the requested snapshot before the next live capture and hand it to the uploader (capture context)
+ */
+void applySnapshotRequest() {
+    if (snapshotRequestSeq == snapshotAppliedSeq) {
+        return;
+    }
+    uint8_t frameSize;
+    uint8_t jpegQuality;
+    {
+        std::lock_guard<std::mutex> lock(snapshotMutex);
+        frameSize = snapshotRequestSize;
+        jpegQuality = snapshotRequestQuality;
+        snapshotAppliedSeq = snapshotRequestSeq;
+    }
+
+    // ABR and ROI changes only reach the sensor from this context: the switch runs undisturbed;
+    // the lock keeps loop()'s offline grab out of the switch and a buffer re-allocation
+    SnapshotResult result;
+    SnapshotError error;
+    {
+        std::lock_guard<std::mutex> camera(cameraMutex);
+        error = snapshotCapture->capture(frameSize, jpegQuality, result);
+    }
+    if (error == SnapshotError::Busy) {
+        postSnapshotResult(result);  // sensor untouched: no gap to measure
+        return;
+    }
+    applyViewRequest();  // rung or ROI posted during the snapshot, on top of the restored live mode
+    if (error != SnapshotError::None) {
+        LOG_WARN("[Snapshot] %s q%u failed: %s (%u frames discarded)", ProfilePlanner::frameSizeName(frameSize),
+                 jpegQuality, SnapshotCapture::errorName(error), result.discarded);
+        return;  // reported with the gap
+    }
+
+    FrameHeader header = {};
+    ClockSyncStats sync = clockSync != NULL ? clockSync->getStats() : ClockSyncStats();
+    header.flags = sync.synced ? kEnvelopeClockSynced : 0;
+    header.sequence = result.id;
+    header.captureUs = result.captureUs;
+    header.clockOffsetUs = sync.offsetUs;
+    header.frameSize = result.frameSize;
+    header.jpegQuality = result.jpegQuality;
+    header.width = result.width;
+    header.height = result.height;
+    header.payloadLength = result.bytes;
+    snapshotUpload->publish(header);
+}
+
+/**
+ * Check a live capture after a snapshot: stale snapshot-size frames are dropped, the first
+ * live frame completes the result with the gap (capture context)
+ * @return false if the frame must not go out as a live frame
+ */
+bool noteSnapshotCapture(const uint8_t* jpeg, size_t length, uint64_t captureUs) {
+    bool live = snapshotCapture->admitLive(jpeg, length, captureUs);
+    SnapshotResult result;
+    if (snapshotCapture->takeResult(result)) {
+        postSnapshotResult(result);
+        if (result.error != SnapshotError::None) {
+            LOG_INFO("[Snapshot] %s: %u ms live gap", SnapshotCapture::errorName(result.error), result.gapUs / 1000);
+            return live;
+        }
+        LOG_INFO("[Snapshot] #%u %ux%u %u KB: %u ms live gap", result.id, result.width, result.height,
+                 result.bytes / 1024, result.gapUs / 1000);
+        LOG_INFO("[Snapshot] #%u switch %u ms%s, settle %u ms, restore %u ms", result.id, result.switchUs / 1000,
+                 result.reinit ? " (re-init)" : "", result.settleUs / 1000, result.restoreUs / 1000);
+    }
+    return live;
+}
+
+/**
+ * Print upload counters
+ */
+void logSnapshotStats() {
+    SnapshotUploadStats stats = snapshotUpload->getStats();
+    if (snapshotUpload->hasPending()) {
+        Serial.printf("[Snapshot] #%u uploading %u/%u KB, ", (unsigned)snapshotUpload->pendingId(),
+                      (unsigned)(snapshotUpload->sentLength() / 1024), (unsigned)(snapshotUpload->totalLength() / 1024));
+    } else {
+        Serial.print("[Snapshot] ");
+    }
+    Serial.printf("uploaded=%u parts=%u failed=%u restarts=%u sent=%llu KB\n", (unsigned)stats.uploaded,
+                  (unsigned)stats.parts, (unsigned)stats.failedParts, (unsigned)stats.restarts,
+                  (unsigned long long)(stats.bytes / 1024));
+}
+
+// ========================================
+// Control Commands
+// ========================================
+/**
+ * LED status reply (static text, nothing allocated per reply)
+ */
+const char* ledStatusText() {
+    return ledState ? "LED_STATUS:ON" : "LED_STATUS:OFF";
+}
+
+void handleLedOn(const CommandArgs& args, CommandReply& reply) {
+    (void)args;
+    digitalWrite(LED_PIN, HIGH);
+    ledState = true;
+    LOG_INFO("[LED] LED turned ON");
+    reply.append(ledStatusText());
+}
+
+void handleLedOff(const CommandArgs& args, CommandReply& reply) {
+    (void)args;
+    digitalWrite(LED_PIN, LOW);
+    ledState = false;
+    LOG_INFO("[LED] LED turned OFF");
+    reply.append(ledStatusText());
+}
+
+void handleLedStatus(const CommandArgs& args, CommandReply& reply) {
+    (void)args;
+    reply.append(ledStatusText());
+}
+
+void handleStats(const CommandArgs& args, CommandReply& reply) {
+    (void)args;
+    (void)reply;  // the snapshot has its own buffer (also published periodically)
+    if (telemetry != NULL) {
+        publishTelemetry();
+    }
+}
+
+void handleRecList(const CommandArgs& args, CommandReply& reply) {
+    (void)args;
+    if (recorder != NULL) {
+        formatRecordingIndex(reply);
+    }
+}
+
+void handleRecExport(const CommandArgs& args, CommandReply& reply) {
+    if (recorder != NULL) {
+        startRecordingExport(args.argument, reply);
+    }
+}
+
+/**
+ * ROI status reply: `ROI_STATUS:{json}` (window, output size and interval while active)
+ * - state: current (query), pending (ROI_OFF, or the requested ROI; applied before the next capture),
+ *   applied, rejected (with the reason)
+ */
+void formatRoiStatus(CommandReply& reply, const char* state, const RoiStatus& status, const char* error) {
+    reply.appendf("ROI_STATUS:{\"state\":\"%s\"", state);
+    if (!status.active) {
+        reply.append(",\"active\":false");
+    } else {
+        const WindowPlan& plan = status.plan;
+        reply.appendf(",\"active\":true,\"roi\":[%u,%u,%u,%u],\"mode\":%u,"
+                      "\"window\":[%u,%u,%u,%u],\"width\":%u,\"height\":%u,\"intervalMs\":%u",
+                      plan.roi.x, plan.roi.y, plan.roi.width, plan.roi.height, (unsigned)plan.mode,
+                      plan.offsetX, plan.offsetY, plan.windowWidth, plan.windowHeight,
+                      plan.outputWidth, plan.outputHeight, plan.intervalMs);
+    }
+    if (error != NULL) {
+        reply.appendf(",\"error\":\"%s\"", error);
+    }
+    reply.append("}");
+}
+
+/**
+ * Programmed view (posted by the capture context)
+ */
+RoiStatus readRoiStatus() {
+    std::lock_guard<std::mutex> lock(roiMutex);
+    return roiStatus;
+}
+
+void handleRoi(const CommandArgs& args, CommandReply& reply) {
+    if (sensorWindow == NULL) {
+        return;
+    }
+    if (args.argumentLength == 0) {
+        formatRoiStatus(reply, "current", readRoiStatus(), NULL);
+        return;
+    }
+    RoiRect roi;
+    if (!SensorWindow::parse(args.argument, roi)) {
+        formatRoiStatus(reply, "rejected", readRoiStatus(), "invalid");
+        return;
+    }
+    requestRoi(roi, true);
+    reply.appendf("ROI_STATUS:{\"state\":\"pending\",\"roi\":[%u,%u,%u,%u]}", roi.x, roi.y, roi.width, roi.height);
+}
+
+void handleRoiOff(const CommandArgs& args, CommandReply& reply) {
+    (void)args;
+    if (sensorWindow == NULL) {
+        return;
+    }
+    requestRoi(RoiRect(), false);
+    reply.append("ROI_STATUS:{\"state\":\"pending\",\"active\":false}");
+}
+
+/**
+ * Demand status reply: `DEMAND_STATUS:{json}` (requested set; the capture task switches on its next frame)
+ */
+void formatDemandStatus(CommandReply& reply, const char* error) {
+    uint32_t request = demandRequest;
+    if (request == kDemandReset) {
+        reply.appendf("DEMAND_STATUS:{\"subscribed\":false,\"mode\":\"%s\"",
+                      StreamDemand::modeName(streamDemand->getMode()));
+    } else {
+        ConsumerSet set;
+        set.live = (uint16_t)(request >> 16);
+        set.analyzer = (uint16_t)request;
+        reply.appendf("DEMAND_STATUS:{\"subscribed\":true,\"live\":%u,\"analyzer\":%u,\"mode\":\"%s\",\"target\":\"%s\"",
+                      set.live, set.analyzer, StreamDemand::modeName(streamDemand->getMode()),
+                      StreamDemand::modeName(StreamDemand::modeFor(set)));
+    }
+    if (error != NULL) {
+        reply.appendf(",\"error\":\"%s\"", error);
+    }
+    reply.append("}");
+}
+
+void handleDemand(const CommandArgs& args, CommandReply& reply) {
+    if (streamDemand == NULL) {
+        return;
+    }
+    if (args.argumentLength == 0) {
+        formatDemandStatus(reply, NULL);
+        return;
+    }
+    ConsumerSet set;
+    if (!StreamDemand::parse(args.argument, set)) {
+        formatDemandStatus(reply, "invalid");
+        return;
+    }
+    requestDemand(((uint32_t)set.live << 16) | set.analyzer);
+    formatDemandStatus(reply, NULL);
+}
+
+/**
+ * Credit status reply: `CREDIT_STATUS:{json}`
+ */
+void formatCreditStatus(CommandReply& reply) {
+    FlowCreditStats stats = flowCredit->getStats();
+    reply.appendf("CREDIT_STATUS:{\"limited\":%s,\"credits\":%u,\"sent\":%u,\"probes\":%u,\"waits\":%u,\"maxWaitMs\":%u}",
+                  flowCredit->isLimited() ? "true" : "false", flowCredit->getCredits(), stats.sent, stats.probes,
+                  stats.waits, stats.maxWaitMs);
+}
+
+void handleCredit(const CommandArgs& args, CommandReply& reply) {
+    if (flowCredit == NULL) {
+        return;
+    }
+    if (args.argumentLength == 0) {
+        formatCreditStatus(reply);
+        return;
+    }
+    // Grants are not acknowledged (one per relayed frame)
+    uint32_t credits = 0;
+    if (FlowCredit::parse(args.argument, credits)) {
+        flowCredit->grant(credits, millis());
+    }
+}
+
+void handleJpegSync(const CommandArgs& args, CommandReply& reply) {
+    (void)args;
+    (void)reply;
+    // Not acknowledged: the next frame carries the new header
+    if (headerElider != NULL) {
+        syncCompactFrames();
+    }
+}
+
+/**
+ * Render the capabilities into capsText
+ * @return Length (0 if they do not fit)
+ */
+size_t formatCaps() {
+    return profilePlanner->formatCaps(readCameraCaps(), capsText, sizeof(capsText));
+}
+
+void handleCaps(const CommandArgs& args, CommandReply& reply) {
+    (void)args;
+    if (profilePlanner != NULL && formatCaps() > 0) {
+        reply.append(capsText);
+    }
+}
+
+/**
+ * Profile status reply: `PROFILE_STATUS:{json}`
+ * - state: active (query), pending (accepted, applied before the next capture),
+ *   applied (with the measured switch gap), rejected (with the reason)
+ */
+void formatProfileStatus(CommandReply& reply, const char* state, bool automatic, const StreamProfile& profile,
+                         const char* error) {
+    reply.appendf("PROFILE_STATUS:{\"state\":\"%s\",\"mode\":\"%s\",\"frameSize\":\"%s\",\"quality\":%u,"
+                  "\"intervalMs\":%u,\"xclkMhz\":%u",
+                  state, automatic ? "auto" : "manual", ProfilePlanner::frameSizeName(profile.frameSize),
+                  profile.jpegQuality, (unsigned)profile.intervalMs, profile.xclkMhz);
+    if (error != NULL) {
+        reply.appendf(",\"error\":\"%s\"", error);
+    }
+}
+
+void handleProfile(const CommandArgs& args, CommandReply& reply) {
+    if (profilePlanner == NULL) {
+        return;
+    }
+    if (args.argumentLength == 0) {
+        formatProfileStatus(reply, "active", !profilePinned, activeProfile, NULL);
+        reply.appendf(",\"switches\":%lu}", profileSwitches);
+        return;
+    }
+    // AUTO: back to ABR (or to the boot profile without it)
+    bool automatic = strcmp(args.argument, "AUTO") == 0;
+    StreamProfile profile = {(uint8_t)FRAME_SIZE, JPEG_QUALITY, FRAME_INTERVAL, 0};
+    if (automatic && abr != NULL) {
+        profile = activeProfile;  // the ladder takes over from here
+    }
+    ProfileError error = automatic ? ProfileError::None : ProfilePlanner::parse(args.argument, profile);
+    if (error == ProfileError::None && !(automatic && abr != NULL)) {
+        ProfilePlan plan;
+        error = profilePlanner->plan(profile, readCameraCaps(), plan);
+        if (error == ProfileError::None) {
+            profile.xclkMhz = plan.profile.xclkMhz;
+        }
+    }
+    if (error != ProfileError::None) {
+        formatProfileStatus(reply, "rejected", automatic, profile, ProfilePlanner::errorName(error));
+        reply.append("}");
+        return;
+    }
+    requestProfile(profile, automatic);
+    formatProfileStatus(reply, "pending", automatic, profile, NULL);
+    reply.append("}");
+}
+
+/**
+ * Snapshot status reply: `SNAPSHOT_STATUS:{json}`
+ * - state: pending (accepted, taken before the next capture), rejected (with the reason),
+ *   captured (with the measured live gap), failed (with the reason and the gap), uploaded
+ */
+void formatSnapshotStatus(CommandReply& reply, const char* state, uint8_t frameSize, uint8_t jpegQuality,
+                          const char* error) {
+    reply.appendf("SNAPSHOT_STATUS:{\"state\":\"%s\",\"frameSize\":\"%s\",\"quality\":%u", state,
+                  ProfilePlanner::frameSizeName(frameSize), jpegQuality);
+    if (error != NULL) {
+        reply.appendf(",\"error\":\"%s\"", error);
+    }
+}
+
+/**
+ * Parse `[<size>[:<quality>]]` (Config.h defaults for what is left out)
+ * @return NULL, or the reason it was refused
+ */
+const char* parseSnapshotArgs(const CommandArgs& args, uint8_t& frameSize, uint8_t& jpegQuality) {
+    frameSize = (uint8_t)SNAPSHOT_FRAME_SIZE;
+    jpegQuality = SNAPSHOT_JPEG_QUALITY;
+    if (args.argumentLength == 0) {
+        return NULL;
+    }
+    const char* colon = strchr(args.argument, ':');
+    size_t nameLength = colon != NULL ? (size_t)(colon - args.argument) : args.argumentLength;
+    if (!ProfilePlanner::frameSizeFromName(args.argument, nameLength, frameSize)) {
+        return "frame_size";
+    }
+    if (colon != NULL) {
+        char* end = NULL;
+        unsigned long quality = strtoul(colon + 1, &end, 10);
+        if (colon[1] < '0' || colon[1] > '9' || *end != '\0') {
+            return "malformed";
+        }
+        ProfileLimits limits;
+        if (quality < limits.minQuality || quality > limits.maxQuality) {
+            return "quality";
+        }
+        jpegQuality = (uint8_t)quality;
+    }
+    // The snapshot buffer holds one frame of SNAPSHOT_FRAME_SIZE
+    if (frameSize > SNAPSHOT_FRAME_SIZE || frameSize > readCameraCaps().maxFrameSize) {
+        return "frame_size";
+    }
+    // ... and the frame buffer it is captured in (a larger JPEG is dropped by the driver)
+    uint8_t bufferSize = frameSize > cameraConfig.frame_size ? frameSize : (uint8_t)cameraConfig.frame_size;
+    if (bufferSize > SNAPSHOT_FRAME_SIZE) {
+        bufferSize = (uint8_t)SNAPSHOT_FRAME_SIZE;
+    }
+    if (jpegQuality < MemoryPlan::qualityFloor(frameSize, MemoryPlan::frameBufferBytes(bufferSize))) {
+        return "quality";
+    }
+    return NULL;
+}
+
+void handleLuma(const CommandArgs& args, CommandReply& reply) {
+    if (lumaStream == NULL) {
+        return;
+    }
+    if (args.argumentLength > 0 && strcmp(args.argument, "KEY") == 0) {
+        // A new receiver has no reference plane
+        lumaStream->reset();
+    } else if (args.argumentLength > 0) {
+        char* end = NULL;
+        unsigned long intervalMs = strtoul(args.argument, &end, 10);
+        if (args.argument[0] < '0' || args.argument[0] > '9' || *end != '\0' || intervalMs > 60000) {
+            formatLumaStatus(reply, "invalid");
+            return;
+        }
+        lumaStream->setInterval((uint32_t)intervalMs);
+        LOG_INFO("[Luma] Interval %u ms%s", (unsigned)intervalMs, intervalMs == 0 ? " (off)" : "");
+    }
+    formatLumaStatus(reply, NULL);
+}
+
+void handleSnapshot(const CommandArgs& args, CommandReply& reply) {
+    if (snapshotCapture == NULL) {
+        return;
+    }
+    uint8_t frameSize;
+    uint8_t jpegQuality;
+    const char* error = parseSnapshotArgs(args, frameSize, jpegQuality);
+    if (error == NULL && (!snapshotUpload->isIdle() || snapshotRequestSeq != snapshotAppliedSeq)) {
+        error = SnapshotCapture::errorName(SnapshotError::Busy);  // one snapshot at a time
+    }
+    if (error != NULL) {
+        formatSnapshotStatus(reply, "rejected", frameSize, jpegQuality, error);
+        reply.append("}");
+        return;
+    }
+    requestSnapshot(frameSize, jpegQuality);
+    formatSnapshotStatus(reply, "pending", frameSize, jpegQuality, NULL);
+    reply.append("}");
+}
+
+/**
+ * Command table (opcode order, checked at compile time)
+ */
+static constexpr CommandEntry kCommands[] = {
+    { kCommandLedOn, "LED_ON", handleLedOn },
+    { kCommandLedOff, "LED_OFF", handleLedOff },
+    { kCommandLedStatus, "LED_STATUS", handleLedStatus },
+    { kCommandStats, "STATS", handleStats },
+    { kCommandRecList, "REC_LIST", handleRecList },
+    { kCommandRecExport, "REC_EXPORT", handleRecExport },
+    { kCommandRoi, "ROI", handleRoi },
+    { kCommandRoiOff, "ROI_OFF", handleRoiOff },
+    { kCommandDemand, "DEMAND", handleDemand },
+    { kCommandCredit, "CREDIT", handleCredit },
+    { kCommandCaps, "CAPS", handleCaps },
+    { kCommandProfile, "PROFILE", handleProfile },
+    { kCommandJpegSync, "JPEG_SYNC", handleJpegSync },
+    { kCommandSnapshot, "SNAPSHOT", handleSnapshot },
+    { kCommandLuma, "LUMA", handleLuma },
+};
+static_assert(CommandRouter::isValidTable(kCommands), "command opcodes must be 1..N in table order with unique names");
+
+CommandRouter commandRouter(kCommands, sizeof(kCommands) / sizeof(kCommands[0]));
+
+// Outgoing control messages, flushed whenever the WebSocket is serviced (also between frame parts)
+char controlStorage[CONTROL_QUEUE_SLOTS * CONTROL_QUEUE_SLOT_SIZE];
+ControlQueue controlQueue(controlStorage, CONTROL_QUEUE_SLOTS, CONTROL_QUEUE_SLOT_SIZE);
+
+/**
+ * Queue a control message (sent right away if the queue refuses it)
+ */
+void queueControlMessage(const char* text, size_t length, ControlPriority priority) {
+    if (!controlQueue.push(text, length, priority)) {
+        webSocket.sendTXT(text, length);
+    }
+}
+
+/**
+ * Send queued control messages, highest priority first
+ */
+void drainControlQueue() {
+    const char* text = NULL;
+    size_t length = 0;
+    while (isConnected && controlQueue.front(text, length)) {
+        if (!webSocket.sendTXT(text, length)) {
+            break;
+        }
+        controlQueue.pop();
+    }
+}
+
+/**
+ * Queue the reply of the last dispatched command (text or binary form: replies are text)
+ */
+void sendCommandReply() {
+    CommandReply& reply = commandRouter.reply();
+    if (!reply.isEmpty()) {
+        queueControlMessage(reply.text(), reply.length(), ControlPriority::High);
+    } else if (reply.overflowed()) {
+        LOG_WARN("[WS] Command reply too long, dropped");
+    }
+}
+
+/**
+ * Queue the result of the last applied or refused PROFILE (posted by the capture context)
+ */
+CommandReply profileReply;  // WebSocket context
+
+void sendProfileResult() {
+    if (profileResultSeq == profileReportedSeq) {
+        return;
+    }
+    ProfileResult result;
+    {
+        std::lock_guard<std::mutex> lock(profileMutex);
+        result = profileResult;
+        profileReportedSeq = profileResultSeq;
+    }
+    profileReply.clear();
+    if (result.error != NULL) {
+        formatProfileStatus(profileReply, "rejected", result.automatic, result.profile, result.error);
+    } else {
+        formatProfileStatus(profileReply, "applied", result.automatic, result.profile, NULL);
+        profileReply.appendf(",\"reinit\":%s,\"fbCount\":%u,\"reinitMs\":%u,\"gapMs\":%u",
+                             result.reinit ? "true" : "false", result.fbCount, (unsigned)result.reinitMs,
+                             (unsigned)result.gapMs);
+    }
+    profileReply.append("}");
+    if (!profileReply.isEmpty()) {
+        queueControlMessage(profileReply.text(), profileReply.length(), ControlPriority::High);
+    }
+}
+
+/**
+ * Queue the outcome of the last ROI / ROI_OFF (posted by the capture context)
+ */
+CommandReply roiReply;  // WebSocket context
+
+void sendRoiResult() {
+    if (roiResultSeq == roiReportedSeq) {
+        return;
+    }
+    RoiStatus status;
+    const char* error;
+    {
+        std::lock_guard<std::mutex> lock(roiMutex);
+        status = roiStatus;
+        error = roiError;
+        roiReportedSeq = roiResultSeq;
+    }
+    roiReply.clear();
+    formatRoiStatus(roiReply, error != NULL ? "rejected" : "applied", status, error);
+    if (!roiReply.isEmpty()) {
+        queueControlMessage(roiReply.text(), roiReply.length(), ControlPriority::High);
+    }
+}
+
+/**
+ * Queue the outcome of the last SNAPSHOT (posted by the capture context)
+ */
+CommandReply snapshotReply;  // WebSocket context
+
+void sendSnapshotResult() {
+    if (snapshotResultSeq == snapshotReportedSeq) {
+        return;
+    }
+    SnapshotResult result;
+    {
+        std::lock_guard<std::mutex> lock(snapshotMutex);
+        result = snapshotResult;
+        snapshotReportedSeq = snapshotResultSeq;
+    }
+    snapshotReply.clear();
+    if (result.error != SnapshotError::None) {
+        formatSnapshotStatus(snapshotReply, result.error == SnapshotError::Busy ? "rejected" : "failed",
+                             result.frameSize, result.jpegQuality, SnapshotCapture::errorName(result.error));
+    } else {
+        formatSnapshotStatus(snapshotReply, "captured", result.frameSize, result.jpegQuality, NULL);
+        snapshotReply.appendf(",\"id\":%u,\"width\":%u,\"height\":%u,\"bytes\":%u", (unsigned)result.id,
+                              result.width, result.height, (unsigned)result.bytes);
+    }
+    snapshotReply.appendf(",\"reinit\":%s,\"discarded\":%u,\"switchMs\":%u,\"settleMs\":%u,\"restoreMs\":%u,"
+                          "\"gapMs\":%u}",
+                          result.reinit ? "true" : "false", (unsigned)(result.discarded + result.staleDropped),
+                          (unsigned)(result.switchUs / 1000), (unsigned)(result.settleUs / 1000),
+                          (unsigned)(result.restoreUs / 1000), (unsigned)(result.gapUs / 1000));
+    if (!snapshotReply.isEmpty()) {
+        queueControlMessage(snapshotReply.text(), snapshotReply.length(), ControlPriority::High);
+    }
+}
+
+// ========================================
+// WebSocket Event Handler
+// ========================================
+/**
+ * Connection lost (disconnect or error): forget everything the relay told us or holds for us
+ */
+void onSocketLost() {
+    if (streamDemand != NULL) {
+        requestDemand(kDemandReset);  // the next relay (or an older one) may not send DEMAND
+    }
+    if (flowCredit != NULL) {
+        flowCredit->reset(millis());  // nor CREDIT
+    }
+    resetCompactFrames();  // nor JPEG_SYNC
+    if (snapshotUpload != NULL) {
+        snapshotUpload->restart();  // the receiver dropped the parts it had
+    }
+    if (lumaStream != NULL) {
+        lumaStream->reset();  // and its last plane
+    }
+    if (isConnected && backfill != NULL) {
+        backfill->onDisconnect((uint64_t)esp_timer_get_time());
+    }
+    exportActive = false;
+    isConnected = false;
+    controlQueue.clear();
+}
+
+void webSocketEvent(WStype_t type, uint8_t* payload, size_t length) {
+    switch (type) {
+        case WStype_DISCONNECTED:
+            LOG_WARN("[WS] Disconnected");
+            onSocketLost();
+            break;
+            
+        case WStype_CONNECTED:
+            LOG_INFO("[WS] Connected to: %s", (const char*)payload);
+            isConnected = true;
+            markBootStage(BootStage::Socket);
+            frameCount = 0;
+            if (telemetry != NULL) {
+                telemetry->onConnect();
+            }
+            if (clockSync != NULL) {
+                clockSync->reset();  // may be a different server (or a restarted one)
+            }
+            if (backfill != NULL) {
+                backfill->onConnect((uint64_t)esp_timer_get_time());
+                BackfillStats backfillStats = backfill->getStats();
+                if (backfillStats.pendingFrames > 0) {
+                    LOG_INFO("[Backfill] %u frames (%u KB) recorded during the outage",
+                             backfillStats.pendingFrames, backfillStats.pendingBytes / 1024);
+                }
+            }
+            
+            // Send firmware version to server
+            delay(100); // Short delay to ensure connection is stable
+            webSocket.sendTXT("FIRMWARE_VERSION:" APP_VERSION);
+            LOG_INFO("[WS] Sent firmware version: %s", APP_VERSION);
+            
+            // Send current LED status on connect
+            webSocket.sendTXT(ledStatusText());
+            LOG_INFO("[LED] Initial LED status sent");
+            
+            // Advertise what the camera can do (the server may answer with PROFILE)
+            if (profilePlanner != NULL) {
+                size_t capsLength = formatCaps();
+                if (capsLength > 0) {
+                    webSocket.sendTXT(capsText, capsLength);
+                    LOG_INFO("[WS] Sent capabilities (%u bytes)", (unsigned)capsLength);
+                }
+            }
+            break;
+            
+        case WStype_TEXT: {
+            // Clock sync replies are timestamped first and not logged (periodic)
+            if (clockSync != NULL && ClockSync::isPong((const char*)payload, length)) {
+                clockSync->handlePong((const char*)payload, length, (uint64_t)esp_timer_get_time());
+                break;
+            }
+            // Credit grants arrive once per relayed frame: applied without logging or a reply
+            uint32_t credits = 0;
+            if (FlowCredit::isGrant((const char*)payload, length, credits)) {
+                if (flowCredit != NULL) {
+                    flowCredit->grant(credits, millis());
+                }
+                break;
+            }
+            LOG_INFO("[WS] Received text: %s", (const char*)payload);
+            // LED 제어, STATS, REC_* 명령 처리 (명령 테이블, 힙 할당 없음)
+            if (commandRouter.dispatchText((const char*)payload, length) == CommandStatus::Handled) {
+                sendCommandReply();
+            }
+            break;
+        }
+            
+        case WStype_BIN:
+            // Compact command form: [magic][opcode][argument length][argument]
+            if (CommandRouter::isBinaryCommand(payload, length)) {
+                CommandStatus status = commandRouter.dispatchBinary(payload, length);
+                if (status == CommandStatus::Handled) {
+                    sendCommandReply();
+                } else {
+                    LOG_WARN("[WS] Rejected binary command (opcode %u, %u bytes)", payload[1], (unsigned)length);
+                }
+            }
+            break;
+            
+        case WStype_ERROR:
+            LOG_ERROR("[WS] Error occurred");
+            onSocketLost();
+            break;
+            
+        default:
+            break;
+    }
+}
+
+// ========================================
+// Frame Ring Helpers
+// ========================================
+/**
+ * Print per-buffer occupancy statistics and reset counters
+ */
+void logRingStats() {
+    uint64_t nowUs = (uint64_t)esp_timer_get_time();
+    FrameRingStats stats = frameRing.getStats();
+    Serial.printf("[Ring] acquired=%u stale=%u held=%u/%u\n",
+                  stats.acquired, stats.staleDrops, stats.held, stats.maxHeld);
+    for (size_t i = 0; i < frameRing.getSlotCount(); i++) {
+        FrameSlotStats slot = frameRing.getSlotStats(i);
+        Serial.printf("[Ring]   fb[%u] occupancy=%u%% acquired=%u stale=%u maxAge=%ums\n",
+                      (unsigned)i, frameRing.occupancyPermille(i, nowUs) / 10,
+                      slot.acquisitions, slot.staleDrops, slot.maxAgeMs);
+    }
+    frameRing.resetStats(nowUs);
+}
+
+// ========================================
+// Motion Gate Helpers
+// ========================================
+/**
+ * Score a frame and decide whether to upload it
+ * - Also hands the decoded thumbnail to the luma side-stream (gated frames included)
+ * @param score Filled with the motion score (‰ of changed blocks)
+ * @return false if the scene is idle or nobody consumes it, and the frame should be skipped
+ */
+bool admitFrame(const camera_fb_t* fb, uint64_t captureUs, uint16_t& score) {
+    score = 0;
+    bool send = true;
+    bool decoded = false;
+    if (motionGate != NULL) {
+        MotionResult result = motionGate->evaluate(fb->buf, fb->len, millis());
+        score = result.score;
+        send = result.send;
+        decoded = result.decoded;
+    }
+    // Consumers decide last: nobody watching means no upload (the background model still learns)
+    send = streamDemand != NULL ? admitDemand(send, fb->len) : send;
+    if (lumaStream != NULL && decoded) {
+        publishLumaPlane(captureUs);
+    }
+    return send;
+}
+
+/**
+ * Print motion gate counters and reset them
+ */
+void logMotionStats() {
+    MotionGateStats stats = motionGate->getStats();
+    Serial.printf("[Motion] frames=%u motion=%u passed=%u keepAlive=%u gated=%u errors=%u score(last=%u peak=%u) grid=%ux%u\n",
+                  stats.frames, stats.motionFrames, stats.passed, stats.keepAlives, stats.gated,
+                  stats.decodeErrors, stats.lastScore, stats.peakScore, stats.widthBlocks, stats.heightBlocks);
+    motionGate->resetStats();
+}
+
+// ========================================
+// Frame Envelope Helpers
+// ========================================
+/**
+ * Allocate the envelope send buffer and clock sync state
+ */
+void initFrameEnvelope() {
+    sendBuffer = (uint8_t*)(psramFound() ? ps_malloc(FRAME_SEND_BUFFER_SIZE) : malloc(FRAME_SEND_BUFFER_SIZE));
+    if (sendBuffer == NULL) {
+        Serial.println("Envelope buffer allocation failed - sending raw JPEG");
+        return;
+    }
+    ClockSyncConfig syncConfig;
+    syncConfig.intervalMs = CLOCK_SYNC_INTERVAL;
+    syncConfig.fastIntervalMs = CLOCK_SYNC_FAST_INTERVAL;
+    clockSync = new ClockSync(syncConfig);
+    Serial.printf("Frame envelope: v%u, %u byte send buffer, %u byte parts\n",
+                  FrameEnvelope::kVersion, FRAME_SEND_BUFFER_SIZE, (unsigned)frameChunker.chunkSize());
+}
+
+/**
+ * Send a clock sync ping when due (called from whichever context owns the WebSocket)
+ */
+void serviceClockSync() {
+    if (clockSync == NULL || !isConnected || !clockSync->pingDue((uint64_t)esp_timer_get_time())) {
+        return;
+    }
+    char ping[ClockSync::kMaxMessage];
+    size_t length = clockSync->makePing((uint64_t)esp_timer_get_time(), ping, sizeof(ping));
+    if (length > 0) {
+        webSocket.sendTXT(ping, length);
+    }
+}
+
+/**
+ * Print clock sync and control queue state
+ */
+void logClockSync() {
+    ClockSyncStats stats = clockSync->getStats();
+    Serial.printf("[Clock] synced=%d offset=%lldus rtt=%uus (last %uus) ping=%u pong=%u rejected=%u\n",
+                  stats.synced, (long long)stats.offsetUs, stats.rttUs, stats.lastRttUs,
+                  stats.pingsSent, stats.pongsReceived, stats.rejected);
+    ControlQueueStats control = controlQueue.getStats();
+    Serial.printf("[Control] queued=%u sent=%u evicted=%u refused=%u depth max=%u\n",
+                  control.queued, control.sent, control.evicted, control.refused, control.maxDepth);
+}
+
+// ========================================
+// RTP/JPEG Transport Helpers
+// ========================================
+/**
+ * Create the UDP sender (the socket opens on the first frame if the host cannot be resolved yet)
+ */
+void initRtpTransport() {
+    RtpSenderConfig config;
+    config.rtp.mtu = RTP_MTU;
+    config.rtp.fecGroup = RTP_FEC_GROUP;
+    config.rtp.fecPayloadType = RTP_FEC_PAYLOAD_TYPE;
+    config.sendRetries = RTP_SEND_RETRIES;
+    rtpSender = new RtpSender(config);
+    rtpSender->open(RTP_DEST_HOST, RTP_DEST_PORT);
+    Serial.printf("RTP/JPEG: udp://%s:%d, MTU %d, parity 1 per %d packets\n",
+                  RTP_DEST_HOST, RTP_DEST_PORT, RTP_MTU, RTP_FEC_GROUP);
+}
+
+/**
+ * Send a frame as RTP/JPEG
+ * @return Unsupported when the frame has to go over the WebSocket instead
+ */
+RtpSendResult sendRtpFrame(const camera_fb_t* fb, uint64_t captureUs) {
+    if (!rtpSender->isOpen() && !rtpSender->open(RTP_DEST_HOST, RTP_DEST_PORT)) {
+        return RtpSendResult::Unsupported;
+    }
+    return rtpSender->sendFrame(fb->buf, fb->len, captureUs);
+}
+
+/**
+ * Print UDP sender counters
+ */
+void logRtpStats() {
+    RtpSenderStats stats = rtpSender->getStats();
+    RtpJpegStats packets = rtpSender->getPacketizerStats();
+    float overhead = packets.scanBytes > 0 ? 100.0f * (packets.wireBytes - packets.scanBytes) / packets.scanBytes : 0.0f;
+    Serial.printf("[RTP] frames=%u unsupported=%u failed=%u packets=%u (parity %u) retries=%u errors=%u %llu KB overhead %.1f%%\n",
+                  stats.frames, stats.unsupported, stats.failed, stats.packets, packets.parityPackets, stats.retries,
+                  stats.sendErrors, (unsigned long long)(stats.bytes / 1024), overhead);
+}
+
+// ========================================
+// WebSocket Service / Chunked Send Helpers
+// ========================================
+/**
+ * Run the WebSocket client (incoming commands, heartbeats) and flush queued control messages
+ */
+void serviceWebSocket() {
+    uint64_t nowUs = (uint64_t)esp_timer_get_time();
+    if (telemetry != NULL && lastServiceUs != 0) {
+        telemetry->record(Metric::ServiceGapUs, (uint32_t)(nowUs - lastServiceUs));
+    }
+    lastServiceUs = nowUs;
+    // No connect attempts before the station has an IP: a failed attempt would hold off the
+    // first real one by the reconnect interval
+    if (!isConnected && WiFi.status() != WL_CONNECTED) {
+        return;
+    }
+    webSocket.loop();
+    if (profilePlanner != NULL) {
+        sendProfileResult();
+    }
+    if (sensorWindow != NULL) {
+        sendRoiResult();
+    }
+    if (snapshotCapture != NULL) {
+        sendSnapshotResult();
+    }
+    drainControlQueue();
+}
+
+/**
+ * Send an encoded [envelope][JPEG] in parts of FRAME_CHUNK_SIZE
+ * - The WebSocket is serviced between parts: a command arriving during a large frame waits
+ *   for one part, not for the whole frame, and its reply goes out before the next part
+ * - Part headers are written in place over already sent bytes (no copy)
+ */
+bool sendChunked(uint8_t* message, const FrameHeader& header) {
+    frameChunker.begin(message, FrameEnvelope::kHeaderSize, header.payloadLength, header.sequence);
+    FrameChunk chunk;
+    while (frameChunker.next(chunk)) {
+        if (!webSocket.sendBIN(chunk.message - WEBSOCKETS_MAX_HEADER_SIZE, chunk.length, true)) {
+            return false;
+        }
+        if (!chunk.last) {
+            serviceWebSocket();
+            serviceClockSync();
+            if (!isConnected) {
+                return false;  // disconnected mid-frame (the receiver drops the partial frame)
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * Check if a JPEG fits the send buffer behind the WebSocket header room and the envelope
+ */
+bool fitsSendBuffer(size_t length) {
+    return sendBuffer != NULL &&
+           WEBSOCKETS_MAX_HEADER_SIZE + FrameEnvelope::kHeaderSize + length <= FRAME_SEND_BUFFER_SIZE;
+}
+
+/**
+ * Send [envelope][JPEG] from the send buffer
+ * - The JPEG is copied once behind the envelope; the WebSocket header is written
+ *   in front of it in place (headerToPayload), so the library makes no further copy
+ * - JPEGs larger than FRAME_CHUNK_SIZE go out in parts (sendChunked)
+ * - Caller checks fitsSendBuffer() first
+ */
+bool sendEnveloped(FrameHeader& header, const uint8_t* jpeg, size_t length) {
+    uint8_t* message = sendBuffer + WEBSOCKETS_MAX_HEADER_SIZE;
+    if (jpeg != message + FrameEnvelope::kHeaderSize) {  // recording export reads in place
+        memcpy(message + FrameEnvelope::kHeaderSize, jpeg, length);
+    }
+    header.payloadLength = length;
+    bool chunked = frameChunker.isChunked(length);
+    if (chunked) {
+        header.flags |= kEnvelopeChunked;
+    }
+    header.sendUs = (uint64_t)esp_timer_get_time();
+    FrameEnvelope::encode(header, message, FrameEnvelope::kHeaderSize);
+    if (chunked) {
+        return sendChunked(message, header);
+    }
+    // headerToPayload: pass the start of the reserved region, length excludes it
+    return webSocket.sendBIN(sendBuffer, FrameEnvelope::kHeaderSize + length, true);
+}
+
+/**
+ * Send one frame: RTP/JPEG over UDP when enabled, otherwise over the WebSocket, prefixed
+ * with the envelope when it fits the send buffer
+ */
+bool sendFrame(const camera_fb_t* fb, uint32_t sequence, uint64_t captureUs, uint16_t motionScore) {
+    if (rtpSender != NULL) {
+        RtpSendResult result = sendRtpFrame(fb, captureUs);
+        if (result != RtpSendResult::Unsupported) {
+            return result == RtpSendResult::Sent;
+        }
+    }
+    if (!fitsSendBuffer(fb->len)) {
+        return webSocket.sendBIN(fb->buf, fb->len);
+    }
+
+    FrameHeader header = {};
+    sensor_t* sensor = esp_camera_sensor_get();
+    if (sensor != NULL) {
+        header.jpegQuality = sensor->status.quality;
+        header.frameSize = (uint8_t)sensor->status.framesize;
+    }
+    ClockSyncStats sync = clockSync->getStats();
+    header.flags = (sync.synced ? kEnvelopeClockSynced : 0) |
+                   (motionScore >= MOTION_SCORE_THRESHOLD ? kEnvelopeMotion : 0);
+    header.sequence = sequence;
+    header.captureUs = captureUs;
+    header.clockOffsetUs = sync.offsetUs;
+    frameDimensions(fb, header.width, header.height);
+    header.motionScore = motionScore;
+    if (!compactFrames) {
+        return sendEnveloped(header, fb->buf, fb->len);
+    }
+
+    // Compact frame: the JPEG preamble only goes out when it changed
+    CompactFrame compact = headerElider->prepare(fb->buf, fb->len);
+    header.headerId = compact.headerId;
+    if (compact.mode == CompactMode::Define) {
+        header.flags |= kEnvelopeHeaderDefined;
+    } else if (compact.mode == CompactMode::Elided) {
+        header.flags |= kEnvelopeHeaderElided;
+    }
+    bool sent = sendEnveloped(header, fb->buf + compact.skip, fb->len - compact.skip);
+    if (!sent && compact.mode == CompactMode::Define) {
+        headerElider->invalidate();  // the relay may not have the header
+    }
+    return sent;
+}
+
+// ========================================
+// Outage Backfill Helpers
+// ========================================
+/**
+ * Allocate the outage store (needs the envelope to mark frames as historical)
+ */
+void initBackfill() {
+    if (sendBuffer == NULL || !psramFound()) {
+        Serial.println("Backfill disabled (needs PSRAM and the frame envelope)");
+        return;
+    }
+    uint8_t* arena = (uint8_t*)ps_malloc(BACKFILL_BUFFER_SIZE);
+    if (arena == NULL) {
+        Serial.println("Backfill buffer allocation failed");
+        return;
+    }
+    BackfillConfig config;
+    config.capacityBytes = BACKFILL_BUFFER_SIZE;
+    config.recordIntervalMs = BACKFILL_RECORD_INTERVAL;
+    config.eviction = BACKFILL_EVICTION;
+    config.sharePercent = BACKFILL_SHARE_PERCENT;
+    config.minRateKbps = BACKFILL_MIN_KBPS;
+    backfill = new BackfillStore(config, arena);
+    Serial.printf("Backfill: %u KB PSRAM, 1 frame / %u ms while offline, %u%% of the link\n",
+                  BACKFILL_BUFFER_SIZE / 1024, BACKFILL_RECORD_INTERVAL, BACKFILL_SHARE_PERCENT);
+}
+
+/**
+ * Store a decimated frame grabbed while the WebSocket is down (see captureOfflineFrame)
+ */
+void recordOutageFrame(const camera_fb_t* fb, uint64_t captureUs, uint64_t nowUs) {
+    BackfillFrame frame = {};
+    frame.data = fb->buf;
+    frame.length = fb->len;
+    frame.captureUs = captureUs;
+    frameDimensions(fb, frame.width, frame.height);
+    sensor_t* sensor = esp_camera_sensor_get();
+    if (sensor != NULL) {
+        frame.jpegQuality = sensor->status.quality;
+        frame.frameSize = (uint8_t)sensor->status.framesize;
+    }
+    // Frames that could only go out raw would lose the historical flag
+    if (fitsSendBuffer(fb->len)) {
+        backfill->record(frame, nowUs);
+    }
+}
+
+/**
+ * Estimated uplink rate from the bitrate controller (0 = unknown)
+ */
+uint32_t linkRateKbps() {
+    if (abr == NULL) {
+        return 0;
+    }
+    BitrateStats stats = abr->getStats();
+    // bytes * 8 / ms = kbit/s
+    return stats.avgSendMs > 0.0f ? (uint32_t)(stats.avgFrameBytes * 8.0f / stats.avgSendMs) : 0;
+}
+
+/**
+ * Send the oldest stored frame if the rate cap allows it and it fits before the next live frame
+ * - Called only from the context that owns the WebSocket, between live frames
+ * @param budgetUs Time until the next live frame is due
+ */
+void serviceBackfill(uint32_t budgetUs) {
+    if (!isConnected) {
+        return;
+    }
+    uint64_t nowUs = (uint64_t)esp_timer_get_time();
+    uint32_t linkKbps = linkRateKbps();
+    backfill->setLinkRate(linkKbps);
+    BackfillFrame frame;
+    if (!backfill->sendDue(nowUs) || !backfill->beginSend(frame)) {
+        return;
+    }
+    if (linkKbps > 0 && (uint64_t)frame.length * 8000 / linkKbps > budgetUs) {
+        backfill->endSend(false);
+        return;
+    }
+
+    FrameHeader header = {};
+    ClockSyncStats sync = clockSync->getStats();
+    header.flags = kEnvelopeHistorical | (sync.synced ? kEnvelopeClockSynced : 0);
+    header.jpegQuality = frame.jpegQuality;
+    header.frameSize = frame.frameSize;
+    header.sequence = frame.sequence;
+    header.captureUs = frame.captureUs;
+    header.clockOffsetUs = sync.offsetUs;
+    header.width = frame.width;
+    header.height = frame.height;
+    bool sent = sendEnveloped(header, frame.data, frame.length);
+    backfill->endSend(sent);
+
+    if (sent && backfill->isEmpty()) {
+        BackfillStats stats = backfill->getStats();
+        LOG_INFO("[Backfill] Drained: %u frames sent (%llu KB), %u evicted, %u rejected, peak %u KB",
+                 stats.sent, (unsigned long long)(stats.sentBytes / 1024), stats.evicted, stats.rejected,
+                 stats.maxPendingBytes / 1024);
+    }
+}
 
 // ========================================
-// Camera Initialization
+// Snapshot Upload
 // ========================================
-bool initCamera() {
-    Serial.println("Initializing camera...");
-    
-    camera_config_t config;
-    config.ledc_channel = LEDC_CHANNEL_0;
-    config.ledc_timer = LEDC_TIMER_0;
-    config.pin_d0 = Y2_GPIO_NUM;
-    config.pin_d1 = Y3_GPIO_NUM;
-    config.pin_d2 = Y4_GPIO_NUM;
-    config.pin_d3 = Y5_GPIO_NUM;
-    config.pin_d4 = Y6_GPIO_NUM;
-    config.pin_d5 = Y7_GPIO_NUM;
-    config.pin_d6 = Y8_GPIO_NUM;
-    config.pin_d7 = Y9_GPIO_NUM;
-    config.pin_xclk = XCLK_GPIO_NUM;
-    config.pin_pclk = PCLK_GPIO_NUM;
-    config.pin_vsync = VSYNC_GPIO_NUM;
-    config.pin_href = HREF_GPIO_NUM;
-    config.pin_sccb_sda = SIOD_GPIO_NUM;  // Fixed deprecated name
-    config.pin_sccb_scl = SIOC_GPIO_NUM;  // Fixed deprecated name
-    config.pin_pwdn = PWDN_GPIO_NUM;
-    config.pin_reset = RESET_GPIO_NUM;
-    config.xclk_freq_hz = 25000000;  // Increased from 20MHz to 25MHz for faster capture
-    config.pixel_format = PIXFORMAT_JPEG;
-    
-    // Frame size and quality settings - Optimized for cloud server (data cost saving)
-    if (psramFound()) {
-        config.frame_size = FRAMESIZE_HVGA; // 400x296 (good balance)
-        config.jpeg_quality = 25;           // 0-63, higher=more compression, 25 saves ~70% bandwidth
-        config.fb_count = 2;                // Double buffering sufficient for 15 FPS
-        Serial.println("PSRAM found - Cloud-optimized mode (15 FPS, compressed)");
-    } else {
-        config.frame_size = FRAMESIZE_SVGA; // 800x600
-        config.jpeg_quality = 12;
-        config.fb_count = 1;
-        Serial.println("PSRAM not found - using lower quality");
+/**
+ * Send the next snapshot part if it fits before the next live frame
+ * - Called only from the context that owns the WebSocket, between live frames
+ * - The part header and the WebSocket header go in front of the part's bytes in the
+ *   snapshot buffer (no copy); the overwritten bytes are put back after the send
+ * @param budgetUs Time until the next live frame is due
+ */
+void serviceSnapshotUpload(uint32_t budgetUs) {
+    if (!isConnected || !snapshotUpload->hasPending()) {
+        return;
     }
-    
-    // Initialize camera
-    esp_err_t err = esp_camera_init(&config);
-    if (err != ESP_OK) {
-        Serial.printf("Camera init failed with error 0x%x\n", err);
-        return false;
+    uint64_t nowUs = (uint64_t)esp_timer_get_time();
+    SnapshotPart part;
+    if (!snapshotUpload->nextPart(nowUs, budgetUs, linkRateKbps(), part)) {
+        return;
     }
-    
-    // Camera sensor settings
-    sensor_t* s = esp_camera_sensor_get();
-    if (s != NULL) {
-        // Adjust settings for better performance
-        s->set_brightness(s, 0);     // -2 to 2
-        s->set_contrast(s, 0);       // -2 to 2
-        s->set_saturation(s, 0);     // -2 to 2
-        s->set_special_effect(s, 0); // 0 to 6 (0 - No Effect)
-        s->set_whitebal(s, 1);       // 0 = disable , 1 = enable
-        s->set_awb_gain(s, 1);       // 0 = disable , 1 = enable
-        s->set_wb_mode(s, 0);        // 0 to 4
-        s->set_exposure_ctrl(s, 1);  // 0 = disable , 1 = enable
-        s->set_aec2(s, 0);           // 0 = disable , 1 = enable
-        s->set_gain_ctrl(s, 1);      // 0 = disable , 1 = enable
-        s->set_agc_gain(s, 0);       // 0 to 30
-        s->set_gainceiling(s, (gainceiling_t)0); // 0 to 6
-        s->set_bpc(s, 0);            // 0 = disable , 1 = enable
-        s->set_wpc(s, 1);            // 0 = disable , 1 = enable
-        s->set_raw_gma(s, 1);        // 0 = disable , 1 = enable
-        s->set_lenc(s, 1);           // 0 = disable , 1 = enable
-        s->set_hmirror(s, 0);        // 0 = disable , 1 = enable
-        s->set_vflip(s, 0);          // 0 = disable , 1 = enable
-        s->set_dcw(s, 1);            // 0 = disable , 1 = enable
-        s->set_colorbar(s, 0);       // 0 = disable , 1 = enable
+    if (part.offset == 0) {
+        snapshotUploadStartUs = nowUs;
     }
-    
-    Serial.println("Camera initialized successfully");
-    return true;
+    bool sent = webSocket.sendBIN(part.message - WEBSOCKETS_MAX_HEADER_SIZE, part.length, true);
+    nowUs = (uint64_t)esp_timer_get_time();
+    if (!snapshotUpload->endPart(sent, nowUs)) {
+        return;
+    }
+    char done[96];
+    int length = snprintf(done, sizeof(done),
+                          "SNAPSHOT_STATUS:{\"state\":\"uploaded\",\"id\":%u,\"bytes\":%u,\"uploadMs\":%u}",
+                          (unsigned)snapshotUpload->pendingId(), (unsigned)snapshotUpload->totalLength(),
+                          (unsigned)((nowUs - snapshotUploadStartUs) / 1000));
+    queueControlMessage(done, (size_t)length, ControlPriority::Normal);
+    LOG_INFO("[Snapshot] #%u uploaded: %u KB in %u ms", snapshotUpload->pendingId(),
+             snapshotUpload->totalLength() / 1024, (uint32_t)((nowUs - snapshotUploadStartUs) / 1000));
 }
 
 // ========================================
-// WiFi Connection
+// Offline Capture / Recording Export
 // ========================================
-void connectWiFi() {
-    Serial.println();
-    Serial.print("Connecting to WiFi: ");
-    Serial.println(WIFI_SSID);
-    
-    WiFi.mode(WIFI_STA);
-    WiFi.setSleep(false);  // Disable WiFi power saving for lower latency
-    WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
-    
-    int attempts = 0;
-    while (WiFi.status() != WL_CONNECTED && attempts < 20) {
-        delay(500);
-        Serial.print(".");
-        attempts++;
-    }
-    
-    if (WiFi.status() == WL_CONNECTED) {
-        Serial.println();
-        Serial.println("WiFi connected!");
-        Serial.print("IP address: ");
-        Serial.println(WiFi.localIP());
-        Serial.print("Signal strength (RSSI): ");
-        Serial.println(WiFi.RSSI());
-    } else {
-        Serial.println();
-        Serial.println("WiFi connection failed!");
+/**
+ * Grab a frame while the WebSocket is down, for the outage backfill, the local recording
+ * and the local MJPEG viewers
+ * - Called from loop(); the pipeline's capture task stops grabbing while offline, but a PROFILE
+ *   switch or a snapshot it already started may still own the driver (cameraMutex): this slot is
+ *   skipped then
+ */
+void captureOfflineFrame() {
+    uint64_t nowUs = (uint64_t)esp_timer_get_time();
+    bool backfillDue = backfill != NULL && backfill->recordDue(nowUs);
+    bool recordingDue = recorder != NULL && recorder->recordDue(nowUs);
+    bool localDue = localFrameDue(nowUs);
+    if (!backfillDue && !recordingDue && !localDue) {
+        return;
+    }
+    std::unique_lock<std::mutex> camera(cameraMutex, std::try_to_lock);
+    if (!camera.owns_lock()) {
+        return;
+    }
+    camera_fb_t* fb = grabFrame();
+    if (!fb) {
+        return;
+    }
+    uint64_t captureUs = frameCaptureMicros(fb);
+    frameRing.onAcquire(fb, captureUs, nowUs);
+
+    if (backfillDue) {
+        recordOutageFrame(fb, captureUs, nowUs);
+    }
+    if (recordingDue) {
+        recordLocalFrame(fb->buf, fb->len, captureUs, 0);
+    }
+    if (localDue) {
+        publishLocalFrame(fb->buf, fb->len, captureUs);
     }
+
+    frameRing.onRelease(fb, (uint64_t)esp_timer_get_time());
+    esp_camera_fb_return(fb);
 }
 
-// ========================================
-// WebSocket Event Handler
-// ========================================
-void webSocketEvent(WStype_t type, uint8_t* payload, size_t length) {
-    switch (type) {
-        case WStype_DISCONNECTED:
-            Serial.println("[WS] Disconnected");
-            isConnected = false;
-            break;
-            
-        case WStype_CONNECTED:
-            Serial.printf("[WS] Connected to: %s\n", payload);
-            isConnected = true;
-            frameCount = 0;
-            
-            // Send firmware version to server
-            delay(100); // Short delay to ensure connection is stable
-            webSocket.sendTXT(String("FIRMWARE_VERSION:") + String(APP_VERSION));
-            Serial.printf("[WS] Sent firmware version: %s\n", APP_VERSION);
-            
-            // Send current LED status on connect
-            webSocket.sendTXT(ledState ? "LED_STATUS:ON" : "LED_STATUS:OFF");
-            Serial.println("[LED] Initial LED status sent");
-            break;
-            
-        case WStype_TEXT: {
-            Serial.printf("[WS] Received text: %s\n", payload);
-            // LED 제어 명령 처리
-            String message = String((char*)payload);
-            if (message == "LED_ON") {
-                digitalWrite(LED_PIN, HIGH);
-                ledState = true;
-                Serial.println("[LED] LED turned ON");
-                webSocket.sendTXT("LED_STATUS:ON");
-            } else if (message == "LED_OFF") {
-                digitalWrite(LED_PIN, LOW);
-                ledState = false;
-                Serial.println("[LED] LED turned OFF");
-                webSocket.sendTXT("LED_STATUS:OFF");
-            } else if (message == "LED_STATUS") {
-                // LED 상태 요청
-                webSocket.sendTXT(ledState ? "LED_STATUS:ON" : "LED_STATUS:OFF");
-            }
-            break;
-        }
-            
-        case WStype_ERROR:
-            Serial.println("[WS] Error occurred");
-            isConnected = false;
-            break;
-            
-        default:
-            break;
+/**
+ * Send the next frame of a REC_EXPORT if it fits before the next live frame
+ * - Called only from the context that owns the WebSocket, between live frames
+ * - The frame is read from the card straight into the send buffer behind the envelope
+ * @param budgetUs Time until the next live frame is due
+ */
+void serviceRecordingExport(uint32_t budgetUs) {
+    uint8_t* jpeg = sendBuffer + WEBSOCKETS_MAX_HEADER_SIZE + FrameEnvelope::kHeaderSize;
+    size_t capacity = FRAME_SEND_BUFFER_SIZE - WEBSOCKETS_MAX_HEADER_SIZE - FrameEnvelope::kHeaderSize;
+    SegmentCursor cursor = exportCursor;
+    RecordedFrame frame;
+    if (!recorder->read(cursor, jpeg, capacity, frame) || frame.timeUs > exportEndUs) {
+        exportActive = false;
+        char done[32];
+        int length = snprintf(done, sizeof(done), "REC_EXPORT_DONE:%u", exportSent);
+        queueControlMessage(done, (size_t)length, ControlPriority::Normal);
+        LOG_INFO("[Rec] Export done: %u frames", exportSent);
+        return;
+    }
+    if (frame.length > capacity) {
+        exportCursor = cursor;  // larger than the send buffer: skipped
+        return;
+    }
+    // Not enough time before the next live frame: read it again in a later gap
+    uint32_t linkKbps = linkRateKbps();
+    if (linkKbps > 0 && (uint64_t)frame.length * 8000 / linkKbps > budgetUs) {
+        return;
+    }
+
+    // Timestamps recorded after clock sync are already on the server clock
+    FrameHeader header = {};
+    header.flags = kEnvelopeHistorical | kEnvelopeRecorded | (frame.flags & (kEnvelopeClockSynced | kEnvelopeMotion));
+    header.sequence = exportSent + 1;
+    header.captureUs = frame.timeUs;
+    header.clockOffsetUs = 0;
+    if (sendEnveloped(header, jpeg, frame.length)) {
+        exportCursor = cursor;
+        exportSent++;
     }
 }
 
@@ -213,29 +2983,254 @@ void captureAndSendFrame() {
         return;
     }
     
+    // ABR rung and ROI, stream profile switch and snapshot (nothing is held between captures)
+    applyViewRequest();
+    if (profilePlanner != NULL) {
+        applyProfileRequest();
+    }
+    if (snapshotCapture != NULL) {
+        applySnapshotRequest();
+    }
+    
     // Capture frame
-    camera_fb_t* fb = esp_camera_fb_get();
+    camera_fb_t* fb = grabFrame();
     if (!fb) {
-        Serial.println("Camera capture failed");
+        LOG_ERROR("Camera capture failed");
+        return;
+    }
+    uint64_t captureUs = frameCaptureMicros(fb);
+    frameRing.onAcquire(fb, captureUs, (uint64_t)esp_timer_get_time());
+    if (profilePlanner != NULL) {
+        noteProfileCapture(captureUs);
+    }
+    
+    // Frames of the snapshot mode left in the ring are not live frames
+    if (snapshotCapture != NULL && !noteSnapshotCapture(fb->buf, fb->len, captureUs)) {
+        frameRing.onRelease(fb, (uint64_t)esp_timer_get_time());
+        esp_camera_fb_return(fb);
+        return;
+    }
+    
+    // Never send frames that aged in the buffer ring
+    if (!frameRing.checkFresh(fb, captureUs, (uint64_t)esp_timer_get_time())) {
+        frameRing.onRelease(fb, (uint64_t)esp_timer_get_time());
+        esp_camera_fb_return(fb);
+        return;
+    }
+    
+    // Static scene: only keep-alive frames are uploaded (local recording and viewers get every frame)
+    publishLocalFrame(fb->buf, fb->len, captureUs);
+    uint16_t motionScore;
+    bool admitted = admitFrame(fb, captureUs, motionScore);
+    recordLocalFrame(fb->buf, fb->len, captureUs, motionScore);
+    if (!admitted) {
+        frameRing.onRelease(fb, (uint64_t)esp_timer_get_time());
+        esp_camera_fb_return(fb);
+        return;
+    }
+    
+    // No credit: the relay's viewers are behind, the next capture is sent instead of this one
+    if (!hasFlowCredit()) {
+        frameRing.onRelease(fb, (uint64_t)esp_timer_get_time());
+        esp_camera_fb_return(fb);
         return;
     }
     
     // Send frame via WebSocket
-    bool success = webSocket.sendBIN(fb->buf, fb->len);
+    uint32_t sendStartUs = (uint32_t)esp_timer_get_time();
+    bool success = sendFrame(fb, ++legacySequence, captureUs, motionScore);
+    uint32_t sendUs = (uint32_t)esp_timer_get_time() - sendStartUs;
     
     if (success) {
+        recordFrameSent(fb->len, sendUs);
+        if (flowCredit != NULL) {
+            flowCredit->onSent(millis());
+        }
         frameCount++;
         if (frameCount % 30 == 0) { // Log every 30 frames
-            Serial.printf("Frame #%lu sent (%u bytes)\n", frameCount, fb->len);
+            LOG_INFO("Frame #%lu sent (%u bytes, motion %u)", frameCount, (unsigned)fb->len, motionScore);
         }
     } else {
-        Serial.println("Failed to send frame");
+        LOG_WARN("Failed to send frame");
+        if (telemetry != NULL) {
+            telemetry->onSendFailure();
+        }
     }
     
     // Return frame buffer
+    frameRing.onRelease(fb, (uint64_t)esp_timer_get_time());
     esp_camera_fb_return(fb);
 }
 
+// ========================================
+// Pipeline Backends
+// ========================================
+/**
+ * Camera frame source for FramePipeline (esp_camera driver)
+ */
+class CameraFrameSource : public FrameSource {
+public:
+    bool acquire(FrameDescriptor& frame) override {
+        applyViewRequest();
+        if (profilePlanner != NULL) {
+            applyProfileRequest();
+        }
+        if (snapshotCapture != NULL) {
+            applySnapshotRequest();
+        }
+        camera_fb_t* fb = grabFrame();
+        if (!fb) {
+            return false;
+        }
+        frame.handle = fb;
+        frame.data = fb->buf;
+        frame.length = fb->len;
+        frame.captureUs = frameCaptureMicros(fb);
+        frameRing.onAcquire(fb, frame.captureUs, (uint64_t)esp_timer_get_time());
+        if (profilePlanner != NULL) {
+            noteProfileCapture(frame.captureUs);
+        }
+        return true;
+    }
+
+    void release(const FrameDescriptor& frame) override {
+        frameRing.onRelease(frame.handle, (uint64_t)esp_timer_get_time());
+        esp_camera_fb_return(static_cast<camera_fb_t*>(frame.handle));
+    }
+
+    void onTick(uint32_t latenessUs) override {
+        recordPaceTick(latenessUs);
+    }
+
+    bool admit(FrameDescriptor& frame) override {
+        // Frames of the snapshot mode left in the ring are not live frames (counted as gated)
+        if (snapshotCapture != NULL && !noteSnapshotCapture(frame.data, frame.length, frame.captureUs)) {
+            return false;
+        }
+        publishLocalFrame(frame.data, frame.length, frame.captureUs);
+        bool admitted = admitFrame(static_cast<camera_fb_t*>(frame.handle), frame.captureUs, frame.motionScore);
+        recordLocalFrame(frame.data, frame.length, frame.captureUs, frame.motionScore);
+        return admitted;
+    }
+
+    bool isFresh(const FrameDescriptor& frame) override {
+        return frameRing.checkFresh(frame.handle, frame.captureUs, (uint64_t)esp_timer_get_time());
+    }
+};
+
+/**
+ * WebSocket frame sink for FramePipeline
+ * - The network task owns the WebSocket client (loop + send)
+ */
+class WebSocketFrameSink : public FrameSink {
+public:
+    bool isReady() override { return isConnected; }
+
+    bool canSend() override { return hasFlowCredit(); }
+
+    bool send(const FrameDescriptor& frame) override {
+        uint32_t sendStartUs = (uint32_t)esp_timer_get_time();
+        bool success = sendFrame(static_cast<const camera_fb_t*>(frame.handle), frame.sequence,
+                                 frame.captureUs, frame.motionScore);
+        uint32_t sendUs = (uint32_t)esp_timer_get_time() - sendStartUs;
+        if (success) {
+            recordFrameSent(frame.length, sendUs);
+            if (flowCredit != NULL) {
+                flowCredit->onSent(millis());
+            }
+            frameCount++;
+        } else {
+            LOG_WARN("Failed to send frame");
+            if (telemetry != NULL) {
+                telemetry->onSendFailure();
+            }
+        }
+        return success;
+    }
+
+    void idle() override {
+        // Side-stream plane first: small and time-sensitive for the analyzer
+        if (lumaStream != NULL) {
+            serviceLumaStream();
+        }
+        // Backfill only if it serializes within half a frame interval (live frames keep priority)
+        if (backfill != NULL) {
+            serviceBackfill(frameIntervalMs * 500);
+        }
+        if (exportActive) {
+            serviceRecordingExport(frameIntervalMs * 500);
+        }
+        if (snapshotUpload != NULL) {
+            serviceSnapshotUpload(frameIntervalMs * 500);
+        }
+    }
+
+    void poll() override {
+        uint32_t startUs = (uint32_t)esp_timer_get_time();
+        serviceWebSocket();
+        serviceClockSync();
+        serviceTelemetry();
+        if (telemetry != NULL) {
+            telemetry->record(Metric::LoopUs, (uint32_t)esp_timer_get_time() - startUs);
+        }
+    }
+};
+
+CameraFrameSource frameSource;
+WebSocketFrameSink frameSink;
+unsigned long lastStatsTime = 0;
+
+/**
+ * Start dual-core capture/upload pipeline
+ */
+bool startPipeline() {
+    PipelineConfig config;
+    config.queueDepth = PIPELINE_QUEUE_DEPTH;
+    config.dropPolicy = PIPELINE_DROP_POLICY;
+    config.frameIntervalMs = frameIntervalMs;
+    config.pacingPolicy = PACING_POLICY;
+    config.maxCatchUp = PACING_MAX_CATCH_UP;
+    config.captureCore = PIPELINE_CAPTURE_CORE;
+    config.networkCore = PIPELINE_NETWORK_CORE;
+
+    pipeline = new FramePipeline(frameSource, frameSink, config);
+    if (!pipeline->start()) {
+        Serial.println("Pipeline start failed - falling back to loop() mode");
+        delete pipeline;
+        pipeline = NULL;
+        return false;
+    }
+    Serial.printf("Pipeline started (capture core %d, network core %d, queue %d)\n",
+                  PIPELINE_CAPTURE_CORE, PIPELINE_NETWORK_CORE, PIPELINE_QUEUE_DEPTH);
+    return true;
+}
+
+/**
+ * Log pipeline counters
+ */
+void logPipelineStats() {
+    PipelineStats stats = pipeline->getStats();
+    Serial.printf("[Pipeline] captured=%u sent=%u fail=%u gated=%u drop(old=%u new=%u offline=%u stale=%u) depth=%u/%u held=%u\n",
+                  stats.captured, stats.sent, stats.sendFailures, stats.gated,
+                  stats.droppedOldest, stats.droppedNewest, stats.droppedOffline, stats.droppedStale,
+                  stats.queueDepth, stats.maxQueueDepth, stats.held);
+}
+
+/**
+ * Log capture pacing statistics (pipeline capture task or loop())
+ */
+void logPaceStats() {
+    FramePacerStats stats = pipeline != NULL ? pipeline->getPacingStats() : framePacer.getStats();
+    if (stats.ticks == 0) {
+        return;
+    }
+    Serial.printf("[Pace] target=%.1f achieved=%.2f FPS ticks=%u late(avg=%uus max=%uus) period=%u..%uus skipped=%u caughtUp=%u\n",
+                  1000.0f / (float)(frameIntervalMs > 0 ? frameIntervalMs : 1), stats.achievedFps(),
+                  stats.ticks, stats.meanLatenessUs(), stats.maxLatenessUs,
+                  stats.ticks > 1 ? stats.minPeriodUs : 0, stats.maxPeriodUs,
+                  stats.skipped, stats.caughtUp);
+}
+
 // ========================================
 // Setup
 // ========================================
@@ -244,8 +3239,9 @@ void setup() {
     WRITE_PERI_REG(RTC_CNTL_BROWN_OUT_REG, 0);
     
     // Initialize serial
-    Serial.begin(115200);
-    Serial.setDebugOutput(true);
+    Serial.begin(SERIAL_BAUD_RATE);
+    Serial.setDebugOutput(LOG_MIN_LEVEL == 0);  // core log_x() output is synchronous: debug builds only
+    initAsyncLog();
     Serial.println();
     Serial.println("========================================");
     Serial.println("ESP32-CAM WebSocket Stream Client");
@@ -256,6 +3252,14 @@ void setup() {
     digitalWrite(LED_PIN, LOW);  // LED OFF initially
     Serial.println("LED initialized (GPIO 4)");
     
+    // Per-stage histograms and STATS snapshots (first, so it sees every boot milestone)
+    if (TELEMETRY_ENABLED) {
+        initTelemetry();
+    }
+    
+    // Start joining WiFi (non-blocking: associates while the camera initializes, retries in loop())
+    startWiFi();
+    
     // Initialize camera
     if (!initCamera()) {
         Serial.println("Camera initialization failed!");
@@ -264,25 +3268,92 @@ void setup() {
             delay(1000);
         }
     }
+    markBootStage(BootStage::Camera);
     
-    // Connect to WiFi
-    connectWiFi();
+    // Start adaptive bitrate on the initial rung
+    if (ABR_ENABLED) {
+        initBitrateController();
+    }
     
-    if (WiFi.status() != WL_CONNECTED) {
-        Serial.println("Cannot proceed without WiFi!");
-        Serial.println("System halted.");
-        while (true) {
-            delay(1000);
-        }
+    // Sensor-windowed region of interest (ROI / ROI_OFF commands)
+    if (ROI_ENABLED) {
+        initSensorWindow();
+    }
+    
+    // Capabilities on connect, runtime stream profiles (CAPS / PROFILE commands)
+    if (STREAM_PROFILE_ENABLED) {
+        initStreamProfile();
+    }
+    
+    // High-resolution stills between live frames (SNAPSHOT command)
+    if (SNAPSHOT_ENABLED) {
+        initSnapshot();
+    }
+    
+    // Upload only what the relay's consumers need (DEMAND command)
+    if (DEMAND_ENABLED) {
+        initStreamDemand();
     }
     
-    // Initialize WebSocket client
+    // Gray planes for the analyzer from the motion gate's thumbnails (LUMA command)
+    if (LUMA_ENABLED && motionGate != NULL) {
+        initLumaStream();
+    }
+    
+    // Per-frame header (sequence, timestamps, clock offset)
+    if (FRAME_ENVELOPE_ENABLED) {
+        initFrameEnvelope();
+    }
+    
+    // PSRAM store for frames captured during WebSocket outages
+    if (BACKFILL_ENABLED) {
+        initBackfill();
+    }
+    
+    // Continuous microSD recording (segment files with a time index)
+    if (RECORDING_ENABLED) {
+        initRecording();
+    }
+    
+    // Deadline grid for the loop() path (the pipeline paces its own capture task)
+    FramePacerConfig pacerConfig;
+    pacerConfig.intervalUs = frameIntervalMs * 1000;
+    pacerConfig.policy = PACING_POLICY;
+    pacerConfig.maxCatchUp = PACING_MAX_CATCH_UP;
+    framePacer = FramePacer(pacerConfig);
+    
+    // LAN viewers straight from the device (runs next to the cloud upload)
+    if (MJPEG_SERVER_ENABLED) {
+        initMjpegServer();
+    }
+    
+    // Frames over UDP (RTP/JPEG with parity FEC); commands stay on the WebSocket
+    if (RTP_ENABLED) {
+        initRtpTransport();
+    }
+    
+    // JPEG header once per epoch after the relay asks for compact frames (JPEG_SYNC command)
+    if (COMPACT_FRAMES_ENABLED && sendBuffer != NULL) {
+        initCompactFrames();
+    }
+    
+    // Live frames only while the relay grants credit (CREDIT command); UDP frames bypass the relay's queue
+    if (FLOW_CONTROL_ENABLED && !RTP_ENABLED) {
+        initFlowControl();
+    }
+    
+    // Initialize WebSocket client (connects once the station has an IP)
     Serial.printf("Connecting to WebSocket: ws://%s:%d%s\n", WS_HOST, WS_PORT, WS_PATH);
     webSocket.begin(WS_HOST, WS_PORT, WS_PATH);
     webSocket.onEvent(webSocketEvent);
     webSocket.setReconnectInterval(3000);  // Reduced from 5000ms for faster recovery
     webSocket.enableHeartbeat(15000, 3000, 2);  // Enable heartbeat for connection stability
     
+    // Start capture/upload tasks (WebSocket is serviced by the network task from now on)
+    if (PIPELINE_ENABLED) {
+        startPipeline();
+    }
+    
     Serial.println("Setup complete!");
     Serial.println("========================================");
 }
@@ -291,16 +3362,150 @@ void setup() {
 // Main Loop
 // ========================================
 void loop() {
+    // Station join and retries
+    serviceWiFi();
+    
+    // Log task did not start: LOG_* lines go out from here
+    if (asyncLog != NULL && !asyncLog->isRunning()) {
+        asyncLog->flush();
+    }
+    
+    // Free memory watermarks
+    if (telemetry != NULL) {
+        telemetry->sampleMemory(ESP.getFreeHeap(), ESP.getFreePsram());
+        telemetry->sampleAllocations(AllocCounter::allocations());
+    }
+    
+    // Per-buffer occupancy statistics
+    if (millis() - lastRingStatsTime >= RING_STATS_INTERVAL) {
+        logRingStats();
+        lastRingStatsTime = millis();
+    }
+    
+    // Motion gate and demand statistics
+    if ((motionGate != NULL || streamDemand != NULL) && millis() - lastMotionStatsTime >= MOTION_STATS_INTERVAL) {
+        if (motionGate != NULL) {
+            logMotionStats();
+        }
+        if (streamDemand != NULL) {
+            logDemandStats();
+        }
+        lastMotionStatsTime = millis();
+    }
+    
+    // Telemetry snapshot published by the WebSocket context
+    if (statsLinePending) {
+        logStatsLine();
+    }
+    
+    // Clock sync state
+    if (clockSync != NULL && millis() - lastClockStatsTime >= CLOCK_SYNC_INTERVAL) {
+        logClockSync();
+        lastClockStatsTime = millis();
+    }
+    
+    // Keep decimated frames while the WebSocket is down (backfilled after reconnect, recorded to the card,
+    // shown to local viewers)
+    if (!isConnected && (backfill != NULL || recorder != NULL || mjpegServer != NULL)) {
+        captureOfflineFrame();
+    }
+    
+    // Local viewer counters
+    if (mjpegServer != NULL && millis() - lastMjpegStatsTime >= MJPEG_STATS_INTERVAL) {
+        logMjpegStats();
+        lastMjpegStatsTime = millis();
+    }
+    
+    // UDP sender counters
+    if (rtpSender != NULL && millis() - lastRtpStatsTime >= RTP_STATS_INTERVAL) {
+        logRtpStats();
+        lastRtpStatsTime = millis();
+    }
+    
+    // Credit window counters
+    if (flowCredit != NULL && millis() - lastFlowStatsTime >= FLOW_STATS_INTERVAL) {
+        logFlowStats();
+        lastFlowStatsTime = millis();
+    }
+    
+    // Header elision counters
+    if (headerElider != NULL && millis() - lastCompactStatsTime >= COMPACT_STATS_INTERVAL) {
+        logCompactStats();
+        lastCompactStatsTime = millis();
+    }
+    
+    // Snapshot upload counters
+    if (snapshotUpload != NULL && millis() - lastSnapshotStatsTime >= SNAPSHOT_STATS_INTERVAL) {
+        logSnapshotStats();
+        lastSnapshotStatsTime = millis();
+    }
+    
+    // Luma side-stream counters
+    if (lumaStream != NULL && millis() - lastLumaStatsTime >= LUMA_STATS_INTERVAL) {
+        logLumaStats();
+        lastLumaStatsTime = millis();
+    }
+    
+    // Recording writer counters
+    if (recorder != NULL && millis() - lastRecordingStatsTime >= RECORDING_STATS_INTERVAL) {
+        logRecordingStats();
+        lastRecordingStatsTime = millis();
+    }
+    
+    // Achieved frame rate and pacing jitter
+    if (millis() - lastPaceStatsTime >= PACING_STATS_INTERVAL) {
+        logPaceStats();
+        lastPaceStatsTime = millis();
+    }
+    
+    // Pipelined mode: capture/network tasks do the work, loop() only reports
+    if (pipeline != NULL) {
+        unsigned long now = millis();
+        if (now - lastStatsTime >= PIPELINE_STATS_INTERVAL) {
+            logPipelineStats();
+            lastStatsTime = now;
+        }
+        delay(wifiConnector != NULL && !wifiConnector->isConnected() ? 10 : 100);  // poll a join closely
+        return;
+    }
+    
     // Handle WebSocket events
-    webSocket.loop();
+    uint32_t loopStartUs = (uint32_t)esp_timer_get_time();
+    serviceWebSocket();
+    serviceClockSync();
+    serviceTelemetry();
     
-    // Send frames at specified interval
-    unsigned long currentTime = millis();
-    if (isConnected && (currentTime - lastFrameTime >= FRAME_INTERVAL)) {
+    // Send frames on the deadline grid (capture/send time does not stretch the period)
+    uint64_t nowUs = (uint64_t)esp_timer_get_time();
+    if (!isConnected) {
+        framePacer.stop();
+    } else if (!framePacer.isRunning()) {
+        framePacer.start(nowUs);
+    }
+    if (framePacer.poll(nowUs)) {
+        recordPaceTick(framePacer.getLastLatenessUs());
         captureAndSendFrame();
-        lastFrameTime = currentTime;
+    } else if (framePacer.isRunning()) {
+        if (lumaStream != NULL) {
+            serviceLumaStream();
+        }
+        if (backfill != NULL) {
+            serviceBackfill(framePacer.waitUs(nowUs));
+        }
+        if (exportActive) {
+            serviceRecordingExport(framePacer.waitUs((uint64_t)esp_timer_get_time()));
+        }
+        if (snapshotUpload != NULL) {
+            serviceSnapshotUpload(framePacer.waitUs((uint64_t)esp_timer_get_time()));
+        }
+    }
+    if (telemetry != NULL) {
+        telemetry->record(Metric::LoopUs, (uint32_t)esp_timer_get_time() - loopStartUs);
     }
     
-    // Small delay to prevent watchdog timer issues
-    delay(10);
+    // Sleep until the next deadline; the WebSocket client has no wake-up event,
+    // so it is still serviced at least every WS_SERVICE_INTERVAL
+    const uint32_t serviceUs = WS_SERVICE_INTERVAL * 1000;
+    uint32_t waitUs = framePacer.isRunning() ? framePacer.waitUs((uint64_t)esp_timer_get_time()) : serviceUs;
+    paceTimer.wait(waitUs < serviceUs ? waitUs : serviceUs);
 }
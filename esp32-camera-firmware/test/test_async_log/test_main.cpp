@@ -0,0 +1,413 @@
+/**
+ * `test_main.cpp`
+ * - Unit tests and a per-call cost benchmark for AsyncLog (native host build)
+ * - The benchmark compares a log call with synchronous formatting plus a modeled 115200-baud
+ *   UART write (what `Serial.printf` costs the caller on the device)
+ * - Run: pio test -e native -f test_async_log
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#include <unity.h>
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define LOG_MIN_LEVEL 1  // info: LOG_DEBUG compiled out
+#include "AsyncLog.h"
+
+// Collects the writer's lines
+struct Capture {
+    std::mutex mutex;
+    std::vector<std::string> lines;
+};
+
+static void captureSink(const char* line, size_t length, void* context) {
+    Capture* capture = static_cast<Capture*>(context);
+    std::lock_guard<std::mutex> lock(capture->mutex);
+    capture->lines.push_back(std::string(line, length));
+}
+
+static void nullSink(const char* line, size_t length, void* context) {
+    (void)line;
+    (void)context;
+    static volatile size_t total = 0;
+    total += length;
+}
+
+static AsyncLogConfig captureConfig(Capture& capture) {
+    AsyncLogConfig config;
+    config.sink = captureSink;
+    config.sinkContext = &capture;
+    config.timestamps = false;
+    return config;
+}
+
+static std::string formatted(const char* format, ...) {
+    char buffer[kLogLineBytes];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+    return std::string(buffer) + "\n";
+}
+
+static int sideEffects = 0;
+
+static int countCall() {
+    return ++sideEffects;
+}
+
+void setUp(void) {
+    AsyncLog::install(NULL);
+}
+
+void tearDown(void) {
+    AsyncLog::install(NULL);
+}
+
+// ========================================
+// Formatting
+// ========================================
+void test_deferred_format_matches_printf() {
+    static LogSlot slots[16];
+    Capture capture;
+    AsyncLog log(captureConfig(capture), slots, 16);
+
+    log.write(LogLevel::Info, "Frame #%lu sent (%u bytes, motion %u)", 30UL, 14812u, (uint16_t)7);
+    log.write(LogLevel::Info, "[WS] Received text: %s", "LED_ON");
+    log.write(LogLevel::Info, "%5d|%-5d|%05d|%#x|%X|%c", -42, 42, 42, 0xBEEFu, 0xBEEFu, 'Z');
+    log.write(LogLevel::Info, "%.1f%% %8.3f %e %g", 3.36, -1.5f, 12345.678, 0.25);
+    log.write(LogLevel::Info, "%llu %lld %zu %hu %o", 18446744073709551615ULL, -9000000000LL, (size_t)77, (unsigned short)9, 8u);
+    log.write(LogLevel::Info, "%u from -1, %d from -1", -1, -1);
+    log.write(LogLevel::Info, "[%10s][%-6s][%.3s]", "right", "left", "truncated");
+    log.write(LogLevel::Info, "no arguments, 100%% literal");
+    TEST_ASSERT_EQUAL(8, (int)log.flush());
+
+    TEST_ASSERT_EQUAL(8, (int)capture.lines.size());
+    TEST_ASSERT_EQUAL_STRING(formatted("Frame #%lu sent (%u bytes, motion %u)", 30UL, 14812u, 7u).c_str(),
+                             capture.lines[0].c_str());
+    TEST_ASSERT_EQUAL_STRING("[WS] Received text: LED_ON\n", capture.lines[1].c_str());
+    TEST_ASSERT_EQUAL_STRING(formatted("%5d|%-5d|%05d|%#x|%X|%c", -42, 42, 42, 0xBEEFu, 0xBEEFu, 'Z').c_str(),
+                             capture.lines[2].c_str());
+    TEST_ASSERT_EQUAL_STRING(formatted("%.1f%% %8.3f %e %g", 3.36, -1.5, 12345.678, 0.25).c_str(),
+                             capture.lines[3].c_str());
+    TEST_ASSERT_EQUAL_STRING("18446744073709551615 -9000000000 77 9 10\n", capture.lines[4].c_str());
+    TEST_ASSERT_EQUAL_STRING("4294967295 from -1, -1 from -1\n", capture.lines[5].c_str());
+    TEST_ASSERT_EQUAL_STRING("[     right][left  ][tru]\n", capture.lines[6].c_str());
+    TEST_ASSERT_EQUAL_STRING("no arguments, 100% literal\n", capture.lines[7].c_str());
+}
+
+void test_string_arguments_are_copied() {
+    static LogSlot slots[16];
+    Capture capture;
+    AsyncLog log(captureConfig(capture), slots, 16);
+
+    // The WebSocket payload buffer is reused before the writer runs
+    char payload[32];
+    strcpy(payload, "PROFILE:VGA:12:66");
+    log.write(LogLevel::Info, "[WS] Received text: %s", payload);
+    strcpy(payload, "overwritten");
+    const char* missing = NULL;
+    log.write(LogLevel::Warn, "%s", missing);
+    log.flush();
+
+    TEST_ASSERT_EQUAL_STRING("[WS] Received text: PROFILE:VGA:12:66\n", capture.lines[0].c_str());
+    TEST_ASSERT_EQUAL_STRING("(null)\n", capture.lines[1].c_str());
+}
+
+void test_long_strings_are_truncated_to_the_record() {
+    static LogSlot slots[16];
+    Capture capture;
+    AsyncLog log(captureConfig(capture), slots, 16);
+
+    std::string longText(200, 'x');
+    log.write(LogLevel::Info, "%s|%s|%d", longText.c_str(), "second", 5);
+    log.flush();
+
+    // First string takes the whole text area, the second one is empty, numbers are unaffected
+    std::string expected = std::string(kLogTextBytes - 1, 'x') + "||5\n";
+    TEST_ASSERT_EQUAL_STRING(expected.c_str(), capture.lines[0].c_str());
+
+    // Lines longer than the line buffer are cut, still newline-terminated
+    log.write(LogLevel::Info, "%0300d", 1);
+    log.flush();
+    TEST_ASSERT_EQUAL(kLogLineBytes - 1, capture.lines[1].size());
+    TEST_ASSERT_EQUAL('\n', capture.lines[1].back());
+}
+
+void test_timestamp_and_level_prefix() {
+    static LogSlot slots[16];
+    Capture capture;
+    AsyncLogConfig config = captureConfig(capture);
+    config.timestamps = true;
+    AsyncLog log(config, slots, 16);
+
+    log.write(LogLevel::Warn, "[Log] prefix");
+    log.flush();
+
+    const std::string& line = capture.lines[0];
+    size_t dot = line.find('.');
+    TEST_ASSERT_TRUE(dot != std::string::npos && dot > 0);
+    TEST_ASSERT_EQUAL_STRING(" W [Log] prefix\n", line.substr(dot + 4).c_str());
+}
+
+// ========================================
+// Ring
+// ========================================
+void test_full_ring_drops_and_reports() {
+    static LogSlot slots[8];
+    Capture capture;
+    AsyncLog log(captureConfig(capture), slots, 8);
+
+    for (int i = 0; i < 20; i++) {
+        TEST_ASSERT_EQUAL(i < 8, log.write(LogLevel::Info, "record %d", i));
+    }
+    AsyncLogStats stats = log.getStats();
+    TEST_ASSERT_EQUAL(8, stats.posted);
+    TEST_ASSERT_EQUAL(12, stats.dropped);
+    TEST_ASSERT_EQUAL(8, stats.maxDepth);
+
+    // The oldest records are kept, the loss is reported after them
+    TEST_ASSERT_EQUAL(8, (int)log.flush());
+    TEST_ASSERT_EQUAL(9, (int)capture.lines.size());
+    TEST_ASSERT_EQUAL_STRING("record 0\n", capture.lines[0].c_str());
+    TEST_ASSERT_EQUAL_STRING("record 7\n", capture.lines[7].c_str());
+    TEST_ASSERT_EQUAL_STRING("[Log] 12 records dropped (ring full)\n", capture.lines[8].c_str());
+
+    // Space again, and the count is reported once
+    TEST_ASSERT_TRUE(log.write(LogLevel::Info, "after"));
+    log.flush();
+    TEST_ASSERT_EQUAL(10, (int)capture.lines.size());
+    TEST_ASSERT_EQUAL_STRING("after\n", capture.lines[9].c_str());
+}
+
+void test_levels_below_threshold_compile_out() {
+    static LogSlot slots[16];
+    Capture capture;
+    AsyncLog log(captureConfig(capture), slots, 16);
+
+    // Not installed: calls are ignored (arguments still evaluated for enabled levels)
+    sideEffects = 0;
+    LOG_INFO("before install %d", countCall());
+    TEST_ASSERT_EQUAL(1, sideEffects);
+    TEST_ASSERT_EQUAL(0, log.getStats().posted);
+
+    AsyncLog::install(&log);
+    sideEffects = 0;
+    LOG_DEBUG("debug %d", countCall());
+    LOG_INFO("info %d", countCall());
+    LOG_WARN("warn %d", countCall());
+    LOG_ERROR("error %d", countCall());
+    TEST_ASSERT_EQUAL(3, sideEffects);  // the debug argument was never evaluated
+    log.flush();
+
+    TEST_ASSERT_EQUAL(3, (int)capture.lines.size());
+    TEST_ASSERT_EQUAL_STRING("info 1\n", capture.lines[0].c_str());
+    TEST_ASSERT_EQUAL_STRING("warn 2\n", capture.lines[1].c_str());
+    TEST_ASSERT_EQUAL_STRING("error 3\n", capture.lines[2].c_str());
+}
+
+void test_concurrent_producers_keep_records_whole() {
+    static LogSlot slots[64];
+    Capture capture;
+    AsyncLogConfig config = captureConfig(capture);
+    config.flushIntervalMs = 1;
+    AsyncLog log(config, slots, 64);
+    TEST_ASSERT_TRUE(log.start());
+
+    const int producers = 4;
+    const int perProducer = 5000;
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; p++) {
+        threads.emplace_back([&log, p, perProducer] {
+            for (int i = 0; i < perProducer; i++) {
+                log.write(LogLevel::Info, "p%d %d %s", p, i, "tag");
+                if (i % 64 == 0) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    log.stop();
+
+    AsyncLogStats stats = log.getStats();
+    TEST_ASSERT_EQUAL(producers * perProducer, (int)(stats.posted + stats.dropped));
+    TEST_ASSERT_EQUAL(stats.posted, stats.written);
+
+    // Every line whole, each producer's records in order
+    int last[producers] = { -1, -1, -1, -1 };
+    uint32_t records = 0;
+    uint32_t reportedDrops = 0;
+    for (const std::string& line : capture.lines) {
+        unsigned long dropped;
+        if (sscanf(line.c_str(), "[Log] %lu records dropped", &dropped) == 1) {
+            reportedDrops += (uint32_t)dropped;
+            continue;
+        }
+        int p, i;
+        char tag[8];
+        TEST_ASSERT_EQUAL(3, sscanf(line.c_str(), "p%d %d %7s", &p, &i, tag));
+        TEST_ASSERT_EQUAL_STRING("tag", tag);
+        TEST_ASSERT_TRUE(p >= 0 && p < producers);
+        TEST_ASSERT_TRUE(i > last[p]);
+        last[p] = i;
+        records++;
+    }
+    TEST_ASSERT_EQUAL(stats.posted, records);
+    TEST_ASSERT_EQUAL(stats.dropped, reportedDrops);
+}
+
+void test_writer_thread_drains_in_background() {
+    static LogSlot slots[16];
+    Capture capture;
+    AsyncLogConfig config = captureConfig(capture);
+    config.flushIntervalMs = 5;
+    AsyncLog log(config, slots, 16);
+    TEST_ASSERT_TRUE(log.start());
+
+    log.write(LogLevel::Info, "[LED] Turned %s", "ON");
+    for (int i = 0; i < 200; i++) {
+        {
+            std::lock_guard<std::mutex> lock(capture.mutex);
+            if (!capture.lines.empty()) {
+                break;
+            }
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    {
+        std::lock_guard<std::mutex> lock(capture.mutex);
+        TEST_ASSERT_EQUAL(1, (int)capture.lines.size());
+        TEST_ASSERT_EQUAL_STRING("[LED] Turned ON\n", capture.lines[0].c_str());
+    }
+
+    // stop() writes what is left
+    log.write(LogLevel::Info, "[LED] Turned %s", "OFF");
+    log.stop();
+    TEST_ASSERT_EQUAL(2, (int)capture.lines.size());
+    TEST_ASSERT_FALSE(log.isRunning());
+}
+
+// ========================================
+// Benchmark
+// ========================================
+static double uartUs(size_t bytes) {
+    return bytes * 10.0 * 1e6 / 115200.0;  // 8N1: 10 bit times per byte
+}
+
+static double elapsedNs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+void test_benchmark_log_call_vs_serial_printf() {
+    const int rounds = 1000;
+    const int batch = 200;             // fits the ring: the writer runs between batches, untimed
+    const int calls = rounds * batch;
+    static LogSlot slots[256];
+    AsyncLogConfig config;
+    config.sink = nullSink;
+    const char* payload = "PROFILE:VGA:12:66";
+
+    // Synchronous: format on the caller, then the UART (host: write to /dev/null + modeled line time)
+    FILE* devNull = fopen("/dev/null", "w");
+    TEST_ASSERT_NOT_NULL(devNull);
+    char line[kLogLineBytes];
+    size_t frameBytes = 0;
+    size_t textBytes = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < calls; i++) {
+        int length = snprintf(line, sizeof(line), "Frame #%lu sent (%u bytes, motion %u)\n",
+                              (unsigned long)i, 14812u, (unsigned)(i & 63));
+        frameBytes = (size_t)length;
+        fwrite(line, 1, frameBytes, devNull);
+    }
+    double syncFrameNs = elapsedNs(start) / calls;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < calls; i++) {
+        int length = snprintf(line, sizeof(line), "[WS] Received text: %s\n", payload);
+        textBytes = (size_t)length;
+        fwrite(line, 1, textBytes, devNull);
+    }
+    double syncTextNs = elapsedNs(start) / calls;
+    fclose(devNull);
+
+    // Asynchronous: record only; formatting happens in flush() (the writer task on the device)
+    AsyncLog log(config, slots, 256);
+    AsyncLog::install(&log);
+    double frameNs = 0;
+    double textNs = 0;
+    double writerNs = 0;
+    for (int round = 0; round < rounds; round++) {
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < batch; i++) {
+            LOG_INFO("Frame #%lu sent (%u bytes, motion %u)", (unsigned long)i, 14812u, (unsigned)(i & 63));
+        }
+        frameNs += elapsedNs(start);
+        start = std::chrono::steady_clock::now();
+        log.flush();
+        writerNs += elapsedNs(start);
+
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < batch; i++) {
+            LOG_INFO("[WS] Received text: %s", payload);
+        }
+        textNs += elapsedNs(start);
+        log.flush();
+    }
+    frameNs /= calls;
+    textNs /= calls;
+    writerNs /= calls;
+
+    // Compiled out
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < calls; i++) {
+        LOG_DEBUG("Frame #%lu sent (%u bytes, motion %u)", (unsigned long)i, 14812u, (unsigned)(i & 63));
+    }
+    double debugNs = elapsedNs(start) / calls;
+    AsyncLogStats stats = log.getStats();
+    AsyncLog::install(NULL);
+
+    printf("\n  per-call cost on the calling task (host CPU; UART time at 115200 baud modeled)\n");
+    printf("  %-12s %6s %22s %10s %10s\n", "line", "bytes", "Serial.printf", "LOG_INFO", "LOG_DEBUG");
+    printf("  %-12s %4u B %8.0f ns + %6.2f ms %7.0f ns %7.1f ns\n", "frame line", (unsigned)frameBytes,
+           syncFrameNs, uartUs(frameBytes) / 1000.0, frameNs, debugNs);
+    printf("  %-12s %4u B %8.0f ns + %6.2f ms %7.0f ns %10s\n", "text line", (unsigned)textBytes,
+           syncTextNs, uartUs(textBytes) / 1000.0, textNs, "-");
+    printf("  writer task: %.0f ns/record to format, then the UART; record %u bytes (64 slots = %u KB)\n",
+           writerNs, (unsigned)sizeof(LogSlot), (unsigned)(sizeof(LogSlot) * 64 / 1024));
+    printf("  posted=%u dropped=%u written=%u\n", stats.posted, stats.dropped, stats.written);
+
+    // Recording must be far cheaper than the line time on the UART; debug calls cost nothing
+    TEST_ASSERT_EQUAL(2 * calls, (int)stats.written);
+    TEST_ASSERT_TRUE(frameNs < uartUs(frameBytes) * 1000.0 / 100.0);
+    TEST_ASSERT_TRUE(debugNs < 5.0);
+}
+
+int main(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+    UNITY_BEGIN();
+    RUN_TEST(test_deferred_format_matches_printf);
+    RUN_TEST(test_string_arguments_are_copied);
+    RUN_TEST(test_long_strings_are_truncated_to_the_record);
+    RUN_TEST(test_timestamp_and_level_prefix);
+    RUN_TEST(test_full_ring_drops_and_reports);
+    RUN_TEST(test_levels_below_threshold_compile_out);
+    RUN_TEST(test_concurrent_producers_keep_records_whole);
+    RUN_TEST(test_writer_thread_drains_in_background);
+    RUN_TEST(test_benchmark_log_call_vs_serial_printf);
+    return UNITY_END();
+}
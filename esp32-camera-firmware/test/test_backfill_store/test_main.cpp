@@ -0,0 +1,362 @@
+/**
+ * `test_main.cpp`
+ * - Unit tests for BackfillStore with simulated outages (native host build)
+ * - Run: pio test -e native -f test_backfill_store
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#include <unity.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#include <vector>
+
+#include "BackfillStore.h"
+
+void setUp(void) {}
+void tearDown(void) {}
+
+static uint8_t frameData[64 * 1024];
+
+/**
+ * Fill frameData with a pattern derived from the capture time
+ */
+static BackfillFrame makeFrame(uint64_t captureUs, uint32_t length) {
+    for (uint32_t i = 0; i < length; i++) {
+        frameData[i] = (uint8_t)(captureUs * 31 + i * 7);
+    }
+    BackfillFrame frame = {};
+    frame.data = frameData;
+    frame.length = length;
+    frame.captureUs = captureUs;
+    frame.width = 640;
+    frame.height = 480;
+    frame.frameSize = 8;
+    frame.jpegQuality = 12;
+    return frame;
+}
+
+static bool patternMatches(const BackfillFrame& frame) {
+    for (uint32_t i = 0; i < frame.length; i++) {
+        if (frame.data[i] != (uint8_t)(frame.captureUs * 31 + i * 7)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Deterministic pseudo-random frame sizes
+ */
+struct SimRandom {
+    uint32_t state;
+    explicit SimRandom(uint32_t seed) : state(seed) {}
+    uint32_t next(uint32_t range) {
+        state = state * 1664525u + 1013904223u;
+        return (state >> 8) % range;
+    }
+};
+
+// ========================================
+// Storage
+// ========================================
+void test_frames_come_back_in_order_with_metadata() {
+    std::vector<uint8_t> arena(64 * 1024);
+    BackfillConfig config;
+    config.capacityBytes = arena.size();
+    BackfillStore store(config, arena.data());
+
+    TEST_ASSERT_TRUE(store.isEmpty());
+    for (uint64_t t = 1; t <= 3; t++) {
+        BackfillFrame frame = makeFrame(t * 1000, 1000 + (uint32_t)t);
+        frame.motionScore = (uint16_t)(t * 10);
+        TEST_ASSERT_TRUE(store.record(frame, t * 1000));
+    }
+
+    for (uint64_t t = 1; t <= 3; t++) {
+        BackfillFrame frame;
+        TEST_ASSERT_TRUE(store.beginSend(frame));
+        TEST_ASSERT_EQUAL_UINT64(t * 1000, frame.captureUs);
+        TEST_ASSERT_EQUAL_UINT32(1000 + t, frame.length);
+        TEST_ASSERT_EQUAL_UINT32(t, frame.sequence);
+        TEST_ASSERT_EQUAL_UINT16(t * 10, frame.motionScore);
+        TEST_ASSERT_EQUAL_UINT16(640, frame.width);
+        TEST_ASSERT_EQUAL_UINT8(12, frame.jpegQuality);
+        TEST_ASSERT_TRUE(patternMatches(frame));
+        store.endSend(true);
+    }
+    TEST_ASSERT_TRUE(store.isEmpty());
+
+    BackfillStats stats = store.getStats();
+    TEST_ASSERT_EQUAL_UINT32(3, stats.recorded);
+    TEST_ASSERT_EQUAL_UINT32(3, stats.sent);
+    TEST_ASSERT_EQUAL_UINT64(3006, stats.sentBytes);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.pendingBytes);
+}
+
+void test_record_is_decimated() {
+    std::vector<uint8_t> arena(16 * 1024);
+    BackfillConfig config;
+    config.capacityBytes = arena.size();
+    config.recordIntervalMs = 500;
+    BackfillStore store(config, arena.data());
+
+    // Nothing is recorded before the first outage (e.g. while booting)
+    TEST_ASSERT_FALSE(store.recordDue(0));
+    store.onDisconnect(0);
+    TEST_ASSERT_TRUE(store.recordDue(0));
+    store.record(makeFrame(0, 100), 0);
+    TEST_ASSERT_FALSE(store.recordDue(499999));
+    TEST_ASSERT_TRUE(store.recordDue(500000));
+    store.onConnect(600000);
+    TEST_ASSERT_FALSE(store.recordDue(600000));
+
+    BackfillStore disabled(config, NULL);
+    disabled.onDisconnect(0);
+    TEST_ASSERT_FALSE(disabled.recordDue(0));
+    TEST_ASSERT_FALSE(disabled.record(makeFrame(0, 100), 0));
+}
+
+void test_drop_oldest_keeps_latest_within_cap() {
+    std::vector<uint8_t> arena(100 * 1024);
+    BackfillConfig config;
+    config.capacityBytes = arena.size();
+    config.eviction = BackfillEviction::DropOldest;
+    BackfillStore store(config, arena.data());
+    SimRandom random(3);
+
+    // Many wrap-arounds with frame sizes of 5..30 KB
+    const uint32_t frames = 500;
+    for (uint32_t i = 1; i <= frames; i++) {
+        TEST_ASSERT_TRUE(store.record(makeFrame(i, 5000 + random.next(25000)), i));
+        BackfillStats stats = store.getStats();
+        TEST_ASSERT_TRUE(stats.pendingBytes <= config.capacityBytes);
+    }
+
+    BackfillStats stats = store.getStats();
+    TEST_ASSERT_EQUAL_UINT32(frames, stats.recorded);
+    TEST_ASSERT_EQUAL_UINT32(frames - stats.pendingFrames, stats.evicted);
+    TEST_ASSERT_TRUE(stats.pendingFrames >= 3);
+
+    // What is left is the newest run of frames, intact
+    uint64_t expected = frames - stats.pendingFrames + 1;
+    BackfillFrame frame;
+    while (store.beginSend(frame)) {
+        TEST_ASSERT_EQUAL_UINT64(expected, frame.captureUs);
+        TEST_ASSERT_TRUE(patternMatches(frame));
+        store.endSend(true);
+        expected++;
+    }
+    TEST_ASSERT_EQUAL_UINT64(frames + 1, expected);
+}
+
+void test_drop_newest_keeps_start_of_outage() {
+    std::vector<uint8_t> arena(32 * 1024);
+    BackfillConfig config;
+    config.capacityBytes = arena.size();
+    config.eviction = BackfillEviction::DropNewest;
+    BackfillStore store(config, arena.data());
+
+    uint32_t stored = 0;
+    for (uint64_t t = 1; t <= 10; t++) {
+        if (store.record(makeFrame(t, 7000), t)) stored++;
+    }
+    TEST_ASSERT_EQUAL_UINT32(4, stored);
+    TEST_ASSERT_EQUAL_UINT32(6, store.getStats().rejected);
+
+    BackfillFrame frame;
+    TEST_ASSERT_TRUE(store.beginSend(frame));
+    TEST_ASSERT_EQUAL_UINT64(1, frame.captureUs);
+    store.endSend(true);
+    // Room again after backfilling one frame
+    TEST_ASSERT_TRUE(store.record(makeFrame(11, 7000), 11));
+}
+
+void test_oversize_frame_is_rejected() {
+    std::vector<uint8_t> arena(8 * 1024);
+    BackfillConfig config;
+    config.capacityBytes = arena.size();
+    BackfillStore store(config, arena.data());
+
+    TEST_ASSERT_TRUE(store.record(makeFrame(1, 4000), 1));
+    TEST_ASSERT_FALSE(store.record(makeFrame(2, 8 * 1024), 2));
+    BackfillStats stats = store.getStats();
+    TEST_ASSERT_EQUAL_UINT32(1, stats.rejected);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.pendingFrames);
+}
+
+void test_in_flight_frame_is_never_evicted() {
+    std::vector<uint8_t> arena(16 * 1024);
+    BackfillConfig config;
+    config.capacityBytes = arena.size();
+    BackfillStore store(config, arena.data());
+
+    store.record(makeFrame(1, 7000), 1);
+    store.record(makeFrame(2, 7000), 2);
+    BackfillFrame frame;
+    TEST_ASSERT_TRUE(store.beginSend(frame));
+    TEST_ASSERT_FALSE(store.beginSend(frame));
+
+    // Link dropped mid-send: new frame cannot evict the pinned head
+    TEST_ASSERT_FALSE(store.record(makeFrame(3, 7000), 3));
+    TEST_ASSERT_TRUE(patternMatches(frame));
+    store.endSend(false);
+
+    // Unsent frame stays, now it can be evicted
+    TEST_ASSERT_TRUE(store.record(makeFrame(3, 7000), 3));
+    TEST_ASSERT_TRUE(store.beginSend(frame));
+    TEST_ASSERT_EQUAL_UINT64(2, frame.captureUs);
+    store.endSend(false);
+}
+
+void test_clear_waits_for_in_flight_send() {
+    std::vector<uint8_t> arena(16 * 1024);
+    BackfillConfig config;
+    config.capacityBytes = arena.size();
+    BackfillStore store(config, arena.data());
+
+    store.record(makeFrame(1, 1000), 1);
+    store.record(makeFrame(2, 1000), 2);
+    BackfillFrame frame;
+    TEST_ASSERT_TRUE(store.beginSend(frame));
+    store.clear();
+    TEST_ASSERT_FALSE(store.isEmpty());
+    store.endSend(true);
+    TEST_ASSERT_TRUE(store.isEmpty());
+    TEST_ASSERT_EQUAL_UINT32(1, store.getStats().sent);
+}
+
+// ========================================
+// Rate Cap
+// ========================================
+void test_backfill_rate_is_capped_share_of_link() {
+    std::vector<uint8_t> arena(2 * 1024 * 1024);
+    BackfillConfig config;
+    config.capacityBytes = arena.size();
+    config.sharePercent = 25;
+    config.burstBytes = 16 * 1024;
+    BackfillStore store(config, arena.data());
+
+    for (uint64_t t = 1; t <= 100; t++) {
+        store.record(makeFrame(t, 15000), t);
+    }
+    store.setLinkRate(2000);   // → 500 kbps = 62.5 KB/s
+    store.onConnect(0);
+
+    uint64_t sentBytes = 0;
+    for (uint64_t now = 0; now <= 10000000; now += 5000) {
+        BackfillFrame frame;
+        if (store.sendDue(now) && store.beginSend(frame)) {
+            sentBytes += frame.length;
+            store.endSend(true);
+        }
+    }
+    TEST_ASSERT_EQUAL_UINT32(500, store.getStats().rateKbps);
+    // 10 s at 62.5 KB/s, plus the frame borrowed ahead at the start
+    TEST_ASSERT_TRUE(sentBytes >= 600000);
+    TEST_ASSERT_TRUE(sentBytes <= 625000 + 15000);
+
+    // Unknown link rate falls back to the floor
+    store.setLinkRate(0);
+    TEST_ASSERT_EQUAL_UINT32(config.minRateKbps, store.getStats().rateKbps);
+}
+
+// ========================================
+// Outage Simulation
+// ========================================
+void test_outage_backfills_behind_live_stream() {
+    // 60 s of ~720 kbps live video (15 FPS) over a 1200 kbps link; outages at 10-15 s and 30-34 s
+    std::vector<uint8_t> arena(256 * 1024);
+    BackfillConfig config;
+    config.capacityBytes = arena.size();
+    config.recordIntervalMs = 500;
+    config.sharePercent = 25;
+    BackfillStore store(config, arena.data());
+    store.setLinkRate(1200);
+    SimRandom random(11);
+
+    const uint64_t frameUs = 66667;
+    const uint64_t endUs = 60000000;
+    bool connected = true;
+    store.onConnect(0);
+    uint64_t liveBytes = 0;
+    uint64_t backfillBytes = 0;
+    uint64_t linkBusyUntil = 0;
+    uint64_t lastBackfillCaptureUs = 0;
+    uint32_t backfilled = 0;
+    uint64_t maxBackfillSecondBytes = 0;
+    uint64_t secondBytes = 0;
+    uint64_t secondStart = 0;
+
+    for (uint64_t now = 0; now < endUs; now += 5000) {
+        bool online = !(now >= 10000000 && now < 15000000) && !(now >= 30000000 && now < 34000000);
+        if (online != connected) {
+            connected = online;
+            if (online) store.onConnect(now); else store.onDisconnect(now);
+        }
+        bool tick = now % frameUs < 5000;
+        uint32_t length = 4000 + random.next(2000);
+
+        if (!connected) {
+            if (tick && store.recordDue(now)) {
+                TEST_ASSERT_TRUE(store.record(makeFrame(now, length), now));
+            }
+            continue;
+        }
+        if (now - secondStart >= 1000000) {
+            if (secondBytes > maxBackfillSecondBytes) maxBackfillSecondBytes = secondBytes;
+            secondBytes = 0;
+            secondStart = now;
+        }
+        if (tick) {
+            // Live frame first; the link is busy for its serialization time
+            liveBytes += length;
+            linkBusyUntil = now + (uint64_t)length * 8000 / 1200;
+            continue;
+        }
+        BackfillFrame frame;
+        if (now >= linkBusyUntil && store.sendDue(now) && store.beginSend(frame)) {
+            TEST_ASSERT_TRUE(patternMatches(frame));
+            TEST_ASSERT_TRUE(frame.captureUs > lastBackfillCaptureUs);
+            lastBackfillCaptureUs = frame.captureUs;
+            backfillBytes += frame.length;
+            secondBytes += frame.length;
+            backfilled++;
+            linkBusyUntil = now + (uint64_t)frame.length * 8000 / 1200;
+            store.endSend(true);
+        }
+    }
+
+    BackfillStats stats = store.getStats();
+    printf("  outages=%u recorded=%u backfilled=%u (%.0f KB) live=%.0f KB max=%.1f KB/s\n",
+           stats.outages, stats.recorded, backfilled, backfillBytes / 1024.0, liveBytes / 1024.0,
+           maxBackfillSecondBytes / 1024.0);
+    TEST_ASSERT_EQUAL_UINT32(2, stats.outages);
+    TEST_ASSERT_EQUAL_UINT32(18, stats.recorded);     // 10 + 8 frames at 2 FPS
+    TEST_ASSERT_EQUAL_UINT32(0, stats.evicted);
+    TEST_ASSERT_EQUAL_UINT32(stats.recorded, backfilled);
+    TEST_ASSERT_TRUE(store.isEmpty());
+    // 25% of 1200 kbps = 37.5 KB/s, plus one frame borrowed ahead
+    TEST_ASSERT_TRUE(maxBackfillSecondBytes <= 37500 + 6000);
+}
+
+int main(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+    UNITY_BEGIN();
+    RUN_TEST(test_frames_come_back_in_order_with_metadata);
+    RUN_TEST(test_record_is_decimated);
+    RUN_TEST(test_drop_oldest_keeps_latest_within_cap);
+    RUN_TEST(test_drop_newest_keeps_start_of_outage);
+    RUN_TEST(test_oversize_frame_is_rejected);
+    RUN_TEST(test_in_flight_frame_is_never_evicted);
+    RUN_TEST(test_clear_waits_for_in_flight_send);
+    RUN_TEST(test_backfill_rate_is_capped_share_of_link);
+    RUN_TEST(test_outage_backfills_behind_live_stream);
+    return UNITY_END();
+}
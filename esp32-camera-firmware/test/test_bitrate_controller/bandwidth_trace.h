@@ -0,0 +1,54 @@
+/**
+ * `bandwidth_trace.h`
+ * - Bandwidth/RSSI trace replayed by the ABR tests
+ * - Shape: good WiFi → congested → weak signal → recovered (one sample per second)
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#ifndef BANDWIDTH_TRACE_H
+#define BANDWIDTH_TRACE_H
+
+#include <stdint.h>
+
+struct TraceSample {
+    uint32_t timeMs;     // sample start
+    uint32_t kbps;       // available uplink throughput
+    int8_t rssiDbm;      // WiFi.RSSI()
+};
+
+static const TraceSample BANDWIDTH_TRACE[] = {
+    // Phase 1: good WiFi (0-20 s)
+    {0, 6200, -58}, {1000, 5900, -59}, {2000, 6400, -58}, {3000, 6100, -60}, {4000, 5800, -59},
+    {5000, 6000, -58}, {6000, 6300, -57}, {7000, 5700, -59}, {8000, 6100, -60}, {9000, 6000, -58},
+    {10000, 5900, -59}, {11000, 6200, -58}, {12000, 6000, -60}, {13000, 5800, -61}, {14000, 6100, -59},
+    {15000, 6000, -58}, {16000, 5900, -59}, {17000, 6200, -60}, {18000, 6000, -59}, {19000, 5800, -60},
+    // Phase 2: congested channel (20-45 s)
+    {20000, 1400, -68}, {21000, 900, -70}, {22000, 750, -71}, {23000, 700, -72}, {24000, 680, -71},
+    {25000, 720, -72}, {26000, 650, -73}, {27000, 700, -72}, {28000, 760, -71}, {29000, 690, -72},
+    {30000, 640, -73}, {31000, 710, -72}, {32000, 700, -71}, {33000, 680, -72}, {34000, 730, -73},
+    {35000, 700, -72}, {36000, 660, -72}, {37000, 690, -71}, {38000, 720, -72}, {39000, 700, -73},
+    {40000, 680, -72}, {41000, 710, -72}, {42000, 700, -71}, {43000, 690, -72}, {44000, 700, -73},
+    // Phase 3: weak signal (45-70 s)
+    {45000, 420, -79}, {46000, 300, -82}, {47000, 260, -83}, {48000, 240, -84}, {49000, 250, -83},
+    {50000, 230, -84}, {51000, 260, -83}, {52000, 250, -83}, {53000, 240, -84}, {54000, 255, -83},
+    {55000, 245, -84}, {56000, 250, -83}, {57000, 260, -82}, {58000, 240, -84}, {59000, 250, -83},
+    {60000, 255, -83}, {61000, 245, -84}, {62000, 250, -83}, {63000, 240, -83}, {64000, 250, -84},
+    {65000, 260, -83}, {66000, 250, -82}, {67000, 245, -83}, {68000, 250, -83}, {69000, 255, -84},
+    // Phase 4: recovered (70-110 s)
+    {70000, 3000, -66}, {71000, 4800, -62}, {72000, 5000, -61}, {73000, 5100, -62}, {74000, 4900, -61},
+    {75000, 5000, -62}, {76000, 5200, -61}, {77000, 4900, -62}, {78000, 5000, -61}, {79000, 5100, -62},
+    {80000, 5000, -61}, {81000, 4800, -62}, {82000, 5000, -61}, {83000, 5100, -62}, {84000, 4900, -61},
+    {85000, 5000, -62}, {86000, 5200, -61}, {87000, 4900, -62}, {88000, 5000, -61}, {89000, 5100, -62},
+    {90000, 5000, -61}, {91000, 4800, -62}, {92000, 5000, -61}, {93000, 5100, -62}, {94000, 4900, -61},
+    {95000, 5000, -62}, {96000, 5200, -61}, {97000, 4900, -62}, {98000, 5000, -61}, {99000, 5100, -62},
+    {100000, 5000, -61}, {101000, 4800, -62}, {102000, 5000, -61}, {103000, 5100, -62}, {104000, 4900, -61},
+    {105000, 5000, -62}, {106000, 5200, -61}, {107000, 4900, -62}, {108000, 5000, -61}, {109000, 5100, -62},
+};
+
+static const uint32_t BANDWIDTH_TRACE_LENGTH = sizeof(BANDWIDTH_TRACE) / sizeof(BANDWIDTH_TRACE[0]);
+
+#endif // BANDWIDTH_TRACE_H
@@ -0,0 +1,288 @@
+/**
+ * `test_main.cpp`
+ * - Unit tests for BitrateController (native host build)
+ * - Replays a bandwidth/RSSI trace against a stub link
+ * - Run: pio test -e native -f test_bitrate_controller
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#include <unity.h>
+
+#include "BitrateController.h"
+#include "bandwidth_trace.h"
+
+// framesize_t values from esp32-camera (sensor.h)
+enum {
+    FS_QVGA = 5,
+    FS_HVGA = 7,
+    FS_VGA = 8
+};
+
+static const BitrateRung LADDER[] = {
+    {FS_QVGA, 30, 200},
+    {FS_QVGA, 20, 100},
+    {FS_HVGA, 25, 100},
+    {FS_HVGA, 15, 66},
+    {FS_VGA, 12, 66},
+};
+static const size_t LADDER_SIZE = sizeof(LADDER) / sizeof(LADDER[0]);
+
+void setUp(void) {}
+void tearDown(void) {}
+
+static BitrateConfig makeConfig(size_t initialRung) {
+    BitrateConfig config;
+    config.ladder = LADDER;
+    config.ladderSize = LADDER_SIZE;
+    config.initialRung = initialRung;
+    return config;
+}
+
+// ========================================
+// Stub Link
+// ========================================
+
+/**
+ * JPEG size model for the OV2640: bits per pixel falls with the quality index
+ */
+static size_t frameBytes(const BitrateRung& rung) {
+    uint32_t pixels;
+    switch (rung.frameSize) {
+        case FS_QVGA: pixels = 320 * 240; break;
+        case FS_HVGA: pixels = 480 * 320; break;
+        default:      pixels = 640 * 480; break;
+    }
+    return (size_t)(pixels * (12.0 / (rung.jpegQuality + 2)) / 8);
+}
+
+static const TraceSample& traceAt(uint32_t nowMs) {
+    uint32_t index = nowMs / 1000;
+    return BANDWIDTH_TRACE[index < BANDWIDTH_TRACE_LENGTH ? index : BANDWIDTH_TRACE_LENGTH - 1];
+}
+
+/**
+ * Time for the socket to accept `bytes` on the traced link (plus fixed overhead)
+ */
+static uint32_t linkSendUs(size_t bytes, uint32_t nowMs) {
+    return (uint32_t)((uint64_t)bytes * 8 * 1000 / traceAt(nowMs).kbps) + 3000;
+}
+
+struct ReplayResult {
+    size_t rungAt[4];          // rung at the end of each trace phase
+    size_t minRung;
+    uint32_t switches;
+    uint32_t lateFrames;       // sends longer than 2 × interval after the first 3 s of a phase
+    uint32_t frames;
+};
+
+/**
+ * Replay the trace with synchronous capture → send → wait pacing
+ */
+static ReplayResult replay(BitrateController& abr) {
+    static const uint32_t PHASE_END_MS[4] = {20000, 45000, 70000, 110000};
+    ReplayResult result = {};
+    result.minRung = abr.getRungIndex();
+    uint32_t nowMs = 0;
+    int phase = 0;
+
+    while (nowMs < PHASE_END_MS[3]) {
+        const BitrateRung& rung = abr.getRung();
+        size_t bytes = frameBytes(rung);
+        uint32_t sendUs = linkSendUs(bytes, nowMs);
+
+        uint32_t phaseStartMs = phase == 0 ? 0 : PHASE_END_MS[phase - 1];
+        if (nowMs - phaseStartMs > 3000 && sendUs > 2000u * rung.intervalMs) {
+            result.lateFrames++;
+        }
+        result.frames++;
+
+        uint32_t sendMs = sendUs / 1000;
+        uint32_t stepMs = sendMs > rung.intervalMs ? sendMs : rung.intervalMs;
+        nowMs += stepMs;
+
+        abr.onFrameSent(bytes, sendUs, nowMs);
+        abr.onRssi(traceAt(nowMs).rssiDbm);
+        abr.update(nowMs);
+
+        if (abr.getRungIndex() < result.minRung) {
+            result.minRung = abr.getRungIndex();
+        }
+        while (phase < 4 && nowMs >= PHASE_END_MS[phase]) {
+            result.rungAt[phase++] = abr.getRungIndex();
+        }
+    }
+    BitrateStats stats = abr.getStats();
+    result.switches = stats.switchesUp + stats.switchesDown;
+    return result;
+}
+
+// ========================================
+// Trace Replay
+// ========================================
+void test_trace_replay_follows_link_capacity(void) {
+    BitrateController abr(makeConfig(LADDER_SIZE - 1));
+    ReplayResult result = replay(abr);
+
+    TEST_ASSERT_EQUAL(LADDER_SIZE - 1, result.rungAt[0]);   // good WiFi: stay on top
+    TEST_ASSERT_LESS_OR_EQUAL(2, result.rungAt[1]);          // congestion: stepped down
+    TEST_ASSERT_LESS_OR_EQUAL(1, result.rungAt[2]);          // weak signal: near the bottom
+    TEST_ASSERT_GREATER_OR_EQUAL(3, result.rungAt[3]);       // recovered: climbed back
+    TEST_ASSERT_LESS_THAN(16, result.switches);              // hysteresis: no oscillation
+}
+
+void test_trace_replay_bounds_late_frames(void) {
+    BitrateController adaptive(makeConfig(LADDER_SIZE - 1));
+    ReplayResult withAbr = replay(adaptive);
+
+    // Reference: fixed top rung (ladder of one)
+    BitrateConfig fixedConfig = makeConfig(0);
+    fixedConfig.ladder = &LADDER[LADDER_SIZE - 1];
+    fixedConfig.ladderSize = 1;
+    BitrateController fixed(fixedConfig);
+    ReplayResult withoutAbr = replay(fixed);
+
+    TEST_ASSERT_GREATER_THAN(50, withoutAbr.lateFrames);
+    TEST_ASSERT_LESS_THAN(withoutAbr.lateFrames / 10, withAbr.lateFrames);
+}
+
+// ========================================
+// Hysteresis & Thresholds
+// ========================================
+
+/**
+ * Feed one window of identical frames
+ */
+static void feedWindow(BitrateController& abr, uint32_t& nowMs, uint32_t sendUs, int8_t rssi) {
+    uint32_t endMs = nowMs + 1000;
+    while (nowMs < endMs) {
+        nowMs += 100;
+        abr.onFrameSent(10000, sendUs, nowMs);
+    }
+    abr.onRssi(rssi);
+}
+
+void test_step_up_requires_hold_time(void) {
+    BitrateConfig config = makeConfig(1);
+    config.upHoldMs = 5000;
+    config.minDwellMs = 0;
+    BitrateController abr(config);
+    uint32_t nowMs = 0;
+
+    for (int i = 0; i < 5; i++) {
+        feedWindow(abr, nowMs, 10000, -60);  // 10% utilization
+        abr.update(nowMs);
+        TEST_ASSERT_EQUAL(1, abr.getRungIndex());
+    }
+    feedWindow(abr, nowMs, 10000, -60);
+    TEST_ASSERT_TRUE(abr.update(nowMs));
+    TEST_ASSERT_EQUAL(2, abr.getRungIndex());
+}
+
+void test_step_down_respects_min_dwell(void) {
+    BitrateConfig config = makeConfig(3);
+    config.minDwellMs = 3000;
+    BitrateController abr(config);
+    uint32_t nowMs = 0;
+
+    feedWindow(abr, nowMs, 95000, -60);  // 95 ms per 66 ms frame
+    TEST_ASSERT_TRUE(abr.update(nowMs + 3000));
+    nowMs += 3000;
+    TEST_ASSERT_EQUAL(2, abr.getRungIndex());
+
+    feedWindow(abr, nowMs, 95000, -60);  // still bad, but within dwell
+    TEST_ASSERT_FALSE(abr.update(nowMs));
+    TEST_ASSERT_EQUAL(2, abr.getRungIndex());
+}
+
+void test_backoff_after_step_down(void) {
+    BitrateConfig config = makeConfig(2);
+    config.minDwellMs = 0;
+    config.upHoldMs = 1000;
+    config.upBackoffMs = 8000;
+    BitrateController abr(config);
+    uint32_t nowMs = 0;
+
+    feedWindow(abr, nowMs, 150000, -60);
+    abr.update(nowMs);
+    TEST_ASSERT_EQUAL(1, abr.getRungIndex());
+
+    // Conditions good again, but the step up waits out the backoff
+    for (int i = 0; i < 6; i++) {
+        feedWindow(abr, nowMs, 5000, -60);
+        abr.update(nowMs);
+        TEST_ASSERT_EQUAL(1, abr.getRungIndex());
+    }
+    for (int i = 0; i < 3; i++) {
+        feedWindow(abr, nowMs, 5000, -60);
+        abr.update(nowMs);
+    }
+    TEST_ASSERT_EQUAL(2, abr.getRungIndex());
+}
+
+void test_weak_rssi_steps_down_and_blocks_up(void) {
+    BitrateConfig config = makeConfig(2);
+    config.minDwellMs = 0;
+    config.upHoldMs = 0;
+    config.upBackoffMs = 0;
+    BitrateController abr(config);
+    uint32_t nowMs = 0;
+
+    feedWindow(abr, nowMs, 5000, -85);
+    TEST_ASSERT_TRUE(abr.update(nowMs));
+    TEST_ASSERT_EQUAL(1, abr.getRungIndex());
+
+    // Low utilization but RSSI between the thresholds: hold
+    feedWindow(abr, nowMs, 5000, -76);
+    TEST_ASSERT_FALSE(abr.update(nowMs));
+    TEST_ASSERT_EQUAL(1, abr.getRungIndex());
+}
+
+void test_emergency_step_down_on_stalled_send(void) {
+    BitrateController abr(makeConfig(4));
+
+    TEST_ASSERT_FALSE(abr.onFrameSent(30000, 50000, 1000));
+    TEST_ASSERT_TRUE(abr.onFrameSent(30000, 400000, 1500));  // 400 ms vs 66 ms interval
+    TEST_ASSERT_EQUAL(3, abr.getRungIndex());
+
+    // Not again within the same window
+    TEST_ASSERT_FALSE(abr.onFrameSent(30000, 400000, 1700));
+    TEST_ASSERT_EQUAL(3, abr.getRungIndex());
+}
+
+void test_no_change_without_samples(void) {
+    BitrateController abr(makeConfig(2));
+    TEST_ASSERT_FALSE(abr.update(5000));
+    TEST_ASSERT_FALSE(abr.update(10000));
+    TEST_ASSERT_EQUAL(2, abr.getRungIndex());
+}
+
+void test_ladder_bounds(void) {
+    BitrateConfig config = makeConfig(99);
+    BitrateController abr(config);
+    TEST_ASSERT_EQUAL(LADDER_SIZE - 1, abr.getRungIndex());
+
+    abr.setRung(0, 0);
+    TEST_ASSERT_EQUAL(0, abr.getRungIndex());
+    abr.setRung(LADDER_SIZE, 0);
+    TEST_ASSERT_EQUAL(0, abr.getRungIndex());
+}
+
+int main(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+    UNITY_BEGIN();
+    RUN_TEST(test_trace_replay_follows_link_capacity);
+    RUN_TEST(test_trace_replay_bounds_late_frames);
+    RUN_TEST(test_step_up_requires_hold_time);
+    RUN_TEST(test_step_down_respects_min_dwell);
+    RUN_TEST(test_backoff_after_step_down);
+    RUN_TEST(test_weak_rssi_steps_down_and_blocks_up);
+    RUN_TEST(test_emergency_step_down_on_stalled_send);
+    RUN_TEST(test_no_change_without_samples);
+    RUN_TEST(test_ladder_bounds);
+    return UNITY_END();
+}
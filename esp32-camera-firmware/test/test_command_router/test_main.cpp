@@ -0,0 +1,480 @@
+/**
+ * `test_main.cpp`
+ * - Unit tests for CommandRouter and AllocCounter (native host build)
+ * - Zero-allocation checks: command dispatch and the steady-state frame path
+ *   (motion gate, envelope, clock sync, pacing, ABR, telemetry, backfill)
+ * - Run: pio test -e native -f test_command_router
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#include <unity.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "AllocCounter.h"
+#include "CommandRouter.h"
+
+#include <BackfillStore.h>
+#include <BitrateController.h>
+#include <ClockSync.h>
+#include <FrameEnvelope.h>
+#include <FramePacer.h>
+#include <FrameRing.h>
+#include <MotionGate.h>
+#include <Telemetry.h>
+
+#include "../test_motion_gate/jpeg_fixture.h"
+
+// ========================================
+// Test Command Table
+// ========================================
+static bool ledOn = false;
+static unsigned calls = 0;
+static char lastArgument[CommandRouter::kMaxArgument + 1];
+static bool lastBinary = false;
+
+static void onLedOn(const CommandArgs& args, CommandReply& reply) {
+    (void)args;
+    ledOn = true;
+    calls++;
+    reply.append("LED_STATUS:ON");
+}
+
+static void onLedOff(const CommandArgs& args, CommandReply& reply) {
+    (void)args;
+    ledOn = false;
+    calls++;
+    reply.append("LED_STATUS:OFF");
+}
+
+static void onLedStatus(const CommandArgs& args, CommandReply& reply) {
+    (void)args;
+    calls++;
+    reply.append(ledOn ? "LED_STATUS:ON" : "LED_STATUS:OFF");
+}
+
+static void onStats(const CommandArgs& args, CommandReply& reply) {
+    (void)args;
+    (void)reply;
+    calls++;
+}
+
+static void onRecList(const CommandArgs& args, CommandReply& reply) {
+    (void)args;
+    calls++;
+    // Larger than the reply buffer: must be dropped as a whole
+    for (int i = 0; i < 200; i++) {
+        reply.appendf("{\"id\":%d},", i);
+    }
+}
+
+static void onRecExport(const CommandArgs& args, CommandReply& reply) {
+    calls++;
+    memcpy(lastArgument, args.argument, args.argumentLength + 1);
+    lastBinary = args.binary;
+    unsigned long long fromMs = 0;
+    unsigned long long toMs = 0;
+    bool valid = sscanf(args.argument, "%llu:%llu", &fromMs, &toMs) == 2;
+    reply.appendf("REC_EXPORT_DONE:%llu", valid ? toMs - fromMs : 0ULL);
+}
+
+static constexpr CommandEntry kTable[] = {
+    { kCommandLedOn, "LED_ON", onLedOn },
+    { kCommandLedOff, "LED_OFF", onLedOff },
+    { kCommandLedStatus, "LED_STATUS", onLedStatus },
+    { kCommandStats, "STATS", onStats },
+    { kCommandRecList, "REC_LIST", onRecList },
+    { kCommandRecExport, "REC_EXPORT", onRecExport },
+};
+static_assert(CommandRouter::isValidTable(kTable), "test table must be valid");
+
+static constexpr CommandEntry kGapTable[] = {
+    { 1, "A", onLedOn },
+    { 3, "B", onLedOff },
+};
+static_assert(!CommandRouter::isValidTable(kGapTable), "opcode gap must be rejected");
+
+static constexpr CommandEntry kDuplicateTable[] = {
+    { 1, "A", onLedOn },
+    { 2, "B", onLedOff },
+    { 3, "A", onLedStatus },
+};
+static_assert(!CommandRouter::isValidTable(kDuplicateTable), "duplicate name must be rejected");
+
+static constexpr CommandEntry kNoHandlerTable[] = {
+    { 1, "A", nullptr },
+};
+static_assert(!CommandRouter::isValidTable(kNoHandlerTable), "missing handler must be rejected");
+
+static const size_t kTableSize = sizeof(kTable) / sizeof(kTable[0]);
+
+void setUp(void) {
+    ledOn = false;
+    calls = 0;
+    lastArgument[0] = '\0';
+    lastBinary = false;
+}
+
+void tearDown(void) {}
+
+static CommandStatus sendText(CommandRouter& router, const char* text) {
+    return router.dispatchText(text, strlen(text));
+}
+
+static CommandStatus sendBinary(CommandRouter& router, uint8_t opcode, const char* argument) {
+    uint8_t message[kCommandHeaderSize + CommandRouter::kMaxArgument];
+    size_t length = CommandRouter::encodeBinary(opcode, argument, strlen(argument), message, sizeof(message));
+    TEST_ASSERT_GREATER_THAN(0, length);
+    return router.dispatchBinary(message, length);
+}
+
+// ========================================
+// Dispatch
+// ========================================
+void test_text_commands_match_whole_names() {
+    CommandRouter router(kTable, kTableSize);
+
+    TEST_ASSERT_TRUE(sendText(router, "LED_ON") == CommandStatus::Handled);
+    TEST_ASSERT_TRUE(ledOn);
+    TEST_ASSERT_EQUAL_STRING("LED_STATUS:ON", router.reply().text());
+    TEST_ASSERT_EQUAL_size_t(13, router.reply().length());
+
+    TEST_ASSERT_TRUE(sendText(router, "LED_STATUS") == CommandStatus::Handled);
+    TEST_ASSERT_EQUAL_STRING("LED_STATUS:ON", router.reply().text());
+    TEST_ASSERT_TRUE(sendText(router, "LED_OFF") == CommandStatus::Handled);
+    TEST_ASSERT_FALSE(ledOn);
+
+    // Prefixes and extensions of a name are different commands
+    TEST_ASSERT_TRUE(sendText(router, "LED") == CommandStatus::Unknown);
+    TEST_ASSERT_TRUE(sendText(router, "LED_ONX") == CommandStatus::Unknown);
+    TEST_ASSERT_TRUE(sendText(router, "STAT") == CommandStatus::Unknown);
+    TEST_ASSERT_TRUE(sendText(router, "") == CommandStatus::Unknown);
+    TEST_ASSERT_EQUAL_UINT(3, calls);
+
+    // Only the given length is looked at (payloads are not always terminated where the command ends)
+    TEST_ASSERT_TRUE(router.dispatchText("STATSXYZ", 5) == CommandStatus::Handled);
+    TEST_ASSERT_EQUAL_UINT(4, calls);
+
+    CommandRouterStats stats = router.getStats();
+    TEST_ASSERT_EQUAL_UINT32(4, stats.text);
+    TEST_ASSERT_EQUAL_UINT32(4, stats.unknown);
+}
+
+void test_text_argument_is_terminated_copy() {
+    CommandRouter router(kTable, kTableSize);
+
+    TEST_ASSERT_TRUE(router.dispatchText("REC_EXPORT:1000:4000:junk", 20) == CommandStatus::Handled);
+    TEST_ASSERT_EQUAL_STRING("1000:4000", lastArgument);
+    TEST_ASSERT_FALSE(lastBinary);
+    TEST_ASSERT_EQUAL_STRING("REC_EXPORT_DONE:3000", router.reply().text());
+
+    TEST_ASSERT_TRUE(sendText(router, "REC_EXPORT:") == CommandStatus::Handled);
+    TEST_ASSERT_EQUAL_STRING("", lastArgument);
+    TEST_ASSERT_EQUAL_STRING("REC_EXPORT_DONE:0", router.reply().text());
+
+    std::string tooLong = "REC_EXPORT:" + std::string(CommandRouter::kMaxArgument + 1, '1');
+    TEST_ASSERT_TRUE(sendText(router, tooLong.c_str()) == CommandStatus::Malformed);
+    TEST_ASSERT_EQUAL_UINT32(1, router.getStats().malformed);
+}
+
+void test_binary_commands_index_table() {
+    CommandRouter router(kTable, kTableSize);
+
+    TEST_ASSERT_TRUE(sendBinary(router, kCommandLedOn, "") == CommandStatus::Handled);
+    TEST_ASSERT_TRUE(ledOn);
+    TEST_ASSERT_EQUAL_STRING("LED_STATUS:ON", router.reply().text());
+
+    TEST_ASSERT_TRUE(sendBinary(router, kCommandRecExport, "5:7") == CommandStatus::Handled);
+    TEST_ASSERT_EQUAL_STRING("5:7", lastArgument);
+    TEST_ASSERT_TRUE(lastBinary);
+    TEST_ASSERT_EQUAL_STRING("REC_EXPORT_DONE:2", router.reply().text());
+
+    TEST_ASSERT_TRUE(sendBinary(router, 0, "") == CommandStatus::Unknown);
+    TEST_ASSERT_TRUE(sendBinary(router, kTableSize + 1, "") == CommandStatus::Unknown);
+
+    // Framing: declared argument length must match the message
+    uint8_t message[16];
+    size_t length = CommandRouter::encodeBinary(kCommandRecExport, "1:2", 3, message, sizeof(message));
+    TEST_ASSERT_EQUAL_size_t(kCommandHeaderSize + 3, length);
+    TEST_ASSERT_TRUE(router.dispatchBinary(message, length - 1) == CommandStatus::Malformed);
+    TEST_ASSERT_TRUE(router.dispatchBinary(message, 2) == CommandStatus::Malformed);
+    TEST_ASSERT_EQUAL_size_t(0, CommandRouter::encodeBinary(kCommandRecExport, "1:2", 3, message, 6));
+
+    CommandRouterStats stats = router.getStats();
+    TEST_ASSERT_EQUAL_UINT32(2, stats.binary);
+    TEST_ASSERT_EQUAL_UINT32(2, stats.unknown);
+    TEST_ASSERT_EQUAL_UINT32(2, stats.malformed);
+}
+
+void test_binary_commands_are_not_frames() {
+    uint8_t envelope[FrameEnvelope::kHeaderSize];
+    FrameHeader header = {};
+    header.payloadLength = 0;
+    FrameEnvelope::encode(header, envelope, sizeof(envelope));
+    TEST_ASSERT_FALSE(CommandRouter::isBinaryCommand(envelope, sizeof(envelope)));
+
+    uint8_t command[kCommandHeaderSize];
+    CommandRouter::encodeBinary(kCommandStats, "", 0, command, sizeof(command));
+    TEST_ASSERT_TRUE(CommandRouter::isBinaryCommand(command, sizeof(command)));
+    TEST_ASSERT_FALSE(FrameEnvelope::isEnvelope(command, sizeof(command)));
+    TEST_ASSERT_FALSE(CommandRouter::isBinaryCommand(command, 3));
+}
+
+void test_reply_overflow_drops_whole_reply() {
+    CommandRouter router(kTable, kTableSize);
+
+    TEST_ASSERT_TRUE(sendText(router, "REC_LIST") == CommandStatus::Handled);
+    TEST_ASSERT_TRUE(router.reply().overflowed());
+    TEST_ASSERT_TRUE(router.reply().isEmpty());
+    TEST_ASSERT_EQUAL_UINT32(1, router.getStats().replyOverflows);
+
+    // The next command starts from an empty reply
+    TEST_ASSERT_TRUE(sendText(router, "LED_STATUS") == CommandStatus::Handled);
+    TEST_ASSERT_FALSE(router.reply().overflowed());
+    TEST_ASSERT_EQUAL_STRING("LED_STATUS:OFF", router.reply().text());
+}
+
+// ========================================
+// Allocation Counter
+// ========================================
+static int* volatile escaped = NULL;  // keeps the compiler from eliding new/delete pairs
+
+void test_alloc_counter_sees_new_and_delete() {
+    uint32_t allocations = AllocCounter::allocations();
+    uint32_t deallocations = AllocCounter::deallocations();
+    int* value = new int(7);
+    int* values = new int[16];
+    escaped = value;
+    escaped = values;
+    delete value;
+    delete[] values;
+    TEST_ASSERT_EQUAL_UINT32(allocations + 2, AllocCounter::allocations());
+    TEST_ASSERT_EQUAL_UINT32(deallocations + 2, AllocCounter::deallocations());
+
+    AllocScope scope;
+    std::vector<uint8_t> buffer(1000);
+    std::string text(100, 'x');
+    TEST_ASSERT_EQUAL_UINT32(2, scope.allocations());
+
+    // Platform (shim) allocations are counted apart
+    uint32_t platform = AllocCounter::platformAllocations();
+    {
+        AllocExempt exempt;
+        std::vector<uint8_t> shim(64);
+    }
+    TEST_ASSERT_EQUAL_UINT32(2, scope.allocations());
+    TEST_ASSERT_EQUAL_UINT32(platform + 1, AllocCounter::platformAllocations());
+}
+
+void test_dispatch_allocates_nothing() {
+    CommandRouter router(kTable, kTableSize);
+    const char* const texts[] = { "LED_ON", "LED_OFF", "LED_STATUS", "STATS", "REC_LIST",
+                                  "REC_EXPORT:1700000000000:1700000060000", "UNKNOWN", "PONG:1:2:3:4" };
+    uint8_t binary[kCommandHeaderSize + 16];
+    size_t binaryLength = CommandRouter::encodeBinary(kCommandRecExport, "10:20", 5, binary, sizeof(binary));
+
+    AllocScope scope;
+    for (int i = 0; i < 1000; i++) {
+        for (const char* text : texts) {
+            router.dispatchText(text, strlen(text));
+        }
+        router.dispatchBinary(binary, binaryLength);
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, scope.allocations());
+    TEST_ASSERT_EQUAL_UINT32(6000, router.getStats().text);
+}
+
+/**
+ * One capture → send iteration of the firmware, driven with fixture frames
+ * - Same module calls as captureAndSendFrame()/the network task; only the modules' own
+ *   allocations are counted (camera and WebSocket are not part of this process)
+ */
+void test_steady_state_frame_path_allocates_nothing() {
+    const int kFrames = 24;
+    FixtureEncoder encoder(60, FixtureSampling::Yuv422);
+    Scene background = makeBackground(320, 240);
+    std::vector<std::vector<uint8_t>> jpegs;
+    for (int i = 0; i < kFrames; i++) {
+        jpegs.push_back(encoder.encode(makeFrame(background, 10 + i, 3, 0, 40 + i * 8, 60, 48, 48)));
+    }
+
+    static const BitrateRung ladder[] = {
+        { 5, 20, 200 },
+        { 8, 12, 100 },
+    };
+    BitrateConfig abrConfig;
+    abrConfig.ladder = ladder;
+    abrConfig.ladderSize = 2;
+    abrConfig.initialRung = 1;
+
+    MotionGate motionGate{MotionGateConfig()};
+    ClockSync clockSync{ClockSyncConfig()};
+    FramePacer pacer{FramePacerConfig()};
+    FrameRing ring{FrameRingConfig()};
+    BitrateController abr(abrConfig);
+    Telemetry telemetry{TelemetryConfig()};
+    BackfillConfig backfillConfig;
+    backfillConfig.capacityBytes = 64 * 1024;
+    backfillConfig.recordIntervalMs = 0;
+    std::vector<uint8_t> arena(backfillConfig.capacityBytes);
+    BackfillStore backfill(backfillConfig, arena.data());
+    CommandRouter router(kTable, kTableSize);
+
+    std::vector<uint8_t> sendBuffer(64 * 1024);
+    char snapshot[Telemetry::kMaxSnapshot];
+    char ping[ClockSync::kMaxMessage];
+    char pong[ClockSync::kMaxMessage];
+
+    uint64_t nowUs = 1000000;
+    pacer.start(nowUs);
+    telemetry.resetWindow(nowUs);
+    uint32_t sequence = 0;
+
+    auto iterate = [&](int i) {
+        const std::vector<uint8_t>& jpeg = jpegs[i % kFrames];
+        nowUs += 100000;
+        pacer.poll(nowUs);
+        int slot = ring.onAcquire(jpeg.data(), nowUs - 3000, nowUs);
+        (void)slot;
+        MotionResult motion = motionGate.evaluate(jpeg.data(), jpeg.size(), (uint32_t)(nowUs / 1000));
+
+        FrameHeader header = {};
+        header.sequence = ++sequence;
+        header.captureUs = nowUs - 3000;
+        header.sendUs = nowUs;
+        header.payloadLength = (uint32_t)jpeg.size();
+        header.motionScore = motion.score;
+        size_t headerLength = FrameEnvelope::encode(header, sendBuffer.data(), sendBuffer.size());
+        memcpy(sendBuffer.data() + headerLength, jpeg.data(), jpeg.size());
+        ring.onRelease(jpeg.data(), nowUs);
+
+        abr.onFrameSent(jpeg.size(), 8000, (uint32_t)(nowUs / 1000));
+        telemetry.record(Metric::SendUs, 8000);
+        telemetry.record(Metric::FrameBytes, (uint32_t)jpeg.size());
+        telemetry.sampleMemory(180000, 3000000);
+        telemetry.sampleAllocations(AllocCounter::allocations());
+
+        // Every few frames: an outage frame, a backfill send, a clock sync exchange, a command
+        if (i % 4 == 0) {
+            BackfillFrame frame = {};
+            frame.data = jpeg.data();
+            frame.length = (uint32_t)jpeg.size();
+            frame.captureUs = nowUs;
+            backfill.record(frame, nowUs);
+            BackfillFrame stored;
+            if (backfill.beginSend(stored)) {
+                backfill.endSend(true);
+            }
+        }
+        if (i % 8 == 0) {
+            clockSync.makePing(nowUs, ping, sizeof(ping));
+            unsigned long long seq = 0;
+            unsigned long long t0 = 0;
+            sscanf(ping, "PING:%llu:%llu", &seq, &t0);
+            int length = snprintf(pong, sizeof(pong), "PONG:%llu:%llu:%llu:%llu", seq, t0,
+                                  t0 + 5000000, t0 + 5000100);
+            clockSync.handlePong(pong, (size_t)length, nowUs + 2000);
+            router.dispatchText("LED_STATUS", 10);
+        }
+        if (i % 50 == 49) {
+            telemetry.format(snapshot, sizeof(snapshot), nowUs);
+            telemetry.resetWindow(nowUs);
+        }
+    };
+
+    // Warm-up: lazy one-time setup (first-use buffers) is allowed here
+    for (int i = 0; i < kFrames; i++) {
+        iterate(i);
+    }
+
+    AllocScope scope;
+    for (int i = 0; i < 1000; i++) {
+        iterate(i);
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, scope.allocations());
+    TEST_ASSERT_TRUE(clockSync.isSynced());
+    TEST_ASSERT_GREATER_THAN(0, motionGate.getStats().frames);
+
+    // The snapshot reports the same: no allocation within the window
+    telemetry.format(snapshot, sizeof(snapshot), nowUs);
+    TEST_ASSERT_NOT_NULL(strstr(snapshot, "\"allocs\":{\"win\":0,"));
+}
+
+// ========================================
+// Benchmark
+// ========================================
+void test_benchmark_dispatch() {
+    const int kRounds = 200000;
+    CommandRouter router(kTable, kTableSize);
+    const char* text = "LED_STATUS";
+    size_t textLength = strlen(text);
+    uint8_t binary[kCommandHeaderSize];
+    size_t binaryLength = CommandRouter::encodeBinary(kCommandLedStatus, "", 0, binary, sizeof(binary));
+
+    AllocScope tableScope;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kRounds; i++) {
+        router.dispatchText(text, textLength);
+    }
+    auto textEnd = std::chrono::steady_clock::now();
+    for (int i = 0; i < kRounds; i++) {
+        router.dispatchBinary(binary, binaryLength);
+    }
+    auto binaryEnd = std::chrono::steady_clock::now();
+    uint32_t tableAllocs = tableScope.allocations();
+
+    // Previous handler shape: a String per message, compared against each command in turn
+    // (std::string keeps short text inline; Arduino String always allocates, so pad past the inline size)
+    std::string padded = std::string(text) + std::string(32, '\0');
+    AllocScope stringScope;
+    unsigned matched = 0;
+    for (int i = 0; i < kRounds; i++) {
+        std::string message(padded.data(), padded.size());
+        message.resize(textLength);
+        if (message == "LED_ON" || message == "LED_OFF") {
+            continue;
+        }
+        if (message == "LED_STATUS") {
+            matched++;
+        }
+    }
+    auto stringEnd = std::chrono::steady_clock::now();
+    uint32_t stringAllocs = stringScope.allocations();
+
+    double textNs = std::chrono::duration<double, std::nano>(textEnd - start).count() / kRounds;
+    double binaryNs = std::chrono::duration<double, std::nano>(binaryEnd - textEnd).count() / kRounds;
+    double stringNs = std::chrono::duration<double, std::nano>(stringEnd - binaryEnd).count() / kRounds;
+    printf("[Benchmark] dispatch: table text %.0f ns, table binary %.0f ns, String chain %.0f ns\n",
+           textNs, binaryNs, stringNs);
+    printf("[Benchmark] heap allocations per %d commands: table %u, String chain %u\n",
+           kRounds, tableAllocs, stringAllocs);
+
+    TEST_ASSERT_EQUAL_UINT32(0, tableAllocs);
+    TEST_ASSERT_EQUAL_UINT32((uint32_t)kRounds, stringAllocs);
+    TEST_ASSERT_EQUAL_UINT((unsigned)kRounds, matched);
+}
+
+int main(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+    UNITY_BEGIN();
+    RUN_TEST(test_text_commands_match_whole_names);
+    RUN_TEST(test_text_argument_is_terminated_copy);
+    RUN_TEST(test_binary_commands_index_table);
+    RUN_TEST(test_binary_commands_are_not_frames);
+    RUN_TEST(test_reply_overflow_drops_whole_reply);
+    RUN_TEST(test_alloc_counter_sees_new_and_delete);
+    RUN_TEST(test_dispatch_allocates_nothing);
+    RUN_TEST(test_steady_state_frame_path_allocates_nothing);
+    RUN_TEST(test_benchmark_dispatch);
+    return UNITY_END();
+}
@@ -0,0 +1,294 @@
+/**
+ * `test_main.cpp`
+ * - Unit tests and benchmark for FlowCredit (native host build)
+ * - The benchmark runs the device, the uplink (LinkEmulator) and a relay whose viewer drains
+ *   frames slower than the camera produces them: capture-to-display latency with and
+ *   without credits
+ * - Run: pio test -e native -f test_flow_credit
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#include <unity.h>
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <deque>
+#include <vector>
+
+#include "FlowCredit.h"
+#include "LinkEmulator.h"
+
+void setUp(void) {}
+void tearDown(void) {}
+
+static FlowCredit makeCredit(uint32_t maxCredits = 8, uint32_t stallTimeoutMs = 3000) {
+    FlowCreditConfig config;
+    config.maxCredits = maxCredits;
+    config.stallTimeoutMs = stallTimeoutMs;
+    return FlowCredit(config);
+}
+
+// ========================================
+// Parsing
+// ========================================
+
+void test_parse_grants(void) {
+    uint32_t credits = 0;
+    TEST_ASSERT_TRUE(FlowCredit::parse("1", credits));
+    TEST_ASSERT_EQUAL_UINT32(1, credits);
+    TEST_ASSERT_TRUE(FlowCredit::parse("65535", credits));
+    TEST_ASSERT_EQUAL_UINT32(65535, credits);
+
+    TEST_ASSERT_FALSE(FlowCredit::parse("", credits));
+    TEST_ASSERT_FALSE(FlowCredit::parse("0", credits));
+    TEST_ASSERT_FALSE(FlowCredit::parse("-1", credits));
+    TEST_ASSERT_FALSE(FlowCredit::parse("2x", credits));
+    TEST_ASSERT_FALSE(FlowCredit::parse("65536", credits));
+    TEST_ASSERT_FALSE(FlowCredit::parse("123456", credits));
+    TEST_ASSERT_FALSE(FlowCredit::parse(NULL, credits));
+
+    // WebSocket text payloads are not NUL-terminated at the message length
+    const char message[] = "CREDIT:12garbage";
+    TEST_ASSERT_TRUE(FlowCredit::isGrant(message, 9, credits));
+    TEST_ASSERT_EQUAL_UINT32(12, credits);
+    TEST_ASSERT_FALSE(FlowCredit::isGrant("CREDIT:", 7, credits));
+    TEST_ASSERT_FALSE(FlowCredit::isGrant("CREDITS:1", 9, credits));
+    TEST_ASSERT_FALSE(FlowCredit::isGrant("DEMAND:1:0", 10, credits));
+    TEST_ASSERT_FALSE(FlowCredit::isGrant("CREDIT:1234567", 14, credits));
+}
+
+// ========================================
+// Window
+// ========================================
+
+void test_unlimited_until_first_grant(void) {
+    FlowCredit credit = makeCredit();
+    for (uint32_t t = 0; t < 10; t++) {
+        TEST_ASSERT_TRUE(credit.canSend(t));
+        credit.onSent(t);
+    }
+    TEST_ASSERT_FALSE(credit.isLimited());
+    TEST_ASSERT_EQUAL_UINT32(0, credit.getStats().sent);
+
+    credit.grant(2, 100);
+    TEST_ASSERT_TRUE(credit.isLimited());
+    TEST_ASSERT_TRUE(credit.canSend(100));
+    credit.onSent(100);
+    TEST_ASSERT_TRUE(credit.canSend(110));
+    credit.onSent(110);
+    TEST_ASSERT_FALSE(credit.canSend(120));
+    TEST_ASSERT_FALSE(credit.canSend(150));
+
+    credit.grant(1, 170);
+    TEST_ASSERT_TRUE(credit.canSend(170));
+    credit.onSent(170);
+    TEST_ASSERT_EQUAL_UINT32(3, credit.getStats().sent);
+    TEST_ASSERT_EQUAL_UINT32(1, credit.getStats().waits);
+    TEST_ASSERT_EQUAL_UINT32(50, credit.getStats().maxWaitMs);
+}
+
+void test_grants_are_capped(void) {
+    FlowCredit credit = makeCredit(4);
+    credit.grant(3, 0);
+    credit.grant(3, 0);
+    TEST_ASSERT_EQUAL_UINT32(4, credit.getCredits());
+    TEST_ASSERT_EQUAL_UINT32(2, credit.getStats().clipped);
+    TEST_ASSERT_EQUAL_UINT32(6, credit.getStats().granted);
+}
+
+void test_reset_returns_to_unlimited(void) {
+    FlowCredit credit = makeCredit();
+    credit.grant(3, 0);
+    credit.onSent(0);
+    credit.reset(10);
+    TEST_ASSERT_FALSE(credit.isLimited());
+    TEST_ASSERT_TRUE(credit.canSend(20));
+
+    // The next relay's first grant is its whole window (leftovers are not added)
+    credit.grant(2, 30);
+    TEST_ASSERT_EQUAL_UINT32(2, credit.getCredits());
+}
+
+void test_stall_probe(void) {
+    FlowCredit credit = makeCredit(8, 3000);
+    credit.grant(1, 0);
+    credit.onSent(0);
+    TEST_ASSERT_FALSE(credit.canSend(100));
+    TEST_ASSERT_FALSE(credit.canSend(3099));
+    TEST_ASSERT_TRUE(credit.canSend(3100));
+    credit.onSent(3100);
+    TEST_ASSERT_EQUAL_UINT32(1, credit.getStats().probes);
+
+    // The next probe waits a full timeout again
+    TEST_ASSERT_FALSE(credit.canSend(3200));
+    TEST_ASSERT_FALSE(credit.canSend(6199));
+    TEST_ASSERT_TRUE(credit.canSend(6200));
+
+    FlowCredit patient = makeCredit(8, 0);
+    patient.grant(1, 0);
+    patient.onSent(0);
+    TEST_ASSERT_FALSE(patient.canSend(0));
+    TEST_ASSERT_FALSE(patient.canSend(600000));
+}
+
+// ========================================
+// Benchmark
+// ========================================
+
+/**
+ * Frame in the simulated path (device → uplink → relay → viewer)
+ */
+struct SimFrame {
+    uint64_t captureUs;
+    uint64_t readyUs;          // arrival at the next stage
+    uint32_t bytes;
+};
+
+struct SimResult {
+    uint32_t captured;
+    uint32_t displayed;
+    uint64_t uplinkBytes;
+    std::vector<double> latencyMs;
+};
+
+/**
+ * 60 s at 10 FPS: the device sends its pending frame when the socket and the credit window
+ * allow; the relay queues frames for the viewer like Java-WebSocket (unbounded) and returns a
+ * credit once the viewer has drained a frame
+ * @param window Credit window (0 = no flow control, the relay never grants)
+ */
+static SimResult simulate(uint32_t window, uint32_t uplinkKbps, uint32_t viewerKbps) {
+    const uint64_t durationUs = 60ULL * 1000 * 1000;
+    const uint64_t frameUs = 100 * 1000;
+    LinkConfig linkConfig;
+    linkConfig.bandwidthKbps = uplinkKbps;
+    linkConfig.delayMs = 40;
+    linkConfig.jitterMs = 10;
+    LinkEmulator link(linkConfig);
+    FlowCredit credit = makeCredit();
+
+    SimResult result = {};
+    bool pending = false;
+    SimFrame pendingFrame = {};
+    uint64_t socketFreeUs = 0;
+    bool draining = false;
+    uint64_t drainEndUs = 0;
+    std::deque<SimFrame> uplink;       // sent, not yet at the relay
+    std::deque<SimFrame> viewerQueue;  // at the relay, not yet drained by the viewer
+    std::deque<uint64_t> grants;       // credits on their way back
+    uint32_t seed = 7;
+
+    if (window > 0) {
+        grants.push_back(link.receive(0));
+    }
+    bool granted = false;
+    for (uint64_t now = 0; now < durationUs; now += 1000) {
+        uint32_t nowMs = (uint32_t)(now / 1000);
+        while (!grants.empty() && grants.front() <= now) {
+            credit.grant(granted ? 1 : window, nowMs);
+            granted = true;
+            grants.pop_front();
+        }
+        if (now % frameUs == 0) {
+            seed = seed * 1664525u + 1013904223u;
+            pendingFrame = SimFrame{now, 0, 18 * 1024 + (seed >> 20) % 4096};   // newest capture replaces the pending one
+            pending = true;
+            result.captured++;
+        }
+        if (pending && now >= socketFreeUs && credit.canSend(nowMs)) {
+            LinkSend send = link.send(pendingFrame.bytes, now);
+            socketFreeUs = send.unblockUs;
+            uplink.push_back(SimFrame{pendingFrame.captureUs, send.deliverUs, pendingFrame.bytes});
+            result.uplinkBytes += pendingFrame.bytes;
+            credit.onSent(nowMs);
+            pending = false;
+        }
+        while (!uplink.empty() && uplink.front().readyUs <= now) {
+            viewerQueue.push_back(uplink.front());
+            uplink.pop_front();
+        }
+        // Viewer drains the oldest queued frame at its own rate
+        if (!draining && !viewerQueue.empty()) {
+            drainEndUs = now + (uint64_t)viewerQueue.front().bytes * 8000 / viewerKbps;
+            draining = true;
+        }
+        if (draining && now >= drainEndUs) {
+            result.latencyMs.push_back((now - viewerQueue.front().captureUs) / 1000.0);
+            result.displayed++;
+            viewerQueue.pop_front();
+            draining = false;
+            if (window > 0) {
+                grants.push_back(link.receive(now));
+            }
+        }
+    }
+    return result;
+}
+
+static double percentileMs(std::vector<double> values, double p) {
+    if (values.empty()) {
+        return 0.0;
+    }
+    std::sort(values.begin(), values.end());
+    size_t index = (size_t)(p / 100.0 * (values.size() - 1) + 0.5);
+    return values[index];
+}
+
+void test_benchmark(void) {
+    struct Scenario {
+        const char* name;
+        uint32_t uplinkKbps;
+        uint32_t viewerKbps;
+    };
+    static const Scenario scenarios[] = {
+        {"slow viewer", 4000, 800},
+        {"slow uplink", 800, 8000},
+        {"both fast", 8000, 8000},
+    };
+    static const uint32_t windows[] = {0, 1, 2, 3};
+
+    printf("\n  60 s at 10 FPS, ~20 KB frames, 40 ms one-way delay\n");
+    printf("  %-12s %-8s %6s %9s %9s %9s %10s\n", "path", "credits", "fps", "p50 ms", "p99 ms", "max ms", "uplink MB");
+    for (const Scenario& scenario : scenarios) {
+        for (uint32_t window : windows) {
+            SimResult result = simulate(window, scenario.uplinkKbps, scenario.viewerKbps);
+            double p50 = percentileMs(result.latencyMs, 50);
+            double p99 = percentileMs(result.latencyMs, 99);
+            double maxMs = percentileMs(result.latencyMs, 100);
+            char label[8];
+            snprintf(label, sizeof(label), window == 0 ? "off" : "%u", window);
+            printf("  %-12s %-8s %6.2f %9.0f %9.0f %9.0f %10.1f\n", scenario.name, label, result.displayed / 60.0,
+                   p50, p99, maxMs, result.uplinkBytes / 1048576.0);
+
+            if (scenario.viewerKbps < scenario.uplinkKbps && window == 0) {
+                TEST_ASSERT_GREATER_THAN(10000, (int)p99);   // the viewer falls further behind every second
+            }
+            if (window == 2) {
+                TEST_ASSERT_LESS_THAN(1000, (int)p99);
+            }
+        }
+    }
+
+    // Credits keep the viewer's rate: two in flight hide the credit round trip
+    SimResult off = simulate(0, 4000, 800);
+    SimResult two = simulate(2, 4000, 800);
+    TEST_ASSERT_GREATER_OR_EQUAL((int)(off.displayed * 9 / 10), (int)two.displayed);
+}
+
+int main(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+    UNITY_BEGIN();
+    RUN_TEST(test_parse_grants);
+    RUN_TEST(test_unlimited_until_first_grant);
+    RUN_TEST(test_grants_are_capped);
+    RUN_TEST(test_reset_returns_to_unlimited);
+    RUN_TEST(test_stall_probe);
+    RUN_TEST(test_benchmark);
+    return UNITY_END();
+}
@@ -0,0 +1,441 @@
+/**
+ * `test_main.cpp`
+ * - Unit tests for FrameChunker, FrameAssembler and ControlQueue (native host build)
+ * - Command round trip on an emulated link: chunked vs. whole-frame sends
+ * - Run: pio test -e native -f test_frame_chunker
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#include <unity.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "ControlQueue.h"
+#include "FrameChunker.h"
+#include <FrameEnvelope.h>
+#include <LinkEmulator.h>
+
+static const size_t kHeadroom = 14;    // WEBSOCKETS_MAX_HEADER_SIZE
+
+void setUp(void) {}
+void tearDown(void) {}
+
+/**
+ * [header room][envelope][payload] as main.cpp lays out its send buffer
+ */
+struct SendBuffer {
+    std::vector<uint8_t> bytes;
+    uint8_t* message;
+    uint8_t* payload;
+
+    SendBuffer(size_t payloadLength, uint32_t sequence, bool chunked)
+        : bytes(kHeadroom + FrameEnvelope::kHeaderSize + payloadLength) {
+        message = bytes.data() + kHeadroom;
+        payload = message + FrameEnvelope::kHeaderSize;
+        for (size_t i = 0; i < payloadLength; i++) {
+            payload[i] = (uint8_t)(i * 7 + i / 251);
+        }
+        FrameHeader header = {};
+        header.sequence = sequence;
+        header.captureUs = 123456;
+        header.payloadLength = (uint32_t)payloadLength;
+        header.flags = kEnvelopeClockSynced | (chunked ? kEnvelopeChunked : 0);
+        FrameEnvelope::encode(header, message, FrameEnvelope::kHeaderSize);
+    }
+};
+
+/**
+ * Send every part like the firmware: the transport writes its header in front of the part
+ * and masks the payload in place, the receiver gets a copy of the part
+ */
+static std::vector<std::vector<uint8_t>> sendParts(FrameChunker& chunker, SendBuffer& buffer, uint32_t sequence) {
+    std::vector<std::vector<uint8_t>> wire;
+    size_t payloadLength = buffer.bytes.size() - kHeadroom - FrameEnvelope::kHeaderSize;
+    chunker.begin(buffer.message, FrameEnvelope::kHeaderSize, payloadLength, sequence);
+    FrameChunk chunk;
+    while (chunker.next(chunk)) {
+        TEST_ASSERT_TRUE(chunk.message - kHeadroom >= buffer.bytes.data());
+        wire.push_back(std::vector<uint8_t>(chunk.message, chunk.message + chunk.length));
+        memset(chunk.message - kHeadroom, 0xEE, kHeadroom);          // WebSocket header
+        for (size_t i = 0; i < chunk.length; i++) {
+            chunk.message[i] ^= 0x5A;                                  // client masking
+        }
+    }
+    return wire;
+}
+
+// ========================================
+// FrameChunker
+// ========================================
+void test_small_frame_is_one_message() {
+    FrameChunker chunker(4096, kHeadroom);
+    TEST_ASSERT_FALSE(chunker.isChunked(4096));
+    TEST_ASSERT_TRUE(chunker.isChunked(4097));
+    TEST_ASSERT_EQUAL_UINT32(1, chunker.partCount(1000));
+
+    SendBuffer buffer(1000, 5, false);
+    chunker.begin(buffer.message, FrameEnvelope::kHeaderSize, 1000, 5);
+    FrameChunk chunk;
+    TEST_ASSERT_TRUE(chunker.next(chunk));
+    TEST_ASSERT_TRUE(chunk.message == buffer.message);
+    TEST_ASSERT_EQUAL_UINT32(FrameEnvelope::kHeaderSize + 1000, chunk.length);
+    TEST_ASSERT_TRUE(chunk.last);
+    TEST_ASSERT_FALSE(chunker.next(chunk));
+
+    // Disabled: never chunked
+    FrameChunker disabled(0, kHeadroom);
+    TEST_ASSERT_FALSE(disabled.isChunked(1 << 20));
+}
+
+void test_parts_cover_payload_in_place() {
+    FrameChunker chunker(4096, kHeadroom);
+    const size_t payloadLength = 4096 * 5 + 123;
+    SendBuffer buffer(payloadLength, 77, true);
+    TEST_ASSERT_EQUAL_UINT32(6, chunker.partCount(payloadLength));
+
+    chunker.begin(buffer.message, FrameEnvelope::kHeaderSize, payloadLength, 77);
+    FrameChunk chunk;
+    size_t covered = 0;
+    uint16_t index = 0;
+    while (chunker.next(chunk)) {
+        TEST_ASSERT_EQUAL_UINT16(index, chunk.index);
+        TEST_ASSERT_EQUAL_UINT32(covered, chunk.offset);
+        if (index == 0) {
+            TEST_ASSERT_TRUE(chunk.message == buffer.message);
+            covered += chunk.length - FrameEnvelope::kHeaderSize;
+        } else {
+            // Part header sits right in front of the chunk bytes, no copy
+            FramePart part;
+            TEST_ASSERT_TRUE(FrameChunker::decodePart(chunk.message, chunk.length, part));
+            TEST_ASSERT_TRUE(part.data == buffer.payload + chunk.offset);
+            TEST_ASSERT_EQUAL_UINT32(77, part.sequence);
+            TEST_ASSERT_EQUAL_UINT32(chunk.offset, part.offset);
+            covered += part.length;
+        }
+        TEST_ASSERT_EQUAL(covered == payloadLength, chunk.last);
+        index++;
+    }
+    TEST_ASSERT_EQUAL_UINT32(payloadLength, covered);
+    TEST_ASSERT_EQUAL_UINT16(6, index);
+    TEST_ASSERT_TRUE(chunker.isDone());
+}
+
+void test_chunk_size_raised_to_fit_part_header() {
+    FrameChunker chunker(4, kHeadroom);
+    TEST_ASSERT_EQUAL_UINT32(FrameChunker::kPartHeaderSize + kHeadroom, chunker.chunkSize());
+
+    // Tiny parts still reassemble (headers overwrite only bytes already sent)
+    const size_t payloadLength = 300;
+    SendBuffer original(payloadLength, 9, true);
+    SendBuffer buffer(payloadLength, 9, true);
+    std::vector<std::vector<uint8_t>> wire = sendParts(chunker, buffer, 9);
+    TEST_ASSERT_EQUAL_UINT32(chunker.partCount(payloadLength), wire.size());
+
+    std::vector<uint8_t> storage(1024);
+    FrameAssembler assembler(storage.data(), storage.size());
+    AssembleResult result = AssembleResult::Dropped;
+    for (size_t i = 0; i < wire.size(); i++) {
+        result = assembler.accept(wire[i].data(), wire[i].size());
+    }
+    TEST_ASSERT_EQUAL(AssembleResult::Complete, result);
+    TEST_ASSERT_EQUAL_MEMORY(original.payload, assembler.frame() + FrameEnvelope::kHeaderSize, payloadLength);
+}
+
+// ========================================
+// FrameAssembler
+// ========================================
+void test_assembler_rebuilds_envelope_and_payload() {
+    const size_t payloadLength = 50000;
+    SendBuffer original(payloadLength, 1234, true);
+    SendBuffer buffer(payloadLength, 1234, true);
+    FrameChunker chunker(4096, kHeadroom);
+    std::vector<std::vector<uint8_t>> wire = sendParts(chunker, buffer, 1234);
+
+    std::vector<uint8_t> storage(64 * 1024);
+    FrameAssembler assembler(storage.data(), storage.size());
+    for (size_t i = 0; i + 1 < wire.size(); i++) {
+        TEST_ASSERT_EQUAL(AssembleResult::Pending, assembler.accept(wire[i].data(), wire[i].size()));
+    }
+    TEST_ASSERT_EQUAL(AssembleResult::Complete, assembler.accept(wire.back().data(), wire.back().size()));
+
+    // Decodes like an unchunked frame
+    FrameHeader header;
+    TEST_ASSERT_TRUE(FrameEnvelope::decode(assembler.frame(), assembler.frameLength(), header));
+    TEST_ASSERT_EQUAL_UINT32(1234, header.sequence);
+    TEST_ASSERT_EQUAL_UINT8(kEnvelopeClockSynced, header.flags);
+    TEST_ASSERT_EQUAL_UINT32(payloadLength, header.payloadLength);
+    TEST_ASSERT_EQUAL_MEMORY(original.payload, assembler.frame() + header.headerLength, payloadLength);
+
+    FrameAssemblerStats stats = assembler.getStats();
+    TEST_ASSERT_EQUAL_UINT32(1, stats.frames);
+    TEST_ASSERT_EQUAL_UINT32(wire.size(), stats.parts);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.dropped);
+}
+
+void test_assembler_passes_unchunked_messages_through() {
+    std::vector<uint8_t> storage(1024);
+    FrameAssembler assembler(storage.data(), storage.size());
+
+    SendBuffer whole(500, 3, false);
+    TEST_ASSERT_EQUAL(AssembleResult::Passthrough,
+                      assembler.accept(whole.message, FrameEnvelope::kHeaderSize + 500));
+    const uint8_t rawJpeg[] = {0xFF, 0xD8, 0xFF, 0xE0, 0x00, 0x10};
+    TEST_ASSERT_EQUAL(AssembleResult::Passthrough, assembler.accept(rawJpeg, sizeof(rawJpeg)));
+    const uint8_t command[] = {0xC7, 0x03, 0x00, 0x00};
+    TEST_ASSERT_EQUAL(AssembleResult::Passthrough, assembler.accept(command, sizeof(command)));
+}
+
+void test_assembler_drops_gaps_and_recovers_on_next_frame() {
+    std::vector<uint8_t> storage(64 * 1024);
+    FrameAssembler assembler(storage.data(), storage.size());
+    FrameChunker chunker(4096, kHeadroom);
+
+    // Part 2 of frame 10 lost: the rest of frame 10 is dropped
+    SendBuffer first(20000, 10, true);
+    std::vector<std::vector<uint8_t>> wire = sendParts(chunker, first, 10);
+    TEST_ASSERT_EQUAL(AssembleResult::Pending, assembler.accept(wire[0].data(), wire[0].size()));
+    TEST_ASSERT_EQUAL(AssembleResult::Pending, assembler.accept(wire[1].data(), wire[1].size()));
+    uint32_t orphans = (uint32_t)wire.size() - 3;
+    for (size_t i = 3; i < wire.size(); i++) {
+        TEST_ASSERT_EQUAL(AssembleResult::Dropped, assembler.accept(wire[i].data(), wire[i].size()));
+    }
+
+    // Frame 11 starts fresh
+    SendBuffer second(9000, 11, true);
+    wire = sendParts(chunker, second, 11);
+    AssembleResult result = AssembleResult::Dropped;
+    for (size_t i = 0; i < wire.size(); i++) {
+        result = assembler.accept(wire[i].data(), wire[i].size());
+    }
+    TEST_ASSERT_EQUAL(AssembleResult::Complete, result);
+
+    // A new first part abandons an unfinished frame; parts of the old one are orphans
+    SendBuffer third(9000, 12, true);
+    SendBuffer fourth(9000, 13, true);
+    std::vector<std::vector<uint8_t>> wireThird = sendParts(chunker, third, 12);
+    std::vector<std::vector<uint8_t>> wireFourth = sendParts(chunker, fourth, 13);
+    TEST_ASSERT_EQUAL(AssembleResult::Pending, assembler.accept(wireThird[0].data(), wireThird[0].size()));
+    TEST_ASSERT_EQUAL(AssembleResult::Pending, assembler.accept(wireFourth[0].data(), wireFourth[0].size()));
+    TEST_ASSERT_EQUAL(AssembleResult::Dropped, assembler.accept(wireThird[1].data(), wireThird[1].size()));
+
+    FrameAssemblerStats stats = assembler.getStats();
+    TEST_ASSERT_EQUAL_UINT32(1, stats.frames);
+    TEST_ASSERT_EQUAL_UINT32(orphans + 1, stats.dropped);
+    TEST_ASSERT_EQUAL_UINT32(3, stats.aborted);
+
+    // Larger than the buffer
+    SendBuffer huge(100000, 14, true);
+    TEST_ASSERT_EQUAL(AssembleResult::Dropped, assembler.accept(huge.message, FrameEnvelope::kHeaderSize + 4096));
+}
+
+// ========================================
+// ControlQueue
+// ========================================
+static std::string popFront(ControlQueue& queue) {
+    const char* text = NULL;
+    size_t length = 0;
+    if (!queue.front(text, length)) {
+        return std::string();
+    }
+    std::string result(text, length);
+    queue.pop();
+    return result;
+}
+
+void test_control_queue_orders_by_priority_then_fifo() {
+    char storage[4 * 32];
+    ControlQueue queue(storage, 4, 32);
+    TEST_ASSERT_TRUE(queue.push("EXPORT_DONE:1", 13, ControlPriority::Normal));
+    TEST_ASSERT_TRUE(queue.push("LED_STATUS:ON", 13, ControlPriority::High));
+    TEST_ASSERT_TRUE(queue.push("EXPORT_DONE:2", 13, ControlPriority::Normal));
+    TEST_ASSERT_TRUE(queue.push("LED_STATUS:OFF", 14, ControlPriority::High));
+    TEST_ASSERT_EQUAL_UINT32(4, queue.size());
+
+    TEST_ASSERT_EQUAL_STRING("LED_STATUS:ON", popFront(queue).c_str());
+    TEST_ASSERT_EQUAL_STRING("LED_STATUS:OFF", popFront(queue).c_str());
+    TEST_ASSERT_EQUAL_STRING("EXPORT_DONE:1", popFront(queue).c_str());
+    TEST_ASSERT_EQUAL_STRING("EXPORT_DONE:2", popFront(queue).c_str());
+    TEST_ASSERT_TRUE(queue.isEmpty());
+    TEST_ASSERT_EQUAL_UINT32(4, queue.getStats().sent);
+    TEST_ASSERT_EQUAL_UINT32(4, queue.getStats().maxDepth);
+}
+
+void test_control_queue_full_evicts_lower_priority_only() {
+    char storage[2 * 32];
+    ControlQueue queue(storage, 2, 32);
+    TEST_ASSERT_TRUE(queue.push("N1", 2, ControlPriority::Normal));
+    TEST_ASSERT_TRUE(queue.push("N2", 2, ControlPriority::Normal));
+
+    // A reply replaces the oldest notice; another notice is refused
+    TEST_ASSERT_TRUE(queue.push("H1", 2, ControlPriority::High));
+    TEST_ASSERT_FALSE(queue.push("N3", 2, ControlPriority::Normal));
+    TEST_ASSERT_TRUE(queue.push("H2", 2, ControlPriority::High));
+    TEST_ASSERT_FALSE(queue.push("H3", 2, ControlPriority::High));
+
+    // Too long for a slot, or empty
+    char longText[40];
+    memset(longText, 'x', sizeof(longText));
+    TEST_ASSERT_FALSE(queue.push(longText, sizeof(longText), ControlPriority::High));
+    TEST_ASSERT_FALSE(queue.push("", 0, ControlPriority::High));
+
+    TEST_ASSERT_EQUAL_STRING("H1", popFront(queue).c_str());
+    TEST_ASSERT_EQUAL_STRING("H2", popFront(queue).c_str());
+    TEST_ASSERT_TRUE(queue.isEmpty());
+
+    ControlQueueStats stats = queue.getStats();
+    TEST_ASSERT_EQUAL_UINT32(2, stats.evicted);
+    TEST_ASSERT_EQUAL_UINT32(4, stats.refused);
+
+    queue.push("N4", 2, ControlPriority::Normal);
+    queue.clear();
+    TEST_ASSERT_TRUE(queue.isEmpty());
+}
+
+// ========================================
+// Command Round Trip (emulated link)
+// ========================================
+struct RttResult {
+    uint32_t commands;
+    uint32_t p50Us;
+    uint32_t maxUs;
+    uint32_t frames;
+};
+
+/**
+ * Stream frames of one size and answer LED commands on an emulated link
+ * - Device: frames every 100 ms (back to back when a frame takes longer); the WebSocket is
+ *   serviced between frames and, when chunking, between parts (like sendChunked())
+ * - Server: sends a command every 37 ms; RTT = reply delivered - command sent
+ * - Replies share the uplink with the frames (TCP head-of-line: they queue behind bytes
+ *   already in the socket buffer)
+ */
+static RttResult simulateCommandRtt(size_t frameBytes, size_t chunkSize) {
+    LinkConfig config;
+    config.bandwidthKbps = 2000;
+    config.delayMs = 20;
+    LinkEmulator link(config);
+    FrameChunker chunker(chunkSize, kHeadroom);
+    char storage[4 * 64];
+    ControlQueue queue(storage, 4, 64);
+
+    const uint64_t kFrameIntervalUs = 100000;
+    const uint64_t kCommandIntervalUs = 37000;
+    const uint64_t kDurationUs = 10000000;
+    std::vector<uint64_t> issuedUs;
+    std::vector<uint64_t> arrivalUs;
+    for (uint64_t t = 13000; t < kDurationUs; t += kCommandIntervalUs) {
+        issuedUs.push_back(t);
+        arrivalUs.push_back(link.receive(t));
+    }
+    std::vector<uint32_t> rtts;
+    size_t nextCommand = 0;
+    std::vector<size_t> pending;            // command index per queued reply (FIFO, one priority)
+    uint64_t nowUs = 0;
+
+    // webSocket.loop() + drainControlQueue() at `nowUs` (a refused reply is sent right away)
+    auto service = [&]() {
+        while (nextCommand < arrivalUs.size() && arrivalUs[nextCommand] <= nowUs) {
+            if (queue.push("LED_STATUS:ON", 13, ControlPriority::High)) {
+                pending.push_back(nextCommand++);
+                continue;
+            }
+            LinkSend reply = link.send(13 + 6, nowUs);
+            nowUs = reply.unblockUs;
+            rtts.push_back((uint32_t)(reply.deliverUs - issuedUs[nextCommand++]));
+        }
+        const char* text = NULL;
+        size_t length = 0;
+        size_t sent = 0;
+        while (queue.front(text, length)) {
+            LinkSend reply = link.send(length + 6, nowUs);
+            nowUs = reply.unblockUs;
+            rtts.push_back((uint32_t)(reply.deliverUs - issuedUs[pending[sent++]]));
+            queue.pop();
+        }
+        pending.erase(pending.begin(), pending.begin() + sent);
+    };
+
+    std::vector<uint8_t> bytes(kHeadroom + FrameEnvelope::kHeaderSize + frameBytes);
+    uint32_t frames = 0;
+    while (nowUs < kDurationUs) {
+        uint64_t frameStartUs = std::max(nowUs, (uint64_t)frames * kFrameIntervalUs);
+        // Idle until the next frame: commands are handled as they arrive
+        while (nextCommand < arrivalUs.size() && arrivalUs[nextCommand] <= frameStartUs) {
+            nowUs = std::max(nowUs, arrivalUs[nextCommand]);
+            service();
+        }
+        nowUs = std::max(nowUs, frameStartUs);
+
+        chunker.begin(bytes.data() + kHeadroom, FrameEnvelope::kHeaderSize, frameBytes, frames);
+        FrameChunk chunk;
+        while (chunker.next(chunk)) {
+            nowUs = link.send(chunk.length + kHeadroom, nowUs).unblockUs;
+            if (!chunk.last) {
+                service();
+            }
+        }
+        service();
+        frames++;
+    }
+
+    RttResult result = {};
+    result.commands = (uint32_t)rtts.size();
+    result.frames = frames;
+    std::sort(rtts.begin(), rtts.end());
+    if (!rtts.empty()) {
+        result.p50Us = rtts[rtts.size() / 2];
+        result.maxUs = rtts.back();
+    }
+    return result;
+}
+
+void test_command_rtt_bounded_regardless_of_frame_size() {
+    const size_t kSizes[] = { 8 * 1024, 16 * 1024, 32 * 1024, 60 * 1024 };
+    RttResult chunked[4];
+    RttResult whole[4];
+    for (size_t i = 0; i < 4; i++) {
+        chunked[i] = simulateCommandRtt(kSizes[i], 4096);
+        whole[i] = simulateCommandRtt(kSizes[i], 0);
+        printf("[Benchmark] %2u KB frames @ 2 Mbps: command RTT chunked p50 %5.1f max %5.1f ms, "
+               "whole-frame p50 %5.1f max %5.1f ms (%u commands)\n",
+               (unsigned)(kSizes[i] / 1024), chunked[i].p50Us / 1000.0, chunked[i].maxUs / 1000.0,
+               whole[i].p50Us / 1000.0, whole[i].maxUs / 1000.0, chunked[i].commands);
+        TEST_ASSERT_TRUE(chunked[i].commands > 200);
+        TEST_ASSERT_EQUAL_UINT32(chunked[i].commands, whole[i].commands);
+    }
+
+    // Chunked: one part (4 KB ≈ 16 ms) + socket buffer + 2 × 20 ms, whatever the frame size
+    for (size_t i = 0; i < 4; i++) {
+        TEST_ASSERT_TRUE(chunked[i].maxUs < 100000);
+    }
+    TEST_ASSERT_TRUE(chunked[3].maxUs < chunked[0].maxUs * 3 / 2);
+
+    // Whole-frame sends: the wait grows with the frame (60 KB ≈ 245 ms on the wire)
+    TEST_ASSERT_TRUE(whole[3].maxUs > 200000);
+    TEST_ASSERT_TRUE(whole[3].maxUs > chunked[3].maxUs * 2);
+}
+
+int main(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+    UNITY_BEGIN();
+    RUN_TEST(test_small_frame_is_one_message);
+    RUN_TEST(test_parts_cover_payload_in_place);
+    RUN_TEST(test_chunk_size_raised_to_fit_part_header);
+    RUN_TEST(test_assembler_rebuilds_envelope_and_payload);
+    RUN_TEST(test_assembler_passes_unchunked_messages_through);
+    RUN_TEST(test_assembler_drops_gaps_and_recovers_on_next_frame);
+    RUN_TEST(test_control_queue_orders_by_priority_then_fifo);
+    RUN_TEST(test_control_queue_full_evicts_lower_priority_only);
+    RUN_TEST(test_command_rtt_bounded_regardless_of_frame_size);
+    return UNITY_END();
+}
@@ -0,0 +1,322 @@
+/**
+ * `test_main.cpp`
+ * - Unit tests for FrameEnvelope and ClockSync (native host build)
+ * - A stand-in server (same role as tools/standin_server.py) answers pings over a
+ *   simulated link with asymmetric jitter and decodes envelopes to measure latency
+ * - Run: pio test -e native -f test_frame_envelope
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#include <unity.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "ClockSync.h"
+#include "FrameEnvelope.h"
+
+void setUp(void) {}
+void tearDown(void) {}
+
+static FrameHeader makeHeader() {
+    FrameHeader header;
+    memset(&header, 0, sizeof(header));
+    header.flags = kEnvelopeClockSynced | kEnvelopeMotion;
+    header.jpegQuality = 12;
+    header.frameSize = 8;
+    header.sequence = 0x01020304;
+    header.captureUs = 0x0000123456789ABCULL;
+    header.sendUs = 0x0000123456799ABCULL;
+    header.clockOffsetUs = -1700000000000000LL;
+    header.payloadLength = 4;
+    header.width = 640;
+    header.height = 480;
+    header.motionScore = 321;
+    header.headerId = 0x0203;
+    return header;
+}
+
+// ========================================
+// FrameEnvelope
+// ========================================
+void test_envelope_round_trip() {
+    FrameHeader header = makeHeader();
+    uint8_t message[FrameEnvelope::kHeaderSize + 4];
+    TEST_ASSERT_EQUAL(FrameEnvelope::kHeaderSize, FrameEnvelope::encode(header, message, sizeof(message)));
+    memcpy(message + FrameEnvelope::kHeaderSize, "\xFF\xD8\xFF\xD9", 4);
+
+    // Network byte order at fixed offsets (server/client parsers rely on these)
+    TEST_ASSERT_EQUAL_MEMORY("CAM", message, 3);
+    TEST_ASSERT_EQUAL_UINT8(1, message[3]);
+    TEST_ASSERT_EQUAL_UINT8(48, message[4]);
+    TEST_ASSERT_EQUAL_UINT8(0x01, message[8]);
+    TEST_ASSERT_EQUAL_UINT8(0x04, message[11]);
+    TEST_ASSERT_EQUAL_UINT8(0x02, message[40]);
+    TEST_ASSERT_EQUAL_UINT8(0x80, message[41]);
+    TEST_ASSERT_EQUAL_UINT8(0x02, message[46]);
+    TEST_ASSERT_EQUAL_UINT8(0x03, message[47]);
+
+    FrameHeader decoded;
+    TEST_ASSERT_TRUE(FrameEnvelope::decode(message, sizeof(message), decoded));
+    TEST_ASSERT_EQUAL_UINT8(1, decoded.version);
+    TEST_ASSERT_EQUAL_UINT8(48, decoded.headerLength);
+    TEST_ASSERT_EQUAL_UINT8(header.flags, decoded.flags);
+    TEST_ASSERT_EQUAL_UINT8(12, decoded.jpegQuality);
+    TEST_ASSERT_EQUAL_UINT8(8, decoded.frameSize);
+    TEST_ASSERT_EQUAL_UINT32(header.sequence, decoded.sequence);
+    TEST_ASSERT_TRUE(header.captureUs == decoded.captureUs);
+    TEST_ASSERT_TRUE(header.sendUs == decoded.sendUs);
+    TEST_ASSERT_TRUE(header.clockOffsetUs == decoded.clockOffsetUs);
+    TEST_ASSERT_EQUAL_UINT32(4, decoded.payloadLength);
+    TEST_ASSERT_EQUAL_UINT16(640, decoded.width);
+    TEST_ASSERT_EQUAL_UINT16(480, decoded.height);
+    TEST_ASSERT_EQUAL_UINT16(321, decoded.motionScore);
+    TEST_ASSERT_EQUAL_UINT16(0x0203, decoded.headerId);
+}
+
+void test_envelope_rejects_raw_jpeg_and_truncation() {
+    FrameHeader header = makeHeader();
+    uint8_t message[FrameEnvelope::kHeaderSize + 4];
+    FrameEnvelope::encode(header, message, sizeof(message));
+    FrameHeader decoded;
+
+    const uint8_t jpeg[] = {0xFF, 0xD8, 0xFF, 0xE0, 0x00, 0x10};
+    TEST_ASSERT_FALSE(FrameEnvelope::isEnvelope(jpeg, sizeof(jpeg)));
+    TEST_ASSERT_FALSE(FrameEnvelope::decode(jpeg, sizeof(jpeg), decoded));
+
+    // Header only / payload cut short
+    TEST_ASSERT_FALSE(FrameEnvelope::decode(message, FrameEnvelope::kHeaderSize - 1, decoded));
+    TEST_ASSERT_FALSE(FrameEnvelope::decode(message, sizeof(message) - 1, decoded));
+
+    // Header-only decode accepts a partial payload (first part of a chunked frame)
+    TEST_ASSERT_TRUE(FrameEnvelope::decodeHeader(message, sizeof(message) - 1, decoded));
+    TEST_ASSERT_EQUAL_UINT32(header.payloadLength, decoded.payloadLength);
+    TEST_ASSERT_FALSE(FrameEnvelope::decodeHeader(message, FrameEnvelope::kHeaderSize - 1, decoded));
+
+    // Header length below version 1 size
+    message[4] = 40;
+    TEST_ASSERT_FALSE(FrameEnvelope::decode(message, sizeof(message), decoded));
+
+    // Encoder refuses a short buffer
+    TEST_ASSERT_EQUAL(0, FrameEnvelope::encode(header, message, FrameEnvelope::kHeaderSize - 1));
+}
+
+void test_envelope_skips_fields_from_later_versions() {
+    FrameHeader header = makeHeader();
+    uint8_t message[FrameEnvelope::kHeaderSize + 16 + 4];
+    memset(message, 0xAA, sizeof(message));
+    FrameEnvelope::encode(header, message, sizeof(message));
+    message[3] = 2;
+    message[4] = FrameEnvelope::kHeaderSize + 16;
+
+    FrameHeader decoded;
+    TEST_ASSERT_TRUE(FrameEnvelope::decode(message, sizeof(message), decoded));
+    TEST_ASSERT_EQUAL_UINT8(2, decoded.version);
+    TEST_ASSERT_EQUAL_UINT8(64, decoded.headerLength);
+    TEST_ASSERT_EQUAL_UINT32(header.sequence, decoded.sequence);
+}
+
+// ========================================
+// ClockSync
+// ========================================
+void test_clock_sync_message_format() {
+    ClockSyncConfig config;
+    ClockSync sync(config);
+    char ping[ClockSync::kMaxMessage];
+    size_t length = sync.makePing(5000, ping, sizeof(ping));
+    TEST_ASSERT_EQUAL_STRING("PING:1:5000", ping);
+
+    char pong[ClockSync::kMaxMessage];
+    size_t pongLength = ClockSync::makePong(ping, length, 1700000000000000ULL, 1700000000000100ULL,
+                                            pong, sizeof(pong));
+    TEST_ASSERT_EQUAL_STRING("PONG:1:5000:1700000000000000:1700000000000100", pong);
+    TEST_ASSERT_TRUE(ClockSync::isPong(pong, pongLength));
+    TEST_ASSERT_FALSE(ClockSync::isPong(ping, length));
+
+    TEST_ASSERT_EQUAL(0, ClockSync::makePong("PING:x:1", 8, 1, 2, pong, sizeof(pong)));
+    TEST_ASSERT_EQUAL(0, ClockSync::makePong(ping, length, 1, 2, pong, 8));
+}
+
+void test_clock_sync_rejects_bad_pongs() {
+    ClockSyncConfig config;
+    config.maxRttUs = 100000;
+    ClockSync sync(config);
+    char ping[ClockSync::kMaxMessage];
+    sync.makePing(1000000, ping, sizeof(ping));
+
+    const char* unknown = "PONG:7:1000000:50:60";
+    const char* reversed = "PONG:1:1000000:60:50";
+    const char* holdTooLong = "PONG:1:1000000:0:500000";
+    const char* malformed = "PONG:1:abc";
+    TEST_ASSERT_FALSE(sync.handlePong(unknown, strlen(unknown), 1010000));
+    TEST_ASSERT_FALSE(sync.handlePong(reversed, strlen(reversed), 1010000));
+    TEST_ASSERT_FALSE(sync.handlePong(holdTooLong, strlen(holdTooLong), 1010000));
+    TEST_ASSERT_FALSE(sync.handlePong(malformed, strlen(malformed), 1010000));
+
+    // RTT of 200 ms exceeds maxRttUs
+    const char* slow = "PONG:1:1000000:5000:5100";
+    TEST_ASSERT_FALSE(sync.handlePong(slow, strlen(slow), 1200000));
+
+    ClockSyncStats stats = sync.getStats();
+    TEST_ASSERT_FALSE(stats.synced);
+    TEST_ASSERT_EQUAL_UINT32(5, stats.rejected);
+    TEST_ASSERT_EQUAL_UINT32(1000000, sync.toServerUs(1000000));
+}
+
+void test_clock_sync_ping_schedule() {
+    ClockSyncConfig config;
+    config.fastIntervalMs = 1000;
+    config.intervalMs = 10000;
+    config.fastSamples = 2;
+    ClockSync sync(config);
+    char message[ClockSync::kMaxMessage];
+
+    TEST_ASSERT_TRUE(sync.pingDue(0));
+    for (uint32_t i = 0; i < 2; i++) {
+        uint64_t t0 = (uint64_t)i * 1000000;
+        TEST_ASSERT_TRUE(sync.pingDue(t0));
+        size_t length = sync.makePing(t0, message, sizeof(message));
+        TEST_ASSERT_FALSE(sync.pingDue(t0 + 500000));
+        char pong[ClockSync::kMaxMessage];
+        size_t pongLength = ClockSync::makePong(message, length, t0 + 1000, t0 + 1000, pong, sizeof(pong));
+        TEST_ASSERT_TRUE(sync.handlePong(pong, pongLength, t0 + 2000));
+    }
+    // Window filled: slow interval
+    TEST_ASSERT_FALSE(sync.pingDue(2000000));
+    TEST_ASSERT_FALSE(sync.pingDue(1000000 + 9000000));
+    TEST_ASSERT_TRUE(sync.pingDue(1000000 + 10000000));
+
+    sync.reset();
+    TEST_ASSERT_FALSE(sync.isSynced());
+    TEST_ASSERT_TRUE(sync.pingDue(1000000 + 1));
+}
+
+// ========================================
+// Stand-in Server over a Simulated Link
+// ========================================
+
+/**
+ * Deterministic link: base one-way delay plus uplink/downlink jitter
+ * (uplink is the congested direction: video competes with the pings)
+ */
+struct SimLink {
+    uint32_t state;
+    uint32_t baseUs;
+    uint32_t upJitterUs;
+    uint32_t downJitterUs;
+
+    uint32_t next() {
+        state = state * 1664525u + 1013904223u;
+        return state >> 8;
+    }
+    uint64_t up() { return baseUs + next() % (upJitterUs + 1); }
+    uint64_t down() { return baseUs + next() % (downJitterUs + 1); }
+};
+
+struct StandInServer {
+    int64_t epochUs;   // server clock = device clock + epochUs
+    uint32_t frames;
+    uint32_t gaps;
+    uint32_t lastSequence;
+    int64_t maxErrorUs;        // worst latency estimate error once settled
+    uint64_t settledAfterUs;
+
+    uint64_t now(uint64_t deviceUs) const { return (uint64_t)((int64_t)deviceUs + epochUs); }
+
+    /**
+     * Receive an enveloped frame and compare estimated capture→server latency with the truth
+     */
+    void receive(const uint8_t* message, size_t length, uint64_t receiveDeviceUs) {
+        FrameHeader header;
+        TEST_ASSERT_TRUE(FrameEnvelope::decode(message, length, header));
+        if (frames > 0 && header.sequence != lastSequence + 1) {
+            gaps++;
+        }
+        lastSequence = header.sequence;
+        frames++;
+        if (!(header.flags & kEnvelopeClockSynced)) {
+            return;
+        }
+        int64_t estimated = (int64_t)now(receiveDeviceUs) - ((int64_t)header.captureUs + header.clockOffsetUs);
+        int64_t actual = (int64_t)(receiveDeviceUs - header.captureUs);
+        int64_t error = llabs(estimated - actual);
+        if (header.captureUs >= settledAfterUs && error > maxErrorUs) {
+            maxErrorUs = error;
+        }
+    }
+};
+
+void test_clock_sync_latency_accuracy_on_jittery_link() {
+    ClockSyncConfig config;
+    ClockSync sync(config);
+    SimLink link = {12345, 8000, 60000, 4000};
+    StandInServer server = {1700000000000000LL, 0, 0, 0, 0, 5000000 + 20000000};
+
+    uint64_t nowUs = 5000000;
+    uint8_t message[FrameEnvelope::kHeaderSize + 16];
+    uint32_t sequence = 0;
+    uint32_t minRtt = 0xFFFFFFFF;
+
+    // 60 s at 10 FPS; every 13th frame is dropped before sending (gap)
+    for (uint32_t tick = 0; tick < 600; tick++, nowUs += 100000) {
+        if (sync.pingDue(nowUs)) {
+            char ping[ClockSync::kMaxMessage];
+            size_t length = sync.makePing(nowUs, ping, sizeof(ping));
+            uint64_t up = link.up();
+            uint64_t serverHold = 150;
+            uint64_t down = link.down();
+            char pong[ClockSync::kMaxMessage];
+            size_t pongLength = ClockSync::makePong(ping, length, server.now(nowUs + up),
+                                                    server.now(nowUs + up + serverHold), pong, sizeof(pong));
+            sync.handlePong(pong, pongLength, nowUs + up + serverHold + down);
+            if (up + down < minRtt) {
+                minRtt = (uint32_t)(up + down);
+            }
+        }
+
+        sequence++;
+        if (sequence % 13 == 0) {
+            continue;
+        }
+        FrameHeader header = makeHeader();
+        header.sequence = sequence;
+        header.captureUs = nowUs;
+        header.sendUs = nowUs + 20000;
+        header.payloadLength = 16;
+        header.flags = sync.isSynced() ? kEnvelopeClockSynced : 0;
+        header.clockOffsetUs = sync.getOffsetUs();
+        FrameEnvelope::encode(header, message, sizeof(message));
+        server.receive(message, sizeof(message), header.sendUs + link.up());
+    }
+
+    ClockSyncStats stats = sync.getStats();
+    TEST_ASSERT_TRUE(stats.synced);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.rejected);
+    TEST_ASSERT_EQUAL_UINT32(stats.pingsSent, stats.pongsReceived);
+    TEST_ASSERT_EQUAL_UINT32(554, server.frames);
+    TEST_ASSERT_EQUAL_UINT32(46, server.gaps);
+
+    // Offset error is bounded by half the asymmetry of the chosen (lowest-RTT) sample;
+    // a single sample (skewed by jitter) is already within its own RTT/2
+    TEST_ASSERT_TRUE(stats.rttUs <= minRtt);
+    TEST_ASSERT_TRUE(server.maxErrorUs <= (int64_t)stats.rttUs / 2);
+    TEST_ASSERT_TRUE(llabs(stats.offsetUs - server.epochUs) <= (int64_t)stats.rttUs / 2);
+}
+
+int main(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+    UNITY_BEGIN();
+    RUN_TEST(test_envelope_round_trip);
+    RUN_TEST(test_envelope_rejects_raw_jpeg_and_truncation);
+    RUN_TEST(test_envelope_skips_fields_from_later_versions);
+    RUN_TEST(test_clock_sync_message_format);
+    RUN_TEST(test_clock_sync_rejects_bad_pongs);
+    RUN_TEST(test_clock_sync_ping_schedule);
+    RUN_TEST(test_clock_sync_latency_accuracy_on_jittery_link);
+    return UNITY_END();
+}
@@ -0,0 +1,258 @@
+/**
+ * `test_main.cpp`
+ * - Unit tests for FramePacer on a simulated clock (native host build)
+ * - Run: pio test -e native -f test_frame_pacer
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#include <unity.h>
+
+#include <stdio.h>
+
+#include "FramePacer.h"
+#include "PaceTimer.h"
+
+#include <chrono>
+
+void setUp(void) {}
+void tearDown(void) {}
+
+/**
+ * Deterministic pseudo-random source for work/wake-up times
+ */
+struct SimRandom {
+    uint32_t state;
+    explicit SimRandom(uint32_t seed) : state(seed) {}
+    uint32_t next(uint32_t range) {
+        state = state * 1664525u + 1013904223u;
+        return (state >> 8) % range;
+    }
+};
+
+static const uint32_t k15FpsUs = 66667;
+
+// ========================================
+// Grid / Drift
+// ========================================
+void test_ticks_stay_on_grid_with_variable_work() {
+    FramePacerConfig config;
+    config.intervalUs = k15FpsUs;
+    FramePacer pacer(config);
+    SimRandom random(7);
+
+    uint64_t now = 1000000;
+    pacer.start(now);
+    const uint32_t frames = 900;  // one minute at 15 FPS
+    for (uint32_t i = 0; i < frames; i++) {
+        // Wake-up overshoot of up to 1.5 ms (timer latency / tick rounding)
+        now += pacer.waitUs(now) + random.next(1500);
+        TEST_ASSERT_TRUE(pacer.poll(now));
+        TEST_ASSERT_FALSE(pacer.poll(now));
+        // Capture + send: 5..50 ms
+        now += 5000 + random.next(45000);
+    }
+
+    FramePacerStats stats = pacer.getStats();
+    TEST_ASSERT_EQUAL_UINT32(frames, stats.ticks);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.skipped);
+    TEST_ASSERT_TRUE(stats.maxLatenessUs < 1500);
+    // The last tick is still on the grid: no accumulated drift
+    uint64_t expectedLast = 1000000 + (uint64_t)(frames - 1) * k15FpsUs;
+    TEST_ASSERT_TRUE(stats.lastTickUs >= expectedLast && stats.lastTickUs < expectedLast + 1500);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 15.0f, stats.achievedFps());
+    TEST_ASSERT_TRUE(stats.minPeriodUs > k15FpsUs - 1500);
+    TEST_ASSERT_TRUE(stats.maxPeriodUs < k15FpsUs + 1500);
+}
+
+void test_naive_polling_drifts_below_target() {
+    // The old loop(): lastFrameTime reset after the send, fixed delay(10) between polls
+    SimRandom random(7);
+    const uint32_t intervalMs = k15FpsUs / 1000;
+    uint64_t nowUs = 0;
+    uint64_t lastFrameMs = 0;
+    uint32_t frames = 0;
+    uint64_t firstUs = 0;
+    uint64_t lastUs = 0;
+    while (frames < 900) {
+        if (nowUs / 1000 - lastFrameMs >= intervalMs) {
+            if (frames == 0) firstUs = nowUs;
+            lastUs = nowUs;
+            frames++;
+            nowUs += 5000 + random.next(45000);
+            lastFrameMs = nowUs / 1000;
+        }
+        nowUs += 10000 + random.next(1500);
+    }
+    float naiveFps = (frames - 1) * 1000000.0f / (float)(lastUs - firstUs);
+    printf("  naive loop at 15 FPS target: %.2f FPS\n", naiveFps);
+    TEST_ASSERT_TRUE(naiveFps < 11.0f);
+}
+
+// ========================================
+// Late Ticks
+// ========================================
+void test_skip_policy_realigns_after_stall() {
+    FramePacerConfig config;
+    config.intervalUs = 100000;
+    config.policy = PacingPolicy::Skip;
+    FramePacer pacer(config);
+
+    pacer.start(0);
+    TEST_ASSERT_TRUE(pacer.poll(0));
+    TEST_ASSERT_TRUE(pacer.poll(100000));
+    TEST_ASSERT_TRUE(pacer.poll(200000));
+
+    // The frame at 200 ms took 350 ms: deadline 300 ms fires late, 400/500 ms are dropped
+    TEST_ASSERT_TRUE(pacer.poll(550000));
+    TEST_ASSERT_EQUAL_UINT32(250000, pacer.getLastLatenessUs());
+    TEST_ASSERT_FALSE(pacer.poll(550000));
+    TEST_ASSERT_EQUAL_UINT64(600000, pacer.getDeadlineUs());
+    TEST_ASSERT_EQUAL_UINT32(50000, pacer.waitUs(550000));
+
+    FramePacerStats stats = pacer.getStats();
+    TEST_ASSERT_EQUAL_UINT32(4, stats.ticks);
+    TEST_ASSERT_EQUAL_UINT32(2, stats.skipped);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.caughtUp);
+    TEST_ASSERT_EQUAL_UINT32(250000, stats.maxLatenessUs);
+}
+
+void test_catch_up_policy_fires_missed_ticks() {
+    FramePacerConfig config;
+    config.intervalUs = 100000;
+    config.policy = PacingPolicy::CatchUp;
+    config.maxCatchUp = 2;
+    FramePacer pacer(config);
+
+    pacer.start(0);
+    TEST_ASSERT_TRUE(pacer.poll(0));
+    // Stall until 350 ms: ticks for 100, 200 and 300 ms fire back-to-back
+    TEST_ASSERT_TRUE(pacer.poll(350000));
+    TEST_ASSERT_TRUE(pacer.poll(350000));
+    TEST_ASSERT_TRUE(pacer.poll(350000));
+    TEST_ASSERT_FALSE(pacer.poll(350000));
+    TEST_ASSERT_EQUAL_UINT64(400000, pacer.getDeadlineUs());
+
+    FramePacerStats stats = pacer.getStats();
+    TEST_ASSERT_EQUAL_UINT32(4, stats.ticks);
+    TEST_ASSERT_EQUAL_UINT32(2, stats.caughtUp);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.skipped);
+}
+
+void test_catch_up_is_bounded() {
+    FramePacerConfig config;
+    config.intervalUs = 100000;
+    config.policy = PacingPolicy::CatchUp;
+    config.maxCatchUp = 1;
+    FramePacer pacer(config);
+
+    pacer.start(0);
+    TEST_ASSERT_TRUE(pacer.poll(0));
+    // One second stall: one catch-up tick, the rest is skipped and the grid is kept
+    TEST_ASSERT_TRUE(pacer.poll(1050000));
+    TEST_ASSERT_TRUE(pacer.poll(1050000));
+    TEST_ASSERT_FALSE(pacer.poll(1050000));
+    TEST_ASSERT_EQUAL_UINT64(1100000, pacer.getDeadlineUs());
+
+    FramePacerStats stats = pacer.getStats();
+    TEST_ASSERT_EQUAL_UINT32(1, stats.caughtUp);
+    TEST_ASSERT_EQUAL_UINT32(8, stats.skipped);
+}
+
+// ========================================
+// Interval Changes / Edge Cases
+// ========================================
+void test_set_interval_keeps_phase() {
+    FramePacerConfig config;
+    config.intervalUs = 100000;
+    FramePacer pacer(config);
+
+    pacer.start(0);
+    TEST_ASSERT_TRUE(pacer.poll(0));
+    TEST_ASSERT_TRUE(pacer.poll(100500));
+
+    // ABR slows down: next tick one new period after the last deadline
+    pacer.setInterval(200000, 150000);
+    TEST_ASSERT_EQUAL_UINT64(300000, pacer.getDeadlineUs());
+    TEST_ASSERT_FALSE(pacer.poll(299999));
+    TEST_ASSERT_TRUE(pacer.poll(300000));
+
+    // Speeding up after the new deadline already passed: tick now
+    pacer.setInterval(50000, 420000);
+    TEST_ASSERT_EQUAL_UINT64(420000, pacer.getDeadlineUs());
+    TEST_ASSERT_TRUE(pacer.poll(420000));
+    TEST_ASSERT_EQUAL_UINT64(470000, pacer.getDeadlineUs());
+    TEST_ASSERT_EQUAL_UINT32(50000, pacer.getIntervalUs());
+}
+
+void test_stopped_and_zero_interval() {
+    FramePacerConfig config;
+    config.intervalUs = 0;
+    FramePacer pacer(config);
+
+    TEST_ASSERT_FALSE(pacer.poll(1000));
+    TEST_ASSERT_EQUAL_UINT32(0, pacer.waitUs(1000));
+
+    pacer.start(1000);
+    TEST_ASSERT_TRUE(pacer.poll(1000));
+    TEST_ASSERT_TRUE(pacer.poll(1000));
+    TEST_ASSERT_TRUE(pacer.poll(2000));
+    TEST_ASSERT_EQUAL_UINT32(0, pacer.getStats().skipped);
+
+    pacer.stop();
+    TEST_ASSERT_FALSE(pacer.poll(3000));
+}
+
+void test_reset_stats_starts_new_window() {
+    FramePacerConfig config;
+    config.intervalUs = 10000;
+    FramePacer pacer(config);
+    pacer.start(0);
+    for (uint64_t t = 0; t <= 100000; t += 10000) {
+        TEST_ASSERT_TRUE(pacer.poll(t + 300));
+    }
+    FramePacerStats stats = pacer.getStats();
+    TEST_ASSERT_EQUAL_UINT32(11, stats.ticks);
+    TEST_ASSERT_EQUAL_UINT32(300, stats.meanLatenessUs());
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 100.0f, stats.achievedFps());
+
+    pacer.resetStats();
+    stats = pacer.getStats();
+    TEST_ASSERT_EQUAL_UINT32(0, stats.ticks);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, stats.achievedFps());
+    TEST_ASSERT_TRUE(pacer.poll(110000));
+    TEST_ASSERT_EQUAL_UINT32(1, pacer.getStats().ticks);
+}
+
+// ========================================
+// PaceTimer (host)
+// ========================================
+void test_pace_timer_waits_requested_time() {
+    PaceTimer timer;
+    auto start = std::chrono::steady_clock::now();
+    timer.wait(0);
+    timer.wait(20000);
+    long long elapsedUs = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    TEST_ASSERT_TRUE(elapsedUs >= 20000);
+    TEST_ASSERT_TRUE(elapsedUs < 200000);
+}
+
+int main(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+    UNITY_BEGIN();
+    RUN_TEST(test_ticks_stay_on_grid_with_variable_work);
+    RUN_TEST(test_naive_polling_drifts_below_target);
+    RUN_TEST(test_skip_policy_realigns_after_stall);
+    RUN_TEST(test_catch_up_policy_fires_missed_ticks);
+    RUN_TEST(test_catch_up_is_bounded);
+    RUN_TEST(test_set_interval_keeps_phase);
+    RUN_TEST(test_stopped_and_zero_interval);
+    RUN_TEST(test_reset_stats_starts_new_window);
+    RUN_TEST(test_pace_timer_waits_requested_time);
+    return UNITY_END();
+}
@@ -0,0 +1,366 @@
+/**
+ * `test_main.cpp`
+ * - Unit tests for FramePipeline (native host build)
+ * - Run: pio test -e native -f test_frame_pipeline
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#include <unity.h>
+
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "FramePipeline.h"
+
+// ========================================
+// Stub Backends
+// ========================================
+
+/**
+ * Camera stub with a fixed number of frame buffers (like fb_count)
+ */
+class StubSource : public FrameSource {
+public:
+    explicit StubSource(int bufferCount) : bufferCount(bufferCount), outstanding(0), acquired(0) {}
+
+    bool acquire(FrameDescriptor& frame) override {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (outstanding >= bufferCount) {
+            return false;  // all buffers held downstream
+        }
+        outstanding++;
+        acquired++;
+        frame.handle = (void*)(uintptr_t)acquired;
+        frame.data = payload;
+        frame.length = sizeof(payload);
+        frame.captureUs = 0;
+        return true;
+    }
+
+    void release(const FrameDescriptor& frame) override {
+        (void)frame;
+        std::lock_guard<std::mutex> lock(mutex);
+        outstanding--;
+    }
+
+    int bufferCount;
+    int outstanding;
+    int acquired;
+    uint8_t payload[16] = {0xFF, 0xD8};
+    std::mutex mutex;
+};
+
+/**
+ * Socket stub with a configurable send delay
+ */
+class StubSink : public FrameSink {
+public:
+    StubSink() : ready(true), credit(true), sendDelayMs(0), polls(0), idles(0) {}
+
+    bool isReady() override { return ready; }
+
+    bool canSend() override { return credit; }
+
+    bool send(const FrameDescriptor& frame) override {
+        if (sendDelayMs > 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(sendDelayMs));
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        sequences.push_back(frame.sequence);
+        return true;
+    }
+
+    void poll() override { polls++; }
+
+    void idle() override { idles++; }
+
+    volatile bool ready;
+    volatile bool credit;
+    uint32_t sendDelayMs;
+    std::atomic<int> polls;
+    std::atomic<int> idles;
+    std::vector<uint32_t> sequences;
+    std::mutex mutex;
+};
+
+static FrameDescriptor makeFrame(uint32_t seq) {
+    FrameDescriptor frame = {};
+    frame.sequence = seq;
+    return frame;
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+// ========================================
+// FrameQueue Tests
+// ========================================
+void test_queue_drop_oldest_keeps_newest(void) {
+    FrameQueue queue(2, DropPolicy::DropOldest);
+    FrameDescriptor dropped;
+
+    TEST_ASSERT_FALSE(queue.push(makeFrame(1), dropped));
+    TEST_ASSERT_FALSE(queue.push(makeFrame(2), dropped));
+    TEST_ASSERT_TRUE(queue.push(makeFrame(3), dropped));
+    TEST_ASSERT_EQUAL_UINT32(1, dropped.sequence);
+
+    FrameDescriptor out;
+    TEST_ASSERT_TRUE(queue.pop(out, 0));
+    TEST_ASSERT_EQUAL_UINT32(2, out.sequence);
+    TEST_ASSERT_TRUE(queue.pop(out, 0));
+    TEST_ASSERT_EQUAL_UINT32(3, out.sequence);
+    TEST_ASSERT_EQUAL_UINT32(1, queue.droppedOldest());
+    TEST_ASSERT_EQUAL_UINT32(0, queue.droppedNewest());
+}
+
+void test_queue_drop_newest_rejects_incoming(void) {
+    FrameQueue queue(1, DropPolicy::DropNewest);
+    FrameDescriptor dropped;
+
+    TEST_ASSERT_FALSE(queue.push(makeFrame(1), dropped));
+    TEST_ASSERT_TRUE(queue.push(makeFrame(2), dropped));
+    TEST_ASSERT_EQUAL_UINT32(2, dropped.sequence);
+
+    FrameDescriptor out;
+    TEST_ASSERT_TRUE(queue.pop(out, 0));
+    TEST_ASSERT_EQUAL_UINT32(1, out.sequence);
+    TEST_ASSERT_EQUAL_UINT32(1, queue.droppedNewest());
+}
+
+void test_queue_depth_counters(void) {
+    FrameQueue queue(4, DropPolicy::DropOldest);
+    FrameDescriptor dropped;
+    FrameDescriptor out;
+
+    queue.push(makeFrame(1), dropped);
+    queue.push(makeFrame(2), dropped);
+    queue.push(makeFrame(3), dropped);
+    queue.pop(out, 0);
+
+    TEST_ASSERT_EQUAL(2, queue.depth());
+    TEST_ASSERT_EQUAL(3, queue.maxDepth());
+}
+
+void test_queue_pop_times_out_when_empty(void) {
+    FrameQueue queue(1, DropPolicy::DropOldest);
+    FrameDescriptor out;
+
+    auto start = std::chrono::steady_clock::now();
+    TEST_ASSERT_FALSE(queue.pop(out, 20));
+    auto waited = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    TEST_ASSERT_GREATER_OR_EQUAL(15, waited);
+}
+
+void test_queue_capacity_is_clamped(void) {
+    FrameQueue zero(0, DropPolicy::DropOldest);
+    FrameQueue huge(100, DropPolicy::DropOldest);
+    TEST_ASSERT_EQUAL(1, zero.capacity());
+    TEST_ASSERT_EQUAL(FrameQueue::kMaxCapacity, huge.capacity());
+}
+
+// ========================================
+// FramePipeline Tests (single-threaded steps)
+// ========================================
+void test_pipeline_steps_release_dropped_frames(void) {
+    StubSource source(4);
+    StubSink sink;
+    PipelineConfig config;
+    config.queueDepth = 1;
+    FramePipeline pipeline(source, sink, config);
+
+    TEST_ASSERT_TRUE(pipeline.captureOnce());
+    TEST_ASSERT_TRUE(pipeline.captureOnce());
+    TEST_ASSERT_TRUE(pipeline.captureOnce());
+    TEST_ASSERT_EQUAL(1, source.outstanding);
+
+    TEST_ASSERT_TRUE(pipeline.sendOnce(0));
+    TEST_ASSERT_EQUAL(0, source.outstanding);
+    TEST_ASSERT_EQUAL(1, (int)sink.sequences.size());
+    TEST_ASSERT_EQUAL_UINT32(3, sink.sequences[0]);
+
+    PipelineStats stats = pipeline.getStats();
+    TEST_ASSERT_EQUAL_UINT32(3, stats.captured);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.sent);
+    TEST_ASSERT_EQUAL_UINT32(2, stats.droppedOldest);
+}
+
+void test_pipeline_discards_queued_frames_when_offline(void) {
+    StubSource source(2);
+    StubSink sink;
+    PipelineConfig config;
+    FramePipeline pipeline(source, sink, config);
+
+    pipeline.captureOnce();
+    sink.ready = false;
+
+    TEST_ASSERT_FALSE(pipeline.sendOnce(0));
+    TEST_ASSERT_EQUAL(0, source.outstanding);
+    TEST_ASSERT_EQUAL_UINT32(1, pipeline.getStats().droppedOffline);
+    TEST_ASSERT_EQUAL(1, sink.polls.load());
+}
+
+void test_pipeline_idle_only_without_live_frame(void) {
+    StubSource source(2);
+    StubSink sink;
+    PipelineConfig config;
+    FramePipeline pipeline(source, sink, config);
+
+    pipeline.captureOnce();
+    TEST_ASSERT_TRUE(pipeline.sendOnce(0));
+    TEST_ASSERT_EQUAL(0, sink.idles.load());
+
+    TEST_ASSERT_FALSE(pipeline.sendOnce(1));
+    TEST_ASSERT_EQUAL(1, sink.idles.load());
+    TEST_ASSERT_EQUAL(2, sink.polls.load());
+}
+
+void test_pipeline_holds_newest_frame_without_credit(void) {
+    StubSource source(3);
+    StubSink sink;
+    PipelineConfig config;
+    FramePipeline pipeline(source, sink, config);
+
+    // No credit: the queued frame is kept and each capture replaces it
+    sink.credit = false;
+    pipeline.captureOnce();
+    TEST_ASSERT_FALSE(pipeline.sendOnce(0));
+    pipeline.captureOnce();
+    pipeline.captureOnce();
+    TEST_ASSERT_FALSE(pipeline.sendOnce(0));
+    TEST_ASSERT_EQUAL(0, (int)sink.sequences.size());
+    TEST_ASSERT_EQUAL(1, source.outstanding);
+
+    sink.credit = true;
+    TEST_ASSERT_TRUE(pipeline.sendOnce(0));
+    TEST_ASSERT_EQUAL_UINT32(3, sink.sequences[0]);
+    TEST_ASSERT_EQUAL(0, source.outstanding);
+
+    PipelineStats stats = pipeline.getStats();
+    TEST_ASSERT_EQUAL_UINT32(2, stats.held);
+    TEST_ASSERT_EQUAL_UINT32(2, stats.droppedOldest);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.droppedOffline);
+}
+
+void test_pipeline_idle_without_credit(void) {
+    StubSource source(2);
+    StubSink sink;
+    PipelineConfig config;
+    FramePipeline pipeline(source, sink, config);
+
+    // Background traffic holds no credit: it still gets the wait, the live frame stays queued
+    sink.credit = false;
+    TEST_ASSERT_FALSE(pipeline.sendOnce(1));
+    TEST_ASSERT_EQUAL(1, sink.idles.load());
+    pipeline.captureOnce();
+    TEST_ASSERT_FALSE(pipeline.sendOnce(1));
+    TEST_ASSERT_EQUAL(2, sink.idles.load());
+    TEST_ASSERT_EQUAL(0, (int)sink.sequences.size());
+    TEST_ASSERT_EQUAL(1, source.outstanding);
+    TEST_ASSERT_EQUAL(2, sink.polls.load());
+    TEST_ASSERT_EQUAL_UINT32(2, pipeline.getStats().held);
+}
+
+/**
+ * Source that admits every other frame (stand-in for the motion gate)
+ */
+class GatedSource : public StubSource {
+public:
+    GatedSource() : StubSource(2) {}
+
+    bool admit(FrameDescriptor& frame) override {
+        frame.motionScore = 500;
+        return (acquired % 2) == 1;
+    }
+};
+
+void test_pipeline_releases_frames_rejected_by_admit(void) {
+    GatedSource source;
+    StubSink sink;
+    PipelineConfig config;
+    FramePipeline pipeline(source, sink, config);
+
+    for (int i = 0; i < 4; i++) {
+        TEST_ASSERT_TRUE(pipeline.captureOnce());
+        pipeline.sendOnce(0);
+    }
+    TEST_ASSERT_EQUAL(0, source.outstanding);
+    TEST_ASSERT_EQUAL(2, (int)sink.sequences.size());
+    TEST_ASSERT_EQUAL_UINT32(2, sink.sequences[1]);  // sequence counts admitted frames only
+
+    PipelineStats stats = pipeline.getStats();
+    TEST_ASSERT_EQUAL_UINT32(4, stats.captured);
+    TEST_ASSERT_EQUAL_UINT32(2, stats.gated);
+    TEST_ASSERT_EQUAL_UINT32(2, stats.sent);
+}
+
+// ========================================
+// FramePipeline Tests (threaded)
+// ========================================
+void test_pipeline_overlaps_capture_and_slow_send(void) {
+    StubSource source(3);  // one sending, one queued, one being captured
+    StubSink sink;
+    sink.sendDelayMs = 20;
+    PipelineConfig config;
+    config.queueDepth = 1;
+    config.frameIntervalMs = 5;
+    config.pollIntervalMs = 2;
+    FramePipeline pipeline(source, sink, config);
+
+    TEST_ASSERT_TRUE(pipeline.start());
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    pipeline.stop();
+
+    PipelineStats stats = pipeline.getStats();
+    TEST_ASSERT_GREATER_THAN(5, stats.sent);
+    TEST_ASSERT_GREATER_THAN(0, stats.droppedOldest);
+    TEST_ASSERT_LESS_OR_EQUAL(1, stats.maxQueueDepth);
+    TEST_ASSERT_EQUAL(0, source.outstanding);  // every buffer returned
+
+    // Frames leave in capture order
+    for (size_t i = 1; i < sink.sequences.size(); i++) {
+        TEST_ASSERT_GREATER_THAN(sink.sequences[i - 1], sink.sequences[i]);
+    }
+}
+
+void test_pipeline_idle_while_sink_not_ready(void) {
+    StubSource source(2);
+    StubSink sink;
+    sink.ready = false;
+    PipelineConfig config;
+    config.pollIntervalMs = 2;
+    FramePipeline pipeline(source, sink, config);
+
+    pipeline.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    pipeline.stop();
+
+    TEST_ASSERT_EQUAL(0, source.acquired);
+    TEST_ASSERT_GREATER_THAN(0, sink.polls.load());  // connection still serviced
+}
+
+int main(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+    UNITY_BEGIN();
+    RUN_TEST(test_queue_drop_oldest_keeps_newest);
+    RUN_TEST(test_queue_drop_newest_rejects_incoming);
+    RUN_TEST(test_queue_depth_counters);
+    RUN_TEST(test_queue_pop_times_out_when_empty);
+    RUN_TEST(test_queue_capacity_is_clamped);
+    RUN_TEST(test_pipeline_steps_release_dropped_frames);
+    RUN_TEST(test_pipeline_discards_queued_frames_when_offline);
+    RUN_TEST(test_pipeline_idle_only_without_live_frame);
+    RUN_TEST(test_pipeline_holds_newest_frame_without_credit);
+    RUN_TEST(test_pipeline_idle_without_credit);
+    RUN_TEST(test_pipeline_releases_frames_rejected_by_admit);
+    RUN_TEST(test_pipeline_overlaps_capture_and_slow_send);
+    RUN_TEST(test_pipeline_idle_while_sink_not_ready);
+    return UNITY_END();
+}
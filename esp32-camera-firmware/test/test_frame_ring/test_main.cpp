@@ -0,0 +1,328 @@
+/**
+ * `test_main.cpp`
+ * - Unit tests for FrameRing (native host build)
+ * - Includes a slow-consumer simulation of the driver's latest-frame grabbing
+ * - Run: pio test -e native -f test_frame_ring
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#include <unity.h>
+
+#include "FramePipeline.h"
+#include "FrameRing.h"
+
+static const uint64_t MS = 1000ULL;
+
+static int bufferA;
+static int bufferB;
+
+void setUp(void) {}
+void tearDown(void) {}
+
+// ========================================
+// Simulated Camera Driver (CAMERA_GRAB_LATEST)
+// ========================================
+
+/**
+ * Simulates esp32-camera with fb_count buffers in latest-frame mode:
+ * - The sensor writes a new frame every periodUs into a free buffer,
+ *   overwriting the oldest unread frame when no buffer is free
+ * - get() returns the most recent unread frame
+ */
+class SimCamera {
+public:
+    static const int kBuffers = 3;
+
+    explicit SimCamera(uint64_t periodUs) : periodUs(periodUs), nextFrameUs(periodUs) {
+        for (int i = 0; i < kBuffers; i++) {
+            held[i] = false;
+            ready[i] = false;
+            captureUs[i] = 0;
+        }
+    }
+
+    void advanceTo(uint64_t nowUs) {
+        while (nextFrameUs <= nowUs) {
+            int target = -1;
+            for (int i = 0; i < kBuffers; i++) {
+                if (!held[i] && !ready[i]) { target = i; break; }
+            }
+            if (target < 0) {
+                // No free buffer: overwrite the oldest ready frame
+                for (int i = 0; i < kBuffers; i++) {
+                    if (!held[i] && ready[i] && (target < 0 || captureUs[i] < captureUs[target])) target = i;
+                }
+            }
+            if (target >= 0) {
+                ready[target] = true;
+                captureUs[target] = nextFrameUs;
+            }
+            nextFrameUs += periodUs;
+        }
+    }
+
+    int get() {
+        int latest = -1;
+        for (int i = 0; i < kBuffers; i++) {
+            if (ready[i] && (latest < 0 || captureUs[i] > captureUs[latest])) latest = i;
+        }
+        if (latest >= 0) {
+            ready[latest] = false;
+            held[latest] = true;
+        }
+        return latest;
+    }
+
+    void put(int index) { held[index] = false; }
+
+    uint64_t periodUs;
+    uint64_t nextFrameUs;
+    bool held[kBuffers];
+    bool ready[kBuffers];
+    uint64_t captureUs[kBuffers];
+};
+
+// ========================================
+// FrameRing Tests
+// ========================================
+void test_slots_are_assigned_per_handle(void) {
+    FrameRingConfig config;
+    FrameRing ring(config);
+
+    TEST_ASSERT_EQUAL(0, ring.onAcquire(&bufferA, 0, 0));
+    TEST_ASSERT_EQUAL(1, ring.onAcquire(&bufferB, 0, 0));
+    ring.onRelease(&bufferA, 10);
+    TEST_ASSERT_EQUAL(0, ring.onAcquire(&bufferA, 20, 20));
+
+    TEST_ASSERT_EQUAL(2, (int)ring.getSlotCount());
+    TEST_ASSERT_EQUAL_UINT32(2, ring.getSlotStats(0).acquisitions);
+    TEST_ASSERT_EQUAL_UINT32(1, ring.getSlotStats(1).acquisitions);
+    TEST_ASSERT_EQUAL_UINT32(2, ring.getStats().held);
+    TEST_ASSERT_EQUAL_UINT32(2, ring.getStats().maxHeld);
+}
+
+void test_stale_boundary(void) {
+    FrameRingConfig config;
+    config.maxFrameAgeMs = 100;
+    FrameRing ring(config);
+
+    TEST_ASSERT_FALSE(ring.isStale(0, 100 * MS));
+    TEST_ASSERT_TRUE(ring.isStale(0, 100 * MS + 1));
+    TEST_ASSERT_FALSE(ring.isStale(200 * MS, 100 * MS));  // clock skew: never stale
+
+    config.maxFrameAgeMs = 0;
+    FrameRing disabled(config);
+    TEST_ASSERT_FALSE(disabled.isStale(0, 10000 * MS));
+}
+
+void test_check_fresh_counts_stale_drops_per_slot(void) {
+    FrameRingConfig config;
+    config.maxFrameAgeMs = 50;
+    FrameRing ring(config);
+
+    ring.onAcquire(&bufferA, 0, 0);
+    ring.onAcquire(&bufferB, 0, 0);
+    TEST_ASSERT_TRUE(ring.checkFresh(&bufferA, 0, 40 * MS));
+    TEST_ASSERT_FALSE(ring.checkFresh(&bufferB, 0, 80 * MS));
+
+    TEST_ASSERT_EQUAL_UINT32(0, ring.getSlotStats(0).staleDrops);
+    TEST_ASSERT_EQUAL_UINT32(1, ring.getSlotStats(1).staleDrops);
+    TEST_ASSERT_EQUAL_UINT32(80, ring.getSlotStats(1).maxAgeMs);
+    TEST_ASSERT_EQUAL_UINT32(1, ring.getStats().staleDrops);
+}
+
+void test_occupancy_permille(void) {
+    FrameRingConfig config;
+    FrameRing ring(config);
+    ring.resetStats(0);
+
+    ring.onAcquire(&bufferA, 0, 0);
+    ring.onRelease(&bufferA, 50 * MS);
+    ring.onAcquire(&bufferB, 0, 75 * MS);
+
+    TEST_ASSERT_EQUAL_UINT32(500, ring.occupancyPermille(0, 100 * MS));
+    TEST_ASSERT_EQUAL_UINT32(250, ring.occupancyPermille(1, 100 * MS));  // still held
+    TEST_ASSERT_EQUAL_UINT32(0, ring.occupancyPermille(5, 100 * MS));
+}
+
+void test_untracked_handles_beyond_capacity(void) {
+    FrameRingConfig config;
+    FrameRing ring(config);
+    int handles[FrameRing::kMaxBuffers + 1];
+
+    for (size_t i = 0; i < FrameRing::kMaxBuffers; i++) {
+        TEST_ASSERT_EQUAL((int)i, ring.onAcquire(&handles[i], 0, 0));
+    }
+    TEST_ASSERT_EQUAL(-1, ring.onAcquire(&handles[FrameRing::kMaxBuffers], 0, 0));
+    TEST_ASSERT_EQUAL_UINT32(1, ring.getStats().untracked);
+}
+
+void test_configure_forgets_tracked_buffers(void) {
+    FrameRingConfig config;
+    FrameRing ring(config);
+    ring.onAcquire(&bufferA, 0, 0);
+
+    config.maxFrameAgeMs = 10;
+    ring.configure(config);
+
+    TEST_ASSERT_EQUAL(0, (int)ring.getSlotCount());
+    TEST_ASSERT_EQUAL_UINT32(0, ring.getStats().acquired);
+    TEST_ASSERT_TRUE(ring.isStale(0, 11 * MS));
+}
+
+// ========================================
+// Slow Consumer Simulation
+// ========================================
+
+/**
+ * Sends frames from a 15 FPS latest-frame camera over a link that needs
+ * sendUs per frame, with one frame waiting in a queue while the previous
+ * one is on the wire (the pipelined layout).
+ * @return Oldest frame age (ms) that reached the socket
+ */
+static uint32_t simulateSlowConsumer(uint64_t sendUs, FrameRing& ring) {
+    SimCamera camera(66 * MS);
+    uint64_t nowUs = 0;
+    uint32_t worstAgeMs = 0;
+    int queued = -1;
+
+    ring.resetStats(0);
+    while (nowUs < 5000 * MS) {
+        camera.advanceTo(nowUs);
+
+        // Capture side: keep the queue filled with the latest frame
+        if (queued < 0) {
+            queued = camera.get();
+            if (queued >= 0) {
+                ring.onAcquire(&camera.held[queued], camera.captureUs[queued], nowUs);
+            }
+        }
+
+        // Network side: take the queued frame, check its age, send it
+        if (queued >= 0) {
+            int frame = queued;
+            queued = -1;
+            if (ring.checkFresh(&camera.held[frame], camera.captureUs[frame], nowUs)) {
+                uint32_t ageMs = (uint32_t)((nowUs - camera.captureUs[frame]) / MS);
+                if (ageMs > worstAgeMs) worstAgeMs = ageMs;
+
+                // While this frame is on the wire the capture side queues the next one
+                camera.advanceTo(nowUs + sendUs / 2);
+                queued = camera.get();
+                if (queued >= 0) {
+                    ring.onAcquire(&camera.held[queued], camera.captureUs[queued], nowUs + sendUs / 2);
+                }
+                nowUs += sendUs;
+            }
+            ring.onRelease(&camera.held[frame], nowUs);
+            camera.put(frame);
+            continue;
+        }
+        nowUs += 5 * MS;
+    }
+    if (queued >= 0) {
+        ring.onRelease(&camera.held[queued], nowUs);
+        camera.put(queued);
+    }
+    return worstAgeMs;
+}
+
+void test_slow_consumer_never_sends_stale_frames(void) {
+    FrameRingConfig config;
+    config.maxFrameAgeMs = 150;
+    FrameRing ring(config);
+
+    uint32_t worstAgeMs = simulateSlowConsumer(250 * MS, ring);
+
+    TEST_ASSERT_LESS_OR_EQUAL(150, worstAgeMs);
+    TEST_ASSERT_GREATER_THAN(0, ring.getStats().staleDrops);
+    TEST_ASSERT_EQUAL(SimCamera::kBuffers, (int)ring.getSlotCount());
+    TEST_ASSERT_EQUAL_UINT32(0, ring.getStats().held);
+
+    // Every buffer took part in the rotation
+    for (size_t i = 0; i < ring.getSlotCount(); i++) {
+        TEST_ASSERT_GREATER_THAN(0, ring.getSlotStats(i).acquisitions);
+    }
+}
+
+void test_slow_consumer_without_age_limit_ships_old_frames(void) {
+    FrameRingConfig config;
+    config.maxFrameAgeMs = 0;
+    FrameRing ring(config);
+
+    uint32_t worstAgeMs = simulateSlowConsumer(250 * MS, ring);
+
+    TEST_ASSERT_GREATER_THAN(150, worstAgeMs);
+    TEST_ASSERT_EQUAL_UINT32(0, ring.getStats().staleDrops);
+}
+
+// ========================================
+// FramePipeline Integration
+// ========================================
+
+/**
+ * Frame source that reports every even frame as stale
+ */
+class AlternatingSource : public FrameSource {
+public:
+    AlternatingSource() : outstanding(0) {}
+    bool acquire(FrameDescriptor& frame) override {
+        outstanding++;
+        frame.handle = this;
+        return true;
+    }
+    void release(const FrameDescriptor& frame) override {
+        (void)frame;
+        outstanding--;
+    }
+    bool isFresh(const FrameDescriptor& frame) override { return frame.sequence % 2 == 1; }
+    int outstanding;
+};
+
+class CountingSink : public FrameSink {
+public:
+    CountingSink() : sent(0) {}
+    bool isReady() override { return true; }
+    bool send(const FrameDescriptor& frame) override {
+        (void)frame;
+        sent++;
+        return true;
+    }
+    int sent;
+};
+
+void test_pipeline_drops_stale_frames_before_send(void) {
+    AlternatingSource source;
+    CountingSink sink;
+    PipelineConfig config;
+    FramePipeline pipeline(source, sink, config);
+
+    for (int i = 0; i < 4; i++) {
+        pipeline.captureOnce();
+        pipeline.sendOnce(0);
+    }
+
+    TEST_ASSERT_EQUAL(2, sink.sent);
+    TEST_ASSERT_EQUAL_UINT32(2, pipeline.getStats().droppedStale);
+    TEST_ASSERT_EQUAL(0, source.outstanding);
+}
+
+int main(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+    UNITY_BEGIN();
+    RUN_TEST(test_slots_are_assigned_per_handle);
+    RUN_TEST(test_stale_boundary);
+    RUN_TEST(test_check_fresh_counts_stale_drops_per_slot);
+    RUN_TEST(test_occupancy_permille);
+    RUN_TEST(test_untracked_handles_beyond_capacity);
+    RUN_TEST(test_configure_forgets_tracked_buffers);
+    RUN_TEST(test_slow_consumer_never_sends_stale_frames);
+    RUN_TEST(test_slow_consumer_without_age_limit_ships_old_frames);
+    RUN_TEST(test_pipeline_drops_stale_frames_before_send);
+    return UNITY_END();
+}
@@ -0,0 +1,349 @@
+/**
+ * `test_main.cpp`
+ * - Unit tests and benchmark for JpegHeaderElider / JpegHeaderRebuilder (native host build)
+ * - Fixtures are OV2640-like frames encoded at run time (../test_motion_gate/jpeg_fixture.h);
+ *   every rebuilt frame must be byte-identical to the one the camera produced
+ * - The benchmark measures the upload saved per frame size and quality at 10 FPS
+ * - Run: pio test -e native -f test_jpeg_header_elision
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#include <unity.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#include <chrono>
+#include <vector>
+
+#include "JpegHeaderElision.h"
+#include "../test_motion_gate/jpeg_fixture.h"
+
+void setUp(void) {}
+void tearDown(void) {}
+
+/**
+ * OV2640 quality (0-63) to the fixture encoder's libjpeg quality (as the replay camera maps it)
+ */
+static int libjpegQuality(int ov2640Quality) {
+    int quality = 100 - ov2640Quality * 3 / 2;
+    return quality < 10 ? 10 : (quality > 95 ? 95 : quality);
+}
+
+static std::vector<uint8_t> makeJpeg(int width, int height, int quality, uint32_t seed,
+                                     FixtureSampling sampling = FixtureSampling::Yuv422,
+                                     uint16_t restartInterval = 0) {
+    FixtureEncoder encoder(libjpegQuality(quality), sampling, restartInterval);
+    Scene scene = makeFrame(makeBackground(width, height), seed, 2, 0, (int)(seed * 7) % width, height / 3,
+                            width / 6, width / 6);
+    return encoder.encode(scene);
+}
+
+/**
+ * Offset just past the SOS header, found the slow way
+ */
+static size_t sosEnd(const std::vector<uint8_t>& jpeg) {
+    for (size_t i = 2; i + 3 < jpeg.size(); i++) {
+        if (jpeg[i] == 0xFF && jpeg[i + 1] == 0xDA) {
+            return i + 2 + ((jpeg[i + 2] << 8) | jpeg[i + 3]);
+        }
+    }
+    return 0;
+}
+
+/**
+ * Send through the elider and rebuild on the receiver side, like the relay does
+ */
+static std::vector<uint8_t> roundTrip(JpegHeaderElider& elider, JpegHeaderRebuilder& rebuilder,
+                                      const std::vector<uint8_t>& jpeg, CompactFrame& frame) {
+    frame = elider.prepare(jpeg.data(), jpeg.size());
+    if (frame.mode == CompactMode::Define) {
+        rebuilder.learn(frame.headerId, jpeg.data(), jpeg.size());
+    }
+    if (frame.mode != CompactMode::Elided) {
+        return jpeg;
+    }
+    std::vector<uint8_t> out(jpeg.size() + kMaxJpegPreamble);
+    size_t length = rebuilder.rebuild(frame.headerId, jpeg.data() + frame.skip, jpeg.size() - frame.skip,
+                                      out.data(), out.size());
+    out.resize(length);
+    return out;
+}
+
+// ========================================
+// Preamble
+// ========================================
+
+void test_preamble_ends_after_sos(void) {
+    const FixtureSampling samplings[] = {FixtureSampling::Yuv422, FixtureSampling::Yuv420, FixtureSampling::Gray};
+    for (FixtureSampling sampling : samplings) {
+        std::vector<uint8_t> jpeg = makeJpeg(320, 240, 12, 1, sampling);
+        TEST_ASSERT_EQUAL(sosEnd(jpeg), JpegHeaderElider::findPreamble(jpeg.data(), jpeg.size()));
+    }
+    // DRI belongs to the preamble
+    std::vector<uint8_t> restart = makeJpeg(320, 240, 12, 1, FixtureSampling::Yuv422, 4);
+    size_t preamble = JpegHeaderElider::findPreamble(restart.data(), restart.size());
+    TEST_ASSERT_EQUAL(sosEnd(restart), preamble);
+    TEST_ASSERT_EQUAL(sosEnd(makeJpeg(320, 240, 12, 1)) + 6, preamble);
+}
+
+void test_preamble_rejects_malformed(void) {
+    std::vector<uint8_t> jpeg = makeJpeg(160, 120, 12, 1);
+    size_t preamble = JpegHeaderElider::findPreamble(jpeg.data(), jpeg.size());
+    TEST_ASSERT_TRUE(preamble > 0);
+
+    TEST_ASSERT_EQUAL(0, JpegHeaderElider::findPreamble(NULL, 0));
+    TEST_ASSERT_EQUAL(0, JpegHeaderElider::findPreamble(jpeg.data() + 2, jpeg.size() - 2));    // no SOI
+    TEST_ASSERT_EQUAL(0, JpegHeaderElider::findPreamble(jpeg.data(), preamble - 1));           // truncated SOS
+    TEST_ASSERT_EQUAL(0, JpegHeaderElider::findPreamble(jpeg.data(), jpeg.size(), preamble - 1));  // over limit
+
+    std::vector<uint8_t> broken = jpeg;
+    broken[2] = 0x12;  // not a marker
+    TEST_ASSERT_EQUAL(0, JpegHeaderElider::findPreamble(broken.data(), broken.size()));
+    broken = jpeg;
+    broken[3] = 0xD0;  // RST0 before the scan
+    TEST_ASSERT_EQUAL(0, JpegHeaderElider::findPreamble(broken.data(), broken.size()));
+
+    // Fill bytes between segments are allowed
+    std::vector<uint8_t> filled = jpeg;
+    filled.insert(filled.begin() + 2, 0xFF);
+    TEST_ASSERT_EQUAL(preamble + 1, JpegHeaderElider::findPreamble(filled.data(), filled.size()));
+}
+
+// ========================================
+// Epochs
+// ========================================
+
+void test_header_sent_once_per_epoch(void) {
+    JpegHeaderElider elider;
+    std::vector<uint8_t> first = makeJpeg(480, 320, 25, 1);
+    std::vector<uint8_t> second = makeJpeg(480, 320, 25, 2);
+    TEST_ASSERT_TRUE(first != second);
+
+    CompactFrame frame = elider.prepare(first.data(), first.size());
+    TEST_ASSERT_EQUAL(CompactMode::Define, frame.mode);
+    TEST_ASSERT_EQUAL(1, frame.headerId);
+    TEST_ASSERT_EQUAL(0, frame.skip);
+
+    for (int i = 0; i < 3; i++) {
+        frame = elider.prepare(second.data(), second.size());
+        TEST_ASSERT_EQUAL(CompactMode::Elided, frame.mode);
+        TEST_ASSERT_EQUAL(1, frame.headerId);
+        TEST_ASSERT_EQUAL(sosEnd(second), frame.skip);
+    }
+
+    JpegElisionStats stats = elider.getStats();
+    TEST_ASSERT_EQUAL(4, stats.frames);
+    TEST_ASSERT_EQUAL(3, stats.elided);
+    TEST_ASSERT_EQUAL(1, stats.defined);
+    TEST_ASSERT_EQUAL(3 * sosEnd(second), stats.bytesSaved);
+    TEST_ASSERT_EQUAL(sosEnd(second), stats.preambleLength);
+}
+
+void test_header_change_starts_new_epoch(void) {
+    JpegHeaderElider elider;
+    std::vector<uint8_t> hvga = makeJpeg(480, 320, 25, 1);
+    std::vector<uint8_t> betterQuality = makeJpeg(480, 320, 12, 1);
+    std::vector<uint8_t> vga = makeJpeg(640, 480, 25, 1);
+
+    TEST_ASSERT_EQUAL(CompactMode::Define, elider.prepare(hvga.data(), hvga.size()).mode);
+    TEST_ASSERT_EQUAL(CompactMode::Elided, elider.prepare(hvga.data(), hvga.size()).mode);
+
+    // Quality changes DQT, frame size changes SOF: both define a new header first
+    CompactFrame frame = elider.prepare(betterQuality.data(), betterQuality.size());
+    TEST_ASSERT_EQUAL(CompactMode::Define, frame.mode);
+    TEST_ASSERT_EQUAL(2, frame.headerId);
+    frame = elider.prepare(vga.data(), vga.size());
+    TEST_ASSERT_EQUAL(CompactMode::Define, frame.mode);
+    TEST_ASSERT_EQUAL(3, frame.headerId);
+
+    // Only the current epoch is kept: going back defines yet another ID
+    frame = elider.prepare(hvga.data(), hvga.size());
+    TEST_ASSERT_EQUAL(CompactMode::Define, frame.mode);
+    TEST_ASSERT_EQUAL(4, frame.headerId);
+}
+
+void test_invalidate_defines_again(void) {
+    JpegHeaderElider elider;
+    std::vector<uint8_t> jpeg = makeJpeg(320, 240, 12, 1);
+    elider.prepare(jpeg.data(), jpeg.size());
+    TEST_ASSERT_EQUAL(CompactMode::Elided, elider.prepare(jpeg.data(), jpeg.size()).mode);
+
+    elider.invalidate();
+    CompactFrame frame = elider.prepare(jpeg.data(), jpeg.size());
+    TEST_ASSERT_EQUAL(CompactMode::Define, frame.mode);
+    TEST_ASSERT_EQUAL(2, frame.headerId);  // a new ID, so a stale receiver cannot match it
+    TEST_ASSERT_EQUAL(CompactMode::Elided, elider.prepare(jpeg.data(), jpeg.size()).mode);
+}
+
+void test_unusable_frames_go_out_whole(void) {
+    JpegHeaderElider elider;
+    std::vector<uint8_t> jpeg = makeJpeg(320, 240, 12, 1);
+    elider.prepare(jpeg.data(), jpeg.size());
+
+    // Preamble longer than kMaxJpegPreamble (e.g. a large APP segment)
+    std::vector<uint8_t> large = jpeg;
+    std::vector<uint8_t> app = {0xFF, 0xE1, 0x05, 0x02};
+    app.resize(2 + 0x0502, 0x41);
+    large.insert(large.begin() + 2, app.begin(), app.end());
+    CompactFrame frame = elider.prepare(large.data(), large.size());
+    TEST_ASSERT_EQUAL(CompactMode::Full, frame.mode);
+    TEST_ASSERT_EQUAL(0, frame.headerId);
+
+    // Not a JPEG
+    std::vector<uint8_t> garbage(1000, 0x55);
+    TEST_ASSERT_EQUAL(CompactMode::Full, elider.prepare(garbage.data(), garbage.size()).mode);
+
+    // The epoch survives frames that could not use it
+    TEST_ASSERT_EQUAL(CompactMode::Elided, elider.prepare(jpeg.data(), jpeg.size()).mode);
+    TEST_ASSERT_EQUAL(2, elider.getStats().full);
+}
+
+// ========================================
+// Reconstruction
+// ========================================
+
+void test_rebuild_is_byte_identical(void) {
+    struct Case {
+        int width, height, quality;
+        FixtureSampling sampling;
+        uint16_t restartInterval;
+    };
+    static const Case cases[] = {
+        {320, 240, 12, FixtureSampling::Yuv422, 0},
+        {480, 320, 25, FixtureSampling::Yuv422, 0},
+        {640, 480, 10, FixtureSampling::Yuv420, 0},
+        {640, 480, 40, FixtureSampling::Yuv422, 8},
+        {160, 120, 6, FixtureSampling::Gray, 0},
+    };
+    JpegHeaderElider elider;
+    JpegHeaderRebuilder rebuilder;
+    uint32_t elided = 0;
+    for (const Case& c : cases) {
+        for (uint32_t seed = 1; seed <= 5; seed++) {
+            std::vector<uint8_t> jpeg = makeJpeg(c.width, c.height, c.quality, seed, c.sampling, c.restartInterval);
+            CompactFrame frame;
+            std::vector<uint8_t> rebuilt = roundTrip(elider, rebuilder, jpeg, frame);
+            TEST_ASSERT_EQUAL(seed == 1 ? CompactMode::Define : CompactMode::Elided, frame.mode);
+            TEST_ASSERT_EQUAL(jpeg.size(), rebuilt.size());
+            TEST_ASSERT_TRUE(memcmp(jpeg.data(), rebuilt.data(), jpeg.size()) == 0);
+            elided += frame.mode == CompactMode::Elided;
+        }
+    }
+    TEST_ASSERT_EQUAL(20, elided);
+}
+
+void test_rebuilder_refuses_unknown_headers(void) {
+    JpegHeaderElider elider;
+    JpegHeaderRebuilder rebuilder;
+    std::vector<uint8_t> jpeg = makeJpeg(320, 240, 12, 1);
+    uint8_t out[32 * 1024];
+
+    // Define frame lost: the first elided frame cannot be rebuilt
+    CompactFrame frame = elider.prepare(jpeg.data(), jpeg.size());
+    frame = elider.prepare(jpeg.data(), jpeg.size());
+    TEST_ASSERT_EQUAL(CompactMode::Elided, frame.mode);
+    TEST_ASSERT_FALSE(rebuilder.knows(frame.headerId));
+    TEST_ASSERT_EQUAL(0, rebuilder.rebuild(frame.headerId, jpeg.data() + frame.skip, jpeg.size() - frame.skip,
+                                           out, sizeof(out)));
+
+    // Receiver asks for a new epoch
+    elider.invalidate();
+    frame = elider.prepare(jpeg.data(), jpeg.size());
+    TEST_ASSERT_TRUE(rebuilder.learn(frame.headerId, jpeg.data(), jpeg.size()));
+    frame = elider.prepare(jpeg.data(), jpeg.size());
+    TEST_ASSERT_EQUAL(jpeg.size(), rebuilder.rebuild(frame.headerId, jpeg.data() + frame.skip,
+                                                     jpeg.size() - frame.skip, out, sizeof(out)));
+    TEST_ASSERT_EQUAL(0, rebuilder.rebuild(frame.headerId - 1, jpeg.data() + frame.skip,
+                                           jpeg.size() - frame.skip, out, sizeof(out)));
+    TEST_ASSERT_EQUAL(0, rebuilder.rebuild(frame.headerId, jpeg.data() + frame.skip, jpeg.size() - frame.skip,
+                                           out, jpeg.size() - 1));
+
+    // Reconnect: forgotten, and ID 0 / unusable frames are never learned
+    rebuilder.reset();
+    TEST_ASSERT_FALSE(rebuilder.knows(frame.headerId));
+    TEST_ASSERT_FALSE(rebuilder.learn(0, jpeg.data(), jpeg.size()));
+    TEST_ASSERT_FALSE(rebuilder.learn(5, jpeg.data() + 2, jpeg.size() - 2));
+    TEST_ASSERT_FALSE(rebuilder.knows(0));
+}
+
+// ========================================
+// Benchmark
+// ========================================
+
+void test_benchmark(void) {
+    struct Profile {
+        const char* name;
+        int width, height, quality;
+    };
+    // ABR ladder rungs and the boot profile
+    static const Profile profiles[] = {
+        {"QVGA q30", 320, 240, 30},
+        {"HVGA q25", 480, 320, 25},
+        {"VGA  q12", 640, 480, 12},
+        {"SVGA q12", 800, 600, 12},
+    };
+    const uint32_t fps = 10;
+    const uint32_t framesPerProfile = 20;
+
+    printf("\n  OV2640-like fixtures, %u frames each, upload at %u FPS\n", framesPerProfile, fps);
+    printf("  %-10s %9s %11s %9s %11s\n", "profile", "preamble", "avg frame", "saved", "kbps saved");
+    double prepareUs = 0;
+    double rebuildUs = 0;
+    uint32_t timed = 0;
+    for (const Profile& p : profiles) {
+        JpegHeaderElider elider;
+        JpegHeaderRebuilder rebuilder;
+        std::vector<std::vector<uint8_t>> frames;
+        for (uint32_t i = 0; i < framesPerProfile; i++) {
+            frames.push_back(makeJpeg(p.width, p.height, p.quality, i + 1));
+        }
+        std::vector<uint8_t> out(frames[0].size() * 2);
+        uint64_t sent = 0;
+        for (const std::vector<uint8_t>& jpeg : frames) {
+            auto start = std::chrono::steady_clock::now();
+            CompactFrame frame = elider.prepare(jpeg.data(), jpeg.size());
+            auto prepared = std::chrono::steady_clock::now();
+            if (frame.mode == CompactMode::Define) {
+                rebuilder.learn(frame.headerId, jpeg.data(), jpeg.size());
+            } else {
+                if (out.size() < jpeg.size()) out.resize(jpeg.size());
+                rebuilder.rebuild(frame.headerId, jpeg.data() + frame.skip, jpeg.size() - frame.skip,
+                                  out.data(), out.size());
+                auto rebuilt = std::chrono::steady_clock::now();
+                prepareUs += std::chrono::duration<double, std::micro>(prepared - start).count();
+                rebuildUs += std::chrono::duration<double, std::micro>(rebuilt - prepared).count();
+                timed++;
+            }
+            sent += jpeg.size() - frame.skip;
+        }
+        JpegElisionStats stats = elider.getStats();
+        double avgFrame = (double)stats.bytesIn / stats.frames;
+        double saved = 100.0 * stats.bytesSaved / stats.bytesIn;
+        double kbpsSaved = stats.preambleLength * 8.0 * fps / 1000.0;
+        printf("  %-10s %7u B %9.0f B %8.2f%% %11.1f\n", p.name, stats.preambleLength, avgFrame, saved, kbpsSaved);
+        TEST_ASSERT_EQUAL(framesPerProfile - 1, stats.elided);
+        TEST_ASSERT_EQUAL(stats.bytesIn - stats.bytesSaved, sent);
+    }
+    printf("  prepare %.2f us/frame, rebuild %.2f us/frame\n", prepareUs / timed, rebuildUs / timed);
+}
+
+int main(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+    UNITY_BEGIN();
+    RUN_TEST(test_preamble_ends_after_sos);
+    RUN_TEST(test_preamble_rejects_malformed);
+    RUN_TEST(test_header_sent_once_per_epoch);
+    RUN_TEST(test_header_change_starts_new_epoch);
+    RUN_TEST(test_invalidate_defines_again);
+    RUN_TEST(test_unusable_frames_go_out_whole);
+    RUN_TEST(test_rebuild_is_byte_identical);
+    RUN_TEST(test_rebuilder_refuses_unknown_headers);
+    RUN_TEST(test_benchmark);
+    return UNITY_END();
+}
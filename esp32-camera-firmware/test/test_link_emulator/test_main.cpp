@@ -0,0 +1,138 @@
+/**
+ * `test_main.cpp`
+ * - Unit tests for LinkEmulator (native host build)
+ * - Run: pio test -e native -f test_link_emulator
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#include <unity.h>
+
+#include "LinkEmulator.h"
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_unlimited_link_delivers_after_delay() {
+    LinkConfig config;
+    config.delayMs = 20;
+    LinkEmulator link(config);
+
+    LinkSend send = link.send(30000, 1000000);
+    TEST_ASSERT_EQUAL_UINT64(1000000, send.unblockUs);
+    TEST_ASSERT_EQUAL_UINT64(1020000, send.deliverUs);
+    TEST_ASSERT_EQUAL_UINT64(1020000, link.receive(1000000));
+}
+
+void test_bandwidth_limits_throughput_and_blocks_sender() {
+    LinkConfig config;
+    config.bandwidthKbps = 1000;       // 125 bytes/ms
+    config.sendBufferBytes = 5000;     // 40 ms of data
+    LinkEmulator link(config);
+
+    // 25 kB takes 200 ms on the wire; send() returns when 5 kB are left
+    LinkSend first = link.send(25000, 0);
+    TEST_ASSERT_EQUAL_UINT64(160000, first.unblockUs);
+    TEST_ASSERT_EQUAL_UINT64(200000, first.deliverUs);
+
+    // A frame sent right away queues behind the first one
+    LinkSend second = link.send(25000, first.unblockUs);
+    TEST_ASSERT_EQUAL_UINT64(400000, second.deliverUs);
+    TEST_ASSERT_EQUAL_UINT64(360000, second.unblockUs);
+
+    // Small message into an idle link never blocks
+    LinkSend small = link.send(100, 1000000);
+    TEST_ASSERT_EQUAL_UINT64(1000000, small.unblockUs);
+    TEST_ASSERT_EQUAL_UINT64(1000800, small.deliverUs);
+
+    LinkStats stats = link.getStats();
+    TEST_ASSERT_EQUAL_UINT32(3, stats.messages);
+    TEST_ASSERT_EQUAL_UINT64(50100, stats.bytes);
+    TEST_ASSERT_EQUAL_UINT64(160000 + 200000, stats.blockedUs);
+}
+
+void test_jitter_is_bounded_and_order_is_kept() {
+    LinkConfig config;
+    config.delayMs = 30;
+    config.jitterMs = 40;
+    config.seed = 7;
+
+    // Sparse messages: delivery = delay + uniform jitter
+    LinkEmulator sparse(config);
+    uint64_t minExtra = UINT64_MAX;
+    uint64_t maxExtra = 0;
+    for (uint32_t i = 0; i < 1000; i++) {
+        uint64_t now = (uint64_t)i * 100000;
+        uint64_t extra = sparse.send(1000, now).deliverUs - now - 30000;
+        if (extra < minExtra) minExtra = extra;
+        if (extra > maxExtra) maxExtra = extra;
+    }
+    TEST_ASSERT_TRUE(minExtra < 1000);
+    TEST_ASSERT_TRUE(maxExtra <= 40000);
+    TEST_ASSERT_TRUE(maxExtra > 39000);
+
+    // Back-to-back messages: jitter never reorders the stream
+    LinkEmulator burst(config);
+    uint64_t last = 0;
+    for (uint32_t i = 0; i < 1000; i++) {
+        uint64_t now = (uint64_t)i * 5000;
+        LinkSend send = burst.send(1000, now);
+        TEST_ASSERT_TRUE(send.deliverUs >= last);
+        TEST_ASSERT_TRUE(send.deliverUs >= now + 30000);
+        last = send.deliverUs;
+    }
+}
+
+void test_loss_costs_retransmission_timeouts() {
+    LinkConfig config;
+    config.lossPercent = 5.0f;
+    config.rtoMs = 200;
+    config.seed = 3;
+    LinkEmulator link(config);
+
+    // 2000 × 21 segments: expect ~5% retransmitted
+    uint32_t delayed = 0;
+    for (uint32_t i = 0; i < 2000; i++) {
+        uint64_t now = (uint64_t)i * 1000000;
+        LinkSend send = link.send(30000, now);
+        TEST_ASSERT_EQUAL_UINT64((uint64_t)send.retransmits * 200000, send.deliverUs - now);
+        if (send.retransmits > 0) delayed++;
+    }
+    LinkStats stats = link.getStats();
+    TEST_ASSERT_EQUAL_UINT32(2000 * 21, stats.segments);
+    TEST_ASSERT_TRUE(stats.retransmits > 2000 * 21 * 4 / 100);
+    TEST_ASSERT_TRUE(stats.retransmits < 2000 * 21 * 6 / 100);
+    // P(frame hit) = 1 - 0.95^21 ≈ 66%
+    TEST_ASSERT_TRUE(delayed > 1200 && delayed < 1450);
+}
+
+void test_same_seed_replays_identically() {
+    LinkConfig config;
+    config.bandwidthKbps = 2000;
+    config.jitterMs = 15;
+    config.lossPercent = 2.0f;
+    config.seed = 99;
+    LinkEmulator a(config);
+    LinkEmulator b(config);
+    for (uint32_t i = 0; i < 200; i++) {
+        LinkSend sa = a.send(8000 + i * 10, (uint64_t)i * 40000);
+        LinkSend sb = b.send(8000 + i * 10, (uint64_t)i * 40000);
+        TEST_ASSERT_EQUAL_UINT64(sa.deliverUs, sb.deliverUs);
+        TEST_ASSERT_EQUAL_UINT64(sa.unblockUs, sb.unblockUs);
+    }
+}
+
+int main(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+    UNITY_BEGIN();
+    RUN_TEST(test_unlimited_link_delivers_after_delay);
+    RUN_TEST(test_bandwidth_limits_throughput_and_blocks_sender);
+    RUN_TEST(test_jitter_is_bounded_and_order_is_kept);
+    RUN_TEST(test_loss_costs_retransmission_timeouts);
+    RUN_TEST(test_same_seed_replays_identically);
+    return UNITY_END();
+}
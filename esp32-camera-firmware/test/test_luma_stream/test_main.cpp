@@ -0,0 +1,567 @@
+/**
+ * `test_main.cpp`
+ * - Unit tests and benchmark for LumaStream (native host build): area resampler, "LUM"
+ *   header, delta codec (round trip, deadband without drift, malformed payloads), key plane
+ *   rules of the side-stream and a receiver following it
+ * - The end-to-end case starts from a JPEG DC thumbnail (../test_motion_gate/jpeg_fixture.h),
+ *   the plane source on the device
+ * - Run: pio test -e native -f test_luma_stream
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#include <unity.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <chrono>
+#include <vector>
+
+#include "JpegDcDecoder.h"
+#include "LumaStream.h"
+#include "../test_motion_gate/jpeg_fixture.h"
+
+static const uint16_t W = 80;
+static const uint16_t H = 60;
+static const size_t PIXELS = (size_t)W * H;
+
+void setUp(void) {}
+void tearDown(void) {}
+
+static std::vector<uint8_t> resampled(const std::vector<uint8_t>& src, uint16_t srcWidth, uint16_t srcHeight,
+                                      uint16_t dstWidth, uint16_t dstHeight) {
+    std::vector<uint8_t> dst((size_t)dstWidth * dstHeight);
+    std::vector<uint32_t> scratch(2 * dstWidth);
+    LumaCodec::resample(src.data(), srcWidth, srcHeight, dst.data(), dstWidth, dstHeight, scratch.data());
+    return dst;
+}
+
+/**
+ * Reference area average in doubles
+ */
+static double areaMean(const std::vector<uint8_t>& src, int srcWidth, int srcHeight, int dstWidth, int dstHeight,
+                       int x, int y) {
+    double x0 = (double)x * srcWidth / dstWidth, x1 = (double)(x + 1) * srcWidth / dstWidth;
+    double y0 = (double)y * srcHeight / dstHeight, y1 = (double)(y + 1) * srcHeight / dstHeight;
+    double sum = 0;
+    for (int j = (int)y0; j < srcHeight && j < y1; j++) {
+        double wy = (j + 1 < y1 ? j + 1 : y1) - (j > y0 ? j : y0);
+        for (int i = (int)x0; i < srcWidth && i < x1; i++) {
+            double wx = (i + 1 < x1 ? i + 1 : x1) - (i > x0 ? i : x0);
+            sum += wx * wy * src[(size_t)j * srcWidth + i];
+        }
+    }
+    return sum / ((x1 - x0) * (y1 - y0));
+}
+
+static std::vector<uint8_t> randomPlane(FixtureRandom& rnd, size_t pixels) {
+    std::vector<uint8_t> plane(pixels);
+    for (uint8_t& v : plane) v = (uint8_t)rnd.next(256);
+    return plane;
+}
+
+/**
+ * Receiver: follows the messages of a stream like the analyzer does
+ */
+struct LumaReceiver {
+    std::vector<uint8_t> plane;
+    bool valid = false;
+    uint32_t nextSequence = 0;
+    uint32_t planes = 0;
+    uint32_t waited = 0;           // deltas dropped while waiting for a key plane
+
+    bool receive(const uint8_t* data, size_t length) {
+        LumaHeader header;
+        if (!LumaCodec::decodeHeader(data, length, header)) {
+            return false;
+        }
+        size_t pixels = (size_t)header.width * header.height;
+        bool key = (header.flags & kLumaKey) != 0;
+        if (key) {
+            plane.assign(pixels, 0);
+        } else if (!valid || header.sequence != nextSequence || plane.size() != pixels) {
+            valid = false;
+            waited++;
+            return false;
+        }
+        nextSequence = header.sequence + 1;
+        valid = LumaCodec::decodeDelta(data + header.headerLength, header.payloadLength, plane.data(), pixels);
+        planes += valid ? 1 : 0;
+        return valid;
+    }
+};
+
+static int maxError(const uint8_t* a, const uint8_t* b, size_t pixels) {
+    int worst = 0;
+    for (size_t i = 0; i < pixels; i++) {
+        int error = abs((int)a[i] - (int)b[i]);
+        if (error > worst) worst = error;
+    }
+    return worst;
+}
+
+// ========================================
+// Resampler
+// ========================================
+void test_resample_uniform_and_identity(void) {
+    std::vector<uint8_t> flat(100 * 75, 137);
+    std::vector<uint8_t> down = resampled(flat, 100, 75, W, H);
+    for (uint8_t v : down) TEST_ASSERT_EQUAL_UINT8(137, v);
+    std::vector<uint8_t> up = resampled(std::vector<uint8_t>(12 * 12, 9), 12, 12, W, H);
+    for (uint8_t v : up) TEST_ASSERT_EQUAL_UINT8(9, v);
+
+    FixtureRandom rnd(7);
+    std::vector<uint8_t> source = randomPlane(rnd, PIXELS);
+    TEST_ASSERT_EQUAL_MEMORY(source.data(), resampled(source, W, H, W, H).data(), PIXELS);
+}
+
+void test_resample_integer_ratios(void) {
+    // 2:1 down = rounded 2 × 2 means; 1:2 up = each pixel replicated
+    FixtureRandom rnd(11);
+    std::vector<uint8_t> source = randomPlane(rnd, 160 * 120);
+    std::vector<uint8_t> down = resampled(source, 160, 120, W, H);
+    for (int y = 0; y < H; y++) {
+        for (int x = 0; x < W; x++) {
+            int sum = source[(2 * y) * 160 + 2 * x] + source[(2 * y) * 160 + 2 * x + 1] +
+                      source[(2 * y + 1) * 160 + 2 * x] + source[(2 * y + 1) * 160 + 2 * x + 1];
+            TEST_ASSERT_EQUAL_UINT8((sum + 2) / 4, down[y * W + x]);
+        }
+    }
+
+    std::vector<uint8_t> small = randomPlane(rnd, 40 * 30);
+    std::vector<uint8_t> up = resampled(small, 40, 30, W, H);
+    for (int y = 0; y < H; y++) {
+        for (int x = 0; x < W; x++) {
+            TEST_ASSERT_EQUAL_UINT8(small[(y / 2) * 40 + x / 2], up[y * W + x]);
+        }
+    }
+}
+
+void test_resample_matches_area_average(void) {
+    // Thumbnail sizes of the ladder (QQVGA .. UXGA): exact overlap weights, rounded once
+    static const uint16_t sizes[][2] = {{20, 15}, {30, 22}, {50, 37}, {100, 75}, {128, 96}, {160, 128}, {200, 150}};
+    FixtureRandom rnd(23);
+    for (const auto& size : sizes) {
+        std::vector<uint8_t> source = randomPlane(rnd, (size_t)size[0] * size[1]);
+        std::vector<uint8_t> plane = resampled(source, size[0], size[1], W, H);
+        for (int y = 0; y < H; y++) {
+            for (int x = 0; x < W; x++) {
+                double expected = areaMean(source, size[0], size[1], W, H, x, y);
+                TEST_ASSERT_TRUE_MESSAGE(fabs(expected - plane[y * W + x]) <= 0.5 + 1e-9, "area average");
+            }
+        }
+    }
+}
+
+void test_plane_from_dc_thumbnail(void) {
+    // SVGA frame → 100 × 75 DC thumbnail → 80 × 60 plane: within the DC quantization of the plane
+    // resampled from exact 8 × 8 block means
+    Scene scene = makeFrame(makeBackground(800, 600), 3, 2, 0, 300, 200, 160, 240);
+    FixtureEncoder encoder(60, FixtureSampling::Yuv422);
+    std::vector<uint8_t> jpeg = encoder.encode(scene);
+    std::vector<uint8_t> thumbnail(100 * 75);
+    JpegDcDecoder decoder;
+    TEST_ASSERT_EQUAL(JpegDcError::None, decoder.decode(jpeg.data(), jpeg.size(), thumbnail.data(), thumbnail.size()));
+    TEST_ASSERT_EQUAL(100, decoder.getWidthBlocks());
+    TEST_ASSERT_EQUAL(75, decoder.getHeightBlocks());
+
+    std::vector<uint8_t> blockMeans(100 * 75);
+    for (int by = 0; by < 75; by++) {
+        for (int bx = 0; bx < 100; bx++) {
+            int sum = 0;
+            for (int i = 0; i < 64; i++) sum += scene.at(bx * 8 + i % 8, by * 8 + i / 8);
+            blockMeans[by * 100 + bx] = (uint8_t)((sum + 32) / 64);
+        }
+    }
+    std::vector<uint8_t> plane = resampled(thumbnail, 100, 75, W, H);
+    std::vector<uint8_t> exact = resampled(blockMeans, 100, 75, W, H);
+    TEST_ASSERT_LESS_OR_EQUAL(encoder.lumaDcQuant() / 8 + 1, maxError(plane.data(), exact.data(), PIXELS));
+
+    // Away from edges the plane is the frame averaged over the same area
+    int x = 10, y = 50;
+    TEST_ASSERT_INT_WITHIN(3, (int)(areaMean(scene.y, 800, 600, W, H, x, y) + 0.5), plane[y * W + x]);
+}
+
+// ========================================
+// Header
+// ========================================
+void test_header_round_trip(void) {
+    LumaHeader header = {};
+    header.flags = kLumaKey | kLumaClockSynced;
+    header.deadband = 2;
+    header.frameSize = 9;
+    header.sequence = 0xA1B2C3D4;
+    header.captureUs = 0x0102030405060708ULL;
+    header.clockOffsetUs = -123456789;
+    header.width = W;
+    header.height = H;
+    header.payloadLength = 3;
+    uint8_t message[LumaCodec::kHeaderSize + 3] = {};
+    TEST_ASSERT_EQUAL(0, LumaCodec::encodeHeader(header, message, LumaCodec::kHeaderSize - 1));
+    TEST_ASSERT_EQUAL(LumaCodec::kHeaderSize, LumaCodec::encodeHeader(header, message, sizeof(message)));
+    TEST_ASSERT_TRUE(LumaCodec::isLuma(message, sizeof(message)));
+
+    LumaHeader decoded = {};
+    TEST_ASSERT_TRUE(LumaCodec::decodeHeader(message, sizeof(message), decoded));
+    TEST_ASSERT_EQUAL(1, decoded.version);
+    TEST_ASSERT_EQUAL(LumaCodec::kHeaderSize, decoded.headerLength);
+    TEST_ASSERT_EQUAL(kLumaKey | kLumaClockSynced, decoded.flags);
+    TEST_ASSERT_EQUAL(2, decoded.deadband);
+    TEST_ASSERT_EQUAL(9, decoded.frameSize);
+    TEST_ASSERT_TRUE(decoded.sequence == 0xA1B2C3D4);
+    TEST_ASSERT_TRUE(decoded.captureUs == 0x0102030405060708ULL);
+    TEST_ASSERT_TRUE(decoded.clockOffsetUs == -123456789);
+    TEST_ASSERT_EQUAL(W, decoded.width);
+    TEST_ASSERT_EQUAL(H, decoded.height);
+    TEST_ASSERT_EQUAL(3, decoded.payloadLength);
+
+    // Truncated payload, frame envelope magic, short header length
+    TEST_ASSERT_FALSE(LumaCodec::decodeHeader(message, sizeof(message) - 1, decoded));
+    message[0] = 'C';
+    TEST_ASSERT_FALSE(LumaCodec::isLuma(message, sizeof(message)));
+    message[0] = 'L';
+    message[4] = LumaCodec::kHeaderSize - 1;
+    TEST_ASSERT_FALSE(LumaCodec::decodeHeader(message, sizeof(message), decoded));
+}
+
+// ========================================
+// Delta Codec
+// ========================================
+void test_delta_round_trip_lossless(void) {
+    FixtureRandom rnd(31);
+    std::vector<uint8_t> reference(PIXELS, 0), decoded(PIXELS, 0);
+    std::vector<uint8_t> payload(LumaCodec::maxPayload(PIXELS));
+
+    // Worst case: noise against the zero plane fills the bound exactly
+    std::vector<uint8_t> plane = randomPlane(rnd, PIXELS);
+    for (uint8_t& v : plane) v = (uint8_t)(v | 0x80);
+    size_t length = LumaCodec::encodeDelta(plane.data(), reference.data(), PIXELS, 0, payload.data(), payload.size());
+    TEST_ASSERT_EQUAL(LumaCodec::maxPayload(PIXELS), length);
+    TEST_ASSERT_TRUE(LumaCodec::decodeDelta(payload.data(), length, decoded.data(), PIXELS));
+    TEST_ASSERT_EQUAL_MEMORY(plane.data(), decoded.data(), PIXELS);
+    TEST_ASSERT_EQUAL_MEMORY(plane.data(), reference.data(), PIXELS);
+
+    // Sparse changes, wrap-around deltas, changes at both ends
+    for (int frame = 0; frame < 20; frame++) {
+        for (int k = 0; k < 40; k++) {
+            size_t i = (size_t)rnd.next((int)PIXELS);
+            plane[i] = (uint8_t)(plane[i] + 128 + rnd.next(3));
+        }
+        plane[0] ^= 0x55;
+        plane[PIXELS - 1] ^= 0xAA;
+        length = LumaCodec::encodeDelta(plane.data(), reference.data(), PIXELS, 0, payload.data(), payload.size());
+        TEST_ASSERT_TRUE(LumaCodec::decodeDelta(payload.data(), length, decoded.data(), PIXELS));
+        TEST_ASSERT_EQUAL_MEMORY(plane.data(), decoded.data(), PIXELS);
+        TEST_ASSERT_LESS_THAN(200, length);
+    }
+
+    // Unchanged plane: one run token per 128 pixels
+    length = LumaCodec::encodeDelta(plane.data(), reference.data(), PIXELS, 0, payload.data(), payload.size());
+    TEST_ASSERT_EQUAL((PIXELS + 127) / 128, length);
+    TEST_ASSERT_EQUAL(0, LumaCodec::encodeDelta(plane.data(), reference.data(), PIXELS, 0, payload.data(), 10));
+}
+
+void test_deadband_bounds_error_without_drift(void) {
+    // ±1 sensor noise, then a slow brightening by 1 per plane: the noise never leaves the
+    // deadband, the accumulated brightening does and is sent before the error exceeds it
+    const uint8_t deadband = 2;
+    FixtureRandom rnd(41);
+    std::vector<uint8_t> base = randomPlane(rnd, PIXELS);
+    for (uint8_t& v : base) v = (uint8_t)(40 + v / 2);
+    std::vector<uint8_t> reference(PIXELS, 0), decoded(PIXELS, 0), plane(PIXELS);
+    std::vector<uint8_t> payload(LumaCodec::maxPayload(PIXELS));
+    for (int frame = 0; frame < 40; frame++) {
+        int brightening = frame < 20 ? 0 : frame - 19;
+        for (size_t i = 0; i < PIXELS; i++) {
+            plane[i] = (uint8_t)(base[i] + brightening + rnd.next(3) - 1);
+        }
+        size_t length = LumaCodec::encodeDelta(plane.data(), reference.data(), PIXELS, deadband, payload.data(),
+                                               payload.size());
+        TEST_ASSERT_TRUE(LumaCodec::decodeDelta(payload.data(), length, decoded.data(), PIXELS));
+        TEST_ASSERT_EQUAL_MEMORY(reference.data(), decoded.data(), PIXELS);
+        TEST_ASSERT_LESS_OR_EQUAL(deadband, maxError(plane.data(), decoded.data(), PIXELS));
+        if (frame > 0 && frame < 20) {
+            TEST_ASSERT_EQUAL((PIXELS + 127) / 128, length);  // run tokens only
+        }
+    }
+}
+
+void test_decoder_rejects_malformed_payloads(void) {
+    std::vector<uint8_t> plane(PIXELS, 0);
+    const uint8_t tooLong[] = {0x7F, 0x7F, 0x7F, 0x7F, 0x7F, 0x7F, 0x7F, 0x7F, 0x7F, 0x7F, 0x7F, 0x7F, 0x7F,
+                               0x7F, 0x7F, 0x7F, 0x7F, 0x7F, 0x7F, 0x7F, 0x7F, 0x7F, 0x7F, 0x7F, 0x7F, 0x7F,
+                               0x7F, 0x7F, 0x7F, 0x7F, 0x7F, 0x7F, 0x7F, 0x7F, 0x7F, 0x7F, 0x7F, 0x7F};
+    TEST_ASSERT_FALSE(LumaCodec::decodeDelta(tooLong, sizeof(tooLong), plane.data(), PIXELS));
+    const uint8_t tooShort[] = {0x7F};
+    TEST_ASSERT_FALSE(LumaCodec::decodeDelta(tooShort, sizeof(tooShort), plane.data(), PIXELS));
+    const uint8_t truncatedLiterals[] = {0x83, 1, 2};
+    TEST_ASSERT_FALSE(LumaCodec::decodeDelta(truncatedLiterals, sizeof(truncatedLiterals), plane.data(), 4));
+    const uint8_t exact[] = {0x83, 1, 2, 3, 4};
+    TEST_ASSERT_TRUE(LumaCodec::decodeDelta(exact, sizeof(exact), plane.data(), 4));
+    TEST_ASSERT_EQUAL_UINT8(4, plane[3]);
+}
+
+// ========================================
+// Side-Stream
+// ========================================
+static bool sendNext(LumaStream& stream, LumaReceiver& receiver, bool delivered, LumaHeader* header = NULL) {
+    uint8_t* message = NULL;
+    size_t length = 0;
+    if (!stream.encode(false, 0, message, length)) {
+        return false;
+    }
+    if (header != NULL) {
+        TEST_ASSERT_TRUE(LumaCodec::decodeHeader(message, length, *header));
+    }
+    if (delivered) {
+        receiver.receive(message, length);
+    }
+    stream.commit(delivered, length);
+    return true;
+}
+
+void test_plane_never_upscaled(void) {
+    // Thumbnails (frame / 8) smaller than the configured plane are sent as they are; larger ones
+    // shrink to fit with the source aspect ratio
+    struct Case {
+        uint16_t srcWidth, srcHeight, width, height;
+    };
+    static const Case cases[] = {
+        {60, 40, 60, 40},      // HVGA: 3:2 kept, not stretched to 4:3
+        {40, 30, 40, 30},      // QVGA
+        {80, 60, 80, 60},      // VGA
+        {100, 75, 80, 60},     // SVGA
+        {200, 150, 80, 60},    // UXGA
+        {160, 90, 80, 45},     // HD 16:9
+        {160, 128, 75, 60},    // SXGA 5:4
+        {30, 100, 18, 60},     // portrait crop
+        {640, 1, 80, 1},       // never 0
+    };
+    for (const Case& c : cases) {
+        uint16_t width = 0, height = 0;
+        LumaCodec::fitSize(c.srcWidth, c.srcHeight, 80, 60, width, height);
+        TEST_ASSERT_EQUAL(c.width, width);
+        TEST_ASSERT_EQUAL(c.height, height);
+    }
+
+    // The stream sends an HVGA thumbnail pixel for pixel (lossless with deadband 0)
+    LumaStreamConfig config;
+    config.deadband = 0;
+    LumaStream stream(config);
+    LumaReceiver receiver;
+    FixtureRandom rnd(7);
+    std::vector<uint8_t> thumbnail = randomPlane(rnd, 60 * 40);
+    uint16_t width = 0, height = 0;
+    stream.getPlaneSize(width, height);
+    TEST_ASSERT_EQUAL(0, width);
+    TEST_ASSERT_TRUE(stream.publish(thumbnail.data(), 60, 40, 7, 0, 0));
+    LumaHeader header;
+    TEST_ASSERT_TRUE(sendNext(stream, receiver, true, &header));
+    TEST_ASSERT_EQUAL(60, header.width);
+    TEST_ASSERT_EQUAL(40, header.height);
+    TEST_ASSERT_EQUAL(60 * 40 + (60 * 40 + 127) / 128, header.payloadLength);  // key plane: one literal per pixel
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(thumbnail.data(), receiver.plane.data(), thumbnail.size());
+    stream.getPlaneSize(width, height);
+    TEST_ASSERT_EQUAL(60, width);
+    TEST_ASSERT_EQUAL(40, height);
+}
+
+void test_stream_interval_and_key_planes(void) {
+    LumaStreamConfig config;
+    config.intervalMs = 200;
+    config.keyInterval = 4;
+    LumaStream stream(config);
+    LumaReceiver receiver;
+    std::vector<uint8_t> thumbnail(40 * 30, 100);
+    LumaHeader header;
+
+    TEST_ASSERT_FALSE(stream.hasPending());
+    TEST_ASSERT_TRUE(stream.publish(thumbnail.data(), 40, 30, 5, 1000, 0));
+    TEST_ASSERT_FALSE(stream.publish(thumbnail.data(), 40, 30, 5, 2000, 199));  // interval not due
+    TEST_ASSERT_TRUE(sendNext(stream, receiver, true, &header));
+    TEST_ASSERT_EQUAL(kLumaKey, header.flags & kLumaKey);                       // first plane
+    TEST_ASSERT_EQUAL(5, header.frameSize);
+    TEST_ASSERT_EQUAL(40, header.width);                                         // not upscaled
+    TEST_ASSERT_TRUE(header.captureUs == 1000);
+    TEST_ASSERT_FALSE(sendNext(stream, receiver, true));                         // nothing pending
+
+    // Deltas up to keyInterval, then a key plane
+    uint32_t nowMs = 0;
+    for (int i = 1; i <= 4; i++) {
+        nowMs += 200;
+        TEST_ASSERT_TRUE(stream.publish(thumbnail.data(), 40, 30, 5, nowMs * 1000ULL, nowMs));
+        TEST_ASSERT_TRUE(sendNext(stream, receiver, true, &header));
+        TEST_ASSERT_EQUAL(i == 4 ? kLumaKey : 0, header.flags & kLumaKey);
+    }
+
+    // Failed send → key plane; the receiver waits for it instead of applying a delta to a stale plane
+    nowMs += 200;
+    stream.publish(thumbnail.data(), 40, 30, 5, 0, nowMs);
+    sendNext(stream, receiver, false);
+    nowMs += 200;
+    stream.publish(thumbnail.data(), 40, 30, 5, 0, nowMs);
+    TEST_ASSERT_TRUE(sendNext(stream, receiver, true, &header));
+    TEST_ASSERT_EQUAL(kLumaKey, header.flags & kLumaKey);
+
+    // Reconnect and source size change → key plane
+    stream.reset();
+    nowMs += 200;
+    stream.publish(thumbnail.data(), 40, 30, 5, 0, nowMs);
+    TEST_ASSERT_TRUE(sendNext(stream, receiver, true, &header));
+    TEST_ASSERT_EQUAL(kLumaKey, header.flags & kLumaKey);
+    std::vector<uint8_t> larger(80 * 60, 100);
+    nowMs += 200;
+    stream.publish(larger.data(), 80, 60, 8, 0, nowMs);
+    TEST_ASSERT_TRUE(sendNext(stream, receiver, true, &header));
+    TEST_ASSERT_EQUAL(kLumaKey, header.flags & kLumaKey);
+    TEST_ASSERT_EQUAL(8, header.frameSize);
+    TEST_ASSERT_EQUAL(80, header.width);
+    TEST_ASSERT_EQUAL(60, header.height);
+
+    // A newer plane replaces one not yet sent
+    nowMs += 200;
+    stream.publish(thumbnail.data(), 40, 30, 5, 0, nowMs);
+    nowMs += 200;
+    stream.publish(thumbnail.data(), 40, 30, 5, 0, nowMs);
+
+    // Off: nothing is taken, the waiting plane is dropped
+    stream.setInterval(0);
+    TEST_ASSERT_FALSE(stream.hasPending());
+    TEST_ASSERT_FALSE(stream.publish(thumbnail.data(), 40, 30, 5, 0, nowMs + 1000));
+
+    LumaStreamStats stats = stream.getStats();
+    TEST_ASSERT_EQUAL(11, stats.published);
+    TEST_ASSERT_EQUAL(8, stats.sent);
+    TEST_ASSERT_EQUAL(1, stats.failed);
+    TEST_ASSERT_EQUAL(1, stats.skipped);
+    TEST_ASSERT_EQUAL(5, stats.keyPlanes);
+    TEST_ASSERT_EQUAL(8, receiver.planes);
+}
+
+void test_receiver_follows_lossy_stream(void) {
+    // Moving object over a noisy scene; some sends fail; the receiver is never more than the
+    // deadband away once it holds a plane
+    LumaStreamConfig config;
+    config.intervalMs = 100;
+    config.keyInterval = 20;
+    config.deadband = 2;
+    LumaStream stream(config);
+    LumaReceiver receiver;
+    Scene background = makeBackground(100, 75);
+    std::vector<uint8_t> expected(PIXELS);
+    std::vector<uint32_t> scratch(2 * W);
+    uint32_t sent = 0;
+
+    for (int frame = 0; frame < 60; frame++) {
+        Scene scene = makeFrame(background, (uint32_t)frame, 2, 0, 5 + frame, 20, 12, 24);
+        TEST_ASSERT_TRUE(stream.publish(scene.y.data(), 100, 75, 9, (uint64_t)frame * 100000, (uint32_t)frame * 100));
+        LumaCodec::resample(scene.y.data(), 100, 75, expected.data(), W, H, scratch.data());
+        bool delivered = frame % 13 != 7;
+        sendNext(stream, receiver, delivered);
+        sent += delivered ? 1 : 0;
+        if (delivered && receiver.valid) {
+            TEST_ASSERT_LESS_OR_EQUAL(config.deadband, maxError(expected.data(), receiver.plane.data(), PIXELS));
+        }
+    }
+    TEST_ASSERT_EQUAL(sent, receiver.planes);
+    TEST_ASSERT_EQUAL(0, receiver.waited);
+}
+
+// ========================================
+// Benchmark
+// ========================================
+void test_benchmark(void) {
+    // One plane per capture: resample the DC thumbnail + delta code, against the JPEG it rides along
+    struct Case {
+        const char* name;
+        int width, height;
+        int noise;
+        bool motion;
+    };
+    static const Case cases[] = {
+        {"QVGA static", 320, 240, 0, false},
+        {"QVGA noise", 320, 240, 3, false},
+        {"QVGA motion", 320, 240, 2, true},
+        {"HVGA motion", 480, 320, 2, true},
+        {"VGA motion", 640, 480, 2, true},
+        {"SVGA motion", 800, 600, 2, true},
+    };
+    const int kFrames = 30;
+    printf("\n  %-12s %7s %7s %9s %9s %9s %9s\n", "scene", "thumb", "plane", "us/plane", "B/plane", "B/key",
+           "JPEG B");
+    for (const Case& c : cases) {
+        Scene background = makeBackground(c.width, c.height);
+        FixtureEncoder encoder(60, FixtureSampling::Yuv422);
+        JpegDcDecoder decoder;
+        std::vector<std::vector<uint8_t>> thumbnails;
+        size_t jpegBytes = 0;
+        for (int f = 0; f < kFrames; f++) {
+            int objX = c.motion ? c.width / 10 + f * c.width / 60 : 0;
+            Scene scene = makeFrame(background, (uint32_t)f + 1, c.noise, 0, objX, c.height / 4,
+                                    c.motion ? c.width / 8 : 0, c.height / 3);
+            std::vector<uint8_t> jpeg = encoder.encode(scene);
+            jpegBytes += jpeg.size();
+            std::vector<uint8_t> thumbnail((size_t)((c.width + 7) / 8) * ((c.height + 7) / 8));
+            TEST_ASSERT_EQUAL(JpegDcError::None,
+                              decoder.decode(jpeg.data(), jpeg.size(), thumbnail.data(), thumbnail.size()));
+            thumbnails.push_back(thumbnail);
+        }
+        uint16_t widthBlocks = decoder.getWidthBlocks();
+        uint16_t heightBlocks = decoder.getHeightBlocks();
+
+        uint16_t width = 0, height = 0;
+        LumaCodec::fitSize(widthBlocks, heightBlocks, W, H, width, height);
+        const size_t pixels = (size_t)width * height;
+        std::vector<uint8_t> plane(pixels), reference(pixels, 0), payload(LumaCodec::maxPayload(pixels));
+        std::vector<uint32_t> scratch(2 * width);
+        size_t keyBytes = 0, deltaBytes = 0;
+        const int kRounds = 20;
+        auto start = std::chrono::steady_clock::now();
+        for (int round = 0; round < kRounds; round++) {
+            memset(reference.data(), 0, pixels);
+            for (int f = 0; f < kFrames; f++) {
+                LumaCodec::resample(thumbnails[f].data(), widthBlocks, heightBlocks, plane.data(), width, height,
+                                    scratch.data());
+                size_t length = LumaCodec::encodeDelta(plane.data(), reference.data(), pixels, 2, payload.data(),
+                                                       payload.size());
+                if (round == 0) {
+                    (f == 0 ? keyBytes : deltaBytes) += length;
+                }
+            }
+        }
+        double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+        printf("  %-12s %3ux%-3u %3ux%-3u %9.1f %9u %9u %9u\n", c.name, widthBlocks, heightBlocks, width, height,
+               us / (kRounds * kFrames),
+               (unsigned)(deltaBytes / (kFrames - 1)), (unsigned)keyBytes, (unsigned)(jpegBytes / kFrames));
+
+        // Delta planes stay well below the key plane; a static scene costs only run tokens
+        TEST_ASSERT_LESS_THAN(keyBytes, deltaBytes / (kFrames - 1));
+        if (c.noise == 0 && !c.motion) {
+            TEST_ASSERT_EQUAL((pixels + 127) / 128, deltaBytes / (kFrames - 1));
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+    UNITY_BEGIN();
+    RUN_TEST(test_resample_uniform_and_identity);
+    RUN_TEST(test_resample_integer_ratios);
+    RUN_TEST(test_resample_matches_area_average);
+    RUN_TEST(test_plane_from_dc_thumbnail);
+    RUN_TEST(test_header_round_trip);
+    RUN_TEST(test_delta_round_trip_lossless);
+    RUN_TEST(test_deadband_bounds_error_without_drift);
+    RUN_TEST(test_decoder_rejects_malformed_payloads);
+    RUN_TEST(test_plane_never_upscaled);
+    RUN_TEST(test_stream_interval_and_key_planes);
+    RUN_TEST(test_receiver_follows_lossy_stream);
+    RUN_TEST(test_benchmark);
+    return UNITY_END();
+}
@@ -0,0 +1,266 @@
+/**
+ * `test_main.cpp`
+ * - Unit tests for MemoryPlan (native host build)
+ * - Worst-case JPEG sizes and quality floors, frame buffer planning with and without PSRAM
+ *   (snapshot-size buffers, fallback to the stream size, DRAM cap), budgets and the boot report
+ * - Run: pio test -e native -f test_memory_plan
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#include <unity.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#include "MemoryPlan.h"
+
+void setUp(void) {}
+void tearDown(void) {}
+
+// framesize_t values used below
+static const uint8_t kQvga = 5;
+static const uint8_t kHvga = 7;
+static const uint8_t kVga = 8;
+static const uint8_t kUxga = 13;
+
+static constexpr uint32_t kDramBudget = 180 * 1024;
+static constexpr uint32_t kPsramBudget = 4 * 1024 * 1024;
+static constexpr uint32_t kReserve = 32 * 1024;
+
+/**
+ * Config.h defaults: HVGA boot, ABR up to VGA, three buffers, UXGA snapshots preallocated
+ */
+static constexpr FrameBufferRequest makeRequest() {
+    FrameBufferRequest request = {};
+    request.bootFrameSize = 7;
+    request.streamMaxFrameSize = 8;
+    request.fbCount = 3;
+    request.minFbCount = 2;
+    request.fbInPsram = true;
+    request.snapshotPreallocate = true;
+    request.snapshotFrameSize = 13;
+    return request;
+}
+
+static constexpr MemoryPlan planFor(uint32_t psramBytes, uint32_t bulkBytes) {
+    MemoryPlan plan(MemoryBudget{kDramBudget, psramBytes, kReserve});
+    plan.add("send", 96 * 1024, psramBytes > 0 ? MemoryRegion::Psram : MemoryRegion::Dram);
+    if (psramBytes > 0) {
+        plan.add("bulk", bulkBytes, MemoryRegion::Psram);
+    }
+    plan.planFrameBuffers(makeRequest());
+    return plan;
+}
+
+// The plan is usable at compile time (src/main.cpp checks the budgets with static_assert)
+static constexpr MemoryPlan kCompiledPlan = planFor(kPsramBudget, 2 * 1024 * 1024);
+static_assert(kCompiledPlan.fits(), "compile-time plan");
+static_assert(kCompiledPlan.frameBuffers().frameSize == 13, "snapshot-size buffers");
+
+// ========================================
+// Frame Sizes and JPEG Sizes
+// ========================================
+
+void test_frame_buffer_bytes(void) {
+    TEST_ASSERT_EQUAL_UINT16(1600, MemoryPlan::frameWidth(kUxga));
+    TEST_ASSERT_EQUAL_UINT16(320, MemoryPlan::frameHeight(kHvga));
+    TEST_ASSERT_EQUAL_UINT32(15360, MemoryPlan::frameBufferBytes(kQvga));
+    TEST_ASSERT_EQUAL_UINT32(61440, MemoryPlan::frameBufferBytes(kVga));
+    TEST_ASSERT_EQUAL_UINT32(384000, MemoryPlan::frameBufferBytes(kUxga));
+    TEST_ASSERT_EQUAL_UINT32(0, MemoryPlan::frameBufferBytes(MemoryPlan::kFrameSizeCount));
+}
+
+void test_worst_case_jpeg(void) {
+    // Breakpoints: pixels × bytes per 1000 pixels + header
+    TEST_ASSERT_EQUAL_UINT32(1920000 * 190 / 1000 + 1024, MemoryPlan::worstJpegBytes(kUxga, 10));
+    TEST_ASSERT_EQUAL_UINT32(307200 * 170 / 1000 + 1024, MemoryPlan::worstJpegBytes(kVga, 12));
+    // Rounded up between breakpoints and past the last one
+    TEST_ASSERT_EQUAL_UINT32(76800 * 48 / 1000 + 1 + 1024, MemoryPlan::worstJpegBytes(kQvga, 63));
+    TEST_ASSERT_EQUAL_UINT32(1920000 * 205 / 1000 + 1024, MemoryPlan::worstJpegBytes(kUxga, 9));
+    TEST_ASSERT_EQUAL_UINT32(0, MemoryPlan::worstJpegBytes(MemoryPlan::kFrameSizeCount, 10));
+
+    // Lower quality value → never smaller
+    for (uint8_t quality = 1; quality <= 63; quality++) {
+        TEST_ASSERT_TRUE(MemoryPlan::worstJpegBytes(kVga, quality) <= MemoryPlan::worstJpegBytes(kVga, quality - 1));
+    }
+}
+
+void test_quality_floor(void) {
+    // A frame always fits a buffer of its own size from q10 up
+    TEST_ASSERT_EQUAL_UINT8(10, MemoryPlan::qualityFloor(kUxga, MemoryPlan::frameBufferBytes(kUxga)));
+    TEST_ASSERT_EQUAL_UINT8(10, MemoryPlan::qualityFloor(kVga, MemoryPlan::frameBufferBytes(kVga)));
+    // Larger buffers (snapshot-size ring) hold any quality of a streamed size
+    TEST_ASSERT_EQUAL_UINT8(0, MemoryPlan::qualityFloor(kVga, MemoryPlan::frameBufferBytes(kUxga)));
+    // Nothing fits
+    TEST_ASSERT_EQUAL_UINT8(64, MemoryPlan::qualityFloor(kUxga, MemoryPlan::frameBufferBytes(kQvga)));
+}
+
+// ========================================
+// Frame Buffer Planning
+// ========================================
+
+void test_psram_preallocates_snapshot_size(void) {
+    MemoryPlan plan = planFor(kPsramBudget, 2 * 1024 * 1024);
+    const FrameBufferPlan& buffers = plan.frameBuffers();
+
+    TEST_ASSERT_EQUAL_UINT8(kUxga, buffers.frameSize);
+    TEST_ASSERT_EQUAL_UINT8(3, buffers.fbCount);
+    TEST_ASSERT_TRUE(buffers.region == MemoryRegion::Psram);
+    TEST_ASSERT_EQUAL_UINT32(384000, buffers.fbBytes);
+    TEST_ASSERT_EQUAL_UINT8(kVga, buffers.streamMaxFrameSize);
+    TEST_ASSERT_TRUE(buffers.snapshotLive);
+    TEST_ASSERT_TRUE(plan.fits());
+    TEST_ASSERT_EQUAL_UINT32(96 * 1024 + 2 * 1024 * 1024 + 3 * 384000, plan.usedBytes(MemoryRegion::Psram));
+    TEST_ASSERT_EQUAL_UINT32(0, plan.usedBytes(MemoryRegion::Dram));
+}
+
+void test_psram_fewer_snapshot_buffers(void) {
+    // Room for two UXGA buffers: still at least minFbCount
+    uint32_t bulk = kPsramBudget - 96 * 1024 - kReserve - 2 * 384000 - 1000;
+    MemoryPlan plan = planFor(kPsramBudget, bulk);
+    TEST_ASSERT_EQUAL_UINT8(kUxga, plan.frameBuffers().frameSize);
+    TEST_ASSERT_EQUAL_UINT8(2, plan.frameBuffers().fbCount);
+    TEST_ASSERT_TRUE(plan.fits());
+}
+
+void test_psram_falls_back_to_stream_size(void) {
+    // One UXGA buffer would fit: below minFbCount, so three VGA buffers and snapshots re-init
+    uint32_t bulk = kPsramBudget - 96 * 1024 - kReserve - 384000 - 1000;
+    MemoryPlan plan = planFor(kPsramBudget, bulk);
+    const FrameBufferPlan& buffers = plan.frameBuffers();
+
+    TEST_ASSERT_EQUAL_UINT8(kVga, buffers.frameSize);
+    TEST_ASSERT_EQUAL_UINT8(3, buffers.fbCount);
+    TEST_ASSERT_FALSE(buffers.snapshotLive);
+    TEST_ASSERT_TRUE(plan.fits());
+}
+
+void test_dram_caps_the_stream(void) {
+    // 180 KB - 96 KB send buffer - 32 KB reserve = 52 KB: no VGA buffer (60 KB), one HVGA buffer
+    MemoryPlan plan = planFor(0, 0);
+    const FrameBufferPlan& buffers = plan.frameBuffers();
+
+    TEST_ASSERT_EQUAL_UINT8(kHvga, buffers.frameSize);
+    TEST_ASSERT_EQUAL_UINT8(1, buffers.fbCount);
+    TEST_ASSERT_TRUE(buffers.region == MemoryRegion::Dram);
+    TEST_ASSERT_EQUAL_UINT8(kHvga, buffers.streamMaxFrameSize);
+    TEST_ASSERT_FALSE(buffers.snapshotLive);
+    TEST_ASSERT_TRUE(plan.fits());
+    TEST_ASSERT_EQUAL_UINT32(96 * 1024 + 30720, plan.usedBytes(MemoryRegion::Dram));
+}
+
+void test_buffers_in_dram_with_psram(void) {
+    // FB_IN_PSRAM false: the ring counts against the internal heap
+    FrameBufferRequest request = makeRequest();
+    request.fbInPsram = false;
+    request.snapshotPreallocate = false;
+    MemoryPlan plan(MemoryBudget{kDramBudget, kPsramBudget, kReserve});
+    FrameBufferPlan buffers = plan.planFrameBuffers(request);
+
+    TEST_ASSERT_TRUE(buffers.region == MemoryRegion::Dram);
+    TEST_ASSERT_EQUAL_UINT8(kVga, buffers.frameSize);
+    TEST_ASSERT_EQUAL_UINT8(2, buffers.fbCount);        // (180 - 32) KB / 60 KB
+    TEST_ASSERT_TRUE(plan.fits());
+}
+
+void test_nothing_fits(void) {
+    MemoryPlan plan(MemoryBudget{kDramBudget, 0, kReserve});
+    plan.add("send", 120 * 1024, MemoryRegion::Dram);     // 28 KB left: less than one HVGA buffer
+    FrameBufferPlan buffers = plan.planFrameBuffers(makeRequest());
+
+    TEST_ASSERT_EQUAL_UINT8(0, buffers.fbCount);
+    TEST_ASSERT_EQUAL_UINT32(28 * 1024, plan.availableBytes(MemoryRegion::Dram));
+    TEST_ASSERT_TRUE(plan.fits(MemoryRegion::Dram));
+    TEST_ASSERT_FALSE(plan.fits());
+}
+
+void test_over_budget(void) {
+    MemoryPlan plan(MemoryBudget{kDramBudget, kPsramBudget, kReserve});
+    plan.add("backfill", kPsramBudget - kReserve + 1, MemoryRegion::Psram);
+    TEST_ASSERT_FALSE(plan.fits(MemoryRegion::Psram));
+    TEST_ASSERT_TRUE(plan.fits(MemoryRegion::Dram));
+    TEST_ASSERT_EQUAL_UINT32(0, plan.availableBytes(MemoryRegion::Psram));
+}
+
+void test_item_overflow(void) {
+    MemoryPlan plan(MemoryBudget{kDramBudget, kPsramBudget, kReserve});
+    for (size_t i = 0; i < MemoryPlan::kMaxItems; i++) {
+        plan.add("item", 1024, MemoryRegion::Psram);
+    }
+    TEST_ASSERT_FALSE(plan.overflowed());
+    plan.planFrameBuffers(makeRequest());      // one past the limit
+    TEST_ASSERT_TRUE(plan.overflowed());
+    TEST_ASSERT_EQUAL(MemoryPlan::kMaxItems, plan.itemCount());
+    TEST_ASSERT_FALSE(plan.fits());
+}
+
+// ========================================
+// Boot Report
+// ========================================
+
+void test_format_region(void) {
+    MemoryPlan plan = planFor(0, 0);
+    char line[128];
+    size_t length = plan.formatRegion(MemoryRegion::Dram, line, sizeof(line));
+    TEST_ASSERT_EQUAL_STRING("DRAM 126 KB of 180 KB (reserve 32 KB): send 96 KB, frame buffers 30 KB", line);
+    TEST_ASSERT_EQUAL(strlen(line), length);
+
+    // Empty region: just the totals
+    plan.formatRegion(MemoryRegion::Psram, line, sizeof(line));
+    TEST_ASSERT_EQUAL_STRING("PSRAM 0 KB of 0 KB (reserve 32 KB)", line);
+
+    // Too small: nothing
+    char small[24];
+    TEST_ASSERT_EQUAL(0, plan.formatRegion(MemoryRegion::Dram, small, sizeof(small)));
+    TEST_ASSERT_EQUAL_STRING("", small);
+}
+
+/**
+ * Worst-case JPEG (KB) by frame size and quality, against the buffer of that frame size
+ */
+void test_worst_case_table(void) {
+    const uint8_t sizes[] = {kQvga, kHvga, kVga, 9, 10, 12, kUxga};
+    const char* names[] = {"QVGA", "HVGA", "VGA", "SVGA", "XGA", "SXGA", "UXGA"};
+    const uint8_t qualities[] = {4, 10, 12, 25, 40, 63};
+    printf("\n  %-6s %7s", "size", "fb KB");
+    for (uint8_t quality : qualities) {
+        printf("  q%-4u", quality);
+    }
+    printf(" %6s\n", "floor");
+    for (size_t i = 0; i < sizeof(sizes); i++) {
+        uint32_t fbBytes = MemoryPlan::frameBufferBytes(sizes[i]);
+        printf("  %-6s %7u", names[i], (unsigned)(fbBytes / 1024));
+        for (uint8_t quality : qualities) {
+            uint32_t worst = MemoryPlan::worstJpegBytes(sizes[i], quality);
+            printf(" %5u%s", (unsigned)(worst / 1024), worst > fbBytes ? "!" : " ");
+        }
+        printf(" %6u\n", MemoryPlan::qualityFloor(sizes[i], fbBytes));
+        // q12 (the best ABR ladder quality) fits every size's own buffer
+        TEST_ASSERT_TRUE(MemoryPlan::qualityFloor(sizes[i], fbBytes) <= 12);
+    }
+    printf("  (! = can exceed the buffer)\n");
+}
+
+int main(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+    UNITY_BEGIN();
+    RUN_TEST(test_frame_buffer_bytes);
+    RUN_TEST(test_worst_case_jpeg);
+    RUN_TEST(test_quality_floor);
+    RUN_TEST(test_psram_preallocates_snapshot_size);
+    RUN_TEST(test_psram_fewer_snapshot_buffers);
+    RUN_TEST(test_psram_falls_back_to_stream_size);
+    RUN_TEST(test_dram_caps_the_stream);
+    RUN_TEST(test_buffers_in_dram_with_psram);
+    RUN_TEST(test_nothing_fits);
+    RUN_TEST(test_over_budget);
+    RUN_TEST(test_item_overflow);
+    RUN_TEST(test_format_region);
+    RUN_TEST(test_worst_case_table);
+    return UNITY_END();
+}
@@ -0,0 +1,441 @@
+/**
+ * `test_main.cpp`
+ * - Unit tests for FrameHub and MjpegServer (native host build)
+ * - The server runs on a real loopback socket; viewers are plain HTTP clients like curl
+ * - Run: pio test -e native -f test_mjpeg_server
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#include <unity.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "FrameHub.h"
+#include "MjpegServer.h"
+
+void setUp(void) {}
+void tearDown(void) {}
+
+// ========================================
+// Helpers
+// ========================================
+static const size_t kSlotSize = 64 * 1024;
+
+/**
+ * Synthetic JPEG: SOI, the frame number, a pattern derived from it, EOI
+ */
+static std::vector<uint8_t> makeJpeg(uint32_t number, size_t length) {
+    std::vector<uint8_t> jpeg(length);
+    for (size_t i = 0; i < length; i++) {
+        jpeg[i] = (uint8_t)(i * 13 + number);
+    }
+    jpeg[0] = 0xFF;
+    jpeg[1] = 0xD8;
+    memcpy(&jpeg[2], &number, sizeof(number));
+    jpeg[length - 2] = 0xFF;
+    jpeg[length - 1] = 0xD9;
+    return jpeg;
+}
+
+static bool isIntactJpeg(const std::string& body) {
+    size_t length = body.size();
+    if (length < 8 || (uint8_t)body[0] != 0xFF || (uint8_t)body[1] != 0xD8 ||
+        (uint8_t)body[length - 2] != 0xFF || (uint8_t)body[length - 1] != 0xD9) {
+        return false;
+    }
+    uint32_t number;
+    memcpy(&number, body.data() + 2, sizeof(number));
+    for (size_t i = 6; i < length - 2; i++) {
+        if ((uint8_t)body[i] != (uint8_t)(i * 13 + number)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static uint64_t nowUs() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * Minimal MJPEG client (what curl/a browser does with multipart/x-mixed-replace)
+ */
+class MjpegClient {
+public:
+    MjpegClient(uint16_t port, const char* path, int receiveBuffer = 0) {
+        _fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (receiveBuffer > 0) {
+            setsockopt(_fd, SOL_SOCKET, SO_RCVBUF, &receiveBuffer, sizeof(receiveBuffer));
+        }
+        struct timeval timeout = {2, 0};
+        setsockopt(_fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        struct sockaddr_in address = {};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(port);
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        _connected = connect(_fd, (struct sockaddr*)&address, sizeof(address)) == 0;
+        char request[128];
+        int length = snprintf(request, sizeof(request), "GET %s HTTP/1.1\r\nHost: cam\r\n\r\n", path);
+        _connected = _connected && send(_fd, request, (size_t)length, 0) == length;
+    }
+
+    ~MjpegClient() { close(); }
+
+    void close() {
+        if (_fd >= 0) {
+            ::close(_fd);
+            _fd = -1;
+        }
+    }
+
+    /**
+     * Response status line and headers
+     */
+    std::string readHead() {
+        return readUntil("\r\n\r\n");
+    }
+
+    /**
+     * Next part: headers, then Content-Length bytes
+     * @return false on timeout or a malformed part
+     */
+    bool readPart(uint32_t& sequence, std::string& body) {
+        std::string head = readUntil("\r\n\r\n");
+        const char* length = strstr(head.c_str(), "Content-Length: ");
+        const char* number = strstr(head.c_str(), "X-Frame-Sequence: ");
+        if (head.find("--frame") == std::string::npos || length == NULL || number == NULL) {
+            return false;
+        }
+        size_t bodyLength = (size_t)strtoul(length + 16, NULL, 10);
+        sequence = (uint32_t)strtoul(number + 18, NULL, 10);
+        while (_buffer.size() < bodyLength) {
+            if (!fill()) return false;
+        }
+        body = _buffer.substr(0, bodyLength);
+        _buffer.erase(0, bodyLength);
+        return true;
+    }
+
+    bool isConnected() const { return _connected; }
+
+private:
+    bool fill() {
+        char chunk[4096];
+        ssize_t n = recv(_fd, chunk, sizeof(chunk), 0);
+        if (n <= 0) return false;
+        _buffer.append(chunk, (size_t)n);
+        return true;
+    }
+
+    std::string readUntil(const char* marker) {
+        size_t at;
+        while ((at = _buffer.find(marker)) == std::string::npos) {
+            if (!fill()) return std::string();
+        }
+        std::string head = _buffer.substr(0, at + strlen(marker));
+        _buffer.erase(0, at + strlen(marker));
+        return head;
+    }
+
+    int _fd;
+    bool _connected;
+    std::string _buffer;
+};
+
+/**
+ * Capture-side stand-in: publishes numbered frames at a fixed period
+ */
+class Publisher {
+public:
+    Publisher(FrameHub& hub, uint32_t periodMs, size_t frameBytes)
+        : _hub(hub), _running(true), _published(0), _publishUs(0) {
+        _thread = std::thread([this, periodMs, frameBytes] {
+            uint32_t number = 0;
+            while (_running.load()) {
+                number++;
+                std::vector<uint8_t> jpeg = makeJpeg(number, frameBytes - number % 512);
+                uint64_t startUs = nowUs();
+                if (_hub.publish(jpeg.data(), jpeg.size(), startUs)) {
+                    _publishUs += nowUs() - startUs;
+                    _published++;
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(periodMs));
+            }
+        });
+    }
+
+    ~Publisher() { stop(); }
+
+    void stop() {
+        _running = false;
+        if (_thread.joinable()) _thread.join();
+    }
+
+    uint32_t published() const { return _published.load(); }
+    uint64_t publishUs() const { return _publishUs.load(); }
+
+private:
+    FrameHub& _hub;
+    std::atomic<bool> _running;
+    std::atomic<uint32_t> _published;
+    std::atomic<uint64_t> _publishUs;
+    std::thread _thread;
+};
+
+// ========================================
+// FrameHub
+// ========================================
+void test_hub_readers_share_one_copy() {
+    std::vector<uint8_t> arena(3 * kSlotSize);
+    FrameHub hub(arena.data(), 3, kSlotSize);
+    std::vector<uint8_t> jpeg = makeJpeg(1, 1000);
+    TEST_ASSERT_TRUE(hub.publish(jpeg.data(), jpeg.size(), 42));
+
+    HubFrame a = {};
+    HubFrame b = {};
+    TEST_ASSERT_TRUE(hub.acquire(0, a));
+    TEST_ASSERT_TRUE(hub.acquire(0, b));
+    TEST_ASSERT_TRUE(a.data == b.data);
+    TEST_ASSERT_EQUAL(1, a.sequence);
+    TEST_ASSERT_EQUAL(42, a.captureUs);
+    TEST_ASSERT_EQUAL_MEMORY(jpeg.data(), a.data, jpeg.size());
+    TEST_ASSERT_EQUAL(3, hub.refCount(a.slot));  // hub + two readers
+
+    int slot = a.slot;
+    hub.release(a);
+    hub.release(b);
+    TEST_ASSERT_EQUAL(-1, a.slot);
+    TEST_ASSERT_EQUAL(1, hub.refCount(slot));
+    TEST_ASSERT_FALSE(hub.acquire(1, a));  // nothing newer than sequence 1
+}
+
+void test_hub_held_frame_survives_newer_publishes() {
+    std::vector<uint8_t> arena(FrameHub::slotsFor(1) * kSlotSize);
+    FrameHub hub(arena.data(), FrameHub::slotsFor(1), kSlotSize);
+    std::vector<uint8_t> first = makeJpeg(1, 5000);
+    hub.publish(first.data(), first.size(), 1);
+
+    HubFrame held = {};
+    TEST_ASSERT_TRUE(hub.acquire(0, held));
+    for (uint32_t i = 2; i <= 20; i++) {
+        std::vector<uint8_t> jpeg = makeJpeg(i, 5000);
+        TEST_ASSERT_TRUE(hub.publish(jpeg.data(), jpeg.size(), i));
+    }
+    TEST_ASSERT_EQUAL_MEMORY(first.data(), held.data, first.size());
+
+    // The slow reader jumps straight to the newest frame
+    HubFrame next = {};
+    TEST_ASSERT_TRUE(hub.acquire(held.sequence, next));
+    TEST_ASSERT_EQUAL(20, next.sequence);
+    hub.release(held);
+    hub.release(next);
+    TEST_ASSERT_EQUAL(0, hub.getStats().noSlot);
+}
+
+void test_hub_sized_for_readers_never_runs_out() {
+    const size_t readers = 3;
+    std::vector<uint8_t> arena(FrameHub::slotsFor(readers) * kSlotSize);
+    FrameHub hub(arena.data(), FrameHub::slotsFor(readers), kSlotSize);
+    std::vector<uint8_t> jpeg = makeJpeg(1, 2000);
+    HubFrame held[readers] = {};
+
+    // Every reader holds a different frame while publishing goes on
+    for (uint32_t round = 0; round < 50; round++) {
+        TEST_ASSERT_TRUE(hub.publish(jpeg.data(), jpeg.size(), round));
+        size_t reader = round % readers;
+        hub.release(held[reader]);
+        TEST_ASSERT_TRUE(hub.acquire(0, held[reader]));
+    }
+    TEST_ASSERT_EQUAL(0, hub.getStats().noSlot);
+    TEST_ASSERT_LESS_OR_EQUAL(FrameHub::slotsFor(readers), hub.getStats().maxHeld);
+
+    // One slot short: the publisher finds every slot held
+    std::vector<uint8_t> small((readers + 1) * kSlotSize);
+    FrameHub tight(small.data(), readers + 1, kSlotSize);
+    HubFrame pinned[readers] = {};
+    for (size_t i = 0; i < readers; i++) {
+        tight.publish(jpeg.data(), jpeg.size(), i);
+        tight.acquire(0, pinned[i]);
+    }
+    TEST_ASSERT_TRUE(tight.publish(jpeg.data(), jpeg.size(), 9));   // last free slot
+    TEST_ASSERT_FALSE(tight.publish(jpeg.data(), jpeg.size(), 10));
+    TEST_ASSERT_EQUAL(1, tight.getStats().noSlot);
+}
+
+void test_hub_rejects_oversized_frames() {
+    std::vector<uint8_t> arena(2 * 1024);
+    FrameHub hub(arena.data(), 2, 1024);
+    std::vector<uint8_t> jpeg = makeJpeg(1, 1025);
+    TEST_ASSERT_FALSE(hub.publish(jpeg.data(), jpeg.size(), 0));
+    TEST_ASSERT_EQUAL(1, hub.getStats().oversized);
+    HubFrame frame = {};
+    TEST_ASSERT_FALSE(hub.acquire(0, frame));
+}
+
+// ========================================
+// MjpegServer
+// ========================================
+void test_server_streams_multipart_to_client() {
+    std::vector<uint8_t> arena(FrameHub::slotsFor(2) * kSlotSize);
+    FrameHub hub(arena.data(), FrameHub::slotsFor(2), kSlotSize);
+    MjpegServerConfig config;
+    config.port = 0;
+    config.maxViewers = 2;
+    MjpegServer server(hub, config);
+    TEST_ASSERT_TRUE(server.start());
+    TEST_ASSERT_FALSE(hub.hasReaders());
+    Publisher publisher(hub, 10, 20000);
+
+    MjpegClient client(server.port(), "/stream?from=test");
+    TEST_ASSERT_TRUE(client.isConnected());
+    std::string head = client.readHead();
+    TEST_ASSERT_TRUE(head.rfind("HTTP/1.1 200 OK\r\n", 0) == 0);
+    TEST_ASSERT_TRUE(head.find("multipart/x-mixed-replace; boundary=frame") != std::string::npos);
+
+    uint32_t last = 0;
+    for (int i = 0; i < 10; i++) {
+        uint32_t sequence = 0;
+        std::string body;
+        TEST_ASSERT_TRUE(client.readPart(sequence, body));
+        TEST_ASSERT_TRUE(isIntactJpeg(body));
+        TEST_ASSERT_GREATER_THAN(last, sequence);
+        last = sequence;
+    }
+    TEST_ASSERT_TRUE(hub.hasReaders());
+
+    // Closing the client detaches it (capture path stops copying)
+    client.close();
+    for (int i = 0; i < 100 && hub.hasReaders(); i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    TEST_ASSERT_FALSE(hub.hasReaders());
+    publisher.stop();
+    server.stop();
+
+    MjpegServerStats stats = server.getStats();
+    TEST_ASSERT_EQUAL(1, stats.accepted);
+    TEST_ASSERT_EQUAL(1, stats.closed);
+    TEST_ASSERT_GREATER_OR_EQUAL(10, stats.framesSent);
+    TEST_ASSERT_EQUAL(0, stats.viewers);
+}
+
+void test_server_rejects_unknown_path_and_extra_viewers() {
+    std::vector<uint8_t> arena(FrameHub::slotsFor(1) * kSlotSize);
+    FrameHub hub(arena.data(), FrameHub::slotsFor(1), kSlotSize);
+    MjpegServerConfig config;
+    config.port = 0;
+    config.maxViewers = 1;
+    MjpegServer server(hub, config);
+    TEST_ASSERT_TRUE(server.start());
+
+    MjpegClient wrongPath(server.port(), "/streamer");
+    TEST_ASSERT_TRUE(wrongPath.readHead().rfind("HTTP/1.1 404", 0) == 0);
+
+    MjpegClient first(server.port(), "/stream");
+    TEST_ASSERT_TRUE(first.readHead().rfind("HTTP/1.1 200", 0) == 0);
+    MjpegClient second(server.port(), "/stream");
+    TEST_ASSERT_TRUE(second.readHead().rfind("HTTP/1.1 503", 0) == 0);
+
+    server.stop();
+    MjpegServerStats stats = server.getStats();
+    TEST_ASSERT_EQUAL(1, stats.accepted);
+    TEST_ASSERT_EQUAL(2, stats.rejected);
+}
+
+void test_slow_viewer_drops_frames_without_slowing_others() {
+    const size_t viewers = 2;
+    std::vector<uint8_t> arena(FrameHub::slotsFor(viewers) * kSlotSize);
+    FrameHub hub(arena.data(), FrameHub::slotsFor(viewers), kSlotSize);
+    MjpegServerConfig config;
+    config.port = 0;
+    config.maxViewers = viewers;
+    MjpegServer server(hub, config);
+    TEST_ASSERT_TRUE(server.start());
+
+    MjpegClient fast(server.port(), "/stream");
+    MjpegClient slow(server.port(), "/stream", 4096);
+    TEST_ASSERT_TRUE(fast.readHead().rfind("HTTP/1.1 200", 0) == 0);
+    TEST_ASSERT_TRUE(slow.readHead().rfind("HTTP/1.1 200", 0) == 0);
+
+    // 50 fps of ~40 KB frames for 1.5 s; the slow viewer reads a frame every 150 ms
+    Publisher publisher(hub, 20, 40000);
+    std::atomic<uint32_t> slowFrames(0);
+    std::atomic<bool> slowIntact(true);
+    std::thread slowReader([&] {
+        uint64_t endUs = nowUs() + 1500000;
+        uint32_t last = 0;
+        while (nowUs() < endUs) {
+            uint32_t sequence = 0;
+            std::string body;
+            if (!slow.readPart(sequence, body) || !isIntactJpeg(body) || sequence <= last) {
+                slowIntact = false;
+                break;
+            }
+            last = sequence;
+            slowFrames++;
+            std::this_thread::sleep_for(std::chrono::milliseconds(150));
+        }
+    });
+
+    uint32_t fastFrames = 0;
+    uint32_t fastMissed = 0;
+    uint32_t last = 0;
+    uint64_t endUs = nowUs() + 1500000;
+    while (nowUs() < endUs) {
+        uint32_t sequence = 0;
+        std::string body;
+        TEST_ASSERT_TRUE(fast.readPart(sequence, body));
+        TEST_ASSERT_TRUE(isIntactJpeg(body));
+        if (last != 0) fastMissed += sequence - last - 1;
+        last = sequence;
+        fastFrames++;
+    }
+    slowReader.join();
+    publisher.stop();
+    server.stop();
+
+    MjpegServerStats stats = server.getStats();
+    FrameHubStats hubStats = hub.getStats();
+    printf("[Benchmark] fan-out: published %u (avg copy %.1f us), fast viewer %u frames (%u missed), "
+           "slow viewer %u frames, skipped total %u\n",
+           publisher.published(), publisher.published() > 0 ? (double)publisher.publishUs() / publisher.published() : 0.0,
+           fastFrames, fastMissed, slowFrames.load(), stats.framesSkipped);
+
+    TEST_ASSERT_TRUE(slowIntact.load());
+    TEST_ASSERT_EQUAL(0, hubStats.noSlot);                        // publisher never waited on a viewer
+    TEST_ASSERT_GREATER_THAN(publisher.published() * 8 / 10, fastFrames);
+    TEST_ASSERT_LESS_THAN(fastFrames / 2, slowFrames.load());
+    TEST_ASSERT_GREATER_THAN(0, stats.framesSkipped);
+}
+
+int main(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+    UNITY_BEGIN();
+    RUN_TEST(test_hub_readers_share_one_copy);
+    RUN_TEST(test_hub_held_frame_survives_newer_publishes);
+    RUN_TEST(test_hub_sized_for_readers_never_runs_out);
+    RUN_TEST(test_hub_rejects_oversized_frames);
+    RUN_TEST(test_server_streams_multipart_to_client);
+    RUN_TEST(test_server_rejects_unknown_path_and_extra_viewers);
+    RUN_TEST(test_slow_viewer_drops_frames_without_slowing_others);
+    return UNITY_END();
+}
@@ -0,0 +1,417 @@
+/**
+ * `jpeg_fixture.h`
+ * - Baseline JPEG fixtures for the MotionGate tests and benchmark
+ * - Minimal encoder (standard Annex K tables, 4:2:2/4:2:0/grayscale, optional DRI)
+ *   producing OV2640-like frames from synthetic scenes, so the tests need no files
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#ifndef JPEG_FIXTURE_H
+#define JPEG_FIXTURE_H
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <vector>
+
+// ========================================
+// Scene
+// ========================================
+
+/**
+ * Luminance image (chroma is generated from it by the encoder)
+ */
+struct Scene {
+    int width;
+    int height;
+    std::vector<uint8_t> y;
+
+    Scene(int w, int h) : width(w), height(h), y((size_t)w * h, 0) {}
+
+    uint8_t at(int x, int yy) const {
+        x = x < 0 ? 0 : (x >= width ? width - 1 : x);
+        yy = yy < 0 ? 0 : (yy >= height ? height - 1 : yy);
+        return y[(size_t)yy * width + x];
+    }
+};
+
+static inline uint8_t clampByte(int v) {
+    return (uint8_t)(v < 0 ? 0 : (v > 255 ? 255 : v));
+}
+
+/**
+ * Deterministic LCG so fixtures are identical on every run
+ */
+struct FixtureRandom {
+    uint32_t state;
+    explicit FixtureRandom(uint32_t seed) : state(seed) {}
+    int next(int range) {
+        state = state * 1664525u + 1013904223u;
+        return (int)((state >> 8) % (uint32_t)range);
+    }
+};
+
+/**
+ * Textured static background (room-like: gradients, edges, fine texture)
+ */
+static inline Scene makeBackground(int width, int height) {
+    Scene scene(width, height);
+    FixtureRandom rnd(12345);
+    for (int yy = 0; yy < height; yy++) {
+        for (int x = 0; x < width; x++) {
+            double v = 90 + 50.0 * x / width + 30.0 * sin(yy * 0.05) + 20.0 * sin(x * 0.21 + yy * 0.13);
+            if ((x / 40 + yy / 30) % 3 == 0) v += 25;  // furniture-like patches
+            v += rnd.next(9) - 4;
+            scene.y[(size_t)yy * width + x] = clampByte((int)v);
+        }
+    }
+    return scene;
+}
+
+/**
+ * Frame = background + exposure offset + sensor noise + optional moving object
+ */
+static inline Scene makeFrame(const Scene& background, uint32_t seed, int noise, int exposure,
+                              int objX, int objY, int objW, int objH) {
+    Scene frame = background;
+    FixtureRandom rnd(seed);
+    for (int yy = 0; yy < frame.height; yy++) {
+        for (int x = 0; x < frame.width; x++) {
+            int v = frame.y[(size_t)yy * frame.width + x] + exposure;
+            if (noise > 0) v += rnd.next(2 * noise + 1) - noise;
+            if (objW > 0 && x >= objX && x < objX + objW && yy >= objY && yy < objY + objH) {
+                v = 220 - ((x - objX) * 7 + (yy - objY) * 3) % 40;  // bright, lightly textured object
+            }
+            frame.y[(size_t)yy * frame.width + x] = clampByte(v);
+        }
+    }
+    return frame;
+}
+
+// ========================================
+// Encoder
+// ========================================
+enum class FixtureSampling { Yuv422, Yuv420, Gray };
+
+static const uint8_t kZigzag[64] = {
+     0,  1,  8, 16,  9,  2,  3, 10, 17, 24, 32, 25, 18, 11,  4,  5,
+    12, 19, 26, 33, 40, 48, 41, 34, 27, 20, 13,  6,  7, 14, 21, 28,
+    35, 42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23, 30, 37, 44, 51,
+    58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63
+};
+
+static const uint8_t kLumaQuant[64] = {
+    16, 11, 10, 16, 24, 40, 51, 61, 12, 12, 14, 19, 26, 58, 60, 55,
+    14, 13, 16, 24, 40, 57, 69, 56, 14, 17, 22, 29, 51, 87, 80, 62,
+    18, 22, 37, 56, 68, 109, 103, 77, 24, 35, 55, 64, 81, 104, 113, 92,
+    49, 64, 78, 87, 103, 121, 120, 101, 72, 92, 95, 98, 112, 100, 103, 99
+};
+
+static const uint8_t kChromaQuant[64] = {
+    17, 18, 24, 47, 99, 99, 99, 99, 18, 21, 26, 66, 99, 99, 99, 99,
+    24, 26, 56, 99, 99, 99, 99, 99, 47, 66, 99, 99, 99, 99, 99, 99,
+    99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99,
+    99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99
+};
+
+static const uint8_t kDcLumaBits[16] = {0, 1, 5, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0};
+static const uint8_t kDcChromaBits[16] = {0, 3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0};
+static const uint8_t kDcValues[12] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11};
+
+static const uint8_t kAcLumaBits[16] = {0, 2, 1, 3, 3, 2, 4, 3, 5, 5, 4, 4, 0, 0, 1, 0x7d};
+static const uint8_t kAcLumaValues[162] = {
+    0x01, 0x02, 0x03, 0x00, 0x04, 0x11, 0x05, 0x12, 0x21, 0x31, 0x41, 0x06, 0x13, 0x51, 0x61, 0x07,
+    0x22, 0x71, 0x14, 0x32, 0x81, 0x91, 0xa1, 0x08, 0x23, 0x42, 0xb1, 0xc1, 0x15, 0x52, 0xd1, 0xf0,
+    0x24, 0x33, 0x62, 0x72, 0x82, 0x09, 0x0a, 0x16, 0x17, 0x18, 0x19, 0x1a, 0x25, 0x26, 0x27, 0x28,
+    0x29, 0x2a, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49,
+    0x4a, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5a, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69,
+    0x6a, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7a, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89,
+    0x8a, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9a, 0xa2, 0xa3, 0xa4, 0xa5, 0xa6, 0xa7,
+    0xa8, 0xa9, 0xaa, 0xb2, 0xb3, 0xb4, 0xb5, 0xb6, 0xb7, 0xb8, 0xb9, 0xba, 0xc2, 0xc3, 0xc4, 0xc5,
+    0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xd2, 0xd3, 0xd4, 0xd5, 0xd6, 0xd7, 0xd8, 0xd9, 0xda, 0xe1, 0xe2,
+    0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8, 0xe9, 0xea, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8,
+    0xf9, 0xfa
+};
+
+static const uint8_t kAcChromaBits[16] = {0, 2, 1, 2, 4, 4, 3, 4, 7, 5, 4, 4, 0, 1, 2, 0x77};
+static const uint8_t kAcChromaValues[162] = {
+    0x00, 0x01, 0x02, 0x03, 0x11, 0x04, 0x05, 0x21, 0x31, 0x06, 0x12, 0x41, 0x51, 0x07, 0x61, 0x71,
+    0x13, 0x22, 0x32, 0x81, 0x08, 0x14, 0x42, 0x91, 0xa1, 0xb1, 0xc1, 0x09, 0x23, 0x33, 0x52, 0xf0,
+    0x15, 0x62, 0x72, 0xd1, 0x0a, 0x16, 0x24, 0x34, 0xe1, 0x25, 0xf1, 0x17, 0x18, 0x19, 0x1a, 0x26,
+    0x27, 0x28, 0x29, 0x2a, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48,
+    0x49, 0x4a, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5a, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68,
+    0x69, 0x6a, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7a, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87,
+    0x88, 0x89, 0x8a, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9a, 0xa2, 0xa3, 0xa4, 0xa5,
+    0xa6, 0xa7, 0xa8, 0xa9, 0xaa, 0xb2, 0xb3, 0xb4, 0xb5, 0xb6, 0xb7, 0xb8, 0xb9, 0xba, 0xc2, 0xc3,
+    0xc4, 0xc5, 0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xd2, 0xd3, 0xd4, 0xd5, 0xd6, 0xd7, 0xd8, 0xd9, 0xda,
+    0xe2, 0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8, 0xe9, 0xea, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8,
+    0xf9, 0xfa
+};
+
+/**
+ * Baseline JPEG writer
+ */
+class FixtureEncoder {
+public:
+    /**
+     * @param quality libjpeg-style quality (1-100)
+     * @param restartInterval MCUs between RSTn markers (0 = none)
+     */
+    FixtureEncoder(int quality, FixtureSampling sampling, uint16_t restartInterval = 0)
+        : _sampling(sampling), _restartInterval(restartInterval) {
+        int scale = quality < 50 ? 5000 / quality : 200 - quality * 2;
+        for (int i = 0; i < 64; i++) {
+            _quant[0][i] = (uint8_t)clampQuant((kLumaQuant[kZigzag[i]] * scale + 50) / 100);
+            _quant[1][i] = (uint8_t)clampQuant((kChromaQuant[kZigzag[i]] * scale + 50) / 100);
+        }
+        buildCodes(_dcCodes[0], kDcLumaBits, kDcValues);
+        buildCodes(_dcCodes[1], kDcChromaBits, kDcValues);
+        buildCodes(_acCodes[0], kAcLumaBits, kAcLumaValues);
+        buildCodes(_acCodes[1], kAcChromaBits, kAcChromaValues);
+        double c[8];
+        for (int u = 0; u < 8; u++) c[u] = u == 0 ? sqrt(0.125) : 0.5;
+        for (int u = 0; u < 8; u++) {
+            for (int x = 0; x < 8; x++) {
+                _cos[u][x] = c[u] * cos((2 * x + 1) * u * M_PI / 16);
+            }
+        }
+    }
+
+    /**
+     * Luma DC quantizer (the decoder scales DC by this)
+     */
+    uint8_t lumaDcQuant() const { return _quant[0][0]; }
+
+    std::vector<uint8_t> encode(const Scene& scene) {
+        _out.clear();
+        _bitBuf = 0;
+        _bitCount = 0;
+        int hY = _sampling == FixtureSampling::Gray ? 1 : 2;
+        int vY = _sampling == FixtureSampling::Yuv420 ? 2 : 1;
+        int components = _sampling == FixtureSampling::Gray ? 1 : 3;
+
+        put16(0xFFD8);
+        writeDqt(0);
+        if (components == 3) writeDqt(1);
+        writeSof(scene, components, hY, vY);
+        writeDht(0x00, kDcLumaBits, kDcValues);
+        writeDht(0x10, kAcLumaBits, kAcLumaValues);
+        if (components == 3) {
+            writeDht(0x01, kDcChromaBits, kDcValues);
+            writeDht(0x11, kAcChromaBits, kAcChromaValues);
+        }
+        if (_restartInterval) {
+            put16(0xFFDD);
+            put16(4);
+            put16(_restartInterval);
+        }
+        writeSos(components);
+
+        int mcuW = 8 * hY;
+        int mcuH = 8 * vY;
+        int mcusX = (scene.width + mcuW - 1) / mcuW;
+        int mcusY = (scene.height + mcuH - 1) / mcuH;
+        int pred[3] = {0, 0, 0};
+        int mcu = 0;
+        int restartIndex = 0;
+        for (int my = 0; my < mcusY; my++) {
+            for (int mx = 0; mx < mcusX; mx++) {
+                if (_restartInterval && mcu > 0 && mcu % _restartInterval == 0) {
+                    flushBits();
+                    _out.push_back(0xFF);
+                    _out.push_back((uint8_t)(0xD0 + (restartIndex++ & 7)));
+                    pred[0] = pred[1] = pred[2] = 0;
+                }
+                mcu++;
+                double block[64];
+                for (int v = 0; v < vY; v++) {
+                    for (int h = 0; h < hY; h++) {
+                        int x0 = mx * mcuW + h * 8;
+                        int y0 = my * mcuH + v * 8;
+                        for (int i = 0; i < 64; i++) block[i] = scene.at(x0 + i % 8, y0 + i / 8);
+                        encodeBlock(block, 0, pred[0]);
+                    }
+                }
+                if (components == 3) {
+                    // Chroma derived from luma (mild tint) averaged over the MCU
+                    for (int ci = 1; ci < 3; ci++) {
+                        for (int i = 0; i < 64; i++) {
+                            int x = mx * mcuW + (i % 8) * hY;
+                            int yy = my * mcuH + (i / 8) * vY;
+                            int luma = scene.at(x, yy);
+                            block[i] = ci == 1 ? 128 + (luma - 128) / 8 : 128 - (luma - 128) / 10;
+                        }
+                        encodeBlock(block, 1, pred[ci]);
+                    }
+                }
+            }
+        }
+        flushBits();
+        put16(0xFFD9);
+        return _out;
+    }
+
+private:
+    struct Code {
+        uint16_t code;
+        uint8_t length;
+    };
+
+    static int clampQuant(int q) { return q < 1 ? 1 : (q > 255 ? 255 : q); }
+
+    static void buildCodes(Code* codes, const uint8_t* bits, const uint8_t* values) {
+        memset(codes, 0, sizeof(Code) * 256);
+        int code = 0;
+        int k = 0;
+        for (int length = 1; length <= 16; length++) {
+            for (int i = 0; i < bits[length - 1]; i++) {
+                codes[values[k]].code = (uint16_t)code++;
+                codes[values[k]].length = (uint8_t)length;
+                k++;
+            }
+            code <<= 1;
+        }
+    }
+
+    void encodeBlock(const double* pixels, int table, int& pred) {
+        double coef[64];
+        for (int v = 0; v < 8; v++) {
+            for (int u = 0; u < 8; u++) {
+                double sum = 0;
+                for (int y = 0; y < 8; y++) {
+                    for (int x = 0; x < 8; x++) {
+                        sum += (pixels[y * 8 + x] - 128) * _cos[u][x] * _cos[v][y];
+                    }
+                }
+                coef[v * 8 + u] = sum;
+            }
+        }
+        int q[64];
+        for (int i = 0; i < 64; i++) {
+            int natural = kZigzag[i];
+            q[i] = (int)lround(coef[natural] / _quant[table][i]);
+        }
+
+        int diff = q[0] - pred;
+        pred = q[0];
+        int size = bitSize(diff);
+        putCode(_dcCodes[table][size]);
+        if (size) putBits(valueBits(diff, size), size);
+
+        int run = 0;
+        for (int i = 1; i < 64; i++) {
+            if (q[i] == 0) {
+                run++;
+                continue;
+            }
+            while (run > 15) {
+                putCode(_acCodes[table][0xF0]);
+                run -= 16;
+            }
+            int s = bitSize(q[i]);
+            putCode(_acCodes[table][(run << 4) | s]);
+            putBits(valueBits(q[i], s), s);
+            run = 0;
+        }
+        if (run > 0) putCode(_acCodes[table][0x00]);
+    }
+
+    static int bitSize(int v) {
+        if (v < 0) v = -v;
+        int n = 0;
+        while (v) {
+            n++;
+            v >>= 1;
+        }
+        return n;
+    }
+
+    static uint32_t valueBits(int v, int size) {
+        return (uint32_t)(v < 0 ? v + (1 << size) - 1 : v);
+    }
+
+    void putCode(const Code& code) { putBits(code.code, code.length); }
+
+    void putBits(uint32_t value, int length) {
+        _bitBuf = (_bitBuf << length) | (value & ((1u << length) - 1));
+        _bitCount += length;
+        while (_bitCount >= 8) {
+            uint8_t byte = (uint8_t)(_bitBuf >> (_bitCount - 8));
+            _out.push_back(byte);
+            if (byte == 0xFF) _out.push_back(0x00);
+            _bitCount -= 8;
+        }
+    }
+
+    void flushBits() {
+        if (_bitCount > 0) putBits(0x7F, 8 - _bitCount);  // pad with 1s
+        _bitBuf = 0;
+        _bitCount = 0;
+    }
+
+    void put16(uint16_t v) {
+        _out.push_back((uint8_t)(v >> 8));
+        _out.push_back((uint8_t)v);
+    }
+
+    void writeDqt(int table) {
+        put16(0xFFDB);
+        put16(67);
+        _out.push_back((uint8_t)table);
+        for (int i = 0; i < 64; i++) _out.push_back(_quant[table][i]);
+    }
+
+    void writeSof(const Scene& scene, int components, int hY, int vY) {
+        put16(0xFFC0);
+        put16((uint16_t)(8 + 3 * components));
+        _out.push_back(8);
+        put16((uint16_t)scene.height);
+        put16((uint16_t)scene.width);
+        _out.push_back((uint8_t)components);
+        for (int c = 0; c < components; c++) {
+            _out.push_back((uint8_t)(c + 1));
+            _out.push_back(c == 0 ? (uint8_t)((hY << 4) | vY) : 0x11);
+            _out.push_back(c == 0 ? 0 : 1);
+        }
+    }
+
+    void writeDht(uint8_t classId, const uint8_t* bits, const uint8_t* values) {
+        int total = 0;
+        for (int i = 0; i < 16; i++) total += bits[i];
+        put16(0xFFC4);
+        put16((uint16_t)(3 + 16 + total));
+        _out.push_back(classId);
+        for (int i = 0; i < 16; i++) _out.push_back(bits[i]);
+        for (int i = 0; i < total; i++) _out.push_back(values[i]);
+    }
+
+    void writeSos(int components) {
+        put16(0xFFDA);
+        put16((uint16_t)(6 + 2 * components));
+        _out.push_back((uint8_t)components);
+        for (int c = 0; c < components; c++) {
+            _out.push_back((uint8_t)(c + 1));
+            _out.push_back(c == 0 ? 0x00 : 0x11);
+        }
+        _out.push_back(0);
+        _out.push_back(63);
+        _out.push_back(0);
+    }
+
+    FixtureSampling _sampling;
+    uint16_t _restartInterval;
+    uint8_t _quant[2][64];   // zigzag order
+    Code _dcCodes[2][256];
+    Code _acCodes[2][256];
+    double _cos[8][8];
+    std::vector<uint8_t> _out;
+    uint32_t _bitBuf;
+    int _bitCount;
+};
+
+#endif // JPEG_FIXTURE_H
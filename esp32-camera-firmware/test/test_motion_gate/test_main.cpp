@@ -0,0 +1,364 @@
+/**
+ * `test_main.cpp`
+ * - Unit tests and benchmark for JpegDcDecoder / MotionGate (native host build)
+ * - Fixtures are encoded at run time from synthetic scenes (jpeg_fixture.h)
+ * - Run: pio test -e native -f test_motion_gate
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#include <unity.h>
+
+#include <stdio.h>
+
+#include <chrono>
+
+#include "JpegDcDecoder.h"
+#include "MotionGate.h"
+#include "jpeg_fixture.h"
+
+static const size_t MAX_BLOCKS = 81 * 61;
+static uint8_t thumbnail[MAX_BLOCKS];
+
+void setUp(void) {}
+void tearDown(void) {}
+
+/**
+ * Mean of the 8x8 block (edge pixels replicated, like the encoder)
+ */
+static int blockMean(const Scene& scene, int bx, int by) {
+    int sum = 0;
+    for (int i = 0; i < 64; i++) {
+        sum += scene.at(bx * 8 + i % 8, by * 8 + i / 8);
+    }
+    return (sum + 32) / 64;
+}
+
+static int maxThumbnailError(const Scene& scene, const JpegDcDecoder& decoder, const uint8_t* luma) {
+    int maxError = 0;
+    for (int by = 0; by < decoder.getHeightBlocks(); by++) {
+        for (int bx = 0; bx < decoder.getWidthBlocks(); bx++) {
+            int error = abs(blockMean(scene, bx, by) - luma[by * decoder.getWidthBlocks() + bx]);
+            if (error > maxError) maxError = error;
+        }
+    }
+    return maxError;
+}
+
+// ========================================
+// JpegDcDecoder
+// ========================================
+void test_dc_thumbnail_matches_block_means(void) {
+    Scene scene = makeFrame(makeBackground(320, 240), 1, 3, 0, 100, 60, 64, 96);
+    FixtureEncoder encoder(60, FixtureSampling::Yuv422);
+    std::vector<uint8_t> jpeg = encoder.encode(scene);
+
+    JpegDcDecoder decoder;
+    TEST_ASSERT_EQUAL(JpegDcError::None, decoder.decode(jpeg.data(), jpeg.size(), thumbnail, MAX_BLOCKS));
+    TEST_ASSERT_EQUAL(320, decoder.getWidth());
+    TEST_ASSERT_EQUAL(240, decoder.getHeight());
+    TEST_ASSERT_EQUAL(40, decoder.getWidthBlocks());
+    TEST_ASSERT_EQUAL(30, decoder.getHeightBlocks());
+    // DC quantization step is lumaDcQuant / 8 grey levels
+    TEST_ASSERT_LESS_OR_EQUAL(encoder.lumaDcQuant() / 8 + 1, maxThumbnailError(scene, decoder, thumbnail));
+}
+
+void test_decodes_all_sampling_modes_and_restart_markers(void) {
+    // Odd size: partial MCUs on the right and bottom edges
+    Scene scene = makeFrame(makeBackground(644, 482), 2, 3, 0, 300, 200, 80, 80);
+    const FixtureSampling modes[] = {FixtureSampling::Yuv422, FixtureSampling::Yuv420, FixtureSampling::Gray};
+
+    for (size_t m = 0; m < 3; m++) {
+        for (uint16_t restart = 0; restart <= 5; restart += 5) {
+            FixtureEncoder encoder(30, modes[m], restart);
+            std::vector<uint8_t> jpeg = encoder.encode(scene);
+            JpegDcDecoder decoder;
+            TEST_ASSERT_EQUAL(JpegDcError::None, decoder.decode(jpeg.data(), jpeg.size(), thumbnail, MAX_BLOCKS));
+            TEST_ASSERT_EQUAL(81, decoder.getWidthBlocks());
+            TEST_ASSERT_EQUAL(61, decoder.getHeightBlocks());
+            TEST_ASSERT_LESS_OR_EQUAL(encoder.lumaDcQuant() / 8 + 1, maxThumbnailError(scene, decoder, thumbnail));
+        }
+    }
+}
+
+void test_rejects_malformed_input(void) {
+    Scene scene = makeBackground(320, 240);
+    FixtureEncoder encoder(50, FixtureSampling::Yuv422);
+    std::vector<uint8_t> jpeg = encoder.encode(scene);
+    JpegDcDecoder decoder;
+
+    // Truncated in the middle of the scan
+    TEST_ASSERT_EQUAL(JpegDcError::Truncated, decoder.decode(jpeg.data(), jpeg.size() / 2, thumbnail, MAX_BLOCKS));
+
+    // Not a JPEG
+    const uint8_t garbage[] = {0x89, 'P', 'N', 'G', 0, 0, 0, 0};
+    TEST_ASSERT_EQUAL(JpegDcError::BadMarker, decoder.decode(garbage, sizeof(garbage), thumbnail, MAX_BLOCKS));
+
+    // Thumbnail does not fit
+    TEST_ASSERT_EQUAL(JpegDcError::TooLarge, decoder.decode(jpeg.data(), jpeg.size(), thumbnail, 100));
+
+    // Progressive (SOF2) is not supported
+    std::vector<uint8_t> progressive = jpeg;
+    for (size_t i = 0; i + 1 < progressive.size(); i++) {
+        if (progressive[i] == 0xFF && progressive[i + 1] == 0xC0) {
+            progressive[i + 1] = 0xC2;
+            break;
+        }
+    }
+    TEST_ASSERT_EQUAL(JpegDcError::Unsupported,
+                      decoder.decode(progressive.data(), progressive.size(), thumbnail, MAX_BLOCKS));
+
+    // Decoder recovers on the next good frame
+    TEST_ASSERT_EQUAL(JpegDcError::None, decoder.decode(jpeg.data(), jpeg.size(), thumbnail, MAX_BLOCKS));
+}
+
+// ========================================
+// MotionGate
+// ========================================
+static MotionGateConfig makeConfig() {
+    MotionGateConfig config;
+    config.maxBlocks = MAX_BLOCKS;
+    config.holdMs = 2000;
+    config.keepAliveMs = 5000;
+    return config;
+}
+
+void test_static_scene_is_gated_with_keep_alive(void) {
+    Scene background = makeBackground(320, 240);
+    FixtureEncoder encoder(40, FixtureSampling::Yuv422);
+    MotionGate gate(makeConfig());
+
+    // 20 s of a static, noisy scene at 10 FPS
+    uint32_t sent = 0;
+    for (uint32_t i = 0; i < 200; i++) {
+        std::vector<uint8_t> jpeg = encoder.encode(makeFrame(background, 100 + i, 4, 0, 0, 0, 0, 0));
+        MotionResult result = gate.evaluate(jpeg.data(), jpeg.size(), i * 100);
+        TEST_ASSERT_TRUE(result.decoded);
+        TEST_ASSERT_FALSE(result.motion);
+        if (result.send) sent++;
+    }
+    // First frame + one keep-alive every 5 s
+    TEST_ASSERT_EQUAL(4, sent);
+    MotionGateStats stats = gate.getStats();
+    TEST_ASSERT_EQUAL(3, stats.keepAlives);
+    TEST_ASSERT_EQUAL(196, stats.gated);
+    TEST_ASSERT_LESS_THAN(15, stats.peakScore);
+}
+
+void test_exposure_change_is_not_motion(void) {
+    Scene background = makeBackground(320, 240);
+    FixtureEncoder encoder(40, FixtureSampling::Yuv422);
+    MotionGate gate(makeConfig());
+
+    std::vector<uint8_t> jpeg = encoder.encode(makeFrame(background, 1, 3, 0, 0, 0, 0, 0));
+    gate.evaluate(jpeg.data(), jpeg.size(), 0);
+    jpeg = encoder.encode(makeFrame(background, 2, 3, 18, 0, 0, 0, 0));  // auto exposure step
+    MotionResult result = gate.evaluate(jpeg.data(), jpeg.size(), 100);
+    TEST_ASSERT_FALSE(result.motion);
+    TEST_ASSERT_FALSE(result.send);
+}
+
+void test_motion_sends_full_rate_then_holds(void) {
+    Scene background = makeBackground(320, 240);
+    FixtureEncoder encoder(40, FixtureSampling::Yuv422);
+    MotionGate gate(makeConfig());
+    uint32_t nowMs = 0;
+
+    for (int i = 0; i < 10; i++, nowMs += 100) {
+        std::vector<uint8_t> jpeg = encoder.encode(makeFrame(background, i, 3, 0, 0, 0, 0, 0));
+        gate.evaluate(jpeg.data(), jpeg.size(), nowMs);
+    }
+
+    // A 40x60 object walks across the frame: every frame is sent
+    for (int i = 0; i < 20; i++, nowMs += 100) {
+        std::vector<uint8_t> jpeg = encoder.encode(makeFrame(background, 50 + i, 3, 0, 10 + i * 12, 90, 40, 60));
+        MotionResult result = gate.evaluate(jpeg.data(), jpeg.size(), nowMs);
+        TEST_ASSERT_TRUE(result.motion);
+        TEST_ASSERT_TRUE(result.send);
+        TEST_ASSERT_GREATER_THAN(15, result.score);
+    }
+
+    // Object leaves: full rate continues for holdMs, then the gate closes
+    uint32_t lastMotionMs = nowMs - 100;
+    for (int i = 0; i < 30; i++, nowMs += 100) {
+        std::vector<uint8_t> jpeg = encoder.encode(makeFrame(background, 90 + i, 3, 0, 0, 0, 0, 0));
+        MotionResult result = gate.evaluate(jpeg.data(), jpeg.size(), nowMs);
+        if (nowMs - lastMotionMs < 2000) {
+            TEST_ASSERT_TRUE(result.send);
+        }
+        if (!result.motion && nowMs - lastMotionMs >= 2500) {
+            TEST_ASSERT_FALSE(result.send);
+        }
+    }
+}
+
+void test_stopped_object_fades_into_background(void) {
+    Scene background = makeBackground(320, 240);
+    FixtureEncoder encoder(40, FixtureSampling::Yuv422);
+    MotionGate gate(makeConfig());
+
+    std::vector<uint8_t> jpeg = encoder.encode(makeFrame(background, 1, 3, 0, 0, 0, 0, 0));
+    gate.evaluate(jpeg.data(), jpeg.size(), 0);
+
+    // Parked object: motion at first, static after the background catches up
+    MotionResult first = {0, false, false, false};
+    MotionResult last = {0, false, false, false};
+    for (int i = 1; i <= 100; i++) {
+        jpeg = encoder.encode(makeFrame(background, 1 + i, 3, 0, 120, 80, 64, 64));
+        MotionResult result = gate.evaluate(jpeg.data(), jpeg.size(), i * 100);
+        if (i == 1) first = result;
+        last = result;
+    }
+    TEST_ASSERT_TRUE(first.motion);
+    TEST_ASSERT_FALSE(last.motion);
+}
+
+void test_resolution_change_restarts_background(void) {
+    MotionGate gate(makeConfig());
+    FixtureEncoder encoder(40, FixtureSampling::Yuv422);
+
+    std::vector<uint8_t> small = encoder.encode(makeBackground(320, 240));
+    std::vector<uint8_t> large = encoder.encode(makeBackground(480, 320));
+    gate.evaluate(small.data(), small.size(), 0);
+    TEST_ASSERT_FALSE(gate.evaluate(small.data(), small.size(), 100).send);
+
+    // ABR switched frame size: first frame at the new size is always sent
+    MotionResult result = gate.evaluate(large.data(), large.size(), 200);
+    TEST_ASSERT_TRUE(result.send);
+    TEST_ASSERT_FALSE(result.motion);
+    TEST_ASSERT_EQUAL(60, gate.getStats().widthBlocks);
+    TEST_ASSERT_FALSE(gate.evaluate(large.data(), large.size(), 300).send);
+}
+
+void test_reserve_grows_for_larger_frames(void) {
+    MotionGateConfig config = makeConfig();
+    config.maxBlocks = 40 * 30;
+    MotionGate gate(config);
+    FixtureEncoder encoder(40, FixtureSampling::Yuv422);
+    std::vector<uint8_t> large = encoder.encode(makeBackground(480, 320));
+
+    // Too large for the thumbnail: fails open
+    TEST_ASSERT_FALSE(gate.evaluate(large.data(), large.size(), 0).decoded);
+
+    // New stream profile: buffers grow, then the frame size is gated as usual
+    gate.reserve(60 * 40);
+    TEST_ASSERT_EQUAL(60 * 40, gate.getConfig().maxBlocks);
+    TEST_ASSERT_TRUE(gate.evaluate(large.data(), large.size(), 100).send);
+    TEST_ASSERT_FALSE(gate.evaluate(large.data(), large.size(), 200).send);
+
+    // Never shrinks; the background restarts
+    gate.reserve(10);
+    TEST_ASSERT_EQUAL(60 * 40, gate.getConfig().maxBlocks);
+    TEST_ASSERT_TRUE(gate.evaluate(large.data(), large.size(), 300).send);
+}
+
+void test_decode_error_fails_open(void) {
+    MotionGate gate(makeConfig());
+    const uint8_t broken[] = {0xFF, 0xD8, 0xFF, 0xDB, 0x00};
+    MotionResult result = gate.evaluate(broken, sizeof(broken), 0);
+    TEST_ASSERT_FALSE(result.decoded);
+    TEST_ASSERT_TRUE(result.send);
+    TEST_ASSERT_EQUAL(1, gate.getStats().decodeErrors);
+}
+
+void test_disabled_gate_scores_but_passes(void) {
+    MotionGateConfig config = makeConfig();
+    config.enabled = false;
+    MotionGate gate(config);
+    FixtureEncoder encoder(40, FixtureSampling::Yuv422);
+    Scene background = makeBackground(320, 240);
+
+    std::vector<uint8_t> jpeg = encoder.encode(background);
+    gate.evaluate(jpeg.data(), jpeg.size(), 0);
+    jpeg = encoder.encode(makeFrame(background, 1, 0, 0, 0, 0, 0, 0));
+    TEST_ASSERT_TRUE(gate.evaluate(jpeg.data(), jpeg.size(), 100).send);
+    jpeg = encoder.encode(makeFrame(background, 2, 0, 0, 100, 100, 80, 80));
+    MotionResult result = gate.evaluate(jpeg.data(), jpeg.size(), 200);
+    TEST_ASSERT_TRUE(result.send);
+    TEST_ASSERT_TRUE(result.motion);
+    TEST_ASSERT_EQUAL(0, gate.getStats().gated);
+}
+
+// ========================================
+// Benchmark
+// ========================================
+
+/**
+ * DC decode throughput per resolution/quality, and upload savings on a mostly static clip
+ */
+void test_benchmark(void) {
+    struct Case {
+        const char* name;
+        int width;
+        int height;
+        int quality;
+    };
+    static const Case cases[] = {
+        {"QVGA q85", 320, 240, 85}, {"QVGA q50", 320, 240, 50},
+        {"HVGA q85", 480, 320, 85}, {"HVGA q50", 480, 320, 50},
+        {"VGA  q85", 640, 480, 85}, {"VGA  q50", 640, 480, 50},
+    };
+    const int iterations = 50;
+
+    printf("\n  %-10s %8s %10s %9s\n", "fixture", "bytes", "us/frame", "MB/s");
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+        FixtureEncoder encoder(cases[c].quality, FixtureSampling::Yuv422);
+        Scene scene = makeFrame(makeBackground(cases[c].width, cases[c].height), 7, 4, 0, 50, 50, 80, 120);
+        std::vector<uint8_t> jpeg = encoder.encode(scene);
+
+        JpegDcDecoder decoder;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; i++) {
+            TEST_ASSERT_EQUAL(JpegDcError::None, decoder.decode(jpeg.data(), jpeg.size(), thumbnail, MAX_BLOCKS));
+        }
+        double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+        double perFrame = us / iterations;
+        printf("  %-10s %8u %10.1f %9.1f\n", cases[c].name, (unsigned)jpeg.size(), perFrame, jpeg.size() / perFrame);
+    }
+
+    // 60 s clip at 10 FPS: static room with two 3 s walk-throughs
+    Scene background = makeBackground(320, 240);
+    FixtureEncoder encoder(40, FixtureSampling::Yuv422);
+    MotionGate gate(makeConfig());
+    size_t totalBytes = 0;
+    size_t sentBytes = 0;
+    uint32_t motionMissed = 0;
+    for (uint32_t i = 0; i < 600; i++) {
+        bool walking = (i >= 150 && i < 180) || (i >= 420 && i < 450);
+        int objX = walking ? (int)((i % 30) * 9) : 0;
+        std::vector<uint8_t> jpeg = encoder.encode(makeFrame(background, 1000 + i, 4, 0, objX, 70, walking ? 40 : 0, 90));
+        MotionResult result = gate.evaluate(jpeg.data(), jpeg.size(), i * 100);
+        totalBytes += jpeg.size();
+        if (result.send) sentBytes += jpeg.size();
+        if (walking && !result.send) motionMissed++;
+    }
+    MotionGateStats stats = gate.getStats();
+    printf("  clip: %u frames, %u sent (%u keep-alive), %u gated, upload %u -> %u bytes (%.0f%% saved)\n",
+           stats.frames, stats.passed, stats.keepAlives, stats.gated, (unsigned)totalBytes, (unsigned)sentBytes,
+           100.0 * (totalBytes - sentBytes) / totalBytes);
+
+    TEST_ASSERT_EQUAL(0, motionMissed);
+    TEST_ASSERT_LESS_THAN(totalBytes / 4, sentBytes);
+}
+
+int main(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+    UNITY_BEGIN();
+    RUN_TEST(test_dc_thumbnail_matches_block_means);
+    RUN_TEST(test_decodes_all_sampling_modes_and_restart_markers);
+    RUN_TEST(test_rejects_malformed_input);
+    RUN_TEST(test_static_scene_is_gated_with_keep_alive);
+    RUN_TEST(test_exposure_change_is_not_motion);
+    RUN_TEST(test_motion_sends_full_rate_then_holds);
+    RUN_TEST(test_stopped_object_fades_into_background);
+    RUN_TEST(test_resolution_change_restarts_background);
+    RUN_TEST(test_reserve_grows_for_larger_frames);
+    RUN_TEST(test_decode_error_fails_open);
+    RUN_TEST(test_disabled_gate_scores_but_passes);
+    RUN_TEST(test_benchmark);
+    return UNITY_END();
+}
@@ -0,0 +1,516 @@
+/**
+ * `test_main.cpp`
+ * - Unit tests for the RTP/JPEG transport (native host build)
+ * - Packetizer/depacketizer round trips with JPEGs encoded like the OV2640 output
+ *   (jpeg_fixture.h), parity repair of every single-loss position, resync after a lost frame
+ * - RtpSender runs over a real loopback UDP socket; loss is injected on the receiving side
+ * - Run: pio test -e native -f test_rtp_jpeg
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#include <unity.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#include "JpegDcDecoder.h"
+#include "RtpJpegDepacketizer.h"
+#include "RtpJpegPacketizer.h"
+#include "RtpJpegTables.h"
+#include "RtpSender.h"
+
+#include "../test_motion_gate/jpeg_fixture.h"
+
+void setUp(void) {}
+void tearDown(void) {}
+
+// ========================================
+// Helpers
+// ========================================
+static const size_t kFrameCapacity = 256 * 1024;
+static uint8_t frameBuffer[kFrameCapacity];
+
+typedef std::vector<std::vector<uint8_t>> PacketList;
+
+/**
+ * Scene as the OV2640 would encode it (quality 12 → libjpeg ~82, 4:2:2)
+ */
+static std::vector<uint8_t> makeJpeg(int width, int height, uint32_t seed = 1,
+                                     FixtureSampling sampling = FixtureSampling::Yuv422, uint16_t restart = 0) {
+    FixtureEncoder encoder(82, sampling, restart);
+    Scene scene = makeFrame(makeBackground(width, height), seed, 4, 0, width / 4 + (int)(seed % 7) * 8,
+                            height / 3, width / 5, height / 3);
+    return encoder.encode(scene);
+}
+
+static RtpJpegConfig makeConfig(uint8_t fecGroup) {
+    RtpJpegConfig config;
+    config.fecGroup = fecGroup;
+    return config;
+}
+
+static PacketList packetize(RtpJpegPacketizer& packetizer, const std::vector<uint8_t>& jpeg, uint32_t timestamp) {
+    PacketList packets;
+    TEST_ASSERT_EQUAL(RtpJpegError::None, packetizer.begin(jpeg.data(), jpeg.size(), timestamp));
+    RtpPacket packet;
+    while (packetizer.next(packet)) {
+        packets.push_back(std::vector<uint8_t>(packet.data, packet.data + packet.length));
+    }
+    return packets;
+}
+
+static bool isParity(const std::vector<uint8_t>& packet) {
+    return (packet[1] & 0x7F) == 127;
+}
+
+/**
+ * Feed packets, skipping the indices in `lost`
+ * @return Results of the accepts that completed a frame
+ */
+static int deliver(RtpJpegDepacketizer& receiver, const PacketList& packets, const std::vector<size_t>& lost = {}) {
+    int completed = 0;
+    for (size_t i = 0; i < packets.size(); i++) {
+        if (std::find(lost.begin(), lost.end(), i) != lost.end()) {
+            continue;
+        }
+        if (receiver.accept(packets[i].data(), packets[i].size()) == RtpReceiveResult::Complete) {
+            completed++;
+        }
+    }
+    return completed;
+}
+
+/**
+ * Same DC thumbnail as the original (the rebuilt JPEG decodes to the same image)
+ */
+static void assertSameImage(const std::vector<uint8_t>& original, const uint8_t* rebuilt, size_t length) {
+    static uint8_t expected[64 * 1024];
+    static uint8_t actual[64 * 1024];
+    JpegDcDecoder decoder;
+    TEST_ASSERT_EQUAL(JpegDcError::None, decoder.decode(original.data(), original.size(), expected, sizeof(expected)));
+    size_t blocks = (size_t)decoder.getWidthBlocks() * decoder.getHeightBlocks();
+    TEST_ASSERT_EQUAL(JpegDcError::None, decoder.decode(rebuilt, length, actual, sizeof(actual)));
+    TEST_ASSERT_EQUAL_MEMORY(expected, actual, blocks);
+
+    RtpJpegScan a;
+    RtpJpegScan b;
+    TEST_ASSERT_EQUAL(RtpJpegError::None, RtpJpegPacketizer::parse(original.data(), original.size(), a));
+    TEST_ASSERT_EQUAL(RtpJpegError::None, RtpJpegPacketizer::parse(rebuilt, length, b));
+    TEST_ASSERT_EQUAL(a.length, b.length);
+    TEST_ASSERT_EQUAL_MEMORY(a.data, b.data, a.length);
+    TEST_ASSERT_EQUAL_MEMORY(a.quant, b.quant, kRtpQuantTablesSize);
+}
+
+// ========================================
+// JPEG Parsing
+// ========================================
+void test_parse_reads_rfc2435_fields() {
+    std::vector<uint8_t> jpeg = makeJpeg(480, 320);
+    RtpJpegScan scan;
+    TEST_ASSERT_EQUAL(RtpJpegError::None, RtpJpegPacketizer::parse(jpeg.data(), jpeg.size(), scan));
+    TEST_ASSERT_EQUAL(0, scan.type);
+    TEST_ASSERT_EQUAL(480, scan.width);
+    TEST_ASSERT_EQUAL(320, scan.height);
+    TEST_ASSERT_EQUAL(0, scan.restartInterval);
+    TEST_ASSERT_TRUE(scan.data > jpeg.data() && scan.data + scan.length == jpeg.data() + jpeg.size() - 2);
+
+    jpeg = makeJpeg(320, 240, 1, FixtureSampling::Yuv420, 10);
+    TEST_ASSERT_EQUAL(RtpJpegError::None, RtpJpegPacketizer::parse(jpeg.data(), jpeg.size(), scan));
+    TEST_ASSERT_EQUAL(64 + 1, scan.type);
+    TEST_ASSERT_EQUAL(10, scan.restartInterval);
+
+    // Driver padding behind EOI is not part of the scan
+    std::vector<uint8_t> padded = makeJpeg(320, 240);
+    size_t length = padded.size();
+    padded.resize(length + 37, 0);
+    TEST_ASSERT_EQUAL(RtpJpegError::None, RtpJpegPacketizer::parse(padded.data(), padded.size(), scan));
+    TEST_ASSERT_TRUE(scan.data + scan.length == padded.data() + length - 2);
+}
+
+void test_parse_rejects_unrepresentable_jpegs() {
+    RtpJpegScan scan;
+    std::vector<uint8_t> gray = makeJpeg(320, 240, 1, FixtureSampling::Gray);
+    TEST_ASSERT_EQUAL(RtpJpegError::Unsupported, RtpJpegPacketizer::parse(gray.data(), gray.size(), scan));
+
+    std::vector<uint8_t> jpeg = makeJpeg(320, 240);
+    TEST_ASSERT_EQUAL(RtpJpegError::BadMarker, RtpJpegPacketizer::parse(jpeg.data() + 1, jpeg.size() - 1, scan));
+    TEST_ASSERT_EQUAL(RtpJpegError::BadMarker, RtpJpegPacketizer::parse(jpeg.data(), jpeg.size() / 2, scan));
+
+    // Optimized (non-standard) Huffman table: the receiver could not rebuild it
+    std::vector<uint8_t> custom = jpeg;
+    for (size_t i = 2; i + 4 < custom.size(); i++) {
+        if (custom[i] == 0xFF && custom[i + 1] == 0xC4) {
+            custom[i + 5 + 16] ^= 1;  // first DC value
+            break;
+        }
+    }
+    TEST_ASSERT_EQUAL(RtpJpegError::Unsupported, RtpJpegPacketizer::parse(custom.data(), custom.size(), scan));
+}
+
+// ========================================
+// Packetizing
+// ========================================
+void test_packets_carry_rfc2435_headers_within_mtu() {
+    RtpJpegConfig config = makeConfig(4);
+    config.mtu = 1200;
+    config.firstSequence = 100;
+    RtpJpegPacketizer packetizer(config);
+    std::vector<uint8_t> jpeg = makeJpeg(640, 480);
+    PacketList packets = packetize(packetizer, jpeg, 123456);
+
+    RtpJpegScan scan;
+    RtpJpegPacketizer::parse(jpeg.data(), jpeg.size(), scan);
+    TEST_ASSERT_EQUAL(packetizer.packetCount(scan.length, false), packets.size());
+
+    uint32_t expectedOffset = 0;
+    size_t media = 0;
+    for (size_t i = 0; i < packets.size(); i++) {
+        const std::vector<uint8_t>& p = packets[i];
+        TEST_ASSERT_TRUE(p.size() <= config.mtu);
+        TEST_ASSERT_EQUAL_UINT8(0x80, p[0]);
+        TEST_ASSERT_EQUAL(100 + i, (p[2] << 8) | p[3]);
+        TEST_ASSERT_EQUAL(123456, ((uint32_t)p[4] << 24) | (p[5] << 16) | (p[6] << 8) | p[7]);
+        TEST_ASSERT_EQUAL_UINT32(config.ssrc, ((uint32_t)p[8] << 24) | (p[9] << 16) | (p[10] << 8) | p[11]);
+        if (isParity(p)) {
+            TEST_ASSERT_EQUAL(0, p[1] & 0x80);
+            continue;
+        }
+        media++;
+        TEST_ASSERT_EQUAL(kRtpPayloadJpeg, p[1] & 0x7F);
+        const uint8_t* h = &p[kRtpHeaderSize];
+        uint32_t offset = ((uint32_t)h[1] << 16) | (h[2] << 8) | h[3];
+        TEST_ASSERT_EQUAL(expectedOffset, offset);
+        TEST_ASSERT_EQUAL(0, h[4]);
+        TEST_ASSERT_EQUAL(255, h[5]);
+        TEST_ASSERT_EQUAL(640 / 8, h[6]);
+        TEST_ASSERT_EQUAL(480 / 8, h[7]);
+        size_t header = kRtpHeaderSize + kRtpJpegHeaderSize;
+        if (offset == 0) {
+            TEST_ASSERT_EQUAL(kRtpQuantTablesSize, (h[10] << 8) | h[11]);
+            TEST_ASSERT_EQUAL_MEMORY(scan.quant, h + 12, kRtpQuantTablesSize);
+            header += kRtpQuantHeaderSize + kRtpQuantTablesSize;
+        }
+        expectedOffset += (uint32_t)(p.size() - header);
+        bool marker = (p[1] & 0x80) != 0;
+        TEST_ASSERT_EQUAL(expectedOffset == scan.length, marker);
+    }
+    TEST_ASSERT_EQUAL(scan.length, expectedOffset);
+    TEST_ASSERT_EQUAL((media + 3) / 4, packets.size() - media);
+    TEST_ASSERT_FALSE(isParity(packets[packets.size() - 2]));   // marker packet, then its parity
+    TEST_ASSERT_TRUE(isParity(packets.back()));
+}
+
+// ========================================
+// Reassembly
+// ========================================
+void test_roundtrip_rebuilds_same_image() {
+    for (uint8_t fecGroup : {0, 4}) {
+        RtpJpegPacketizer packetizer(makeConfig(fecGroup));
+        RtpJpegDepacketizer receiver(frameBuffer, kFrameCapacity, RtpJpegReceiverConfig());
+        for (uint32_t f = 0; f < 3; f++) {
+            std::vector<uint8_t> jpeg = makeJpeg(480, 320, f);
+            PacketList packets = packetize(packetizer, jpeg, f * 9000);
+            TEST_ASSERT_EQUAL(1, deliver(receiver, packets));
+            TEST_ASSERT_EQUAL(f * 9000, receiver.frameTimestamp());
+            assertSameImage(jpeg, receiver.frame(), receiver.frameLength());
+        }
+        TEST_ASSERT_EQUAL(3, receiver.getStats().frames);
+        TEST_ASSERT_EQUAL(0, receiver.getStats().lostFrames);
+    }
+
+    // Restart markers and 4:2:0 (type 65)
+    RtpJpegPacketizer packetizer(makeConfig(4));
+    RtpJpegDepacketizer receiver(frameBuffer, kFrameCapacity, RtpJpegReceiverConfig());
+    std::vector<uint8_t> jpeg = makeJpeg(640, 480, 3, FixtureSampling::Yuv420, 8);
+    TEST_ASSERT_EQUAL(1, deliver(receiver, packetize(packetizer, jpeg, 1)));
+    assertSameImage(jpeg, receiver.frame(), receiver.frameLength());
+}
+
+void test_q_factor_frames_use_scaled_tables() {
+    // RFC 2435 Appendix A scaling is libjpeg's: Q 82 reproduces the fixture's DQT
+    std::vector<uint8_t> jpeg = makeJpeg(480, 320, 2);
+    RtpJpegScan scan;
+    RtpJpegPacketizer::parse(jpeg.data(), jpeg.size(), scan);
+    uint8_t tables[kRtpQuantTablesSize];
+    rtpJpegMakeTables(82, tables);
+    TEST_ASSERT_EQUAL_MEMORY(scan.quant, tables, kRtpQuantTablesSize);
+
+    // A sender using Q 82 leaves the tables out of the first packet
+    RtpJpegPacketizer packetizer(makeConfig(0));
+    PacketList packets = packetize(packetizer, jpeg, 5);
+    std::vector<uint8_t>& first = packets[0];
+    size_t quantHeader = kRtpHeaderSize + kRtpJpegHeaderSize;
+    first.erase(first.begin() + quantHeader, first.begin() + quantHeader + kRtpQuantHeaderSize + kRtpQuantTablesSize);
+    first[kRtpHeaderSize + 5] = 82;
+    RtpJpegDepacketizer receiver(frameBuffer, kFrameCapacity, RtpJpegReceiverConfig());
+    TEST_ASSERT_EQUAL(1, deliver(receiver, packets));
+    assertSameImage(jpeg, receiver.frame(), receiver.frameLength());
+}
+
+void test_parity_repairs_any_single_loss_per_group() {
+    std::vector<uint8_t> jpeg = makeJpeg(640, 480, 5);
+    RtpJpegPacketizer packetizer(makeConfig(4));
+    PacketList packets = packetize(packetizer, jpeg, 777);
+
+    // Every media position, the first (tables) and the marker packet included
+    for (size_t lost = 0; lost < packets.size(); lost++) {
+        if (isParity(packets[lost])) {
+            continue;
+        }
+        RtpJpegDepacketizer receiver(frameBuffer, kFrameCapacity, RtpJpegReceiverConfig());
+        TEST_ASSERT_EQUAL(1, deliver(receiver, packets, {lost}));
+        TEST_ASSERT_EQUAL(1, receiver.getStats().recovered);
+        assertSameImage(jpeg, receiver.frame(), receiver.frameLength());
+    }
+
+    // One loss in each group at once
+    std::vector<size_t> lost;
+    for (size_t i = 0; i < packets.size(); i += 5) {
+        lost.push_back(i + 1);
+    }
+    RtpJpegDepacketizer receiver(frameBuffer, kFrameCapacity, RtpJpegReceiverConfig());
+    TEST_ASSERT_EQUAL(1, deliver(receiver, packets, lost));
+    TEST_ASSERT_EQUAL(lost.size(), receiver.getStats().recovered);
+}
+
+void test_unrepairable_loss_costs_only_its_frame() {
+    RtpJpegPacketizer packetizer(makeConfig(4));
+    RtpJpegDepacketizer receiver(frameBuffer, kFrameCapacity, RtpJpegReceiverConfig());
+    std::vector<uint8_t> first = makeJpeg(480, 320, 1);
+    std::vector<uint8_t> second = makeJpeg(480, 320, 2);
+
+    TEST_ASSERT_EQUAL(0, deliver(receiver, packetize(packetizer, first, 1000), {1, 2}));  // two in one group
+    TEST_ASSERT_EQUAL(1, deliver(receiver, packetize(packetizer, second, 10000)));
+    assertSameImage(second, receiver.frame(), receiver.frameLength());
+    TEST_ASSERT_EQUAL(1, receiver.getStats().lostFrames);
+    TEST_ASSERT_EQUAL(1, receiver.getStats().frames);
+
+    // Without parity any loss costs the frame
+    RtpJpegPacketizer plain(makeConfig(0));
+    RtpJpegDepacketizer plainReceiver(frameBuffer, kFrameCapacity, RtpJpegReceiverConfig());
+    TEST_ASSERT_EQUAL(0, deliver(plainReceiver, packetize(plain, first, 1000), {3}));
+    TEST_ASSERT_EQUAL(1, deliver(plainReceiver, packetize(plain, second, 10000)));
+    TEST_ASSERT_EQUAL(1, plainReceiver.getStats().lostFrames);
+
+    // A late packet of the abandoned frame is dropped, the current frame is kept
+    PacketList late = packetize(plain, first, 1000);
+    TEST_ASSERT_EQUAL(RtpReceiveResult::Dropped, plainReceiver.accept(late[0].data(), late[0].size()));
+}
+
+void test_reordered_and_duplicated_packets() {
+    std::vector<uint8_t> jpeg = makeJpeg(640, 480, 9);
+    RtpJpegConfig config = makeConfig(4);
+    config.firstSequence = 65530;  // group spans the sequence wrap
+    RtpJpegPacketizer packetizer(config);
+    PacketList packets = packetize(packetizer, jpeg, 42);
+
+    PacketList shuffled = packets;
+    FixtureRandom random{12345};
+    for (size_t i = shuffled.size() - 1; i > 0; i--) {
+        std::swap(shuffled[i], shuffled[random.next((int)i + 1)]);
+    }
+    shuffled.insert(shuffled.begin() + 3, shuffled[1]);
+    RtpJpegDepacketizer receiver(frameBuffer, kFrameCapacity, RtpJpegReceiverConfig());
+    TEST_ASSERT_EQUAL(1, deliver(receiver, shuffled, {0}));
+    assertSameImage(jpeg, receiver.frame(), receiver.frameLength());
+    TEST_ASSERT_EQUAL(1, receiver.getStats().frames);
+    // The injected copy, plus members that arrived after parity had already rebuilt them
+    TEST_ASSERT_GREATER_OR_EQUAL(1, (int)receiver.getStats().duplicates);
+}
+
+// ========================================
+// Loopback UDP
+// ========================================
+/**
+ * UDP receiver on an ephemeral loopback port
+ */
+struct LoopbackReceiver {
+    int fd;
+    uint16_t port;
+
+    LoopbackReceiver() : fd(-1), port(0) {
+        fd = socket(AF_INET, SOCK_DGRAM, 0);
+        int buffer = 4 * 1024 * 1024;
+        setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &buffer, sizeof(buffer));
+        struct timeval timeout = {0, 20000};
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        struct sockaddr_in address = {};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t length = sizeof(address);
+        bind(fd, (struct sockaddr*)&address, sizeof(address));
+        getsockname(fd, (struct sockaddr*)&address, &length);
+        port = ntohs(address.sin_port);
+    }
+
+    ~LoopbackReceiver() { close(fd); }
+
+    /**
+     * Drain queued datagrams into the receiver, dropping `lossPercent` of them
+     * @return Frames completed
+     */
+    int drain(RtpJpegDepacketizer& receiver, FixtureRandom& random, uint32_t lossPercent, uint32_t& datagrams) {
+        uint8_t packet[2048];
+        int completed = 0;
+        for (;;) {
+            ssize_t length = recv(fd, packet, sizeof(packet), 0);
+            if (length <= 0) {
+                return completed;
+            }
+            datagrams++;
+            if ((uint32_t)random.next(100) < lossPercent) {
+                continue;
+            }
+            if (receiver.accept(packet, (size_t)length) == RtpReceiveResult::Complete) {
+                completed++;
+            }
+        }
+    }
+};
+
+void test_sender_over_loopback_with_injected_loss() {
+    const uint32_t frames = 60;
+    const uint32_t lossPercent = 3;
+    int delivered[2] = {0, 0};
+    for (int withFec = 0; withFec < 2; withFec++) {
+        LoopbackReceiver sink;
+        RtpSenderConfig config;
+        config.rtp.fecGroup = withFec ? 4 : 0;
+        RtpSender sender(config);
+        TEST_ASSERT_TRUE(sender.open("127.0.0.1", sink.port));
+
+        RtpJpegDepacketizer receiver(frameBuffer, kFrameCapacity, RtpJpegReceiverConfig());
+        FixtureRandom random{2026};
+        uint32_t datagrams = 0;
+        std::vector<uint8_t> jpeg = makeJpeg(480, 320, 4);
+        for (uint32_t f = 0; f < frames; f++) {
+            TEST_ASSERT_EQUAL(RtpSendResult::Sent, sender.sendFrame(jpeg.data(), jpeg.size(), f * 100000ULL));
+            int completed = sink.drain(receiver, random, lossPercent, datagrams);
+            if (completed > 0) {
+                assertSameImage(jpeg, receiver.frame(), receiver.frameLength());
+            }
+            delivered[withFec] += completed;
+        }
+        TEST_ASSERT_EQUAL(sender.getStats().packets, datagrams);
+        TEST_ASSERT_EQUAL(frames, sender.getStats().frames);
+    }
+    printf("  loopback, %u%% loss: %d/%u frames without parity, %d/%u with 1 parity per 4\n", lossPercent,
+           delivered[0], frames, delivered[1], frames);
+    TEST_ASSERT_GREATER_THAN(delivered[0], delivered[1]);
+    TEST_ASSERT_GREATER_OR_EQUAL((int)(frames * 8 / 10), delivered[1]);
+
+    // Grayscale cannot be carried: the caller falls back to the WebSocket path
+    RtpSender sender{RtpSenderConfig()};
+    LoopbackReceiver sink;
+    TEST_ASSERT_TRUE(sender.open("127.0.0.1", sink.port));
+    std::vector<uint8_t> gray = makeJpeg(320, 240, 1, FixtureSampling::Gray);
+    TEST_ASSERT_EQUAL(RtpSendResult::Unsupported, sender.sendFrame(gray.data(), gray.size(), 0));
+    TEST_ASSERT_EQUAL(1, sender.getStats().unsupported);
+}
+
+// ========================================
+// Benchmark
+// ========================================
+void test_benchmark(void) {
+    // Delivered frames over a random-loss channel, 300 HVGA frames per cell
+    static const uint32_t losses[] = {0, 1, 2, 5, 10};
+    static const uint8_t groups[] = {0, 8, 4, 2};
+    const uint32_t frames = 300;
+    std::vector<uint8_t> jpeg = makeJpeg(480, 320, 6);
+
+    printf("\n  HVGA %u bytes, MTU 1400: frames delivered (%%) by packet loss\n", (unsigned)jpeg.size());
+    printf("  %-12s %9s", "parity", "overhead");
+    for (uint32_t loss : losses) {
+        printf(" %6u%%", loss);
+    }
+    printf("\n");
+    double delivered4At5 = 0;
+    double deliveredNoneAt5 = 0;
+    for (uint8_t group : groups) {
+        RtpJpegPacketizer packetizer(makeConfig(group));
+        PacketList packets = packetize(packetizer, jpeg, 0);
+        RtpJpegStats stats = packetizer.getStats();
+        char label[16];
+        snprintf(label, sizeof(label), group == 0 ? "none" : "1 per %u", group);
+        printf("  %-12s %8.1f%%", label, 100.0 * (stats.wireBytes - stats.scanBytes) / stats.scanBytes);
+        for (uint32_t loss : losses) {
+            RtpJpegDepacketizer receiver(frameBuffer, kFrameCapacity, RtpJpegReceiverConfig());
+            FixtureRandom random{7 + loss};
+            int completed = 0;
+            for (uint32_t f = 0; f < frames; f++) {
+                PacketList frame = packetize(packetizer, jpeg, f * 9000);
+                for (const std::vector<uint8_t>& p : frame) {
+                    if ((uint32_t)random.next(1000) < loss * 10) {
+                        continue;
+                    }
+                    completed += receiver.accept(p.data(), p.size()) == RtpReceiveResult::Complete ? 1 : 0;
+                }
+            }
+            double percent = 100.0 * completed / frames;
+            printf(" %6.1f%%", percent);
+            if (loss == 5) {
+                delivered4At5 = group == 4 ? percent : delivered4At5;
+                deliveredNoneAt5 = group == 0 ? percent : deliveredNoneAt5;
+            }
+        }
+        printf("\n");
+    }
+
+    // Per-frame cost of both ends
+    RtpJpegPacketizer packetizer(makeConfig(4));
+    RtpJpegDepacketizer receiver(frameBuffer, kFrameCapacity, RtpJpegReceiverConfig());
+    const int iterations = 500;
+    RtpPacket packet;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        packetizer.begin(jpeg.data(), jpeg.size(), (uint32_t)i);
+        while (packetizer.next(packet)) {
+        }
+    }
+    double packetizeUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    PacketList packets = packetize(packetizer, jpeg, 0);
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        for (std::vector<uint8_t>& p : packets) {
+            p[4] = (uint8_t)(i >> 8);  // new timestamp per round
+            p[7] = (uint8_t)i;
+            receiver.accept(p.data(), p.size());
+        }
+    }
+    double receiveUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    TEST_ASSERT_EQUAL(iterations, (int)receiver.getStats().frames);
+    printf("  packetize %.1f us/frame, depacketize + rebuild %.1f us/frame (%u packets)\n", packetizeUs / iterations,
+           receiveUs / iterations, (unsigned)packets.size());
+
+    TEST_ASSERT_GREATER_THAN(deliveredNoneAt5 + 20, delivered4At5);
+}
+
+int main(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+    UNITY_BEGIN();
+    RUN_TEST(test_parse_reads_rfc2435_fields);
+    RUN_TEST(test_parse_rejects_unrepresentable_jpegs);
+    RUN_TEST(test_packets_carry_rfc2435_headers_within_mtu);
+    RUN_TEST(test_roundtrip_rebuilds_same_image);
+    RUN_TEST(test_q_factor_frames_use_scaled_tables);
+    RUN_TEST(test_parity_repairs_any_single_loss_per_group);
+    RUN_TEST(test_unrepairable_loss_costs_only_its_frame);
+    RUN_TEST(test_reordered_and_duplicated_packets);
+    RUN_TEST(test_sender_over_loopback_with_injected_loss);
+    RUN_TEST(test_benchmark);
+    return UNITY_END();
+}
@@ -0,0 +1,552 @@
+/**
+ * `test_main.cpp`
+ * - Unit tests and a write/seek benchmark for SegmentStore and SegmentRecorder (native host build)
+ * - Segments are written to a temporary directory on the host filesystem
+ * - Run: pio test -e native -f test_segment_store
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#include <unity.h>
+
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "SegmentRecorder.h"
+#include "SegmentStore.h"
+
+static char testDir[64];
+
+void setUp(void) {
+    strcpy(testDir, "/tmp/segstore_XXXXXX");
+    TEST_ASSERT_NOT_NULL(mkdtemp(testDir));
+}
+
+void tearDown(void) {
+    DIR* dir = opendir(testDir);
+    if (dir != NULL) {
+        struct dirent* entry;
+        while ((entry = readdir(dir)) != NULL) {
+            if (entry->d_name[0] != '.') {
+                remove((std::string(testDir) + "/" + entry->d_name).c_str());
+            }
+        }
+        closedir(dir);
+    }
+    rmdir(testDir);
+}
+
+static uint8_t frameData[64 * 1024];
+static uint8_t readData[64 * 1024];
+
+/**
+ * Fill frameData with a pattern derived from the timestamp
+ */
+static const uint8_t* makeFrame(uint64_t timeUs, uint32_t length) {
+    for (uint32_t i = 0; i < length; i++) {
+        frameData[i] = (uint8_t)(timeUs * 31 + i * 7);
+    }
+    return frameData;
+}
+
+static bool patternMatches(const RecordedFrame& frame) {
+    for (uint32_t i = 0; i < frame.length; i++) {
+        if (readData[i] != (uint8_t)(frame.timeUs * 31 + i * 7)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static SegmentStoreConfig testConfig() {
+    SegmentStoreConfig config;
+    config.directory = testDir;
+    config.segmentDurationMs = 60000;
+    config.segmentMaxBytes = 4 * 1024 * 1024;
+    config.segmentMaxFrames = 1024;
+    config.batchBytes = 8 * 1024;
+    config.retentionBytes = 0;
+    config.retentionSegments = 0;
+    return config;
+}
+
+static long fileSize(const SegmentStoreConfig& config, uint32_t id) {
+    char path[128];
+    snprintf(path, sizeof(path), "%s/seg_%08u.csg", config.directory, (unsigned)id);
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) {
+        return -1;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fclose(file);
+    return size;
+}
+
+/**
+ * Deterministic pseudo-random frame sizes
+ */
+struct SimRandom {
+    uint32_t state;
+    explicit SimRandom(uint32_t seed) : state(seed) {}
+    uint32_t next(uint32_t range) {
+        state = state * 1664525u + 1013904223u;
+        return (state >> 8) % range;
+    }
+};
+
+// ========================================
+// Writing / Reading
+// ========================================
+void test_frames_round_trip_in_order() {
+    SegmentStoreConfig config = testConfig();
+    std::vector<uint8_t> workspace(SegmentStore::workspaceSize(config));
+    SegmentStore store(config, workspace.data());
+    TEST_ASSERT_TRUE(store.open());
+
+    for (uint32_t i = 0; i < 20; i++) {
+        uint64_t timeUs = 1000000 + i * 100000;
+        TEST_ASSERT_TRUE(store.append(timeUs, makeFrame(timeUs, 3000 + i * 100), 3000 + i * 100, (uint8_t)i));
+    }
+
+    // Still open: the tail is read from the batch buffer, the head from the file
+    SegmentCursor cursor;
+    TEST_ASSERT_TRUE(store.seek(0, cursor));
+    RecordedFrame frame;
+    for (uint32_t i = 0; i < 20; i++) {
+        TEST_ASSERT_TRUE(store.read(cursor, readData, sizeof(readData), frame));
+        TEST_ASSERT_EQUAL_UINT64(1000000 + i * 100000, frame.timeUs);
+        TEST_ASSERT_EQUAL_UINT32(3000 + i * 100, frame.length);
+        TEST_ASSERT_EQUAL_UINT8(i, frame.flags);
+        TEST_ASSERT_TRUE(patternMatches(frame));
+    }
+    TEST_ASSERT_FALSE(store.read(cursor, readData, sizeof(readData), frame));
+
+    // Reading the open segment did not disturb the writer
+    TEST_ASSERT_TRUE(store.append(3000000, makeFrame(3000000, 5000), 5000, 0));
+    TEST_ASSERT_TRUE(store.read(cursor, readData, sizeof(readData), frame));
+    TEST_ASSERT_EQUAL_UINT64(3000000, frame.timeUs);
+    TEST_ASSERT_TRUE(patternMatches(frame));
+
+    store.close();
+    TEST_ASSERT_EQUAL(1, store.segmentCount());
+    TEST_ASSERT_EQUAL_UINT32(21, store.segment(0).frames);
+    TEST_ASSERT_FALSE(store.segment(0).open);
+    TEST_ASSERT_EQUAL(store.segment(0).bytes, fileSize(config, store.segment(0).id));
+}
+
+void test_writes_are_whole_sectors() {
+    SegmentStoreConfig config = testConfig();
+    std::vector<uint8_t> workspace(SegmentStore::workspaceSize(config));
+    SegmentStore store(config, workspace.data());
+    TEST_ASSERT_TRUE(store.open());
+
+    SimRandom rng(7);
+    uint64_t payload = 0;
+    for (uint32_t i = 0; i < 200; i++) {
+        uint32_t length = 2000 + rng.next(6000);
+        payload += length;
+        TEST_ASSERT_TRUE(store.append(i * 100000, makeFrame(i, length), length, 0));
+        // Batches are written only when full
+        TEST_ASSERT_EQUAL(0, fileSize(config, 1) % SegmentStore::kSectorSize);
+    }
+    SegmentStoreStats stats = store.getStats();
+    TEST_ASSERT_EQUAL_UINT32(stats.bytesWritten / config.batchBytes, stats.writeCalls);
+
+    // A timed flush pads to the next sector boundary
+    TEST_ASSERT_TRUE(store.append(200 * 100000, makeFrame(200, 777), 777, 0));
+    TEST_ASSERT_TRUE(store.flush());
+    TEST_ASSERT_EQUAL(0, fileSize(config, 1) % SegmentStore::kSectorSize);
+    TEST_ASSERT_EQUAL((long)store.segment(0).bytes, fileSize(config, 1));
+    TEST_ASSERT_EQUAL_UINT32(1, store.getStats().flushes);
+    TEST_ASSERT_TRUE(payload + 777 < store.getStats().bytesWritten);
+}
+
+void test_tick_flushes_after_interval() {
+    SegmentStoreConfig config = testConfig();
+    config.flushIntervalMs = 1000;
+    std::vector<uint8_t> workspace(SegmentStore::workspaceSize(config));
+    SegmentStore store(config, workspace.data());
+    TEST_ASSERT_TRUE(store.open());
+
+    store.tick(0);
+    TEST_ASSERT_TRUE(store.append(0, makeFrame(0, 1000), 1000, 0));
+    TEST_ASSERT_EQUAL(0, fileSize(config, 1));
+    store.tick(900000);
+    TEST_ASSERT_EQUAL_UINT32(0, store.getStats().flushes);
+    store.tick(1000000);
+    TEST_ASSERT_EQUAL_UINT32(1, store.getStats().flushes);
+    // 512 header + 1016 record + 8 left in the sector (< record header): pad into the next one
+    TEST_ASSERT_EQUAL(4 * SegmentStore::kSectorSize, fileSize(config, 1));
+    TEST_ASSERT_EQUAL_UINT32(520, store.getStats().padBytes);
+
+    // Nothing new: no further flushes
+    store.tick(5000000);
+    TEST_ASSERT_EQUAL_UINT32(1, store.getStats().flushes);
+}
+
+// ========================================
+// Rotation / Retention
+// ========================================
+void test_segments_rotate_on_duration_frames_and_clock_reset() {
+    SegmentStoreConfig config = testConfig();
+    config.segmentDurationMs = 1000;
+    config.segmentMaxFrames = 8;
+    std::vector<uint8_t> workspace(SegmentStore::workspaceSize(config));
+    SegmentStore store(config, workspace.data());
+    TEST_ASSERT_TRUE(store.open());
+
+    // 12 frames 100 ms apart: the 8-frame cap rotates before the 1 s duration
+    for (uint32_t i = 0; i < 12; i++) {
+        TEST_ASSERT_TRUE(store.append(i * 100000, makeFrame(i, 500), 500, 0));
+    }
+    TEST_ASSERT_EQUAL(2, store.segmentCount());
+    TEST_ASSERT_EQUAL_UINT32(8, store.segment(0).frames);  // frame cap hit first
+    TEST_ASSERT_EQUAL_UINT64(0, store.segment(0).firstUs);
+    TEST_ASSERT_EQUAL_UINT64(700000, store.segment(0).lastUs);
+
+    // Device clock restarted: a new segment keeps each index sorted
+    TEST_ASSERT_TRUE(store.append(50000, makeFrame(50000, 500), 500, 0));
+    TEST_ASSERT_EQUAL(3, store.segmentCount());
+    TEST_ASSERT_EQUAL_UINT64(50000, store.segment(2).firstUs);
+    TEST_ASSERT_FALSE(store.segment(1).open);
+    TEST_ASSERT_TRUE(store.segment(2).open);
+    TEST_ASSERT_EQUAL_UINT32(3, store.getStats().segmentsCreated);
+}
+
+void test_retention_deletes_oldest_segments() {
+    SegmentStoreConfig config = testConfig();
+    config.segmentMaxFrames = 10;
+    config.retentionSegments = 3;
+    std::vector<uint8_t> workspace(SegmentStore::workspaceSize(config));
+    SegmentStore store(config, workspace.data());
+    TEST_ASSERT_TRUE(store.open());
+
+    TEST_ASSERT_TRUE(store.append(0, makeFrame(0, 1000), 1000, 0));
+    SegmentCursor cursor;
+    TEST_ASSERT_TRUE(store.seek(0, cursor));
+
+    for (uint32_t i = 1; i < 60; i++) {
+        TEST_ASSERT_TRUE(store.append(i * 1000, makeFrame(i * 1000, 1000), 1000, 0));
+    }
+    TEST_ASSERT_EQUAL(3, store.segmentCount());
+    TEST_ASSERT_EQUAL_UINT32(3, store.getStats().segmentsDeleted);
+    TEST_ASSERT_EQUAL(-1, fileSize(config, 1));
+    TEST_ASSERT_EQUAL_UINT32(4, store.segment(0).id);
+
+    // A reader left behind continues at the oldest remaining frame
+    RecordedFrame frame;
+    TEST_ASSERT_TRUE(store.read(cursor, readData, sizeof(readData), frame));
+    TEST_ASSERT_EQUAL_UINT64(30000, frame.timeUs);
+    TEST_ASSERT_EQUAL_UINT32(4, frame.segmentId);
+
+    // Byte limit: at most ~2 closed segments of ~11 KB fit next to the open one
+    SegmentStoreConfig bytesConfig = testConfig();
+    bytesConfig.segmentMaxFrames = 10;
+    bytesConfig.retentionBytes = 30 * 1024;
+    store.close();
+    SegmentStore limited(bytesConfig, workspace.data());
+    TEST_ASSERT_TRUE(limited.open());
+    TEST_ASSERT_TRUE(limited.totalBytes() <= bytesConfig.retentionBytes);
+    TEST_ASSERT_EQUAL(2, limited.segmentCount());
+}
+
+// ========================================
+// Index / Recovery
+// ========================================
+void test_seek_reads_log_n_index_entries() {
+    SegmentStoreConfig config = testConfig();
+    config.segmentMaxFrames = 4096;
+    config.segmentDurationMs = 3600000;
+    config.segmentMaxBytes = 64 * 1024 * 1024;
+    std::vector<uint8_t> workspace(SegmentStore::workspaceSize(config));
+    SegmentStore store(config, workspace.data());
+    TEST_ASSERT_TRUE(store.open());
+
+    const uint32_t frames = 4000;
+    for (uint32_t i = 0; i < frames; i++) {
+        TEST_ASSERT_TRUE(store.append(i * 66666ULL, makeFrame(i, 200), 200, 0));
+    }
+    store.close();
+    TEST_ASSERT_TRUE(store.open());
+
+    // 12 index reads for 4000 entries (ceil(log2 4000)), no scanning
+    SegmentCursor cursor;
+    uint32_t seeksBefore = store.getStats().seeks;
+    TEST_ASSERT_TRUE(store.seek(1234 * 66666ULL - 1, cursor));
+    uint32_t indexReads = store.getStats().seeks - seeksBefore;
+    TEST_ASSERT_TRUE(indexReads <= 12);
+    TEST_ASSERT_EQUAL_UINT32(1234, cursor.entry);
+
+    RecordedFrame frame;
+    TEST_ASSERT_TRUE(store.read(cursor, readData, sizeof(readData), frame));
+    TEST_ASSERT_EQUAL_UINT64(1234 * 66666ULL, frame.timeUs);
+
+    // Past the end / exact hit / before the start
+    TEST_ASSERT_FALSE(store.seek(frames * 66666ULL, cursor));
+    TEST_ASSERT_TRUE(store.seek(10 * 66666ULL, cursor));
+    TEST_ASSERT_EQUAL_UINT32(10, cursor.entry);
+    TEST_ASSERT_TRUE(store.seek(0, cursor));
+    TEST_ASSERT_EQUAL_UINT32(0, cursor.entry);
+    printf("  seek in %u frames: %u index reads\n", frames, indexReads);
+}
+
+void test_reopen_lists_segments_and_continues_numbering() {
+    SegmentStoreConfig config = testConfig();
+    config.segmentMaxFrames = 5;
+    std::vector<uint8_t> workspace(SegmentStore::workspaceSize(config));
+    {
+        SegmentStore store(config, workspace.data());
+        TEST_ASSERT_TRUE(store.open());
+        for (uint32_t i = 0; i < 12; i++) {
+            TEST_ASSERT_TRUE(store.append(i * 1000, makeFrame(i, 800), 800, 0));
+        }
+    }  // destructor closes the open segment
+
+    SegmentStore store(config, workspace.data());
+    TEST_ASSERT_TRUE(store.open());
+    TEST_ASSERT_EQUAL(3, store.segmentCount());
+    TEST_ASSERT_EQUAL_UINT32(2, store.segment(2).frames);
+    TEST_ASSERT_EQUAL_UINT64(11000, store.segment(2).lastUs);
+    TEST_ASSERT_EQUAL_UINT32(0, store.getStats().segmentsRecovered);
+
+    TEST_ASSERT_TRUE(store.append(20000, makeFrame(20000, 800), 800, 0));
+    TEST_ASSERT_EQUAL_UINT32(4, store.segment(3).id);
+}
+
+void test_unterminated_segment_is_recovered() {
+    SegmentStoreConfig config = testConfig();
+    std::vector<uint8_t> workspace(SegmentStore::workspaceSize(config));
+    {
+        SegmentStore store(config, workspace.data());
+        TEST_ASSERT_TRUE(store.open());
+        for (uint32_t i = 0; i < 30; i++) {
+            TEST_ASSERT_TRUE(store.append(i * 1000, makeFrame(i * 1000, 1500), 1500, 0));
+        }
+        TEST_ASSERT_TRUE(store.flush());
+
+        // Power loss: the file as it is on the card now, plus half a record
+        char from[128], to[128];
+        snprintf(from, sizeof(from), "%s/seg_%08u.csg", testDir, 1u);
+        snprintf(to, sizeof(to), "%s/seg_%08u.csg", testDir, 9u);
+        FILE* in = fopen(from, "rb");
+        FILE* out = fopen(to, "wb");
+        size_t n;
+        while ((n = fread(readData, 1, sizeof(readData), in)) > 0) {
+            fwrite(readData, 1, n, out);
+        }
+        uint8_t torn[16] = {0xA3, 0xF7, 1, 0, 0x00, 0x10, 0, 0};
+        fwrite(torn, 1, sizeof(torn), out);
+        fclose(in);
+        fclose(out);
+        remove(from);
+    }
+
+    SegmentStore store(config, workspace.data());
+    TEST_ASSERT_TRUE(store.open());
+    TEST_ASSERT_EQUAL_UINT32(1, store.getStats().segmentsRecovered);
+    TEST_ASSERT_EQUAL(1, store.segmentCount());
+    TEST_ASSERT_EQUAL_UINT32(9, store.segment(0).id);
+    TEST_ASSERT_EQUAL_UINT32(30, store.segment(0).frames);
+
+    SegmentCursor cursor;
+    RecordedFrame frame;
+    TEST_ASSERT_TRUE(store.seek(29000, cursor));
+    TEST_ASSERT_TRUE(store.read(cursor, readData, sizeof(readData), frame));
+    TEST_ASSERT_TRUE(patternMatches(frame));
+
+    // Recovered index is persistent: the next open needs no scan
+    store.close();
+    SegmentStore again(config, workspace.data());
+    TEST_ASSERT_TRUE(again.open());
+    TEST_ASSERT_EQUAL_UINT32(0, again.getStats().segmentsRecovered);
+    TEST_ASSERT_EQUAL_UINT32(30, again.segment(0).frames);
+}
+
+// ========================================
+// Recorder
+// ========================================
+void test_recorder_writes_in_background() {
+    SegmentStoreConfig storeConfig = testConfig();
+    SegmentRecorderConfig config;
+    config.stagingBytes = 64 * 1024;
+    config.recordIntervalMs = 100;
+    config.pollIntervalMs = 5;
+    std::vector<uint8_t> workspace(SegmentStore::workspaceSize(storeConfig));
+    std::vector<uint8_t> staging(config.stagingBytes);
+    SegmentRecorder recorder(storeConfig, config, workspace.data(), staging.data());
+    TEST_ASSERT_TRUE(recorder.start());
+
+    // Decimation: one frame per recording interval
+    TEST_ASSERT_TRUE(recorder.recordDue(0));
+    TEST_ASSERT_TRUE(recorder.submit(1000, makeFrame(1000, 4000), 4000, 2, 0));
+    TEST_ASSERT_FALSE(recorder.recordDue(50000));
+    TEST_ASSERT_TRUE(recorder.recordDue(100000));
+
+    for (uint32_t i = 1; i < 40; i++) {
+        uint64_t timeUs = 1000 + i * 100000;
+        TEST_ASSERT_TRUE(recorder.submit(timeUs, makeFrame(timeUs, 4000), 4000, 0, i * 100000));
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    for (int i = 0; i < 200 && recorder.getStats().written < 40; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    TEST_ASSERT_EQUAL_UINT32(40, recorder.getStats().written);
+
+    // Export reads run next to the writer
+    SegmentCursor cursor;
+    RecordedFrame frame;
+    TEST_ASSERT_TRUE(recorder.seek(0, cursor));
+    TEST_ASSERT_TRUE(recorder.read(cursor, readData, sizeof(readData), frame));
+    TEST_ASSERT_EQUAL_UINT64(1000, frame.timeUs);
+    TEST_ASSERT_EQUAL_UINT8(2, frame.flags);
+    TEST_ASSERT_TRUE(patternMatches(frame));
+
+    recorder.stop();
+    SegmentInfo segments[4];
+    TEST_ASSERT_EQUAL(1, recorder.catalog(segments, 4));
+    TEST_ASSERT_FALSE(segments[0].open);
+    TEST_ASSERT_EQUAL_UINT32(40, segments[0].frames);
+}
+
+void test_recorder_drops_when_card_falls_behind() {
+    SegmentStoreConfig storeConfig = testConfig();
+    SegmentRecorderConfig config;
+    config.stagingBytes = 16 * 1024;
+    std::vector<uint8_t> workspace(SegmentStore::workspaceSize(storeConfig));
+    std::vector<uint8_t> staging(config.stagingBytes);
+    SegmentRecorder recorder(storeConfig, config, workspace.data(), staging.data());
+
+    // Writer not running (card stalled): submit never waits, the FIFO fills and rejects
+    for (uint32_t i = 0; i < 10; i++) {
+        recorder.submit(i * 1000, makeFrame(i * 1000, 4000), 4000, 0, i * 1000);
+    }
+    SegmentRecorderStats stats = recorder.getStats();
+    TEST_ASSERT_EQUAL_UINT32(4, stats.submitted);
+    TEST_ASSERT_EQUAL_UINT32(6, stats.dropped);
+    TEST_ASSERT_EQUAL_UINT32(4, stats.stagedFrames);
+
+    // Card back: the oldest staged frames are written first
+    TEST_ASSERT_TRUE(recorder.start());
+    recorder.stop();
+    stats = recorder.getStats();
+    TEST_ASSERT_EQUAL_UINT32(4, stats.written);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.stagedFrames);
+    SegmentInfo segment;
+    TEST_ASSERT_EQUAL(1, recorder.catalog(&segment, 1));
+    TEST_ASSERT_EQUAL_UINT64(0, segment.firstUs);
+    TEST_ASSERT_EQUAL_UINT64(3000, segment.lastUs);
+}
+
+// ========================================
+// Benchmark (host filesystem)
+// ========================================
+static double elapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void test_benchmark_batched_store_vs_plain_file() {
+    const uint32_t frames = 600;
+    SimRandom rng(11);
+    std::vector<uint32_t> lengths(frames);
+    uint64_t payload = 0;
+    for (uint32_t i = 0; i < frames; i++) {
+        lengths[i] = 8000 + rng.next(16000);
+        payload += lengths[i];
+    }
+
+    // Plain file: one unbuffered write per frame, synced at the same interval as the store
+    std::string plainPath = std::string(testDir) + "/plain.bin";
+    FILE* plain = fopen(plainPath.c_str(), "wb");
+    setvbuf(plain, NULL, _IONBF, 0);
+    uint32_t plainWrites = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < frames; i++) {
+        uint8_t header[16] = {};
+        fwrite(header, 1, sizeof(header), plain);
+        fwrite(frameData, 1, lengths[i], plain);
+        plainWrites += 2;
+        if (i % 30 == 29) {
+            fsync(fileno(plain));
+        }
+    }
+    fsync(fileno(plain));
+    fclose(plain);
+    double plainMs = elapsedMs(start);
+
+    SegmentStoreConfig config = testConfig();
+    config.batchBytes = 32 * 1024;
+    config.segmentMaxFrames = frames;
+    config.segmentMaxBytes = 64 * 1024 * 1024;
+    std::vector<uint8_t> workspace(SegmentStore::workspaceSize(config));
+    SegmentStore store(config, workspace.data());
+    TEST_ASSERT_TRUE(store.open());
+    start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < frames; i++) {
+        TEST_ASSERT_TRUE(store.append(i * 66666ULL, frameData, lengths[i], 0));
+        if (i % 30 == 29) {
+            store.flush();
+        }
+    }
+    store.close();
+    double storeMs = elapsedMs(start);
+    SegmentStoreStats stats = store.getStats();
+
+    // Seek: index lower_bound vs scanning record headers from the start
+    start = std::chrono::steady_clock::now();
+    SegmentCursor cursor;
+    for (uint32_t i = 0; i < 100; i++) {
+        TEST_ASSERT_TRUE(store.seek((uint64_t)rng.next(frames) * 66666ULL, cursor));
+    }
+    double seekUs = elapsedMs(start) * 10.0;  // per seek (x1000 / 100)
+    plain = fopen(plainPath.c_str(), "rb");
+    start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < 100; i++) {
+        uint32_t target = rng.next(frames);
+        long offset = 0;
+        for (uint32_t f = 0; f < target; f++) {
+            uint8_t header[16];
+            fseek(plain, offset, SEEK_SET);
+            TEST_ASSERT_EQUAL(16, fread(header, 1, sizeof(header), plain));
+            offset += 16 + lengths[f];
+        }
+    }
+    double scanUs = elapsedMs(start) * 10.0;
+    fclose(plain);
+
+    TEST_ASSERT_TRUE(stats.writeCalls * 3 < plainWrites);
+    TEST_ASSERT_TRUE(stats.bytesWritten < payload + payload / 20);  // headers/padding/index < 5%
+    printf("  write %u frames (%.1f MB): plain %u calls %.1f MB/s, store %u calls %.1f MB/s (+%.2f%% bytes)\n",
+           frames, payload / 1e6, plainWrites, payload / 1e3 / plainMs, stats.writeCalls, payload / 1e3 / storeMs,
+           (stats.bytesWritten - payload) * 100.0 / payload);
+    printf("  seek: index %.1f us, header scan %.1f us\n", seekUs, scanUs);
+}
+
+int main(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+    UNITY_BEGIN();
+    RUN_TEST(test_frames_round_trip_in_order);
+    RUN_TEST(test_writes_are_whole_sectors);
+    RUN_TEST(test_tick_flushes_after_interval);
+    RUN_TEST(test_segments_rotate_on_duration_frames_and_clock_reset);
+    RUN_TEST(test_retention_deletes_oldest_segments);
+    RUN_TEST(test_seek_reads_log_n_index_entries);
+    RUN_TEST(test_reopen_lists_segments_and_continues_numbering);
+    RUN_TEST(test_unterminated_segment_is_recovered);
+    RUN_TEST(test_recorder_writes_in_background);
+    RUN_TEST(test_recorder_drops_when_card_falls_behind);
+    RUN_TEST(test_benchmark_batched_store_vs_plain_file);
+    return UNITY_END();
+}
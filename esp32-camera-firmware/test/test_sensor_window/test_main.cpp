@@ -0,0 +1,286 @@
+/**
+ * `test_main.cpp`
+ * - Unit tests and benchmark for SensorWindow (native host build)
+ * - The benchmark models the windowed sensor with synthetic scenes (jpeg_fixture.h):
+ *   full view vs the ROI crop at the same pixel density, bytes/frame and FPS on a fixed link
+ * - Run: pio test -e native -f test_sensor_window
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#include <unity.h>
+
+#include <stdio.h>
+
+#include <chrono>
+#include <vector>
+
+#include "SensorWindow.h"
+#include "../test_motion_gate/jpeg_fixture.h"
+
+void setUp(void) {}
+void tearDown(void) {}
+
+static SensorWindow makeWindow() {
+    SensorWindowConfig config;
+    config.alignment = 8;
+    config.minOutput = 64;
+    config.minIntervalMs = 40;
+    return SensorWindow(config);
+}
+
+static RoiRect roiOf(uint16_t x, uint16_t y, uint16_t width, uint16_t height) {
+    RoiRect roi;
+    roi.x = x;
+    roi.y = y;
+    roi.width = width;
+    roi.height = height;
+    return roi;
+}
+
+// ========================================
+// Parsing
+// ========================================
+
+void test_parse_accepts_field_of_view_rects(void) {
+    RoiRect roi;
+    TEST_ASSERT_TRUE(SensorWindow::parse("250:200:300:600", roi));
+    TEST_ASSERT_EQUAL(250, roi.x);
+    TEST_ASSERT_EQUAL(200, roi.y);
+    TEST_ASSERT_EQUAL(300, roi.width);
+    TEST_ASSERT_EQUAL(600, roi.height);
+    TEST_ASSERT_TRUE(SensorWindow::parse("0:0:1000:1000", roi));
+
+    TEST_ASSERT_FALSE(SensorWindow::parse("", roi));
+    TEST_ASSERT_FALSE(SensorWindow::parse("1:2:3", roi));
+    TEST_ASSERT_FALSE(SensorWindow::parse("1:2:3:4:5", roi));
+    TEST_ASSERT_FALSE(SensorWindow::parse("1:2:3:4x", roi));
+    TEST_ASSERT_FALSE(SensorWindow::parse("0:0:0:500", roi));        // empty
+    TEST_ASSERT_FALSE(SensorWindow::parse("800:0:300:500", roi));    // past the right edge
+    TEST_ASSERT_FALSE(SensorWindow::parse("0:0:1001:500", roi));
+    TEST_ASSERT_FALSE(SensorWindow::parse(NULL, roi));
+}
+
+void test_invalid_roi_keeps_the_previous_one(void) {
+    SensorWindow window = makeWindow();
+    TEST_ASSERT_FALSE(window.isActive());
+    TEST_ASSERT_TRUE(window.set(roiOf(100, 100, 200, 200)));
+    TEST_ASSERT_FALSE(window.set(roiOf(900, 0, 200, 200)));
+    TEST_ASSERT_TRUE(window.isActive());
+    TEST_ASSERT_EQUAL(100, window.getRoi().x);
+
+    window.clear();
+    TEST_ASSERT_FALSE(window.isActive());
+    WindowPlan plan;
+    TEST_ASSERT_FALSE(window.plan(480, 320, 100, plan));
+}
+
+// ========================================
+// Planning
+// ========================================
+
+void test_plan_keeps_full_view_pixel_density(void) {
+    SensorWindow window = makeWindow();
+    TEST_ASSERT_TRUE(window.set(roiOf(250, 200, 300, 600)));
+    WindowPlan plan;
+    TEST_ASSERT_TRUE(window.plan(480, 320, 100, plan));
+
+    // HVGA full view comes from the SVGA readout: the ROI is the same crop of it
+    TEST_ASSERT_TRUE(plan.mode == SensorMode::Svga);
+    TEST_ASSERT_EQUAL(144, plan.outputWidth);
+    TEST_ASSERT_EQUAL(192, plan.outputHeight);
+    TEST_ASSERT_EQUAL(200, plan.offsetX);
+    TEST_ASSERT_EQUAL(120, plan.offsetY);
+    TEST_ASSERT_EQUAL(240, plan.windowWidth);
+    TEST_ASSERT_EQUAL(360, plan.windowHeight);
+    TEST_ASSERT_TRUE(plan.outputWidth <= plan.windowWidth && plan.outputHeight <= plan.windowHeight);
+}
+
+void test_mode_is_fastest_without_upscaling(void) {
+    SensorWindow window = makeWindow();
+    TEST_ASSERT_TRUE(window.set(roiOf(0, 0, 500, 500)));
+    WindowPlan plan;
+
+    TEST_ASSERT_TRUE(window.plan(320, 240, 100, plan));     // QVGA
+    TEST_ASSERT_TRUE(plan.mode == SensorMode::Cif);
+    TEST_ASSERT_TRUE(window.plan(640, 480, 100, plan));     // VGA
+    TEST_ASSERT_TRUE(plan.mode == SensorMode::Svga);
+    TEST_ASSERT_TRUE(window.plan(1280, 1024, 100, plan));   // SXGA
+    TEST_ASSERT_TRUE(plan.mode == SensorMode::Uxga);
+
+    const SensorModeInfo& cif = SensorWindow::modeInfo(SensorMode::Cif);
+    TEST_ASSERT_EQUAL(400, cif.width);
+    TEST_ASSERT_EQUAL(296, cif.height);
+}
+
+void test_window_stays_aligned_inside_the_mode(void) {
+    SensorWindow window = makeWindow();
+    static const RoiRect rois[] = {
+        {0, 0, 1000, 1000}, {999, 999, 1, 1}, {333, 77, 501, 923}, {1, 1, 7, 998}, {640, 410, 360, 590},
+    };
+    static const uint16_t sizes[][2] = { {320, 240}, {480, 320}, {640, 480}, {1600, 1200} };
+    for (const RoiRect& roi : rois) {
+        TEST_ASSERT_TRUE(window.set(roi));
+        for (const auto& size : sizes) {
+            WindowPlan plan;
+            TEST_ASSERT_TRUE(window.plan(size[0], size[1], 100, plan));
+            const SensorModeInfo& mode = SensorWindow::modeInfo(plan.mode);
+            TEST_ASSERT_EQUAL(0, plan.offsetX % 8);
+            TEST_ASSERT_EQUAL(0, plan.windowWidth % 8);
+            TEST_ASSERT_EQUAL(0, plan.outputHeight % 8);
+            TEST_ASSERT_TRUE(plan.offsetX + plan.windowWidth <= mode.width);
+            TEST_ASSERT_TRUE(plan.offsetY + plan.windowHeight <= mode.height);
+            TEST_ASSERT_TRUE(plan.outputWidth <= plan.windowWidth && plan.outputHeight <= plan.windowHeight);
+            TEST_ASSERT_TRUE(plan.outputWidth <= size[0] && plan.outputHeight <= size[1]);
+        }
+    }
+}
+
+void test_small_roi_grows_around_its_center(void) {
+    SensorWindow window = makeWindow();
+    WindowPlan plan;
+
+    TEST_ASSERT_TRUE(window.set(roiOf(500, 500, 10, 10)));
+    TEST_ASSERT_TRUE(window.plan(480, 320, 100, plan));
+    TEST_ASSERT_EQUAL(64, plan.outputWidth);
+    TEST_ASSERT_EQUAL(64, plan.outputHeight);
+    TEST_ASSERT_TRUE(plan.roi.x < 505 && plan.roi.x + plan.roi.width > 505);
+
+    // At the edge the grown ROI is pushed back inside the field of view
+    TEST_ASSERT_TRUE(window.set(roiOf(995, 0, 5, 5)));
+    TEST_ASSERT_TRUE(window.plan(480, 320, 100, plan));
+    TEST_ASSERT_EQUAL(1000, plan.roi.x + plan.roi.width);
+    TEST_ASSERT_EQUAL(0, plan.roi.y);
+    TEST_ASSERT_EQUAL(64, plan.outputWidth);
+}
+
+void test_interval_spends_the_full_view_byte_budget(void) {
+    SensorWindow window = makeWindow();
+    WindowPlan plan;
+
+    // Quarter of the area at 200 ms → 50 ms
+    TEST_ASSERT_TRUE(window.set(roiOf(0, 0, 500, 500)));
+    TEST_ASSERT_TRUE(window.plan(320, 240, 200, plan));
+    TEST_ASSERT_EQUAL(50, plan.intervalMs);
+
+    // Floor: configured minimum, then the readout rate of the mode
+    TEST_ASSERT_TRUE(window.plan(480, 320, 100, plan));
+    TEST_ASSERT_EQUAL(40, plan.intervalMs);
+    TEST_ASSERT_TRUE(window.plan(1600, 1200, 100, plan));
+    TEST_ASSERT_EQUAL(67, plan.intervalMs);                 // UXGA readout 15 FPS
+
+    // Never slower than the full view
+    TEST_ASSERT_TRUE(window.set(roiOf(0, 0, 1000, 1000)));
+    TEST_ASSERT_TRUE(window.plan(480, 320, 100, plan));
+    TEST_ASSERT_EQUAL(100, plan.intervalMs);
+}
+
+// ========================================
+// JPEG Header
+// ========================================
+
+void test_jpeg_dimensions_from_frame_header(void) {
+    FixtureEncoder encoder(60, FixtureSampling::Yuv422);
+    std::vector<uint8_t> jpeg = encoder.encode(makeBackground(144, 192));
+    uint16_t width = 0;
+    uint16_t height = 0;
+    TEST_ASSERT_TRUE(SensorWindow::jpegDimensions(jpeg.data(), jpeg.size(), width, height));
+    TEST_ASSERT_EQUAL(144, width);
+    TEST_ASSERT_EQUAL(192, height);
+
+    TEST_ASSERT_FALSE(SensorWindow::jpegDimensions(jpeg.data(), 20, width, height));
+    jpeg[0] = 0x00;
+    TEST_ASSERT_FALSE(SensorWindow::jpegDimensions(jpeg.data(), jpeg.size(), width, height));
+    TEST_ASSERT_FALSE(SensorWindow::jpegDimensions(NULL, 0, width, height));
+}
+
+// ========================================
+// Benchmark
+// ========================================
+
+/**
+ * Synthetic sensor: full view vs doorway ROI at the same pixel density
+ * - Bytes/frame and encode time from the fixture encoder, FPS from the planned interval
+ *   capped by a 1 Mbps uplink
+ */
+void test_benchmark(void) {
+    struct Case {
+        const char* name;
+        int width;
+        int height;
+        int quality;
+        uint32_t intervalMs;
+    };
+    static const Case cases[] = {
+        {"QVGA q20", 320, 240, 20, 100},
+        {"HVGA q25", 480, 320, 25, 100},
+        {"VGA  q12", 640, 480, 12, 66},
+    };
+    const RoiRect doorway = roiOf(350, 100, 250, 800);
+    const double linkBytesPerSecond = 1000000.0 / 8;
+    const int frames = 20;
+
+    SensorWindow window = makeWindow();
+    TEST_ASSERT_TRUE(window.set(doorway));
+    printf("\n  %-9s %-5s %9s %8s %10s %7s\n", "view", "", "size", "bytes", "us/encode", "FPS");
+    for (const Case& c : cases) {
+        WindowPlan plan;
+        TEST_ASSERT_TRUE(window.plan((uint16_t)c.width, (uint16_t)c.height, c.intervalMs, plan));
+        FixtureEncoder encoder(100 - c.quality * 3 / 2, FixtureSampling::Yuv422);
+        Scene background = makeBackground(c.width, c.height);
+        int cropX = doorway.x * c.width / 1000;
+        int cropY = doorway.y * c.height / 1000;
+
+        double bytes[2] = {0, 0};
+        double encodeUs[2] = {0, 0};
+        for (int i = 0; i < frames; i++) {
+            Scene scene = makeFrame(background, (uint32_t)i + 1, 2, 0, cropX + 10, cropY + 40, 60, 120);
+            Scene crop(plan.outputWidth, plan.outputHeight);
+            for (int y = 0; y < crop.height; y++) {
+                for (int x = 0; x < crop.width; x++) {
+                    crop.y[(size_t)y * crop.width + x] = scene.at(cropX + x, cropY + y);
+                }
+            }
+            const Scene* views[2] = {&scene, &crop};
+            for (int v = 0; v < 2; v++) {
+                auto start = std::chrono::steady_clock::now();
+                bytes[v] += encoder.encode(*views[v]).size();
+                encodeUs[v] += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+            }
+        }
+
+        uint32_t intervals[2] = {c.intervalMs, plan.intervalMs};
+        double fps[2];
+        for (int v = 0; v < 2; v++) {
+            bytes[v] /= frames;
+            encodeUs[v] /= frames;
+            double paced = 1000.0 / intervals[v];
+            double linkLimited = linkBytesPerSecond / bytes[v];
+            fps[v] = paced < linkLimited ? paced : linkLimited;
+            printf("  %-9s %-5s %4dx%-4d %8.0f %10.0f %7.1f\n", c.name, v == 0 ? "full" : "ROI",
+                   v == 0 ? c.width : plan.outputWidth, v == 0 ? c.height : plan.outputHeight,
+                   bytes[v], encodeUs[v], fps[v]);
+        }
+        TEST_ASSERT_TRUE(bytes[1] < bytes[0] / 2);
+        TEST_ASSERT_TRUE(fps[1] > fps[0] * 1.5);
+    }
+}
+
+int main(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+    UNITY_BEGIN();
+    RUN_TEST(test_parse_accepts_field_of_view_rects);
+    RUN_TEST(test_invalid_roi_keeps_the_previous_one);
+    RUN_TEST(test_plan_keeps_full_view_pixel_density);
+    RUN_TEST(test_mode_is_fastest_without_upscaling);
+    RUN_TEST(test_window_stays_aligned_inside_the_mode);
+    RUN_TEST(test_small_roi_grows_around_its_center);
+    RUN_TEST(test_interval_spends_the_full_view_byte_budget);
+    RUN_TEST(test_jpeg_dimensions_from_frame_header);
+    RUN_TEST(test_benchmark);
+    return UNITY_END();
+}
@@ -0,0 +1,805 @@
+/**
+ * `test_main.cpp`
+ * - Unit tests and benchmark for SnapshotCapture / SnapshotUpload / SnapshotAssembler
+ *   (native host build)
+ * - SyntheticCamera models the OV2640 behind esp32-camera on a virtual clock:
+ *   - a frame size change takes effect at the next frame start; the first frame after a
+ *     readout mode change (UXGA ↔ SVGA binning) is cut off (no EOI)
+ *   - CAMERA_GRAB_LATEST ring of fb_count buffers sized for the allocated frame size;
+ *     larger JPEGs are truncated like a driver buffer overflow
+ *   - driver re-init costs a fixed time and restarts the sensor
+ *   JPEGs are structural (SOI, DQT, SOF0, SOS, scan bytes, EOI) sized like OV2640 output
+ * - The benchmark compares the live stream gap of the switch variants and the upload time
+ *   of a UXGA snapshot next to a 10 FPS live stream
+ * - Run: pio test -e native -f test_snapshot_capture
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#include <unity.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#include <map>
+#include <vector>
+
+#include "SensorWindow.h"
+#include "SnapshotCapture.h"
+#include "StreamProfile.h"
+
+void setUp(void) {}
+void tearDown(void) {}
+
+// framesize_t values used below
+static const uint8_t kHvga = 7;
+static const uint8_t kVga = 8;
+static const uint8_t kSvga = 9;
+static const uint8_t kUxga = 13;
+
+static const size_t kHeadroom = 14;   // WEBSOCKETS_MAX_HEADER_SIZE
+
+// ========================================
+// Synthetic Camera
+// ========================================
+/**
+ * OV2640 JPEG size: ≈ 1.6 bytes per pixel / quality (VGA q12 ≈ 41 KB, UXGA q10 ≈ 307 KB)
+ */
+static size_t jpegBytes(uint8_t frameSize, uint8_t quality) {
+    size_t pixels = (size_t)ProfilePlanner::frameWidth(frameSize) * ProfilePlanner::frameHeight(frameSize);
+    return pixels * 16 / (10 * (quality > 0 ? quality : 1));
+}
+
+/**
+ * SOI, DQT, SOF0 (size), SOS, scan bytes (no 0xFF), EOI; `complete` = false cuts the EOI off
+ */
+static std::vector<uint8_t> makeJpeg(uint8_t frameSize, uint8_t quality, uint32_t number, size_t limit,
+                                     bool complete) {
+    uint16_t width = ProfilePlanner::frameWidth(frameSize);
+    uint16_t height = ProfilePlanner::frameHeight(frameSize);
+    std::vector<uint8_t> jpeg = {0xFF, 0xD8, 0xFF, 0xDB, 0x00, 0x43, 0x00};
+    for (int i = 0; i < 64; i++) jpeg.push_back((uint8_t)(quality + i));
+    const uint8_t sof[] = {0xFF, 0xC0, 0x00, 0x11, 0x08, (uint8_t)(height >> 8), (uint8_t)height,
+                           (uint8_t)(width >> 8), (uint8_t)width, 0x03, 0x01, 0x21, 0x00, 0x02, 0x11,
+                           0x01, 0x03, 0x11, 0x01};
+    jpeg.insert(jpeg.end(), sof, sof + sizeof(sof));
+    const uint8_t sos[] = {0xFF, 0xDA, 0x00, 0x0C, 0x03, 0x01, 0x00, 0x02, 0x11, 0x03, 0x11, 0x00, 0x3F, 0x00};
+    jpeg.insert(jpeg.end(), sos, sos + sizeof(sos));
+    size_t total = jpegBytes(frameSize, quality);
+    for (size_t i = jpeg.size(); i + 2 < total; i++) {
+        jpeg.push_back((uint8_t)((i * 31 + number) % 0xFE));
+    }
+    jpeg.push_back(0xFF);
+    jpeg.push_back(0xD9);
+    if (jpeg.size() > limit) {
+        jpeg.resize(limit);    // driver buffer overflow: the rest of the frame is lost
+    } else if (!complete) {
+        jpeg.resize(jpeg.size() * 2 / 3);
+    }
+    return jpeg;
+}
+
+class SyntheticCamera : public SnapshotCamera {
+public:
+    uint32_t reinitUs = 280000;    // esp_camera_deinit + esp_camera_init (sensor probe, DMA buffers)
+    uint32_t setModeUs = 3000;     // SCCB register writes
+    bool failReinit = false;
+    uint8_t liveSize = kHvga;
+    uint8_t liveQuality = 25;
+    uint64_t now = 1000000;
+
+    uint32_t reallocations = 0;
+    uint32_t modeChanges = 0;
+    uint32_t sensorFrames = 0;
+
+    SyntheticCamera(uint8_t fbFrameSize, uint8_t fbCount) : _fbFrameSize(fbFrameSize), _fbCount(fbCount) {
+        _size = _requestedSize = liveSize;
+        _quality = _requestedQuality = liveQuality;
+        startSensor();
+    }
+
+    uint8_t sensorFrameSize() const { return _requestedSize; }
+    uint8_t sensorQuality() const { return _requestedQuality; }
+    uint8_t fbCount() const { return _fbCount; }
+
+    uint8_t bufferFrameSize() override { return _fbFrameSize; }
+
+    bool reallocate(uint8_t frameSize) override {
+        now += reinitUs;
+        if (failReinit) {
+            startSensor();
+            return false;
+        }
+        _savedFrameSize = _fbFrameSize;
+        _savedCount = _fbCount;
+        _fbFrameSize = frameSize;
+        _fbCount = 1;
+        _size = _requestedSize = frameSize;  // esp_camera_init starts at the buffer frame size
+        startSensor();
+        reallocations++;
+        return true;
+    }
+
+    bool restoreBuffers() override {
+        now += reinitUs;
+        _fbFrameSize = _savedFrameSize;
+        _fbCount = _savedCount;
+        _size = _requestedSize = _fbFrameSize;
+        startSensor();
+        reallocations++;
+        return true;
+    }
+
+    bool setMode(uint8_t frameSize, uint8_t jpegQuality) override {
+        now += setModeUs;
+        _requestedSize = frameSize;
+        _requestedQuality = jpegQuality;
+        modeChanges++;
+        return frameSize <= kUxga;
+    }
+
+    void restoreMode() override {
+        now += setModeUs;
+        _requestedSize = liveSize;
+        _requestedQuality = liveQuality;
+        modeChanges++;
+    }
+
+    bool grab(SnapshotFrame& frame) override {
+        for (int attempt = 0; attempt < 100; attempt++) {
+            advance(now);
+            Slot* newest = NULL;
+            for (Slot& slot : _slots) {
+                if (slot.filled && !slot.held && (newest == NULL || slot.number > newest->number)) {
+                    newest = &slot;
+                }
+            }
+            if (newest != NULL) {
+                newest->held = true;
+                frame.handle = newest;
+                frame.data = newest->jpeg.data();
+                frame.length = newest->jpeg.size();
+                frame.captureUs = newest->startUs;
+                return true;
+            }
+            now = _frameEndUs;  // wait for the sensor
+        }
+        return false;
+    }
+
+    void release(const SnapshotFrame& frame) override {
+        Slot* slot = static_cast<Slot*>(frame.handle);
+        slot->held = false;
+        slot->filled = false;
+    }
+
+    uint64_t nowUs() override { return now; }
+
+private:
+    struct Slot {
+        std::vector<uint8_t> jpeg;
+        uint64_t startUs = 0;
+        uint32_t number = 0;
+        bool filled = false;
+        bool held = false;
+    };
+
+    static bool fullReadout(uint8_t frameSize) { return frameSize > kSvga; }
+
+    static uint64_t periodUs(uint8_t frameSize) {
+        return fullReadout(frameSize) ? 1000000 / 15 : 1000000 / 30;  // OV2640 at 20 MHz XCLK
+    }
+
+    void startSensor() {
+        _slots.assign(_fbCount, Slot());
+        _frameStartUs = now;
+        _frameEndUs = now + periodUs(_size);
+        _cutOff = false;
+    }
+
+    void advance(uint64_t until) {
+        while (_frameEndUs <= until) {
+            complete();
+            // Register changes take effect at the next frame start
+            bool readoutChange = fullReadout(_requestedSize) != fullReadout(_size);
+            _size = _requestedSize;
+            _quality = _requestedQuality;
+            _cutOff = readoutChange;
+            _frameStartUs = _frameEndUs;
+            _frameEndUs = _frameStartUs + periodUs(_size);
+        }
+    }
+
+    void complete() {
+        sensorFrames++;
+        // CAMERA_GRAB_LATEST: a new frame replaces any frame nobody grabbed yet
+        Slot* target = NULL;
+        for (Slot& slot : _slots) {
+            if (!slot.held) {
+                if (slot.filled || target == NULL) target = &slot;
+                slot.filled = false;
+            }
+        }
+        if (target == NULL) {
+            return;
+        }
+        size_t limit = ProfilePlanner::frameBufferBytes(_fbFrameSize);
+        std::vector<uint8_t>& cached = _cache[((uint32_t)_size << 8) | _quality];
+        if (cached.empty()) {
+            cached = makeJpeg(_size, _quality, 0, (size_t)-1, true);
+        }
+        if (_cutOff || cached.size() > limit) {
+            target->jpeg = makeJpeg(_size, _quality, sensorFrames, limit, !_cutOff);
+        } else {
+            target->jpeg = cached;
+        }
+        target->startUs = _frameStartUs;
+        target->number = sensorFrames;
+        target->filled = true;
+    }
+
+    uint8_t _fbFrameSize;
+    uint8_t _fbCount;
+    uint8_t _savedFrameSize = 0;
+    uint8_t _savedCount = 0;
+    uint8_t _size;
+    uint8_t _quality;
+    uint8_t _requestedSize;
+    uint8_t _requestedQuality;
+    bool _cutOff = false;
+    uint64_t _frameStartUs = 0;
+    uint64_t _frameEndUs = 0;
+    std::vector<Slot> _slots;
+    std::map<uint32_t, std::vector<uint8_t>> _cache;
+};
+
+/**
+ * Live stream on the camera: one grab every `intervalUs` (like the capture task)
+ */
+struct LiveStream {
+    SyntheticCamera& camera;
+    SnapshotCapture& snapshot;
+    uint64_t intervalUs;
+    uint64_t nextUs;
+    uint32_t sent = 0;
+    uint32_t refused = 0;
+    uint16_t lastWidth = 0;
+    uint64_t lastCaptureUs = 0;
+
+    LiveStream(SyntheticCamera& cam, SnapshotCapture& capture, uint64_t interval)
+        : camera(cam), snapshot(capture), intervalUs(interval), nextUs(cam.now) {}
+
+    void step() {
+        if (camera.now < nextUs) {
+            camera.now = nextUs;
+        }
+        SnapshotFrame frame;
+        TEST_ASSERT_TRUE(camera.grab(frame));
+        if (snapshot.admitLive(frame.data, frame.length, frame.captureUs)) {
+            uint16_t height;
+            SensorWindow::jpegDimensions(frame.data, frame.length, lastWidth, height);
+            lastCaptureUs = frame.captureUs;
+            sent++;
+        } else {
+            refused++;
+        }
+        camera.release(frame);
+        nextUs += intervalUs;
+    }
+
+    void run(int frames) {
+        for (int i = 0; i < frames; i++) step();
+    }
+};
+
+struct Fixture {
+    std::vector<uint8_t> buffer;
+    SnapshotUpload upload;
+    SnapshotCapture capture;
+
+    Fixture(SyntheticCamera& camera, const SnapshotConfig& config = SnapshotConfig(),
+            const SnapshotUploadConfig& uploadConfig = makeUploadConfig())
+        : buffer(SnapshotUpload::bufferSize(ProfilePlanner::frameBufferBytes(kUxga), kHeadroom)),
+          upload(buffer.data(), buffer.size(), uploadConfig),
+          capture(camera, upload, config) {}
+
+    static SnapshotUploadConfig makeUploadConfig() {
+        SnapshotUploadConfig config;
+        config.headroom = kHeadroom;
+        return config;
+    }
+};
+
+static FrameHeader snapshotHeader(const SnapshotResult& result) {
+    FrameHeader header = {};
+    header.sequence = result.id;
+    header.captureUs = result.captureUs;
+    header.frameSize = result.frameSize;
+    header.jpegQuality = result.jpegQuality;
+    header.width = result.width;
+    header.height = result.height;
+    header.payloadLength = result.bytes;
+    return header;
+}
+
+/**
+ * Send every part through `assembler`; the transport scribbles over its header room
+ * @return Parts sent
+ */
+static uint32_t uploadAll(SnapshotUpload& upload, SnapshotAssembler& assembler, uint64_t& nowUs,
+                          uint32_t budgetUs = 50000, uint32_t kbps = 2000) {
+    uint32_t parts = 0;
+    SnapshotPart part;
+    while (upload.hasPending()) {
+        if (!upload.nextPart(nowUs, budgetUs, kbps, part)) {
+            nowUs += 1000;
+            continue;
+        }
+        memset(part.message - kHeadroom, 0xEE, kHeadroom);
+        SnapshotAssembleResult result = assembler.accept(part.message, part.length);
+        TEST_ASSERT_TRUE(result == (part.last ? AssembleResult::Complete : AssembleResult::Pending));
+        upload.endPart(true, nowUs);
+        parts++;
+    }
+    return parts;
+}
+
+// ========================================
+// Capture
+// ========================================
+
+void test_direct_switch_takes_first_valid_frame(void) {
+    SyntheticCamera camera(kUxga, 3);  // buffers already hold UXGA
+    Fixture fixture(camera);
+    LiveStream live(camera, fixture.capture, 100000);
+    live.run(5);
+
+    SnapshotResult result;
+    TEST_ASSERT_TRUE(fixture.capture.capture(kUxga, 10, result) == SnapshotError::None);
+    TEST_ASSERT_FALSE(result.reinit);
+    TEST_ASSERT_EQUAL(0, camera.reallocations);
+    TEST_ASSERT_EQUAL(1, result.id);
+    TEST_ASSERT_EQUAL(1600, result.width);
+    TEST_ASSERT_EQUAL(1200, result.height);
+    TEST_ASSERT_EQUAL(jpegBytes(kUxga, 10), result.bytes);
+    // Stale HVGA frame, the cut-off first UXGA frame, one settle frame
+    TEST_ASSERT_EQUAL(3, result.discarded);
+
+    const uint8_t* jpeg = fixture.upload.jpegBuffer();
+    uint16_t width = 0;
+    uint16_t height = 0;
+    TEST_ASSERT_TRUE(SensorWindow::jpegDimensions(jpeg, result.bytes, width, height));
+    TEST_ASSERT_EQUAL(1600, width);
+    TEST_ASSERT_TRUE(SnapshotCapture::isComplete(jpeg, result.bytes));
+
+    // Live mode is back before the function returns
+    TEST_ASSERT_EQUAL(kHvga, camera.sensorFrameSize());
+    TEST_ASSERT_EQUAL(25, camera.sensorQuality());
+}
+
+void test_small_buffers_reinit_and_restore(void) {
+    SyntheticCamera camera(kVga, 3);
+    Fixture fixture(camera);
+    LiveStream live(camera, fixture.capture, 100000);
+    live.run(3);
+
+    SnapshotResult result;
+    TEST_ASSERT_TRUE(fixture.capture.capture(kUxga, 10, result) == SnapshotError::None);
+    TEST_ASSERT_TRUE(result.reinit);
+    TEST_ASSERT_EQUAL(2, camera.reallocations);
+    TEST_ASSERT_EQUAL(kVga, camera.bufferFrameSize());
+    TEST_ASSERT_EQUAL(3, camera.fbCount());
+    TEST_ASSERT_EQUAL(kHvga, camera.sensorFrameSize());
+    TEST_ASSERT_EQUAL(1600, result.width);
+    TEST_ASSERT_TRUE(result.switchUs >= camera.reinitUs);
+    TEST_ASSERT_TRUE(result.restoreUs >= camera.reinitUs);
+}
+
+void test_reinit_failure_restores_live_mode(void) {
+    SyntheticCamera camera(kVga, 3);
+    camera.failReinit = true;
+    Fixture fixture(camera);
+    LiveStream live(camera, fixture.capture, 100000);
+    live.run(3);
+
+    SnapshotResult result;
+    TEST_ASSERT_TRUE(fixture.capture.capture(kUxga, 10, result) == SnapshotError::Reinit);
+    TEST_ASSERT_EQUAL_STRING("reinit", SnapshotCapture::errorName(result.error));
+    TEST_ASSERT_EQUAL(0, result.id);
+    TEST_ASSERT_EQUAL(kVga, camera.bufferFrameSize());
+    TEST_ASSERT_EQUAL(kHvga, camera.sensorFrameSize());
+    TEST_ASSERT_TRUE(fixture.upload.isIdle());
+
+    // The stream carries on
+    live.run(3);
+    TEST_ASSERT_EQUAL(6, live.sent);
+}
+
+void test_overflowing_frames_time_out(void) {
+    // Quality 5 at UXGA (≈ 614 KB) overflows the 375 KB buffers on every frame
+    SyntheticCamera camera(kUxga, 2);
+    SnapshotConfig config;
+    config.maxWaitMs = 500;
+    Fixture fixture(camera, config);
+    LiveStream live(camera, fixture.capture, 100000);
+    live.run(2);
+
+    uint64_t startUs = camera.now;
+    SnapshotResult result;
+    TEST_ASSERT_TRUE(fixture.capture.capture(kUxga, 5, result) == SnapshotError::Capture);
+    TEST_ASSERT_TRUE(result.discarded >= 6);
+    TEST_ASSERT_TRUE(camera.now - startUs < 700000);
+    TEST_ASSERT_EQUAL(kHvga, camera.sensorFrameSize());
+    TEST_ASSERT_TRUE(fixture.upload.isIdle());
+}
+
+void test_stale_snapshot_frames_dropped_from_live(void) {
+    SyntheticCamera camera(kUxga, 3);
+    Fixture fixture(camera);
+    LiveStream live(camera, fixture.capture, 100000);
+    live.run(5);
+    uint64_t lastLiveUs = 0;
+    {
+        SnapshotFrame frame = {};
+        camera.grab(frame);
+        lastLiveUs = frame.captureUs;
+        TEST_ASSERT_TRUE(fixture.capture.admitLive(frame.data, frame.length, frame.captureUs));
+        camera.release(frame);
+    }
+
+    SnapshotResult result;
+    TEST_ASSERT_TRUE(fixture.capture.capture(kUxga, 10, result) == SnapshotError::None);
+    TEST_ASSERT_FALSE(fixture.capture.takeResult(result));  // gap not measured yet
+
+    // Next grab right away: the UXGA frame completed meanwhile is still in the ring
+    live.nextUs = camera.now;
+    live.run(3);
+    TEST_ASSERT_EQUAL(1, live.refused);
+    TEST_ASSERT_EQUAL(480, live.lastWidth);
+
+    SnapshotResult measured;
+    TEST_ASSERT_TRUE(fixture.capture.takeResult(measured));
+    TEST_ASSERT_FALSE(fixture.capture.takeResult(measured));
+    TEST_ASSERT_EQUAL(1, measured.staleDropped);
+    TEST_ASSERT_TRUE(measured.gapUs > 0);
+    TEST_ASSERT_TRUE(measured.gapUs < 600000);
+    TEST_ASSERT_TRUE(measured.gapUs >= result.switchUs + result.settleUs + result.restoreUs);
+    TEST_ASSERT_TRUE(camera.now - lastLiveUs >= measured.gapUs);
+}
+
+void test_busy_while_uploading(void) {
+    SyntheticCamera camera(kUxga, 3);
+    Fixture fixture(camera);
+    LiveStream live(camera, fixture.capture, 100000);
+    live.run(2);
+
+    SnapshotResult result;
+    TEST_ASSERT_TRUE(fixture.capture.capture(kUxga, 10, result) == SnapshotError::None);
+    fixture.upload.publish(snapshotHeader(result));
+    uint32_t modeChanges = camera.modeChanges;
+
+    SnapshotResult second;
+    TEST_ASSERT_TRUE(fixture.capture.capture(kUxga, 10, second) == SnapshotError::Busy);
+    TEST_ASSERT_EQUAL(modeChanges, camera.modeChanges);  // sensor untouched
+
+    std::vector<uint8_t> received(fixture.buffer.size());
+    SnapshotAssembler assembler(received.data(), received.size());
+    uint64_t nowUs = camera.now;
+    uploadAll(fixture.upload, assembler, nowUs);
+    TEST_ASSERT_TRUE(fixture.capture.capture(kUxga, 10, second) == SnapshotError::None);
+    TEST_ASSERT_EQUAL(2, second.id);
+}
+
+// ========================================
+// Upload
+// ========================================
+
+void test_upload_parts_interleave_with_live_frames(void) {
+    SyntheticCamera camera(kUxga, 3);
+    Fixture fixture(camera);
+    LiveStream live(camera, fixture.capture, 100000);
+    live.run(2);
+    SnapshotResult result;
+    TEST_ASSERT_TRUE(fixture.capture.capture(kUxga, 10, result) == SnapshotError::None);
+    std::vector<uint8_t> original(fixture.upload.jpegBuffer(), fixture.upload.jpegBuffer() + result.bytes);
+    fixture.upload.publish(snapshotHeader(result));
+    TEST_ASSERT_FALSE(fixture.upload.isIdle());
+
+    std::vector<uint8_t> received(fixture.buffer.size());
+    SnapshotAssembler assembler(received.data(), received.size());
+    uint8_t liveMessage[FrameEnvelope::kHeaderSize + 16] = {};
+    FrameHeader liveHeader = {};
+    liveHeader.payloadLength = 16;
+    FrameEnvelope::encode(liveHeader, liveMessage, sizeof(liveMessage));
+
+    uint64_t nowUs = camera.now;
+    uint32_t parts = 0;
+    uint32_t refusals = 0;
+    uint32_t budgets[] = {4000, 20000, 50000, 90000};  // µs before the next live frame
+    SnapshotPart part;
+    for (uint32_t turn = 0; fixture.upload.hasPending(); turn++) {
+        uint32_t budgetUs = budgets[turn % 4];
+        if (!fixture.upload.nextPart(nowUs, budgetUs, 2000, part)) {
+            refusals++;
+            nowUs += 5000;
+            continue;
+        }
+        TEST_ASSERT_TRUE(part.length - SnapshotUpload::kPartHeaderSize <= (size_t)budgetUs * 2000 / 8000);
+        memset(part.message - kHeadroom, 0xEE, kHeadroom);
+        assembler.accept(part.message, part.length);
+        fixture.upload.endPart(true, nowUs);
+        parts++;
+        // A live frame between two parts is not a part
+        TEST_ASSERT_TRUE(assembler.accept(liveMessage, sizeof(liveMessage)) == AssembleResult::Passthrough);
+    }
+    TEST_ASSERT_TRUE(fixture.upload.isIdle());
+    TEST_ASSERT_EQUAL(1, assembler.completed());
+    TEST_ASSERT_TRUE(parts > 10);
+    TEST_ASSERT_TRUE(refusals > 0);  // 4 ms holds less than a minimum part
+
+    FrameHeader header;
+    TEST_ASSERT_TRUE(FrameEnvelope::decode(assembler.snapshot(), assembler.snapshotLength(), header));
+    TEST_ASSERT_TRUE(header.flags & kEnvelopeSnapshot);
+    TEST_ASSERT_EQUAL(1, header.sequence);
+    TEST_ASSERT_EQUAL(1600, header.width);
+    TEST_ASSERT_EQUAL(result.bytes, header.payloadLength);
+    TEST_ASSERT_EQUAL_MEMORY(original.data(), assembler.snapshot() + FrameEnvelope::kHeaderSize, result.bytes);
+
+    SnapshotUploadStats stats = fixture.upload.getStats();
+    TEST_ASSERT_EQUAL(1, stats.uploaded);
+    TEST_ASSERT_EQUAL(parts, stats.parts);
+    TEST_ASSERT_EQUAL(FrameEnvelope::kHeaderSize + result.bytes, stats.bytes);
+}
+
+void test_link_share_spaces_parts(void) {
+    SyntheticCamera camera(kUxga, 3);
+    SnapshotUploadConfig config = Fixture::makeUploadConfig();
+    config.sharePercent = 25;
+    Fixture fixture(camera, SnapshotConfig(), config);
+    LiveStream live(camera, fixture.capture, 100000);
+    live.run(2);
+    SnapshotResult result;
+    fixture.capture.capture(kUxga, 10, result);
+    fixture.upload.publish(snapshotHeader(result));
+
+    // 8 KB at 1 Mbps ≈ 65 ms on the link: at 25 % the next part waits three times as long
+    SnapshotPart part;
+    uint64_t nowUs = 0;
+    TEST_ASSERT_TRUE(fixture.upload.nextPart(nowUs, 65536, 1000, part));
+    TEST_ASSERT_EQUAL(SnapshotUpload::kPartHeaderSize + 8192, part.length);
+    fixture.upload.endPart(true, nowUs);
+    TEST_ASSERT_FALSE(fixture.upload.nextPart(nowUs + 190000, 65536, 1000, part));
+    TEST_ASSERT_TRUE(fixture.upload.nextPart(nowUs + 200000, 65536, 1000, part));
+    fixture.upload.endPart(true, nowUs + 200000);
+
+    // Too little time before the next live frame: nothing
+    TEST_ASSERT_FALSE(fixture.upload.nextPart(nowUs + 1000000, 4000, 1000, part));
+}
+
+void test_failed_part_is_resent_and_restart_after_reconnect(void) {
+    SyntheticCamera camera(kUxga, 3);
+    Fixture fixture(camera);
+    LiveStream live(camera, fixture.capture, 100000);
+    live.run(2);
+    SnapshotResult result;
+    fixture.capture.capture(kUxga, 10, result);
+    std::vector<uint8_t> original(fixture.upload.jpegBuffer(), fixture.upload.jpegBuffer() + result.bytes);
+    fixture.upload.publish(snapshotHeader(result));
+
+    std::vector<uint8_t> received(fixture.buffer.size());
+    SnapshotAssembler assembler(received.data(), received.size());
+    uint64_t nowUs = 0;
+    SnapshotPart part;
+    for (int i = 0; i < 4; i++) {
+        TEST_ASSERT_TRUE(fixture.upload.nextPart(nowUs, 50000, 2000, part));
+        memset(part.message - kHeadroom, 0xEE, kHeadroom);
+        assembler.accept(part.message, part.length);
+        fixture.upload.endPart(true, nowUs);
+        nowUs += 100000;
+    }
+
+    // Transport refused a part: the same offset comes again
+    TEST_ASSERT_TRUE(fixture.upload.nextPart(nowUs, 50000, 2000, part));
+    uint32_t offset = part.offset;
+    memset(part.message - kHeadroom, 0xEE, kHeadroom);
+    fixture.upload.endPart(false, nowUs);
+    TEST_ASSERT_TRUE(fixture.upload.nextPart(nowUs, 50000, 2000, part));
+    TEST_ASSERT_EQUAL(offset, part.offset);
+    fixture.upload.endPart(false, nowUs);
+
+    // Connection lost with a part out: the receiver dropped the partial snapshot, the upload starts over
+    TEST_ASSERT_TRUE(fixture.upload.nextPart(nowUs, 50000, 2000, part));
+    memset(part.message - kHeadroom, 0xEE, kHeadroom);
+    assembler.reset();
+    fixture.upload.restart();
+    nowUs += 100000;
+    uint32_t parts = uploadAll(fixture.upload, assembler, nowUs);
+    TEST_ASSERT_TRUE(parts > 4);
+    TEST_ASSERT_EQUAL(1, assembler.completed());
+    TEST_ASSERT_EQUAL_MEMORY(original.data(), assembler.snapshot() + FrameEnvelope::kHeaderSize, result.bytes);
+
+    SnapshotUploadStats stats = fixture.upload.getStats();
+    TEST_ASSERT_EQUAL(1, stats.restarts);
+    TEST_ASSERT_EQUAL(3, stats.failedParts);
+}
+
+void test_assembler_rejects_gaps(void) {
+    uint8_t blob[1000];
+    for (size_t i = 0; i < sizeof(blob); i++) blob[i] = (uint8_t)i;
+    uint8_t message[SnapshotUpload::kPartHeaderSize + 400];
+    uint8_t buffer[2048];
+    SnapshotAssembler assembler(buffer, sizeof(buffer));
+
+    auto send = [&](uint32_t id, uint32_t offset, size_t length) {
+        SnapshotUpload::encodePart(id, offset, sizeof(blob), message, sizeof(message));
+        memcpy(message + SnapshotUpload::kPartHeaderSize, blob + offset, length);
+        return assembler.accept(message, SnapshotUpload::kPartHeaderSize + length);
+    };
+    TEST_ASSERT_TRUE(send(7, 0, 400) == AssembleResult::Pending);
+    TEST_ASSERT_TRUE(send(7, 800, 200) == AssembleResult::Dropped);  // 400..800 missing
+    TEST_ASSERT_TRUE(send(7, 400, 400) == AssembleResult::Dropped);  // orphan until a first part
+    TEST_ASSERT_TRUE(send(7, 0, 400) == AssembleResult::Pending);
+    TEST_ASSERT_TRUE(send(8, 400, 400) == AssembleResult::Dropped);  // other snapshot
+    TEST_ASSERT_TRUE(send(7, 0, 400) == AssembleResult::Pending);
+    TEST_ASSERT_TRUE(send(7, 400, 400) == AssembleResult::Pending);
+    TEST_ASSERT_TRUE(send(7, 800, 200) == AssembleResult::Complete);
+    TEST_ASSERT_EQUAL(sizeof(blob), assembler.snapshotLength());
+    TEST_ASSERT_EQUAL_MEMORY(blob, assembler.snapshot(), sizeof(blob));
+    TEST_ASSERT_EQUAL(3, assembler.dropped());
+
+    // Larger than the receiver's buffer
+    SnapshotAssembler small(buffer, 512);
+    SnapshotUpload::encodePart(9, 0, sizeof(blob), message, sizeof(message));
+    TEST_ASSERT_TRUE(small.accept(message, SnapshotUpload::kPartHeaderSize + 100) == AssembleResult::Dropped);
+}
+
+// ========================================
+// Benchmark
+// ========================================
+/**
+ * Common sketch approach for comparison: switch, wait a fixed delay for the sensor to settle,
+ * take the next frame, switch back (no geometry check: stale frames go out as live frames)
+ * @return Live stream gap (measured like SnapshotCapture: last live capture → first live-size capture)
+ */
+static uint64_t fixedDelayGap(SyntheticCamera& camera, uint64_t lastLiveUs, uint32_t delayMs, uint32_t& staleSent) {
+    SnapshotFrame frame;
+    camera.setMode(kUxga, 10);
+    camera.now += (uint64_t)delayMs * 1000;
+    camera.grab(frame);
+    camera.release(frame);
+    camera.restoreMode();
+    staleSent = 0;
+    for (;;) {
+        camera.grab(frame);
+        uint16_t width = 0;
+        uint16_t height = 0;
+        SensorWindow::jpegDimensions(frame.data, frame.length, width, height);
+        camera.release(frame);
+        if (width == ProfilePlanner::frameWidth(camera.liveSize)) {
+            return frame.captureUs - lastLiveUs;
+        }
+        staleSent++;
+    }
+}
+
+void test_benchmark(void) {
+    struct Variant {
+        const char* name;
+        uint8_t fbFrameSize;
+        uint8_t settleFrames;
+    };
+    static const Variant variants[] = {
+        {"live switch, settle 0", kUxga, 0},
+        {"live switch, settle 1", kUxga, 1},
+        {"re-init, settle 0", kVga, 0},
+        {"re-init, settle 1", kVga, 1},
+    };
+    printf("\n  HVGA q25 live stream at 10 FPS, UXGA q10 snapshot (OV2640 model: 15 FPS UXGA, 30 FPS SVGA)\n");
+    printf("  %-24s %8s %9s %9s %10s %8s %9s\n", "variant", "buffers", "switch", "settle", "restore", "gap",
+           "discarded");
+    uint64_t directGapUs = 0;
+    for (const Variant& v : variants) {
+        SyntheticCamera camera(v.fbFrameSize, 3);
+        SnapshotConfig config;
+        config.settleFrames = v.settleFrames;
+        Fixture fixture(camera, config);
+        LiveStream live(camera, fixture.capture, 100000);
+        live.run(5);
+        camera.now = live.nextUs;  // snapshot right after a live frame
+
+        SnapshotResult result;
+        TEST_ASSERT_TRUE(fixture.capture.capture(kUxga, 10, result) == SnapshotError::None);
+        live.nextUs = camera.now;
+        while (!fixture.capture.takeResult(result)) {
+            live.step();
+        }
+        if (v.fbFrameSize == kUxga && v.settleFrames == 1) {
+            directGapUs = result.gapUs;
+        }
+        printf("  %-24s %8s %6.1f ms %6.1f ms %7.1f ms %5.0f ms %9u\n", v.name,
+               ProfilePlanner::frameSizeName(v.fbFrameSize), result.switchUs / 1000.0, result.settleUs / 1000.0,
+               result.restoreUs / 1000.0, result.gapUs / 1000.0, result.discarded + result.staleDropped);
+    }
+    {
+        SyntheticCamera camera(kUxga, 3);
+        Fixture fixture(camera);
+        LiveStream live(camera, fixture.capture, 100000);
+        live.run(5);
+        camera.now = live.nextUs;
+        uint32_t staleSent = 0;
+        uint64_t gapUs = fixedDelayGap(camera, live.lastCaptureUs, 500, staleSent);
+        printf("  %-24s %8s %31s %5.0f ms %9s (stale frames sent as live: %u)\n", "fixed 500 ms delay",
+               "UXGA", "", gapUs / 1000.0, "-", staleSent);
+        TEST_ASSERT_TRUE(directGapUs < gapUs);
+    }
+
+    // Upload next to the live stream: parts only in the idle half of each frame interval
+    printf("\n  UXGA q10 snapshot (%u KB) upload next to HVGA q25 live frames (%u KB every 100 ms)\n",
+           (unsigned)(jpegBytes(kUxga, 10) / 1024), (unsigned)(jpegBytes(kHvga, 25) / 1024));
+    printf("  %-10s %8s %12s %10s %14s\n", "link", "parts", "upload", "live late", "live share");
+    static const uint32_t links[] = {1000, 2000, 5000, 10000};
+    for (uint32_t kbps : links) {
+        SyntheticCamera camera(kUxga, 3);
+        Fixture fixture(camera);
+        LiveStream live(camera, fixture.capture, 100000);
+        live.run(2);
+        SnapshotResult result;
+        fixture.capture.capture(kUxga, 10, result);
+        fixture.upload.publish(snapshotHeader(result));
+
+        std::vector<uint8_t> received(fixture.buffer.size());
+        SnapshotAssembler assembler(received.data(), received.size());
+        const uint64_t intervalUs = 100000;
+        const uint64_t liveUs = jpegBytes(kHvga, 25) * 8000 / kbps;
+        uint64_t frameStartUs = 0;
+        uint64_t lateUs = 0;
+        uint64_t busyUs = 0;
+        uint32_t parts = 0;
+        while (fixture.upload.hasPending()) {
+            // Live frame first; the network task is idle for the rest of the interval
+            uint64_t nowUs = frameStartUs + liveUs;
+            busyUs += liveUs;
+            SnapshotPart part;
+            while (nowUs < frameStartUs + intervalUs) {
+                uint32_t budgetUs = (uint32_t)(frameStartUs + intervalUs - nowUs);
+                if (budgetUs > intervalUs / 2) budgetUs = (uint32_t)(intervalUs / 2);
+                if (!fixture.upload.nextPart(nowUs, budgetUs, kbps, part)) {
+                    nowUs += 1000;
+                    continue;
+                }
+                nowUs += part.length * 8000 / kbps;
+                assembler.accept(part.message, part.length);
+                fixture.upload.endPart(true, nowUs);
+                parts++;
+            }
+            if (nowUs > frameStartUs + intervalUs) {
+                lateUs = nowUs - (frameStartUs + intervalUs) > lateUs ? nowUs - (frameStartUs + intervalUs) : lateUs;
+            }
+            frameStartUs += intervalUs;
+        }
+        TEST_ASSERT_EQUAL(1, assembler.completed());
+        printf("  %5.1f Mbps %8u %9.1f s %7.1f ms %13.0f%%\n", kbps / 1000.0, parts, frameStartUs / 1e6,
+               lateUs / 1000.0, 100.0 * busyUs / frameStartUs);
+    }
+}
+
+int main(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+    UNITY_BEGIN();
+    RUN_TEST(test_direct_switch_takes_first_valid_frame);
+    RUN_TEST(test_small_buffers_reinit_and_restore);
+    RUN_TEST(test_reinit_failure_restores_live_mode);
+    RUN_TEST(test_overflowing_frames_time_out);
+    RUN_TEST(test_stale_snapshot_frames_dropped_from_live);
+    RUN_TEST(test_busy_while_uploading);
+    RUN_TEST(test_upload_parts_interleave_with_live_frames);
+    RUN_TEST(test_link_share_spaces_parts);
+    RUN_TEST(test_failed_part_is_resent_and_restart_after_reconnect);
+    RUN_TEST(test_assembler_rejects_gaps);
+    RUN_TEST(test_benchmark);
+    return UNITY_END();
+}
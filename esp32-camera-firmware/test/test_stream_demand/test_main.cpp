@@ -0,0 +1,273 @@
+/**
+ * `test_main.cpp`
+ * - Unit tests and benchmark for StreamDemand (native host build)
+ * - The benchmark replays one hour of relay consumer sets at 10 FPS: upload bytes with and
+ *   without the demand gate, and viewer arrival to first frame
+ * - Run: pio test -e native -f test_stream_demand
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#include <unity.h>
+
+#include <stdio.h>
+
+#include "StreamDemand.h"
+
+void setUp(void) {}
+void tearDown(void) {}
+
+static StreamDemand makeDemand() {
+    StreamDemandConfig config;
+    config.analyzerIntervalMs = 500;
+    config.lingerMs = 5000;
+    return StreamDemand(config);
+}
+
+static ConsumerSet consumers(uint16_t live, uint16_t analyzer) {
+    ConsumerSet set;
+    set.live = live;
+    set.analyzer = analyzer;
+    return set;
+}
+
+// ========================================
+// Parsing
+// ========================================
+
+void test_parse_consumer_sets(void) {
+    ConsumerSet set;
+    TEST_ASSERT_TRUE(StreamDemand::parse("2:1", set));
+    TEST_ASSERT_EQUAL(2, set.live);
+    TEST_ASSERT_EQUAL(1, set.analyzer);
+    TEST_ASSERT_TRUE(StreamDemand::parse("0:0", set));
+    TEST_ASSERT_EQUAL(0, set.live);
+
+    TEST_ASSERT_FALSE(StreamDemand::parse("", set));
+    TEST_ASSERT_FALSE(StreamDemand::parse("3", set));
+    TEST_ASSERT_FALSE(StreamDemand::parse("1:2:3", set));
+    TEST_ASSERT_FALSE(StreamDemand::parse("1:2x", set));
+    TEST_ASSERT_FALSE(StreamDemand::parse("70000:0", set));
+    TEST_ASSERT_FALSE(StreamDemand::parse(NULL, set));
+}
+
+// ========================================
+// Modes
+// ========================================
+
+void test_live_until_subscribed(void) {
+    StreamDemand demand = makeDemand();
+    TEST_ASSERT_FALSE(demand.isSubscribed());
+    TEST_ASSERT_TRUE(demand.getMode() == StreamMode::Live);
+    for (uint32_t t = 0; t < 1000; t += 100) {
+        TEST_ASSERT_TRUE(demand.admit(true, 1000, t));
+    }
+    TEST_ASSERT_FALSE(demand.admit(false, 1000, 1000));   // the motion gate still decides
+    TEST_ASSERT_EQUAL(0, demand.getStats().suppressed);
+}
+
+void test_ramp_down_waits_for_linger(void) {
+    StreamDemand demand = makeDemand();
+    demand.setConsumers(consumers(1, 0), 0);
+    demand.setConsumers(consumers(0, 0), 1000);
+    TEST_ASSERT_TRUE(demand.getPendingMode() == StreamMode::Idle);
+    TEST_ASSERT_EQUAL(5000, demand.getPendingMs(1000));
+
+    TEST_ASSERT_TRUE(demand.admit(true, 1000, 5900));
+    TEST_ASSERT_TRUE(demand.getMode() == StreamMode::Live);
+    TEST_ASSERT_FALSE(demand.admit(true, 1000, 6000));
+    TEST_ASSERT_TRUE(demand.getMode() == StreamMode::Idle);
+    TEST_ASSERT_EQUAL(0, demand.getPendingMs(6000));
+}
+
+void test_returning_consumer_cancels_ramp_down(void) {
+    StreamDemand demand = makeDemand();
+    demand.setConsumers(consumers(1, 0), 0);
+    demand.setConsumers(consumers(0, 0), 1000);   // page reload
+    demand.setConsumers(consumers(1, 0), 1800);
+    TEST_ASSERT_TRUE(demand.getPendingMode() == StreamMode::Live);
+    TEST_ASSERT_TRUE(demand.admit(true, 1000, 10000));
+    TEST_ASSERT_TRUE(demand.getMode() == StreamMode::Live);
+    TEST_ASSERT_EQUAL(0, demand.getStats().modeChanges);
+}
+
+void test_ramp_up_is_immediate_and_skips_motion_gate(void) {
+    StreamDemand demand = makeDemand();
+    demand.setConsumers(consumers(0, 0), 0);
+    TEST_ASSERT_FALSE(demand.admit(true, 1000, 6000));
+    TEST_ASSERT_TRUE(demand.getMode() == StreamMode::Idle);
+
+    demand.setConsumers(consumers(1, 0), 7000);
+    TEST_ASSERT_TRUE(demand.getMode() == StreamMode::Live);
+    TEST_ASSERT_TRUE(demand.admit(false, 1000, 7040));    // static scene: sent anyway
+    TEST_ASSERT_FALSE(demand.admit(false, 1000, 7080));   // then the motion gate decides again
+    TEST_ASSERT_TRUE(demand.admit(true, 1000, 7120));
+    TEST_ASSERT_EQUAL(1, demand.getStats().rampUps);
+}
+
+void test_analyzer_mode_limits_rate(void) {
+    StreamDemand demand = makeDemand();
+    demand.setConsumers(consumers(0, 1), 5000);
+    TEST_ASSERT_TRUE(demand.getMode() == StreamMode::Analyzer);
+
+    uint32_t sent = 0;
+    for (uint32_t t = 5000; t < 15000; t += 100) {
+        if (demand.admit(true, 1000, t)) {
+            sent++;
+        }
+    }
+    TEST_ASSERT_EQUAL(20, sent);                          // 10 s at 2 FPS
+    TEST_ASSERT_EQUAL(80, demand.getStats().suppressed);
+    TEST_ASSERT_EQUAL(80000, (uint32_t)demand.getStats().suppressedBytes);
+}
+
+void test_analyzer_to_live_ramps_up(void) {
+    StreamDemand demand = makeDemand();
+    demand.setConsumers(consumers(0, 1), 0);
+    demand.update(5000);
+    TEST_ASSERT_TRUE(demand.admit(true, 1000, 5000));
+    demand.setConsumers(consumers(1, 1), 5100);
+    TEST_ASSERT_TRUE(demand.admit(true, 1000, 5140));    // inside the analyzer interval
+    TEST_ASSERT_TRUE(demand.admit(true, 1000, 5180));
+}
+
+void test_idle_suppresses_everything(void) {
+    StreamDemand demand = makeDemand();
+    demand.setConsumers(consumers(0, 0), 0);
+    demand.update(5000);
+    for (uint32_t t = 5000; t < 6000; t += 100) {
+        TEST_ASSERT_FALSE(demand.admit(true, 2000, t));
+        TEST_ASSERT_FALSE(demand.admit(false, 2000, t));
+    }
+    TEST_ASSERT_EQUAL(10, demand.getStats().suppressed);   // only frames the motion gate wanted
+    TEST_ASSERT_EQUAL(20000, (uint32_t)demand.getStats().suppressedBytes);
+}
+
+void test_first_set_applies_at_once(void) {
+    StreamDemand demand = makeDemand();
+    demand.setConsumers(consumers(0, 0), 3000);
+    TEST_ASSERT_TRUE(demand.isSubscribed());
+    TEST_ASSERT_TRUE(demand.getMode() == StreamMode::Idle);
+    TEST_ASSERT_FALSE(demand.admit(true, 1000, 3040));
+    TEST_ASSERT_EQUAL(0, demand.getStats().rampUps);
+}
+
+void test_reset_returns_to_live(void) {
+    StreamDemand demand = makeDemand();
+    demand.setConsumers(consumers(0, 0), 0);
+    TEST_ASSERT_TRUE(demand.getMode() == StreamMode::Idle);
+
+    demand.reset(6000);
+    TEST_ASSERT_FALSE(demand.isSubscribed());
+    TEST_ASSERT_TRUE(demand.getMode() == StreamMode::Live);
+    TEST_ASSERT_TRUE(demand.admit(true, 1000, 6100));
+
+    demand.setConsumers(consumers(0, 1), 7000);   // new relay connection
+    TEST_ASSERT_TRUE(demand.getMode() == StreamMode::Analyzer);
+}
+
+void test_time_per_mode(void) {
+    StreamDemand demand = makeDemand();
+    demand.setConsumers(consumers(0, 1), 2000);
+    demand.setConsumers(consumers(2, 1), 20000);
+    demand.setConsumers(consumers(0, 0), 30000);
+    demand.update(35000);                      // live until the linger expires
+    demand.update(40000);
+    const StreamDemandStats& stats = demand.getStats();
+    TEST_ASSERT_EQUAL(2000 + 15000, stats.modeMs[(int)StreamMode::Live]);
+    TEST_ASSERT_EQUAL(18000, stats.modeMs[(int)StreamMode::Analyzer]);
+    TEST_ASSERT_EQUAL(5000, stats.modeMs[(int)StreamMode::Idle]);
+    TEST_ASSERT_EQUAL(3, stats.modeChanges);
+}
+
+// ========================================
+// Benchmark
+// ========================================
+
+/**
+ * Relay consumer set change (seconds into the run)
+ */
+struct DemandStep {
+    uint32_t atS;
+    uint16_t live;
+    uint16_t analyzer;
+};
+
+void test_benchmark(void) {
+    struct Scenario {
+        const char* name;
+        DemandStep steps[6];
+        size_t count;
+    };
+    static const Scenario scenarios[] = {
+        {"viewer all hour", {{0, 1, 1}}, 1},
+        {"analyzer + 2 views", {{0, 0, 1}, {610, 1, 1}, {900, 0, 1}, {2410, 2, 1}, {2700, 0, 1}}, 5},
+        {"2 short views", {{0, 0, 0}, {610, 1, 0}, {900, 0, 0}, {2410, 1, 0}, {2700, 0, 0}}, 5},
+        {"nobody", {{0, 0, 0}}, 1},
+    };
+    // One hour at 10 FPS, 25 KB frames; viewers arrive during still scenes
+    const uint32_t frameBytes = 25 * 1024;
+    const uint32_t frameMs = 100;
+    const uint32_t durationMs = 3600 * 1000;
+
+    printf("\n  %-20s %10s %10s %7s %12s\n", "scenario", "always MB", "demand MB", "saved", "first frame");
+    for (size_t s = 0; s < sizeof(scenarios) / sizeof(scenarios[0]); s++) {
+        const Scenario& scenario = scenarios[s];
+        StreamDemand demand = makeDemand();
+        uint64_t alwaysBytes = 0;
+        uint64_t demandBytes = 0;
+        uint32_t worstFirstFrameMs = 0;
+        uint32_t viewerArrivedMs = 0;
+        bool awaitingFrame = false;
+        size_t next = 0;
+
+        for (uint32_t t = 0; t < durationMs; t += frameMs) {
+            while (next < scenario.count && scenario.steps[next].atS * 1000 <= t) {
+                const DemandStep& step = scenario.steps[next++];
+                if (step.live > 0 && demand.getConsumers().live == 0) {
+                    viewerArrivedMs = t;
+                    awaitingFrame = true;
+                }
+                demand.setConsumers(consumers(step.live, step.analyzer), t);
+            }
+            bool wanted = (t / 10000) % 2 == 0;   // 10 s motion, 10 s still (keep-alive off)
+            if (wanted) {
+                alwaysBytes += frameBytes;
+            }
+            if (demand.admit(wanted, frameBytes, t)) {
+                demandBytes += frameBytes;
+                if (awaitingFrame) {
+                    uint32_t firstMs = t - viewerArrivedMs;
+                    worstFirstFrameMs = firstMs > worstFirstFrameMs ? firstMs : worstFirstFrameMs;
+                    awaitingFrame = false;
+                }
+            }
+        }
+        TEST_ASSERT_FALSE(awaitingFrame);
+        TEST_ASSERT_TRUE(worstFirstFrameMs <= frameMs);
+        printf("  %-20s %10.1f %10.1f %6.0f%% %9u ms\n", scenario.name, alwaysBytes / 1048576.0,
+               demandBytes / 1048576.0, 100.0 * (alwaysBytes - demandBytes) / alwaysBytes, worstFirstFrameMs);
+    }
+}
+
+int main(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+    UNITY_BEGIN();
+    RUN_TEST(test_parse_consumer_sets);
+    RUN_TEST(test_live_until_subscribed);
+    RUN_TEST(test_ramp_down_waits_for_linger);
+    RUN_TEST(test_returning_consumer_cancels_ramp_down);
+    RUN_TEST(test_ramp_up_is_immediate_and_skips_motion_gate);
+    RUN_TEST(test_analyzer_mode_limits_rate);
+    RUN_TEST(test_analyzer_to_live_ramps_up);
+    RUN_TEST(test_idle_suppresses_everything);
+    RUN_TEST(test_first_set_applies_at_once);
+    RUN_TEST(test_reset_returns_to_live);
+    RUN_TEST(test_time_per_mode);
+    RUN_TEST(test_benchmark);
+    return UNITY_END();
+}
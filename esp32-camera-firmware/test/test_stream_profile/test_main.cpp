@@ -0,0 +1,281 @@
+/**
+ * `test_main.cpp`
+ * - Unit tests for StreamProfile (native host build)
+ * - Parsing, validation against the limits and capabilities, frame buffer planning
+ *   (live switch vs re-init, buffer count under memory pressure) and the CAPS message
+ * - Run: pio test -e native -f test_stream_profile
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#include <unity.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#include "StreamProfile.h"
+
+void setUp(void) {}
+void tearDown(void) {}
+
+// framesize_t values used below
+static const uint8_t kQvga = 5;
+static const uint8_t kHvga = 7;
+static const uint8_t kVga = 8;
+static const uint8_t kSvga = 9;
+static const uint8_t kUxga = 13;
+
+/**
+ * AI-Thinker ESP32-CAM: OV2640, 4 MB PSRAM, three VGA buffers in PSRAM at 20 MHz
+ */
+static CameraCaps makeCaps() {
+    CameraCaps caps = {};
+    caps.sensorName = "OV2640";
+    caps.sensorPid = 0x26;
+    caps.maxFrameSize = kUxga;
+    caps.jpeg = true;
+    caps.psramBytes = 4 * 1024 * 1024;
+    caps.fbCount = 3;
+    caps.fbInPsram = true;
+    caps.fbFrameSize = kVga;
+    caps.fbFreeBytes = 3 * 1024 * 1024;
+    caps.fbLargestFree = 3 * 1024 * 1024;
+    caps.xclkMhz = 20;
+    return caps;
+}
+
+static StreamProfile makeProfile(uint8_t frameSize, uint8_t quality, uint32_t intervalMs, uint8_t xclkMhz = 0) {
+    StreamProfile profile = {frameSize, quality, intervalMs, xclkMhz};
+    return profile;
+}
+
+// ========================================
+// Parsing
+// ========================================
+
+void test_parse_profiles(void) {
+    StreamProfile profile = {};
+    TEST_ASSERT_EQUAL(ProfileError::None, ProfilePlanner::parse("VGA:12:100", profile));
+    TEST_ASSERT_EQUAL_UINT8(kVga, profile.frameSize);
+    TEST_ASSERT_EQUAL_UINT8(12, profile.jpegQuality);
+    TEST_ASSERT_EQUAL_UINT32(100, profile.intervalMs);
+    TEST_ASSERT_EQUAL_UINT8(0, profile.xclkMhz);
+
+    TEST_ASSERT_EQUAL(ProfileError::None, ProfilePlanner::parse("uxga:20:200:10", profile));
+    TEST_ASSERT_EQUAL_UINT8(kUxga, profile.frameSize);
+    TEST_ASSERT_EQUAL_UINT8(10, profile.xclkMhz);
+
+    TEST_ASSERT_EQUAL(ProfileError::None, ProfilePlanner::parse("240X240:30:66", profile));
+    TEST_ASSERT_EQUAL_UINT8(4, profile.frameSize);
+}
+
+void test_parse_rejects_malformed(void) {
+    StreamProfile profile = {};
+    const char* malformed[] = {
+        "", "VGA", "VGA:", "VGA:12", "VGA:12:", ":12:100", "VGA:12:100:", "VGA:12:100:0",
+        "VGA:12:100:20:1", "VGA:-1:100", "VGA: 12:100", "VGA:+12:100", "VGA:12:100x", "VGA:300:100",
+    };
+    for (const char* text : malformed) {
+        TEST_ASSERT_EQUAL_MESSAGE(ProfileError::Malformed, ProfilePlanner::parse(text, profile), text);
+    }
+    TEST_ASSERT_EQUAL(ProfileError::Malformed, ProfilePlanner::parse(NULL, profile));
+    TEST_ASSERT_EQUAL(ProfileError::FrameSize, ProfilePlanner::parse("QXGA:12:100", profile));
+    TEST_ASSERT_EQUAL(ProfileError::FrameSize, ProfilePlanner::parse("VGAX:12:100", profile));
+    TEST_ASSERT_EQUAL(ProfileError::FrameSize, ProfilePlanner::parse("VG:12:100", profile));
+}
+
+void test_frame_size_names(void) {
+    uint8_t frameSize = 0;
+    for (uint8_t i = 0; i < ProfilePlanner::kFrameSizeCount; i++) {
+        const char* name = ProfilePlanner::frameSizeName(i);
+        TEST_ASSERT_TRUE(ProfilePlanner::frameSizeFromName(name, strlen(name), frameSize));
+        TEST_ASSERT_EQUAL_UINT8(i, frameSize);
+    }
+    TEST_ASSERT_EQUAL_STRING("?", ProfilePlanner::frameSizeName(ProfilePlanner::kFrameSizeCount));
+    TEST_ASSERT_EQUAL(640, ProfilePlanner::frameWidth(kVga));
+    TEST_ASSERT_EQUAL(1200, ProfilePlanner::frameHeight(kUxga));
+    TEST_ASSERT_EQUAL_UINT32(61440, ProfilePlanner::frameBufferBytes(kVga));
+    TEST_ASSERT_EQUAL_UINT32(384000, ProfilePlanner::frameBufferBytes(kUxga));
+    TEST_ASSERT_EQUAL_STRING("memory", ProfilePlanner::errorName(ProfileError::Memory));
+}
+
+// ========================================
+// Planning
+// ========================================
+
+void test_limits_are_enforced(void) {
+    ProfilePlanner planner{ProfileLimits()};
+    CameraCaps caps = makeCaps();
+    ProfilePlan plan = {};
+    TEST_ASSERT_EQUAL(ProfileError::Quality, planner.plan(makeProfile(kVga, 2, 100), caps, plan));
+    TEST_ASSERT_EQUAL(ProfileError::Quality, planner.plan(makeProfile(kVga, 64, 100), caps, plan));
+    TEST_ASSERT_EQUAL(ProfileError::Interval, planner.plan(makeProfile(kVga, 12, 10), caps, plan));
+    TEST_ASSERT_EQUAL(ProfileError::Interval, planner.plan(makeProfile(kVga, 12, 20000), caps, plan));
+    TEST_ASSERT_EQUAL(ProfileError::Xclk, planner.plan(makeProfile(kVga, 12, 100, 40), caps, plan));
+    TEST_ASSERT_EQUAL(ProfileError::FrameSize, planner.plan(makeProfile(14, 12, 100), caps, plan));
+
+    // VGA-only sensor (e.g. OV7725)
+    caps.maxFrameSize = kVga;
+    TEST_ASSERT_EQUAL(ProfileError::FrameSize, planner.plan(makeProfile(kSvga, 12, 100), caps, plan));
+    TEST_ASSERT_EQUAL(ProfileError::None, planner.plan(makeProfile(kVga, 12, 100), caps, plan));
+}
+
+void test_smaller_frames_switch_live(void) {
+    ProfilePlanner planner{ProfileLimits()};
+    CameraCaps caps = makeCaps();
+    ProfilePlan plan = {};
+    TEST_ASSERT_EQUAL(ProfileError::None, planner.plan(makeProfile(kQvga, 25, 66), caps, plan));
+    TEST_ASSERT_FALSE(plan.reinit);
+    TEST_ASSERT_FALSE(plan.xclkChange);
+    TEST_ASSERT_EQUAL_UINT8(20, plan.profile.xclkMhz);   // kept
+    TEST_ASSERT_EQUAL_UINT8(kVga, plan.fbFrameSize);
+    TEST_ASSERT_EQUAL_UINT8(3, plan.fbCount);
+    TEST_ASSERT_EQUAL_UINT32(3 * 61440, plan.fbBytes);
+
+    // Same size, different clock: set_xclk, buffers stay
+    TEST_ASSERT_EQUAL(ProfileError::None, planner.plan(makeProfile(kVga, 12, 100, 10), caps, plan));
+    TEST_ASSERT_FALSE(plan.reinit);
+    TEST_ASSERT_TRUE(plan.xclkChange);
+    TEST_ASSERT_EQUAL_UINT8(10, plan.profile.xclkMhz);
+}
+
+void test_larger_frames_reallocate_buffers(void) {
+    ProfilePlanner planner{ProfileLimits()};
+    CameraCaps caps = makeCaps();
+    ProfilePlan plan = {};
+    TEST_ASSERT_EQUAL(ProfileError::None, planner.plan(makeProfile(kUxga, 20, 200), caps, plan));
+    TEST_ASSERT_TRUE(plan.reinit);
+    TEST_ASSERT_EQUAL_UINT8(kUxga, plan.fbFrameSize);
+    TEST_ASSERT_EQUAL_UINT8(3, plan.fbCount);
+    TEST_ASSERT_EQUAL_UINT32(3 * 384000, plan.fbBytes);
+
+    // After the switch the buffers are UXGA-sized: going back down is live
+    caps.fbFrameSize = plan.fbFrameSize;
+    caps.fbFreeBytes -= plan.fbBytes - 3 * 61440;
+    TEST_ASSERT_EQUAL(ProfileError::None, planner.plan(makeProfile(kHvga, 25, 100), caps, plan));
+    TEST_ASSERT_FALSE(plan.reinit);
+    TEST_ASSERT_EQUAL_UINT8(kUxga, plan.fbFrameSize);
+}
+
+void test_buffer_count_shrinks_to_fit_memory(void) {
+    ProfileLimits limits;
+    limits.minFbCount = 2;
+    ProfilePlanner planner(limits);
+    CameraCaps caps = makeCaps();
+    ProfilePlan plan = {};
+
+    // 700 KB free + 180 KB of VGA buffers - 32 KB reserve: two UXGA buffers (750 KB) fit, three do not
+    caps.fbFreeBytes = 700 * 1024;
+    TEST_ASSERT_EQUAL(ProfileError::None, planner.plan(makeProfile(kUxga, 20, 200), caps, plan));
+    TEST_ASSERT_TRUE(plan.reinit);
+    TEST_ASSERT_EQUAL_UINT8(2, plan.fbCount);
+
+    // One would fit, but the pipeline needs two
+    caps.fbFreeBytes = 300 * 1024;
+    TEST_ASSERT_EQUAL(ProfileError::Memory, planner.plan(makeProfile(kUxga, 20, 200), caps, plan));
+
+    // Fragmented: the total fits, no block holds one buffer
+    caps.fbFreeBytes = 3 * 1024 * 1024;
+    caps.fbLargestFree = 256 * 1024;
+    TEST_ASSERT_EQUAL(ProfileError::Memory, planner.plan(makeProfile(kUxga, 20, 200), caps, plan));
+    TEST_ASSERT_EQUAL(ProfileError::None, planner.plan(makeProfile(kSvga, 12, 100), caps, plan));
+}
+
+void test_dram_only_board(void) {
+    ProfilePlanner planner{ProfileLimits()};
+    CameraCaps caps = makeCaps();
+    caps.psramBytes = 0;
+    caps.fbCount = 1;
+    caps.fbInPsram = false;
+    caps.fbFrameSize = kHvga;
+    caps.fbFreeBytes = 110 * 1024;
+    caps.fbLargestFree = 80 * 1024;
+    ProfilePlan plan = {};
+    TEST_ASSERT_EQUAL(ProfileError::None, planner.plan(makeProfile(kVga, 12, 100), caps, plan));
+    TEST_ASSERT_TRUE(plan.reinit);
+    TEST_ASSERT_EQUAL_UINT8(1, plan.fbCount);
+    TEST_ASSERT_EQUAL(ProfileError::Memory, planner.plan(makeProfile(kSvga, 12, 100), caps, plan));
+}
+
+// ========================================
+// Capabilities
+// ========================================
+
+void test_caps_message(void) {
+    ProfilePlanner planner{ProfileLimits()};
+    CameraCaps caps = makeCaps();
+    char text[512];
+    size_t length = planner.formatCaps(caps, text, sizeof(text));
+    TEST_ASSERT_GREATER_THAN(0, length);
+    TEST_ASSERT_EQUAL(strlen(text), length);
+    const char* prefix = "CAPS:{\"sensor\":\"OV2640\",\"pid\":38,\"jpeg\":true,\"frameSizes\":[\"96X96\",";
+    TEST_ASSERT_EQUAL(0, strncmp(prefix, text, strlen(prefix)));
+    TEST_ASSERT_NOT_NULL(strstr(text, "\"UXGA\"]"));
+    TEST_ASSERT_NOT_NULL(strstr(text, "\"fb\":{\"count\":3,\"location\":\"PSRAM\",\"frameSize\":\"VGA\",\"bytes\":184320,"));
+    TEST_ASSERT_NOT_NULL(strstr(text, "\"limits\":{\"quality\":[4,63],\"intervalMs\":[33,10000],\"xclkMhz\":[8,25]}}"));
+    TEST_ASSERT_EQUAL('}', text[length - 1]);
+    printf("\n  %s (%u bytes)\n", text, (unsigned)length);
+
+    // Frame sizes stop at the sensor's largest
+    caps.maxFrameSize = kVga;
+    planner.formatCaps(caps, text, sizeof(text));
+    TEST_ASSERT_NOT_NULL(strstr(text, "\"HVGA\",\"VGA\"],"));
+
+    // Too small: nothing half-written
+    TEST_ASSERT_EQUAL(0, planner.formatCaps(caps, text, 64));
+    TEST_ASSERT_EQUAL('\0', text[0]);
+}
+
+/**
+ * How a server-pushed profile sequence is applied on a 4 MB PSRAM board
+ */
+void test_plan_table(void) {
+    ProfileLimits limits;
+    limits.minFbCount = 2;
+    ProfilePlanner planner(limits);
+    CameraCaps caps = makeCaps();
+    const char* requests[] = {
+        "QVGA:25:66", "HVGA:25:100", "VGA:12:100:10", "SVGA:12:100", "UXGA:20:200", "VGA:12:100", "UXGA:4:10",
+    };
+    printf("\n  %-16s %-10s %-7s %5s %-6s %9s\n", "request", "result", "switch", "fbs", "fb", "fb KB");
+    for (const char* request : requests) {
+        StreamProfile profile = {};
+        ProfilePlan plan = {};
+        ProfileError error = ProfilePlanner::parse(request, profile);
+        if (error == ProfileError::None) {
+            error = planner.plan(profile, caps, plan);
+        }
+        if (error != ProfileError::None) {
+            printf("  %-16s %-10s\n", request, ProfilePlanner::errorName(error));
+            continue;
+        }
+        printf("  %-16s %-10s %-7s %5u %-6s %9u\n", request, "ok", plan.reinit ? "reinit" : "live", plan.fbCount,
+               ProfilePlanner::frameSizeName(plan.fbFrameSize), plan.fbBytes / 1024);
+        caps.fbFreeBytes -= plan.fbBytes - ProfilePlanner::frameBufferBytes(caps.fbFrameSize) * caps.fbCount;
+        caps.fbFrameSize = plan.fbFrameSize;
+        caps.fbCount = plan.fbCount;
+        caps.xclkMhz = plan.profile.xclkMhz;
+    }
+    TEST_ASSERT_EQUAL_UINT8(kUxga, caps.fbFrameSize);
+    TEST_ASSERT_EQUAL_UINT8(10, caps.xclkMhz);
+}
+
+int main(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+    UNITY_BEGIN();
+    RUN_TEST(test_parse_profiles);
+    RUN_TEST(test_parse_rejects_malformed);
+    RUN_TEST(test_frame_size_names);
+    RUN_TEST(test_limits_are_enforced);
+    RUN_TEST(test_smaller_frames_switch_live);
+    RUN_TEST(test_larger_frames_reallocate_buffers);
+    RUN_TEST(test_buffer_count_shrinks_to_fit_memory);
+    RUN_TEST(test_dram_only_board);
+    RUN_TEST(test_caps_message);
+    RUN_TEST(test_plan_table);
+    return UNITY_END();
+}
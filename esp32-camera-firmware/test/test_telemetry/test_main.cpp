@@ -0,0 +1,281 @@
+/**
+ * `test_main.cpp`
+ * - Unit tests for Histogram and Telemetry (native host build)
+ * - Run: pio test -e native -f test_telemetry
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#include <unity.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Histogram.h"
+#include "Telemetry.h"
+
+void setUp(void) {}
+void tearDown(void) {}
+
+/**
+ * Integer field of a JSON object inside the snapshot ("key":{... "field":N ...})
+ */
+static long long snapshotField(const char* snapshot, const char* key, const char* field) {
+    std::string text(snapshot);
+    size_t object = text.find(std::string("\"") + key + "\":");
+    if (object == std::string::npos) {
+        return -1;
+    }
+    if (field == NULL) {
+        return atoll(text.c_str() + object + strlen(key) + 3);
+    }
+    size_t end = text.find('}', object);
+    size_t pos = text.find(std::string("\"") + field + "\":", object);
+    if (pos == std::string::npos || pos > end) {
+        return -1;
+    }
+    return atoll(text.c_str() + pos + strlen(field) + 3);
+}
+
+// ========================================
+// Histogram
+// ========================================
+void test_bucket_bounds_cover_every_value() {
+    // Buckets are contiguous and each value maps into its own bucket's range
+    for (size_t i = 1; i < Histogram::kBucketCount; i++) {
+        TEST_ASSERT_EQUAL_UINT32(Histogram::bucketUpperBound(i - 1) + 1, Histogram::bucketLowerBound(i));
+    }
+    TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, Histogram::bucketUpperBound(Histogram::kBucketCount - 1));
+
+    const uint32_t values[] = { 0, 1, 7, 8, 15, 16, 17, 1000, 33333, 1000000, 0x80000000u, UINT32_MAX };
+    for (uint32_t value : values) {
+        size_t index = Histogram::bucketIndex(value);
+        TEST_ASSERT_LESS_THAN(Histogram::kBucketCount, index);
+        TEST_ASSERT_TRUE(value >= Histogram::bucketLowerBound(index));
+        TEST_ASSERT_TRUE(value <= Histogram::bucketUpperBound(index));
+        // Relative bucket width stays within 1/8
+        uint32_t width = Histogram::bucketUpperBound(index) - Histogram::bucketLowerBound(index);
+        TEST_ASSERT_TRUE((uint64_t)width * 8 <= (uint64_t)Histogram::bucketLowerBound(index) || value < 8);
+    }
+}
+
+void test_percentiles_within_bucket_error() {
+    Histogram histogram;
+    for (uint32_t value = 1; value <= 10000; value++) {
+        histogram.record(value);
+    }
+    HistogramSummary summary = histogram.summarize();
+    TEST_ASSERT_EQUAL_UINT32(10000, summary.count);
+    TEST_ASSERT_EQUAL_UINT32(1, summary.min);
+    TEST_ASSERT_EQUAL_UINT32(10000, summary.max);
+    TEST_ASSERT_EQUAL_UINT32(5000, summary.mean);
+
+    // Reported value is the bucket's upper bound: never below the true value, ≤ 12.5% above
+    TEST_ASSERT_TRUE(summary.p50 >= 5000 && summary.p50 <= 5625);
+    TEST_ASSERT_TRUE(summary.p90 >= 9000 && summary.p90 <= 10000);
+    TEST_ASSERT_TRUE(summary.p99 >= 9900 && summary.p99 <= 10000);
+    TEST_ASSERT_EQUAL_UINT32(10000, histogram.percentile(100.0f));
+}
+
+void test_tail_is_visible_next_to_fast_samples() {
+    // 98 fast sends and 2 stalls: p99 must show the stall, p50 the fast path
+    Histogram histogram;
+    for (int i = 0; i < 98; i++) {
+        histogram.record(12000);
+    }
+    histogram.record(450000);
+    histogram.record(480000);
+    HistogramSummary summary = histogram.summarize();
+    TEST_ASSERT_TRUE(summary.p50 >= 12000 && summary.p50 < 13500);
+    TEST_ASSERT_TRUE(summary.p99 >= 450000);
+    TEST_ASSERT_EQUAL_UINT32(480000, summary.max);
+}
+
+void test_reset_clears_window() {
+    Histogram histogram;
+    histogram.record(100);
+    histogram.reset();
+    HistogramSummary summary = histogram.summarize();
+    TEST_ASSERT_EQUAL_UINT32(0, summary.count);
+    TEST_ASSERT_EQUAL_UINT32(0, summary.max);
+    histogram.record(7);
+    TEST_ASSERT_EQUAL_UINT32(7, histogram.summarize().min);
+}
+
+void test_concurrent_recording_loses_no_samples() {
+    Histogram histogram;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&histogram, t]() {
+            for (uint32_t i = 0; i < 50000; i++) {
+                histogram.record((i % 1000) + (uint32_t)t * 1000);
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    HistogramSummary summary = histogram.summarize();
+    TEST_ASSERT_EQUAL_UINT32(200000, summary.count);
+    TEST_ASSERT_EQUAL_UINT32(200000, histogram.getCount());
+    TEST_ASSERT_EQUAL_UINT32(0, summary.min);
+    TEST_ASSERT_EQUAL_UINT32(3999, summary.max);
+}
+
+// ========================================
+// Telemetry
+// ========================================
+void test_snapshot_reports_histograms_and_counters() {
+    TelemetryConfig config;
+    Telemetry telemetry(config);
+    telemetry.resetWindow(1000000);
+
+    for (int i = 0; i < 50; i++) {
+        telemetry.record(Metric::CaptureUs, 3000);
+        telemetry.record(Metric::SendUs, 20000);
+        telemetry.record(Metric::FrameBytes, 14000);
+    }
+    telemetry.record(Metric::LoopUs, 250);
+    telemetry.sampleMemory(180000, 3000000);
+    telemetry.sampleMemory(150000, 3500000);
+    telemetry.sampleMemory(170000, 3200000);
+    telemetry.onConnect();
+    telemetry.onConnect();
+    telemetry.onConnect();
+    telemetry.onSendFailure();
+    telemetry.sampleAllocations(42);
+
+    char snapshot[Telemetry::kMaxSnapshot];
+    size_t length = telemetry.format(snapshot, sizeof(snapshot), 11000000);
+    TEST_ASSERT_EQUAL_size_t(strlen(snapshot), length);
+    TEST_ASSERT_EQUAL_INT(0, strncmp(snapshot, "STATS:{", 7));
+    TEST_ASSERT_EQUAL_INT('}', snapshot[length - 1]);
+
+    TEST_ASSERT_EQUAL_INT64(1, snapshotField(snapshot, "v", NULL));
+    TEST_ASSERT_EQUAL_INT64(11000, snapshotField(snapshot, "upMs", NULL));
+    TEST_ASSERT_EQUAL_INT64(10000, snapshotField(snapshot, "winMs", NULL));
+    TEST_ASSERT_EQUAL_INT64(50, snapshotField(snapshot, "capUs", "n"));
+    TEST_ASSERT_EQUAL_INT64(20000, snapshotField(snapshot, "sendUs", "max"));
+    TEST_ASSERT_EQUAL_INT64(14000, snapshotField(snapshot, "frameB", "avg"));
+    TEST_ASSERT_EQUAL_INT64(1, snapshotField(snapshot, "loopUs", "n"));
+    TEST_ASSERT_EQUAL_INT64(170000, snapshotField(snapshot, "heap", "free"));
+    TEST_ASSERT_EQUAL_INT64(150000, snapshotField(snapshot, "heap", "min"));
+    TEST_ASSERT_EQUAL_INT64(3000000, snapshotField(snapshot, "psram", "min"));
+    TEST_ASSERT_EQUAL_INT64(2, snapshotField(snapshot, "reconnects", NULL));
+    TEST_ASSERT_EQUAL_INT64(1, snapshotField(snapshot, "sendFail", "total"));
+    TEST_ASSERT_EQUAL_INT64(42, snapshotField(snapshot, "allocs", "total"));
+}
+
+void test_window_reset_keeps_totals() {
+    TelemetryConfig config;
+    config.publishIntervalMs = 5000;
+    Telemetry telemetry(config);
+    telemetry.resetWindow(0);
+
+    telemetry.record(Metric::SendUs, 9000);
+    telemetry.onSendFailure();
+    telemetry.sampleMemory(120000, 0);
+    telemetry.sampleAllocations(100);
+    TEST_ASSERT_FALSE(telemetry.publishDue(4999999));
+    TEST_ASSERT_TRUE(telemetry.publishDue(5000000));
+
+    telemetry.resetWindow(5000000);
+    TEST_ASSERT_FALSE(telemetry.publishDue(5000001));
+    telemetry.sampleMemory(160000, 0);
+    telemetry.sampleAllocations(103);
+
+    char snapshot[Telemetry::kMaxSnapshot];
+    telemetry.format(snapshot, sizeof(snapshot), 6000000);
+    TEST_ASSERT_EQUAL_INT64(0, snapshotField(snapshot, "sendUs", "n"));
+    TEST_ASSERT_EQUAL_INT64(0, snapshotField(snapshot, "sendFail", "win"));
+    TEST_ASSERT_EQUAL_INT64(1, snapshotField(snapshot, "sendFail", "total"));
+    TEST_ASSERT_EQUAL_INT64(120000, snapshotField(snapshot, "heap", "min"));
+    TEST_ASSERT_EQUAL_INT64(1000, snapshotField(snapshot, "winMs", NULL));
+    TEST_ASSERT_EQUAL_INT64(3, snapshotField(snapshot, "allocs", "win"));
+    TEST_ASSERT_EQUAL_INT64(103, snapshotField(snapshot, "allocs", "total"));
+}
+
+void test_boot_milestones_keep_first_report() {
+    TelemetryConfig config;
+    Telemetry telemetry(config);
+
+    char snapshot[Telemetry::kMaxSnapshot];
+    telemetry.format(snapshot, sizeof(snapshot), 0);
+    TEST_ASSERT_EQUAL_INT64(0, snapshotField(snapshot, "boot", "frameMs"));
+    TEST_ASSERT_NOT_NULL(strstr(snapshot, "\"cachedJoin\":false"));
+
+    telemetry.recordBoot(BootStage::Camera, 0);
+    telemetry.recordBoot(BootStage::WiFi, 640);
+    telemetry.recordBoot(BootStage::Socket, 720);
+    telemetry.recordBoot(BootStage::FirstFrame, 810);
+    telemetry.markCachedJoin();
+    // A reconnect later reaches the stages again; the boot times stay
+    telemetry.recordBoot(BootStage::WiFi, 60000);
+    telemetry.recordBoot(BootStage::FirstFrame, 61000);
+
+    telemetry.format(snapshot, sizeof(snapshot), 70000000);
+    TEST_ASSERT_EQUAL_INT64(1, snapshotField(snapshot, "boot", "camMs"));
+    TEST_ASSERT_EQUAL_INT64(640, snapshotField(snapshot, "boot", "wifiMs"));
+    TEST_ASSERT_EQUAL_INT64(720, snapshotField(snapshot, "boot", "wsMs"));
+    TEST_ASSERT_EQUAL_INT64(810, snapshotField(snapshot, "boot", "frameMs"));
+    TEST_ASSERT_NOT_NULL(strstr(snapshot, "\"cachedJoin\":true"));
+    TEST_ASSERT_EQUAL_UINT32(810, telemetry.getBootMs(BootStage::FirstFrame));
+}
+
+void test_worst_case_snapshot_fits() {
+    TelemetryConfig config;
+    config.publishIntervalMs = 0;
+    Telemetry telemetry(config);
+    for (size_t i = 0; i < (size_t)Metric::Count; i++) {
+        telemetry.record((Metric)i, 0);
+        telemetry.record((Metric)i, UINT32_MAX);
+    }
+    telemetry.sampleMemory(UINT32_MAX - 1, UINT32_MAX - 1);
+    telemetry.sampleAllocations(UINT32_MAX);
+    for (size_t i = 0; i < (size_t)BootStage::Count; i++) {
+        telemetry.recordBoot((BootStage)i, UINT32_MAX);
+    }
+    telemetry.markCachedJoin();
+    TEST_ASSERT_FALSE(telemetry.publishDue(UINT64_MAX / 2));
+
+    char snapshot[Telemetry::kMaxSnapshot];
+    size_t length = telemetry.format(snapshot, sizeof(snapshot), UINT64_MAX / 2);
+    TEST_ASSERT_GREATER_THAN(0, length);
+    TEST_ASSERT_LESS_THAN(Telemetry::kMaxSnapshot, length);
+
+    // Too small a buffer yields an empty string, never a truncated snapshot
+    char small[64];
+    TEST_ASSERT_EQUAL_size_t(0, telemetry.format(small, sizeof(small), 0));
+    TEST_ASSERT_EQUAL_INT('\0', small[0]);
+}
+
+void test_stats_command_matches_exactly() {
+    TEST_ASSERT_TRUE(Telemetry::isCommand("STATS", 5));
+    TEST_ASSERT_FALSE(Telemetry::isCommand("STATS:{}", 8));
+    TEST_ASSERT_FALSE(Telemetry::isCommand("STAT", 4));
+    TEST_ASSERT_FALSE(Telemetry::isCommand("LED_STATUS", 10));
+}
+
+int main(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+    UNITY_BEGIN();
+    RUN_TEST(test_bucket_bounds_cover_every_value);
+    RUN_TEST(test_percentiles_within_bucket_error);
+    RUN_TEST(test_tail_is_visible_next_to_fast_samples);
+    RUN_TEST(test_reset_clears_window);
+    RUN_TEST(test_concurrent_recording_loses_no_samples);
+    RUN_TEST(test_snapshot_reports_histograms_and_counters);
+    RUN_TEST(test_window_reset_keeps_totals);
+    RUN_TEST(test_boot_milestones_keep_first_report);
+    RUN_TEST(test_worst_case_snapshot_fits);
+    RUN_TEST(test_stats_command_matches_exactly);
+    return UNITY_END();
+}
@@ -0,0 +1,306 @@
+/**
+ * `test_main.cpp`
+ * - Unit tests and benchmark for WifiCache / WifiConnector (native host build)
+ * - The benchmark drives the connector against a modelled radio (scan, cached join, DHCP,
+ *   camera init) and compares boot-to-first-frame with the old sequential, scanning boot
+ * - Run: pio test -e native -f test_wifi_connector
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+
+#include <unity.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#include "WifiCache.h"
+#include "WifiConnector.h"
+
+void setUp(void) {}
+void tearDown(void) {}
+
+static WifiCache makeCache(const char* ssid) {
+    WifiCache cache;
+    cache.clear();
+    const uint8_t bssid[6] = {0x24, 0x0A, 0xC4, 0x12, 0x34, 0x56};
+    memcpy(cache.bssid, bssid, sizeof(bssid));
+    cache.channel = 6;
+    cache.ssidHash = WifiCache::hashSsid(ssid);
+    cache.localIp = 0x1704A8C0;        // 192.168.4.23
+    cache.gateway = 0x0104A8C0;
+    cache.subnet = 0x00FFFFFF;
+    cache.dns = 0x0104A8C0;
+    return cache;
+}
+
+static WifiConnectorConfig makeConfig() {
+    WifiConnectorConfig config;
+    config.cachedTimeoutMs = 1500;
+    config.scanTimeoutMs = 10000;
+    config.minBackoffMs = 1000;
+    config.maxBackoffMs = 8000;
+    config.maxCachedFailures = 2;
+    return config;
+}
+
+// ========================================
+// WifiCache
+// ========================================
+void test_cache_round_trip() {
+    WifiCache cache = makeCache("camera-net");
+    uint8_t blob[WifiCache::kEncodedSize];
+    TEST_ASSERT_EQUAL_size_t(WifiCache::kEncodedSize, cache.encode(blob, sizeof(blob)));
+
+    WifiCache loaded;
+    TEST_ASSERT_TRUE(loaded.decode(blob, sizeof(blob)));
+    TEST_ASSERT_EQUAL_INT(0, memcmp(cache.bssid, loaded.bssid, sizeof(cache.bssid)));
+    TEST_ASSERT_EQUAL_UINT8(6, loaded.channel);
+    TEST_ASSERT_EQUAL_UINT32(cache.localIp, loaded.localIp);
+    TEST_ASSERT_EQUAL_UINT32(cache.dns, loaded.dns);
+    TEST_ASSERT_TRUE(loaded.isValidFor("camera-net"));
+    TEST_ASSERT_TRUE(loaded.hasLease());
+
+    TEST_ASSERT_EQUAL_size_t(0, cache.encode(blob, sizeof(blob) - 1));
+}
+
+void test_cache_rejects_corrupt_or_foreign_records() {
+    WifiCache cache = makeCache("camera-net");
+    uint8_t blob[WifiCache::kEncodedSize];
+    cache.encode(blob, sizeof(blob));
+
+    WifiCache loaded;
+    // Brownout during the NVS write: any flipped byte fails the CRC
+    for (size_t i = 0; i < sizeof(blob); i++) {
+        uint8_t torn[WifiCache::kEncodedSize];
+        memcpy(torn, blob, sizeof(blob));
+        torn[i] ^= 0x10;
+        TEST_ASSERT_FALSE(loaded.decode(torn, sizeof(torn)));
+        TEST_ASSERT_EQUAL_UINT8(0, loaded.channel);
+    }
+    TEST_ASSERT_FALSE(loaded.decode(blob, sizeof(blob) - 1));
+    TEST_ASSERT_FALSE(loaded.decode(NULL, 0));
+
+    // Learned on another network (WIFI_SSID changed in Config.h)
+    TEST_ASSERT_TRUE(loaded.decode(blob, sizeof(blob)));
+    TEST_ASSERT_FALSE(loaded.isValidFor("other-net"));
+
+    loaded.clear();
+    TEST_ASSERT_FALSE(loaded.isValidFor("camera-net"));
+    TEST_ASSERT_FALSE(loaded.hasLease());
+}
+
+// ========================================
+// WifiConnector
+// ========================================
+void test_cached_join_skips_scan() {
+    WifiConnector connector(makeConfig());
+    TEST_ASSERT_TRUE(WifiEvent::None == connector.update(false, 0));
+    TEST_ASSERT_TRUE(WifiEvent::BeginCached == connector.begin(true, 100));
+    TEST_ASSERT_TRUE(WifiEvent::None == connector.update(false, 400));
+    TEST_ASSERT_TRUE(WifiEvent::Connected == connector.update(true, 420));
+    TEST_ASSERT_TRUE(WifiEvent::None == connector.update(true, 500));
+    TEST_ASSERT_TRUE(connector.isConnected());
+    TEST_ASSERT_EQUAL_UINT32(1, connector.getStats().cachedConnects);
+    TEST_ASSERT_EQUAL_UINT32(320, connector.getStats().lastJoinMs);
+    TEST_ASSERT_TRUE(connector.getStats().lastJoinCached);
+}
+
+void test_cached_timeout_falls_back_to_scan() {
+    WifiConnector connector(makeConfig());
+    connector.begin(true, 0);
+    TEST_ASSERT_TRUE(WifiEvent::None == connector.update(false, 1499));
+    TEST_ASSERT_TRUE(WifiEvent::BeginScan == connector.update(false, 1500));
+    TEST_ASSERT_TRUE(WifiPhase::Scan == connector.getPhase());
+    TEST_ASSERT_TRUE(connector.isCacheUsable());      // one miss is not enough to drop it
+    TEST_ASSERT_TRUE(WifiEvent::Connected == connector.update(true, 4000));
+    TEST_ASSERT_EQUAL_UINT32(1, connector.getStats().scanConnects);
+    TEST_ASSERT_EQUAL_UINT32(1, connector.getStats().cachedTimeouts);
+    TEST_ASSERT_EQUAL_UINT32(2500, connector.getStats().lastJoinMs);
+    TEST_ASSERT_FALSE(connector.getStats().lastJoinCached);
+}
+
+void test_failed_scans_back_off_and_never_give_up() {
+    WifiConnector connector(makeConfig());
+    TEST_ASSERT_TRUE(WifiEvent::BeginScan == connector.begin(false, 0));
+
+    uint32_t now = 0;
+    const uint32_t expectedBackoff[] = {1000, 2000, 4000, 8000, 8000, 8000};
+    for (uint32_t backoff : expectedBackoff) {
+        now += 10000;
+        TEST_ASSERT_TRUE(WifiEvent::Backoff == connector.update(false, now));
+        TEST_ASSERT_EQUAL_UINT32(backoff, connector.getBackoffMs());
+        TEST_ASSERT_TRUE(WifiEvent::None == connector.update(false, now + backoff - 1));
+        now += backoff;
+        TEST_ASSERT_TRUE(WifiEvent::BeginScan == connector.update(false, now));
+    }
+    TEST_ASSERT_EQUAL_UINT32(7, connector.getStats().attempts);
+    TEST_ASSERT_EQUAL_UINT32(6, connector.getStats().scanTimeouts);
+
+    // The AP comes back: connected, and the next failure starts from the short backoff
+    TEST_ASSERT_TRUE(WifiEvent::Connected == connector.update(true, now + 3000));
+    TEST_ASSERT_EQUAL_UINT32(0, connector.getBackoffMs());
+}
+
+void test_repeated_cached_misses_drop_the_cache() {
+    WifiConnectorConfig config = makeConfig();
+    config.scanTimeoutMs = 2000;
+    WifiConnector connector(config);
+    connector.begin(true, 0);
+
+    TEST_ASSERT_TRUE(WifiEvent::BeginScan == connector.update(false, 1500));
+    TEST_ASSERT_TRUE(WifiEvent::Backoff == connector.update(false, 3500));
+    TEST_ASSERT_TRUE(WifiEvent::BeginCached == connector.update(false, 4500));
+    TEST_ASSERT_TRUE(WifiEvent::BeginScan == connector.update(false, 6000));
+    TEST_ASSERT_FALSE(connector.isCacheUsable());
+    TEST_ASSERT_TRUE(WifiEvent::Backoff == connector.update(false, 8000));
+    TEST_ASSERT_TRUE(WifiEvent::BeginScan == connector.update(false, 10000));
+
+    TEST_ASSERT_TRUE(WifiEvent::Connected == connector.update(true, 11000));
+    connector.onCacheStored();
+    TEST_ASSERT_TRUE(connector.isCacheUsable());
+}
+
+void test_lost_link_rejoins_cached_ap() {
+    WifiConnector connector(makeConfig());
+    connector.begin(false, 0);
+    connector.update(true, 2500);
+    connector.onCacheStored();
+
+    TEST_ASSERT_TRUE(WifiEvent::Lost == connector.update(false, 60000));
+    TEST_ASSERT_TRUE(WifiEvent::BeginCached == connector.update(false, 60005));
+    TEST_ASSERT_TRUE(WifiEvent::Connected == connector.update(true, 60300));
+    TEST_ASSERT_EQUAL_UINT32(1, connector.getStats().lost);
+    TEST_ASSERT_EQUAL_UINT32(1, connector.getStats().cachedConnects);
+}
+
+void test_late_association_during_backoff_counts() {
+    WifiConnector connector(makeConfig());
+    connector.begin(false, 0);
+    TEST_ASSERT_TRUE(WifiEvent::Backoff == connector.update(false, 10000));
+    TEST_ASSERT_TRUE(WifiEvent::Connected == connector.update(true, 10200));
+    TEST_ASSERT_TRUE(connector.isConnected());
+}
+
+void test_timers_survive_millis_wrap() {
+    WifiConnector connector(makeConfig());
+    uint32_t start = UINT32_MAX - 500;
+    connector.begin(true, start);
+    TEST_ASSERT_TRUE(WifiEvent::None == connector.update(false, start + 1000));
+    TEST_ASSERT_TRUE(WifiEvent::BeginScan == connector.update(false, start + 1500));
+    TEST_ASSERT_TRUE(WifiEvent::Backoff == connector.update(false, start + 11500));
+    TEST_ASSERT_TRUE(WifiEvent::None == connector.update(false, start + 12000));
+    TEST_ASSERT_TRUE(WifiEvent::BeginCached == connector.update(false, start + 12500));
+}
+
+// ========================================
+// Benchmark
+// ========================================
+/**
+ * Radio model: an attempt associates after its join time, then waits for DHCP unless the
+ * cached lease is reused. A cached join only works while the AP keeps its BSSID/channel.
+ */
+struct RadioModel {
+    uint32_t scanJoinMs;
+    uint32_t cachedJoinMs;
+    uint32_t dhcpMs;
+    uint32_t apUpAtMs;         // AP unreachable before this time
+    bool apMoved;              // cached BSSID/channel no longer valid
+};
+
+struct BootResult {
+    uint32_t firstFrameMs;
+    uint32_t attempts;
+};
+
+/**
+ * Camera and WiFi in parallel, connector polled every 10 ms (pipeline loop() cadence)
+ */
+static BootResult simulateParallelBoot(const RadioModel& radio, bool cached, bool reuseLease,
+                                       uint32_t cameraInitMs, uint32_t socketMs) {
+    WifiConnector connector(makeConfig());
+    WifiEvent event = connector.begin(cached, 0);
+    uint32_t associatedAtMs = UINT32_MAX;
+    BootResult result = {0, 0};
+    for (uint32_t now = 0; now < 120000; now += 10) {
+        if (event == WifiEvent::BeginCached || event == WifiEvent::BeginScan) {
+            bool usable = event == WifiEvent::BeginScan || !radio.apMoved;
+            uint32_t joinMs = event == WifiEvent::BeginCached ? radio.cachedJoinMs : radio.scanJoinMs;
+            uint32_t dhcpMs = event == WifiEvent::BeginCached && reuseLease ? 0 : radio.dhcpMs;
+            uint32_t start = now > radio.apUpAtMs ? now : radio.apUpAtMs;
+            associatedAtMs = usable ? start + joinMs + dhcpMs : UINT32_MAX;
+        } else if (event == WifiEvent::Backoff) {
+            associatedAtMs = UINT32_MAX;
+        }
+        event = connector.update(now >= associatedAtMs, now);
+        if (connector.isConnected()) {
+            uint32_t ready = now > cameraInitMs ? now : cameraInitMs;
+            result.firstFrameMs = ready + socketMs;
+            result.attempts = connector.getStats().attempts;
+            return result;
+        }
+    }
+    return result;
+}
+
+void test_benchmark(void) {
+    // Typical ESP32-CAM figures: OV2640 probe + init ~700 ms, active scan of 13 channels
+    // ~2.4 s, join to a known BSSID/channel ~300 ms, DHCP ~600 ms, WebSocket + first send ~200 ms
+    const uint32_t cameraInitMs = 700;
+    const uint32_t socketMs = 200;
+    const RadioModel normal = {2400, 300, 600, 0, false};
+    const RadioModel moved = {2400, 300, 600, 0, true};
+    const RadioModel apLate = {2400, 300, 600, 6000, false};
+
+    // Old boot: camera, then WiFi.begin() polled every 500 ms, then the WebSocket
+    uint32_t sequentialMs = cameraInitMs + (normal.scanJoinMs + normal.dhcpMs + 499) / 500 * 500 + socketMs;
+
+    struct Case {
+        const char* name;
+        const RadioModel* radio;
+        bool cached;
+        bool reuseLease;
+    };
+    static const Case cases[] = {
+        {"scan (no cache)", &normal, false, false},
+        {"cached BSSID", &normal, true, false},
+        {"cached + lease", &normal, true, true},
+        {"AP moved", &moved, true, false},
+        {"AP up at 6 s", &apLate, true, false},
+    };
+
+    printf("\n  %-22s %10s %9s\n", "boot", "firstFrame", "attempts");
+    printf("  %-22s %8u ms %9s\n", "sequential (old)", (unsigned)sequentialMs, "1");
+    uint32_t results[sizeof(cases) / sizeof(cases[0])];
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        BootResult result = simulateParallelBoot(*cases[i].radio, cases[i].cached, cases[i].reuseLease,
+                                                 cameraInitMs, socketMs);
+        results[i] = result.firstFrameMs;
+        printf("  %-22s %8u ms %9u\n", cases[i].name, (unsigned)result.firstFrameMs, (unsigned)result.attempts);
+        TEST_ASSERT_GREATER_THAN(0, result.firstFrameMs);
+    }
+
+    TEST_ASSERT_LESS_THAN(sequentialMs, results[0]);       // parallel camera init alone
+    TEST_ASSERT_LESS_THAN(results[0] / 2, results[1]);     // no scan
+    TEST_ASSERT_LESS_THAN(results[1], results[2]);         // no DHCP
+    TEST_ASSERT_LESS_THAN(results[0] + 1600, results[3]);  // one short cached miss, then a scan
+}
+
+int main(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+    UNITY_BEGIN();
+    RUN_TEST(test_cache_round_trip);
+    RUN_TEST(test_cache_rejects_corrupt_or_foreign_records);
+    RUN_TEST(test_cached_join_skips_scan);
+    RUN_TEST(test_cached_timeout_falls_back_to_scan);
+    RUN_TEST(test_failed_scans_back_off_and_never_give_up);
+    RUN_TEST(test_repeated_cached_misses_drop_the_cache);
+    RUN_TEST(test_lost_link_rejoins_cached_ap);
+    RUN_TEST(test_late_association_during_backoff_counts);
+    RUN_TEST(test_timers_survive_millis_wrap);
+    RUN_TEST(test_benchmark);
+    return UNITY_END();
+}
@@ -0,0 +1,140 @@
+"""
+`mjpeg_viewers.py`
+- Local MJPEG viewers for the device's HTTP stream (lib/MjpegServer), like several curl/browser tabs
+- Each viewer parses the multipart stream, checks every JPEG (SOI/EOI, Content-Length) and counts
+  frames the server skipped for it (X-Frame-Sequence gaps)
+- `--slow N --slow-kbps K` throttles N of the viewers to show that they drop frames on their own
+  while the others keep the full rate
+- Python standard library only
+
+Usage:
+    python3 tools/mjpeg_viewers.py --url http://127.0.0.1:8081/stream --viewers 3 --duration 20
+    python3 tools/mjpeg_viewers.py --viewers 3 --slow 1 --slow-kbps 200 --min-fps 8
+
+@author      Sim Woo-Keun <smileteeth14@gmail.com>
+@date        2026-10-16 initial version
+
+@copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+"""
+
+import argparse
+import socket
+import sys
+import threading
+import time
+from typing import List, Optional
+from urllib.parse import urlparse
+
+
+class Viewer(threading.Thread):
+    """
+    One HTTP client reading the multipart stream until the deadline
+    """
+
+    def __init__(self, index: int, url: str, deadline: float, rate_kbps: float):
+        super().__init__(daemon=True)
+        self.index = index
+        self.url = urlparse(url)
+        self.deadline = deadline
+        self.rate_kbps = rate_kbps
+        self.frames = 0
+        self.skipped = 0
+        self.malformed = 0
+        self.bytes = 0
+        self.status = ''
+        self.started = 0.0
+        self.error: Optional[str] = None
+        self._buffer = b''
+        self._sock: Optional[socket.socket] = None
+
+    def _fill(self) -> None:
+        data = self._sock.recv(16384)
+        if not data:
+            raise ConnectionError('stream closed')
+        self._buffer += data
+        if self.rate_kbps > 0:
+            time.sleep(len(data) * 8 / (self.rate_kbps * 1000))
+
+    def _read_until(self, marker: bytes) -> bytes:
+        while marker not in self._buffer:
+            self._fill()
+        head, self._buffer = self._buffer.split(marker, 1)
+        return head
+
+    def _read_exact(self, length: int) -> bytes:
+        while len(self._buffer) < length:
+            self._fill()
+        body, self._buffer = self._buffer[:length], self._buffer[length:]
+        return body
+
+    def run(self) -> None:
+        try:
+            self._sock = socket.create_connection((self.url.hostname, self.url.port or 80), timeout=5)
+            if self.rate_kbps > 0:
+                self._sock.setsockopt(socket.SOL_SOCKET, socket.SO_RCVBUF, 4096)
+            path = self.url.path or '/'
+            self._sock.sendall(f'GET {path} HTTP/1.1\r\nHost: {self.url.hostname}\r\n\r\n'.encode())
+            self.status = self._read_until(b'\r\n\r\n').split(b'\r\n', 1)[0].decode(errors='replace')
+            if ' 200 ' not in self.status:
+                return
+            self.started = time.time()
+            last_sequence = 0
+            while time.time() < self.deadline:
+                headers = {}
+                for line in self._read_until(b'\r\n\r\n').split(b'\r\n'):
+                    key, _, value = line.decode(errors='replace').partition(':')
+                    headers[key.strip().lower()] = value.strip()
+                body = self._read_exact(int(headers.get('content-length', '0')))
+                sequence = int(headers.get('x-frame-sequence', '0'))
+                if len(body) < 4 or body[:2] != b'\xff\xd8' or body[-2:] != b'\xff\xd9':
+                    self.malformed += 1
+                if last_sequence and sequence > last_sequence + 1:
+                    self.skipped += sequence - last_sequence - 1
+                last_sequence = sequence
+                self.frames += 1
+                self.bytes += len(body)
+        except (OSError, ValueError) as error:
+            self.error = str(error)
+        finally:
+            if self._sock is not None:
+                self._sock.close()
+
+    def fps(self) -> float:
+        elapsed = time.time() - self.started if self.started else 0
+        return self.frames / elapsed if elapsed > 0 else 0.0
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description='Local MJPEG viewers for the device HTTP stream')
+    parser.add_argument('--url', default='http://127.0.0.1:8081/stream')
+    parser.add_argument('--viewers', type=int, default=2)
+    parser.add_argument('--slow', type=int, default=0, help='number of throttled viewers')
+    parser.add_argument('--slow-kbps', type=float, default=200)
+    parser.add_argument('--duration', type=float, default=10)
+    parser.add_argument('--min-fps', type=float, default=0, help='exit 1 if a full-rate viewer is slower')
+    args = parser.parse_args()
+
+    deadline = time.time() + args.duration
+    viewers: List[Viewer] = []
+    for index in range(args.viewers):
+        rate = args.slow_kbps if index < args.slow else 0
+        viewers.append(Viewer(index, args.url, deadline, rate))
+    for viewer in viewers:
+        viewer.start()
+    for viewer in viewers:
+        viewer.join(args.duration + 10)
+
+    failed = False
+    for viewer in viewers:
+        kind = f'slow {viewer.rate_kbps:.0f} kbps' if viewer.rate_kbps > 0 else 'full rate'
+        print(f'[Viewer {viewer.index}] {kind}: {viewer.status or "no response"}, frames={viewer.frames} '
+              f'fps={viewer.fps():.2f} skipped={viewer.skipped} malformed={viewer.malformed} '
+              f'kbps={viewer.bytes * 8 / 1000 / max(args.duration, 0.001):.0f}'
+              + (f' error={viewer.error}' if viewer.error else ''))
+        if viewer.malformed > 0 or (viewer.rate_kbps == 0 and viewer.fps() < args.min_fps):
+            failed = True
+    return 1 if failed else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
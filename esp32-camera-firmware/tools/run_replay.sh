@@ -0,0 +1,28 @@
+#!/usr/bin/env bash
+# Build the host replay harness and run it against the local stand-in server.
+# Extra arguments go to the harness, e.g.:
+#   tools/run_replay.sh --clip clips/hallway --bandwidth 800 --delay 40 --jitter 20 --loss 1
+# REPLAY_VIEWERS=N also watches the local MJPEG stream with N viewers (tools/mjpeg_viewers.py,
+# REPLAY_SLOW_VIEWERS of them throttled) while the WebSocket upload runs.
+# REPLAY_SERVER_ARGS go to the stand-in server, e.g. scripted commands compared phase by phase:
+#   REPLAY_SERVER_ARGS="--send-at 10:ROI:300:150:300:700 --send-at 20:ROI_OFF" tools/run_replay.sh --duration 30
+set -euo pipefail
+
+cd "$(dirname "$0")/.."
+PORT="${REPLAY_PORT:-18887}"
+VIEWERS="${REPLAY_VIEWERS:-0}"
+
+pio run -e replay
+
+# shellcheck disable=SC2086
+python3 tools/standin_server.py --port "$PORT" --quiet ${REPLAY_SERVER_ARGS:-} &
+SERVER_PID=$!
+trap 'kill -INT "$SERVER_PID" 2>/dev/null || true; wait "$SERVER_PID" 2>/dev/null || true' EXIT
+sleep 1
+
+if [ "$VIEWERS" -gt 0 ]; then
+    (sleep 2; python3 tools/mjpeg_viewers.py --viewers "$VIEWERS" --slow "${REPLAY_SLOW_VIEWERS:-0}" \
+        --duration "${REPLAY_VIEWER_SECONDS:-10}") &
+fi
+
+.pio/build/replay/program --sink "127.0.0.1:$PORT" "$@"
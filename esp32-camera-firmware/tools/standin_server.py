@@ -0,0 +1,962 @@
+"""
+`standin_server.py`
+- Local stand-in for the relay server's ESP32 endpoint (ws://<host>:<port>/esp32)
+- Answers clock-sync pings, decodes frame envelopes and reports per-hop latency
+  percentiles, FPS, throughput, sequence gaps and reordering
+- Keeps the latest device telemetry snapshot (`STATS:{json}`) and adds it to the report
+- Reassembles chunked frames (lib/FrameChunker) and probes command round-trip latency
+  (LED_STATUS → LED_STATUS:<state>) while frames are streaming
+- `--send-at S:TEXT` sends scripted commands S seconds after the device connects; the report
+  then has one phase per command (FPS, bytes/frame, frame size), e.g. ROI vs full view
+- `--demand L:A` announces a consumer set on connect like the relay (`DEMAND:<live>:<analyzer>`);
+  combined with `--send-at S:DEMAND:L:A` it replays viewers arriving and leaving
+- `--consumer-kbps K` hands live frames to a viewer that drains them at K kbps (queue without
+  limit, like the relay's web sockets); `--credits N` grants N frame credits on connect and
+  returns `CREDIT:1` per drained frame (see FLOW_CONTROL_PROTOCOL.md)
+- `--compact` asks for compact frames on connect (`JPEG_SYNC`), rebuilds every header-elided
+  frame like the relay (lib/JpegHeaderElision) and reports the bytes the elision saved
+- Reassembles snapshot uploads ('SNP' parts, lib/SnapshotCapture) next to the live stream and
+  reports size, upload time and the live gap from `SNAPSHOT_STATUS` (`--send-at S:SNAPSHOT`)
+- Decodes the gray plane side-stream ('LUM' messages, lib/LumaStream) like the analyzer and
+  reports planes, key planes, bytes per plane and the changed pixels between planes
+  (`--send-at S:LUMA:<ms>` changes the rate)
+- Python standard library only (no websockets package needed)
+
+Usage:
+    python3 tools/standin_server.py --port 8887
+    python3 tools/standin_server.py --port 8887 --duration 60 --json result.json
+    python3 tools/standin_server.py --duration 30 --send-at 10:ROI:300:150:300:700 --send-at 20:ROI_OFF
+    python3 tools/standin_server.py --duration 40 --demand 0:1 --send-at 10:DEMAND:0:0 --send-at 25:DEMAND:1:0
+    python3 tools/standin_server.py --duration 60 --consumer-kbps 600 --credits 2
+    python3 tools/standin_server.py --duration 30 --compact
+    python3 tools/standin_server.py --duration 40 --send-at 10:SNAPSHOT --send-at 25:SNAPSHOT:SXGA:12
+    python3 tools/standin_server.py --duration 30 --demand 0:1 --send-at 15:LUMA:100
+
+@author      Sim Woo-Keun <smileteeth14@gmail.com>
+@date        2026-10-16 initial version
+
+@copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+"""
+
+import argparse
+import base64
+import hashlib
+import json
+import re
+import socket
+import socketserver
+import struct
+import sys
+import threading
+import time
+from typing import Dict, List, Optional, Tuple
+
+# ========================================
+# Frame Envelope (see lib/FrameEnvelope/FrameEnvelope.h)
+# ========================================
+ENVELOPE_MAGIC = b'CAM'
+ENVELOPE_V1 = struct.Struct('>3sBBBBBIQQqIHHHH')  # 48 bytes
+FLAG_CLOCK_SYNCED = 0x01
+FLAG_MOTION = 0x02
+FLAG_HISTORICAL = 0x04
+FLAG_CHUNKED = 0x10
+FLAG_HEADER_DEFINED = 0x20
+FLAG_HEADER_ELIDED = 0x40
+FLAG_SNAPSHOT = 0x80
+PART_MAGIC = b'CAP'
+PART_HEADER = struct.Struct('>3sBII')  # 12 bytes
+SNAPSHOT_MAGIC = b'SNP'
+SNAPSHOT_HEADER = struct.Struct('>3sBIII')  # 16 bytes: magic, version, id, offset, total
+
+# ========================================
+# Gray Plane Side-Stream (see lib/LumaStream/LumaStream.h)
+# ========================================
+LUMA_MAGIC = b'LUM'
+LUMA_HEADER = struct.Struct('>3sBBBBBIQqHHI')  # 36 bytes
+LUMA_FLAG_KEY = 0x01
+LUMA_FLAG_CLOCK_SYNCED = 0x02
+LUMA_CHANGE_THRESHOLD = 10  # |pixel difference| counted as changed (like MOTION_BLOCK_THRESHOLD)
+
+
+def decode_envelope(data: bytes, partial: bool = False) -> Optional[Tuple[dict, bytes]]:
+    """
+    Split an enveloped frame into (header, jpeg)
+
+    Args:
+        partial: accept a payload shorter than payload_length (first part of a chunked frame)
+
+    Returns:
+        None for raw JPEG or malformed envelopes
+    """
+    if len(data) < ENVELOPE_V1.size or data[:3] != ENVELOPE_MAGIC:
+        return None
+    (_, version, header_length, flags, quality, frame_size, sequence, capture_us, send_us,
+     offset_us, payload_length, width, height, motion_score, header_id) = ENVELOPE_V1.unpack_from(data)
+    if version < 1 or header_length < ENVELOPE_V1.size or header_length > len(data):
+        return None
+    if not partial and header_length + payload_length > len(data):
+        return None
+    header = {
+        'version': version,
+        'flags': flags,
+        'quality': quality,
+        'frame_size': frame_size,
+        'sequence': sequence,
+        'capture_us': capture_us,
+        'send_us': send_us,
+        'clock_offset_us': offset_us,
+        'payload_length': payload_length,
+        'width': width,
+        'height': height,
+        'motion_score': motion_score,
+        'header_id': header_id,
+    }
+    return header, data[header_length:header_length + payload_length]
+
+
+class FrameAssembler:
+    """Rebuilds chunked frames: [envelope + first chunk] then 'CAP' parts (see FrameChunker.h)"""
+
+    def __init__(self):
+        self.pending: Optional[bytearray] = None
+        self.sequence = 0
+        self.expected = 0
+        self.parts = 0
+        self.dropped = 0
+
+    def accept(self, data: bytes) -> Optional[bytes]:
+        """
+        Returns:
+            the message to record (whole frame or unchunked message), None while a frame is incomplete
+        """
+        decoded = decode_envelope(data, partial=True)
+        if decoded is not None:
+            header, _ = decoded
+            if not header['flags'] & FLAG_CHUNKED:
+                return data
+            header_length = data[4]
+            frame = bytearray(data)
+            frame[5] &= ~FLAG_CHUNKED & 0xFF
+            self.pending, self.sequence = frame, header['sequence']
+            self.expected = header_length + header['payload_length']
+        elif len(data) >= PART_HEADER.size and data[:3] == PART_MAGIC:
+            _, _, sequence, offset = PART_HEADER.unpack_from(data)
+            if (self.pending is None or sequence != self.sequence
+                    or self.pending[4] + offset != len(self.pending)):
+                self.pending = None
+                self.dropped += 1
+                return None
+            self.pending.extend(data[PART_HEADER.size:])
+            self.parts += 1
+        else:
+            return data
+        if len(self.pending) < self.expected:
+            return None
+        frame, self.pending = bytes(self.pending), None
+        return frame
+
+
+class SnapshotAssembler:
+    """Rebuilds snapshot uploads: 'SNP' parts in order, interleaved with live frames (see SnapshotCapture.h)"""
+
+    def __init__(self):
+        self.pending: Optional[bytearray] = None
+        self.snapshot_id = 0
+        self.total = 0
+        self.started_us = 0
+        self.parts = 0
+        self.dropped = 0
+
+    def accept(self, data: bytes, receive_us: int) -> Optional[Tuple[bytes, int, int]]:
+        """
+        Returns:
+            (envelope + JPEG, parts, upload time in µs) once the last part arrived, else None
+        """
+        _, _, snapshot_id, offset, total = SNAPSHOT_HEADER.unpack_from(data)
+        if offset == 0:
+            # First part (also an upload started over after a reconnect)
+            self.pending, self.snapshot_id, self.total = bytearray(), snapshot_id, total
+            self.started_us, self.parts = receive_us, 0
+        elif self.pending is None or snapshot_id != self.snapshot_id or offset != len(self.pending):
+            self.pending = None
+            self.dropped += 1
+            return None
+        self.pending.extend(data[SNAPSHOT_HEADER.size:])
+        self.parts += 1
+        if len(self.pending) < self.total:
+            return None
+        snapshot, self.pending = bytes(self.pending), None
+        return snapshot, self.parts, receive_us - self.started_us
+
+
+def decode_luma_header(data: bytes) -> Optional[dict]:
+    if len(data) < LUMA_HEADER.size or data[:3] != LUMA_MAGIC:
+        return None
+    (_, version, header_length, flags, deadband, frame_size, sequence, capture_us, clock_offset_us,
+     width, height, payload_length) = LUMA_HEADER.unpack_from(data)
+    if version < 1 or header_length < LUMA_HEADER.size or header_length + payload_length > len(data):
+        return None
+    return {'flags': flags, 'deadband': deadband, 'frame_size': frame_size, 'sequence': sequence,
+            'capture_us': capture_us, 'clock_offset_us': clock_offset_us, 'width': width, 'height': height,
+            'payload': data[header_length:header_length + payload_length]}
+
+
+def apply_luma_delta(payload: bytes, plane: bytearray) -> bool:
+    """Token c < 0x80: c + 1 unchanged pixels; c >= 0x80: c - 0x7F deltas (mod 256) follow"""
+    offset, index, pixels = 0, 0, len(plane)
+    while offset < len(payload):
+        token = payload[offset]
+        offset += 1
+        if token < 0x80:
+            index += token + 1
+            if index > pixels:
+                return False
+            continue
+        count = token - 0x7F
+        if index + count > pixels or offset + count > len(payload):
+            return False
+        for k in range(count):
+            plane[index + k] = (plane[index + k] + payload[offset + k]) & 0xFF
+        index += count
+        offset += count
+    return index == pixels
+
+
+class LumaFollower:
+    """Follows the 'LUM' planes like the analyzer: key planes restart, a gap waits for the next key plane"""
+
+    def __init__(self):
+        self.plane: Optional[bytearray] = None
+        self.next_sequence = 0
+        self.planes = 0
+        self.key_planes = 0
+        self.waited = 0
+        self.errors = 0
+        self.bytes = 0
+        self.changed_permille: List[int] = []
+        self.size = ''
+
+    def accept(self, data: bytes) -> Optional[dict]:
+        self.bytes += len(data)
+        header = decode_luma_header(data)
+        if header is None:
+            self.errors += 1
+            return None
+        pixels = header['width'] * header['height']
+        previous = bytes(self.plane) if self.plane is not None and len(self.plane) == pixels else None
+        if header['flags'] & LUMA_FLAG_KEY:
+            self.plane = bytearray(pixels)
+            self.key_planes += 1
+        elif self.plane is None or header['sequence'] != self.next_sequence or len(self.plane) != pixels:
+            self.plane = None
+            self.waited += 1
+            return None
+        self.next_sequence = header['sequence'] + 1
+        if not apply_luma_delta(header['payload'], self.plane):
+            self.plane = None
+            self.errors += 1
+            return None
+        self.planes += 1
+        self.size = f"{header['width']}x{header['height']}"
+        if previous is not None:
+            changed = sum(1 for a, b in zip(previous, self.plane) if abs(a - b) > LUMA_CHANGE_THRESHOLD)
+            self.changed_permille.append(changed * 1000 // pixels)
+        return header
+
+
+def jpeg_preamble(jpeg: bytes) -> int:
+    """Length of the JPEG preamble up to and including the SOS header (0 if there is none)"""
+    if jpeg[:2] != b'\xff\xd8':
+        return 0
+    pos = 2
+    while pos + 4 <= len(jpeg):
+        if jpeg[pos] != 0xFF:
+            return 0
+        marker = jpeg[pos + 1]
+        if marker == 0xFF:
+            pos += 1
+            continue
+        pos += 2 + struct.unpack_from('>H', jpeg, pos + 2)[0]
+        if marker == 0xDA:
+            return pos if pos <= len(jpeg) else 0
+    return 0
+
+
+class HeaderRebuilder:
+    """Compact frames (see lib/JpegHeaderElision): learns defined preambles, rebuilds elided frames"""
+
+    def __init__(self):
+        self.header_id = 0
+        self.preamble = b''
+        self.defined = 0
+        self.elided = 0
+        self.unknown = 0
+        self.saved = 0
+        self.sync_requested = False  # JPEG_SYNC sent, waiting for the next defined header
+
+    def accept(self, header: dict, payload: bytes) -> Optional[bytes]:
+        """
+        Returns:
+            the whole JPEG, None if an elided frame refers to a header this side does not have
+        """
+        if header['flags'] & FLAG_HEADER_DEFINED:
+            preamble = jpeg_preamble(payload)
+            if preamble:
+                self.header_id, self.preamble = header['header_id'], payload[:preamble]
+                self.defined += 1
+                self.sync_requested = False
+            return payload
+        if not header['flags'] & FLAG_HEADER_ELIDED:
+            return payload
+        if header['header_id'] == 0 or header['header_id'] != self.header_id:
+            self.unknown += 1
+            return None
+        self.elided += 1
+        self.saved += len(self.preamble)
+        return self.preamble + payload
+
+
+def now_us() -> int:
+    """Server clock (epoch microseconds, same as the relay server)"""
+    return time.time_ns() // 1000
+
+
+def make_pong(ping: str, receive_us: int, send_us: int) -> Optional[str]:
+    """'PING:<seq>:<t0>' -> 'PONG:<seq>:<t0>:<t1>:<t2>'"""
+    parts = ping.split(':')
+    if len(parts) < 3 or parts[0] != 'PING' or not parts[1].isdigit() or not parts[2].isdigit():
+        return None
+    return f'PONG:{parts[1]}:{parts[2]}:{receive_us}:{send_us}'
+
+
+# ========================================
+# Statistics
+# ========================================
+def percentile(values: List[float], p: float) -> float:
+    if not values:
+        return 0.0
+    ordered = sorted(values)
+    index = min(len(ordered) - 1, max(0, int(round(p / 100.0 * (len(ordered) - 1)))))
+    return ordered[index]
+
+
+class StreamStats:
+    """Per-hop latency and sequence tracking for one device"""
+
+    HOPS = ('capture_to_send', 'send_to_server', 'capture_to_server', 'capture_to_consumer', 'command_rtt',
+            'luma_capture_to_server')
+
+    def __init__(self):
+        self.lock = threading.Lock()
+        self.frames = 0
+        self.raw_frames = 0
+        self.bytes = 0
+        self.gaps = 0
+        self.lost = 0
+        self.reordered = 0
+        self.motion_frames = 0
+        self.backfilled = 0
+        self.unsynced = 0
+        self.last_sequence: Optional[int] = None
+        self.latency_ms: Dict[str, List[float]] = {hop: [] for hop in self.HOPS}
+        self.started = time.monotonic()
+        self.pings = 0
+        self.chunk_parts = 0
+        self.chunk_dropped = 0
+        self.device: Optional[dict] = None
+        self.device_snapshots = 0
+        self.phases: List[dict] = []  # only with scripted commands (see CommandScript)
+        self.compact: Optional[dict] = None  # only with --compact
+        self.snapshots: List[dict] = []
+        self.snapshot_dropped = 0
+        self.luma: Optional[dict] = None
+
+    def start_phase(self, label: str) -> None:
+        """Close the current phase and open one named after the command that starts it"""
+        with self.lock:
+            now = time.monotonic()
+            if self.phases:
+                self.phases[-1]['elapsed_s'] = now - self.phases[-1]['started']
+            self.phases.append({'label': label, 'started': now, 'elapsed_s': 0.0, 'frames': 0, 'bytes': 0,
+                                'width': 0, 'height': 0})
+
+    def record_device(self, text: str) -> bool:
+        """'STATS:{json}' -> keep the latest device telemetry snapshot"""
+        try:
+            device = json.loads(text[len('STATS:'):])
+        except ValueError:
+            return False
+        with self.lock:
+            self.device = device
+            self.device_snapshots += 1
+        return True
+
+    def record(self, data: bytes, receive_us: int) -> Optional[dict]:
+        """
+        Returns:
+            the envelope of a live frame (None for raw and backfilled frames)
+        """
+        with self.lock:
+            self.bytes += len(data)
+            decoded = decode_envelope(data)
+            if decoded is None:
+                self.raw_frames += 1
+                return None
+            header, _ = decoded
+            if header['flags'] & FLAG_HISTORICAL:
+                # Recorded during an outage: own sequence space, old capture times
+                self.backfilled += 1
+                return None
+            self.frames += 1
+            if self.phases:
+                phase = self.phases[-1]
+                phase['frames'] += 1
+                phase['bytes'] += len(data)
+                phase['width'], phase['height'] = header['width'], header['height']
+            if header['flags'] & FLAG_MOTION:
+                self.motion_frames += 1
+
+            # Sequence: gaps are frames lost or gated before the envelope was written
+            sequence = header['sequence']
+            if self.last_sequence is not None:
+                if sequence > self.last_sequence + 1:
+                    self.gaps += 1
+                    self.lost += sequence - self.last_sequence - 1
+                elif sequence <= self.last_sequence:
+                    self.reordered += 1
+            if self.last_sequence is None or sequence > self.last_sequence:
+                self.last_sequence = sequence
+
+            self.latency_ms['capture_to_send'].append((header['send_us'] - header['capture_us']) / 1000.0)
+            if header['flags'] & FLAG_CLOCK_SYNCED:
+                offset = header['clock_offset_us']
+                self.latency_ms['send_to_server'].append((receive_us - (header['send_us'] + offset)) / 1000.0)
+                self.latency_ms['capture_to_server'].append((receive_us - (header['capture_us'] + offset)) / 1000.0)
+            else:
+                self.unsynced += 1
+            return header
+
+    def record_consumer(self, header: dict, displayed_us: int) -> None:
+        """A live frame reached the slow consumer (capture time on the server clock)"""
+        if header['flags'] & FLAG_CLOCK_SYNCED:
+            with self.lock:
+                capture_us = header['capture_us'] + header['clock_offset_us']
+                self.latency_ms['capture_to_consumer'].append((displayed_us - capture_us) / 1000.0)
+
+    def record_command(self, rtt_ms: float) -> None:
+        with self.lock:
+            self.latency_ms['command_rtt'].append(rtt_ms)
+
+    def record_compact(self, rebuilder: HeaderRebuilder, broken: int) -> None:
+        with self.lock:
+            self.compact = {'defined': rebuilder.defined, 'elided': rebuilder.elided, 'unknown': rebuilder.unknown,
+                            'saved_bytes': rebuilder.saved, 'broken': broken}
+
+    def record_snapshot(self, data: bytes, parts: int, upload_us: int) -> None:
+        """A reassembled snapshot (not part of the live stream)"""
+        decoded = decode_envelope(data)
+        with self.lock:
+            if decoded is None:
+                self.snapshot_dropped += 1
+                return
+            header, jpeg = decoded
+            self.snapshots.append({'id': header['sequence'], 'size': f"{header['width']}x{header['height']}",
+                                   'bytes': len(jpeg), 'parts': parts, 'upload_ms': round(upload_us / 1000.0, 1),
+                                   'valid': bool(header['flags'] & FLAG_SNAPSHOT) and jpeg[:2] == b'\xff\xd8'
+                                   and jpeg[-2:] == b'\xff\xd9',
+                                   'gap_ms': None})
+
+    def record_snapshot_status(self, text: str) -> None:
+        """'SNAPSHOT_STATUS:{json}' -> the device's measured live gap for a captured snapshot"""
+        try:
+            status = json.loads(text[len('SNAPSHOT_STATUS:'):])
+        except ValueError:
+            return
+        if status.get('state') != 'captured':
+            return
+        with self.lock:
+            self.snapshots.append({'id': status.get('id'), 'gap_ms': status.get('gapMs'),
+                                   'switch_ms': status.get('switchMs'), 'reinit': status.get('reinit')})
+
+    def record_luma(self, follower: LumaFollower, header: Optional[dict], receive_us: int) -> None:
+        """A 'LUM' plane (header None: not decodable or waiting for a key plane)"""
+        with self.lock:
+            if header is not None and header['flags'] & LUMA_FLAG_CLOCK_SYNCED:
+                capture_us = header['capture_us'] + header['clock_offset_us']
+                self.latency_ms['luma_capture_to_server'].append((receive_us - capture_us) / 1000.0)
+            changes = follower.changed_permille
+            self.luma = {'planes': follower.planes, 'key_planes': follower.key_planes, 'waited': follower.waited,
+                         'errors': follower.errors, 'bytes': follower.bytes, 'size': follower.size,
+                         'changed_permille_max': max(changes) if changes else 0,
+                         'changed_permille_last': changes[-1] if changes else 0}
+
+    def record_parts(self, parts: int, dropped: int) -> None:
+        with self.lock:
+            self.chunk_parts += parts
+            self.chunk_dropped += dropped
+
+    def merged_snapshots(self) -> List[dict]:
+        """Status (captured, gap) and upload (bytes, time) of each snapshot id in one entry"""
+        merged: Dict[int, dict] = {}
+        for entry in self.snapshots:
+            merged.setdefault(entry['id'], {}).update({k: v for k, v in entry.items() if v is not None})
+        return [merged[key] for key in sorted(merged, key=lambda k: k or 0)]
+
+    def snapshot(self) -> dict:
+        with self.lock:
+            elapsed = max(1e-6, time.monotonic() - self.started)
+            result = {
+                'elapsed_s': round(elapsed, 1),
+                'frames': self.frames,
+                'raw_frames': self.raw_frames,
+                'fps': round((self.frames + self.raw_frames) / elapsed, 2),
+                'kbps': round(self.bytes * 8 / 1000 / elapsed, 1),
+                'gaps': self.gaps,
+                'lost': self.lost,
+                'reordered': self.reordered,
+                'motion_frames': self.motion_frames,
+                'backfilled': self.backfilled,
+                'unsynced': self.unsynced,
+                'pings': self.pings,
+                'chunk_parts': self.chunk_parts,
+                'chunk_dropped': self.chunk_dropped,
+                'latency_ms': {},
+                'device_snapshots': self.device_snapshots,
+                'device': self.device,
+                'phases': [],
+                'compact': self.compact,
+                'snapshots': self.merged_snapshots(),
+                'snapshot_dropped': self.snapshot_dropped,
+                'luma': dict(self.luma, fps=round(self.luma['planes'] / elapsed, 2)) if self.luma else None,
+            }
+            for phase in self.phases:
+                seconds = max(1e-6, phase['elapsed_s'] or time.monotonic() - phase['started'])
+                result['phases'].append({
+                    'label': phase['label'],
+                    'seconds': round(seconds, 1),
+                    'frames': phase['frames'],
+                    'fps': round(phase['frames'] / seconds, 2),
+                    'bytes_per_frame': phase['bytes'] // phase['frames'] if phase['frames'] else 0,
+                    'kbps': round(phase['bytes'] * 8 / 1000 / seconds, 1),
+                    'size': f"{phase['width']}x{phase['height']}",
+                })
+            for hop, values in self.latency_ms.items():
+                result['latency_ms'][hop] = {
+                    'count': len(values),
+                    'p50': round(percentile(values, 50), 2),
+                    'p90': round(percentile(values, 90), 2),
+                    'p99': round(percentile(values, 99), 2),
+                    'max': round(max(values), 2) if values else 0.0,
+                }
+            return result
+
+
+# ========================================
+# Minimal WebSocket Server (RFC 6455)
+# ========================================
+WS_GUID = '258EAFA5-E914-47DA-95CA-C5AB0DC85B11'
+OP_CONTINUATION, OP_TEXT, OP_BINARY, OP_CLOSE, OP_PING, OP_PONG = 0x0, 0x1, 0x2, 0x8, 0x9, 0xA
+
+
+def recv_exact(sock: socket.socket, count: int) -> bytes:
+    data = bytearray()
+    while len(data) < count:
+        chunk = sock.recv(count - len(data))
+        if not chunk:
+            raise ConnectionError('connection closed')
+        data.extend(chunk)
+    return bytes(data)
+
+
+def send_frame(sock: socket.socket, opcode: int, payload: bytes) -> None:
+    length = len(payload)
+    if length < 126:
+        header = struct.pack('>BB', 0x80 | opcode, length)
+    elif length < 65536:
+        header = struct.pack('>BBH', 0x80 | opcode, 126, length)
+    else:
+        header = struct.pack('>BBQ', 0x80 | opcode, 127, length)
+    sock.sendall(header + payload)
+
+
+def unmask(data: bytes, mask: bytes) -> bytes:
+    # Whole-payload XOR via big ints (frames are tens of KB)
+    key = (mask * (len(data) // 4 + 1))[:len(data)]
+    return (int.from_bytes(data, 'big') ^ int.from_bytes(key, 'big')).to_bytes(len(data), 'big')
+
+
+def recv_message(sock: socket.socket) -> Tuple[int, bytes]:
+    """Read one (possibly fragmented) message; control frames are returned as-is"""
+    message_opcode = None
+    payload = bytearray()
+    while True:
+        b0, b1 = recv_exact(sock, 2)
+        fin = b0 & 0x80
+        opcode = b0 & 0x0F
+        length = b1 & 0x7F
+        if length == 126:
+            length = struct.unpack('>H', recv_exact(sock, 2))[0]
+        elif length == 127:
+            length = struct.unpack('>Q', recv_exact(sock, 8))[0]
+        mask = recv_exact(sock, 4) if b1 & 0x80 else None
+        data = recv_exact(sock, length)
+        if mask:
+            data = unmask(data, mask)
+        if opcode >= 0x8:
+            return opcode, data
+        if opcode != OP_CONTINUATION:
+            message_opcode = opcode
+        payload.extend(data)
+        if fin:
+            return message_opcode, bytes(payload)
+
+
+class CommandProbe:
+    """Sends LED_STATUS periodically and times the LED_STATUS:<state> reply (one probe in flight)"""
+
+    TIMEOUT_S = 5.0
+
+    def __init__(self, send, interval_s: float):
+        self.send = send
+        self.interval_s = interval_s
+        self.lock = threading.Lock()
+        self.sent_at: Optional[float] = None
+        self.rtt_ms = 0.0
+        self.stopped = threading.Event()
+
+    def run(self) -> None:
+        while not self.stopped.wait(self.interval_s):
+            with self.lock:
+                if self.sent_at is not None and time.monotonic() - self.sent_at < self.TIMEOUT_S:
+                    continue
+                self.sent_at = time.monotonic()
+            try:
+                self.send(OP_TEXT, b'LED_STATUS')
+            except OSError:
+                return
+
+    def answer(self) -> bool:
+        """Match a reply to the probe in flight (unsolicited status updates are ignored)"""
+        with self.lock:
+            if self.sent_at is None:
+                return False
+            self.rtt_ms = (time.monotonic() - self.sent_at) * 1000.0
+            self.sent_at = None
+            return True
+
+    def stop(self) -> None:
+        self.stopped.set()
+
+
+class CommandScript:
+    """Sends (offset seconds, text) commands after the connection and starts a stats phase at each"""
+
+    def __init__(self, send, commands: List[Tuple[float, str]], stats: StreamStats):
+        self.send = send
+        self.commands = sorted(commands)
+        self.stats = stats
+        self.stopped = threading.Event()
+
+    def run(self) -> None:
+        started = time.monotonic()
+        self.stats.start_phase('connected')
+        for offset, text in self.commands:
+            if self.stopped.wait(max(0.0, started + offset - time.monotonic())):
+                return
+            try:
+                self.send(OP_TEXT, text.encode())
+            except OSError:
+                return
+            self.stats.start_phase(text)
+
+    def stop(self) -> None:
+        self.stopped.set()
+
+
+class SlowConsumer:
+    """
+    Viewer that drains live frames at a fixed rate from a queue without limit (a web socket
+    on the relay) and returns a credit per drained frame when the device was granted credits
+    """
+
+    def __init__(self, send, kbps: float, credits: int, stats: StreamStats):
+        self.send = send
+        self.kbps = kbps
+        self.credits = credits
+        self.stats = stats
+        self.queue: List[Tuple[dict, int]] = []
+        self.ready = threading.Condition()
+        self.stopped = False
+
+    def push(self, header: dict, length: int) -> None:
+        with self.ready:
+            self.queue.append((header, length))
+            self.ready.notify()
+
+    def run(self) -> None:
+        while True:
+            with self.ready:
+                while not self.queue and not self.stopped:
+                    self.ready.wait()
+                if self.stopped:
+                    return
+                header, length = self.queue.pop(0)
+            time.sleep(length * 8 / 1000.0 / self.kbps)
+            self.stats.record_consumer(header, now_us())
+            if self.credits > 0:
+                try:
+                    self.send(OP_TEXT, b'CREDIT:1')
+                except OSError:
+                    return
+
+    def stop(self) -> None:
+        with self.ready:
+            self.stopped = True
+            self.ready.notify()
+
+
+class StandInHandler(socketserver.BaseRequestHandler):
+    def handle(self) -> None:
+        sock: socket.socket = self.request
+        request = b''
+        while b'\r\n\r\n' not in request:
+            chunk = sock.recv(4096)
+            if not chunk:
+                return
+            request += chunk
+        lines = request.split(b'\r\n\r\n')[0].decode('latin-1').split('\r\n')
+        path = lines[0].split(' ')[1] if len(lines[0].split(' ')) > 1 else '/'
+        headers = {}
+        for line in lines[1:]:
+            if ':' in line:
+                name, value = line.split(':', 1)
+                headers[name.strip().lower()] = value.strip()
+        key = headers.get('sec-websocket-key', '')
+        accept = base64.b64encode(hashlib.sha1((key + WS_GUID).encode()).digest()).decode()
+        sock.sendall(('HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n'
+                      f'Sec-WebSocket-Accept: {accept}\r\n\r\n').encode())
+
+        server: 'StandInServer' = self.server  # type: ignore[assignment]
+        server.log(f'[Stand-in] Connected {self.client_address[0]} {path}')
+        send_lock = threading.Lock()  # replies (this thread) and command probes (probe thread)
+
+        def send(opcode: int, payload: bytes) -> None:
+            with send_lock:
+                send_frame(sock, opcode, payload)
+
+        assembler = FrameAssembler()
+        snapshots = SnapshotAssembler()
+        luma = LumaFollower()
+        probe = CommandProbe(send, server.command_interval)
+        if server.command_interval > 0:
+            threading.Thread(target=probe.run, daemon=True).start()
+        if server.demand:
+            send(OP_TEXT, f'DEMAND:{server.demand}'.encode())
+        if server.credits > 0:
+            send(OP_TEXT, f'CREDIT:{server.credits}'.encode())
+        rebuilder = HeaderRebuilder()
+        broken = 0
+        if server.compact:
+            send(OP_TEXT, b'JPEG_SYNC')
+        consumer = SlowConsumer(send, server.consumer_kbps, server.credits, server.stats)
+        if server.consumer_kbps > 0:
+            threading.Thread(target=consumer.run, daemon=True).start()
+        script = CommandScript(send, server.script, server.stats)
+        if server.script:
+            threading.Thread(target=script.run, daemon=True).start()
+        try:
+            while True:
+                opcode, payload = recv_message(sock)
+                receive_us = now_us()
+                if opcode == OP_BINARY and payload[:3] == SNAPSHOT_MAGIC and len(payload) >= SNAPSHOT_HEADER.size:
+                    # Snapshot parts never reset the live frame assembler
+                    dropped = snapshots.dropped
+                    complete = snapshots.accept(payload, receive_us)
+                    with server.stats.lock:
+                        server.stats.snapshot_dropped += snapshots.dropped - dropped
+                    if complete is not None:
+                        server.stats.record_snapshot(*complete)
+                        server.log(f'[Stand-in] Snapshot #{snapshots.snapshot_id}: {snapshots.total} bytes in '
+                                   f'{complete[1]} parts, {complete[2] / 1000:.0f} ms')
+                elif opcode == OP_BINARY and payload[:3] == LUMA_MAGIC:
+                    # Side-stream planes never reach the frame assembler either
+                    server.stats.record_luma(luma, luma.accept(payload), receive_us)
+                elif opcode == OP_BINARY:
+                    parts, dropped = assembler.parts, assembler.dropped
+                    frame = assembler.accept(payload)
+                    server.stats.record_parts(assembler.parts - parts, assembler.dropped - dropped)
+                    if frame is not None:
+                        header = server.stats.record(frame, receive_us)
+                        if header is not None and server.consumer_kbps > 0:
+                            consumer.push(header, len(frame))
+                        decoded = decode_envelope(frame) if server.compact else None
+                        if decoded is not None:
+                            jpeg = rebuilder.accept(*decoded)
+                            if jpeg is None:
+                                if not rebuilder.sync_requested:
+                                    rebuilder.sync_requested = True
+                                    send(OP_TEXT, b'JPEG_SYNC')  # header lost: ask for a new epoch
+                            elif jpeg[:2] != b'\xff\xd8' or jpeg[-2:] != b'\xff\xd9':
+                                broken += 1
+                            server.stats.record_compact(rebuilder, broken)
+                elif opcode == OP_TEXT:
+                    text = payload.decode('utf-8', errors='replace')
+                    if text.startswith('PING:'):
+                        pong = make_pong(text, receive_us, now_us())
+                        if pong:
+                            send(OP_TEXT, pong.encode())
+                            with server.stats.lock:
+                                server.stats.pings += 1
+                    elif text.startswith('LED_STATUS:') and probe.answer():
+                        server.stats.record_command(probe.rtt_ms)
+                    elif text.startswith('SNAPSHOT_STATUS:'):
+                        server.stats.record_snapshot_status(text)
+                        server.log(f'[Stand-in] Text: {text}')
+                    elif not (text.startswith('STATS:') and server.stats.record_device(text)):
+                        server.log(f'[Stand-in] Text: {text}')
+                elif opcode == OP_PING:
+                    send(OP_PONG, payload)
+                elif opcode == OP_CLOSE:
+                    send(OP_CLOSE, payload[:2])
+                    break
+        except (ConnectionError, OSError):
+            pass
+        probe.stop()
+        script.stop()
+        consumer.stop()
+        server.log(f'[Stand-in] Disconnected {self.client_address[0]}')
+
+
+class StandInServer(socketserver.ThreadingTCPServer):
+    allow_reuse_address = True
+    daemon_threads = True
+
+    def __init__(self, port: int, quiet: bool = False, command_interval: float = 1.0,
+                 script: Optional[List[Tuple[float, str]]] = None, demand: str = '', credits: int = 0,
+                 consumer_kbps: float = 0, compact: bool = False):
+        super().__init__(('0.0.0.0', port), StandInHandler)
+        self.stats = StreamStats()
+        self.quiet = quiet
+        self.command_interval = command_interval
+        self.script = script or []
+        self.demand = demand
+        self.credits = credits
+        self.consumer_kbps = consumer_kbps
+        self.compact = compact
+
+    def log(self, message: str) -> None:
+        if not self.quiet:
+            print(message, flush=True)
+
+
+def format_report(snapshot: dict) -> str:
+    lines = [f"[Stand-in] {snapshot['elapsed_s']}s frames={snapshot['frames']}+{snapshot['raw_frames']} raw "
+             f"fps={snapshot['fps']} kbps={snapshot['kbps']} gaps={snapshot['gaps']} lost={snapshot['lost']} "
+             f"reordered={snapshot['reordered']} unsynced={snapshot['unsynced']} backfilled={snapshot['backfilled']} "
+             f"parts={snapshot['chunk_parts']} (dropped {snapshot['chunk_dropped']})"]
+    for hop, p in snapshot['latency_ms'].items():
+        lines.append(f"[Stand-in]   {hop:<19} n={p['count']:<5} p50={p['p50']:>7.1f} p90={p['p90']:>7.1f} "
+                     f"p99={p['p99']:>7.1f} max={p['max']:>7.1f} ms")
+    device = snapshot.get('device')
+    if device:
+        send, capture, loop = device.get('sendUs', {}), device.get('capUs', {}), device.get('loopUs', {})
+        lines.append(f"[Stand-in]   device window {device.get('winMs', 0) / 1000:.0f}s: "
+                     f"send p50={send.get('p50', 0) / 1000:.1f} p99={send.get('p99', 0) / 1000:.1f} ms, "
+                     f"capture p99={capture.get('p99', 0) / 1000:.1f} ms, loop max={loop.get('max', 0) / 1000:.1f} ms, "
+                     f"command wait max={device.get('gapUs', {}).get('max', 0) / 1000:.1f} ms, "
+                     f"heap min={device.get('heap', {}).get('min', 0)} B, reconnects={device.get('reconnects', 0)}, "
+                     f"send failures={device.get('sendFail', {}).get('total', 0)}, "
+                     f"allocs={device.get('allocs', {}).get('win', 0)}")
+        boot = device.get('boot')
+        if boot:
+            lines.append(f"[Stand-in]   device boot: camera {boot.get('camMs', 0)} ms, WiFi {boot.get('wifiMs', 0)} ms "
+                         f"({'cached' if boot.get('cachedJoin') else 'scan'}), WebSocket {boot.get('wsMs', 0)} ms, "
+                         f"first frame {boot.get('frameMs', 0)} ms")
+    compact = snapshot.get('compact')
+    if compact:
+        saved_kbps = compact['saved_bytes'] * 8 / 1000 / max(1e-6, snapshot['elapsed_s'])
+        lines.append(f"[Stand-in]   compact frames: defined={compact['defined']} elided={compact['elided']} "
+                     f"unknown={compact['unknown']} broken={compact['broken']} "
+                     f"saved={compact['saved_bytes'] // 1024} KB ({saved_kbps:.1f} kbps)")
+    for shot in snapshot['snapshots']:
+        lines.append(f"[Stand-in]   snapshot #{shot.get('id')} {shot.get('size', '?')} {shot.get('bytes', 0) // 1024} KB "
+                     f"in {shot.get('parts', 0)} parts, upload {shot.get('upload_ms', 0):.0f} ms, "
+                     f"live gap {shot.get('gap_ms', '?')} ms{' (re-init)' if shot.get('reinit') else ''}"
+                     f"{'' if shot.get('valid', False) else ' INCOMPLETE'}")
+    if snapshot['snapshot_dropped']:
+        lines.append(f"[Stand-in]   snapshot parts dropped: {snapshot['snapshot_dropped']}")
+    luma = snapshot.get('luma')
+    if luma:
+        per_plane = luma['bytes'] // max(1, luma['planes'])
+        lines.append(f"[Stand-in]   luma planes: {luma['planes']} {luma['size']} ({luma['fps']} fps, key {luma['key_planes']}) "
+                     f"{per_plane} B/plane, waited={luma['waited']} errors={luma['errors']}, changed "
+                     f"last={luma['changed_permille_last']} max={luma['changed_permille_max']} permille")
+    if snapshot['phases']:
+        for phase in snapshot['phases']:
+            lines.append(f"[Stand-in]   phase {phase['label']:<24} {phase['seconds']:>5.1f}s fps={phase['fps']:>6.2f} "
+                         f"bytes/frame={phase['bytes_per_frame']:>6} kbps={phase['kbps']:>7.1f} size={phase['size']}")
+    return '\n'.join(lines)
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description='Local stand-in for the relay server ESP32 endpoint')
+    parser.add_argument('--port', type=int, default=8887)
+    parser.add_argument('--duration', type=float, default=0, help='stop after N seconds (0 = run until Ctrl+C)')
+    parser.add_argument('--report-interval', type=float, default=10)
+    parser.add_argument('--json', help='write the final report to this file')
+    parser.add_argument('--command-interval', type=float, default=1.0,
+                        help='seconds between LED_STATUS round-trip probes (0 = off)')
+    parser.add_argument('--send-at', action='append', default=[], metavar='S:TEXT',
+                        help='send TEXT S seconds after the device connects (repeatable)')
+    parser.add_argument('--demand', default='', metavar='L:A',
+                        help='consumer set sent on connect: live viewers, analyzers (default: none, device stays live)')
+    parser.add_argument('--credits', type=int, default=0, metavar='N',
+                        help='frame credits granted on connect, one returned per consumed frame (default: 0, no flow control)')
+    parser.add_argument('--consumer-kbps', type=float, default=0, metavar='K',
+                        help='drain live frames to a viewer at K kbps (default: 0, no consumer)')
+    parser.add_argument('--compact', action='store_true',
+                        help='ask for header-elided frames (JPEG_SYNC) and rebuild them like the relay')
+    parser.add_argument('--quiet', action='store_true')
+    args = parser.parse_args()
+
+    script = []
+    for item in args.send_at:
+        offset, _, text = item.partition(':')
+        try:
+            script.append((float(offset), text))
+        except ValueError:
+            parser.error(f'--send-at expects S:TEXT, got {item!r}')
+
+    if args.demand and not re.fullmatch(r'\d+:\d+', args.demand):
+        parser.error(f'--demand expects L:A, got {args.demand!r}')
+
+    if args.credits > 0 and args.consumer_kbps <= 0:
+        parser.error('--credits needs --consumer-kbps (credits are returned as the consumer drains frames)')
+
+    server = StandInServer(args.port, args.quiet, args.command_interval, script, args.demand, args.credits,
+                           args.consumer_kbps, args.compact)
+    threading.Thread(target=server.serve_forever, daemon=True).start()
+    print(f'[Stand-in] Listening on ws://0.0.0.0:{args.port}/esp32', flush=True)
+
+    deadline = time.monotonic() + args.duration if args.duration > 0 else None
+    next_report = time.monotonic() + args.report_interval
+    try:
+        while deadline is None or time.monotonic() < deadline:
+            time.sleep(0.2)
+            if time.monotonic() >= next_report:
+                print(format_report(server.stats.snapshot()), flush=True)
+                next_report += args.report_interval
+    except KeyboardInterrupt:
+        pass
+    server.shutdown()
+
+    snapshot = server.stats.snapshot()
+    print(format_report(snapshot), flush=True)
+    if args.json:
+        with open(args.json, 'w') as f:
+            json.dump(snapshot, f, indent=2)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
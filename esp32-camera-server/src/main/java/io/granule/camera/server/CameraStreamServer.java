@@ -1,7 +1,7 @@
 /**
  * `CameraStreamServer.java`
  * - WebSocket server for ESP32 camera streaming with LED control
- * - Modular architecture: Connection + LED + Frame + Stats modules
+ * - Modular architecture: Connection + LED + Frame + Stats + Demand + Flow + Profile + Snapshot + Luma modules
  * - Features: Frame relay, LED synchronization, connection management
  *
  * @author      Sim Woo-Keun <smileteeth14@gmail.com>
@@ -12,9 +12,19 @@
 package io.granule.camera.server;
 
 import io.granule.camera.server.config.ServerConfig;
+import io.granule.camera.server.module.CompactFrameService;
 import io.granule.camera.server.module.ConnectionManager;
+import io.granule.camera.server.module.DeviceTelemetryService;
+import io.granule.camera.server.module.FlowControlService;
+import io.granule.camera.server.module.FrameAssembler;
+import io.granule.camera.server.module.FrameEnvelope;
 import io.granule.camera.server.module.LedStateManager;
+import io.granule.camera.server.module.LumaRelayService;
 import io.granule.camera.server.module.FrameRelayService;
+import io.granule.camera.server.module.SnapshotService;
+import io.granule.camera.server.module.StreamDemandService;
+import io.granule.camera.server.module.StreamDemandService.ConsumerNeed;
+import io.granule.camera.server.module.StreamProfileService;
 import io.granule.camera.server.module.ViewerStatsService;
 
 import org.java_websocket.WebSocket;
@@ -26,6 +36,8 @@ import org.slf4j.LoggerFactory;
 import java.net.InetSocketAddress;
 import java.nio.ByteBuffer;
 import java.util.Map;
+import java.util.concurrent.Executors;
+import java.util.concurrent.ScheduledExecutorService;
 import java.util.concurrent.Semaphore;
 import java.util.concurrent.TimeUnit;
 import java.util.concurrent.atomic.AtomicReference;
@@ -43,6 +55,22 @@ public class CameraStreamServer extends WebSocketServer {
     private final LedStateManager ledStateManager = new LedStateManager();
     private final FrameRelayService frameRelayService = new FrameRelayService();
     private final ViewerStatsService viewerStatsService = new ViewerStatsService();
+    private final DeviceTelemetryService deviceTelemetryService = new DeviceTelemetryService();
+    private final FrameAssembler frameAssembler = new FrameAssembler();
+    private final StreamDemandService streamDemandService = new StreamDemandService();
+    private final FlowControlService flowControlService = new FlowControlService(
+        ServerConfig.FLOW_CREDIT_WINDOW, ServerConfig.FLOW_CREDIT_MAX_HOLD_MS);
+    private final CompactFrameService compactFrameService = new CompactFrameService();
+    private final StreamProfileService streamProfileService = new StreamProfileService(ServerConfig.getStreamProfile());
+    private final SnapshotService snapshotService = new SnapshotService(ServerConfig.getSnapshotDir());
+    private final LumaRelayService lumaRelayService = new LumaRelayService(ServerConfig.getLumaInterval());
+    
+    // Returns frame credits as the consumers' sockets drain (daemon: does not block shutdown)
+    private final ScheduledExecutorService creditScheduler = Executors.newSingleThreadScheduledExecutor(runnable -> {
+        final Thread thread = new Thread(runnable, "flow-credits");
+        thread.setDaemon(true);
+        return thread;
+    });
     
     // Version tracking (Thread-Safe)
     private final AtomicReference<String> firmwareVersion = new AtomicReference<>("Unknown");
@@ -53,6 +81,10 @@ public class CameraStreamServer extends WebSocketServer {
     private volatile long lastViewerCountBroadcast = 0;
     private static final long VIEWER_COUNT_DEBOUNCE_MS = 100; // 100ms debouncing
     
+    // Binary command form: [magic][opcode][argument length u16][argument] (firmware CommandRouter.h)
+    private static final int COMMAND_MAGIC = 0xC7;
+    private static final int COMMAND_HEADER_SIZE = 4;
+    
     public CameraStreamServer(final int port) {
         super(new InetSocketAddress(port));
         _log.info("CameraStreamServer initialized on port {} (modular architecture)", port);
@@ -72,8 +104,28 @@ public class CameraStreamServer extends WebSocketServer {
             // Request current LED status from ESP32
             conn.send("LED_STATUS");
             _log.debug("Requested LED status from ESP32");
+            
+            // Tell the device who consumes its stream (it uploads nothing if nobody does)
+            conn.send(streamDemandService.getDemandCommand());
+            
+            // Frames in flight from the device (one credit comes back per relayed frame)
+            conn.send(flowControlService.addDevice(conn));
+            
+            // JPEG header once per change, scan data only in between (restored before relaying)
+            conn.send(compactFrameService.addDevice(conn));
+            
+            // Gray plane rate for the analyzers (device default from Config.h otherwise)
+            final String luma = lumaRelayService.getIntervalCommand();
+            if (luma != null) {
+                conn.send(luma);
+            }
         } else if (uri.startsWith("/analyzer")) {
             connectionManager.addAnalyzerClient(conn);
+            streamDemandService.addConsumer(conn, ConsumerNeed.ANALYZER);
+            announceDemand();
+            
+            // The new analyzer has no reference plane: the next gray plane must be a key plane
+            connectionManager.broadcastToESP32(LumaRelayService.KEY_COMMAND);
             _log.info("========================================");
             _log.info("🎯 MOTION ANALYZER CONNECTED");
             _log.info("Remote: {}", conn.getRemoteSocketAddress());
@@ -82,6 +134,10 @@ public class CameraStreamServer extends WebSocketServer {
             connectionManager.addWebClient(conn);
             _log.info("New web viewer connected: {}", conn.getRemoteSocketAddress());
             
+            // Ramp the device up first: the new viewer waits for its first frame
+            streamDemandService.addConsumer(conn, ConsumerNeed.LIVE);
+            announceDemand();
+            
             // Send current LED state to new viewer
             conn.send(ledStateManager.getStatus());
             _log.debug("Sent current LED state to new viewer: {}", ledStateManager.getStatus());
@@ -89,6 +145,12 @@ public class CameraStreamServer extends WebSocketServer {
             // Send version information
             sendVersionInfo(conn);
             
+            // Camera capabilities (the device advertised them before this viewer connected)
+            final String caps = streamProfileService.getLatestCapabilities();
+            if (caps != null) {
+                conn.send(caps);
+            }
+            
             // Broadcast viewer count to all web clients
             broadcastViewerCount();
         } else {
@@ -105,6 +167,13 @@ public class CameraStreamServer extends WebSocketServer {
         _log.info("Connection closed: {} - {}", remoteAddress, reason);
         
         final boolean wasWebClient = connectionManager.removeClient(conn);
+        frameAssembler.remove(conn);
+        streamDemandService.removeConsumer(conn);
+        flowControlService.removeDevice(conn);
+        streamProfileService.removeDevice(conn);
+        compactFrameService.removeDevice(conn);
+        snapshotService.remove(conn);
+        announceDemand();
         
         // Notify remaining viewers of updated count
         if (wasWebClient) {
@@ -114,6 +183,15 @@ public class CameraStreamServer extends WebSocketServer {
     
     @Override
     public void onMessage(final WebSocket conn, final String message) {
+        // Clock sync: answer immediately (t1 taken before anything else)
+        if (message.startsWith("PING:") && connectionManager.isEsp32Client(conn)) {
+            final String pong = FrameEnvelope.makePong(message, FrameEnvelope.nowMicros());
+            if (pong != null) {
+                conn.send(pong);
+            }
+            return;
+        }
+        
         _log.debug("Text message received from {}: {}", conn.getRemoteSocketAddress(), message);
         
         // Handle control messages
@@ -130,6 +208,45 @@ public class CameraStreamServer extends WebSocketServer {
                 return;
             }
             
+            // Telemetry snapshot (still forwarded to viewers below)
+            if (deviceTelemetryService.isTelemetry(message)) {
+                deviceTelemetryService.record(message);
+            }
+            
+            // Upload mode acknowledgement (still forwarded to viewers below)
+            if (message.startsWith(StreamDemandService.STATUS_PREFIX)) {
+                _log.info("[Demand] ESP32 {}", message);
+            }
+            
+            // Credit window state (reply to CREDIT, still forwarded to viewers below)
+            if (message.startsWith(FlowControlService.STATUS_PREFIX)) {
+                _log.info("[Flow] ESP32 {}", message);
+            }
+            
+            // Capabilities on connect: answer with the configured profile (still forwarded to viewers below)
+            if (streamProfileService.isCapabilities(message)) {
+                final String profile = streamProfileService.recordCapabilities(conn, message);
+                if (profile != null) {
+                    conn.send(profile);
+                    _log.info("[Profile] Sent {}", profile);
+                }
+            }
+            
+            // Profile switch result with the measured gap (still forwarded to viewers below)
+            if (streamProfileService.isStatus(message)) {
+                streamProfileService.recordStatus(message);
+            }
+            
+            // Snapshot result: captured (with the live gap) / failed / uploaded (still forwarded to viewers below)
+            if (snapshotService.isStatus(message)) {
+                snapshotService.recordStatus(message);
+            }
+            
+            // Gray plane side-stream state (reply to LUMA, still forwarded to viewers below)
+            if (lumaRelayService.isStatus(message)) {
+                lumaRelayService.recordStatus(message);
+            }
+            
             // Update LED state if it's a status message
             if (ledStateManager.isLedStatusUpdate(message)) {
                 ledStateManager.updateStatus(message);
@@ -140,6 +257,14 @@ public class CameraStreamServer extends WebSocketServer {
         } else if (connectionManager.isWebClient(conn)) {
             _log.debug("Control message from web client: {}", message);
             
+            // Viewer need (e.g. tab hidden): changes the consumer set, not forwarded as is
+            if (streamDemandService.isNeedMessage(message)) {
+                if (streamDemandService.updateNeed(conn, message)) {
+                    announceDemand();
+                }
+                return;
+            }
+            
             // LED control with Race Condition prevention
             if (ledStateManager.isLedCommand(message)) {
                 try {
@@ -152,6 +277,7 @@ public class CameraStreamServer extends WebSocketServer {
                             connectionManager.broadcastToWebClients(message);
                             
                             // Forward control to ESP32
+                            ledStateManager.markCommandForwarded();
                             connectionManager.broadcastToESP32(message);
                             
                             _log.info("[LED] Control executed: {} by {}", message, conn.getRemoteSocketAddress());
@@ -184,17 +310,52 @@ public class CameraStreamServer extends WebSocketServer {
     public void onMessage(final WebSocket conn, final ByteBuffer message) {
         // Receive binary data (camera frames) from ESP32
         if (connectionManager.isEsp32Client(conn)) {
-            final int frameSize = message.remaining();
+            final long receiveUs = FrameEnvelope.nowMicros();
+            
+            // Snapshot parts (between live frames): joined and kept here, not relayed, no credit
+            if (snapshotService.accept(conn, message)) {
+                return;
+            }
+            
+            // Gray planes (between live frames): analyzers only, not counted as frames, no credit
+            if (LumaRelayService.isPlane(message)) {
+                lumaRelayService.recordPlane(message);
+                connectionManager.broadcastToAnalyzers(message);
+                return;
+            }
+            
+            // Large frames arrive in parts (device answers commands in between): relay whole frames only
+            final ByteBuffer assembled = frameAssembler.accept(conn, message);
+            if (assembled == null) {
+                return;
+            }
+            
+            // Compact frames get their JPEG header back; an unknown header asks the device for a new one
+            final ByteBuffer frame = compactFrameService.restore(conn, assembled, FrameEnvelope.decode(assembled));
+            if (frame == null) {
+                final String sync = compactFrameService.takeSyncRequest(conn);
+                if (sync != null) {
+                    conn.send(sync);
+                }
+                return;
+            }
+            final int frameSize = frame.remaining();
             _log.debug("Received frame from ESP32: {} bytes", frameSize);
             
+            // Envelope (sequence, timestamps) → latency/gap statistics
+            final FrameEnvelope envelope = FrameEnvelope.decode(frame);
+            if (envelope != null) {
+                frameRelayService.recordEnvelope(envelope, receiveUs);
+            }
+            
             // Update statistics
             frameRelayService.recordFrame(frameSize);
             
-            // Broadcast to all web clients
-            connectionManager.broadcastToWebClients(message);
+            // Broadcast to all web clients (envelope kept for capture-to-display latency)
+            connectionManager.broadcastToWebClients(frame);
             
             // Also broadcast to analyzers for motion detection
-            message.rewind();
+            frame.rewind();
             
             // Log frame distribution
             if (frameRelayService.getTotalFrames() % 100 == 0) {
@@ -203,7 +364,20 @@ public class CameraStreamServer extends WebSocketServer {
                     connectionManager.getWebClientsCount(),
                     connectionManager.getAnalyzerClientsCount());
             }
-            connectionManager.broadcastToAnalyzers(message);
+            
+            // Analyzers decode plain JPEG (viewers parse the envelope themselves);
+            // without timestamps they would take backfilled frames for live ones
+            if (envelope == null || !envelope.isHistorical()) {
+                connectionManager.broadcastToAnalyzers(envelope != null ? envelope.payload(frame) : frame);
+                
+                // Live frames hold a credit until the consumers' sockets have taken them
+                flowControlService.onFrameRelayed(conn, System.currentTimeMillis());
+            }
+        } else if (connectionManager.isWebClient(conn)) {
+            // Binary control commands (opcode form) - forward directly
+            if (message.remaining() >= COMMAND_HEADER_SIZE && (message.get(message.position()) & 0xFF) == COMMAND_MAGIC) {
+                connectionManager.broadcastToESP32(message);
+            }
         }
     }
     
@@ -218,6 +392,26 @@ public class CameraStreamServer extends WebSocketServer {
     @Override
     public void onStart() {
         _log.info("WebSocket server started successfully");
+        creditScheduler.scheduleAtFixedRate(this::returnCredits, ServerConfig.FLOW_CREDIT_POLL_MS,
+            ServerConfig.FLOW_CREDIT_POLL_MS, TimeUnit.MILLISECONDS);
+    }
+    
+    /**
+     * Return credits for frames the consumers have taken (or held too long)
+     */
+    private void returnCredits() {
+        try {
+            final Map<WebSocket, Integer> due = flowControlService.takeDueCredits(
+                connectionManager.consumersDrained(), System.currentTimeMillis());
+            for (final Map.Entry<WebSocket, Integer> entry : due.entrySet()) {
+                if (entry.getKey().isOpen()) {
+                    entry.getKey().send(flowControlService.grantCommand(entry.getValue()));
+                }
+            }
+        } catch (final Exception e) {
+            // An exception would cancel the schedule (no more credits for any device)
+            _log.error("[Flow] Credit return failed: {}", e.getMessage());
+        }
     }
     
     /**
@@ -241,11 +435,21 @@ public class CameraStreamServer extends WebSocketServer {
         }
     }
     
+    /**
+     * Send the consumer set to the ESP32 if it changed
+     */
+    private void announceDemand() {
+        final String command = streamDemandService.takeChangedCommand();
+        if (command != null) {
+            connectionManager.broadcastToESP32(command);
+        }
+    }
+    
     /**
      * Get server statistics
      */
     public final Map<String, Object> getStatistics() {
-        return viewerStatsService.getStatistics(
+        final Map<String, Object> stats = viewerStatsService.getStatistics(
             connectionManager.getWebClientsCount(),
             connectionManager.getEsp32ClientsCount(),
             frameRelayService.getTotalFrames(),
@@ -253,6 +457,28 @@ public class CameraStreamServer extends WebSocketServer {
             ledStateManager.getCommandCount(),
             ledStateManager.getStatus()
         );
+        stats.put("deviceTelemetry", deviceTelemetryService.getLatestSnapshot());
+        stats.put("deviceTelemetryAgeMs", deviceTelemetryService.getSnapshotAgeMs());
+        stats.put("ledCommandRoundTripMs", ledStateManager.getLastRoundTripMs());
+        stats.put("chunkedFramesAssembled", frameAssembler.getFramesAssembled());
+        stats.put("chunkedPartsDropped", frameAssembler.getPartsDropped());
+        stats.put("consumerDemand", streamDemandService.getDemandCommand());
+        stats.put("flowCreditWindow", flowControlService.getWindow());
+        stats.put("flowCreditsReturned", flowControlService.getCreditsReturned());
+        stats.put("flowCreditsForced", flowControlService.getCreditsForced());
+        stats.put("compactFramesRestored", compactFrameService.getFramesRestored());
+        stats.put("compactFramesDropped", compactFrameService.getFramesDropped());
+        stats.put("compactBytesSaved", compactFrameService.getBytesSaved());
+        stats.put("cameraCapabilities", streamProfileService.getLatestCapabilities());
+        stats.put("streamProfileStatus", streamProfileService.getLatestStatus());
+        stats.put("snapshotsReceived", snapshotService.getSnapshotsReceived());
+        stats.put("snapshotPartsDropped", snapshotService.getPartsDropped());
+        stats.put("snapshotStatus", snapshotService.getLatestStatus());
+        stats.put("lumaPlanesRelayed", lumaRelayService.getPlanesRelayed());
+        stats.put("lumaKeyPlanes", lumaRelayService.getKeyPlanes());
+        stats.put("lumaBytesRelayed", lumaRelayService.getBytesRelayed());
+        stats.put("lumaStatus", lumaRelayService.getLatestStatus());
+        return stats;
     }
     
     /**
@@ -59,6 +59,75 @@ public final class ServerConfig {
      */
     public static final int MAX_FRAME_SIZE = 1024 * 1024; // 1MB
     
+    // ========================================
+    // Flow Control Configuration
+    // ========================================
+    
+    /**
+     * Frame credits granted to the ESP32 on connect (live frames in flight)
+     * - 2: the next frame is already on its way while the previous one is being delivered
+     */
+    public static final int FLOW_CREDIT_WINDOW = 2;
+    
+    /**
+     * Credit returned after this long even if a consumer has not taken the frame (ms)
+     * - One stalled viewer slows the upload to 1 FPS instead of stopping it
+     */
+    public static final long FLOW_CREDIT_MAX_HOLD_MS = 1000;
+    
+    /**
+     * Interval of the consumer drain check that returns credits (ms)
+     */
+    public static final long FLOW_CREDIT_POLL_MS = 5;
+    
+    // ========================================
+    // Stream Profile Configuration
+    // ========================================
+    
+    /**
+     * Stream profile pushed to the ESP32 after it advertised its capabilities
+     * - `<size>:<quality>:<intervalMs>[:<xclkMhz>]`, e.g. `VGA:12:100` (env `STREAM_PROFILE`)
+     * - null: the device keeps its boot profile (Config.h) or bitrate ladder
+     */
+    public static final String getStreamProfile() {
+        final String profile = System.getenv("STREAM_PROFILE");
+        return profile != null && !profile.isBlank() ? profile.trim() : null;
+    }
+    
+    // ========================================
+    // Snapshot Configuration
+    // ========================================
+    
+    /**
+     * Directory for reassembled SNAPSHOT stills (`snapshot-<id>-<epochMs>.jpg`, env `SNAPSHOT_DIR`)
+     * - null: only the latest still is kept in memory
+     */
+    public static final String getSnapshotDir() {
+        final String dir = System.getenv("SNAPSHOT_DIR");
+        return dir != null && !dir.isBlank() ? dir.trim() : null;
+    }
+    
+    // ========================================
+    // Luma Side-Stream Configuration
+    // ========================================
+    
+    /**
+     * Gray plane interval pushed to the ESP32 on connect (ms, 0 = off, env `LUMA_INTERVAL`)
+     * - null: the device keeps LUMA_INTERVAL from Config.h
+     */
+    public static final Integer getLumaInterval() {
+        final String interval = System.getenv("LUMA_INTERVAL");
+        if (interval == null || interval.isBlank()) {
+            return null;
+        }
+        try {
+            final int ms = Integer.parseInt(interval.trim());
+            return ms >= 0 && ms <= 60000 ? ms : null;
+        } catch (NumberFormatException e) {
+            return null;
+        }
+    }
+    
     // ========================================
     // Statistics Configuration
     // ========================================
@@ -161,6 +230,8 @@ public final class ServerConfig {
         System.out.println("ESP32 Endpoint: ws://localhost:" + getPort() + ENDPOINT_ESP32);
         System.out.println("Viewer Endpoint: ws://localhost:" + getPort() + ENDPOINT_VIEWER);
         System.out.println("Max Frame Size: " + (MAX_FRAME_SIZE / 1024) + "KB");
+        System.out.println("Flow Control: " + FLOW_CREDIT_WINDOW + " frame credits (max hold " + FLOW_CREDIT_MAX_HOLD_MS + "ms)");
+        System.out.println("Stream Profile: " + (getStreamProfile() != null ? getStreamProfile() : "device default"));
         System.out.println("Statistics Logging: " + (STATS_LOGGING_ENABLED ? "Enabled" : "Disabled"));
         System.out.println("========================================");
     }
@@ -0,0 +1,180 @@
+/**
+ * `CompactFrameService.java`
+ * - Compact frame restoration (see esp32-camera-firmware/lib/JpegHeaderElision/JpegHeaderElision.h)
+ * - The ESP32 sends the JPEG preamble (SOI .. SOS header, ~600 bytes) once per header ID and only
+ *   the scan data afterwards, but only after the relay asked for it with `JPEG_SYNC`
+ * - Handles: `JPEG_SYNC` on connect, learning preambles from FLAG_HEADER_DEFINED frames,
+ *   rebuilding FLAG_HEADER_ELIDED frames, one `JPEG_SYNC` per unknown header ID
+ * - Viewers and analyzers get whole JPEG frames with both flags cleared, as before
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+package io.granule.camera.server.module;
+
+import org.java_websocket.WebSocket;
+import org.slf4j.Logger;
+import org.slf4j.LoggerFactory;
+
+import java.nio.ByteBuffer;
+import java.util.Map;
+import java.util.concurrent.ConcurrentHashMap;
+import java.util.concurrent.atomic.AtomicLong;
+
+/**
+ * Compact Frame Service
+ * Restores the JPEG preamble the ESP32 left out, one header per device
+ */
+public class CompactFrameService {
+    private static final Logger _log = LoggerFactory.getLogger(CompactFrameService.class);
+
+    public static final String SYNC_COMMAND = "JPEG_SYNC";
+    private static final int MAX_PREAMBLE = 1024;   // kMaxJpegPreamble on the device
+
+    private final Map<WebSocket, Header> headers = new ConcurrentHashMap<>();
+    private final AtomicLong framesRestored = new AtomicLong(0);
+    private final AtomicLong framesDropped = new AtomicLong(0);
+    private final AtomicLong bytesSaved = new AtomicLong(0);
+
+    private static final class Header {
+        int id;                 // 0 = none learned
+        byte[] preamble;
+        boolean syncRequested;  // JPEG_SYNC sent, waiting for a defining frame
+    }
+
+    /**
+     * Register a device and get the command that turns compact frames on
+     */
+    public final String addDevice(final WebSocket device) {
+        final Header header = new Header();
+        header.syncRequested = true;
+        headers.put(device, header);
+        return SYNC_COMMAND;
+    }
+
+    /**
+     * Forget a device (no-op for other connections)
+     */
+    public final void removeDevice(final WebSocket device) {
+        headers.remove(device);
+    }
+
+    /**
+     * Turn a device frame back into a plain enveloped JPEG
+     * @return the frame itself if it is not compact, the rebuilt frame, or null if its header
+     *         is unknown (dropped; the caller sends {@link #takeSyncRequest} to the device)
+     */
+    public final ByteBuffer restore(final WebSocket device, final ByteBuffer frame, final FrameEnvelope envelope) {
+        if (envelope == null || (!envelope.isHeaderDefined() && !envelope.isHeaderElided())) {
+            return frame;
+        }
+        final Header header = headers.get(device);
+        if (header == null) {
+            return frame;
+        }
+        synchronized (header) {
+            if (envelope.isHeaderDefined()) {
+                final int length = preambleLength(envelope.payload(frame));
+                if (length > 0) {
+                    final byte[] preamble = new byte[length];
+                    envelope.payload(frame).get(preamble);
+                    header.id = envelope.headerId();
+                    header.preamble = preamble;
+                    header.syncRequested = false;
+                }
+                return clearFlags(frame);
+            }
+            if (header.id == 0 || header.id != envelope.headerId()) {
+                framesDropped.incrementAndGet();
+                return null;
+            }
+            final ByteBuffer rebuilt = ByteBuffer.allocate(
+                    envelope.headerLength() + header.preamble.length + envelope.payloadLength());
+            final ByteBuffer head = frame.duplicate();
+            head.limit(frame.position() + envelope.headerLength());
+            rebuilt.put(head);
+            rebuilt.put(header.preamble);
+            rebuilt.put(envelope.payload(frame));
+            rebuilt.flip();
+            rebuilt.putInt(36, header.preamble.length + envelope.payloadLength());
+            framesRestored.incrementAndGet();
+            bytesSaved.addAndGet(header.preamble.length);
+            return clearFlags(rebuilt);
+        }
+    }
+
+    /**
+     * After a dropped frame: the command to send the device, once until it defines a new header
+     * @return null if a sync is already pending
+     */
+    public final String takeSyncRequest(final WebSocket device) {
+        final Header header = headers.get(device);
+        if (header == null) {
+            return null;
+        }
+        synchronized (header) {
+            if (header.syncRequested) {
+                return null;
+            }
+            header.syncRequested = true;
+        }
+        _log.info("[Compact] Unknown JPEG header from {}, requesting a new one", device.getRemoteSocketAddress());
+        return SYNC_COMMAND;
+    }
+
+    public final long getFramesRestored() {
+        return framesRestored.get();
+    }
+
+    public final long getFramesDropped() {
+        return framesDropped.get();
+    }
+
+    public final long getBytesSaved() {
+        return bytesSaved.get();
+    }
+
+    /**
+     * Length of the JPEG preamble: everything up to and including the SOS header
+     * (same walk as JpegHeaderElider::findPreamble)
+     * @return 0 if there is no usable preamble
+     */
+    static int preambleLength(final ByteBuffer jpeg) {
+        final int base = jpeg.position();
+        final int end = Math.min(jpeg.remaining(), MAX_PREAMBLE);
+        if (end < 4 || (jpeg.get(base) & 0xFF) != 0xFF || (jpeg.get(base + 1) & 0xFF) != 0xD8) {
+            return 0;
+        }
+        int pos = 2;
+        while (pos + 4 <= end) {
+            if ((jpeg.get(base + pos) & 0xFF) != 0xFF) {
+                return 0;
+            }
+            final int marker = jpeg.get(base + pos + 1) & 0xFF;
+            if (marker == 0xFF) {
+                pos++;  // fill byte
+                continue;
+            }
+            if (marker == 0xD8 || marker == 0xD9 || (marker >= 0xD0 && marker <= 0xD7) || marker == 0x01 || marker == 0x00) {
+                return 0;
+            }
+            final int segment = jpeg.getShort(base + pos + 2) & 0xFFFF;
+            if (segment < 2) {
+                return 0;
+            }
+            pos += 2 + segment;
+            if (marker == 0xDA) {
+                return pos <= end ? pos : 0;
+            }
+        }
+        return 0;
+    }
+
+    private static ByteBuffer clearFlags(final ByteBuffer frame) {
+        final int flags = frame.position() + 5;
+        frame.put(flags, (byte) (frame.get(flags) & ~(FrameEnvelope.FLAG_HEADER_DEFINED | FrameEnvelope.FLAG_HEADER_ELIDED)));
+        return frame;
+    }
+}
@@ -107,6 +107,24 @@ public class ConnectionManager {
         return analyzerClients.size();
     }
     
+    /**
+     * Check if every viewer and analyzer socket has written out what it was given
+     * (frame credits are returned to the ESP32 only then, see FlowControlService)
+     */
+    public final boolean consumersDrained() {
+        for (final WebSocket client : webClients) {
+            if (client.hasBufferedData()) {
+                return false;
+            }
+        }
+        for (final WebSocket client : analyzerClients) {
+            if (client.hasBufferedData()) {
+                return false;
+            }
+        }
+        return true;
+    }
+    
     /**
      * Broadcast binary data to all web clients
      * Prepends 8-byte big-endian timestamp (System.currentTimeMillis) for latency measurement
@@ -167,6 +185,20 @@ public class ConnectionManager {
         _log.debug("[Connection] Broadcasted message to {} ESP32 clients: {}", esp32Clients.size(), message);
     }
     
+    /**
+     * Broadcast binary command (compact form, see CommandRouter.h) to all ESP32 clients
+     */
+    public final void broadcastToESP32(final ByteBuffer command) {
+        for (final WebSocket client : esp32Clients) {
+            try {
+                client.send(command.duplicate());
+            } catch (Exception e) {
+                _log.error("[Connection] Failed to send command to ESP32: {}", e.getMessage());
+            }
+        }
+        _log.debug("[Connection] Forwarded {}-byte binary command to {} ESP32 clients", command.remaining(), esp32Clients.size());
+    }
+    
     /**
      * Broadcast binary data to all analyzer clients
      */
@@ -0,0 +1,123 @@
+/**
+ * `DeviceTelemetryService.java`
+ * - ESP32 runtime telemetry module
+ * - Handles: `STATS:{json}` snapshots (per-stage histograms, memory watermarks,
+ *   reconnects, failed sends, boot milestones), latest snapshot for statistics, summary logging
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+package io.granule.camera.server.module;
+
+import org.slf4j.Logger;
+import org.slf4j.LoggerFactory;
+
+import java.util.concurrent.atomic.AtomicLong;
+import java.util.concurrent.atomic.AtomicReference;
+
+/**
+ * Device Telemetry Service
+ * Keeps the latest telemetry snapshot published by the ESP32
+ */
+public class DeviceTelemetryService {
+    private static final Logger _log = LoggerFactory.getLogger(DeviceTelemetryService.class);
+    
+    public static final String STATS_PREFIX = "STATS:";
+    public static final String STATS_COMMAND = "STATS";  // ask the ESP32 for a snapshot now
+    
+    private final AtomicReference<String> latestSnapshot = new AtomicReference<>(null);
+    private final AtomicLong snapshotCount = new AtomicLong(0);
+    private volatile long lastSnapshotTime = 0;
+    
+    /**
+     * Check if message is a telemetry snapshot
+     */
+    public final boolean isTelemetry(final String message) {
+        return message.startsWith(STATS_PREFIX);
+    }
+    
+    /**
+     * Record a telemetry snapshot (`STATS:{json}`)
+     */
+    public final void record(final String message) {
+        final String json = message.substring(STATS_PREFIX.length());
+        latestSnapshot.set(json);
+        lastSnapshotTime = System.currentTimeMillis();
+        snapshotCount.incrementAndGet();
+        
+        _log.info("[Telemetry] {}s window: send p50={}ms p99={}ms, capture p99={}ms, loop max={}ms, command wait max={}ms, frame avg={}B, heap min={}B, psram min={}B, reconnects={}, send failures={}, allocs={}, boot to first frame={}ms",
+                field(json, null, "winMs") / 1000,
+                millis(field(json, "sendUs", "p50")),
+                millis(field(json, "sendUs", "p99")),
+                millis(field(json, "capUs", "p99")),
+                millis(field(json, "loopUs", "max")),
+                millis(field(json, "gapUs", "max")),
+                field(json, "frameB", "avg"),
+                field(json, "heap", "min"),
+                field(json, "psram", "min"),
+                field(json, null, "reconnects"),
+                field(json, "sendFail", "total"),
+                field(json, "allocs", "win"),
+                field(json, "boot", "frameMs"));
+    }
+    
+    /**
+     * Latest snapshot JSON (null until the ESP32 published one)
+     */
+    public final String getLatestSnapshot() {
+        return latestSnapshot.get();
+    }
+    
+    /**
+     * Age of the latest snapshot in milliseconds (-1 if none)
+     */
+    public final long getSnapshotAgeMs() {
+        return lastSnapshotTime == 0 ? -1 : System.currentTimeMillis() - lastSnapshotTime;
+    }
+    
+    public final long getSnapshotCount() {
+        return snapshotCount.get();
+    }
+    
+    /**
+     * Integer field of the flat snapshot JSON
+     * - The firmware format is fixed: `"object":{"key":N,...}` or top-level `"key":N`
+     * @param object Enclosing object name (null = top level)
+     * @return Value, or -1 if the field is missing
+     */
+    static long field(final String json, final String object, final String key) {
+        int from = 0;
+        int to = json.length();
+        if (object != null) {
+            final int start = json.indexOf("\"" + object + "\":{");
+            if (start < 0) {
+                return -1;
+            }
+            from = start;
+            to = json.indexOf('}', start);
+            if (to < 0) {
+                return -1;
+            }
+        }
+        final String name = "\"" + key + "\":";
+        final int pos = json.indexOf(name, from);
+        if (pos < 0 || pos >= to) {
+            return -1;
+        }
+        int index = pos + name.length();
+        long value = 0;
+        boolean digits = false;
+        while (index < json.length() && json.charAt(index) >= '0' && json.charAt(index) <= '9') {
+            value = value * 10 + (json.charAt(index) - '0');
+            index++;
+            digits = true;
+        }
+        return digits ? value : -1;
+    }
+    
+    private static String millis(final long micros) {
+        return micros < 0 ? "-" : String.format("%.1f", micros / 1000.0);
+    }
+}
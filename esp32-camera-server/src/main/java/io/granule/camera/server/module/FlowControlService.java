@@ -0,0 +1,136 @@
+/**
+ * `FlowControlService.java`
+ * - Frame credits for the ESP32 live upload (`CREDIT:<n>`, see FLOW_CONTROL_PROTOCOL.md)
+ * - Handles: the window granted on connect, one credit returned per live frame once the
+ *   consumers' sockets have taken it (or after a maximum hold), per-device bookkeeping
+ * - Without this the relay queues every frame a slow viewer cannot take yet, and the viewer's
+ *   picture falls further behind the camera every second
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+package io.granule.camera.server.module;
+
+import org.java_websocket.WebSocket;
+import org.slf4j.Logger;
+import org.slf4j.LoggerFactory;
+
+import java.util.ArrayDeque;
+import java.util.Deque;
+import java.util.HashMap;
+import java.util.Map;
+import java.util.concurrent.ConcurrentHashMap;
+import java.util.concurrent.atomic.AtomicLong;
+
+/**
+ * Flow Control Service
+ * Returns upload credits to each device as its frames leave the relay
+ */
+public class FlowControlService {
+    private static final Logger _log = LoggerFactory.getLogger(FlowControlService.class);
+
+    public static final String GRANT_PREFIX = "CREDIT:";
+    public static final String STATUS_PREFIX = "CREDIT_STATUS:";
+
+    private final int window;
+    private final long maxHoldMs;
+
+    // Relay time of each live frame whose credit is not returned yet (per device)
+    private final Map<WebSocket, Deque<Long>> pending = new ConcurrentHashMap<>();
+    private final AtomicLong creditsReturned = new AtomicLong();
+    private final AtomicLong creditsForced = new AtomicLong();
+
+    /**
+     * @param window Frames a device may have in flight
+     * @param maxHoldMs Credit returned after this long even if a consumer is still behind
+     */
+    public FlowControlService(final int window, final long maxHoldMs) {
+        this.window = window;
+        this.maxHoldMs = maxHoldMs;
+    }
+
+    /**
+     * Register a device and get its initial grant (the whole window)
+     */
+    public final String addDevice(final WebSocket device) {
+        pending.put(device, new ArrayDeque<>());
+        _log.info("[Flow] Granting {} frame credits to {}", window, device.getRemoteSocketAddress());
+        return GRANT_PREFIX + window;
+    }
+
+    /**
+     * Forget a device (no-op for other connections)
+     */
+    public final void removeDevice(final WebSocket device) {
+        pending.remove(device);
+    }
+
+    /**
+     * A live frame from the device was handed to the consumers' sockets
+     */
+    public final void onFrameRelayed(final WebSocket device, final long nowMs) {
+        final Deque<Long> frames = pending.get(device);
+        if (frames != null) {
+            synchronized (frames) {
+                frames.addLast(nowMs);
+            }
+        }
+    }
+
+    /**
+     * Credits due per device
+     * @param drained No consumer has unsent data (every relayed frame is on its way)
+     * @return devices with at least one credit to return
+     */
+    public final Map<WebSocket, Integer> takeDueCredits(final boolean drained, final long nowMs) {
+        final Map<WebSocket, Integer> due = new HashMap<>();
+        for (final Map.Entry<WebSocket, Deque<Long>> entry : pending.entrySet()) {
+            final Deque<Long> frames = entry.getValue();
+            int credits = 0;
+            int forced = 0;
+            synchronized (frames) {
+                while (!frames.isEmpty()) {
+                    final boolean expired = nowMs - frames.peekFirst() >= maxHoldMs;
+                    if (!drained && !expired) {
+                        break;
+                    }
+                    frames.pollFirst();
+                    credits++;
+                    if (!drained) {
+                        forced++;
+                    }
+                }
+            }
+            if (credits > 0) {
+                due.put(entry.getKey(), credits);
+                creditsReturned.addAndGet(credits);
+                creditsForced.addAndGet(forced);
+            }
+        }
+        return due;
+    }
+
+    /**
+     * Grant message for a number of credits
+     */
+    public final String grantCommand(final int credits) {
+        return GRANT_PREFIX + credits;
+    }
+
+    public final int getWindow() {
+        return window;
+    }
+
+    public final long getCreditsReturned() {
+        return creditsReturned.get();
+    }
+
+    /**
+     * Credits returned after maxHoldMs while a consumer was still behind
+     */
+    public final long getCreditsForced() {
+        return creditsForced.get();
+    }
+}
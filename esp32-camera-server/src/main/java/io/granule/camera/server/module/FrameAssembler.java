@@ -0,0 +1,126 @@
+/**
+ * `FrameAssembler.java`
+ * - Chunked frame reassembly (see esp32-camera-firmware/lib/FrameChunker/FrameChunker.h)
+ * - The ESP32 sends large frames in parts so it can answer commands between them:
+ *   [envelope with FLAG_CHUNKED][first chunk], then [part header "CAP"][next chunk] ...
+ * - Viewers and analyzers get the whole frame with FLAG_CHUNKED cleared, as before
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+package io.granule.camera.server.module;
+
+import org.java_websocket.WebSocket;
+import org.slf4j.Logger;
+import org.slf4j.LoggerFactory;
+
+import java.nio.ByteBuffer;
+import java.util.Map;
+import java.util.concurrent.ConcurrentHashMap;
+import java.util.concurrent.atomic.AtomicLong;
+
+/**
+ * Frame Assembler
+ * Joins the parts of chunked frames, one frame in flight per ESP32 connection
+ */
+public class FrameAssembler {
+    private static final Logger _log = LoggerFactory.getLogger(FrameAssembler.class);
+    
+    // Part header (v1, big-endian): magic "CAP" (3), version (1), sequence (4), payload offset (4)
+    public static final int PART_HEADER_SIZE = 12;
+    private static final int MAX_FRAME_SIZE = 512 * 1024;
+    
+    private final Map<WebSocket, Pending> pending = new ConcurrentHashMap<>();
+    private final AtomicLong framesAssembled = new AtomicLong(0);
+    private final AtomicLong partsDropped = new AtomicLong(0);
+    
+    private record Pending(long sequence, int headerLength, ByteBuffer frame) {}
+    
+    /**
+     * Feed one binary message from an ESP32
+     * @return the message to relay (whole frame, or the message itself if it is not chunked),
+     *         null while a frame is incomplete or when a part was dropped
+     */
+    public final ByteBuffer accept(final WebSocket conn, final ByteBuffer message) {
+        final FrameEnvelope envelope = FrameEnvelope.decodeHeader(message);
+        if (envelope != null) {
+            if (!envelope.isChunked()) {
+                return message;
+            }
+            // A new first part abandons an unfinished frame
+            final int expected = envelope.headerLength() + envelope.payloadLength();
+            if (expected > MAX_FRAME_SIZE || message.remaining() > expected) {
+                drop(conn, "first part of " + expected + " bytes");
+                return null;
+            }
+            final ByteBuffer frame = ByteBuffer.allocate(expected);
+            frame.put(message.duplicate());
+            frame.put(5, (byte) (frame.get(5) & ~FrameEnvelope.FLAG_CHUNKED));
+            final Pending state = new Pending(envelope.sequence(), envelope.headerLength(), frame);
+            pending.put(conn, state);
+            return complete(conn, state);
+        }
+        
+        if (!isPart(message)) {
+            return message;
+        }
+        final int base = message.position();
+        final long sequence = message.getInt(base + 4) & 0xFFFFFFFFL;
+        final long offset = message.getInt(base + 8) & 0xFFFFFFFFL;
+        final int length = message.remaining() - PART_HEADER_SIZE;
+        final Pending state = pending.get(conn);
+        if (state == null || sequence != state.sequence()
+                || state.headerLength() + offset != state.frame().position()
+                || length > state.frame().remaining()) {
+            drop(conn, "part " + sequence + "@" + offset);
+            return null;
+        }
+        final ByteBuffer chunk = message.duplicate();
+        chunk.position(base + PART_HEADER_SIZE);
+        state.frame().put(chunk);
+        return complete(conn, state);
+    }
+    
+    /**
+     * Forget the pending frame of a closed connection
+     */
+    public final void remove(final WebSocket conn) {
+        pending.remove(conn);
+    }
+    
+    public final long getFramesAssembled() {
+        return framesAssembled.get();
+    }
+    
+    public final long getPartsDropped() {
+        return partsDropped.get();
+    }
+    
+    /**
+     * Check for the part magic (envelopes start with "CAM", raw JPEG with FF D8)
+     */
+    public static boolean isPart(final ByteBuffer data) {
+        final int base = data.position();
+        return data.remaining() >= PART_HEADER_SIZE
+                && data.get(base) == 'C' && data.get(base + 1) == 'A' && data.get(base + 2) == 'P'
+                && (data.get(base + 3) & 0xFF) >= 1;
+    }
+    
+    private ByteBuffer complete(final WebSocket conn, final Pending state) {
+        if (state.frame().hasRemaining()) {
+            return null;
+        }
+        pending.remove(conn, state);
+        framesAssembled.incrementAndGet();
+        state.frame().flip();
+        return state.frame();
+    }
+    
+    private void drop(final WebSocket conn, final String what) {
+        pending.remove(conn);
+        final long dropped = partsDropped.incrementAndGet();
+        _log.debug("Dropped chunked frame data: {} ({} total)", what, dropped);
+    }
+}
@@ -0,0 +1,184 @@
+/**
+ * `FrameEnvelope.java`
+ * - Frame envelope decoder (see esp32-camera-firmware/lib/FrameEnvelope/FrameEnvelope.h)
+ * - Handles: Envelope parsing, clock sync PING/PONG replies
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+package io.granule.camera.server.module;
+
+import java.nio.ByteBuffer;
+import java.time.Instant;
+
+/**
+ * Frame Envelope
+ * Versioned header the ESP32 sends in front of each JPEG frame (big-endian, 48 bytes in v1)
+ */
+public record FrameEnvelope(
+        int version,
+        int headerLength,
+        int flags,
+        int jpegQuality,
+        int frameSize,
+        long sequence,
+        long captureUs,
+        long sendUs,
+        long clockOffsetUs,
+        int payloadLength,
+        int width,
+        int height,
+        int motionScore,
+        int headerId) {
+
+    public static final int HEADER_SIZE_V1 = 48;
+    public static final int FLAG_CLOCK_SYNCED = 0x01;
+    public static final int FLAG_MOTION = 0x02;
+    public static final int FLAG_HISTORICAL = 0x04;
+    public static final int FLAG_RECORDED = 0x08;
+    public static final int FLAG_CHUNKED = 0x10;
+    public static final int FLAG_HEADER_DEFINED = 0x20;
+    public static final int FLAG_HEADER_ELIDED = 0x40;
+    public static final int FLAG_SNAPSHOT = 0x80;
+
+    /**
+     * Decode the envelope at the buffer position (position is not changed)
+     * @return null for raw JPEG, malformed envelopes or an incomplete payload
+     */
+    public static FrameEnvelope decode(final ByteBuffer data) {
+        final FrameEnvelope envelope = decodeHeader(data);
+        if (envelope == null || (long) envelope.headerLength + envelope.payloadLength > data.remaining()) {
+            return null;
+        }
+        return envelope;
+    }
+
+    /**
+     * Decode the envelope header only (the payload may be incomplete: first part of a chunked frame)
+     * @return null for raw JPEG or malformed envelopes
+     */
+    public static FrameEnvelope decodeHeader(final ByteBuffer data) {
+        final int base = data.position();
+        final int length = data.remaining();
+        if (length < HEADER_SIZE_V1
+                || data.get(base) != 'C' || data.get(base + 1) != 'A' || data.get(base + 2) != 'M') {
+            return null;
+        }
+        final int version = data.get(base + 3) & 0xFF;
+        final int headerLength = data.get(base + 4) & 0xFF;
+        final int payloadLength = data.getInt(base + 36);
+        if (version < 1 || headerLength < HEADER_SIZE_V1 || headerLength > length || payloadLength < 0) {
+            return null;
+        }
+        return new FrameEnvelope(
+                version,
+                headerLength,
+                data.get(base + 5) & 0xFF,
+                data.get(base + 6) & 0xFF,
+                data.get(base + 7) & 0xFF,
+                data.getInt(base + 8) & 0xFFFFFFFFL,
+                data.getLong(base + 12),
+                data.getLong(base + 20),
+                data.getLong(base + 28),
+                payloadLength,
+                data.getShort(base + 40) & 0xFFFF,
+                data.getShort(base + 42) & 0xFFFF,
+                data.getShort(base + 44) & 0xFFFF,
+                data.getShort(base + 46) & 0xFFFF);
+    }
+
+    /**
+     * JPEG payload view (envelope stripped)
+     */
+    public ByteBuffer payload(final ByteBuffer data) {
+        final ByteBuffer view = data.duplicate();
+        view.position(data.position() + headerLength);
+        view.limit(data.position() + headerLength + payloadLength);
+        return view.slice();
+    }
+
+    public boolean isClockSynced() {
+        return (flags & FLAG_CLOCK_SYNCED) != 0;
+    }
+
+    public boolean isMotion() {
+        return (flags & FLAG_MOTION) != 0;
+    }
+    
+    /**
+     * Frame recorded during an outage and backfilled after reconnect
+     * (own sequence space, not part of the live stream)
+     */
+    public boolean isHistorical() {
+        return (flags & FLAG_HISTORICAL) != 0;
+    }
+    
+    /**
+     * Frame read back from the device's microSD recording (REC_EXPORT reply, also historical)
+     */
+    public boolean isRecorded() {
+        return (flags & FLAG_RECORDED) != 0;
+    }
+
+    /**
+     * First part of a frame sent in parts (FrameAssembler joins the rest)
+     */
+    public boolean isChunked() {
+        return (flags & FLAG_CHUNKED) != 0;
+    }
+
+    /**
+     * Whole JPEG whose preamble the device elides from later frames with the same headerId
+     */
+    public boolean isHeaderDefined() {
+        return (flags & FLAG_HEADER_DEFINED) != 0;
+    }
+
+    /**
+     * Scan data only: the JPEG preamble of headerId was left out (CompactFrameService restores it)
+     */
+    public boolean isHeaderElided() {
+        return (flags & FLAG_HEADER_ELIDED) != 0;
+    }
+
+    /**
+     * High-resolution still (SNAPSHOT reply, uploaded in "SNP" parts; SnapshotService joins them)
+     */
+    public boolean isSnapshot() {
+        return (flags & FLAG_SNAPSHOT) != 0;
+    }
+
+    /**
+     * Device timestamp mapped to the server clock (epoch microseconds)
+     */
+    public long toServerUs(final long deviceUs) {
+        return deviceUs + clockOffsetUs;
+    }
+
+    /**
+     * Server clock for latency measurement and clock sync (epoch microseconds)
+     */
+    public static long nowMicros() {
+        final Instant now = Instant.now();
+        return now.getEpochSecond() * 1_000_000L + now.getNano() / 1_000;
+    }
+
+    /**
+     * Answer a clock sync ping: "PING:<seq>:<t0>" → "PONG:<seq>:<t0>:<t1>:<t2>"
+     * @param receiveUs Server time when the ping arrived (t1)
+     * @return null if the message is not a valid ping
+     */
+    public static String makePong(final String ping, final long receiveUs) {
+        final String[] parts = ping.split(":");
+        if (parts.length < 3 || !parts[0].equals("PING") || !isDigits(parts[1]) || !isDigits(parts[2])) {
+            return null;
+        }
+        return "PONG:" + parts[1] + ":" + parts[2] + ":" + receiveUs + ":" + nowMicros();
+    }
+
+    private static boolean isDigits(final String text) {
+        return !text.isEmpty() && text.chars().allMatch(c -> c >= '0' && c <= '9');
+    }
+}
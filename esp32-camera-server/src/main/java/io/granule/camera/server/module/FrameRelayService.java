@@ -2,9 +2,13 @@
  * `FrameRelayService.java`
  * - Frame relay service module
  * - Handles: Frame counting, data tracking, relay statistics
+ * - Enveloped frames: per-hop latency percentiles, sequence gaps and reordering
+ * - Backfilled (historical) frames are counted apart from the live stream
  *
  * @author      Sim Woo-Keun <smileteeth14@gmail.com>
  * @date        2026-02-18 initial version
+ * @date        2026-10-16 frame envelope latency/gap tracking
+ * @date        2026-10-16 outage backfill counters
  *
  * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
  */
@@ -13,6 +17,7 @@ package io.granule.camera.server.module;
 import org.slf4j.Logger;
 import org.slf4j.LoggerFactory;
 
+import java.util.Arrays;
 import java.util.concurrent.atomic.AtomicLong;
 
 /**
@@ -22,9 +27,22 @@ import java.util.concurrent.atomic.AtomicLong;
 public class FrameRelayService {
     private static final Logger _log = LoggerFactory.getLogger(FrameRelayService.class);
     
+    private static final int LATENCY_WINDOW = 256;  // Samples per hop for percentiles
+    
     private final AtomicLong totalFramesReceived = new AtomicLong(0);
     private final AtomicLong totalBytesReceived = new AtomicLong(0);
     
+    // Envelope tracking (guarded by sequenceLock)
+    private final Object sequenceLock = new Object();
+    private long lastSequence = -1;
+    private long sequenceGaps = 0;
+    private long framesLost = 0;
+    private long framesReordered = 0;
+    private long framesBackfilled = 0;
+    private final LatencyWindow captureToSend = new LatencyWindow();
+    private final LatencyWindow sendToServer = new LatencyWindow();
+    private final LatencyWindow captureToServer = new LatencyWindow();
+    
     /**
      * Record received frame
      */
@@ -36,6 +54,55 @@ public class FrameRelayService {
         if (frameCount % 100 == 0) {
             _log.info("[Frame] Total frames: {}, Total data: {} MB", 
                      frameCount, totalBytesReceived.get() / 1024 / 1024);
+            logLatency();
+        }
+    }
+    
+    /**
+     * Record envelope of a received frame (call before recordFrame)
+     * @param receiveUs Server time when the frame arrived (epoch microseconds)
+     */
+    public final void recordEnvelope(final FrameEnvelope envelope, final long receiveUs) {
+        synchronized (sequenceLock) {
+            if (envelope.isHistorical()) {
+                // Own sequence space and old capture times: keep out of live gap/latency stats
+                framesBackfilled++;
+                return;
+            }
+            final long sequence = envelope.sequence();
+            if (lastSequence >= 0) {
+                if (sequence > lastSequence + 1) {
+                    sequenceGaps++;
+                    framesLost += sequence - lastSequence - 1;
+                } else if (sequence <= lastSequence) {
+                    // Device restart also lands here (sequence starts over)
+                    framesReordered++;
+                }
+            }
+            if (lastSequence < 0 || sequence > lastSequence || lastSequence - sequence > 1000) {
+                lastSequence = sequence;
+            }
+        
+            captureToSend.add(envelope.sendUs() - envelope.captureUs());
+            if (envelope.isClockSynced()) {
+                sendToServer.add(receiveUs - envelope.toServerUs(envelope.sendUs()));
+                captureToServer.add(receiveUs - envelope.toServerUs(envelope.captureUs()));
+            }
+        }
+    }
+    
+    /**
+     * Log latency percentiles and sequence counters
+     */
+    private void logLatency() {
+        synchronized (sequenceLock) {
+            if (lastSequence < 0) {
+                return;
+            }
+            _log.info("[Frame] Latency ms p50/p90/p99 - capture→send {}, send→server {}, capture→server {}",
+                     captureToSend.summary(), sendToServer.summary(), captureToServer.summary());
+            _log.info("[Frame] Sequence #{}: gaps {}, lost {}, reordered {}, backfilled {}",
+                     lastSequence, sequenceGaps, framesLost, framesReordered, framesBackfilled);
         }
     }
     
@@ -52,4 +119,34 @@ public class FrameRelayService {
     public final long getTotalBytes() {
         return totalBytesReceived.get();
     }
+    
+    /**
+     * Fixed-size ring of latency samples (microseconds)
+     */
+    private static final class LatencyWindow {
+        private final long[] samples = new long[LATENCY_WINDOW];
+        private int count = 0;
+        private int next = 0;
+        
+        void add(final long valueUs) {
+            samples[next] = valueUs;
+            next = (next + 1) % samples.length;
+            count = Math.min(count + 1, samples.length);
+        }
+        
+        String summary() {
+            if (count == 0) {
+                return "-";
+            }
+            final long[] sorted = Arrays.copyOf(samples, count);
+            Arrays.sort(sorted);
+            return "%.1f/%.1f/%.1f".formatted(
+                    percentile(sorted, 50), percentile(sorted, 90), percentile(sorted, 99));
+        }
+        
+        private static double percentile(final long[] sorted, final int p) {
+            final int index = Math.min(sorted.length - 1, (int) Math.round(p / 100.0 * (sorted.length - 1)));
+            return sorted[index] / 1000.0;
+        }
+    }
 }
@@ -1,7 +1,7 @@
 /**
  * `LedStateManager.java`
  * - LED state management module
- * - Handles: LED status tracking, state updates, command counting
+ * - Handles: LED status tracking, state updates, command counting, command round trip
  *
  * @author      Sim Woo-Keun <smileteeth14@gmail.com>
  * @date        2026-02-18 initial version
@@ -25,15 +25,38 @@ public class LedStateManager {
     private volatile String currentLedStatus = "LED_STATUS:OFF";
     private final Object ledStateLock = new Object();
     private final AtomicLong totalLedCommands = new AtomicLong(0);
+    private final AtomicLong pendingCommandNanos = new AtomicLong(0);  // forwarded, reply outstanding
+    private final AtomicLong lastRoundTripMs = new AtomicLong(-1);
     
     /**
      * Update LED status
      */
     public final void updateStatus(final String status) {
+        final long sentNanos = pendingCommandNanos.getAndSet(0);
         synchronized (ledStateLock) {
             currentLedStatus = status;
             _log.info("[LED] State updated: {}", currentLedStatus);
         }
+        if (sentNanos != 0) {
+            final long roundTripMs = (System.nanoTime() - sentNanos) / 1_000_000L;
+            lastRoundTripMs.set(roundTripMs);
+            _log.info("[LED] Command round trip: {} ms", roundTripMs);
+        }
+    }
+    
+    /**
+     * Mark an LED command forwarded to the ESP32 (the round trip ends at its LED_STATUS reply;
+     * the device answers between frame parts, so this should not grow with the frame size)
+     */
+    public final void markCommandForwarded() {
+        pendingCommandNanos.compareAndSet(0, System.nanoTime());
+    }
+    
+    /**
+     * Last LED command round trip (ms, -1 if none yet)
+     */
+    public final long getLastRoundTripMs() {
+        return lastRoundTripMs.get();
     }
     
     /**
@@ -0,0 +1,114 @@
+/**
+ * `LumaRelayService.java`
+ * - Gray plane side-stream (see esp32-camera-firmware/lib/LumaStream/LumaStream.h)
+ * - The ESP32 sends a small delta-coded luminance plane ("LUM" messages) next to the JPEG frames;
+ *   it goes to the analyzers only (they skip the JPEG decode), viewers never see it
+ * - Planes hold no flow credit (a few hundred bytes, sent between frames)
+ * - A new analyzer has no reference plane: the device is asked for a key plane (`LUMA:KEY`)
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+package io.granule.camera.server.module;
+
+import org.slf4j.Logger;
+import org.slf4j.LoggerFactory;
+
+import java.nio.ByteBuffer;
+import java.util.concurrent.atomic.AtomicLong;
+import java.util.concurrent.atomic.AtomicReference;
+
+/**
+ * Luma Relay Service
+ * Recognises gray planes from the ESP32 and keeps the side-stream counters
+ */
+public class LumaRelayService {
+    private static final Logger _log = LoggerFactory.getLogger(LumaRelayService.class);
+
+    public static final String STATUS_PREFIX = "LUMA_STATUS:";
+    public static final String KEY_COMMAND = "LUMA:KEY";
+
+    // Plane header (v1, big-endian): magic "LUM" (3), version (1), header length (1), flags (1), ...
+    public static final int HEADER_SIZE = 36;
+    private static final int FLAGS_OFFSET = 5;
+    private static final int FLAG_KEY = 0x01;
+
+    private final String intervalCommand;
+    private final AtomicLong planesRelayed = new AtomicLong(0);
+    private final AtomicLong keyPlanes = new AtomicLong(0);
+    private final AtomicLong bytesRelayed = new AtomicLong(0);
+    private final AtomicReference<String> latestStatus = new AtomicReference<>(null);
+
+    /**
+     * @param intervalMs Plane interval pushed to each ESP32 on connect (null = device default)
+     */
+    public LumaRelayService(final Integer intervalMs) {
+        this.intervalCommand = intervalMs != null ? "LUMA:" + intervalMs : null;
+    }
+
+    /**
+     * Check for the plane magic (frame envelopes start with "CAM", snapshot parts with "SNP")
+     */
+    public static boolean isPlane(final ByteBuffer message) {
+        final int base = message.position();
+        return message.remaining() >= HEADER_SIZE
+                && message.get(base) == 'L' && message.get(base + 1) == 'U' && message.get(base + 2) == 'M';
+    }
+
+    /**
+     * Count a plane that goes to the analyzers
+     */
+    public final void recordPlane(final ByteBuffer message) {
+        final long planes = planesRelayed.incrementAndGet();
+        bytesRelayed.addAndGet(message.remaining());
+        if ((message.get(message.position() + FLAGS_OFFSET) & FLAG_KEY) != 0) {
+            keyPlanes.incrementAndGet();
+        }
+        if (planes % 500 == 0) {
+            _log.info("[Luma] {} planes relayed ({} key, avg {}B)", planes, keyPlanes.get(),
+                    bytesRelayed.get() / planes);
+        }
+    }
+
+    /**
+     * Interval command for a newly connected ESP32 (null = keep the device default)
+     */
+    public final String getIntervalCommand() {
+        return intervalCommand;
+    }
+
+    public final boolean isStatus(final String message) {
+        return message.startsWith(STATUS_PREFIX);
+    }
+
+    /**
+     * Record the device side of the stream (`LUMA_STATUS:{json}`)
+     */
+    public final void recordStatus(final String message) {
+        latestStatus.set(message);
+        final String json = message.substring(STATUS_PREFIX.length());
+        _log.info("[Luma] ESP32 every {}ms {}x{}: sent {} (key {}), failed {}",
+                DeviceTelemetryService.field(json, null, "intervalMs"),
+                DeviceTelemetryService.field(json, null, "width"), DeviceTelemetryService.field(json, null, "height"),
+                DeviceTelemetryService.field(json, null, "sent"), DeviceTelemetryService.field(json, null, "keyPlanes"),
+                DeviceTelemetryService.field(json, null, "failed"));
+    }
+
+    public final String getLatestStatus() {
+        return latestStatus.get();
+    }
+
+    public final long getPlanesRelayed() {
+        return planesRelayed.get();
+    }
+
+    public final long getKeyPlanes() {
+        return keyPlanes.get();
+    }
+
+    public final long getBytesRelayed() {
+        return bytesRelayed.get();
+    }
+}
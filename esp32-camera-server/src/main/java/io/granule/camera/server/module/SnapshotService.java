@@ -0,0 +1,211 @@
+/**
+ * `SnapshotService.java`
+ * - High-resolution still reassembly (see esp32-camera-firmware/lib/SnapshotCapture/SnapshotCapture.h)
+ * - The ESP32 uploads a SNAPSHOT in "SNP" parts between live frames (lower priority than the stream);
+ *   the joined parts are an envelope with FLAG_SNAPSHOT followed by the JPEG
+ * - Keeps the latest still in memory and optionally writes each one to a directory;
+ *   stills are not relayed to viewers or analyzers (they are not part of the live stream)
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+package io.granule.camera.server.module;
+
+import org.java_websocket.WebSocket;
+import org.slf4j.Logger;
+import org.slf4j.LoggerFactory;
+
+import java.io.IOException;
+import java.nio.ByteBuffer;
+import java.nio.file.Files;
+import java.nio.file.Path;
+import java.util.Map;
+import java.util.concurrent.ConcurrentHashMap;
+import java.util.concurrent.atomic.AtomicLong;
+import java.util.concurrent.atomic.AtomicReference;
+
+/**
+ * Snapshot Service
+ * Joins the parts of snapshot uploads, one upload in flight per ESP32 connection
+ */
+public class SnapshotService {
+    private static final Logger _log = LoggerFactory.getLogger(SnapshotService.class);
+
+    public static final String STATUS_PREFIX = "SNAPSHOT_STATUS:";
+
+    // Part header (v1, big-endian): magic "SNP" (3), version (1), snapshot id (4), offset (4), total length (4)
+    public static final int PART_HEADER_SIZE = 16;
+    private static final int MAX_SNAPSHOT_SIZE = 2 * 1024 * 1024;
+
+    private final String directory;
+    private final Map<WebSocket, Pending> pending = new ConcurrentHashMap<>();
+    private final AtomicReference<Snapshot> latest = new AtomicReference<>(null);
+    private final AtomicReference<String> latestStatus = new AtomicReference<>(null);
+    private final AtomicLong snapshotsReceived = new AtomicLong(0);
+    private final AtomicLong partsDropped = new AtomicLong(0);
+
+    private record Pending(long id, long startedMs, ByteBuffer data) {}
+
+    /**
+     * Reassembled still
+     * @param envelope Envelope (sequence = snapshot id, frameSize/quality of the still)
+     * @param data     Envelope followed by the JPEG
+     */
+    public record Snapshot(FrameEnvelope envelope, ByteBuffer data, long receivedMs, long uploadMs) {
+        public ByteBuffer jpeg() {
+            return envelope.payload(data);
+        }
+    }
+
+    /**
+     * @param directory Where to write each still (null = memory only)
+     */
+    public SnapshotService(final String directory) {
+        this.directory = directory;
+    }
+
+    public final boolean isStatus(final String message) {
+        return message.startsWith(STATUS_PREFIX);
+    }
+
+    /**
+     * Record a snapshot result (`SNAPSHOT_STATUS:{json}`: captured / failed / rejected / uploaded)
+     */
+    public final void recordStatus(final String message) {
+        latestStatus.set(message);
+        final String json = message.substring(STATUS_PREFIX.length());
+        final String state = StreamProfileService.text(json, "state");
+        if ("captured".equals(state)) {
+            _log.info("[Snapshot] ESP32 captured #{} {} q{} {}B (switch {}ms, restore {}ms, live gap {}ms, re-init {})",
+                    DeviceTelemetryService.field(json, null, "id"), StreamProfileService.text(json, "frameSize"),
+                    DeviceTelemetryService.field(json, null, "quality"), DeviceTelemetryService.field(json, null, "bytes"),
+                    DeviceTelemetryService.field(json, null, "switchMs"),
+                    DeviceTelemetryService.field(json, null, "restoreMs"),
+                    DeviceTelemetryService.field(json, null, "gapMs"), json.contains("\"reinit\":true"));
+        } else if ("failed".equals(state) || "rejected".equals(state)) {
+            _log.warn("[Snapshot] ESP32 {}: {}", state, StreamProfileService.text(json, "error"));
+        } else {
+            _log.info("[Snapshot] ESP32 {}", message);
+        }
+    }
+
+    /**
+     * Feed one binary message from an ESP32
+     * @return true if it was a snapshot part (consumed here), false for anything else
+     */
+    public final boolean accept(final WebSocket conn, final ByteBuffer message) {
+        if (!isPart(message)) {
+            return false;
+        }
+        final int base = message.position();
+        final long id = message.getInt(base + 4) & 0xFFFFFFFFL;
+        final long offset = message.getInt(base + 8) & 0xFFFFFFFFL;
+        final long total = message.getInt(base + 12) & 0xFFFFFFFFL;
+        final int length = message.remaining() - PART_HEADER_SIZE;
+
+        // The first part starts an upload (also one started over after a reconnect)
+        Pending state = pending.get(conn);
+        if (offset == 0) {
+            if (total < FrameEnvelope.HEADER_SIZE_V1 || total > MAX_SNAPSHOT_SIZE) {
+                drop(conn, "snapshot " + id + " of " + total + " bytes");
+                return true;
+            }
+            state = new Pending(id, System.currentTimeMillis(), ByteBuffer.allocate((int) total));
+            pending.put(conn, state);
+        }
+        if (state == null || id != state.id() || offset != state.data().position()
+                || length > state.data().remaining()) {
+            drop(conn, "part " + id + "@" + offset);
+            return true;
+        }
+        final ByteBuffer chunk = message.duplicate();
+        chunk.position(base + PART_HEADER_SIZE);
+        state.data().put(chunk);
+        if (!state.data().hasRemaining()) {
+            pending.remove(conn, state);
+            complete(state);
+        }
+        return true;
+    }
+
+    /**
+     * Forget the pending upload of a closed connection
+     */
+    public final void remove(final WebSocket conn) {
+        pending.remove(conn);
+    }
+
+    /**
+     * Latest reassembled still (null until one arrived)
+     */
+    public final Snapshot getLatest() {
+        return latest.get();
+    }
+
+    public final String getLatestStatus() {
+        return latestStatus.get();
+    }
+
+    public final long getSnapshotsReceived() {
+        return snapshotsReceived.get();
+    }
+
+    public final long getPartsDropped() {
+        return partsDropped.get();
+    }
+
+    /**
+     * Check for the part magic (envelopes start with "CAM", chunk parts with "CAP")
+     */
+    public static boolean isPart(final ByteBuffer data) {
+        final int base = data.position();
+        return data.remaining() >= PART_HEADER_SIZE
+                && data.get(base) == 'S' && data.get(base + 1) == 'N' && data.get(base + 2) == 'P'
+                && (data.get(base + 3) & 0xFF) >= 1;
+    }
+
+    private void complete(final Pending state) {
+        final ByteBuffer data = state.data();
+        data.flip();
+        final FrameEnvelope envelope = FrameEnvelope.decode(data);
+        if (envelope == null || !envelope.isSnapshot()) {
+            final long dropped = partsDropped.incrementAndGet();
+            _log.warn("[Snapshot] #{}: not a snapshot envelope ({} dropped)", state.id(), dropped);
+            return;
+        }
+        final long now = System.currentTimeMillis();
+        final Snapshot snapshot = new Snapshot(envelope, data.asReadOnlyBuffer(), now, now - state.startedMs());
+        latest.set(snapshot);
+        snapshotsReceived.incrementAndGet();
+        _log.info("[Snapshot] #{} received: {}x{} {} bytes in {} ms",
+                envelope.sequence(), envelope.width(), envelope.height(), envelope.payloadLength(),
+                snapshot.uploadMs());
+        save(snapshot);
+    }
+
+    private void save(final Snapshot snapshot) {
+        if (directory == null) {
+            return;
+        }
+        final Path path = Path.of(directory,
+                "snapshot-%d-%d.jpg".formatted(snapshot.envelope().sequence(), snapshot.receivedMs()));
+        final ByteBuffer jpeg = snapshot.jpeg();
+        final byte[] bytes = new byte[jpeg.remaining()];
+        jpeg.get(bytes);
+        try {
+            Files.createDirectories(path.getParent());
+            Files.write(path, bytes);
+            _log.info("[Snapshot] Saved {}", path);
+        } catch (final IOException e) {
+            _log.error("[Snapshot] Could not save {}: {}", path, e.getMessage());
+        }
+    }
+
+    private void drop(final WebSocket conn, final String what) {
+        pending.remove(conn);
+        final long dropped = partsDropped.incrementAndGet();
+        _log.debug("Dropped snapshot data: {} ({} total)", what, dropped);
+    }
+}
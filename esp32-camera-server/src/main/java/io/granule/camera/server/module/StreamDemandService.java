@@ -0,0 +1,111 @@
+/**
+ * `StreamDemandService.java`
+ * - Consumer set announced to the ESP32 (`DEMAND:<live>:<analyzer>`)
+ * - Handles: per-connection needs (viewers live, analyzers analyzer-only, hidden viewers none),
+ *   change detection so the device is told only when its upload mode may change
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+package io.granule.camera.server.module;
+
+import org.java_websocket.WebSocket;
+import org.slf4j.Logger;
+import org.slf4j.LoggerFactory;
+
+import java.util.Map;
+import java.util.concurrent.ConcurrentHashMap;
+
+/**
+ * Stream Demand Service
+ * Tracks what each consumer needs from the device stream
+ */
+public class StreamDemandService {
+    private static final Logger _log = LoggerFactory.getLogger(StreamDemandService.class);
+
+    public static final String NEED_PREFIX = "VIEWER_NEED:";
+    public static final String STATUS_PREFIX = "DEMAND_STATUS:";
+
+    /**
+     * What a consumer needs from the stream
+     */
+    public enum ConsumerNeed {
+        LIVE,        // shows the video (full rate)
+        ANALYZER,    // analyzes frames (low rate is enough)
+        NONE         // connected but not watching (hidden tab)
+    }
+
+    private final Map<WebSocket, ConsumerNeed> needs = new ConcurrentHashMap<>();
+    private final Object announceLock = new Object();
+    private String lastAnnounced = "";
+
+    /**
+     * Register a consumer
+     */
+    public final void addConsumer(final WebSocket conn, final ConsumerNeed need) {
+        needs.put(conn, need);
+    }
+
+    /**
+     * Remove a consumer (no-op for other connections)
+     */
+    public final void removeConsumer(final WebSocket conn) {
+        needs.remove(conn);
+    }
+
+    /**
+     * Check if message is a viewer need update (`VIEWER_NEED:LIVE|ANALYZER|NONE`)
+     */
+    public final boolean isNeedMessage(final String message) {
+        return message.startsWith(NEED_PREFIX);
+    }
+
+    /**
+     * Apply a viewer need update
+     * @return false if the need is unknown or the connection is not a consumer
+     */
+    public final boolean updateNeed(final WebSocket conn, final String message) {
+        final ConsumerNeed need;
+        try {
+            need = ConsumerNeed.valueOf(message.substring(NEED_PREFIX.length()).trim());
+        } catch (final IllegalArgumentException e) {
+            _log.warn("[Demand] Unknown viewer need: {}", message);
+            return false;
+        }
+        return needs.replace(conn, need) != null;
+    }
+
+    /**
+     * Current consumer set as a device command
+     */
+    public final String getDemandCommand() {
+        int live = 0;
+        int analyzer = 0;
+        for (final ConsumerNeed need : needs.values()) {
+            if (need == ConsumerNeed.LIVE) {
+                live++;
+            } else if (need == ConsumerNeed.ANALYZER) {
+                analyzer++;
+            }
+        }
+        return "DEMAND:" + live + ":" + analyzer;
+    }
+
+    /**
+     * Command to announce if the consumer set changed since the last announcement
+     * @return null if unchanged
+     */
+    public final String takeChangedCommand() {
+        final String command = getDemandCommand();
+        synchronized (announceLock) {
+            if (command.equals(lastAnnounced)) {
+                return null;
+            }
+            lastAnnounced = command;
+        }
+        _log.info("[Demand] Consumer set changed: {}", command);
+        return command;
+    }
+}
@@ -0,0 +1,137 @@
+/**
+ * `StreamProfileService.java`
+ * - ESP32 stream profile negotiation module
+ * - Handles: `CAPS:{json}` capabilities advertised on connect, `PROFILE_STATUS:{json}`
+ *   results (pending / applied with the measured switch gap / rejected), the profile to push
+ *   after the capabilities arrived (`PROFILE:<size>:<quality>:<intervalMs>[:<xclkMhz>]`)
+ *
+ * @author      Sim Woo-Keun <smileteeth14@gmail.com>
+ * @date        2026-10-16 initial version
+ *
+ * @copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+ */
+package io.granule.camera.server.module;
+
+import org.java_websocket.WebSocket;
+import org.slf4j.Logger;
+import org.slf4j.LoggerFactory;
+
+import java.util.Map;
+import java.util.concurrent.ConcurrentHashMap;
+import java.util.concurrent.atomic.AtomicReference;
+
+/**
+ * Stream Profile Service
+ * Keeps each device's capabilities and the last profile result
+ */
+public class StreamProfileService {
+    private static final Logger _log = LoggerFactory.getLogger(StreamProfileService.class);
+    
+    public static final String CAPS_PREFIX = "CAPS:";
+    public static final String STATUS_PREFIX = "PROFILE_STATUS:";
+    public static final String PROFILE_COMMAND = "PROFILE";
+    
+    private final String defaultProfile;
+    private final Map<WebSocket, String> capabilities = new ConcurrentHashMap<>();
+    private final AtomicReference<String> latestCaps = new AtomicReference<>(null);
+    private final AtomicReference<String> latestStatus = new AtomicReference<>(null);
+    
+    /**
+     * @param defaultProfile Profile pushed after CAPS (`<size>:<quality>:<intervalMs>[:<xclkMhz>]`, null = none)
+     */
+    public StreamProfileService(final String defaultProfile) {
+        this.defaultProfile = defaultProfile;
+    }
+    
+    public final boolean isCapabilities(final String message) {
+        return message.startsWith(CAPS_PREFIX);
+    }
+    
+    public final boolean isStatus(final String message) {
+        return message.startsWith(STATUS_PREFIX);
+    }
+    
+    /**
+     * Record a device's capabilities (`CAPS:{json}`)
+     * @return Command to send back (`PROFILE:...`), or null to keep the device's profile
+     */
+    public final String recordCapabilities(final WebSocket device, final String message) {
+        capabilities.put(device, message);
+        latestCaps.set(message);
+        final String json = message.substring(CAPS_PREFIX.length());
+        _log.info("[Profile] ESP32 sensor={} maxFrameSize={} psram={}B fb={}x{} ({}) xclk={}MHz",
+                text(json, "sensor"), lastFrameSize(json), DeviceTelemetryService.field(json, null, "psram"),
+                DeviceTelemetryService.field(json, "fb", "count"), text(json, "frameSize"), text(json, "location"),
+                DeviceTelemetryService.field(json, null, "xclkMhz"));
+        return defaultProfile != null ? PROFILE_COMMAND + ":" + defaultProfile : null;
+    }
+    
+    /**
+     * Record a profile result (`PROFILE_STATUS:{json}`)
+     */
+    public final void recordStatus(final String message) {
+        latestStatus.set(message);
+        final String json = message.substring(STATUS_PREFIX.length());
+        final String state = text(json, "state");
+        if ("applied".equals(state)) {
+            _log.info("[Profile] ESP32 applied {} q{} {}ms {}MHz (re-init {}ms, gap {}ms, {} buffers)",
+                    text(json, "frameSize"), DeviceTelemetryService.field(json, null, "quality"),
+                    DeviceTelemetryService.field(json, null, "intervalMs"),
+                    DeviceTelemetryService.field(json, null, "xclkMhz"),
+                    DeviceTelemetryService.field(json, null, "reinitMs"),
+                    DeviceTelemetryService.field(json, null, "gapMs"),
+                    DeviceTelemetryService.field(json, null, "fbCount"));
+        } else if ("rejected".equals(state)) {
+            _log.warn("[Profile] ESP32 rejected {}: {}", text(json, "frameSize"), text(json, "error"));
+        } else {
+            _log.info("[Profile] ESP32 {}", message);
+        }
+    }
+    
+    /**
+     * Forget a disconnected device
+     */
+    public final void removeDevice(final WebSocket device) {
+        capabilities.remove(device);
+    }
+    
+    /**
+     * Capabilities of the most recently connected device (null until one advertised them)
+     * - Sent to viewers that connect after the device
+     */
+    public final String getLatestCapabilities() {
+        return capabilities.isEmpty() ? null : latestCaps.get();
+    }
+    
+    public final String getLatestStatus() {
+        return latestStatus.get();
+    }
+    
+    /**
+     * String field of the flat firmware JSON (`"key":"value"`, first occurrence)
+     * @return Value, or null if the field is missing
+     */
+    static String text(final String json, final String key) {
+        final String name = "\"" + key + "\":\"";
+        final int start = json.indexOf(name);
+        if (start < 0) {
+            return null;
+        }
+        final int end = json.indexOf('"', start + name.length());
+        return end < 0 ? null : json.substring(start + name.length(), end);
+    }
+    
+    /**
+     * Largest entry of the `"frameSizes":[...]` list
+     */
+    private static String lastFrameSize(final String json) {
+        final int start = json.indexOf("\"frameSizes\":[");
+        final int end = start < 0 ? -1 : json.indexOf(']', start);
+        if (end < 0) {
+            return null;
+        }
+        final int last = json.lastIndexOf(',', end);
+        final int from = last > start ? last + 1 : start + "\"frameSizes\":[".length();
+        return json.substring(from, end).replace("\"", "");
+    }
+}
@@ -0,0 +1,162 @@
+"""
+`luma_plane.py`
+- Gray plane side-stream decoder (see esp32-camera-firmware/lib/LumaStream/LumaStream.h)
+- The ESP32 sends a small luminance plane (at most e.g. 80x60, HVGA 60x40) per capture as a "LUM" message,
+  delta-coded against the previous plane; motion detection runs on it without a JPEG decode
+
+@author      Sim Woo-Keun <smileteeth14@gmail.com>
+@date        2026-10-16 initial version
+
+@copyright   (C) 2026 Granule Co Ltd. - All Rights Reserved.
+"""
+
+import struct
+from dataclasses import dataclass
+from typing import Optional
+import logging
+
+import numpy as np
+
+# Namespace logging
+NS = '\033[95m[LUMA]\033[0m'  # Magenta
+_log = logging.getLogger(__name__)
+
+LUMA_MAGIC = b'LUM'
+# magic, version, header length, flags, deadband, frame size, sequence, capture us, clock offset us,
+# width, height, payload length (36 bytes, big-endian)
+LUMA_HEADER = struct.Struct('>3sBBBBBIQqHHI')
+FLAG_KEY = 0x01
+FLAG_CLOCK_SYNCED = 0x02
+
+# JPEG frame width per framesize_t (header frame_size), 96X96 .. UXGA
+FRAME_WIDTHS = (96, 160, 176, 240, 240, 320, 400, 480, 640, 800, 1024, 1280, 1280, 1600)
+
+
+@dataclass
+class LumaHeader:
+    """Plane header"""
+    flags: int
+    deadband: int
+    frame_size: int
+    sequence: int
+    capture_us: int
+    clock_offset_us: int
+    width: int
+    height: int
+    payload: bytes
+
+    @property
+    def is_key(self) -> bool:
+        return bool(self.flags & FLAG_KEY)
+
+
+def is_luma(message: bytes) -> bool:
+    """Gray plane message (JPEG frames start with FF D8)"""
+    return message[:3] == LUMA_MAGIC
+
+
+def parse_header(message: bytes) -> Optional[LumaHeader]:
+    """
+    Parse a plane message
+
+    Returns:
+        Header with its payload, None if the message is truncated or not a plane
+    """
+    if len(message) < LUMA_HEADER.size or not is_luma(message):
+        return None
+    (_, version, header_length, flags, deadband, frame_size, sequence, capture_us, clock_offset_us,
+     width, height, payload_length) = LUMA_HEADER.unpack_from(message)
+    # Later versions append fields: skip header_length bytes
+    if version < 1 or header_length < LUMA_HEADER.size or header_length + payload_length > len(message):
+        return None
+    return LumaHeader(flags, deadband, frame_size, sequence, capture_us, clock_offset_us, width, height,
+                      message[header_length:header_length + payload_length])
+
+
+def apply_delta(payload: bytes, plane: np.ndarray) -> bool:
+    """
+    Apply a delta payload to the previous plane in place (zero plane for a key plane)
+
+    Token c < 0x80: c + 1 unchanged pixels; c >= 0x80: c - 0x7F deltas (mod 256) follow
+
+    Returns:
+        False if the payload does not cover exactly the plane
+    """
+    flat = plane.reshape(-1)
+    pixels = flat.size
+    offset, index = 0, 0
+    while offset < len(payload):
+        token = payload[offset]
+        offset += 1
+        if token < 0x80:
+            index += token + 1
+            if index > pixels:
+                return False
+            continue
+        count = token - 0x7F
+        if index + count > pixels or offset + count > len(payload):
+            return False
+        flat[index:index + count] += np.frombuffer(payload, np.uint8, count, offset)
+        index += count
+        offset += count
+    return index == pixels
+
+
+class LumaPlaneDecoder:
+    """
+    Follows the plane sequence: key planes restart it, a gap waits for the next key plane
+    """
+
+    def __init__(self):
+        self.plane: Optional[np.ndarray] = None
+        self.frame_width: Optional[int] = None  # width of the JPEG frames the plane was taken from
+        self.next_sequence = 0
+        self.planes = 0
+        self.key_planes = 0
+        self.waited = 0
+        self.errors = 0
+
+    def accept(self, message: bytes) -> Optional[np.ndarray]:
+        """
+        Decode one plane message
+
+        Returns:
+            The reconstructed plane (height x width, uint8), None while waiting for a key plane
+        """
+        header = parse_header(message)
+        if header is None:
+            self.errors += 1
+            return None
+        shape = (header.height, header.width)
+        if header.is_key:
+            self.plane = np.zeros(shape, np.uint8)
+            self.key_planes += 1
+        elif self.plane is None or self.plane.shape != shape or header.sequence != self.next_sequence:
+            # Lost plane or joined mid-stream: the relay asked the device for a key plane
+            if self.plane is not None:
+                _log.warning(f'{NS} ! Plane {header.sequence} out of sequence, waiting for a key plane')
+            self.plane = None
+            self.waited += 1
+            return None
+        self.next_sequence = (header.sequence + 1) & 0xFFFFFFFF
+        if not apply_delta(header.payload, self.plane):
+            _log.warning(f'{NS} ! Malformed plane {header.sequence}')
+            self.plane = None
+            self.errors += 1
+            return None
+        self.planes += 1
+        self.frame_width = FRAME_WIDTHS[header.frame_size] if header.frame_size < len(FRAME_WIDTHS) else None
+        return self.plane.copy()
+
+    def reset(self) -> None:
+        """Connection lost: the next plane must be a key plane"""
+        self.plane = None
+
+    def get_stats(self) -> dict:
+        """Get decoder statistics"""
+        return {
+            'planes': self.planes,
+            'key_planes': self.key_planes,
+            'waited': self.waited,
+            'errors': self.errors
+        }
@@ -56,60 +56,95 @@ class MotionDetector:
             # Convert to grayscale and blur
             gray = cv2.cvtColor(frame, cv2.COLOR_BGR2GRAY)
             blurred = cv2.GaussianBlur(gray, (self.config.blur_size, self.config.blur_size), 0)
+            return self._compare(frame, blurred, self.config.min_contour_area, dilate_iterations=2)
             
-            # First frame initialization
-            if self.previous_frame is None:
-                _log.info(f'{NS} > First frame initialized')
-                self.previous_frame = blurred
-                return ('none', 0.0, None, None, [])
-            
-            # Calculate frame difference
-            frame_delta = cv2.absdiff(self.previous_frame, blurred)
-            thresh = cv2.threshold(frame_delta, 25, 255, cv2.THRESH_BINARY)[1]
-            
-            # Dilate to fill holes
-            thresh = cv2.dilate(thresh, None, iterations=2)
+        except Exception as e:
+            _log.error(f'{NS} ! detect_motion() error: {e}')
+            return ('none', 0.0, None, None, [])
+    
+    def detect_motion_gray(self, plane: np.ndarray, scale: float) -> Tuple[MotionLevel, float, Optional[np.ndarray]]:
+        """
+        Detect motion in a gray plane from the ESP32 side-stream (no JPEG decode)
+        
+        Args:
+            plane: Current luminance plane (uint8, e.g. 80x60 or 60x40)
+            scale: Frame width / plane width (blur and contour area shrink with it)
             
-            # Calculate change percentage
-            total_pixels = thresh.shape[0] * thresh.shape[1]
-            changed_pixels = np.count_nonzero(thresh)
-            change_percentage = (changed_pixels / total_pixels) * 100
+        Returns:
+            Same tuple as detect_motion(), coordinates in plane pixels
+        """
+        try:
+            self.frame_count += 1
             
-            # Determine motion level
-            motion_level = self._calculate_motion_level(change_percentage)
+            # The plane is already averaged per block: a much smaller blur is enough
+            ksize = max(3, int(self.config.blur_size / scale) | 1)
+            blurred = cv2.GaussianBlur(plane, (ksize, ksize), 0)
+            min_area = self.config.min_contour_area / (scale * scale)
+            return self._compare(cv2.cvtColor(plane, cv2.COLOR_GRAY2BGR), blurred, min_area, dilate_iterations=1)
             
-            # Find contours for visualization
-            contours, _ = cv2.findContours(thresh.copy(), cv2.RETR_EXTERNAL, cv2.CHAIN_APPROX_SIMPLE)
+        except Exception as e:
+            _log.error(f'{NS} ! detect_motion_gray() error: {e}')
+            return ('none', 0.0, None, None, [])
+    
+    def _compare(self, frame: np.ndarray, blurred: np.ndarray, min_area: float, dilate_iterations: int) -> tuple:
+        """
+        Compare a blurred gray image with the previous one
+        
+        Args:
+            frame: Current frame (BGR, for the annotated copy)
+            blurred: Blurred gray image of the frame
+            min_area: Smallest contour area reported
+            dilate_iterations: Dilation passes on the threshold mask
+        """
+        # First frame initialization
+        if self.previous_frame is None or self.previous_frame.shape != blurred.shape:
+            _log.info(f'{NS} > First frame initialized')
+            self.previous_frame = blurred
+            return ('none', 0.0, None, None, [])
+        
+        # Calculate frame difference
+        frame_delta = cv2.absdiff(self.previous_frame, blurred)
+        thresh = cv2.threshold(frame_delta, 25, 255, cv2.THRESH_BINARY)[1]
+        
+        # Dilate to fill holes
+        thresh = cv2.dilate(thresh, None, iterations=dilate_iterations)
+        
+        # Calculate change percentage
+        total_pixels = thresh.shape[0] * thresh.shape[1]
+        changed_pixels = np.count_nonzero(thresh)
+        change_percentage = (changed_pixels / total_pixels) * 100
+        
+        # Determine motion level
+        motion_level = self._calculate_motion_level(change_percentage)
+        
+        # Find contours for visualization
+        contours, _ = cv2.findContours(thresh.copy(), cv2.RETR_EXTERNAL, cv2.CHAIN_APPROX_SIMPLE)
 
-            # Draw contours on diff frame
-            diff_frame = cv2.cvtColor(frame_delta, cv2.COLOR_GRAY2BGR)
-            for contour in contours:
-                if cv2.contourArea(contour) < self.config.min_contour_area:
-                    continue
-                (x, y, w, h) = cv2.boundingRect(contour)
-                cv2.rectangle(diff_frame, (x, y), (x + w, y + h), (0, 255, 0), 2)
+        # Draw contours on diff frame
+        diff_frame = cv2.cvtColor(frame_delta, cv2.COLOR_GRAY2BGR)
+        for contour in contours:
+            if cv2.contourArea(contour) < min_area:
+                continue
+            (x, y, w, h) = cv2.boundingRect(contour)
+            cv2.rectangle(diff_frame, (x, y), (x + w, y + h), (0, 255, 0), 2)
 
-            # Draw contours on original frame (green placeholder; caller may redraw with change_type color)
-            annotated_frame = frame.copy()
-            for contour in contours:
-                if cv2.contourArea(contour) < self.config.min_contour_area:
-                    continue
-                (x, y, w, h) = cv2.boundingRect(contour)
-                cv2.rectangle(annotated_frame, (x, y), (x + w, y + h), (0, 255, 0), 2)
-            
-            # Update previous frame
-            self.previous_frame = blurred
+        # Draw contours on original frame (green placeholder; caller may redraw with change_type color)
+        annotated_frame = frame.copy()
+        for contour in contours:
+            if cv2.contourArea(contour) < min_area:
+                continue
+            (x, y, w, h) = cv2.boundingRect(contour)
+            cv2.rectangle(annotated_frame, (x, y), (x + w, y + h), (0, 255, 0), 2)
+        
+        # Update previous frame
+        self.previous_frame = blurred
 
-            if motion_level != 'none':
-                _log.info(f'{NS} > Motion detected: {motion_level} ({change_percentage:.2f}%)')
+        if motion_level != 'none':
+            _log.info(f'{NS} > Motion detected: {motion_level} ({change_percentage:.2f}%)')
 
-            # Return contours along with frames so caller can redraw with change_type color
-            valid_contours = [c for c in contours if cv2.contourArea(c) >= self.config.min_contour_area]
-            return (motion_level, change_percentage, diff_frame, annotated_frame, valid_contours)
-            
-        except Exception as e:
-            _log.error(f'{NS} ! detect_motion() error: {e}')
-            return ('none', 0.0, None, None, [])
+        # Return contours along with frames so caller can redraw with change_type color
+        valid_contours = [c for c in contours if cv2.contourArea(c) >= min_area]
+        return (motion_level, change_percentage, diff_frame, annotated_frame, valid_contours)
     
     def _calculate_motion_level(self, change_percentage: float) -> MotionLevel:
         """
@@ -2,6 +2,8 @@
 `websocket_client.py`
 - WebSocket client for ESP32 camera server integration
 - Receives frames, performs motion detection, sends analysis results
+- With the ESP32 gray plane side-stream ("LUM" messages) motion detection runs on the planes;
+  JPEG frames are only decoded when a plane shows motion worth an AI analysis
 
 @author      Sim Woo-Keun <smileteeth14@gmail.com>
 @date        2026-02-19 initial version
@@ -18,15 +20,20 @@ from typing import Optional
 from datetime import datetime
 import logging
 import base64
+import time
 
 from motion_types import MotionEvent, DetectionConfig, WebSocketMessage
 from motion_detector import MotionDetector
 from ai_analyzer import AIAnalyzer
+from luma_plane import LumaPlaneDecoder, is_luma
 
 # Namespace logging
 NS = '\033[96m[WS]\033[0m'  # Cyan
 _log = logging.getLogger(__name__)
 
+# JPEG frames go back to the motion detector when no gray plane arrived for this long
+LUMA_TIMEOUT_S = 2.0
+
 
 class MotionDetectionClient:
     """
@@ -57,6 +64,13 @@ class MotionDetectionClient:
         self.websocket: Optional[websockets.WebSocketClientProtocol] = None
         self.running = False
         self.frame_count = 0
+        
+        # Gray plane side-stream (own detector: planes and frames are different images)
+        self.luma = LumaPlaneDecoder()
+        self.luma_detector = MotionDetector(config)
+        self.luma_last_time = 0.0
+        self.latest_jpeg: Optional[bytes] = None
+        self.jpeg_decodes_skipped = 0
     
     async def connect(self) -> None:
         """Connect to WebSocket server"""
@@ -91,6 +105,8 @@ class MotionDetectionClient:
         if self.websocket:
             await self.websocket.close()
             self.websocket = None
+        self.luma.reset()
+        self.luma_last_time = 0.0
         _log.info(f'{NS} > Disconnected')
     
     async def run(self) -> None:
@@ -102,7 +118,9 @@ class MotionDetectionClient:
             
             async for message in self.websocket:
                 try:
-                    if isinstance(message, bytes):
+                    if isinstance(message, bytes) and is_luma(message):
+                        await self._process_luma(message)
+                    elif isinstance(message, bytes):
                         await self._process_frame(message)
                     else:
                         await self._process_text_message(message)
@@ -127,6 +145,12 @@ class MotionDetectionClient:
         try:
             self.frame_count += 1
             
+            # Gray planes arriving: keep the JPEG for an AI analysis, do not decode it
+            if time.monotonic() - self.luma_last_time < LUMA_TIMEOUT_S:
+                self.latest_jpeg = frame_data
+                self.jpeg_decodes_skipped += 1
+                return
+            
             # Decode JPEG to numpy array
             nparr = np.frombuffer(frame_data, np.uint8)
             frame = cv2.imdecode(nparr, cv2.IMREAD_COLOR)
@@ -139,9 +163,8 @@ class MotionDetectionClient:
             motion_level, change_pct, diff_frame, annotated_frame, contours = self.detector.detect_motion(frame)
             
             # Send debug info every frame
-            debug_boxes = [{'x': int(cv2.boundingRect(c)[0]), 'y': int(cv2.boundingRect(c)[1]),
-                             'w': int(cv2.boundingRect(c)[2]), 'h': int(cv2.boundingRect(c)[3])}
-                            for c in contours]
+            boxes = [cv2.boundingRect(c) for c in contours]
+            debug_boxes = [{'x': int(x), 'y': int(y), 'w': int(w), 'h': int(h)} for (x, y, w, h) in boxes]
             await self._send_debug_info({
                 'frame_number': self.frame_count,
                 'motion_level': motion_level,
@@ -156,58 +179,119 @@ class MotionDetectionClient:
             
             # Only analyze if significant motion detected
             if motion_level not in ['none', 'low'] and self.config.enable_ai_analysis:
-                change_type, description, confidence = self.analyzer.analyze_change(frame, diff_frame)
-
-                # Redraw contours on annotated_frame with change_type-specific color
-                COLOR_MAP = {
-                    'person': (0, 0, 255),    # Red
-                    'light':  (0, 255, 255),  # Yellow
-                    'object': (255, 165, 0),  # Orange
-                    'camera': (255, 0, 255),  # Magenta
-                    'unknown': (128, 128, 128),  # Gray
-                }
-                border_color = COLOR_MAP.get(change_type, (0, 255, 0))
-                labeled_frame = frame.copy()
-                for contour in contours:
-                    (cx, cy, cw, ch) = cv2.boundingRect(contour)
-                    cv2.rectangle(labeled_frame, (cx, cy), (cx + cw, cy + ch), border_color, 2)
-                # Draw label on top-left corner
-                label_text = f'{change_type.upper()} ({int(confidence * 100)}%)'
-                (tw, th), _ = cv2.getTextSize(label_text, cv2.FONT_HERSHEY_SIMPLEX, 0.6, 2)
-                cv2.rectangle(labeled_frame, (8, 8), (8 + tw + 8, 8 + th + 10), border_color, -1)
-                cv2.putText(labeled_frame, label_text, (12, 8 + th + 2),
-                            cv2.FONT_HERSHEY_SIMPLEX, 0.6, (255, 255, 255), 2)
-                # Motion level badge
-                level_text = f'{motion_level} {change_pct:.1f}%'
-                cv2.putText(labeled_frame, level_text, (12, labeled_frame.shape[0] - 10),
-                            cv2.FONT_HERSHEY_SIMPLEX, 0.5, border_color, 1)
-                
-                # Build bounding box list for web overlay
-                bounding_boxes = []
-                for contour in contours:
-                    (cx, cy, cw, ch) = cv2.boundingRect(contour)
-                    bounding_boxes.append({'x': cx, 'y': cy, 'w': cw, 'h': ch})
-
-                # Send analysis result to server
-                await self._send_motion_event({
-                    'frame_number': self.frame_count,
-                    'motion_level': motion_level,
-                    'change_percentage': round(change_pct, 2),
-                    'change_type': change_type,
-                    'description': description,
-                    'confidence': round(confidence, 2),
-                    'timestamp': datetime.now().isoformat(),
-                    'frame_size': {'w': frame.shape[1], 'h': frame.shape[0]},
-                    'bounding_boxes': bounding_boxes,
-                })
-                
-                # Save snapshot if enabled
-                if self.config.save_snapshots:
-                    self._save_snapshot(labeled_frame, diff_frame, motion_level, change_type)
+                await self._analyze_motion(frame, diff_frame, motion_level, change_pct, boxes)
                     
         except Exception as e:
             _log.error(f'{NS} ! _process_frame() error: {e}')
     
+    async def _process_luma(self, message: bytes) -> None:
+        """
+        Process a gray plane from the ESP32 side-stream (no JPEG decode)
+        
+        Args:
+            message: "LUM" message (header + delta payload)
+        """
+        try:
+            plane = self.luma.accept(message)
+            if plane is None:
+                return
+            self.luma_last_time = time.monotonic()
+            
+            # Plane coordinates → frame coordinates (frame size from the plane header)
+            height, width = plane.shape
+            frame_w = self.luma.frame_width or width
+            scale = frame_w / width
+            frame_h = int(round(height * scale))
+            
+            motion_level, change_pct, diff_plane, _, contours = self.luma_detector.detect_motion_gray(plane, scale)
+            boxes = [tuple(int(round(v * scale)) for v in cv2.boundingRect(c)) for c in contours]
+            
+            await self._send_debug_info({
+                'frame_number': self.frame_count,
+                'plane_number': self.luma.planes,
+                'source': 'luma',
+                'motion_level': motion_level,
+                'change_percentage': round(change_pct, 2),
+                'frame_size': f'{frame_w}x{frame_h}',
+                'frame_w': frame_w,
+                'frame_h': frame_h,
+                'contour_count': len(contours),
+                'contour_boxes': [{'x': x, 'y': y, 'w': w, 'h': h} for (x, y, w, h) in boxes],
+                'timestamp': datetime.now().isoformat()
+            })
+            
+            # Only significant motion pays for decoding the latest JPEG
+            if motion_level in ['none', 'low'] or not self.config.enable_ai_analysis or self.latest_jpeg is None:
+                return
+            frame = cv2.imdecode(np.frombuffer(self.latest_jpeg, np.uint8), cv2.IMREAD_COLOR)
+            if frame is None:
+                return
+            if frame.shape[1] != frame_w:
+                ratio = frame.shape[1] / frame_w
+                boxes = [tuple(int(round(v * ratio)) for v in box) for box in boxes]
+            diff_frame = cv2.resize(diff_plane, (frame.shape[1], frame.shape[0]), interpolation=cv2.INTER_NEAREST)
+            await self._analyze_motion(frame, diff_frame, motion_level, change_pct, boxes)
+            
+        except Exception as e:
+            _log.error(f'{NS} ! _process_luma() error: {e}')
+    
+    async def _analyze_motion(self, frame: np.ndarray, diff_frame: np.ndarray, motion_level: str,
+                              change_pct: float, boxes: list) -> None:
+        """
+        Classify significant motion, send the event and save a snapshot
+        
+        Args:
+            frame: Current frame (BGR)
+            diff_frame: Difference frame (same size as frame)
+            motion_level: Motion level classification
+            change_pct: Percentage of changed pixels
+            boxes: Changed regions (x, y, w, h) in frame pixels
+        """
+        change_type, description, confidence = self.analyzer.analyze_change(frame, diff_frame)
+
+        # Redraw contours on annotated_frame with change_type-specific color
+        COLOR_MAP = {
+            'person': (0, 0, 255),    # Red
+            'light':  (0, 255, 255),  # Yellow
+            'object': (255, 165, 0),  # Orange
+            'camera': (255, 0, 255),  # Magenta
+            'unknown': (128, 128, 128),  # Gray
+        }
+        border_color = COLOR_MAP.get(change_type, (0, 255, 0))
+        labeled_frame = frame.copy()
+        for (cx, cy, cw, ch) in boxes:
+            cv2.rectangle(labeled_frame, (cx, cy), (cx + cw, cy + ch), border_color, 2)
+        # Draw label on top-left corner
+        label_text = f'{change_type.upper()} ({int(confidence * 100)}%)'
+        (tw, th), _ = cv2.getTextSize(label_text, cv2.FONT_HERSHEY_SIMPLEX, 0.6, 2)
+        cv2.rectangle(labeled_frame, (8, 8), (8 + tw + 8, 8 + th + 10), border_color, -1)
+        cv2.putText(labeled_frame, label_text, (12, 8 + th + 2),
+                    cv2.FONT_HERSHEY_SIMPLEX, 0.6, (255, 255, 255), 2)
+        # Motion level badge
+        level_text = f'{motion_level} {change_pct:.1f}%'
+        cv2.putText(labeled_frame, level_text, (12, labeled_frame.shape[0] - 10),
+                    cv2.FONT_HERSHEY_SIMPLEX, 0.5, border_color, 1)
+        
+        # Build bounding box list for web overlay
+        bounding_boxes = [{'x': int(cx), 'y': int(cy), 'w': int(cw), 'h': int(ch)} for (cx, cy, cw, ch) in boxes]
+
+        # Send analysis result to server
+        await self._send_motion_event({
+            'frame_number': self.frame_count,
+            'motion_level': motion_level,
+            'change_percentage': round(change_pct, 2),
+            'change_type': change_type,
+            'description': description,
+            'confidence': round(confidence, 2),
+            'timestamp': datetime.now().isoformat(),
+            'frame_size': {'w': frame.shape[1], 'h': frame.shape[0]},
+            'bounding_boxes': bounding_boxes,
+        })
+        
+        # Save snapshot if enabled
+        if self.config.save_snapshots:
+            self._save_snapshot(labeled_frame, diff_frame, motion_level, change_type)
+    
     async def _process_text_message(self, message: str) -> None:
         """
         Process text message from server
@@ -305,6 +389,9 @@ class MotionDetectionClient:
         return {
             'connected': self.running,
             'frame_count': self.frame_count,
+            'jpeg_decodes_skipped': self.jpeg_decodes_skipped,
             'detector_stats': self.detector.get_stats(),
+            'luma_stats': self.luma.get_stats(),
+            'luma_detector_stats': self.luma_detector.get_stats(),
             'analyzer_stats': self.analyzer.get_stats()
         }